@@ -14,6 +14,9 @@ public:
 	void Run();
 	void Finalize();
 
+	// Runs numFrames frames after a warm-up, writes the frame statistics to reportFilepath and closes
+	void SetBenchmarkMode(uint32_t numFrames, const std::string& reportFilepath);
+
 	void OnWindowResize(uint32_t width, uint32_t height);
 
 	bool IsInitialized() const { return m_Initialized; }
@@ -44,4 +47,7 @@ private:
 	bool m_Initialized = false;
 	bool m_RenderGUI = true;
 
+	uint32_t m_NumBenchmarkFrames = 0;
+	std::string m_BenchmarkReportFilepath;
+
 };
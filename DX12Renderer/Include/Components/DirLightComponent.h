@@ -1,7 +1,7 @@
 #pragma once
 #include "Component.h"
-#include "Scene/Camera/Camera.h"
 #include "Graphics/RenderAPI.h"
+#include "Graphics/ShadowCascades.h"
 
 struct DirectionalLightData
 {
@@ -16,8 +16,11 @@ struct DirectionalLightData
 	glm::vec3 Color = glm::vec3(1.0f);
 	BYTE_PADDING(4);
 
-	glm::mat4 ViewProjection = glm::identity<glm::mat4>();
-	uint32_t ShadowMapIndex = 0;
+	// Filled in by the renderer every frame, the cascades are fitted to the scene camera
+	// Atlas rects are the offset (xy) and scale (zw) of the cascade tiles in the shadow atlas, a scale of 0 means the cascade has no tile
+	glm::mat4 CascadeViewProjections[MAX_SHADOW_CASCADES];
+	glm::vec4 CascadeAtlasRects[MAX_SHADOW_CASCADES] = {};
+	uint32_t NumCascades = 0;
 	BYTE_PADDING(12);
 };
 
@@ -41,7 +44,5 @@ private:
 	GUIDataRepresentation m_GUIData;
 
 	DirectionalLightData m_DirectionalLightData;
-	Camera m_Camera;
-	RenderResourceHandle m_ShadowMap;
 
 };
@@ -14,7 +14,12 @@ struct PointLightData
 	glm::vec3 Attenuation = glm::vec3(0.0f);
 	BYTE_PADDING(4);
 	glm::vec3 Color = glm::vec3(1.0f);
-	uint32_t ShadowMapIndex = 0;
+	BYTE_PADDING(4);
+
+	// Filled in by the renderer, every face is a tile of the shadow atlas in the order +X, -X, +Y, -Y, +Z, -Z
+	// Atlas rects are the offset (xy) and scale (zw) of the tiles, a scale of 0 means unshadowed
+	glm::mat4 FaceViewProjections[6];
+	glm::vec4 ShadowAtlasRects[6] = {};
 };
 
 class PointLightComponent : public Component
@@ -30,6 +35,5 @@ public:
 private:
 	PointLightData m_PointLightData;
 	std::array<Camera, 6> m_Cameras;
-	RenderResourceHandle m_ShadowMap;
 
 };
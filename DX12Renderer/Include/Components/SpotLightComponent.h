@@ -19,8 +19,8 @@ struct SpotLightData
 	glm::vec3 Color = glm::vec3(0.0f);
 
 	glm::mat4 ViewProjection = glm::identity<glm::mat4>();
-	uint32_t ShadowMapIndex = 0;
-	BYTE_PADDING(12);
+	// Offset (xy) and scale (zw) of the shadow map tile in the shadow atlas, filled in by the renderer, a scale of 0 means unshadowed
+	glm::vec4 ShadowAtlasRect = glm::vec4(0.0f);
 };
 
 class SpotLightComponent : public Component
@@ -45,5 +45,4 @@ private:
 
 	SpotLightData m_SpotLightData;
 	Camera m_Camera;
-	RenderResourceHandle m_ShadowMap;
 };
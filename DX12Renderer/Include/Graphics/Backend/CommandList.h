@@ -1,7 +1,7 @@
 #pragma once
 #include "Graphics/Buffer.h"
 #include "Graphics/Texture.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 class DescriptorHeap;
 class DynamicDescriptorHeap;
@@ -19,11 +19,15 @@ public:
 
 	void ClearRenderTargetView(D3D12_CPU_DESCRIPTOR_HANDLE rtv, const float* clearColor);
 	void ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsv, float depth = 1.0f);
+	// Only clears the given rects, e.g. the tiles of a shadow atlas
+	void ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsv, float depth, uint32_t numRects, const D3D12_RECT* rects);
 
 	void SetViewports(uint32_t numViewports, D3D12_VIEWPORT* viewports);
 	void SetScissorRects(uint32_t numRects, D3D12_RECT* rects);
 	void SetRenderTargets(uint32_t numRTVS, D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, D3D12_CPU_DESCRIPTOR_HANDLE* dsv);
 	void SetRenderPassBindables(const RasterPass& renderPass);
+	// Switches to another shader permutation variant of the bound render pass
+	void SetPipelineState(const RasterPass& renderPass, uint32_t variant);
 
 	void SetRootConstants(uint32_t rootIndex, uint32_t numValues, const void* data, uint32_t offset);
 	void SetVertexBuffers(uint32_t slot, uint32_t numViews, const Buffer& vertexBuffer);
@@ -32,10 +36,16 @@ public:
 	void SetRootDescriptorTable(uint32_t rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE baseDescriptor);
 
 	void SetRootConstantBufferView(uint32_t rootParameterIndex, Buffer& buffer, D3D12_RESOURCE_STATES stateAfter);
+	// Binds the constant buffer data starting at byteOffset, which has to be a multiple of 256
+	void SetRootConstantBufferView(uint32_t rootParameterIndex, Buffer& buffer, std::size_t byteOffset, D3D12_RESOURCE_STATES stateAfter);
 	void SetRootShaderResourceView(uint32_t rootParameterIndex, Texture& texture, D3D12_RESOURCE_STATES stateAfter);
+	void SetRootShaderResourceView(uint32_t rootParameterIndex, Buffer& buffer, D3D12_RESOURCE_STATES stateAfter);
+	// Binds the buffer data starting at byteOffset, e.g. the copy of the current back buffer
+	void SetRootShaderResourceView(uint32_t rootParameterIndex, Buffer& buffer, std::size_t byteOffset, D3D12_RESOURCE_STATES stateAfter);
 
-	void BeginTimestampQuery(const std::string& name);
-	void EndTimestampQuery(const std::string& name);
+	// Zones are registered once with the GPU profiler of the render backend, and can span multiple command lists
+	void BeginGPUZone(uint32_t zoneID);
+	void EndGPUZone();
 	void ResolveTimestampQueries();
 	
 	void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex = 0, uint32_t startInstance = 0);
@@ -45,6 +55,7 @@ public:
 	void CopyBuffer(const UploadBufferAllocation& uploadBuffer, Buffer& destBuffer, const void* bufferData);
 	void CopyBufferRegion(const UploadBufferAllocation& uploadBuffer, Buffer& destBuffer, std::size_t destOffset, std::size_t numBytes);
 	void CopyTexture(const UploadBufferAllocation& uploadBuffer, Texture& destTexture, const void* textureData);
+	void CopyTextureRegion(const UploadBufferAllocation& uploadBuffer, Texture& destTexture, uint32_t firstRow, uint32_t numRows, std::size_t rowPitch);
 	void GenerateMips(Texture& texture);
 	void ResolveTexture(Texture& destTexture, Texture& srcTexture);
 
@@ -73,6 +84,7 @@ private:
 	ID3D12RootSignature* m_RootSignature;
 	ID3D12DescriptorHeap* DescriptorHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
 
-	std::unordered_map<std::string, TimestampQuery> m_TimestampQueries;
+	// Timestamp queries written since the last resolve, in the query heap of the back buffer
+	std::vector<uint32_t> m_TimestampQueries;
 
 };
@@ -14,6 +14,7 @@ public:
 
 	uint64_t Signal();
 	bool IsFenceComplete() const;
+	uint64_t GetCompletedFenceValue() const;
 	void WaitForFenceValue(uint64_t fenceValue) const;
 	void ResetCommandLists();
 
@@ -26,12 +27,18 @@ public:
 	uint64_t GetTimestampFrequency() const { return m_TimestampFrequency; }
 
 private:
+	uint64_t SignalUnlocked();
+
 	ComPtr<ID3D12CommandQueue> m_d3d12CommandQueue;
 	D3D12_COMMAND_LIST_TYPE m_d3d12CommandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
 	uint64_t m_TimestampFrequency = 0;
 
 	ComPtr<ID3D12Fence> m_d3d12Fence;
-	uint64_t m_FenceValue = 0;
+	// Atomic so the fence can be polled without taking the submit mutex
+	std::atomic<uint64_t> m_FenceValue = 0;
+	// The upload queue worker and the main thread both submit to the copy queue, executing a command list and signaling its fence
+	// value has to happen as one step, otherwise the signals can reach the queue in a different order than their values
+	std::mutex m_SubmitMutex;
 
 	struct InFlightCommandList
 	{
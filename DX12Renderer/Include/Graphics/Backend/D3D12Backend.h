@@ -0,0 +1,59 @@
+#pragma once
+#include "Graphics/Backend/DescriptorAllocation.h"
+#include "Graphics/Backend/UploadQueue.h"
+#include "Graphics/Buffer.h"
+#include "Util/Hash.h"
+
+class SwapChain;
+class DescriptorHeap;
+class CommandQueue;
+class CommandList;
+class Texture;
+class GPUProfiler;
+
+namespace D3D12Backend
+{
+
+	void Initialize(HWND hWnd, uint32_t width, uint32_t height);
+	void BeginFrame();
+	void OnImGuiRender();
+	void EndFrame();
+	void Finalize();
+	void CreateBuffer(ComPtr<ID3D12Resource>& d3d12Resource, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& bufferDesc, D3D12_RESOURCE_STATES initialState);
+	void CreateTexture(ComPtr<ID3D12Resource>& d3d12Resource, const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue);
+	UploadTicket UploadBufferData(Buffer& destBuffer, const void* bufferData);
+	void UploadBufferDataRegion(Buffer& destBuffer, std::size_t destOffset, std::size_t numBytes);
+	UploadTicket UploadTextureData(Texture& destTexture, const void* textureData);
+	bool IsUploadComplete(UploadTicket ticket);
+	void WaitForUpload(UploadTicket ticket);
+	void GenerateMips(Texture& texture);
+
+	// Pipeline states are created on the job system and shared between identical descriptions, the description is copied
+	// GetPipelineState returns nullptr until the pipeline state is ready, the root signature hash is the hash of its serialized blob
+	uint32_t CreateGraphicsPipelineState(const std::string& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash);
+	uint32_t CreateComputePipelineState(const std::string& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash);
+	ID3D12PipelineState* GetPipelineState(uint32_t pipelineStateID);
+	ID3D12PipelineState* WaitForPipelineState(uint32_t pipelineStateID);
+
+	// GPU zones of the direct queue, the query heap and readback buffer of a back buffer can grow at the start of its frame
+	GPUProfiler& GetGPUProfiler();
+	ID3D12QueryHeap* GetD3D12TimestampQueryHeap(uint32_t backBufferIndex);
+	const Buffer& GetQueryReadbackBuffer(uint32_t backBufferIndex);
+
+	void Resize(uint32_t width, uint32_t height);
+	void Flush();
+	void SetVSync(bool vSync);
+
+	IDXGIAdapter4* GetDXGIAdapter();
+	ID3D12Device2* GetD3D12Device();
+	SwapChain& GetSwapChain();
+	ID3D12PipelineState* GetMipGenPSO();
+	ID3D12RootSignature* GetMipGenRootSig();
+	DescriptorAllocation AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors = 1);
+	DescriptorHeap& GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type);
+
+	std::shared_ptr<CommandList> GetCommandList(D3D12_COMMAND_LIST_TYPE type);
+	void ExecuteCommandList(std::shared_ptr<CommandList> commandList);
+	void ExecuteCommandListAndWait(std::shared_ptr<CommandList> commandList);
+
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include "Graphics/Backend/RenderBackend.h"
+
+class Buffer;
+class Texture;
+class RasterPass;
+class ComputePass;
+class CommandList;
+
+enum ComputePassType : uint32_t
+{
+	LIGHT_CLUSTERING,
+	TEMPORAL_ANTI_ALIASING,
+	POST_PROCESS,
+	NUM_COMPUTE_PASSES
+};
+
+/*
+
+	Render backend of the application, records the passes of the renderer into D3D12 command lists.
+	Owns the swap chain and device through D3D12Backend, which is initialized and finalized with it.
+	Buffers and textures handed to the renderer are Resource pointers (Buffer or Texture).
+
+*/
+class D3D12RenderBackend : public RenderBackend
+{
+public:
+	D3D12RenderBackend(HWND hWnd, uint32_t width, uint32_t height);
+	virtual ~D3D12RenderBackend();
+
+	virtual void BeginFrame() override;
+	virtual void EndFrame() override;
+	virtual void Flush() override;
+	virtual void Resize(uint32_t width, uint32_t height) override;
+	virtual void SetVSync(bool vSync) override;
+	virtual uint32_t GetBackBufferIndex() const override;
+	virtual GPUProfiler& GetGPUProfiler() override;
+
+	virtual void CreateRenderPasses(const RenderSettings& settings) override;
+	virtual void CreateRenderTargets(const RenderSettings& settings) override;
+	virtual bool ArePipelineStatesReady() const override;
+	virtual void CreateRenderBuffer(RenderBufferType type, const BufferDesc& desc) override;
+	virtual void WriteRenderBuffer(RenderBufferType type, const void* data, std::size_t byteSize, std::size_t byteOffset = 0) override;
+
+	virtual void* CreateBuffer(const BufferDesc& desc) override;
+	virtual void* CreateTexture(const TextureDesc& desc) override;
+	virtual void ReleaseResource(void* resource) override;
+	virtual bool IsResourceReady(void* resource) const override;
+	virtual uint32_t GetTextureIndex(void* texture) const override;
+	virtual uint32_t GetShadowAtlasIndex() const override;
+
+	virtual void BeginCommandList() override;
+	virtual void ExecuteCommandList() override;
+	virtual void BeginGPUZone(uint32_t zoneID) override;
+	virtual void EndGPUZone() override;
+
+	virtual void BindRenderPass(RenderPassType pass, uint32_t sceneTableCopyIndex) override;
+	virtual void SetPipelineVariant(RenderPassType pass, uint32_t variant) override;
+	virtual void SetViewProjection(const glm::mat4& viewProjection) override;
+	virtual void DrawMesh(void* positionBuffer, void* attributeBuffer, void* indexBuffer, uint32_t numIndices, uint32_t instance) override;
+
+	virtual void BeginShadowAtlasLayer(ShadowAtlasLayer layer) override;
+	virtual void ClearShadowAtlasTiles(ShadowAtlasLayer layer, const std::vector<ShadowAtlasTile>& tiles) override;
+	virtual void SetShadowAtlasTile(ShadowAtlasLayer layer, const ShadowAtlasTile& tile) override;
+	virtual void ComposeShadowAtlasTile(const ShadowAtlasTile& tile) override;
+	virtual bool HasShadowAtlasStaticLayer() const override { return m_ShadowAtlasStaticLayer != nullptr; }
+	virtual void CreateShadowAtlasStaticLayer() override;
+	virtual void ReleaseShadowAtlasStaticLayer() override;
+
+	virtual void DispatchLightClustering(uint32_t sceneTableCopyIndex) override;
+	virtual void ReadBackLightClusters(LightClusterLists& outLists) override;
+	virtual void ResolveTemporalAA(bool enableTAA) override;
+	virtual void PostProcess(DebugShowTextureMode debugShowTextureMode) override;
+
+	// Binds the SDR color target and the depth of the depth pre-pass, for the debug and GUI renderers that draw over the final output
+	void SetOverlayRenderTargets(CommandList& commandList);
+
+private:
+	Texture& GetShadowAtlasLayer(ShadowAtlasLayer layer);
+	const Texture& GetDebugShowTextureModeTexture(DebugShowTextureMode mode) const;
+	Buffer& GetRenderBuffer(RenderBufferType type) { return *m_RenderBuffers[static_cast<uint32_t>(type)]; }
+	std::size_t GetRenderBufferCopyOffset(RenderBufferType type, uint32_t sceneTableCopyIndex);
+	void SetRenderResolutionViewport();
+
+private:
+	std::unique_ptr<RasterPass> m_RenderPasses[RenderPassType::NUM_RENDER_PASSES];
+	std::unique_ptr<ComputePass> m_ComputePasses[ComputePassType::NUM_COMPUTE_PASSES];
+	std::unique_ptr<Buffer> m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_NUM_TYPES)];
+
+	// For textures which names contain "history", this will mean that it accumulates values over time
+	// For textures which names contain "previous", this will mean that it is the last frame's texture of that particular type
+	std::unique_ptr<Texture> m_DepthPrepassDepthTarget;
+	std::unique_ptr<Texture> m_HDRColorTarget;
+	std::unique_ptr<Texture> m_SDRColorTarget;
+	std::unique_ptr<Texture> m_TAAResolveTarget;
+	std::unique_ptr<Texture> m_TAAHistory;
+	std::unique_ptr<Texture> m_VelocityTarget;
+	std::unique_ptr<Texture> m_VelocityTargetPrevious;
+
+	std::unique_ptr<Texture> m_ShadowAtlas;
+	std::unique_ptr<Texture> m_ShadowAtlasStaticLayer;
+
+	std::shared_ptr<CommandList> m_CommandList;
+	Resolution m_RenderResolution;
+	std::vector<D3D12_RECT> m_ShadowAtlasClearRects;
+
+};
@@ -29,5 +29,6 @@ private:
 	uint32_t m_NumDescriptors = 256;
 	uint32_t m_DescriptorOffset = 0;
 	uint32_t m_DescriptorHandleIncrementSize = 0;
+	uint32_t m_MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
 
 };
@@ -0,0 +1,112 @@
+#pragma once
+
+static constexpr uint32_t GPU_PROFILER_INVALID_QUERY = std::numeric_limits<uint32_t>::max();
+
+// GPU timestamp and CPU time sampled at the same moment, used to place GPU zones on the CPU timeline
+struct GPUClockCalibration
+{
+	uint64_t GPUTimestamp = 0;
+	std::chrono::steady_clock::time_point CPUTime;
+};
+
+/*
+
+	The GPU profiler only hands out query indices and turns resolved timestamps into zones, the queries themselves
+	are owned by a source. The renderer uses D3D12 timestamp query heaps, the bookkeeping has no graphics API
+	dependencies and can be driven by a fake source that writes timestamps on its own clock.
+
+*/
+class GPUProfilerQuerySource
+{
+public:
+	virtual ~GPUProfilerQuerySource() = default;
+
+	// Makes room for numQueries timestamps in the queries of a frame in flight, only called while the GPU does not use them
+	virtual void ResizeQueries(uint32_t frameIndex, uint32_t numQueries) = 0;
+	// Reads the first numQueries timestamps of a frame in flight whose GPU work completed
+	virtual void ReadTimestamps(uint32_t frameIndex, uint32_t numQueries, uint64_t* outTimestamps) = 0;
+
+	virtual uint64_t GetTimestampFrequency() const = 0;
+	virtual GPUClockCalibration GetClockCalibration() = 0;
+};
+
+struct GPUProfilerStatistics
+{
+	uint32_t NumRegisteredZones = 0;
+	// Zones resolved from the last completed frame
+	uint32_t NumZones = 0;
+	uint32_t NumQueriesPerFrame = 0;
+	// Zones that were not recorded because the queries of their frame were used up, the queries grow for the next frames
+	uint64_t NumDroppedZones = 0;
+};
+
+/*
+
+	Nested GPU zones identified by IDs that are registered once, so recording a zone neither hashes nor copies a name.
+	Every zone writes a timestamp query when it begins and ends, the queries of a frame in flight are read back once
+	the frame comes around again and converted to CPU time with the clock calibration of the source.
+	A zone is only recorded when its frame has a query left for the end of every open zone, a frame that runs out
+	drops whole zones and the queries of all frames grow to the largest number a frame asked for.
+	Zones are recorded by one thread at a time, in the order the GPU executes them.
+
+*/
+class GPUProfiler
+{
+public:
+	GPUProfiler(std::unique_ptr<GPUProfilerQuerySource> source, uint32_t numFramesInFlight, uint32_t numQueriesPerFrame = 64);
+
+	// Returns the ID of the zone with the name, zones with the same name share an ID
+	uint32_t RegisterZone(const std::string& name);
+	const char* GetZoneName(uint32_t zoneID) const;
+
+	// Resolves the zones last recorded in the frame in flight, then starts recording new ones into it
+	void BeginFrame(uint32_t frameIndex);
+	// Return the query to write the timestamp into, or GPU_PROFILER_INVALID_QUERY when the zone is not recorded
+	uint32_t BeginZone(uint32_t zoneID);
+	uint32_t EndZone();
+
+	// Zones of the last completed frame in begin order, every zone follows its parent
+	const std::vector<ProfilerGPUZone>& GetZones() const { return m_Zones; }
+	GPUProfilerStatistics GetStatistics() const;
+	GPUProfilerQuerySource& GetQuerySource() { return *m_Source; }
+
+private:
+	struct ZoneRecord
+	{
+		uint32_t ZoneID = 0;
+		uint32_t Depth = 0;
+		uint32_t BeginQuery = GPU_PROFILER_INVALID_QUERY;
+		uint32_t EndQuery = GPU_PROFILER_INVALID_QUERY;
+	};
+
+	struct FrameQueries
+	{
+		std::vector<ZoneRecord> Records;
+		uint32_t NumQueries = 0;
+		uint32_t Capacity = 0;
+	};
+
+private:
+	void ResolveFrame(FrameQueries& frame);
+
+private:
+	std::unique_ptr<GPUProfilerQuerySource> m_Source;
+
+	// Names are never removed, the deque keeps the pointers handed out to zones valid
+	std::deque<TrackedString> m_ZoneNames;
+	std::unordered_map<std::string, uint32_t> m_ZoneIDs;
+
+	std::vector<FrameQueries> m_Frames;
+	uint32_t m_CurrentFrame = 0;
+	// Records of the zones that are still open, or GPU_PROFILER_INVALID_QUERY for dropped ones
+	std::vector<uint32_t> m_OpenZones;
+	uint32_t m_NumOpenRecordedZones = 0;
+
+	// Largest number of queries any frame asked for, the queries of every frame grow to it
+	uint32_t m_NumRequiredQueries = 0;
+	uint64_t m_NumDroppedZones = 0;
+
+	std::vector<uint64_t> m_Timestamps;
+	std::vector<ProfilerGPUZone> m_Zones;
+
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/UploadQueue.h"
+#include "Graphics/Backend/GPUProfiler.h"
+#include "Graphics/ShaderCache.h"
+
+static constexpr uint32_t HEADLESS_FRAMES_IN_FLIGHT = 3;
+
+/*
+
+	Buffers and textures of the headless backend are plain host memory.
+	Uploads are copied into Memory by the upload queue, IsReady is set once the copy completed.
+
+*/
+struct HeadlessResource
+{
+	std::vector<uint8_t> Memory;
+	std::string DebugName;
+
+	// Textures only, rows are tightly packed
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	std::size_t RowPitch = 0;
+	uint32_t TextureIndex = 0;
+
+	bool IsReady = false;
+	UploadTicket Ticket;
+	uint32_t MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
+};
+
+enum class HeadlessCommandType : uint32_t
+{
+	HEADLESS_COMMAND_TYPE_SET_VERTEX_BUFFER,
+	HEADLESS_COMMAND_TYPE_SET_INDEX_BUFFER,
+	HEADLESS_COMMAND_TYPE_SET_ROOT_CONSTANTS,
+	HEADLESS_COMMAND_TYPE_DRAW_INDEXED,
+	HEADLESS_COMMAND_TYPE_WRITE_TIMESTAMP,
+	HEADLESS_COMMAND_TYPE_SET_PIPELINE_STATE,
+	HEADLESS_COMMAND_TYPE_SET_VIEWPORT,
+	HEADLESS_COMMAND_TYPE_CLEAR_DEPTH,
+	HEADLESS_COMMAND_TYPE_DRAW,
+	HEADLESS_COMMAND_TYPE_DISPATCH
+};
+
+enum class HeadlessComputePassType : uint32_t
+{
+	HEADLESS_COMPUTE_PASS_TYPE_LIGHT_CLUSTERING,
+	HEADLESS_COMPUTE_PASS_TYPE_TEMPORAL_ANTI_ALIASING,
+	HEADLESS_COMPUTE_PASS_TYPE_POST_PROCESS
+};
+
+class HeadlessGPUQuerySource;
+
+/*
+
+	Records commands into a linear byte stream, every command is a header followed by its payload.
+	Nothing is executed, the stream only exists so recording has the same memory traffic as a real command list.
+
+*/
+class HeadlessCommandList
+{
+public:
+	struct CommandHeader
+	{
+		HeadlessCommandType Type;
+		uint32_t PayloadByteSize;
+	};
+
+public:
+	void Reset();
+
+	void SetVertexBuffer(uint32_t slot, const HeadlessResource& vertexBuffer);
+	void SetIndexBuffer(const HeadlessResource& indexBuffer);
+	void SetRootConstants(const void* data, uint32_t numBytes);
+	void SetPipelineState(uint32_t pipelineState);
+	void SetViewport(const ShadowAtlasTile& tile);
+	void ClearDepth(const std::vector<ShadowAtlasTile>& tiles);
+	void Draw(uint32_t numVertices, uint32_t numInstances);
+	void DrawIndexed(uint32_t numIndices, uint32_t numInstances, uint32_t firstIndex, uint32_t firstInstance);
+	void Dispatch(HeadlessComputePassType pass, uint32_t numGroupsX, uint32_t numGroupsY, uint32_t numGroupsZ);
+	void BeginGPUZone(GPUProfiler& gpuProfiler, uint32_t zoneID);
+	void EndGPUZone(GPUProfiler& gpuProfiler);
+
+	const std::vector<uint8_t>& GetCommandStream() const { return m_CommandStream; }
+	uint32_t GetNumCommands() const { return m_NumCommands; }
+
+private:
+	void WriteTimestamp(uint32_t queryIndex);
+	void RecordCommand(HeadlessCommandType type, const void* payload, uint32_t payloadByteSize);
+
+private:
+	std::vector<uint8_t> m_CommandStream;
+	uint32_t m_NumCommands = 0;
+
+};
+
+struct HeadlessBackendStatistics
+{
+	uint32_t NumBuffers = 0;
+	uint32_t NumTextures = 0;
+	std::size_t ResourceByteSize = 0;
+
+	uint64_t NumCommandListsExecuted = 0;
+	uint64_t NumCommandsExecuted = 0;
+	uint64_t NumDrawsExecuted = 0;
+	uint64_t NumIndicesExecuted = 0;
+	std::size_t CommandStreamByteSize = 0;
+
+	// Fence value of the last executed command list, the headless "GPU" finishes everything immediately
+	uint64_t LastFenceValue = 0;
+};
+
+/*
+
+	Render backend without a GPU, used to run the renderer on machines without D3D12, e.g. for benchmarking.
+	Resources live in host memory, uploads go through the regular UploadQueue with a backend that copies on the worker thread,
+	and executed command lists are walked and validated, then dropped. The light clustering dispatch builds the cluster
+	light lists on the CPU when it is executed, render targets only count their memory since no pixel is ever written.
+	Timestamp queries are written on a fake GPU clock that advances with the executed draws and dispatches, so the GPU profiler
+	resolves and calibrates its zones like it does on a real GPU. Frames in flight are cycled on every BeginFrame.
+
+*/
+class HeadlessBackend : public RenderBackend
+{
+public:
+	HeadlessBackend(const UploadQueueDesc& uploadQueueDesc = UploadQueueDesc());
+	virtual ~HeadlessBackend();
+
+	virtual void BeginFrame() override;
+	virtual void EndFrame() override;
+	virtual void Flush() override;
+	virtual void Resize(uint32_t width, uint32_t height) override;
+	virtual void SetVSync(bool vSync) override;
+	virtual uint32_t GetBackBufferIndex() const override { return m_FrameIndex; }
+	virtual GPUProfiler& GetGPUProfiler() override { return *m_GPUProfiler; }
+
+	virtual void CreateRenderPasses(const RenderSettings& settings) override;
+	virtual void CreateRenderTargets(const RenderSettings& settings) override;
+	virtual bool ArePipelineStatesReady() const override { return true; }
+	virtual void CreateRenderBuffer(RenderBufferType type, const BufferDesc& desc) override;
+	virtual void WriteRenderBuffer(RenderBufferType type, const void* data, std::size_t byteSize, std::size_t byteOffset = 0) override;
+
+	virtual void* CreateBuffer(const BufferDesc& desc) override;
+	virtual void* CreateTexture(const TextureDesc& desc) override;
+	// Resources that are never released stay in the memory tracker and are reported as leaks
+	virtual void ReleaseResource(void* resource) override;
+	virtual bool IsResourceReady(void* resource) const override;
+	virtual uint32_t GetTextureIndex(void* texture) const override;
+	virtual uint32_t GetShadowAtlasIndex() const override { return 0; }
+
+	virtual void BeginCommandList() override;
+	virtual void ExecuteCommandList() override;
+	virtual void BeginGPUZone(uint32_t zoneID) override;
+	virtual void EndGPUZone() override;
+
+	virtual void BindRenderPass(RenderPassType pass, uint32_t sceneTableCopyIndex) override;
+	virtual void SetPipelineVariant(RenderPassType pass, uint32_t variant) override;
+	virtual void SetViewProjection(const glm::mat4& viewProjection) override;
+	virtual void DrawMesh(void* positionBuffer, void* attributeBuffer, void* indexBuffer, uint32_t numIndices, uint32_t instance) override;
+
+	virtual void BeginShadowAtlasLayer(ShadowAtlasLayer layer) override;
+	virtual void ClearShadowAtlasTiles(ShadowAtlasLayer layer, const std::vector<ShadowAtlasTile>& tiles) override;
+	virtual void SetShadowAtlasTile(ShadowAtlasLayer layer, const ShadowAtlasTile& tile) override;
+	virtual void ComposeShadowAtlasTile(const ShadowAtlasTile& tile) override;
+	virtual bool HasShadowAtlasStaticLayer() const override { return m_ShadowAtlasStaticLayerTrackerID != MEMORY_TRACKER_INVALID_ID; }
+	virtual void CreateShadowAtlasStaticLayer() override;
+	virtual void ReleaseShadowAtlasStaticLayer() override;
+
+	virtual void DispatchLightClustering(uint32_t sceneTableCopyIndex) override;
+	virtual void ReadBackLightClusters(LightClusterLists& outLists) override;
+	virtual void ResolveTemporalAA(bool enableTAA) override;
+	virtual void PostProcess(DebugShowTextureMode debugShowTextureMode) override;
+
+	UploadQueue& GetUploadQueue() { return *m_UploadQueue; }
+	const HeadlessBackendStatistics& GetStatistics() const { return m_Stats; }
+
+private:
+	HeadlessResource* CreateResource(std::size_t byteSize, const std::string& debugName, GPUMemoryCategory memoryCategory);
+	void TrackRenderTargets();
+	void UntrackRenderTargets();
+	uint64_t Execute(const HeadlessCommandList& commandList);
+	void ExecuteLightClustering(uint32_t sceneTableCopyIndex);
+
+private:
+	std::deque<std::unique_ptr<HeadlessResource>> m_Resources;
+	std::unique_ptr<UploadQueue> m_UploadQueue;
+	HeadlessBackendStatistics m_Stats;
+
+	std::unique_ptr<GPUProfiler> m_GPUProfiler;
+	// Owned by the GPU profiler
+	HeadlessGPUQuerySource* m_GPUQuerySource = nullptr;
+	uint32_t m_FrameIndex = HEADLESS_FRAMES_IN_FLIGHT - 1;
+
+	HeadlessCommandList m_CommandList;
+	HeadlessResource* m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_NUM_TYPES)] = {};
+	std::size_t m_NumInstanceTableEntries = 0;
+
+	// Render targets at the render resolution, the shadow atlas and its static layer
+	Resolution m_RenderResolution;
+	uint32_t m_ShadowAtlasResolution = 0;
+	std::vector<uint32_t> m_RenderTargetTrackerIDs;
+	uint32_t m_ShadowAtlasStaticLayerTrackerID = MEMORY_TRACKER_INVALID_ID;
+
+	// Index 0 of the bindless texture table is the shadow atlas
+	uint32_t m_NextTextureIndex = 1;
+
+};
+
+/*
+
+	Stands in for DXC on machines without it, so the shader cache can be exercised by the headless benchmark.
+	The bytecode is a hash of the compiled sources followed by the main file, the reflection lists the lines that bind registers.
+	Compilation fails like it would with DXC when the entry point is missing or an include cannot be found,
+	and takes compileTime milliseconds, so batches behave like they do with a real compiler.
+
+*/
+class HeadlessShaderCompiler : public ShaderCompiler
+{
+public:
+	HeadlessShaderCompiler(float compileTime = 0.0f);
+
+	virtual Hash128 GetVersionHash() const override;
+	virtual bool Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages) override;
+
+private:
+	float m_CompileTime = 0.0f;
+
+};
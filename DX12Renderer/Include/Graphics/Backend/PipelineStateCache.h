@@ -0,0 +1,115 @@
+#pragma once
+#include "Util/Hash.h"
+#include "Util/JobSystem.h"
+
+static constexpr uint32_t PIPELINE_STATE_CACHE_INVALID_ID = std::numeric_limits<uint32_t>::max();
+
+enum class PipelineStateStatus : uint32_t
+{
+	PIPELINE_STATE_STATUS_PENDING,
+	PIPELINE_STATE_STATUS_READY,
+	PIPELINE_STATE_STATUS_FAILED
+};
+
+/*
+
+	Builds the key of a pipeline state description field by field.
+	Pointers are never hashed, callers hash what they point to (bytecode, semantic names, root signature blobs),
+	so the same description gives the same key in every run and keys can name entries of a pipeline library on disk.
+	Structs with padding have to be added member by member, their padding bytes are not guaranteed to be zero.
+
+*/
+class PipelineStateHasher
+{
+public:
+	void AddBytes(const void* data, std::size_t byteSize);
+	void AddString(const char* string);
+	void AddHash(const Hash128& hash);
+
+	template<typename T>
+	void Add(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value, "Only values without pointers can be added to a pipeline state hash");
+		AddBytes(&value, sizeof(T));
+	}
+
+	Hash128 GetHash() const { return m_Hash; }
+
+private:
+	Hash128 m_Hash;
+
+};
+
+struct PipelineStateCacheStatistics
+{
+	uint32_t NumRequests = 0;
+	// Requests whose key was already requested before, they share the pipeline state of the first request
+	uint32_t NumDeduplicated = 0;
+	uint32_t NumCreated = 0;
+	uint32_t NumPending = 0;
+	uint32_t NumFailed = 0;
+
+	// Summed over all threads
+	float CreationTime = 0.0f;
+};
+
+/*
+
+	Deduplicates pipeline states by the hash of their full description and creates them on the job system.
+	The cache only sees opaque pipeline state objects, the create function of a request builds one from its description
+	and returns nullptr on failure, the release function is called for every created pipeline state when the cache is destroyed.
+	Requests return right away, GetPipelineState returns nullptr until the pipeline state is created, so draws that need it
+	can be skipped, WaitForPipelineState blocks for the ones that cannot be skipped. Requests are made from one thread.
+
+*/
+class PipelineStateCache
+{
+public:
+	using CreateFunction = std::function<void*()>;
+	using ReleaseFunction = std::function<void(void*)>;
+
+public:
+	PipelineStateCache(ReleaseFunction release);
+	~PipelineStateCache();
+
+	// The create function is only called for the first request of a key, requests of the same key return the same ID
+	uint32_t Request(const Hash128& key, const std::string& name, CreateFunction create);
+
+	PipelineStateStatus GetStatus(uint32_t id) const;
+	// Never blocks, nullptr while the pipeline state is pending or when it failed
+	void* GetPipelineState(uint32_t id) const;
+	void* WaitForPipelineState(uint32_t id);
+	void WaitForAll();
+
+	const std::string& GetName(uint32_t id) const;
+	const Hash128& GetKey(uint32_t id) const;
+	uint32_t GetNumPipelineStates() const;
+
+	PipelineStateCacheStatistics GetStatistics() const;
+
+private:
+	struct Entry
+	{
+		Hash128 Key;
+		std::string Name;
+		void* PipelineState = nullptr;
+		std::atomic<PipelineStateStatus> Status = PipelineStateStatus::PIPELINE_STATE_STATUS_PENDING;
+		mutable JobCounter Counter;
+	};
+
+	const Entry& GetEntry(uint32_t id) const;
+
+private:
+	ReleaseFunction m_Release;
+
+	// A deque keeps the entries in place while jobs write to them and new requests are appended
+	std::deque<Entry> m_Entries;
+	std::unordered_map<Hash128, uint32_t, Hash128Hasher> m_KeyToID;
+	mutable std::mutex m_Mutex;
+
+	std::atomic<uint32_t> m_NumDeduplicated = 0;
+	std::atomic<uint32_t> m_NumCreated = 0;
+	std::atomic<uint32_t> m_NumFailed = 0;
+	std::atomic<uint64_t> m_CreationTimeNanoseconds = 0;
+
+};
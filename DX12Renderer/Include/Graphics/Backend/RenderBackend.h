@@ -1,68 +1,120 @@
 #pragma once
-#include "Graphics/Backend/DescriptorAllocation.h"
-#include "Graphics/Buffer.h";
+#include "Graphics/RenderAPI.h"
+#include "Graphics/ShadowAtlas.h"
 
-class SwapChain;
-class DescriptorHeap;
-class CommandQueue;
-class CommandList;
-class Texture;
+class GPUProfiler;
+struct RenderSettings;
+struct LightClusterLists;
+enum class DebugShowTextureMode : uint32_t;
 
-struct TimestampQuery
+enum RenderPassType : uint32_t
 {
-	void ReadFromBuffer(const Buffer& queryResultBuffer)
-	{
-		BeginQueryTimestamp = queryResultBuffer.ReadBackBytes<uint64_t>(sizeof(uint64_t), StartIndex * sizeof(uint64_t));
-		EndQueryTimestamp = queryResultBuffer.ReadBackBytes<uint64_t>(sizeof(uint64_t), (StartIndex + 1) * sizeof(uint64_t));
-	}
-
-	uint64_t GetTicks()
-	{
-		return (EndQueryTimestamp - BeginQueryTimestamp);
-	}
+	SHADOW_MAPPING,
+	SHADOW_MAPPING_MASKED,
+	SHADOW_COMPOSE,
+	DEPTH_PREPASS,
+	DEPTH_PREPASS_MASKED,
+	LIGHTING,
+	LIGHTING_TRANSPARENT,
+	NUM_RENDER_PASSES
+};
 
-	uint32_t StartIndex = 0;
-	uint32_t NumQueries = 0;
+// Buffers the passes bind, created by the renderer with its own sizes and owned by the backend
+enum class RenderBufferType : uint32_t
+{
+	RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS,
+	RENDER_BUFFER_TYPE_SCENE_DATA,
+	RENDER_BUFFER_TYPE_MESH_INSTANCES,
+	RENDER_BUFFER_TYPE_MATERIALS,
+	RENDER_BUFFER_TYPE_LIGHTS,
+	RENDER_BUFFER_TYPE_LIGHT_CLUSTERS,
+	RENDER_BUFFER_TYPE_LIGHT_SPHERES,
+	RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS,
+	RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES,
+	RENDER_BUFFER_TYPE_INSTANCE_LIGHT_INDICES,
+	RENDER_BUFFER_TYPE_NUM_TYPES
+};
 
-	uint64_t BeginQueryTimestamp = 0;
-	uint64_t EndQueryTimestamp = 0;
+// The shadow atlas, and the depth of the static casters of every tile when shadow caching is enabled
+enum class ShadowAtlasLayer : uint32_t
+{
+	SHADOW_ATLAS_LAYER_DYNAMIC,
+	SHADOW_ATLAS_LAYER_STATIC
 };
 
-namespace RenderBackend
+/*
+
+	Everything the renderer needs from a graphics API. The renderer decides what is drawn and in which order,
+	the backend owns the render targets, passes and pass buffers and knows how a pass is bound.
+	Commands are recorded into the current command list of the backend, between BeginCommandList and ExecuteCommandList.
+	Buffers and textures are created from their descs and passed around as opaque pointers, which only the backend interprets.
+	The renderer runs on the D3D12 backend in the application, and on the headless backend in the benchmark and tests.
+
+*/
+class RenderBackend
 {
+public:
+	virtual ~RenderBackend() = default;
+
+	// Waits for the oldest frame in flight, copies the velocity of the last frame and clears the render targets
+	virtual void BeginFrame() = 0;
+	// Resolves the final output to the back buffer and presents it
+	virtual void EndFrame() = 0;
+	// Waits until the GPU and the uploads are idle
+	virtual void Flush() = 0;
+	virtual void Resize(uint32_t width, uint32_t height) = 0;
+	virtual void SetVSync(bool vSync) = 0;
+	// Frame in flight that is recorded, the copy of the per frame data the GPU reads
+	virtual uint32_t GetBackBufferIndex() const = 0;
+	virtual GPUProfiler& GetGPUProfiler() = 0;
+
+	virtual void CreateRenderPasses(const RenderSettings& settings) = 0;
+	virtual void CreateRenderTargets(const RenderSettings& settings) = 0;
+	// Pipeline states are created on the job system, nothing is drawn with a pass before all of them are ready
+	virtual bool ArePipelineStatesReady() const = 0;
+	virtual void CreateRenderBuffer(RenderBufferType type, const BufferDesc& desc) = 0;
+	virtual void WriteRenderBuffer(RenderBufferType type, const void* data, std::size_t byteSize, std::size_t byteOffset = 0) = 0;
 
-	void Initialize(HWND hWnd, uint32_t width, uint32_t height);
-	void BeginFrame();
-	void OnImGuiRender();
-	void EndFrame();
-	void Finalize();
-	void CreateBuffer(ComPtr<ID3D12Resource>& d3d12Resource, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& bufferDesc, D3D12_RESOURCE_STATES initialState);
-	void CreateTexture(ComPtr<ID3D12Resource>& d3d12Resource, const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue);
-	void UploadBufferData(Buffer& destBuffer, const void* bufferData);
-	void UploadBufferDataRegion(Buffer& destBuffer, std::size_t destOffset, std::size_t numBytes);
-	void UploadTextureData(Texture& destTexture, const void* textureData);
-	void GenerateMips(Texture& texture);
+	// Data of the desc is uploaded in the background, the resource is not ready before the upload completed
+	virtual void* CreateBuffer(const BufferDesc& desc) = 0;
+	virtual void* CreateTexture(const TextureDesc& desc) = 0;
+	// Waits for uploads to the resource that are still in flight, the GPU must be done with it
+	virtual void ReleaseResource(void* resource) = 0;
+	virtual bool IsResourceReady(void* resource) const = 0;
+	// Index of the texture in the bindless texture table
+	virtual uint32_t GetTextureIndex(void* texture) const = 0;
+	virtual uint32_t GetShadowAtlasIndex() const = 0;
 
-	ID3D12QueryHeap* GetD3D12TimestampQueryHeap();
-	const Buffer& GetQueryReadbackBuffer(uint32_t backBufferIndex);
-	void TrackTimestampQueryResult(const std::string& name, const TimestampQuery& timestampQuery, uint32_t backBufferIndex);
-	uint32_t GetMaxQueriesPerFrame();
-	uint32_t GetNextQueryIndex(uint32_t backBufferIndex);
+	virtual void BeginCommandList() = 0;
+	virtual void ExecuteCommandList() = 0;
+	virtual void BeginGPUZone(uint32_t zoneID) = 0;
+	virtual void EndGPUZone() = 0;
 
-	void Resize(uint32_t width, uint32_t height);
-	void Flush();
-	void SetVSync(bool vSync);
+	// Binds the pass with its targets and buffers, and the copies of the instance and material tables of the scene table copy index
+	virtual void BindRenderPass(RenderPassType pass, uint32_t sceneTableCopyIndex) = 0;
+	// Binds a shader permutation variant of the bound pass, passes are bound with variant 0
+	virtual void SetPipelineVariant(RenderPassType pass, uint32_t variant) = 0;
+	// View projection of the shadow mapping passes
+	virtual void SetViewProjection(const glm::mat4& viewProjection) = 0;
+	// Attribute buffer is nullptr for depth-only draws that only read positions, the instance is an entry of the bound instance table
+	virtual void DrawMesh(void* positionBuffer, void* attributeBuffer, void* indexBuffer, uint32_t numIndices, uint32_t instance) = 0;
 
-	IDXGIAdapter4* GetDXGIAdapter();
-	ID3D12Device2* GetD3D12Device();
-	SwapChain& GetSwapChain();
-	ID3D12PipelineState* GetMipGenPSO();
-	ID3D12RootSignature* GetMipGenRootSig();
-	DescriptorAllocation AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors = 1);
-	DescriptorHeap& GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type);
+	// Transitions a layer for rendering, the static layer exists while shadow caching is enabled
+	virtual void BeginShadowAtlasLayer(ShadowAtlasLayer layer) = 0;
+	virtual void ClearShadowAtlasTiles(ShadowAtlasLayer layer, const std::vector<ShadowAtlasTile>& tiles) = 0;
+	virtual void SetShadowAtlasTile(ShadowAtlasLayer layer, const ShadowAtlasTile& tile) = 0;
+	// Copies the static layer of the tile into the shadow atlas, with the shadow compose pass bound
+	virtual void ComposeShadowAtlasTile(const ShadowAtlasTile& tile) = 0;
+	virtual bool HasShadowAtlasStaticLayer() const = 0;
+	virtual void CreateShadowAtlasStaticLayer() = 0;
+	virtual void ReleaseShadowAtlasStaticLayer() = 0;
 
-	std::shared_ptr<CommandList> GetCommandList(D3D12_COMMAND_LIST_TYPE type);
-	void ExecuteCommandList(std::shared_ptr<CommandList> commandList);
-	void ExecuteCommandListAndWait(std::shared_ptr<CommandList> commandList);
+	// Builds the cluster light lists from the light cluster and light sphere buffer copies of the frame
+	virtual void DispatchLightClustering(uint32_t sceneTableCopyIndex) = 0;
+	// Executes the current command list and waits for the cluster light lists, this stalls the frame and is only meant for debugging
+	virtual void ReadBackLightClusters(LightClusterLists& outLists) = 0;
+	// Resolves the lighting output into the TAA history, or copies it over if TAA is disabled
+	virtual void ResolveTemporalAA(bool enableTAA) = 0;
+	virtual void PostProcess(DebugShowTextureMode debugShowTextureMode) = 0;
 
 };
@@ -20,6 +20,7 @@ private:
 	void* m_CPUPtr = nullptr;
 
 	std::size_t m_TotalByteSize = 0;
+	uint32_t m_MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
 	std::size_t m_CurrentByteOffset = 0;
 
 };
@@ -0,0 +1,167 @@
+#pragma once
+
+struct UploadTicket
+{
+	// 0 is never handed out, resources without an upload are always complete
+	uint64_t Value = 0;
+};
+
+enum class UploadRequestType : uint32_t
+{
+	UPLOAD_REQUEST_TYPE_BUFFER,
+	UPLOAD_REQUEST_TYPE_TEXTURE
+};
+
+struct UploadRequest
+{
+	UploadRequestType Type = UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER;
+	UploadTicket Ticket;
+
+	// Buffer or texture that is written to, only interpreted by the backend
+	void* Destination = nullptr;
+
+	// Copy of the source data, so callers can release theirs right after enqueueing
+	std::vector<uint8_t> Data;
+
+	// Textures are uploaded row by row, so large textures can be split across frames
+	std::size_t RowPitch = 0;
+	uint32_t NumRows = 0;
+
+	// Progress, in bytes for buffers and in rows for textures
+	std::size_t NextByte = 0;
+	uint32_t NextRow = 0;
+};
+
+struct UploadSlice
+{
+	std::size_t StagingOffset = 0;
+	std::size_t StagingRowPitch = 0;
+
+	// Buffers
+	std::size_t ByteOffset = 0;
+	std::size_t NumBytes = 0;
+
+	// Textures
+	uint32_t FirstRow = 0;
+	uint32_t NumRows = 0;
+};
+
+/*
+
+	The upload queue only schedules and batches uploads, the actual copies are recorded by a backend.
+	The renderer uses the D3D12 copy queue, the scheduling itself has no graphics API dependencies
+	and can be driven by a fake backend that records slices and completes fences manually.
+
+*/
+class UploadQueueBackend
+{
+public:
+	virtual ~UploadQueueBackend() = default;
+
+	virtual uint8_t* GetStagingMemory() = 0;
+	virtual std::size_t GetStagingByteSize() const = 0;
+	virtual std::size_t GetTextureRowPitchAlignment() const = 0;
+	virtual std::size_t GetTextureSliceAlignment() const = 0;
+
+	// Called from the upload worker thread
+	virtual void BeginBatch() = 0;
+	virtual void RecordCopy(const UploadRequest& request, const UploadSlice& slice) = 0;
+	virtual uint64_t SubmitBatch() = 0;
+
+	virtual uint64_t GetCompletedFenceValue() const = 0;
+	virtual void WaitForFenceValue(uint64_t fenceValue) = 0;
+
+	// Called from the thread that calls UploadQueue::ProcessCompletions, once the copies of a request are done
+	virtual void OnUploadComplete(UploadRequestType type, void* destination) = 0;
+};
+
+struct UploadQueueDesc
+{
+	std::size_t MaxBytesPerFrame = MEGABYTE(32);
+	std::size_t MaxBytesPerBatch = MEGABYTE(8);
+	std::size_t BufferAlignment = 16;
+};
+
+struct UploadQueueStatistics
+{
+	std::size_t NumPendingRequests = 0;
+	std::size_t NumPendingBytes = 0;
+	std::size_t BytesUploadedThisFrame = 0;
+	uint64_t NumBatchesSubmitted = 0;
+	uint64_t NumRequestsCompleted = 0;
+};
+
+class UploadQueue
+{
+public:
+	UploadQueue(std::unique_ptr<UploadQueueBackend> backend, const UploadQueueDesc& desc = UploadQueueDesc());
+	~UploadQueue();
+
+	UploadTicket UploadBuffer(void* destination, const void* data, std::size_t numBytes);
+	UploadTicket UploadTexture(void* destination, const void* data, std::size_t rowPitch, uint32_t numRows);
+
+	// Resets the per-frame upload budget and wakes up the worker
+	void BeginFrame();
+
+	// Runs completion callbacks for finished requests, has to be called from the render thread
+	void ProcessCompletions();
+
+	bool IsComplete(UploadTicket ticket) const;
+	void WaitForTicket(UploadTicket ticket);
+	void Flush();
+
+	UploadQueueStatistics GetStatistics() const;
+
+private:
+	UploadTicket Enqueue(UploadRequest&& request);
+
+	void WorkerLoop();
+	void ProcessBatch();
+	bool AllocateStaging(std::size_t byteSize, std::size_t align, std::size_t& outOffset);
+	void RetireStaging();
+
+	std::size_t RecordBufferSlice(UploadRequest& request, std::size_t budget);
+	std::size_t RecordTextureSlice(UploadRequest& request, std::size_t budget);
+	void RecordCopy(const UploadRequest& request, const UploadSlice& slice);
+	bool IsFinished(const UploadRequest& request) const;
+
+private:
+	struct CompletedUpload
+	{
+		UploadTicket Ticket;
+		UploadRequestType Type;
+		void* Destination;
+	};
+
+	struct InFlightBatch
+	{
+		uint64_t FenceValue = 0;
+		std::vector<CompletedUpload> CompletedUploads;
+	};
+
+	std::unique_ptr<UploadQueueBackend> m_Backend;
+	UploadQueueDesc m_Desc;
+
+	std::deque<UploadRequest> m_PendingRequests;
+	std::deque<InFlightBatch> m_InFlightBatches;
+	uint64_t m_NextTicket = 1;
+	std::size_t m_FrameBudgetRemaining = 0;
+	UploadQueueStatistics m_Stats;
+
+	// Staging ring, only touched by the worker thread
+	std::size_t m_StagingHead = 0;
+	std::size_t m_StagingUsed = 0;
+	std::size_t m_BatchStagingBytes = 0;
+	std::deque<std::pair<uint64_t, std::size_t>> m_StagingRetireQueue;
+	bool m_BatchOpen = false;
+
+	std::atomic<uint64_t> m_CompletedTicket = 0;
+	std::atomic<uint64_t> m_LastSubmittedFence = 0;
+	std::atomic<uint32_t> m_FlushRequests = 0;
+
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_WorkCV;
+	std::thread m_WorkerThread;
+	bool m_Stop = false;
+
+};
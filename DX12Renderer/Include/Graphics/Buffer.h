@@ -24,6 +24,11 @@ public:
 		return data;
 	}
 
+	void ReadBackData(void* dest, std::size_t numBytes, std::size_t byteOffset = 0) const
+	{
+		memcpy(dest, static_cast<unsigned char*>(m_CPUPtr) + byteOffset, numBytes);
+	}
+
 	BufferDesc& GetBufferDesc() { return m_BufferDesc; }
 	const BufferDesc& GetBufferDesc() const { return m_BufferDesc; }
 
@@ -1,4 +1,5 @@
 #pragma once
+#include "Graphics/Backend/PipelineStateCache.h"
 
 class Shader;
 
@@ -18,8 +19,10 @@ class ComputePass
 public:
 	ComputePass(const std::string& name, const ComputePassDesc& desc);
 
-	ComPtr<ID3D12PipelineState> GetD3D12PipelineState() const { return m_d3d12PipelineState; }
+	// nullptr until the pipeline state was created on the job system, dispatches of the pass are skipped until then
+	ID3D12PipelineState* GetD3D12PipelineState() const;
 	ComPtr<ID3D12RootSignature> GetD3D12RootSignature() const { return m_d3d12RootSignature; }
+	bool IsReady() const { return GetD3D12PipelineState() != nullptr; }
 
 	const ComputePassDesc& GetDesc() const { return m_Desc; }
 
@@ -31,8 +34,9 @@ private:
 	ComputePassDesc m_Desc;
 	std::string m_Name;
 
-	ComPtr<ID3D12PipelineState> m_d3d12PipelineState;
+	uint32_t m_PipelineStateID = PIPELINE_STATE_CACHE_INVALID_ID;
 	ComPtr<ID3D12RootSignature> m_d3d12RootSignature;
+	Hash128 m_RootSignatureHash;
 
 	std::unique_ptr<Shader> m_ComputeShader;
 
@@ -0,0 +1,196 @@
+#pragma once
+#include "Graphics/RenderAPI.h"
+#include "Util/MappedFile.h"
+
+#include <fstream>
+
+/*
+
+	Captured renderer workload, everything Renderer::Submit and Renderer::BeginScene receive for one frame.
+	Meshes and materials are referenced by capture IDs instead of render resource handles, so a capture
+	can be replayed by a process that never loaded the original scene.
+
+*/
+constexpr uint32_t FRAME_CAPTURE_INVALID_ID = ~0u;
+
+enum class CapturedLightType : uint32_t
+{
+	CAPTURED_LIGHT_TYPE_DIRECTIONAL,
+	CAPTURED_LIGHT_TYPE_SPOT,
+	CAPTURED_LIGHT_TYPE_POINT
+};
+
+struct CapturedView
+{
+	glm::mat4 View = glm::identity<glm::mat4>();
+	glm::mat4 Projection = glm::identity<glm::mat4>();
+	float Near = 0.1f;
+	float Far = 1000.0f;
+	bool FrustumCulling = true;
+};
+
+struct CapturedMeshLOD
+{
+	uint32_t NumIndices = 0;
+	float Error = 0.0f;
+};
+
+struct CapturedMesh
+{
+	uint32_t NumVertices = 0;
+	uint32_t NumIndices = 0;
+	BoundingBox BB;
+	uint32_t Material = FRAME_CAPTURE_INVALID_ID;
+	std::vector<CapturedMeshLOD> LODs;
+};
+
+struct CapturedMaterial
+{
+	TransparencyMode Transparency = TransparencyMode::OPAQUE;
+	float AlphaCutoff = 0.5f;
+	float Metalness = 0.0f;
+	float Roughness = 0.3f;
+	bool HasAlbedoTexture = false;
+	bool HasNormalTexture = false;
+	bool HasMetallicRoughnessTexture = false;
+};
+
+struct CapturedMeshSubmission
+{
+	uint32_t Mesh = FRAME_CAPTURE_INVALID_ID;
+	glm::mat4 Transform = glm::identity<glm::mat4>();
+	glm::mat4 PrevFrameTransform = glm::identity<glm::mat4>();
+};
+
+struct CapturedLight
+{
+	CapturedLightType Type = CapturedLightType::CAPTURED_LIGHT_TYPE_DIRECTIONAL;
+	glm::vec3 Position = glm::vec3(0.0f);
+	glm::vec3 Direction = glm::vec3(0.0f);
+	glm::vec3 Color = glm::vec3(1.0f);
+	glm::vec3 Attenuation = glm::vec3(0.0f);
+	float Range = 0.0f;
+	float InnerConeAngle = 0.0f;
+	float OuterConeAngle = 0.0f;
+
+	// One view per shadow map face, point lights have six
+	std::vector<CapturedView> ShadowViews;
+};
+
+struct CapturedSettings
+{
+	uint32_t RenderWidth = 1280;
+	uint32_t RenderHeight = 720;
+	uint32_t ShadowMapResolution = 2048;
+
+	bool EnableMeshLODs = true;
+	float LODErrorThreshold = 1.0f;
+	float ShadowLODErrorThreshold = 4.0f;
+};
+
+struct CapturedFrame
+{
+	void Reset()
+	{
+		MeshSubmissions.clear();
+		Lights.clear();
+	}
+
+	CapturedSettings Settings;
+	CapturedView SceneView;
+	std::vector<CapturedMeshSubmission> MeshSubmissions;
+	std::vector<CapturedLight> Lights;
+};
+
+enum class FrameCaptureRecordType : uint32_t
+{
+	FRAME_CAPTURE_RECORD_TYPE_MATERIAL,
+	FRAME_CAPTURE_RECORD_TYPE_MESH,
+	FRAME_CAPTURE_RECORD_TYPE_FRAME
+};
+
+/*
+
+	Writes a capture as a header followed by records, every record is a type and byte size followed by its payload.
+	Meshes and materials are written once, the first time they are added, frames only reference their IDs.
+	Previous frame transforms are only stored for submissions that moved, which keeps static scenes at one matrix per instance.
+
+*/
+class FrameCaptureWriter
+{
+public:
+	FrameCaptureWriter(const std::string& filepath);
+	~FrameCaptureWriter();
+
+	FrameCaptureWriter(const FrameCaptureWriter& other) = delete;
+	FrameCaptureWriter& operator=(const FrameCaptureWriter& other) = delete;
+
+	bool IsValid() const { return m_File.is_open() && m_File.good(); }
+
+	// Keys identify meshes and materials of the capturing process, e.g. render resource handles, and are never written
+	uint32_t FindMaterial(uint64_t key) const;
+	uint32_t AddMaterial(uint64_t key, const CapturedMaterial& material);
+	uint32_t FindMesh(uint64_t key) const;
+	uint32_t AddMesh(uint64_t key, const CapturedMesh& mesh);
+
+	void WriteFrame(const CapturedFrame& frame);
+
+	uint32_t GetNumFrames() const { return m_NumFrames; }
+	std::size_t GetByteSize() const { return m_ByteSize; }
+
+private:
+	void WriteRecord(FrameCaptureRecordType type);
+
+	template<typename T>
+	void Write(const T& value)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+		m_RecordData.insert(m_RecordData.end(), bytes, bytes + sizeof(T));
+	}
+
+	void WriteView(const CapturedView& view);
+
+private:
+	std::ofstream m_File;
+	TrackedVector<uint8_t, MEMORY_TAG_RENDER> m_RecordData;
+
+	std::unordered_map<uint64_t, uint32_t> m_MaterialIDs;
+	std::unordered_map<uint64_t, uint32_t> m_MeshIDs;
+
+	uint32_t m_NumFrames = 0;
+	std::size_t m_ByteSize = 0;
+
+};
+
+/*
+
+	Reads a capture written by FrameCaptureWriter from a memory mapped file.
+	All mesh and material records are parsed up front, frames are decoded on demand so replays only touch one frame at a time.
+
+*/
+class FrameCaptureReader
+{
+public:
+	FrameCaptureReader(const std::string& filepath);
+
+	bool IsValid() const { return m_IsValid; }
+
+	const std::vector<CapturedMaterial>& GetMaterials() const { return m_Materials; }
+	const std::vector<CapturedMesh>& GetMeshes() const { return m_Meshes; }
+	uint32_t GetNumFrames() const { return static_cast<uint32_t>(m_FrameOffsets.size()); }
+
+	// Returns false if the frame record is truncated or references meshes that were never defined
+	bool ReadFrame(uint32_t frameIndex, CapturedFrame& frame) const;
+
+private:
+	bool ParseRecords();
+
+private:
+	MappedFile m_File;
+	bool m_IsValid = false;
+
+	std::vector<CapturedMaterial> m_Materials;
+	std::vector<CapturedMesh> m_Meshes;
+	std::vector<std::size_t> m_FrameOffsets;
+
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+static constexpr uint32_t GPU_SCENE_TABLE_INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+
+// Bytes of a table that have to be copied into one of its GPU copies, the offset is the same in the CPU data and the copy
+struct GPUSceneTableUpload
+{
+	std::size_t ByteOffset = 0;
+	std::size_t ByteSize = 0;
+};
+
+struct GPUSceneTableStatistics
+{
+	uint32_t NumEntries = 0;
+	// Entries added, written with different data, and released because they were not updated this frame
+	uint32_t NumNewEntries = 0;
+	uint32_t NumChangedEntries = 0;
+	uint32_t NumReleasedEntries = 0;
+	// Copies made into the GPU copy of this frame, ranges of consecutive slots are merged into one
+	uint32_t NumUploadRanges = 0;
+	std::size_t NumUploadedBytes = 0;
+};
+
+/*
+
+	Persistent table of fixed size GPU elements (mesh instances, materials), every entry keeps its slot for as long as it is
+	updated every frame, so draws and other entries can refer to it by slot. Entries that were not updated in a frame are released.
+	The GPU reads one of NumCopies copies of the table per frame (one per frame in flight), every slot and copy has a version,
+	and a copy only receives the slots that changed since it was last written. A static scene uploads nothing after the first frames.
+
+*/
+class GPUSceneTable
+{
+public:
+	GPUSceneTable(uint32_t elementSize, uint32_t capacity, uint32_t numCopies);
+
+	void BeginFrame();
+	// Writes the data of the entry with the key and returns its slot, the slot is only marked as changed if the data differs
+	uint32_t Update(uint64_t key, const void* data);
+	// Releases the entries that were not updated this frame, and returns the ranges that copy copyIndex is missing
+	void EndFrame(uint32_t copyIndex, std::vector<GPUSceneTableUpload>& outUploads);
+
+	uint32_t GetSlot(uint64_t key) const;
+	const unsigned char* GetData() const { return m_Data.data(); }
+	uint32_t GetElementSize() const { return m_ElementSize; }
+	uint32_t GetCapacity() const { return m_Capacity; }
+	const GPUSceneTableStatistics& GetStatistics() const { return m_Stats; }
+
+private:
+	struct SlotState
+	{
+		uint64_t Key = 0;
+		// Version of the frame the data was last written in
+		uint64_t Version = 0;
+		bool IsAllocated = false;
+		bool IsUpdated = false;
+	};
+
+private:
+	uint32_t m_ElementSize = 0;
+	uint32_t m_Capacity = 0;
+
+	TrackedVector<unsigned char, MEMORY_TAG_RENDER> m_Data;
+	std::vector<SlotState> m_SlotStates;
+	std::vector<uint32_t> m_FreeSlots;
+	std::unordered_map<uint64_t, uint32_t> m_KeyToSlot;
+	// Slots below it were allocated at some point, the ones above were never used and are not scanned
+	uint32_t m_NumUsedSlots = 0;
+
+	uint64_t m_Version = 0;
+	// Version each GPU copy was last written in
+	std::vector<uint64_t> m_CopyVersions;
+
+	GPUSceneTableStatistics m_Stats;
+
+};
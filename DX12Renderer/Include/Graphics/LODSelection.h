@@ -0,0 +1,47 @@
+#pragma once
+#include "Scene/BoundingVolume.h"
+
+/*
+
+	Screen-space error based LOD selection, shared by the renderer and the headless benchmark.
+	Only depends on matrices and bounds, so the same decisions are made with and without a GPU.
+
+*/
+namespace LODSelection
+{
+
+	// Returns how many pixels one object space unit covers at the closest point of the instance bounding sphere, 0 if it is behind the camera
+	// Projections with a flipped y axis (like the directional light shadow projection) are handled as well
+	inline float CalculatePixelsPerUnit(const glm::mat4& view, const glm::mat4& projection, float viewHeight, const BoundingBox& bb, const glm::mat4& transform)
+	{
+		// Object space errors scale with the largest axis scale of the instance transform
+		float maxScale = std::max({ glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2])) });
+
+		glm::vec3 center = transform * glm::vec4((bb.Min + bb.Max) * 0.5f, 1.0f);
+		float radius = glm::length(bb.Max - bb.Min) * 0.5f * maxScale;
+
+		// Clip space w at the closest point of the bounding sphere, this is the view depth for perspective projections and 1 for orthographic ones
+		glm::vec4 viewCenter = view * glm::vec4(center, 1.0f);
+		float w = projection[2][3] * (viewCenter.z - radius) + projection[3][3];
+
+		if (w <= 0.0f)
+			return 0.0f;
+
+		return maxScale * std::abs(projection[1][1]) * 0.5f * viewHeight / w;
+	}
+
+	// LOD 0 is the full detail mesh, LOD n refers to lods[n - 1], every element needs an object space Error
+	template<typename TLOD>
+	inline uint32_t SelectLOD(const std::vector<TLOD>& lods, float pixelsPerUnit, float errorThreshold)
+	{
+		if (pixelsPerUnit <= 0.0f)
+			return 0;
+
+		uint32_t lod = 0;
+		while (lod < lods.size() && lods[lod].Error * pixelsPerUnit <= errorThreshold)
+			lod++;
+
+		return lod;
+	}
+
+};
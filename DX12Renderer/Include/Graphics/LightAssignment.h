@@ -0,0 +1,56 @@
+#pragma once
+#include "Scene/BoundingVolume.h"
+
+/*
+
+	Spot and pointlights in structure of arrays layout, so the assignment kernel can test several lights at once.
+	Pointlights have a zero direction and cone angle, which makes the cone test pass for them without a branch.
+
+*/
+struct LightAssignmentLights
+{
+	void Reset()
+	{
+		NumLights = 0;
+		NumSpotLights = 0;
+
+		for (std::vector<float>* values : { &PositionX, &PositionY, &PositionZ, &Range, &DirectionX, &DirectionY, &DirectionZ, &CosConeAngle, &SinConeAngle })
+			values->clear();
+	}
+
+	uint32_t NumLights = 0;
+	uint32_t NumSpotLights = 0;
+
+	std::vector<float> PositionX;
+	std::vector<float> PositionY;
+	std::vector<float> PositionZ;
+	std::vector<float> Range;
+	std::vector<float> DirectionX;
+	std::vector<float> DirectionY;
+	std::vector<float> DirectionZ;
+	std::vector<float> CosConeAngle;
+	std::vector<float> SinConeAngle;
+};
+
+/*
+
+	Per instance light assignment, finds the spot and pointlights whose range sphere and cone overlap an instance bounding box.
+	Light indices follow the light clustering order: spotlights first, pointlights start at NumSpotLights.
+	The SIMD kernel (SSE2 where available) and the scalar reference evaluate the same operations, so both return the same lists.
+
+*/
+namespace LightAssignment
+{
+
+	// Spotlights have to be added before any pointlight, cosOuterConeAngle is the cosine like in SpotLightData
+	void AddSpotLight(LightAssignmentLights& lights, const glm::vec3& position, const glm::vec3& direction, float range, float cosOuterConeAngle);
+	void AddPointLight(LightAssignmentLights& lights, const glm::vec3& position, float range);
+
+	// World space box around all eight transformed corners
+	BoundingBox TransformBoundingBox(const BoundingBox& bb, const glm::mat4& transform);
+
+	// Appends the indices of all lights overlapping the box in increasing order and returns how many were appended
+	uint32_t AssignLights(const LightAssignmentLights& lights, const BoundingBox& worldBB, std::vector<uint32_t>& outLightIndices);
+	uint32_t AssignLightsScalar(const LightAssignmentLights& lights, const BoundingBox& worldBB, std::vector<uint32_t>& outLightIndices);
+
+};
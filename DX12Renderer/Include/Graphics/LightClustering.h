@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+
+	Cluster grid constants, these have to match LightClustering.hlsl
+
+*/
+constexpr uint32_t LIGHT_CLUSTER_GRID_SIZE_X = 16;
+constexpr uint32_t LIGHT_CLUSTER_GRID_SIZE_Y = 9;
+constexpr uint32_t LIGHT_CLUSTER_GRID_SIZE_Z = 24;
+constexpr uint32_t LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y * LIGHT_CLUSTER_GRID_SIZE_Z;
+constexpr uint32_t LIGHT_CLUSTER_MAX_LIGHTS = 64;
+
+/*
+
+	Constant buffer layout of the cluster grid (ClusterCBData in LightClustering.hlsl).
+	Tile and slice boundaries are calculated once on the CPU, so the cluster bounds of the CPU and GPU builds only need
+	multiplications, which are exact in both, and never divisions or transcendental functions, which are not.
+
+*/
+struct LightClusterGridData
+{
+	glm::mat4 View = glm::identity<glm::mat4>();
+
+	glm::vec2 ScreenSize = glm::vec2(1.0f);
+	// Used to find the slice of a view depth in the lighting shader
+	float SliceScale = 0.0f;
+	float SliceBias = 0.0f;
+
+	uint32_t NumSpotLights = 0;
+	uint32_t NumPointLights = 0;
+	glm::uvec2 Padding = glm::uvec2(0);
+
+	// View space x and y per unit of depth for every tile boundary, and the view depth of every slice boundary, four per register
+	glm::vec4 TileSlopesX[(LIGHT_CLUSTER_GRID_SIZE_X + 1 + 3) / 4];
+	glm::vec4 TileSlopesY[(LIGHT_CLUSTER_GRID_SIZE_Y + 1 + 3) / 4];
+	glm::vec4 SliceDepths[(LIGHT_CLUSTER_GRID_SIZE_Z + 1 + 3) / 4];
+};
+
+struct LightClusterStatistics
+{
+	uint32_t NumLights = 0;
+	uint32_t NumLightAssignments = 0;
+	uint32_t NumOccupiedClusters = 0;
+	uint32_t MaxLightsInCluster = 0;
+	// Lights that did not fit into a full cluster and are not shaded in it
+	uint32_t NumDroppedAssignments = 0;
+};
+
+/*
+
+	Per cluster light lists, every cluster owns LIGHT_CLUSTER_MAX_LIGHTS consecutive index slots.
+	LightCounts holds the number of overlapping lights, which can be larger than the number of slots, only the first ones are stored.
+	Indices below NumSpotLights refer to spotlights, the others to pointlights (index - NumSpotLights).
+	Slots are filled in light order without atomics, so the lists of the CPU and GPU builds can be compared directly.
+
+*/
+struct LightClusterLists
+{
+	std::vector<uint32_t> LightCounts;
+	std::vector<uint32_t> LightIndices;
+};
+
+/*
+
+	Clustered light culling, the view frustum is split into a froxel grid with exponential depth slices
+	and every light is assigned to the clusters its bounding sphere overlaps.
+	This is the CPU reference of the LightClustering_CS compute pass: both work on view space light spheres calculated here
+	and evaluate the bounds and overlap tests with the same operations in the same order (the shader marks them precise),
+	so for the same input the GPU produces bit-identical lists.
+
+*/
+namespace LightClustering
+{
+
+	// Near and far are the view depths of the first and last slice, the projection has to be a perspective one
+	LightClusterGridData MakeGridData(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane,
+		const glm::vec2& screenSize, uint32_t numSpotLights, uint32_t numPointLights);
+
+	// Bounding spheres in world space (xyz center, w radius), cosOuterConeAngle is the cosine like in SpotLightData
+	glm::vec4 GetPointLightBoundingSphere(const glm::vec3& position, float range);
+	glm::vec4 GetSpotLightBoundingSphere(const glm::vec3& position, const glm::vec3& direction, float range, float cosOuterConeAngle);
+
+	// Transforms world space spheres into view space, this is the data uploaded for the compute pass
+	void TransformSpheresToViewSpace(const LightClusterGridData& grid, const std::vector<glm::vec4>& worldSpheres, std::vector<glm::vec4>& viewSpheres);
+
+	void CalculateClusterBounds(const LightClusterGridData& grid, uint32_t clusterIndex, glm::vec3& outMin, glm::vec3& outMax);
+	uint32_t GetClusterIndex(const LightClusterGridData& grid, const glm::vec2& pixel, float viewDepth);
+
+	// Builds the lists of clusters [firstCluster, firstCluster + numClusters), lists must already be sized for all clusters
+	void BuildClusters(const LightClusterGridData& grid, const std::vector<glm::vec4>& viewSpheres, LightClusterLists& lists, uint32_t firstCluster, uint32_t numClusters);
+	// Builds all clusters, split over the job system
+	void BuildClusters(const LightClusterGridData& grid, const std::vector<glm::vec4>& viewSpheres, LightClusterLists& lists);
+
+	LightClusterStatistics GetStatistics(const LightClusterLists& lists, uint32_t numLights);
+
+	// Compares two builds, e.g. the CPU reference against a GPU readback, and returns the number of clusters that differ
+	uint32_t CompareClusters(const LightClusterLists& lhs, const LightClusterLists& rhs);
+
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include "Graphics/Texture.h"
+#include "Graphics/ShaderPermutation.h"
+#include "Graphics/Backend/PipelineStateCache.h"
 
 class FrameBuffer;
 class Shader;
@@ -15,6 +17,8 @@ struct RasterPassDesc
 	TextureDesc DepthAttachmentDesc;
 	
 	bool DepthEnabled = true;
+	// Passes that only test against the depth of earlier passes, like blended geometry, leave the depth untouched
+	bool DepthWriteEnabled = true;
 	D3D12_COMPARISON_FUNC DepthComparisonFunc = D3D12_COMPARISON_FUNC_GREATER;
 	int DepthBias = 0;
 	float SlopeScaledDepthBias = 0.0f;
@@ -25,6 +29,11 @@ struct RasterPassDesc
 
 	std::vector<CD3DX12_ROOT_PARAMETER1> RootParameters;
 	std::vector<D3D12_INPUT_ELEMENT_DESC> ShaderInputLayout;
+
+	// Defines of every shader of the pass, so passes can share shader files, the pixel shader variants add their own defines
+	std::vector<std::string> ShaderDefines;
+	// Variants of the pixel shader, every variant gets its own pipeline state, passes without variants leave it empty
+	ShaderPermutationManifest PixelShaderPermutations;
 };
 
 class RasterPass
@@ -32,8 +41,14 @@ class RasterPass
 public:
 	RasterPass(const std::string& name, const RasterPassDesc& desc);
 
-	ID3D12PipelineState* GetD3D12PipelineState() const { return m_d3d12PipelineState.Get(); }
+	// nullptr until the pipeline state was created on the job system, draws of the pass are skipped until then
+	ID3D12PipelineState* GetD3D12PipelineState(uint32_t variant = 0) const;
 	ID3D12RootSignature* GetD3D12RootSignature() const { return m_d3d12RootSignature.Get(); }
+	// The pipeline states of all variants were created
+	bool IsReady() const;
+
+	uint32_t SelectVariant(uint32_t drawFeatures) const { return m_Permutations.SelectVariant(drawFeatures); }
+	const ShaderPermutationSet& GetPermutations() const { return m_Permutations; }
 
 	const RasterPassDesc& GetDesc() const { return m_Desc; }
 
@@ -45,10 +60,12 @@ private:
 	RasterPassDesc m_Desc;
 	std::string m_Name;
 
-	ComPtr<ID3D12PipelineState> m_d3d12PipelineState;
+	ShaderPermutationSet m_Permutations;
+	std::vector<uint32_t> m_PipelineStateIDs;
 	ComPtr<ID3D12RootSignature> m_d3d12RootSignature;
+	Hash128 m_RootSignatureHash;
 
 	std::unique_ptr<Shader> m_VertexShader;
-	std::unique_ptr<Shader> m_PixelShader;
+	std::vector<std::unique_ptr<Shader>> m_PixelShaders;
 
 };
@@ -52,10 +52,26 @@ struct BufferDesc
 	std::size_t NumElements = 0;
 	std::size_t ElementSize = 0;
 	const void* DataPtr = nullptr;
+	// Other lets the buffer pick the category from its usage
+	GPUMemoryCategory MemoryCategory = GPU_MEMORY_CATEGORY_OTHER;
 
 	std::string DebugName = "Unnamed";
 };
 
+// Category a buffer is counted in by the memory tracker, every backend counts its buffers the same way
+inline GPUMemoryCategory GetBufferMemoryCategory(const BufferDesc& desc)
+{
+	if (desc.MemoryCategory != GPU_MEMORY_CATEGORY_OTHER)
+		return desc.MemoryCategory;
+
+	if (desc.Usage & BufferUsage::BUFFER_USAGE_VERTEX || desc.Usage & BufferUsage::BUFFER_USAGE_INDEX)
+		return GPU_MEMORY_CATEGORY_MESH_BUFFERS;
+	if (desc.Usage & BufferUsage::BUFFER_USAGE_CONSTANT || desc.Usage & BufferUsage::BUFFER_USAGE_UPLOAD || desc.Usage & BufferUsage::BUFFER_USAGE_READBACK)
+		return GPU_MEMORY_CATEGORY_UPLOAD;
+
+	return GPU_MEMORY_CATEGORY_OTHER;
+}
+
 enum class TextureUsage : uint32_t
 {
 	TEXTURE_USAGE_NONE = 0,
@@ -85,6 +101,25 @@ enum class TextureFormat : uint32_t
 	TEXTURE_FORMAT_DEPTH32
 };
 
+// Size of a single texel, every format is uncompressed so a row of texture data is its width times this size
+inline std::size_t GetTextureFormatByteSize(TextureFormat format)
+{
+	switch (format)
+	{
+	case TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM:
+	case TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB:
+	case TextureFormat::TEXTURE_FORMAT_RG16_FLOAT:
+	case TextureFormat::TEXTURE_FORMAT_DEPTH32:
+		return 4;
+	case TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT:
+		return 8;
+	case TextureFormat::TEXTURE_FORMAT_UNSPECIFIED:
+		break;
+	}
+
+	return 0;
+}
+
 enum class TextureDimension : uint32_t
 {
 	TEXTURE_DIMENSION_2D = 0,
@@ -108,21 +143,70 @@ struct TextureDesc
 	};
 
 	const void* DataPtr = nullptr;
+	// Other lets the texture pick the category from its usage
+	GPUMemoryCategory MemoryCategory = GPU_MEMORY_CATEGORY_OTHER;
 
 	std::string DebugName = "Unnamed";
 };
 
+inline GPUMemoryCategory GetTextureMemoryCategory(const TextureDesc& desc)
+{
+	if (desc.MemoryCategory != GPU_MEMORY_CATEGORY_OTHER)
+		return desc.MemoryCategory;
+
+	if (desc.Usage & TextureUsage::TEXTURE_USAGE_RENDER_TARGET || desc.Usage & TextureUsage::TEXTURE_USAGE_DEPTH)
+		return GPU_MEMORY_CATEGORY_RENDER_TARGETS;
+	if (desc.Usage & TextureUsage::TEXTURE_USAGE_READ)
+		return GPU_MEMORY_CATEGORY_MATERIAL_TEXTURES;
+
+	return GPU_MEMORY_CATEGORY_OTHER;
+}
+
+// Masked materials are opaque where the albedo alpha reaches their alpha cutoff and discarded elsewhere, transparent materials are blended
 enum TransparencyMode : uint32_t
 {
-	OPAQUE = 0, TRANSPARENT = 1,
-	NUM_ALPHA_MODES = 2
+	OPAQUE = 0, MASKED = 1, TRANSPARENT = 2,
+	NUM_ALPHA_MODES = 3
+};
+
+struct MeshLODDesc
+{
+	BufferDesc IndexBufferDesc;
+
+	// Optional, an already created buffer takes precedence over the buffer desc
+	RenderResourceHandle IndexBuffer = RENDER_RESOURCE_HANDLE_NULL;
+
+	// Object space error compared to the full detail mesh
+	float Error = 0.0f;
+};
+
+// Format of the position stream of meshes, 16 bit positions are relative to the bounds of their mesh
+enum class VertexPositionFormat : uint32_t
+{
+	VERTEX_POSITION_FORMAT_FLOAT3,
+	VERTEX_POSITION_FORMAT_UNORM16
 };
 
 struct MeshDesc
 {
-	BufferDesc VertexBufferDesc;
+	// Positions are a stream of their own, depth-only passes read nothing else, the other attributes are interleaved
+	BufferDesc PositionBufferDesc;
+	BufferDesc AttributeBufferDesc;
 	BufferDesc IndexBufferDesc;
 
+	// Optional, already created buffers take precedence over the buffer descs
+	RenderResourceHandle PositionBuffer;
+	RenderResourceHandle AttributeBuffer;
+	RenderResourceHandle IndexBuffer;
+
+	// Object space positions are the stored positions times the scale plus the offset, quantized positions are stored in [0, 1]
+	VertexPositionFormat PositionFormat = VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3;
+	glm::vec3 PositionScale = glm::vec3(1.0f);
+	glm::vec3 PositionOffset = glm::vec3(0.0f);
+
+	// Optional coarser levels of detail ordered from fine to coarse, they index into the same vertex streams
+	std::vector<MeshLODDesc> LODs;
+
 	RenderResourceHandle MaterialHandle;
 	BoundingBox BB;
 
@@ -135,10 +219,17 @@ struct MaterialDesc
 	TextureDesc NormalDesc;
 	TextureDesc MetallicRoughnessDesc;
 
+	// Optional, already created textures take precedence over the texture descs
+	RenderResourceHandle AlbedoTexture;
+	RenderResourceHandle NormalTexture;
+	RenderResourceHandle MetallicRoughnessTexture;
+
 	float Metalness;
 	float Roughness;
 
 	TransparencyMode Transparency;
+	// Only used by masked materials
+	float AlphaCutoff = 0.5f;
 
 	std::string DebugName;
 };
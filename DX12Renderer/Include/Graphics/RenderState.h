@@ -1,15 +1,64 @@
 #pragma once
-#include "Graphics/Buffer.h"
-#include "Graphics/Texture.h"
+#include "Graphics/RenderAPI.h"
 #include "Graphics/ResourceSlotmap.h"
+#include "Graphics/ShadowCascades.h"
+#include "Graphics/ShadowAtlas.h"
+#include "Graphics/ShadowScheduler.h"
+
+enum class LightCullingMode : uint32_t
+{
+	LIGHT_CULLING_MODE_CLUSTERED,
+	LIGHT_CULLING_MODE_PER_INSTANCE,
+	LIGHT_CULLING_MODE_NUM_MODES
+};
+
+inline std::string LightCullingModeToString(LightCullingMode mode)
+{
+	switch (mode)
+	{
+	case LightCullingMode::LIGHT_CULLING_MODE_CLUSTERED:
+		return std::string("Clustered");
+	case LightCullingMode::LIGHT_CULLING_MODE_PER_INSTANCE:
+		return std::string("Per instance");
+	default:
+		return std::string("Unknown");
+	}
+}
 
 struct RenderSettings
 {
 	Resolution RenderResolution = { 1280, 720 };
+	// Resolution of a directional light cascade, spot and pointlights get their tile size from the shadow atlas
 	Resolution ShadowMapResolution = { 2048, 2048 };
 
 	bool EnableTAA = true;
 	bool EnableVSync = true;
+
+	// Maximum projected error in pixels a coarser mesh LOD may have, shadow maps can use coarser meshes
+	bool EnableMeshLODs = true;
+	float LODErrorThreshold = 1.0f;
+	float ShadowLODErrorThreshold = 4.0f;
+
+	// Directional light shadow cascades, the camera frustum is split between its near plane and the shadow distance
+	uint32_t NumShadowCascades = MAX_SHADOW_CASCADES;
+	float CascadeSplitLambda = 0.75f;
+	float ShadowDistance = 3000.0f;
+
+	// Keep the depth of static casters per shadow map and only draw casters that moved every frame
+	bool EnableShadowCache = true;
+	// Skip casters that cannot throw a shadow onto anything inside the camera frustum
+	bool EnableShadowCasterCulling = true;
+
+	// All shadow maps are tiles of one shadow atlas, the atlas resolution is fixed once the renderer is initialized
+	ShadowAtlasSettings ShadowAtlas;
+	// Time-sliced shadow updates, only the shadow views that fit into the per frame budget are rendered again
+	ShadowSchedulerSettings ShadowScheduler;
+
+	// Store mesh positions as 16 bit positions relative to the mesh bounds instead of floats, fixed once the renderer is initialized
+	bool QuantizeMeshPositions = false;
+
+	// Which spot and pointlights the lighting pass evaluates, the ones of the fragment's cluster or the ones overlapping the instance
+	LightCullingMode LightCulling = LightCullingMode::LIGHT_CULLING_MODE_CLUSTERED;
 };
 
 struct RendererStatistics
@@ -19,18 +68,92 @@ struct RendererStatistics
 		DrawCallCount = 0;
 		TriangleCount = 0;
 		MeshCount = 0;
+		LODDrawCallCount = 0;
+		PipelineStateSwitchCount = 0;
+		for (uint32_t& count : LightingDrawCallCount)
+			count = 0;
+		DepthPrepassDrawCallCount = 0;
+		DepthVertexByteCount = 0;
+		InstanceLightAssignmentCount = 0;
+		ShadowMapCount = 0;
+		ShadowMapCacheHitCount = 0;
+		ShadowCasterCulledCount = 0;
+		ShadowViewSkippedCount = 0;
+		ShadowViewUnshadowedCount = 0;
+		ShadowAtlasOccupancy = 0.0f;
+		ShadowAtlasNewLightCount = 0;
+		ShadowAtlasResizedLightCount = 0;
+		ShadowAtlasDeferredResizeCount = 0;
+		ShadowAtlasEvictedLightCount = 0;
+		SceneTableUploadByteCount = 0;
 	}
 
 	uint32_t DrawCallCount = 0;
+	// Triangles drawn in all passes, including every shadow map
 	uint32_t TriangleCount = 0;
 	uint32_t MeshCount = 0;
+	// Draw calls that used a coarser LOD than the full detail mesh
+	uint32_t LODDrawCallCount = 0;
+	// Pipeline state changes between shader permutation variants of a pass, draws are sorted so they stay low
+	uint32_t PipelineStateSwitchCount = 0;
+	// Draw calls of the lighting pass per transparency mode, and of the depth pre-pass, which only opaque and masked meshes are drawn in
+	uint32_t LightingDrawCallCount[TransparencyMode::NUM_ALPHA_MODES] = {};
+	uint32_t DepthPrepassDrawCallCount = 0;
+	// Vertex stream bytes bound by the depth pre-pass and shadow map draws, every vertex of a drawn mesh counted once per draw
+	uint64_t DepthVertexByteCount = 0;
+	// Light indices in the per instance light lists, only filled with per instance light culling
+	uint32_t InstanceLightAssignmentCount = 0;
+	// Shadow views (cascades, spotlights and pointlight faces) rendered this frame, and the ones that reused their cached static layer
+	uint32_t ShadowMapCount = 0;
+	uint32_t ShadowMapCacheHitCount = 0;
+	// Casters skipped by shadow caster culling, counted once per light view
+	uint32_t ShadowCasterCulledCount = 0;
+	// Shadow views that kept their last shadow map because they did not fit into the update budget, and the ones of them without a shadow map
+	uint32_t ShadowViewSkippedCount = 0;
+	uint32_t ShadowViewUnshadowedCount = 0;
+	// Fraction of the shadow atlas texels allocated to lights, and the lights whose tiles changed or could not grow this frame
+	float ShadowAtlasOccupancy = 0.0f;
+	uint32_t ShadowAtlasNewLightCount = 0;
+	uint32_t ShadowAtlasResizedLightCount = 0;
+	uint32_t ShadowAtlasDeferredResizeCount = 0;
+	uint32_t ShadowAtlasEvictedLightCount = 0;
+	// Bytes of the instance and material tables copied to the copy of the current back buffer
+	std::size_t SceneTableUploadByteCount = 0;
+};
+
+// Buffers and textures of the render backend with the desc they were created from, the data pointer of the desc is cleared
+struct RenderBuffer
+{
+	BufferDesc Desc;
+	void* Resource = nullptr;
+};
+
+struct RenderTexture
+{
+	TextureDesc Desc;
+	void* Resource = nullptr;
+};
+
+struct MeshLOD
+{
+	RenderResourceHandle IndexBuffer;
+	float Error = 0.0f;
 };
 
 struct Mesh
 {
-	RenderResourceHandle VertexBuffer;
+	// Depth-only passes bind the position stream alone, the lighting pass binds the attribute stream next to it
+	RenderResourceHandle PositionBuffer;
+	RenderResourceHandle AttributeBuffer;
 	RenderResourceHandle IndexBuffer;
 
+	// Dequantization of the position stream, identity for float positions
+	glm::vec3 PositionScale = glm::vec3(1.0f);
+	glm::vec3 PositionOffset = glm::vec3(0.0f);
+
+	// Coarser levels of detail, the full detail mesh uses IndexBuffer
+	std::vector<MeshLOD> LODs;
+
 	RenderResourceHandle Material;
 	BoundingBox BB;
 
@@ -47,6 +170,7 @@ struct Material
 	float RoughnessFactor;
 
 	TransparencyMode Transparency;
+	float AlphaCutoff;
 };
 
 struct SceneData
@@ -64,6 +188,8 @@ struct SceneData
 	uint32_t DirLightCount = 0;
 	uint32_t PointLightCount = 0;
 	uint32_t SpotLightCount = 0;
+	LightCullingMode LightCulling = LightCullingMode::LIGHT_CULLING_MODE_CLUSTERED;
+	uint32_t ShadowAtlasIndex = 0;
 };
 
 enum class TonemapType : uint32_t
@@ -72,7 +198,7 @@ enum class TonemapType : uint32_t
 	NUM_TYPES
 };
 
-static std::string TonemapTypeToString(TonemapType type)
+inline std::string TonemapTypeToString(TonemapType type)
 {
 	switch (type)
 	{
@@ -100,7 +226,7 @@ enum class DebugShowTextureMode : uint32_t
 	DEBUG_SHOW_TEXTURE_MODE_NUM_MODES
 };
 
-static std::string DebugShowTextureModeToString(DebugShowTextureMode mode)
+inline std::string DebugShowTextureModeToString(DebugShowTextureMode mode)
 {
 	switch (mode)
 	{
@@ -126,7 +252,7 @@ struct GlobalConstantBufferData
 	glm::mat4 PrevViewProj = glm::identity<glm::mat4>();
 	glm::mat4 PrevInvViewProj = glm::identity<glm::mat4>();
 
-	Resolution Resolution = { 1280, 720 };
+	::Resolution Resolution = { 1280, 720 };
 
 	// TAA settings
 	glm::vec2 TAA_HaltonJitter = glm::vec2(0.500000f, 0.333333f);
@@ -160,54 +286,15 @@ struct RenderState
 	static constexpr uint32_t BACK_BUFFER_COUNT = 3;
 
 	// Resource slotmaps
-	ResourceSlotmap<Buffer> BufferSlotmap;
-	ResourceSlotmap<Texture> TextureSlotmap;
+	ResourceSlotmap<RenderBuffer> BufferSlotmap;
+	ResourceSlotmap<RenderTexture> TextureSlotmap;
 	ResourceSlotmap<Mesh> MeshSlotmap;
 	ResourceSlotmap<Material> MaterialSlotmap;
 
-	// For textures which names contain "history", this will mean that it accumulates values over time
-	// For textures which names contain "previous", this will mean that it is the last frame's texture of that particular type
-	// Render targets
-	std::unique_ptr<Texture> DepthPrepassDepthTarget;
-	std::unique_ptr<Texture> HDRColorTarget;
-	std::unique_ptr<Texture> SDRColorTarget;
-
-	// TAA render targets
-	std::unique_ptr<Texture> TAAResolveTarget;
-	std::unique_ptr<Texture> TAAHistory;
-	std::unique_ptr<Texture> VelocityTarget;
-	std::unique_ptr<Texture> VelocityTargetPrevious;
-
-	// Buffers
-	std::unique_ptr<Buffer> GlobalConstantBuffer;
-	std::unique_ptr<Buffer> MeshInstanceBufferOpaque;
-	std::unique_ptr<Buffer> MeshInstanceBufferTransparent;
-	std::unique_ptr<Buffer> SceneDataConstantBuffer;
-	std::unique_ptr<Buffer> MaterialConstantBuffer;
-	std::unique_ptr<Buffer> LightConstantBuffer;
-	std::unique_ptr<Buffer> DebugLineBuffer;
-
-	// Default textures
-	std::unique_ptr<Texture> DefaultWhiteTexture;
-	std::unique_ptr<Texture> DefaultNormalTexture;
+	// Default textures, bound in place of missing material textures and of textures that are still uploading
+	void* DefaultWhiteTexture = nullptr;
+	void* DefaultNormalTexture = nullptr;
 
 };
 
 extern RenderState g_RenderState;
-
-static const Texture& GetDebugShowDebugModeTexture(DebugShowTextureMode mode)
-{
-	switch (mode)
-	{
-	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_DEFAULT:
-		return *g_RenderState.TAAResolveTarget;
-	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_TAA_RESOLVE:
-		return *g_RenderState.TAAResolveTarget;
-	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_TAA_HISTORY:
-		return *g_RenderState.TAAHistory;
-	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_VELOCITY:
-		return *g_RenderState.VelocityTarget;
-	default:
-		return *g_RenderState.TAAResolveTarget;
-	}
-}
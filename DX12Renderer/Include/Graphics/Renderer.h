@@ -1,4 +1,5 @@
 #pragma once
+#include "Graphics/ShadowCascades.h"
 
 struct MeshPrimitive;
 struct BoundingBox;
@@ -12,12 +13,16 @@ struct MeshDesc;
 struct MaterialDesc;
 struct Resolution;
 
+enum class VertexPositionFormat : uint32_t;
+
 class Camera;
+class RenderBackend;
 
 namespace Renderer
 {
 
-	void Initialize(HWND hWnd, uint32_t width, uint32_t height);
+	// The renderer owns the backend, which is destroyed in Finalize
+	void Initialize(std::unique_ptr<RenderBackend> backend, uint32_t width, uint32_t height);
 	void Finalize();
 
 	void BeginFrame();
@@ -27,21 +32,37 @@ namespace Renderer
 	void EndScene();
 	void EndFrame();
 
-	void Submit(RenderResourceHandle meshPrimitiveHandle, const glm::mat4& transform, const glm::mat4& prevFrameTransform);
-	void Submit(DirectionalLightData& dirLightData, const Camera& lightCamera, RenderResourceHandle shadowMapHandle);
-	void Submit(SpotLightData& spotLightData, const Camera& lightCamera, RenderResourceHandle shadowMapHandle);
-	void Submit(PointLightData& pointLightData, const std::array<Camera, 6>& lightCameras, RenderResourceHandle shadowMapHandle);
+	// Mesh instances keep their slot in the GPU instance table across frames by their object ID, one submission per ID and frame
+	void Submit(RenderResourceHandle meshPrimitiveHandle, const glm::mat4& transform, const glm::mat4& prevFrameTransform, uint64_t objectID);
+	// Shadow maps are tiles of the shadow atlas, lights keep their tiles across frames by their light ID (e.g. the scene object ID)
+	// The shadow cascades of the directional light are fitted to the scene camera in Render, one tile per cascade
+	void Submit(DirectionalLightData& dirLightData, uint64_t lightID);
+	void Submit(SpotLightData& spotLightData, const Camera& lightCamera, uint64_t lightID);
+	void Submit(PointLightData& pointLightData, const std::array<Camera, 6>& lightCameras, uint64_t lightID);
 
 	RenderResourceHandle CreateBuffer(const BufferDesc& desc);
 	RenderResourceHandle CreateTexture(const TextureDesc& desc);
 	RenderResourceHandle CreateMesh(const MeshDesc& desc);
 	RenderResourceHandle CreateMaterial(const MaterialDesc& desc);
 
+	// Buffers and textures are freed once the frames in flight are done with them, meshes and materials right away (not during Render)
+	// The buffers and textures a mesh or material refers to are not destroyed with it
+	void DestroyBuffer(RenderResourceHandle handle);
+	void DestroyTexture(RenderResourceHandle handle);
+	void DestroyMesh(RenderResourceHandle handle);
+	void DestroyMaterial(RenderResourceHandle handle);
+
 	void Resize(uint32_t width, uint32_t height);
 	void ToggleVSync();
 	bool IsVSyncEnabled();
 
+	RenderBackend& GetBackend();
 	const Resolution& GetRenderResolution();
-	const Resolution& GetShadowResolution();
+	// Meshes have to store their positions in this format, see RenderSettings::QuantizeMeshPositions
+	VertexPositionFormat GetMeshPositionFormat();
+
+	// Records the submissions of the next numFrames frames, see FrameCapture.h and dx12r_bench --replay
+	void BeginCapture(const std::string& filepath, uint32_t numFrames);
+	bool IsCapturing();
 
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "Graphics/Backend/DescriptorAllocation.h"
+#include "Graphics/Backend/UploadQueue.h"
 
 class Resource
 {
@@ -17,6 +18,10 @@ public:
 	virtual bool IsCPUAccessible() const = 0;
 	virtual void Invalidate() = 0;
 
+	// Returns false while the initial data of the resource is still being uploaded
+	bool IsReady() const;
+	UploadTicket GetUploadTicket() const { return m_UploadTicket; }
+
 	const DescriptorAllocation& GetDescriptorAllocation(DescriptorType type) const;
 	D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptor(DescriptorType type, uint32_t offset = 0) const;
 	uint32_t GetDescriptorHeapIndex(DescriptorType type, uint32_t offset = 0) const;
@@ -34,6 +39,8 @@ protected:
 	virtual void AllocateDescriptors() = 0;
 	virtual void CreateViews() = 0;
 	void ResetDescriptorAllocations();
+	// Counts the D3D12 resource in the memory tracker, replacing the resource it counted before
+	void TrackGPUMemory(const std::string& name, GPUMemoryCategory category);
 
 protected:
 	ComPtr<ID3D12Resource> m_d3d12Resource;
@@ -44,5 +51,7 @@ protected:
 	std::size_t m_ByteSize = 0;
 
 	void* m_CPUPtr = nullptr;
+	UploadTicket m_UploadTicket;
+	uint32_t m_MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
 
 };
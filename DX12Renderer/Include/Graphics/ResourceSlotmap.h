@@ -20,6 +20,10 @@ public:
 			m_Slots[slot].NextFree = (uint32_t)slot + 1;
 			m_Slots[slot].Generation = 0;
 		}
+
+		// The last slot ends the free list
+		m_Slots[m_Capacity - 1].NextFree = 0;
+		m_Slots[m_Capacity - 1].Generation = 0;
 	}
 
 	~ResourceSlotmap()
@@ -71,13 +75,31 @@ public:
 	void Erase(RenderResourceHandle handle)
 	{
 		// Get slot 0 (sentinel)
+		Slot* sentinel = &m_Slots[0];
+
 		// Check if resource handle is valid
+		if (!RENDER_RESOURCE_HANDLE_VALID(handle) || handle.Index >= m_Capacity)
+			return;
+
 		// Get the slot from the handle index
-		// Check if the handle version is equal to the slot generation
-		// Increase the slot generation
+		Slot* slot = &m_Slots[handle.Index];
+
+		// Check if the handle version is equal to the slot generation, stale handles must not free the slot of a newer resource
+		if (handle.Version != slot->Generation || slot->NextFree != SLOT_OCCUPIED)
+			return;
+
+		// Increase the slot generation, so every handle to the erased resource stops resolving
+		slot->Generation++;
+
 		// Set the slot's next free to the sentinels next free
+		slot->NextFree = sentinel->NextFree;
+
 		// Set the sentinels next free to the handle index
-		// Call destructor on non trivivally destructible
+		sentinel->NextFree = handle.Index;
+
+		// Call destructor, and leave a default constructed resource behind since delete[] destructs every slot
+		slot->Resource.~Resource_t();
+		new (&slot->Resource) Resource_t();
 	}
 
 	Resource_t* Find(RenderResourceHandle handle)
@@ -99,6 +121,17 @@ public:
 		return resource;
 	}
 
+	// Calls func for every resource that was inserted and not erased yet
+	template<typename Func>
+	void ForEach(Func&& func)
+	{
+		for (std::size_t index = 1; index < m_Capacity; ++index)
+		{
+			if (m_Slots[index].NextFree == SLOT_OCCUPIED)
+				func(m_Slots[index].Resource);
+		}
+	}
+
 private:
 	RenderResourceHandle AllocateSlot()
 	{
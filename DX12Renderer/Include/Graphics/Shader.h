@@ -1,18 +1,36 @@
 #pragma once
+#include "Graphics/ShaderCache.h"
+
+/*
+
+	DXC behind the shader cache, every compilation creates its own compiler instance since DXC compilers are not thread safe.
+	Reflection is stripped from the bytecode and returned separately.
+
+*/
+class DXCShaderCompiler : public ShaderCompiler
+{
+public:
+	DXCShaderCompiler();
+
+	virtual Hash128 GetVersionHash() const override { return m_VersionHash; }
+	virtual bool Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages) override;
+
+private:
+	Hash128 m_VersionHash;
+
+};
 
 class Shader
 {
 public:
-	Shader(const std::wstring& filepath, const std::string& entryPoint, const std::string& target);
+	Shader(const std::string& filepath, const std::string& entryPoint, const std::string& target, const std::vector<std::string>& defines = {});
 	~Shader();
 
 	D3D12_SHADER_BYTECODE GetShaderByteCode() const { return m_ShaderByteCode; }
+	const ShaderBinary& GetBinary() const { return *m_Binary; }
 
 private:
-	void Compile(const std::wstring& filepath, const std::string& entryPoint, const std::string& target);
-
-private:
-	ComPtr<IDxcBlob> m_ShaderByteBlob;
-	D3D12_SHADER_BYTECODE m_ShaderByteCode;
+	std::shared_ptr<const ShaderBinary> m_Binary;
+	D3D12_SHADER_BYTECODE m_ShaderByteCode = {};
 
 };
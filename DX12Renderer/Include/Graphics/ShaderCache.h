@@ -0,0 +1,124 @@
+#pragma once
+#include "Util/Hash.h"
+
+// Shader models of the renderer, passes and precompilation use the same targets so they share cache entries
+static constexpr const char* SHADER_TARGET_VERTEX = "vs_6_0";
+static constexpr const char* SHADER_TARGET_PIXEL = "ps_6_0";
+static constexpr const char* SHADER_TARGET_COMPUTE = "cs_6_0";
+
+enum ShaderCompileFlags : uint32_t
+{
+	SHADER_COMPILE_FLAG_NONE = 0,
+	SHADER_COMPILE_FLAG_DEBUG = (1 << 0),
+	SHADER_COMPILE_FLAG_SKIP_OPTIMIZATIONS = (1 << 1)
+};
+
+#ifdef _DEBUG
+static constexpr uint32_t SHADER_COMPILE_FLAGS_DEFAULT = SHADER_COMPILE_FLAG_DEBUG | SHADER_COMPILE_FLAG_SKIP_OPTIMIZATIONS;
+#else
+static constexpr uint32_t SHADER_COMPILE_FLAGS_DEFAULT = SHADER_COMPILE_FLAG_NONE;
+#endif
+
+struct ShaderCompileDesc
+{
+	std::string Filepath;
+	std::string EntryPoint = "main";
+	std::string Target;
+	uint32_t Flags = SHADER_COMPILE_FLAGS_DEFAULT;
+	// Preprocessor defines of a shader permutation, "NAME" or "NAME=VALUE", they are part of the cache key
+	std::vector<std::string> Defines;
+};
+
+/*
+
+	A shader file and every file it includes, the main file comes first, the includes follow in the order they were found.
+	Includes are resolved relative to the file that includes them, paths are normalized with forward slashes.
+	Includes that could not be found are kept without code, so creating them later changes the hash of the shaders that include them.
+
+*/
+struct ShaderSourceFile
+{
+	std::string Filepath;
+	std::string Code;
+	bool Exists = false;
+};
+
+using ShaderSources = std::vector<ShaderSourceFile>;
+
+struct ShaderBinary
+{
+	// DXIL with the reflection stripped
+	std::vector<uint8_t> Bytecode;
+	// Reflection part of the container, ID3D12ShaderReflection can be created from it with IDxcUtils::CreateReflection
+	std::vector<uint8_t> Reflection;
+};
+
+/*
+
+	Compiles a single shader, called from multiple job system threads at once.
+	Includes are resolved from the given sources, so the compiled code is exactly the code that was hashed.
+	Warnings of successful compilations are returned in outMessages as well.
+
+*/
+class ShaderCompiler
+{
+public:
+	virtual ~ShaderCompiler() = default;
+
+	// Identifies the compiler and its version, binaries of another compiler are never used
+	virtual Hash128 GetVersionHash() const = 0;
+	virtual bool Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages) = 0;
+};
+
+struct ShaderCacheDesc
+{
+	std::string Directory = "Cache/Shaders/";
+};
+
+struct ShaderCacheStatistics
+{
+	uint32_t NumMemoryHits = 0;
+	uint32_t NumDiskHits = 0;
+	uint32_t NumCompiled = 0;
+	uint32_t NumFailed = 0;
+
+	// Summed over all threads
+	float HashTime = 0.0f;
+	float CompileTime = 0.0f;
+	// Wall clock time of the last CompileShaders call
+	float LastBatchTime = 0.0f;
+};
+
+/*
+
+	Content addressed cache of compiled shaders.
+	Shaders are keyed by a hash of their source, the sources of everything they include, entry point, target, flags, defines and compiler version,
+	so editing Common.hlsl recompiles every shader that includes it and nothing else. Binaries are kept in memory and written to Directory,
+	later launches load them from there instead of compiling. Misses of a CompileShaders call are compiled in parallel on the job system.
+
+*/
+namespace ShaderCache
+{
+
+	void Initialize(std::unique_ptr<ShaderCompiler> compiler, const ShaderCacheDesc& desc = ShaderCacheDesc());
+	void Finalize();
+
+	bool LoadSources(const std::string& filepath, ShaderSources& outSources);
+	Hash128 HashShader(const ShaderCompileDesc& desc, const ShaderSources& sources);
+
+	// Failed shaders are returned as nullptr, their errors are logged
+	void CompileShaders(const std::vector<ShaderCompileDesc>& descs, std::vector<std::shared_ptr<const ShaderBinary>>& outBinaries);
+	std::shared_ptr<const ShaderBinary> GetShader(const ShaderCompileDesc& desc);
+
+	// Shaders of a directory, the stage is taken from the _VS, _PS or _CS suffix of the file name, other files are includes
+	void GetDirectoryShaders(const std::string& directory, std::vector<ShaderCompileDesc>& outDescs);
+	// Returns the number of shaders that failed to compile
+	uint32_t CompileDirectory(const std::string& directory);
+
+	// Drops the binaries kept in memory, shaders that are requested again are loaded from disk
+	void ClearMemory();
+
+	ShaderCacheStatistics GetStatistics();
+	void ResetStatistics();
+
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+
+	Feature bits of shader permutations, every bit has a define that the shader checks with #if.
+	Capabilities are work a variant can do, a draw that needs one can only use variants that have it, variants with more capabilities
+	still draw correctly since materials without a texture bind a default texture. Specializations are work a variant can skip,
+	a variant with one can only be used by draws that meet it.
+
+*/
+enum ShaderFeature : uint32_t
+{
+	SHADER_FEATURE_NONE = 0,
+	// Capabilities
+	SHADER_FEATURE_NORMAL_MAP = (1 << 0),
+	SHADER_FEATURE_METALLIC_ROUGHNESS_MAP = (1 << 1),
+	SHADER_FEATURE_ALPHA_TEST = (1 << 2),
+	// Specializations
+	SHADER_FEATURE_SHADOWED_LIGHTS_ONLY = (1 << 3)
+};
+
+static constexpr uint32_t SHADER_FEATURE_NUM_BITS = 4;
+static constexpr uint32_t SHADER_FEATURE_ALL = (1 << SHADER_FEATURE_NUM_BITS) - 1;
+static constexpr uint32_t SHADER_FEATURE_CAPABILITIES = SHADER_FEATURE_NORMAL_MAP | SHADER_FEATURE_METALLIC_ROUGHNESS_MAP | SHADER_FEATURE_ALPHA_TEST;
+static constexpr uint32_t SHADER_FEATURE_SPECIALIZATIONS = SHADER_FEATURE_SHADOWED_LIGHTS_ONLY;
+
+// Every variant is a pipeline state of its own, so a pass can never have more than this
+static constexpr uint32_t SHADER_PERMUTATION_MAX_VARIANTS = 16;
+
+/*
+
+	The variants of a shader that are compiled, draws can only pick from these.
+	The first variant is the fallback every draw can use, it has every supported capability and no specialization.
+
+*/
+struct ShaderPermutationManifest
+{
+	std::string Name;
+	uint32_t SupportedFeatures = SHADER_FEATURE_NONE;
+	std::vector<uint32_t> Variants;
+};
+
+/*
+
+	Picks the variant of a manifest for the features of a draw, from a table with an entry for every combination of feature bits.
+	A draw gets the compatible variant with the fewest capabilities it does not need, and of those the one with the most specializations.
+	Features the manifest does not support are ignored. A set without a manifest has a single variant without features.
+
+*/
+class ShaderPermutationSet
+{
+public:
+	ShaderPermutationSet();
+	ShaderPermutationSet(const ShaderPermutationManifest& manifest);
+
+	uint32_t SelectVariant(uint32_t drawFeatures) const { return m_VariantLookup[drawFeatures & SHADER_FEATURE_ALL]; }
+
+	uint32_t GetNumVariants() const { return static_cast<uint32_t>(m_Manifest.Variants.size()); }
+	uint32_t GetVariantFeatures(uint32_t variant) const { return m_Manifest.Variants[variant]; }
+	const ShaderPermutationManifest& GetManifest() const { return m_Manifest; }
+
+private:
+	ShaderPermutationManifest m_Manifest;
+	std::array<uint8_t, 1 << SHADER_FEATURE_NUM_BITS> m_VariantLookup = {};
+
+};
+
+namespace ShaderPermutation
+{
+
+	const char* GetFeatureDefine(ShaderFeature feature);
+	// One define per feature bit, in bit order
+	void GetDefines(uint32_t features, std::vector<std::string>& outDefines);
+	std::string GetFeatureString(uint32_t features);
+
+	bool IsVariantCompatible(uint32_t variantFeatures, uint32_t drawFeatures);
+	// Logs why a manifest is invalid, a valid manifest has a fallback first, no duplicates and at most SHADER_PERMUTATION_MAX_VARIANTS variants
+	bool ValidateManifest(const ShaderPermutationManifest& manifest);
+
+	// Variants of Lighting_PS.hlsl, every combination of its texture capabilities with and without unshadowed lights
+	const ShaderPermutationManifest& GetLightingManifest();
+
+	// Draws are sorted by their key, so draws that use the same variant are next to each other and the pipeline state changes least.
+	// The shader features are in the highest bits, then the material, then the mesh
+	uint64_t MakeDrawSortKey(uint32_t shaderFeatures, uint32_t material, uint32_t mesh);
+	uint32_t GetDrawSortKeyFeatures(uint64_t sortKey);
+
+}
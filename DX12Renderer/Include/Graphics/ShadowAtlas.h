@@ -0,0 +1,176 @@
+#pragma once
+
+// Pointlights render six faces, directional lights one tile per cascade
+constexpr uint32_t MAX_SHADOW_ATLAS_TILES_PER_LIGHT = 6;
+
+struct ShadowAtlasTile
+{
+	// Top left texel and edge length of the tile in the atlas
+	uint32_t X = 0;
+	uint32_t Y = 0;
+	uint32_t Size = 0;
+
+	bool operator==(const ShadowAtlasTile& other) const { return X == other.X && Y == other.Y && Size == other.Size; }
+	bool operator!=(const ShadowAtlasTile& other) const { return !(*this == other); }
+};
+
+/*
+
+	Quadtree allocator for square power of two tiles, a free node is split into four children until it has the requested size,
+	and four free siblings are merged back into their parent. Free nodes are taken in scan order from the smallest level that
+	has one, so small tiles fill up partially used nodes before larger free nodes are split.
+
+*/
+class ShadowAtlasAllocator
+{
+public:
+	ShadowAtlasAllocator() = default;
+	ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize);
+
+	bool Allocate(uint32_t tileSize, ShadowAtlasTile& outTile);
+	void Free(const ShadowAtlasTile& tile);
+	void Reset();
+
+	uint32_t GetAtlasSize() const { return m_AtlasSize; }
+	uint32_t GetMinTileSize() const { return m_MinTileSize; }
+	uint64_t GetAllocatedTexels() const { return m_AllocatedTexels; }
+
+private:
+	enum NodeState : uint8_t
+	{
+		// Part of a free, allocated or unsplit node of a coarser level
+		NODE_STATE_NONE,
+		NODE_STATE_FREE,
+		NODE_STATE_SPLIT,
+		NODE_STATE_ALLOCATED
+	};
+
+	uint32_t GetLevel(uint32_t tileSize) const;
+	void SetState(uint32_t level, uint32_t node, NodeState state);
+
+private:
+	uint32_t m_AtlasSize = 0;
+	uint32_t m_MinTileSize = 0;
+	uint32_t m_NumLevels = 0;
+	uint64_t m_AllocatedTexels = 0;
+
+	// Level 0 is the whole atlas, level n has (2^n)^2 nodes in row major order
+	std::vector<std::vector<uint8_t>> m_NodeStates;
+	std::vector<uint32_t> m_NumFreeNodes;
+
+};
+
+struct ShadowAtlasSettings
+{
+	uint32_t AtlasResolution = 8192;
+	uint32_t MinTileSize = 128;
+	uint32_t MaxTileSize = 2048;
+
+	// Tile size in texels per pixel of the projected light diameter
+	float ResolutionScale = 1.0f;
+	// How far past the halfway point between two tile sizes the desired size has to move before a light changes size, in powers of two
+	float SizeHysteresis = 0.25f;
+	// A light without tiles only evicts lights whose priority is lower by this factor
+	float PriorityHysteresis = 0.25f;
+	// When the lights want more texels than this fraction of the atlas, all desired sizes are scaled down evenly,
+	// the rest is slack for rounding up to powers of two and fragmentation
+	float MaxOccupancy = 0.6f;
+};
+
+struct ShadowAtlasRequest
+{
+	// Identifies the light across frames, allocations are kept as long as the light is requested every frame
+	uint64_t LightID = 0;
+	uint32_t NumTiles = 1;
+
+	// Projected diameter of the light bounds on screen in pixels, see ShadowAtlas::CalculateScreenCoverage
+	float ScreenCoverage = 0.0f;
+	float Importance = 1.0f;
+
+	// Tiles of exactly this size, allocated before all other lights and never evicted, used for directional light cascades
+	uint32_t FixedTileSize = 0;
+};
+
+struct ShadowAtlasAllocation
+{
+	// Every tile of a light has the same size, 0 if the light did not get any tiles
+	uint32_t TileSize = 0;
+	uint32_t NumTiles = 0;
+	ShadowAtlasTile Tiles[MAX_SHADOW_ATLAS_TILES_PER_LIGHT];
+};
+
+struct ShadowAtlasStatistics
+{
+	uint32_t NumLights = 0;
+	uint32_t NumAllocatedLights = 0;
+	uint32_t NumAllocatedTiles = 0;
+	uint64_t NumAllocatedTexels = 0;
+
+	// Lights that got new tiles this frame, a light with new tiles has to render its shadow maps again
+	uint32_t NumNewLights = 0;
+	uint32_t NumResizedLights = 0;
+	// Lights that wanted larger tiles but kept their current ones because the atlas was full
+	uint32_t NumDeferredResizes = 0;
+	// Lights that lost their tiles to a light with a higher priority, and lights without tiles
+	uint32_t NumEvictedLights = 0;
+	uint32_t NumUnallocatedLights = 0;
+	// Scale applied to all desired tile sizes, below 1 when the lights want more texels than the atlas has
+	float DemandScale = 1.0f;
+};
+
+/*
+
+	Shadow atlas tile assignment, every frame each shadow casting light asks for a tile size based on its projected size on screen.
+	The desired size is rounded to a power of two with hysteresis, so lights near the threshold between two sizes keep their tiles.
+	Lights keep their tiles until they change size or stop being requested, lights that need new tiles are served by priority
+	(screen coverage times importance), and only evict lights with a clearly lower priority when the atlas is full.
+	Only depends on the requests, so the policy can be run and measured without a GPU.
+
+*/
+class ShadowAtlas
+{
+public:
+	ShadowAtlas(const ShadowAtlasSettings& settings = ShadowAtlasSettings());
+
+	void Update(const std::vector<ShadowAtlasRequest>& requests);
+
+	// Changing the atlas resolution or the tile size range drops all allocations
+	void SetSettings(const ShadowAtlasSettings& settings);
+	const ShadowAtlasSettings& GetSettings() const { return m_Settings; }
+
+	// Returns nullptr if the light did not get tiles in the last update
+	const ShadowAtlasAllocation* GetAllocation(uint64_t lightID) const;
+	// Offset (xy) and scale (zw) of a tile in atlas texture coordinates
+	glm::vec4 GetTileUVRect(const ShadowAtlasTile& tile) const;
+	const ShadowAtlasStatistics& GetStatistics() const { return m_Stats; }
+
+	// Projected diameter in pixels of a world space sphere (xyz center, w radius), the full view height if the camera is inside it
+	// and 0 if it is behind the camera
+	static float CalculateScreenCoverage(const glm::mat4& view, const glm::mat4& projection, float viewHeight, const glm::vec4& sphere);
+
+private:
+	struct LightState
+	{
+		ShadowAtlasAllocation Allocation;
+		float Priority = 0.0f;
+		uint32_t TargetTileSize = 0;
+		bool IsRequested = false;
+	};
+
+	float CalculateDemandScale(const std::vector<ShadowAtlasRequest>& requests) const;
+	uint32_t CalculateTargetTileSize(const ShadowAtlasRequest& request, uint32_t currentTileSize) const;
+	bool AllocateTiles(uint32_t tileSize, uint32_t numTiles, ShadowAtlasAllocation& outAllocation);
+	void FreeTiles(ShadowAtlasAllocation& allocation);
+
+private:
+	ShadowAtlasSettings m_Settings;
+	ShadowAtlasAllocator m_Allocator;
+	ShadowAtlasStatistics m_Stats;
+	// Scale of all desired tile sizes in the last update, below 1 when the atlas is oversubscribed
+	float m_DemandScale = 1.0f;
+
+	std::unordered_map<uint64_t, LightState> m_Lights;
+	// Request indices sorted by priority, kept around to avoid allocating every frame
+	std::vector<std::size_t> m_RequestOrder;
+
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include "Util/Hash.h"
+
+struct ShadowCacheEntry
+{
+	// Signature of the static layer currently stored in the cache
+	Hash128 Signature;
+	bool IsValid = false;
+};
+
+/*
+
+	Static shadow caster cache, every shadow map keeps a copy of the depth of its static casters.
+	The views of a shadow map include their shadow atlas tile (x, y, size), so a light that moved in the atlas is rendered again.
+	A caster is static in a frame if its transform did not change since the previous frame, dynamic casters are drawn
+	on top of the cached layer every frame. The signature of a static layer covers the light views of the shadow map
+	and every static caster inside one of them, so the cache is invalidated when the light moves, or when a caster in
+	its range starts or stops moving, appears or disappears. The signature does not depend on the submission order.
+
+*/
+namespace ShadowCache
+{
+
+	bool IsStaticCaster(const glm::mat4& transform, const glm::mat4& prevFrameTransform);
+
+	void AddView(Hash128& signature, const glm::mat4& viewProjection, const glm::uvec3& atlasTile);
+	void AddStaticCaster(Hash128& signature, uint64_t meshID, const glm::mat4& transform);
+
+	// Returns true if the cached static layer matches the signature and can be reused,
+	// otherwise the entry takes the new signature and the caller has to render the static layer into the cache again
+	bool Validate(ShadowCacheEntry& entry, const Hash128& signature);
+	void Invalidate(ShadowCacheEntry& entry);
+
+};
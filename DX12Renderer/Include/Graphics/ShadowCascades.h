@@ -0,0 +1,72 @@
+#pragma once
+#include "Scene/BoundingVolume.h"
+
+// Has to match MAX_SHADOW_CASCADES in Common.hlsl
+constexpr uint32_t MAX_SHADOW_CASCADES = 4;
+
+struct ShadowCascadeSettings
+{
+	uint32_t NumCascades = MAX_SHADOW_CASCADES;
+	// Blend between uniform (0) and logarithmic (1) split distances
+	float SplitLambda = 0.75f;
+	// Shadows end at this view depth, or at the far plane of the camera if it is closer
+	float MaxShadowDistance = 3000.0f;
+	uint32_t ShadowMapResolution = 2048;
+};
+
+/*
+
+	One cascade of a directional light shadow map.
+	The orthographic bounds are in light view space, Near and Far are light view depths with Near < Far,
+	the projection is built with reverse-z like all other cameras.
+
+*/
+struct ShadowCascade
+{
+	// View depth range of the camera frustum slice this cascade covers
+	float SplitNear = 0.0f;
+	float SplitFar = 0.0f;
+	BoundingSphere Sphere;
+
+	glm::mat4 View = glm::identity<glm::mat4>();
+	glm::mat4 Projection = glm::identity<glm::mat4>();
+	glm::mat4 ViewProjection = glm::identity<glm::mat4>();
+
+	float Left = 0.0f;
+	float Right = 0.0f;
+	float Bottom = 0.0f;
+	float Top = 0.0f;
+	float Near = 0.0f;
+	float Far = 0.0f;
+};
+
+/*
+
+	Cascaded shadow map setup for directional lights, calculated every frame from the scene camera.
+	The camera frustum is split with the practical split scheme, every slice is enclosed by a bounding sphere
+	which does not change size when the camera rotates, and the sphere center is snapped to shadow map texels,
+	so the shadow map content only moves in whole texels and does not shimmer.
+	The light depth range is tightened to the bounds of the scene instead of a fixed range.
+
+*/
+namespace ShadowCascades
+{
+
+	// Writes numCascades + 1 view depths, the first is nearPlane and the last farPlane
+	void CalculateSplitDistances(float nearPlane, float farPlane, uint32_t numCascades, float lambda, float* outSplits);
+
+	// Smallest sphere around the camera frustum between the view depths sliceNear and sliceFar, in world space
+	BoundingSphere CalculateFrustumSliceBoundingSphere(const glm::mat4& cameraView, float tanHalfFovY, float aspectRatio, float sliceNear, float sliceFar);
+
+	// Rotation only light view looking along the light direction
+	glm::mat4 MakeLightView(const glm::vec3& lightDirection);
+
+	// Fits the orthographic bounds of a cascade around the sphere, snapped to texel increments of the shadow map,
+	// with the depth range reaching from the first caster of the scene to the last receiver inside the sphere
+	void FitCascade(const glm::mat4& lightView, const BoundingSphere& sphere, uint32_t shadowMapResolution, const BoundingBox& sceneBB, ShadowCascade& outCascade);
+
+	// Calculates all cascades for a perspective camera and returns the number of cascades written to outCascades
+	uint32_t CalculateCascades(const ShadowCascadeSettings& settings, const glm::mat4& cameraView, const glm::mat4& cameraProjection, float cameraNear, float cameraFar,
+		const glm::vec3& lightDirection, const BoundingBox& sceneBB, ShadowCascade* outCascades);
+
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "Scene/BoundingVolume.h"
+
+/*
+
+	Receivers one light view can shadow, in light space. Orthographic views use light view xy, perspective views use the
+	direction of the ray from the light (x / z, y / z), so in both cases a caster and the receivers behind it share the same xy.
+	A caster can only throw a shadow onto a receiver if their xy overlap and the caster is closer to the light than the receiver.
+
+*/
+struct ShadowCasterVolume
+{
+	glm::mat4 LightView = glm::identity<glm::mat4>();
+	bool IsPerspective = false;
+	// No visible receiver is inside the light view, nothing has to be rendered
+	bool IsEmpty = true;
+
+	glm::vec2 ReceiverMin = glm::vec2(0.0f);
+	glm::vec2 ReceiverMax = glm::vec2(0.0f);
+	// Light view depth of the receiver farthest away from the light
+	float ReceiverMaxDepth = 0.0f;
+};
+
+/*
+
+	Shadow caster culling, removes casters that cannot throw a shadow onto anything the camera sees.
+	The visible receivers are the camera frustum clipped to the scene bounds, and every light view extrudes them toward the light:
+	a caster survives if its bounds overlap the receivers in light space and it is not behind all of them.
+	All tests are conservative, a caster that shadows a visible receiver is never culled.
+
+*/
+namespace ShadowCasterCulling
+{
+
+	// Corners of the convex region inside both the camera frustum and the scene bounds, in world space, empty if they do not overlap
+	void CalculateReceiverRegion(const glm::mat4& cameraViewProjection, const BoundingBox& sceneBB, std::vector<glm::vec3>& outPoints);
+
+	// Volume of a light view with a reverse-z or regular, orthographic or perspective projection
+	ShadowCasterVolume MakeCasterVolume(const glm::mat4& lightView, const glm::mat4& lightProjection, const std::vector<glm::vec3>& receiverPoints);
+
+	bool IsCasterInVolume(const ShadowCasterVolume& volume, const BoundingBox& worldBB);
+
+	// Tests a batch of world space caster bounds, writes 1 for the casters that have to be rendered and returns how many were culled
+	uint32_t CullCasters(const ShadowCasterVolume& volume, const BoundingBox* worldBBs, std::size_t numCasters, uint8_t* outVisible);
+
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+struct ShadowSchedulerSettings
+{
+	// Draws and estimated triangles all shadow view updates of a frame may add up to, 0 is unlimited
+	uint32_t DrawBudget = 0;
+	uint64_t TriangleBudget = 0;
+
+	// A light that moved since its last update counts this many times more
+	float MotionWeight = 4.0f;
+	// Views whose light did not move and that have no dynamic casters only update with budget to spare
+	float UnchangedWeight = 0.25f;
+	// Priority is divided by 1 + distance * DistanceFalloff, so lights far away from the camera update less often
+	float DistanceFalloff = 0.01f;
+};
+
+struct ShadowViewRequest
+{
+	// Identifies one shadow view (a cascade, spotlight or pointlight face) across frames
+	uint64_t ViewID = 0;
+
+	// Projected diameter of the light bounds on screen in pixels, and distance of the light to the camera
+	float ScreenCoverage = 0.0f;
+	float Distance = 0.0f;
+
+	// The view changed since the shadow map was last rendered, or casters in it move
+	bool HasMoved = false;
+	bool HasDynamicCasters = false;
+	// The tile holds no shadow map of this view (new tile, never rendered), skipping it leaves the view unshadowed
+	bool IsInvalid = false;
+	// Updated every frame regardless of the budget, used for directional light cascades which follow the camera
+	bool AlwaysUpdate = false;
+
+	// Estimated cost of rendering the view
+	uint32_t NumDraws = 0;
+	uint64_t NumTriangles = 0;
+};
+
+struct ShadowSchedulerStatistics
+{
+	uint32_t NumViews = 0;
+	uint32_t NumUpdatedViews = 0;
+	uint32_t NumSkippedViews = 0;
+	// Invalid views that did not fit into the budget
+	uint32_t NumUnshadowedViews = 0;
+	uint32_t NumUpdatedDraws = 0;
+	uint64_t NumUpdatedTriangles = 0;
+	// Frames since the least recently updated view was last rendered
+	uint32_t MaxFramesSinceUpdate = 0;
+};
+
+/*
+
+	Time-sliced shadow updates, every frame each shadow view gets a priority from the screen coverage and distance of its light,
+	whether it moved and how many frames passed since it was last rendered. Views are updated in priority order as long as
+	their estimated cost fits into the budget, the others keep the shadow map of their last update.
+	Always updated and invalid views go first, and the top view is always updated so every view is eventually rendered.
+	The result only depends on the requests and the previous results, ties are broken by view ID.
+
+*/
+class ShadowScheduler
+{
+public:
+	ShadowScheduler(const ShadowSchedulerSettings& settings = ShadowSchedulerSettings());
+
+	// Writes 1 for every request whose view has to be rendered this frame
+	void Schedule(const std::vector<ShadowViewRequest>& requests, std::vector<uint8_t>& outUpdate);
+
+	void SetSettings(const ShadowSchedulerSettings& settings) { m_Settings = settings; }
+	const ShadowSchedulerSettings& GetSettings() const { return m_Settings; }
+	const ShadowSchedulerStatistics& GetStatistics() const { return m_Stats; }
+
+	// Number of frames since the view was last rendered, 0 if it was rendered this frame or is unknown
+	uint32_t GetFramesSinceUpdate(uint64_t viewID) const;
+
+private:
+	struct ViewState
+	{
+		uint32_t FramesSinceUpdate = 0;
+		bool IsRequested = false;
+	};
+
+	float CalculatePriority(const ShadowViewRequest& request, uint32_t framesSinceUpdate) const;
+
+private:
+	ShadowSchedulerSettings m_Settings;
+	ShadowSchedulerStatistics m_Stats;
+
+	std::unordered_map<uint64_t, ViewState> m_Views;
+	// Request indices sorted by priority and their priorities, kept around to avoid allocating every frame
+	std::vector<std::size_t> m_RequestOrder;
+	std::vector<float> m_Priorities;
+
+};
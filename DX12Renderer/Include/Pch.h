@@ -10,6 +10,7 @@
 #include <chrono>
 #include <string>
 #include <queue>
+#include <deque>
 #include <vector>
 #include <array>
 #include <unordered_map>
@@ -18,15 +19,21 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 #include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
 
 /*
 
-	WIN32 includes/macros
+	WIN32 includes/macros, the portable core (see CMakeLists.txt) is also built without them
 
 */
+#if defined(_WIN32)
 #include "WinIncludes.h"
 #define DX_CALL(hr) if (hr != S_OK) throw std::exception()
+#endif
 
 /*
 
@@ -77,6 +84,7 @@ constexpr float LIGHT_RANGE_EPSILON = 1.0f / 0.01f;
 #include "Util/MathHelper.h"
 #include "Util/Random.h"
 #include "Util/Logger.h"
+#include "Util/MemoryTracker.h"
 #include "Util/Profiler.h"
 #include "Util/StringHelper.h"
 #include "Util/ThreadSafeQueue.h"
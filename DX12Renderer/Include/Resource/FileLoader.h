@@ -1,5 +1,4 @@
 #pragma once
-#include <tinygltf/tiny_gltf.h>
 
 class Model;
 
@@ -16,6 +15,7 @@ class FileLoader
 {
 public:
 	static ImageInfo LoadImage(const std::string& filepath);
+	static ImageInfo LoadImageFromMemory(const uint8_t* data, std::size_t byteSize);
+	static void FreeImage(ImageInfo& imageInfo);
 	static std::string LoadShader(const std::string& filepath);
-	static tinygltf::Model LoadGLTFModel(const std::string& filepath);
 };
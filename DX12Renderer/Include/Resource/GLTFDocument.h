@@ -0,0 +1,174 @@
+#pragma once
+#include "Resource/FileLoader.h"
+#include "Util/MappedFile.h"
+
+enum class GLTFComponentType : uint32_t
+{
+	GLTF_COMPONENT_TYPE_BYTE = 5120,
+	GLTF_COMPONENT_TYPE_UNSIGNED_BYTE = 5121,
+	GLTF_COMPONENT_TYPE_SHORT = 5122,
+	GLTF_COMPONENT_TYPE_UNSIGNED_SHORT = 5123,
+	GLTF_COMPONENT_TYPE_UNSIGNED_INT = 5125,
+	GLTF_COMPONENT_TYPE_FLOAT = 5126
+};
+
+enum class GLTFAlphaMode : uint32_t
+{
+	GLTF_ALPHA_MODE_OPAQUE,
+	GLTF_ALPHA_MODE_MASK,
+	GLTF_ALPHA_MODE_BLEND
+};
+
+/*
+
+	Strided view over the elements of a glTF accessor.
+	Data points directly into the mapped file (or the GLB binary chunk), nothing is copied.
+
+*/
+struct GLTFAccessorView
+{
+	const uint8_t* Data = nullptr;
+	std::size_t Count = 0;
+	std::size_t Stride = 0;
+
+	GLTFComponentType ComponentType = GLTFComponentType::GLTF_COMPONENT_TYPE_FLOAT;
+	uint32_t NumComponents = 0;
+	bool Normalized = false;
+
+	bool HasBounds = false;
+	glm::vec3 Min = glm::vec3(0.0f);
+	glm::vec3 Max = glm::vec3(0.0f);
+
+	bool IsValid() const { return Data != nullptr; }
+
+	// Converts up to numComponents components of an element to floats, normalized integers are mapped to [0, 1] or [-1, 1]
+	void ReadFloats(std::size_t index, float* out, uint32_t numComponents) const;
+	uint32_t ReadIndex(std::size_t index) const;
+};
+
+struct GLTFPrimitive
+{
+	int PositionAccessor = -1;
+	int NormalAccessor = -1;
+	int TangentAccessor = -1;
+	int TexCoordAccessor = -1;
+	int IndexAccessor = -1;
+	int Material = -1;
+};
+
+struct GLTFMesh
+{
+	std::string Name;
+	std::vector<GLTFPrimitive> Primitives;
+};
+
+struct GLTFMaterial
+{
+	// Image indices, texture indirections are already resolved
+	int AlbedoImage = -1;
+	int NormalImage = -1;
+	int MetallicRoughnessImage = -1;
+
+	float MetallicFactor = 1.0f;
+	float RoughnessFactor = 1.0f;
+	GLTFAlphaMode AlphaMode = GLTFAlphaMode::GLTF_ALPHA_MODE_OPAQUE;
+	float AlphaCutoff = 0.5f;
+};
+
+struct GLTFNode
+{
+	std::string Name;
+	int Mesh = -1;
+	glm::mat4 Transform = glm::identity<glm::mat4>();
+	std::vector<std::size_t> Children;
+};
+
+/*
+
+	Minimal glTF 2.0 reader for .gltf (with external or embedded buffers) and binary .glb files.
+	Malformed documents (out of range indices, invalid numbers or node cycles) are rejected without throwing, see IsValid.
+	Files are memory mapped instead of copied, accessors are exposed as views into the mapped bytes,
+	and images are only decoded once they are acquired. Every material reference to an image counts as one use,
+	the decoded pixels are freed as soon as all uses have been released.
+
+*/
+class GLTFDocument
+{
+public:
+	GLTFDocument(const std::string& filepath);
+	~GLTFDocument();
+
+	bool IsValid() const { return m_IsValid; }
+
+	GLTFAccessorView GetAccessor(int accessorIndex) const;
+
+	const ImageInfo& AcquireImage(int imageIndex);
+	void ReleaseImage(int imageIndex);
+	std::size_t GetImageCount() const { return m_Images.size(); }
+
+	const std::vector<GLTFMesh>& GetMeshes() const { return m_Meshes; }
+	const std::vector<GLTFMaterial>& GetMaterials() const { return m_Materials; }
+	const std::vector<GLTFNode>& GetNodes() const { return m_Nodes; }
+	const std::vector<std::size_t>& GetRootNodes() const { return m_RootNodes; }
+
+private:
+	struct BufferRange
+	{
+		const uint8_t* Data = nullptr;
+		std::size_t ByteSize = 0;
+	};
+
+	struct BufferView
+	{
+		int Buffer = -1;
+		std::size_t ByteOffset = 0;
+		std::size_t ByteLength = 0;
+		std::size_t ByteStride = 0;
+	};
+
+	struct Accessor
+	{
+		int BufferView = -1;
+		std::size_t ByteOffset = 0;
+		std::size_t Count = 0;
+		GLTFComponentType ComponentType = GLTFComponentType::GLTF_COMPONENT_TYPE_FLOAT;
+		uint32_t NumComponents = 0;
+		bool Normalized = false;
+
+		bool HasBounds = false;
+		glm::vec3 Min = glm::vec3(0.0f);
+		glm::vec3 Max = glm::vec3(0.0f);
+	};
+
+	struct Image
+	{
+		std::string Uri;
+		int BufferView = -1;
+
+		ImageInfo Decoded = {};
+		uint32_t RemainingUses = 0;
+	};
+
+	// Every index in the document is validated while parsing, errors are logged and make the document invalid
+	bool Parse(const char* json, std::size_t jsonByteSize, const BufferRange& glbBinaryChunk);
+	bool ValidateNodeHierarchy() const;
+	BufferRange LoadUri(const std::string& uri);
+
+private:
+	std::string m_BaseDir;
+	bool m_IsValid = false;
+
+	std::vector<std::unique_ptr<MappedFile>> m_MappedFiles;
+	std::vector<std::vector<uint8_t>> m_EmbeddedData;
+
+	std::vector<BufferRange> m_Buffers;
+	std::vector<BufferView> m_BufferViews;
+	std::vector<Accessor> m_Accessors;
+	std::vector<Image> m_Images;
+
+	std::vector<GLTFMesh> m_Meshes;
+	std::vector<GLTFMaterial> m_Materials;
+	std::vector<GLTFNode> m_Nodes;
+	std::vector<std::size_t> m_RootNodes;
+
+};
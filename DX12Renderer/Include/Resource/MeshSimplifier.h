@@ -0,0 +1,52 @@
+#pragma once
+
+struct MeshSimplifierInput
+{
+	const uint8_t* Vertices = nullptr;
+	std::size_t VertexStride = 0;
+	std::size_t NumVertices = 0;
+	std::size_t PositionOffset = 0;
+
+	const uint32_t* Indices = nullptr;
+	std::size_t NumIndices = 0;
+};
+
+struct MeshSimplifierResult
+{
+	// Indices into the source vertices, the vertex buffer is shared by all levels of detail
+	std::vector<uint32_t> Indices;
+
+	// Object space distance by which the simplified surface deviates from the source surface
+	float Error = 0.0f;
+};
+
+struct MeshSimplifierStatistics
+{
+	uint64_t NumSourceTriangles = 0;
+	uint64_t NumLODTriangles = 0;
+	uint32_t NumLODs = 0;
+
+	// Summed over all threads
+	float SimplifyTime = 0.0f;
+};
+
+/*
+
+	Quadric error metric simplification (Garland & Heckbert), edges are collapsed onto one of their existing vertices
+	instead of an optimal new position, so simplified meshes only need a new index buffer.
+	Vertices on open borders and attribute seams are locked to keep the silhouette and texture mapping intact.
+	All functions are thread safe, so multiple meshes can be simplified in parallel on the job system.
+
+*/
+namespace MeshSimplifier
+{
+
+	MeshSimplifierResult Simplify(const MeshSimplifierInput& input, std::size_t targetIndexCount, float maxError = std::numeric_limits<float>::max());
+
+	// Every level targets half the triangles of the previous one, the chain ends once a level no longer reduces enough
+	std::vector<MeshSimplifierResult> GenerateLODChain(const MeshSimplifierInput& input, uint32_t maxLODs);
+
+	MeshSimplifierStatistics GetStatistics();
+	void ResetStatistics();
+
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include "Graphics/RenderAPI.h"
+#include "Resource/MeshSimplifier.h"
+
+class GLTFDocument;
+enum class GLTFAlphaMode : uint32_t;
+
+struct Vertex
+{
+	glm::vec3 Position;
+	glm::vec2 TexCoord;
+	glm::vec3 Normal;
+	glm::vec3 Tangent;
+	glm::vec3 Bitangent;
+};
+
+// Everything but the position, the attribute stream only the lighting pass reads
+struct VertexAttributes
+{
+	glm::vec2 TexCoord;
+	glm::vec3 Normal;
+	glm::vec3 Tangent;
+	glm::vec3 Bitangent;
+};
+
+// Read as R16G16B16A16_UNORM, W only pads the position to the element size
+struct QuantizedPosition
+{
+	uint16_t X;
+	uint16_t Y;
+	uint16_t Z;
+	uint16_t W;
+};
+
+struct ImportedPrimitive
+{
+	// Interleaved vertices are the working layout while the geometry is processed, they are released once the streams are built
+	TrackedVector<Vertex, MEMORY_TAG_ASSETS> Vertices;
+	TrackedVector<uint32_t, MEMORY_TAG_ASSETS> Indices;
+
+	// Vertex streams of the GPU mesh, positions in the position format and the remaining attributes interleaved
+	TrackedVector<uint8_t, MEMORY_TAG_ASSETS> PositionStream;
+	TrackedVector<VertexAttributes, MEMORY_TAG_ASSETS> AttributeStream;
+	std::size_t NumVertices = 0;
+	VertexPositionFormat PositionFormat = VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3;
+	glm::vec3 PositionScale = glm::vec3(1.0f);
+	glm::vec3 PositionOffset = glm::vec3(0.0f);
+
+	glm::vec3 MinBounds = glm::vec3(0.0f);
+	glm::vec3 MaxBounds = glm::vec3(0.0f);
+	bool HasTangents = false;
+
+	// Coarser levels of detail, they index into the same vertices
+	std::vector<MeshSimplifierResult> LODs;
+
+	std::string DebugName;
+
+	// Index into the materials of the document, -1 means the glTF default material
+	int Material = -1;
+};
+
+struct ImportedGeometry
+{
+	std::vector<ImportedPrimitive> Primitives;
+
+	// The primitives of glTF mesh i are [MeshFirstPrimitive[i], MeshFirstPrimitive[i + 1])
+	std::vector<std::size_t> MeshFirstPrimitive;
+};
+
+/*
+
+	CPU side of model loading, without any dependency on the graphics API.
+	The resource manager turns the result into GPU resources, the headless benchmark uses it as is.
+
+*/
+namespace ModelImporter
+{
+
+	constexpr uint32_t MAX_MESH_LODS = 4;
+
+	// Interleaves the vertex attributes and reads the indices of every primitive in the document
+	// Primitives with missing or too short attributes, or indices that are not whole triangles of existing vertices, are skipped with a warning
+	ImportedGeometry ReadGeometry(const GLTFDocument& document);
+
+	// Generates missing tangents and the LOD chains on the job system, then splits the vertices of every primitive into
+	// a position stream in the given format and an attribute stream, returns once all primitives are done
+	void ProcessGeometry(ImportedGeometry& geometry, VertexPositionFormat positionFormat = VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3);
+
+	uint32_t GetPositionByteSize(VertexPositionFormat format);
+	// Stores the positions of the vertices in the format, quantized positions are relative to the bounds of the vertices
+	void BuildVertexStreams(ImportedPrimitive& primitive, VertexPositionFormat positionFormat);
+
+	// MASK materials are alpha tested, BLEND materials are blended
+	TransparencyMode GetTransparencyMode(GLTFAlphaMode alphaMode);
+
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "Graphics/RenderAPI.h"
+#include "Util/Hash.h"
+
+enum class CachedResourceType : uint32_t
+{
+	CACHED_RESOURCE_TYPE_BUFFER,
+	CACHED_RESOURCE_TYPE_TEXTURE,
+	CACHED_RESOURCE_TYPE_MATERIAL,
+	CACHED_RESOURCE_TYPE_MESH,
+	CACHED_RESOURCE_TYPE_NUM_TYPES
+};
+
+struct ResourceCacheStatistics
+{
+	uint32_t NumHits = 0;
+	uint32_t NumMisses = 0;
+	// Lookups whose hash matched a resource with a different descriptor or payload size
+	uint32_t NumCollisions = 0;
+
+	std::size_t BytesHashed = 0;
+	std::size_t BytesDeduplicated = 0;
+	float HashTime = 0.0f;
+};
+
+/*
+
+	Content addressed cache for render resources.
+	Resources are keyed by a 128-bit hash of their decoded payload and the descriptor fields that affect the GPU resource,
+	so loading the same image or vertex data twice (within or across models) returns the existing handle.
+	A hit also has to match the descriptor and payload size of the cached resource, a hash collision creates a new uncached resource.
+	Every GetOrCreate call adds a reference which has to be matched by a Release call, uncached resources are freed by Release as well.
+	The cache locks internally and can be used from any thread, the resources themselves are created and destroyed through the Renderer.
+
+*/
+namespace ResourceCache
+{
+
+	Hash128 HashBufferDesc(const BufferDesc& desc);
+	Hash128 HashTextureDesc(const TextureDesc& desc);
+
+	RenderResourceHandle GetOrCreateBuffer(const BufferDesc& desc);
+	RenderResourceHandle GetOrCreateTexture(const TextureDesc& desc);
+	RenderResourceHandle GetOrCreateMaterial(const MaterialDesc& desc);
+	RenderResourceHandle GetOrCreateMesh(const MeshDesc& desc);
+
+	uint32_t AddRef(CachedResourceType type, RenderResourceHandle handle);
+	uint32_t Release(CachedResourceType type, RenderResourceHandle handle);
+	uint32_t GetRefCount(CachedResourceType type, RenderResourceHandle handle);
+
+	// Returns a copy, other threads might be updating the statistics
+	ResourceCacheStatistics GetStatistics();
+	void OnImGuiRender();
+
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+
+	Flat view over interleaved vertex data, attributes are addressed by their byte offset within a vertex.
+	Positions, normals and tangents are float3, texture coordinates float2. Indices form a triangle list.
+
+*/
+struct TangentGeneratorInput
+{
+	uint8_t* Vertices = nullptr;
+	std::size_t VertexStride = 0;
+	std::size_t NumVertices = 0;
+
+	std::size_t PositionOffset = 0;
+	std::size_t NormalOffset = 0;
+	std::size_t TexCoordOffset = 0;
+	std::size_t TangentOffset = 0;
+	std::size_t BitangentOffset = 0;
+
+	const uint32_t* Indices = nullptr;
+	std::size_t NumIndices = 0;
+};
+
+struct TangentGeneratorStatistics
+{
+	uint64_t NumTrianglesGenerated = 0;
+	uint64_t NumTrianglesFromCache = 0;
+	uint32_t NumCacheHits = 0;
+
+	// Summed over all threads
+	float GenerationTime = 0.0f;
+};
+
+/*
+
+	MikkTSpace tangent generation, results are cached on disk keyed by a hash of the input geometry.
+	Generate is thread safe, so multiple primitives can be processed in parallel on the job system.
+
+*/
+namespace TangentGenerator
+{
+
+	void Generate(const TangentGeneratorInput& input);
+
+	TangentGeneratorStatistics GetStatistics();
+	void ResetStatistics();
+
+};
@@ -12,11 +12,14 @@ public:
 	Camera(const glm::mat4& view, float fov, float aspect, float near, float far);
 	// Constructs an orthographic camera with a reverse-z projection
 	Camera(const glm::mat4& view, float left, float right, float bottom, float top, float near, float far);
+	// Constructs a camera from the matrices of another camera, e.g. a captured one, the projection can be perspective or orthographic
+	Camera(const glm::mat4& view, const glm::mat4& projection, float near, float far);
 	~Camera();
 
 	void Update(float deltaTime);
 	void ResizeProjection(float width, float height);
 	void SetViewMatrix(const glm::mat4& view);
+	void SetFrustumCulling(bool enableFrustumCulling) { m_EnableFrustumCulling = enableFrustumCulling; }
 	void OnImGuiRender();
 
 	const ViewFrustum& GetViewFrustum() const { return m_ViewFrustum; }
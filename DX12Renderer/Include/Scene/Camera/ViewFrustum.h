@@ -9,7 +9,10 @@ public:
 
 	void SetNearFarTangent(float near, float far, float tangent);
 
+	// Perspective bounds, calling this turns an orthographic frustum back into a perspective one
 	void UpdateBounds(float aspectRatio);
+	// Turns this into a box shaped frustum of an orthographic projection, the bounds are in view space
+	void SetOrthographicBounds(float left, float right, float bottom, float top);
 	void UpdatePlanes(const Transform& transform);
 
 	bool IsPointInViewFrustum(const glm::vec3& point) const;
@@ -42,4 +45,10 @@ private:
 
 	float m_Tangent = 0.0f;
 
+	bool m_IsOrthographic = false;
+	float m_Left = -1.0f;
+	float m_Right = 1.0f;
+	float m_Bottom = -1.0f;
+	float m_Top = 1.0f;
+
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+struct FrameTimeStatistics
+{
+	uint32_t NumSamples = 0;
+	float Min = 0.0f;
+	float Max = 0.0f;
+	float Average = 0.0f;
+	float StdDev = 0.0f;
+	float P50 = 0.0f;
+	float P95 = 0.0f;
+	float P99 = 0.0f;
+	float P999 = 0.0f;
+	// Samples in the window that took longer than the stutter factor times the median at the time they were added
+	uint32_t NumStutters = 0;
+};
+
+/*
+
+	Histogram of times in milliseconds with logarithmic buckets, so every bucket is equally precise relative to its time.
+	The bucket of a time is taken straight from the exponent and the upper mantissa bits of the float,
+	adding and removing a sample is a single increment or decrement. Times outside the range go into the outermost buckets.
+
+*/
+class FrameTimeHistogram
+{
+public:
+	// 64 buckets per power of two, a bucket is at most 1.6% wide relative to its lower bound
+	static constexpr uint32_t NUM_SUB_BUCKET_BITS = 6;
+	// Times from about a microsecond up to 16 seconds
+	static constexpr int32_t MIN_EXPONENT = -10;
+	static constexpr int32_t MAX_EXPONENT = 14;
+	static constexpr uint32_t NUM_BUCKETS = static_cast<uint32_t>(MAX_EXPONENT - MIN_EXPONENT) << NUM_SUB_BUCKET_BITS;
+
+public:
+	void Add(float milliseconds);
+	void Remove(float milliseconds);
+	void Clear();
+
+	// Middle of the bucket holding the sample at the percentile (0 to 100), 0 when there are no samples
+	float GetPercentile(float percentile) const;
+	uint32_t GetNumSamples() const { return m_NumSamples; }
+
+	static uint32_t GetBucket(float milliseconds);
+	static float GetBucketLowerBound(uint32_t bucket);
+
+private:
+	std::array<uint32_t, NUM_BUCKETS> m_Counts = {};
+	uint32_t m_NumSamples = 0;
+
+};
+
+/*
+
+	Statistics over the last windowSize samples, adding a sample is O(1): it replaces the oldest sample in the window,
+	updates the histogram the percentiles are read from and the running sums of the average and standard deviation.
+	The sums are recomputed from the window every time it wraps around, so rounding errors do not pile up.
+	A sample is a stutter when it takes longer than the stutter factor times the median of the window,
+	the median is refreshed from the histogram every few samples.
+
+*/
+class RollingFrameStatistics
+{
+public:
+	RollingFrameStatistics(uint32_t windowSize = 1024, float stutterFactor = 2.0f);
+
+	void AddSample(float milliseconds);
+	void Clear();
+
+	// Min and max are exact, percentiles have the precision of the histogram
+	FrameTimeStatistics GetStatistics() const;
+	// Samples in the window, oldest first
+	void GetSamples(std::vector<float>& outSamples) const;
+	const FrameTimeHistogram& GetHistogram() const { return m_Histogram; }
+
+	void SetStutterFactor(float stutterFactor) { m_StutterFactor = stutterFactor; }
+	float GetStutterFactor() const { return m_StutterFactor; }
+	uint32_t GetWindowSize() const { return static_cast<uint32_t>(m_Samples.size()); }
+	uint32_t GetNumSamples() const { return m_NumSamples; }
+	// Stutters since the statistics were created or cleared, including the ones that left the window
+	uint64_t GetNumTotalStutters() const { return m_NumTotalStutters; }
+
+private:
+	void RecomputeSums();
+
+private:
+	std::vector<float> m_Samples;
+	std::vector<uint8_t> m_IsStutter;
+	uint32_t m_NextSample = 0;
+	uint32_t m_NumSamples = 0;
+
+	FrameTimeHistogram m_Histogram;
+	double m_Sum = 0.0;
+	double m_SumOfSquares = 0.0;
+
+	float m_StutterFactor = 2.0f;
+	float m_Median = 0.0f;
+	uint32_t m_NumSamplesSinceMedian = 0;
+	uint32_t m_NumStutters = 0;
+	uint64_t m_NumTotalStutters = 0;
+
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+struct Hash128
+{
+	uint64_t Low = 0;
+	uint64_t High = 0;
+
+	bool operator==(const Hash128& other) const { return Low == other.Low && High == other.High; }
+	bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+struct Hash128Hasher
+{
+	std::size_t operator()(const Hash128& hash) const
+	{
+		// Both halves are already well mixed, folding them is enough for bucket selection
+		return static_cast<std::size_t>(hash.Low ^ hash.High);
+	}
+};
+
+class Hash
+{
+public:
+	/* Returns a 128-bit hash of the given bytes, uses the same round/avalanche structure as xxHash (4 lanes, 32 bytes per stripe) */
+	static Hash128 Bytes(const void* data, std::size_t byteSize, uint64_t seed = 0);
+
+	/* Returns a 128-bit hash of a trivially copyable value */
+	template<typename T>
+	static inline Hash128 Value(const T& value, uint64_t seed = 0)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Hash::Value only supports trivially copyable types");
+		return Bytes(&value, sizeof(T), seed);
+	}
+
+	/* Combines two hashes into one, the order of the arguments matters */
+	static Hash128 Combine(const Hash128& lhs, const Hash128& rhs);
+
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+struct JobCounter
+{
+	std::atomic<uint32_t> NumPendingJobs = 0;
+};
+
+/*
+
+	Small fire-and-forget job pool for CPU heavy work (e.g. asset processing during loading).
+	Jobs are tracked by a counter, the thread waiting on a counter helps executing jobs until it reaches zero.
+
+*/
+namespace JobSystem
+{
+
+	// Uses one worker less than the number of hardware threads when numWorkers is 0
+	void Initialize(uint32_t numWorkers = 0);
+	void Finalize();
+
+	void Execute(JobCounter& counter, std::function<void()> job);
+	void Wait(JobCounter& counter);
+	bool IsBusy(const JobCounter& counter);
+
+	uint32_t GetNumWorkers();
+
+};
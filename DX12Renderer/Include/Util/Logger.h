@@ -1,5 +1,128 @@
 #pragma once
 
+#include <string_view>
+#include <type_traits>
+
+// Messages below this severity are compiled out, 0 keeps everything, 1 keeps warnings and errors, 2 keeps errors
+#ifndef LOGGER_MIN_SEVERITY
+#define LOGGER_MIN_SEVERITY 0
+#endif
+
+class LogSink;
+
+// Arguments are copied into the ring by value, strings with their characters, and turned into text on the logger thread
+template<typename T, typename Enable = void>
+struct LogArgument
+{
+	static_assert(sizeof(T) == 0, "Type cannot be logged, convert it to a string or a number first");
+};
+
+template<typename T>
+struct LogArgument<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>>>
+{
+	static uint32_t GetByteSize(const T&) { return sizeof(T); }
+
+	static void Encode(uint8_t*& data, const T& value)
+	{
+		std::memcpy(data, &value, sizeof(T));
+		data += sizeof(T);
+	}
+
+	static void Decode(const uint8_t*& data, std::string& outText)
+	{
+		T value;
+		std::memcpy(&value, data, sizeof(T));
+		data += sizeof(T);
+
+		if constexpr (std::is_same_v<T, bool>)
+			outText += value ? "true" : "false";
+		else if constexpr (std::is_same_v<T, char>)
+			outText += value;
+		else if constexpr (std::is_enum_v<T>)
+			outText += std::to_string(static_cast<std::underlying_type_t<T>>(value));
+		else if constexpr (std::is_pointer_v<T>)
+		{
+			char pointer[32];
+			snprintf(pointer, sizeof(pointer), "%p", reinterpret_cast<const void*>(value));
+			outText += pointer;
+		}
+		else
+			outText += std::to_string(value);
+	}
+};
+
+struct LogStringArgument
+{
+	static uint32_t GetByteSize(std::size_t length) { return static_cast<uint32_t>(sizeof(uint32_t) + length); }
+
+	static void Encode(uint8_t*& data, const char* chars, std::size_t length)
+	{
+		uint32_t numChars = static_cast<uint32_t>(length);
+		std::memcpy(data, &numChars, sizeof(numChars));
+		std::memcpy(data + sizeof(numChars), chars, numChars);
+		data += sizeof(numChars) + numChars;
+	}
+
+	static void Decode(const uint8_t*& data, std::string& outText)
+	{
+		uint32_t numChars = 0;
+		std::memcpy(&numChars, data, sizeof(numChars));
+		outText.append(reinterpret_cast<const char*>(data + sizeof(numChars)), numChars);
+		data += sizeof(numChars) + numChars;
+	}
+};
+
+// Character pointers are strings, not addresses, their characters are copied since they may not outlive the call
+template<>
+struct LogArgument<const char*>
+{
+	static uint32_t GetByteSize(const char* value) { return LogStringArgument::GetByteSize(std::strlen(value)); }
+	static void Encode(uint8_t*& data, const char* value) { LogStringArgument::Encode(data, value, std::strlen(value)); }
+	static void Decode(const uint8_t*& data, std::string& outText) { LogStringArgument::Decode(data, outText); }
+};
+
+template<>
+struct LogArgument<char*> : LogArgument<const char*>
+{
+};
+
+template<typename Traits, typename Allocator>
+struct LogArgument<std::basic_string<char, Traits, Allocator>>
+{
+	using String = std::basic_string<char, Traits, Allocator>;
+
+	static uint32_t GetByteSize(const String& value) { return LogStringArgument::GetByteSize(value.size()); }
+	static void Encode(uint8_t*& data, const String& value) { LogStringArgument::Encode(data, value.data(), value.size()); }
+	static void Decode(const uint8_t*& data, std::string& outText) { LogStringArgument::Decode(data, outText); }
+};
+
+template<>
+struct LogArgument<std::string_view>
+{
+	static uint32_t GetByteSize(std::string_view value) { return LogStringArgument::GetByteSize(value.size()); }
+	static void Encode(uint8_t*& data, std::string_view value) { LogStringArgument::Encode(data, value.data(), value.size()); }
+	static void Decode(const uint8_t*& data, std::string& outText) { LogStringArgument::Decode(data, outText); }
+};
+
+struct LoggerStatistics
+{
+	uint64_t NumMessages = 0;
+	// Messages that found the ring of their thread full and had to wait until it was drained
+	uint64_t NumBlockedMessages = 0;
+	uint64_t NumWrittenBytes = 0;
+};
+
+/*
+
+	Asynchronous logger, a message is the address of its format string, a decode function picked by the argument types,
+	and a copy of the raw arguments, written into a ring of the calling thread without locks or allocations.
+	The logger thread drains the rings of all threads, formats the messages and writes them to the console and the file sinks.
+	Formats are string literals with {} for every argument, e.g. LOG_INFO("Loaded {} in {} ms", filepath, loadTime).
+	Messages of one thread keep their order, messages of different threads are only ordered by the time they were drained.
+	Errors are written before LOG_ERR returns, so they reach the sinks even when an assert follows, and a crash drains
+	everything that was logged before it. A thread whose ring is full waits for it to be drained instead of dropping messages.
+
+*/
 class Logger
 {
 public:
@@ -10,19 +133,91 @@ public:
 		ERR =  (WARN + 1)
 	};
 
+	using DecodeFunction = void(*)(const char* format, const uint8_t* data, std::string& outMessage);
+
 public:
-	/* Log a string to console with custom severity level */
-	static void Log(const char* message, Severity severity);
+	/* Log a message formatted from a string literal and its arguments */
+	template<std::size_t N, typename... Args>
+	static void Log(Severity severity, const char (&format)[N], const Args&... args)
+	{
+		uint32_t byteSize = (0 + ... + LogArgument<std::decay_t<Args>>::GetByteSize(args));
+		uint8_t* data = BeginMessage(severity, format, &Decode<std::decay_t<Args>...>, byteSize); (void)data;
+		(LogArgument<std::decay_t<Args>>::Encode(data, args), ...);
+		EndMessage(severity);
+	}
+
+	/* Log a string that was built by the caller, it is copied */
+	static void Log(Severity severity, const std::string& message)
+	{
+		Log(severity, "{}", message);
+	}
 
-	/* Log a string to console with custom severity level */
-	static void Log(const std::string& message, Severity severity);
+	static bool IsEnabled(Severity severity) { return static_cast<int>(severity) >= s_MinSeverity.load(std::memory_order_relaxed); }
+	static void SetMinSeverity(Severity severity) { s_MinSeverity.store(static_cast<int>(severity), std::memory_order_relaxed); }
+
+	// Rotates the file once it grows past maxByteSize, keeping numBackups older files as filepath.1 (newest) to filepath.numBackups
+	static bool AddFileSink(const std::string& filepath, std::size_t maxByteSize = MEGABYTE(16), uint32_t numBackups = 3);
+	static void AddSink(std::shared_ptr<LogSink> sink);
+	static void RemoveSink(const std::shared_ptr<LogSink>& sink);
+	static void SetConsoleOutput(bool enabled);
+
+	// Writes every message logged so far before returning
+	static void Flush();
+	// Flushes and stops the logger thread, messages logged afterwards are written before the call returns
+	static void Finalize();
+	static LoggerStatistics GetStatistics();
+
+	static const char* SeverityToString(Severity severity);
 
 private:
-	static inline const char* SeverityToString(Severity severity);
-	static inline void SetSeverityConsoleColor(Severity severity);
+	static uint8_t* BeginMessage(Severity severity, const char* format, DecodeFunction decode, uint32_t byteSize);
+	static void EndMessage(Severity severity);
+	static void Format(const char* format, const std::string* arguments, std::size_t numArguments, std::string& outMessage);
+
+	template<typename... Args>
+	static void Decode(const char* format, const uint8_t* data, std::string& outMessage)
+	{
+		// The comma fold runs from left to right, so the arguments are decoded in the order they were encoded
+		std::string arguments[sizeof...(Args) + 1];
+		std::size_t argument = 0; (void)data;
+		((LogArgument<Args>::Decode(data, arguments[argument++])), ...);
+
+		Format(format, arguments, sizeof...(Args), outMessage);
+	}
+
+private:
+	static inline std::atomic<int> s_MinSeverity = 0;
 
 };
 
-#define LOG_INFO(message) Logger::Log(message, Logger::Severity::INFO)
-#define LOG_WARN(message) Logger::Log(message, Logger::Severity::WARN)
-#define LOG_ERR(message) Logger::Log(message, Logger::Severity::ERR)
+/*
+
+	Destination of formatted messages, called from the logger thread only, or from the thread that flushes.
+	Lines end with a newline.
+
+*/
+class LogSink
+{
+public:
+	virtual ~LogSink() = default;
+
+	virtual void Write(Logger::Severity severity, const std::string& line) = 0;
+	virtual void Flush() {}
+
+};
+
+#define LOGGER_LOG(severity, ...) do { if (Logger::IsEnabled(severity)) Logger::Log(severity, __VA_ARGS__); } while (0)
+
+#if LOGGER_MIN_SEVERITY <= 0
+#define LOG_INFO(...) LOGGER_LOG(Logger::Severity::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOGGER_MIN_SEVERITY <= 1
+#define LOG_WARN(...) LOGGER_LOG(Logger::Severity::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#define LOG_ERR(...) LOGGER_LOG(Logger::Severity::ERR, __VA_ARGS__)
@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+
+	Read-only memory mapped file, pages are only read from disk once they are accessed.
+	The mapping stays valid for the lifetime of the object.
+
+*/
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const std::string& filepath);
+	~MappedFile();
+
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+
+	bool IsValid() const { return m_Data != nullptr; }
+	const uint8_t* GetData() const { return m_Data; }
+	std::size_t GetByteSize() const { return m_ByteSize; }
+
+private:
+#if defined(_WIN32)
+	HANDLE m_FileHandle = INVALID_HANDLE_VALUE;
+	HANDLE m_MappingHandle = nullptr;
+#else
+	int m_FileDescriptor = -1;
+#endif
+
+	const uint8_t* m_Data = nullptr;
+	std::size_t m_ByteSize = 0;
+
+};
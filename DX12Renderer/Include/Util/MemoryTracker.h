@@ -0,0 +1,135 @@
+#pragma once
+
+enum MemoryTag : uint32_t
+{
+	MEMORY_TAG_SCENE, MEMORY_TAG_ASSETS, MEMORY_TAG_RENDER, MEMORY_TAG_STRINGS, NUM_MEMORY_TAGS
+};
+
+enum GPUMemoryCategory : uint32_t
+{
+	GPU_MEMORY_CATEGORY_MESH_BUFFERS,
+	GPU_MEMORY_CATEGORY_MATERIAL_TEXTURES,
+	GPU_MEMORY_CATEGORY_SHADOW_MAPS,
+	GPU_MEMORY_CATEGORY_RENDER_TARGETS,
+	GPU_MEMORY_CATEGORY_UPLOAD,
+	GPU_MEMORY_CATEGORY_DESCRIPTOR_HEAPS,
+	GPU_MEMORY_CATEGORY_OTHER,
+	NUM_GPU_MEMORY_CATEGORIES
+};
+
+static constexpr uint32_t MEMORY_TRACKER_INVALID_ID = std::numeric_limits<uint32_t>::max();
+
+struct MemoryTagStatistics
+{
+	uint64_t ByteSize = 0;
+	uint64_t PeakByteSize = 0;
+	uint64_t NumAllocations = 0;
+	uint64_t NumTotalAllocations = 0;
+	// Change of ByteSize over the last frame
+	int64_t FrameDelta = 0;
+};
+
+struct GPUMemoryCategoryStatistics
+{
+	uint64_t ByteSize = 0;
+	uint64_t PeakByteSize = 0;
+	uint32_t NumResources = 0;
+	int64_t FrameDelta = 0;
+};
+
+struct MemoryStatistics
+{
+	std::array<MemoryTagStatistics, NUM_MEMORY_TAGS> Tags;
+	std::array<GPUMemoryCategoryStatistics, NUM_GPU_MEMORY_CATEGORIES> GPUCategories;
+
+	uint64_t CPUByteSize = 0;
+	uint64_t GPUByteSize = 0;
+	int64_t CPUFrameDelta = 0;
+	int64_t GPUFrameDelta = 0;
+};
+
+struct GPUMemoryResource
+{
+	std::string Name;
+	GPUMemoryCategory Category = GPU_MEMORY_CATEGORY_OTHER;
+	uint64_t ByteSize = 0;
+	// Frame the resource was created in, counted by EndFrame
+	uint64_t Frame = 0;
+};
+
+/*
+
+	Memory accounting for both sides of the renderer.
+	CPU memory is counted per tag by the containers that use a TrackedAllocator, the tag is a template argument, so counting
+	an allocation is two relaxed atomic adds on the counters of the tag, without any lookup or lock.
+	GPU memory is counted per resource, buffers, textures, descriptor heaps and upload memory add themselves when they are created
+	and remove themselves when they are released. Resources are only created and released occasionally, so they go through a lock.
+	EndFrame takes the frame over frame deltas, ReportLeaks lists everything that is still alive, e.g. on shutdown.
+
+*/
+namespace MemoryTracker
+{
+
+	void TrackAllocation(MemoryTag tag, std::size_t byteSize);
+	void TrackFree(MemoryTag tag, std::size_t byteSize);
+
+	// Returns the ID the resource is removed with
+	uint32_t AddGPUResource(const std::string& name, GPUMemoryCategory category, uint64_t byteSize);
+	void RemoveGPUResource(uint32_t resourceID);
+
+	void EndFrame();
+	MemoryStatistics GetStatistics();
+	// The numResources largest GPU resources that are alive, largest first
+	void GetLargestGPUResources(uint32_t numResources, std::vector<GPUMemoryResource>& outResources);
+	// Logs all GPU resources and tagged CPU memory that are still alive and returns the number of leaked GPU resources
+	uint32_t ReportLeaks();
+
+	const char* GetTagName(MemoryTag tag);
+	const char* GetGPUCategoryName(GPUMemoryCategory category);
+	void OnImGuiRender();
+
+};
+
+// Standard allocator that counts the memory of a container under a tag
+template<typename T, MemoryTag Tag>
+class TrackedAllocator
+{
+public:
+	using value_type = T;
+
+	template<typename U>
+	struct rebind
+	{
+		using other = TrackedAllocator<U, Tag>;
+	};
+
+public:
+	TrackedAllocator() = default;
+
+	template<typename U>
+	TrackedAllocator(const TrackedAllocator<U, Tag>&)
+	{
+	}
+
+	T* allocate(std::size_t numElements)
+	{
+		MemoryTracker::TrackAllocation(Tag, numElements * sizeof(T));
+		return std::allocator<T>().allocate(numElements);
+	}
+
+	void deallocate(T* ptr, std::size_t numElements)
+	{
+		MemoryTracker::TrackFree(Tag, numElements * sizeof(T));
+		std::allocator<T>().deallocate(ptr, numElements);
+	}
+
+	template<typename U>
+	bool operator==(const TrackedAllocator<U, Tag>&) const { return true; }
+	template<typename U>
+	bool operator!=(const TrackedAllocator<U, Tag>&) const { return false; }
+
+};
+
+template<typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+using TrackedString = std::basic_string<char, std::char_traits<char>, TrackedAllocator<char, MEMORY_TAG_STRINGS>>;
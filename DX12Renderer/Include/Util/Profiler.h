@@ -1,38 +1,126 @@
 #pragma once
+#include "Util/FrameStatistics.h"
+
 #include <chrono>
 
-struct TimerResult
+// Static description of an instrumented scope, created once per scope by SCOPED_TIMER and identified by its address
+struct ProfilerZone
+{
+	const char* Name = "";
+	const char* File = "";
+	uint32_t Line = 0;
+};
+
+// One node of the call tree of a thread, zones with the same parent and descriptor are merged into one node
+struct ProfilerZoneNode
+{
+	const ProfilerZone* Zone = nullptr;
+	uint32_t Depth = 0;
+	uint32_t NumCalls = 0;
+	float Duration = 0.0f;
+	float MaxDuration = 0.0f;
+};
+
+struct ProfilerThreadFrame
 {
-	TimerResult() = default;
+	std::string Name;
+	// Call tree in depth first order, zones are counted in the frame they end in
+	std::vector<ProfilerZoneNode> Nodes;
+};
 
+// Zone that ran on the GPU, placed on the CPU timeline with the clock calibration of the GPU
+struct ProfilerGPUZone
+{
 	const char* Name = "";
+	uint32_t Depth = 0;
+	std::chrono::steady_clock::time_point BeginTime;
 	float Duration = 0.0f;
 };
 
+// Rolling statistics of the time a zone takes per frame, summed over all its calls and threads, over the frames it ran in
+struct ProfilerZoneStatistics
+{
+	TrackedString Name;
+	bool IsGPUZone = false;
+	RollingFrameStatistics Statistics;
+};
+
+struct ProfilerStatistics
+{
+	uint32_t NumThreads = 0;
+	uint64_t NumZones = 0;
+	// Zones that were not recorded because the ring buffer of their thread was full
+	uint64_t NumDroppedZones = 0;
+};
+
+/*
+
+	Zone profiler, every thread records begin and end events of its zones into its own ring buffer, without locks.
+	Events are timestamps (the TSC where available, steady_clock otherwise) and a pointer to the static zone descriptor.
+	EndFrame marks the end of a frame and drains the rings of all threads into the call trees of the frame,
+	and into a trace capture when one is running. Captures are written as Chrome trace JSON, which Perfetto opens as well.
+	The frame time and the per frame time of every CPU and GPU zone also go into rolling statistics of the last frames.
+	A zone is only recorded when its ring has room for its end event, so a full ring drops whole zones and nesting stays intact.
+
+*/
 namespace Profiler
 {
 
-	void AddFrameTime(const TimerResult& result);
-	void AddCPUTimer(const TimerResult& result);
-	void AddGPUTimer(const TimerResult& result);
+	bool BeginZone(const ProfilerZone& zone);
+	void EndZone();
+	// Name of the calling thread in the profiler window and in traces
+	void SetThreadName(const std::string& name);
+
+	// Called once per frame by the main thread, the frame time is the time between two calls
+	void EndFrame();
+	// Writes a trace capture that did not reach its frame count yet and releases the zone statistics
+	void Finalize();
+
+	// Captures all zones of the next numFrames frames and writes them to filepath once the last one ended
+	void CaptureTrace(const std::string& filepath, uint32_t numFrames);
+	bool IsCapturingTrace();
+
+	float GetFrameTime();
+	const std::vector<ProfilerThreadFrame>& GetThreadFrames();
+	ProfilerStatistics GetStatistics();
+
+	// Frame times and zone times of the last frames, zones are added in the order they first ran
+	const RollingFrameStatistics& GetFrameStatistics();
+	const std::vector<ProfilerZoneStatistics>& GetZoneStatistics();
+	// Number of frames the statistics are kept for, changing it resets them
+	void SetStatisticsWindow(uint32_t numFrames);
+	// Frames longer than stutterFactor times the median frame are counted as stutters, for the frame and every zone
+	void SetStutterFactor(float stutterFactor);
+	float GetStutterFactor();
+	void ResetStatistics();
+	// Writes the frame and zone statistics as CSV when the filepath ends with .csv, as JSON otherwise
+	bool WriteStatisticsReport(const std::string& filepath);
+
+	// GPU zones of a completed GPU frame are added during a frame and shown once it ended, zone names have to stay valid
+	void AddGPUZones(const std::vector<ProfilerGPUZone>& zones);
+	const std::vector<ProfilerGPUZone>& GetGPUZones();
 	void OnImGuiRender();
-	void Reset();
 
 };
 
-class Timer
+class ProfilerScope
 {
 public:
-	Timer(const char* name);
-	~Timer();
+	ProfilerScope(const ProfilerZone& zone)
+		: m_IsRecorded(Profiler::BeginZone(zone))
+	{
+	}
 
-	void Stop();
+	~ProfilerScope()
+	{
+		if (m_IsRecorded)
+			Profiler::EndZone();
+	}
 
 private:
-	const char* m_Name;
-	std::chrono::time_point<std::chrono::steady_clock> m_StartTime;
-	bool m_IsStopped;
+	bool m_IsRecorded;
 
 };
 
-#define SCOPED_TIMER(name) Timer timer##__LINE__(name)
+#define SCOPED_TIMER(name) static constexpr ProfilerZone CONCAT(s_ProfilerZone, __LINE__) = { name, __FILE__, __LINE__ }; \
+	ProfilerScope CONCAT(profilerScope, __LINE__)(CONCAT(s_ProfilerZone, __LINE__))
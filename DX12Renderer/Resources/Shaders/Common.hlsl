@@ -42,16 +42,28 @@ struct SceneData
 	uint NumDirectionalLights;
 	uint NumPointLights;
 	uint NumSpotLights;
+	uint LightCullingMode;
+
+	uint ShadowAtlasIndex;
 };
 
+// Light culling modes, these have to match LightCullingMode in RenderState.h
+#define LIGHT_CULLING_MODE_CLUSTERED 0
+#define LIGHT_CULLING_MODE_PER_INSTANCE 1
+
+// Has to match MAX_SHADOW_CASCADES in ShadowCascades.h
+#define MAX_SHADOW_CASCADES 4
+
 struct DirectionalLight
 {
 	float3 Direction;
 	float3 Ambient;
 	float3 Color;
 
-	float4x4 ViewProjection;
-	uint ShadowMapIndex;
+	// Shadow atlas rects are the offset (xy) and scale (zw) of a tile in atlas texture coordinates, zero if the light has no tile
+	float4x4 CascadeViewProjections[MAX_SHADOW_CASCADES];
+	float4 CascadeAtlasRects[MAX_SHADOW_CASCADES];
+	uint NumCascades;
 };
 
 struct PointLight
@@ -61,7 +73,9 @@ struct PointLight
 	float3 Attenuation;
 	float3 Color;
 
-	uint ShadowMapIndex;
+	// Faces in the order +X, -X, +Y, -Y, +Z, -Z
+	float4x4 FaceViewProjections[6];
+	float4 ShadowAtlasRects[6];
 };
 
 struct SpotLight
@@ -75,7 +89,7 @@ struct SpotLight
 	float3 Color;
 
 	float4x4 ViewProjection;
-	uint ShadowMapIndex;
+	float4 ShadowAtlasRect;
 };
 
 struct LightCBData
@@ -92,6 +106,7 @@ struct Material
 	uint MetallicRoughnessTextureIndex;
 	float Metalness;
 	float Roughness;
+	float AlphaCutoff;
 };
 
 struct MaterialCBData
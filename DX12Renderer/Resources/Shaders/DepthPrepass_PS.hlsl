@@ -1,3 +1,27 @@
+#if ALPHA_TEST
+#include "Common.hlsl"
+
+struct PixelShaderInput
+{
+	float4 Position : SV_POSITION;
+	float2 TexCoord : TEXCOORD;
+	nointerpolation uint MaterialID : MATERIAL_ID;
+};
+
+ConstantBuffer<MaterialCBData> MaterialCB : register(b2);
+Texture2D Texture2DTable[] : register(t0, space0);
+SamplerState Sampler_Antisotropic_Wrap : register(s0, space0);
+
+// Masked materials only write the depth of the pixels whose albedo alpha reaches the alpha cutoff
+void main(PixelShaderInput IN)
+{
+	Material mat = MaterialCB.materials[IN.MaterialID];
+	float alpha = Texture2DTable[mat.AlbedoTextureIndex].Sample(Sampler_Antisotropic_Wrap, IN.TexCoord).a;
+
+	clip(alpha - mat.AlphaCutoff);
+}
+#else
 void main() : SV_TARGET
 {
 }
+#endif
@@ -1,22 +1,46 @@
 #include "Common.hlsl"
 
+// ALPHA_TEST: the masked pass, the pixel shader needs the texture coordinates and material of the vertex
+
 struct VertexShaderInput
 {
 	float3 Position : POSITION;
+#if ALPHA_TEST
+	float2 TexCoord : TEXCOORD;
+	uint MaterialID : MATERIAL_ID;
+#endif
 	float4x4 Transform : TRANSFORM;
+	float3 PositionScale : POSITION_SCALE;
+	float3 PositionOffset : POSITION_OFFSET;
+};
+
+struct VertexShaderOutput
+{
+	float4 Position : SV_POSITION;
+#if ALPHA_TEST
+	float2 TexCoord : TEXCOORD;
+	nointerpolation uint MaterialID : MATERIAL_ID;
+#endif
 };
 
 ConstantBuffer<GlobalConstantBufferData> GlobalCB : register(b0);
 ConstantBuffer<SceneData> SceneDataCB : register(b1);
 
-float4 main(VertexShaderInput IN) : SV_POSITION
+VertexShaderOutput main(VertexShaderInput IN)
 {
 	float4x4 jitterMatrix = SceneDataCB.ViewProjection;
 	jitterMatrix[0][2] += GlobalCB.TAA_HaltonJitter.x;
 	jitterMatrix[1][2] += GlobalCB.TAA_HaltonJitter.y;
 
-	float4 OutPosition = mul(IN.Transform, float4(IN.Position, 1.0f));
-	OutPosition = mul(jitterMatrix, OutPosition);
+	float3 position = IN.Position * IN.PositionScale + IN.PositionOffset;
+
+	VertexShaderOutput OUT;
+	OUT.Position = mul(IN.Transform, float4(position, 1.0f));
+	OUT.Position = mul(jitterMatrix, OUT.Position);
+#if ALPHA_TEST
+	OUT.TexCoord = IN.TexCoord;
+	OUT.MaterialID = IN.MaterialID;
+#endif
 
-	return OutPosition;
+	return OUT;
 }
\ No newline at end of file
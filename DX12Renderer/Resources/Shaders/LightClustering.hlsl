@@ -0,0 +1,38 @@
+// Cluster grid constants, these have to match LightClustering.h
+#define LIGHT_CLUSTER_GRID_SIZE_X 16
+#define LIGHT_CLUSTER_GRID_SIZE_Y 9
+#define LIGHT_CLUSTER_GRID_SIZE_Z 24
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y * LIGHT_CLUSTER_GRID_SIZE_Z)
+#define LIGHT_CLUSTER_MAX_LIGHTS 64
+
+struct ClusterCBData
+{
+	float4x4 View;
+
+	float2 ScreenSize;
+	float SliceScale;
+	float SliceBias;
+
+	uint NumSpotLights;
+	uint NumPointLights;
+	uint2 Padding;
+
+	// View space x and y per unit of depth for every tile boundary, and the view depth of every slice boundary, four per register
+	float4 TileSlopesX[(LIGHT_CLUSTER_GRID_SIZE_X + 1 + 3) / 4];
+	float4 TileSlopesY[(LIGHT_CLUSTER_GRID_SIZE_Y + 1 + 3) / 4];
+	float4 SliceDepths[(LIGHT_CLUSTER_GRID_SIZE_Z + 1 + 3) / 4];
+};
+
+// Reads one float of an array packed four per register
+#define GET_PACKED_FLOAT(values, index) values[(index) / 4][(index) % 4]
+
+uint GetClusterIndex(ClusterCBData grid, float2 pixel, float viewDepth)
+{
+	uint x = min(uint(pixel.x / grid.ScreenSize.x * LIGHT_CLUSTER_GRID_SIZE_X), LIGHT_CLUSTER_GRID_SIZE_X - 1);
+	uint y = min(uint(pixel.y / grid.ScreenSize.y * LIGHT_CLUSTER_GRID_SIZE_Y), LIGHT_CLUSTER_GRID_SIZE_Y - 1);
+
+	float slice = log(max(viewDepth, 1e-6f)) * grid.SliceScale + grid.SliceBias;
+	uint z = uint(clamp(slice, 0.0f, float(LIGHT_CLUSTER_GRID_SIZE_Z - 1)));
+
+	return x + y * LIGHT_CLUSTER_GRID_SIZE_X + z * LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y;
+}
@@ -0,0 +1,70 @@
+#include "LightClustering.hlsl"
+
+ConstantBuffer<ClusterCBData> ClusterCB : register(b0);
+// View space light bounding spheres, spotlights first followed by pointlights
+StructuredBuffer<float4> LightSpheres : register(t0);
+RWStructuredBuffer<uint> ClusterLightCounts : register(u0);
+RWStructuredBuffer<uint> ClusterLightIndices : register(u1);
+
+// The bounds and overlap test are marked precise and match LightClustering.cpp operation for operation,
+// this keeps the compiler from fusing or reordering them so the CPU reference produces bit-identical lists
+float GetAxisDistance(float center, float boundsMin, float boundsMax)
+{
+	precise float distance = max(max(boundsMin - center, center - boundsMax), 0.0f);
+	return distance;
+}
+
+// One thread per cluster, lights are tested in order so the lists do not depend on thread scheduling
+[numthreads(64, 1, 1)]
+void main(uint3 threadID : SV_DispatchThreadID)
+{
+	uint clusterIndex = threadID.x;
+	if (clusterIndex >= LIGHT_CLUSTER_COUNT)
+		return;
+
+	uint x = clusterIndex % LIGHT_CLUSTER_GRID_SIZE_X;
+	uint y = (clusterIndex / LIGHT_CLUSTER_GRID_SIZE_X) % LIGHT_CLUSTER_GRID_SIZE_Y;
+	uint z = clusterIndex / (LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y);
+
+	float nearDepth = GET_PACKED_FLOAT(ClusterCB.SliceDepths, z);
+	float farDepth = GET_PACKED_FLOAT(ClusterCB.SliceDepths, z + 1);
+
+	float slopeLeft = GET_PACKED_FLOAT(ClusterCB.TileSlopesX, x);
+	float slopeRight = GET_PACKED_FLOAT(ClusterCB.TileSlopesX, x + 1);
+	float slopeBottom = GET_PACKED_FLOAT(ClusterCB.TileSlopesY, y + 1);
+	float slopeTop = GET_PACKED_FLOAT(ClusterCB.TileSlopesY, y);
+
+	precise float3 boundsMin;
+	precise float3 boundsMax;
+	boundsMin.x = min(slopeLeft * nearDepth, slopeLeft * farDepth);
+	boundsMax.x = max(slopeRight * nearDepth, slopeRight * farDepth);
+	boundsMin.y = min(slopeBottom * nearDepth, slopeBottom * farDepth);
+	boundsMax.y = max(slopeTop * nearDepth, slopeTop * farDepth);
+	boundsMin.z = nearDepth;
+	boundsMax.z = farDepth;
+
+	uint numLights = 0;
+	uint numSpheres = ClusterCB.NumSpotLights + ClusterCB.NumPointLights;
+
+	for (uint lightIndex = 0; lightIndex < numSpheres; ++lightIndex)
+	{
+		float4 sphere = LightSpheres[lightIndex];
+		float dx = GetAxisDistance(sphere.x, boundsMin.x, boundsMax.x);
+		float dy = GetAxisDistance(sphere.y, boundsMin.y, boundsMax.y);
+		float dz = GetAxisDistance(sphere.z, boundsMin.z, boundsMax.z);
+
+		precise float distanceSquared = dx * dx + dy * dy;
+		distanceSquared = distanceSquared + dz * dz;
+		precise float radiusSquared = sphere.w * sphere.w;
+
+		if (distanceSquared <= radiusSquared)
+		{
+			if (numLights < LIGHT_CLUSTER_MAX_LIGHTS)
+				ClusterLightIndices[clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS + numLights] = lightIndex;
+
+			numLights++;
+		}
+	}
+
+	ClusterLightCounts[clusterIndex] = numLights;
+}
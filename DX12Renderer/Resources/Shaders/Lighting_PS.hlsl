@@ -1,5 +1,11 @@
 #include "Common.hlsl"
 #include "BRDF.hlsl"
+#include "LightClustering.hlsl"
+
+// Shader permutation defines (see ShaderPermutation.h), the variant is picked per draw
+// HAS_NORMAL_MAP: the material has a normal map, otherwise the interpolated normal is used
+// HAS_METALLIC_ROUGHNESS_MAP: the material has a metallic roughness map, otherwise only its factors are used
+// SHADOWED_LIGHTS_ONLY: every light of the frame has a shadow atlas tile, so the check for unshadowed lights is skipped
 
 struct PixelShaderInput
 {
@@ -12,15 +18,20 @@ struct PixelShaderInput
 	float3 Bitangent : BITANGENT;
 	float4 WorldPosition : WORLD_POSITION;
 	uint MaterialID : MATERIAL_ID;
+	nointerpolation uint2 LightList : LIGHT_LIST;
 };
 
 ConstantBuffer<GlobalConstantBufferData> GlobalCB : register(b0);
 ConstantBuffer<SceneData> SceneDataCB : register(b1);
 ConstantBuffer<MaterialCBData> MaterialCB : register(b2);
 ConstantBuffer<LightCBData> LightCB : register(b3);
+ConstantBuffer<ClusterCBData> ClusterCB : register(b4);
 
 Texture2D Texture2DTable[] : register(t0, space0);
 TextureCube TextureCubeTable[] : register(t0, space1);
+StructuredBuffer<uint> ClusterLightCounts : register(t0, space2);
+StructuredBuffer<uint> ClusterLightIndices : register(t1, space2);
+StructuredBuffer<uint> InstanceLightIndices : register(t2, space2);
 SamplerState Sampler_Antisotropic_Wrap : register(s0, space0);
 SamplerComparisonState Sampler_PCF : register(s0, space1);
 
@@ -38,19 +49,28 @@ PixelShaderOutput main(PixelShaderInput IN)
 {
 	Material mat = MaterialCB.materials[IN.MaterialID];
 
-	// Sample albedo color and normals from normal map
+	// Sample albedo color
 	float4 albedo = Texture2DTable[mat.AlbedoTextureIndex].Sample(Sampler_Antisotropic_Wrap, IN.TexCoord);
-	float3 normalTS = Texture2DTable[mat.NormalTextureIndex].Sample(Sampler_Antisotropic_Wrap, IN.TexCoord).xyz;
-	normalTS = (normalTS * 2.0f) - 1.0f;
 
 	// Sample metallic roughness and scale them by the factor in the material
+#if HAS_METALLIC_ROUGHNESS_MAP
 	float4 metallicRoughness = Texture2DTable[mat.MetallicRoughnessTextureIndex].Sample(Sampler_Antisotropic_Wrap, IN.TexCoord);
 	float metalness = metallicRoughness.b * mat.Metalness;
 	float roughness = metallicRoughness.g * mat.Roughness;
+#else
+	float metalness = mat.Metalness;
+	float roughness = mat.Roughness;
+#endif
 
-	// Get the fragments world position, the fragments world space normal and the view direction
+	// Get the fragments world position, the fragments world space normal (from the normal map) and the view direction
 	float4 fragPosWS = IN.WorldPosition;
+#if HAS_NORMAL_MAP
+	float3 normalTS = Texture2DTable[mat.NormalTextureIndex].Sample(Sampler_Antisotropic_Wrap, IN.TexCoord).xyz;
+	normalTS = (normalTS * 2.0f) - 1.0f;
 	float3 fragNormalWS = normalize(normalTS.x * IN.Tangent + normalTS.y * IN.Bitangent + normalTS.z * IN.Normal);
+#else
+	float3 fragNormalWS = normalize(IN.Normal);
+#endif
 	float3 viewDir = normalize(SceneDataCB.ViewPosition - fragPosWS);
 
 	float3 finalColor = float3(0.0f, 0.0f, 0.0f);
@@ -59,14 +79,33 @@ PixelShaderOutput main(PixelShaderInput IN)
 	if (SceneDataCB.NumDirectionalLights == 1)
 		finalColor += EvaluateDirectionalLight(fragPosWS, fragNormalWS, albedo, metalness, roughness, viewDir, LightCB.DirLight);
 
-	for (uint s = 0; s < SceneDataCB.NumSpotLights; ++s)
+	// Only walk the spot and pointlights assigned to the cluster of this fragment, or to the instance it belongs to
+	// Both lists use the same indices: spotlights first, pointlights start at NumSpotLights
+	uint numLights = 0;
+	uint firstLight = 0;
+
+	if (SceneDataCB.LightCullingMode == LIGHT_CULLING_MODE_PER_INSTANCE)
 	{
-		finalColor += EvaluateSpotLight(fragPosWS, fragNormalWS, albedo, metalness, roughness, viewDir, LightCB.SpotLights[s]);
+		firstLight = IN.LightList.x;
+		numLights = IN.LightList.y;
+	}
+	else
+	{
+		float viewDepth = mul(ClusterCB.View, fragPosWS).z;
+		uint clusterIndex = GetClusterIndex(ClusterCB, IN.Position.xy, viewDepth);
+		firstLight = clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS;
+		numLights = min(ClusterLightCounts[clusterIndex], LIGHT_CLUSTER_MAX_LIGHTS);
 	}
 
-	for (uint p = 0; p < SceneDataCB.NumPointLights; ++p)
+	for (uint l = 0; l < numLights; ++l)
 	{
-		finalColor += EvaluatePointLight(fragPosWS, fragNormalWS, albedo, metalness, roughness, viewDir, LightCB.PointLights[p]);
+		uint lightIndex = SceneDataCB.LightCullingMode == LIGHT_CULLING_MODE_PER_INSTANCE ?
+			InstanceLightIndices[firstLight + l] : ClusterLightIndices[firstLight + l];
+
+		if (lightIndex < ClusterCB.NumSpotLights)
+			finalColor += EvaluateSpotLight(fragPosWS, fragNormalWS, albedo, metalness, roughness, viewDir, LightCB.SpotLights[lightIndex]);
+		else
+			finalColor += EvaluatePointLight(fragPosWS, fragNormalWS, albedo, metalness, roughness, viewDir, LightCB.PointLights[lightIndex - ClusterCB.NumSpotLights]);
 	}
 
 	// Render HDR color to SV_Target0
@@ -91,29 +130,22 @@ float DistanceAttenuation(float3 lightAttenuation, float distance)
 	return max(attenuation, 0.0f);
 }
 
-float DirectionToDepthValue(float3 direction, float near, float far)
-{
-	float3 absDir = abs(direction);
-	// Get face of cubemap we will be sampling from
-	float localZComp = max(absDir.x, max(absDir.y, absDir.z));
-
-	// Transform depth into range of 0..1 with the corresponding near and far plane
-	float normZComp = (far + near) / (far - near) - (2 * far * near) / (far - near) / localZComp;
-	return (normZComp + 1.0f) * 0.5f;
-}
-
-float SamplePCF(float2 baseUV, float uOff, float vOff, float compDepth, float invShadowMapRes, uint shadowMapIndex)
+float SamplePCF(float2 baseUV, float uOff, float vOff, float compDepth, float2 invShadowMapRes, float4 atlasRect)
 {
+	// Keep the taps inside the tile, so neighbouring tiles in the shadow atlas never bleed in
 	float2 uv = baseUV + float2(uOff, vOff) * invShadowMapRes;
-	return Texture2DTable[shadowMapIndex].SampleCmpLevelZero(Sampler_PCF, uv, compDepth);
+	uv = clamp(uv, atlasRect.xy + 0.5f * invShadowMapRes, atlasRect.xy + atlasRect.zw - 0.5f * invShadowMapRes);
+	return Texture2DTable[SceneDataCB.ShadowAtlasIndex].SampleCmpLevelZero(Sampler_PCF, uv, compDepth);
 }
 
-float SampleShadowPCF(float2 uv, float compDepth, uint shadowMapIndex)
+float SampleShadowPCF(float2 uv, float compDepth, float4 atlasRect)
 {
 	float2 shadowMapRes;
-	Texture2DTable[shadowMapIndex].GetDimensions(shadowMapRes.x, shadowMapRes.y);
+	Texture2DTable[SceneDataCB.ShadowAtlasIndex].GetDimensions(shadowMapRes.x, shadowMapRes.y);
 	float2 invShadowMapRes = 1.0f / shadowMapRes;
 
+	// Texture coordinates of the tile to texture coordinates of the shadow atlas
+	uv = atlasRect.xy + uv * atlasRect.zw;
 	uv *= shadowMapRes;
 
 	float2 baseUV;
@@ -144,81 +176,29 @@ float SampleShadowPCF(float2 uv, float compDepth, uint shadowMapIndex)
 
 	float acc = 0.0f;
 
-	acc += uw0 * vw0 * SamplePCF(baseUV, u0, v0, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw0 * SamplePCF(baseUV, u1, v0, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw0 * SamplePCF(baseUV, u2, v0, compDepth, invShadowMapRes, shadowMapIndex);
+	acc += uw0 * vw0 * SamplePCF(baseUV, u0, v0, compDepth, invShadowMapRes, atlasRect);
+	acc += uw1 * vw0 * SamplePCF(baseUV, u1, v0, compDepth, invShadowMapRes, atlasRect);
+	acc += uw2 * vw0 * SamplePCF(baseUV, u2, v0, compDepth, invShadowMapRes, atlasRect);
 
-	acc += uw0 * vw1 * SamplePCF(baseUV, u0, v1, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw1 * SamplePCF(baseUV, u1, v1, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw1 * SamplePCF(baseUV, u2, v1, compDepth, invShadowMapRes, shadowMapIndex);
+	acc += uw0 * vw1 * SamplePCF(baseUV, u0, v1, compDepth, invShadowMapRes, atlasRect);
+	acc += uw1 * vw1 * SamplePCF(baseUV, u1, v1, compDepth, invShadowMapRes, atlasRect);
+	acc += uw2 * vw1 * SamplePCF(baseUV, u2, v1, compDepth, invShadowMapRes, atlasRect);
 
-	acc += uw0 * vw2 * SamplePCF(baseUV, u0, v2, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw2 * SamplePCF(baseUV, u1, v2, compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw2 * SamplePCF(baseUV, u2, v2, compDepth, invShadowMapRes, shadowMapIndex);
+	acc += uw0 * vw2 * SamplePCF(baseUV, u0, v2, compDepth, invShadowMapRes, atlasRect);
+	acc += uw1 * vw2 * SamplePCF(baseUV, u1, v2, compDepth, invShadowMapRes, atlasRect);
+	acc += uw2 * vw2 * SamplePCF(baseUV, u2, v2, compDepth, invShadowMapRes, atlasRect);
 
 	return acc *= 1.0f / 144;
 }
 
-float SamplePCFCube(float3 lightToFrag, float3 baseDir, float3 dirOffset, float compDepth, float invShadowMapRes, uint shadowMapIndex)
+float EvaluateDirectionalShadow(float4 fragPosLS, float angle, float4 atlasRect)
 {
-	float3 offset = baseDir + dirOffset * invShadowMapRes;
-	float3 normDir = normalize(lightToFrag);
-	return TextureCubeTable[shadowMapIndex].SampleCmpLevelZero(Sampler_PCF, float3(normDir.x + offset.x, normDir.y + offset.y, normDir.z + offset.z), compDepth);
-}
-
-float SampleShadowPCF(float3 lightToFrag, float compDepth, uint shadowMapIndex)
-{
-	float2 shadowMapRes;
-	Texture2DTable[shadowMapIndex].GetDimensions(shadowMapRes.x, shadowMapRes.y);
-	float2 invShadowMapRes = 1.0f / shadowMapRes;
-
-	float3 nDir = normalize(lightToFrag) * float3(shadowMapRes, 1.0f);
-	float3 baseDir;
-	baseDir.x = (nDir.x + 0.5f);
-	baseDir.y = (nDir.y + 0.5f);
-	baseDir.z = nDir.z;
-
-	float s = (nDir.x + 0.5f - baseDir.x);
-	float t = (nDir.y + 0.5f - baseDir.y);
-
-	baseDir.xy -= float2(0.5f, 0.5f);
-	baseDir.xy *= invShadowMapRes.xy;
+	// Lights that did not get a shadow atlas tile are not shadowed
+#if !SHADOWED_LIGHTS_ONLY
+	if (atlasRect.z == 0.0f)
+		return 0.0f;
+#endif
 
-	float uw0 = (4 - 3 * s);
-	float uw1 = 7;
-	float uw2 = (1 + 3 * s);
-
-	float u0 = (3 - 2 * s) / uw0 - 2;
-	float u1 = (3 + s) / uw1;
-	float u2 = s / uw2 + 2;
-
-	float vw0 = (4 - 3 * t);
-	float vw1 = 7;
-	float vw2 = (1 + 3 * t);
-
-	float v0 = (3 - 2 * t) / vw0 - 2;
-	float v1 = (3 + t) / vw1;
-	float v2 = t / vw2 + 2;
-
-	float acc = 0.0f;
-
-	acc += uw0 * vw0 * SamplePCFCube(lightToFrag, baseDir, float3(u0, v0, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw0 * SamplePCFCube(lightToFrag, baseDir, float3(u1, v0, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw0 * SamplePCFCube(lightToFrag, baseDir, float3(u2, v0, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-
-	acc += uw0 * vw1 * SamplePCFCube(lightToFrag, baseDir, float3(u0, v1, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw1 * SamplePCFCube(lightToFrag, baseDir, float3(u1, v1, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw1 * SamplePCFCube(lightToFrag, baseDir, float3(u2, v1, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-
-	acc += uw0 * vw2 * SamplePCFCube(lightToFrag, baseDir, float3(u0, v2, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw1 * vw2 * SamplePCFCube(lightToFrag, baseDir, float3(u1, v2, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-	acc += uw2 * vw2 * SamplePCFCube(lightToFrag, baseDir, float3(u2, v2, baseDir.z), compDepth, invShadowMapRes, shadowMapIndex);
-
-	return acc *= 1.0f / 144;
-}
-
-float EvaluateDirectionalShadow(float4 fragPosLS, float angle, uint shadowMapIndex)
-{
 	float3 projectedCoords = fragPosLS.xyz / fragPosLS.w;
 	float currentDepth = projectedCoords.z;
 	projectedCoords = projectedCoords * 0.5f;
@@ -228,25 +208,26 @@ float EvaluateDirectionalShadow(float4 fragPosLS, float angle, uint shadowMapInd
 
 	float shadow = 0.0f;
 
-	if (projectedCoords.z > 1.0f || projectedCoords.z < 0.0f)
+	// Outside of its tile a light has no depth to compare against, like outside the border of a separate shadow map
+	if (projectedCoords.z > 1.0f || projectedCoords.z < 0.0f || any(projectedCoords.xy < 0.0f) || any(projectedCoords.xy > 1.0f))
 		shadow = 1.0f;
 	else
-		shadow = SampleShadowPCF(projectedCoords.xy, currentDepth, shadowMapIndex);
+		shadow = SampleShadowPCF(projectedCoords.xy, currentDepth, atlasRect);
 
 	return shadow;
 }
 
-float EvaluateOmnidirectionalShadow(float3 lightToFrag, float angle, float farPlane, uint shadowMapIndex)
+uint GetCubeFace(float3 direction)
 {
-	float currentDepth = DirectionToDepthValue(lightToFrag, farPlane, 0.1f);
-	float shadow = 0.0f;
+	// Same face order as the pointlight cameras: +X, -X, +Y, -Y, +Z, -Z
+	float3 absDir = abs(direction);
 
-	if (currentDepth > 1.0f || currentDepth < 0.0f)
-		shadow = 1.0f;
+	if (absDir.x >= absDir.y && absDir.x >= absDir.z)
+		return direction.x >= 0.0f ? 0 : 1;
+	else if (absDir.y >= absDir.z)
+		return direction.y >= 0.0f ? 2 : 3;
 	else
-		shadow = SampleShadowPCF(lightToFrag, currentDepth, shadowMapIndex);
-
-	return shadow;
+		return direction.z >= 0.0f ? 4 : 5;
 }
 
 float3 EvaluateDirectionalLight(float4 fragPosWS, float3 fragNormal, float3 albedo, float metalness, float roughness, float3 viewDir, DirectionalLight dirLight)
@@ -255,9 +236,19 @@ float3 EvaluateDirectionalLight(float4 fragPosWS, float3 fragNormal, float3 albe
 	float NoL = clamp(dot(fragNormal, fragToLight), 0.0f, 1.0f);
 	float3 Lo = float3(0.0f, 0.0f, 0.0f);
 
-	// Check if current fragment is in shadow
-	float4 fragPosLS = mul(dirLight.ViewProjection, fragPosWS);
-	float shadow = EvaluateDirectionalShadow(fragPosLS, NoL, dirLight.ShadowMapIndex);
+	// Check if current fragment is in shadow, using the first cascade that contains it
+	// Fragments beyond the last cascade are past the shadow distance and not shadowed
+	float shadow = 0.0f;
+	for (uint c = 0; c < dirLight.NumCascades; ++c)
+	{
+		float4 fragPosLS = mul(dirLight.CascadeViewProjections[c], fragPosWS);
+
+		if (all(abs(fragPosLS.xy) <= 1.0f) && fragPosLS.z >= 0.0f && fragPosLS.z <= 1.0f)
+		{
+			shadow = EvaluateDirectionalShadow(fragPosLS, NoL, dirLight.CascadeAtlasRects[c]);
+			break;
+		}
+	}
 
 	// Evaluate BRDF
 	float3 halfVec = normalize(viewDir + fragToLight);
@@ -289,7 +280,7 @@ float3 EvaluateSpotLight(float4 fragPosWS, float3 fragNormal, float3 albedo, flo
 			{
 				// Check if current fragment is in shadow
 				float4 fragPosLS = mul(spotLight.ViewProjection, fragPosWS);
-				float shadow = EvaluateDirectionalShadow(fragPosLS, NoL, spotLight.ShadowMapIndex);
+				float shadow = EvaluateDirectionalShadow(fragPosLS, NoL, spotLight.ShadowAtlasRect);
 
 				// Evaluate BRDF
 				float3 halfVec = normalize(viewDir + fragToLight);
@@ -325,9 +316,10 @@ float3 EvaluatePointLight(float4 fragPosWS, float3 fragNormal, float3 albedo, fl
 
 		if (NoL > 0.0f)
 		{
-			// Check if current fragment is in shadow
-			float3 lightToFrag = fragPosWS.xyz - pointLight.Position;
-			float shadow = EvaluateOmnidirectionalShadow(lightToFrag, NoL, pointLight.Range, pointLight.ShadowMapIndex);
+			// Check if current fragment is in shadow, every face is a perspective shadow map in its own shadow atlas tile
+			uint face = GetCubeFace(fragPosWS.xyz - pointLight.Position);
+			float4 fragPosLS = mul(pointLight.FaceViewProjections[face], fragPosWS);
+			float shadow = EvaluateDirectionalShadow(fragPosLS, NoL, pointLight.ShadowAtlasRects[face]);
 
 			// Evaluate BRDF
 			float3 halfVec = normalize(viewDir + fragToLight);
@@ -10,6 +10,9 @@ struct VertexShaderInput
 	matrix Transform : TRANSFORM;
 	matrix PrevFrameTransform : PREV_FRAME_TRANSFORM;
 	uint MaterialID : MATERIAL_ID;
+	uint2 LightList : LIGHT_LIST;
+	float3 PositionScale : POSITION_SCALE;
+	float3 PositionOffset : POSITION_OFFSET;
 };
 
 ConstantBuffer<GlobalConstantBufferData> GlobalCB : register(b0);
@@ -26,14 +29,18 @@ struct VertexShaderOutput
 	float3 Bitangent : BITANGENT;
 	float4 WorldPosition : WORLD_POSITION;
 	uint MaterialID : MATERIAL_ID;
+	nointerpolation uint2 LightList : LIGHT_LIST;
 };
 
 VertexShaderOutput main(VertexShaderInput IN)
 {
 	VertexShaderOutput OUT;
 
+	// Positions come from the position stream the depth pre-pass reads as well, so both passes compute the same depth
+	float3 position = IN.Position * IN.PositionScale + IN.PositionOffset;
+
 	// Calculate world position of vertex and store it in the vertex shader output
-	OUT.Position = mul(IN.Transform, float4(IN.Position, 1.0f));
+	OUT.Position = mul(IN.Transform, float4(position, 1.0f));
 	OUT.WorldPosition = OUT.Position;
 
 	// Apply jitter to the current vertex position
@@ -45,7 +52,7 @@ VertexShaderOutput main(VertexShaderInput IN)
 
 	// Calculate current and previous non-jittered position for velocity
 	OUT.CurrentPosNoJitter = mul(SceneDataCB.ViewProjection, OUT.WorldPosition);
-	OUT.PreviousPosNoJitter = mul(IN.PrevFrameTransform, float4(IN.Position, 1.0f));
+	OUT.PreviousPosNoJitter = mul(IN.PrevFrameTransform, float4(position, 1.0f));
 	OUT.PreviousPosNoJitter = mul(GlobalCB.PrevViewProj, OUT.PreviousPosNoJitter);
 
 	OUT.TexCoord = IN.TexCoord;
@@ -53,6 +60,7 @@ VertexShaderOutput main(VertexShaderInput IN)
 	OUT.Tangent = IN.Tangent;
 	OUT.Bitangent = IN.Bitangent;
 	OUT.MaterialID = IN.MaterialID;
+	OUT.LightList = IN.LightList;
 
 	return OUT;
 }
\ No newline at end of file
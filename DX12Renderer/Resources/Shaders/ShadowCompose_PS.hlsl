@@ -0,0 +1,14 @@
+struct StaticLayer
+{
+	uint TextureIndex;
+};
+
+ConstantBuffer<StaticLayer> StaticLayerCB : register(b0);
+
+Texture2D Texture2DTable[] : register(t0, space0);
+
+float main(float4 position : SV_POSITION) : SV_Depth
+{
+	// The static layer has the same tiles as the shadow atlas, so the depth is copied texel by texel
+	return Texture2DTable[StaticLayerCB.TextureIndex].Load(int3(position.xy, 0)).r;
+}
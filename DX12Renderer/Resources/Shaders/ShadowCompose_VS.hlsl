@@ -0,0 +1,15 @@
+struct VertexShaderOutput
+{
+	float4 Position : SV_POSITION;
+};
+
+VertexShaderOutput main(uint vertexID : SV_VertexID)
+{
+	VertexShaderOutput OUT;
+
+	// One triangle covering the whole viewport, the viewport and scissor rect select the shadow atlas tile
+	float2 uv = float2((vertexID << 1) & 2, vertexID & 2);
+	OUT.Position = float4(uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+
+	return OUT;
+}
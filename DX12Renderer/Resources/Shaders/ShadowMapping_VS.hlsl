@@ -1,7 +1,24 @@
+// ALPHA_TEST: the masked pass, the pixel shader needs the texture coordinates and material of the vertex
+
 struct VertexShaderInput
 {
 	float3 Position : POSITION;
+#if ALPHA_TEST
+	float2 TexCoord : TEXCOORD;
+	uint MaterialID : MATERIAL_ID;
+#endif
 	matrix Transform : TRANSFORM;
+	float3 PositionScale : POSITION_SCALE;
+	float3 PositionOffset : POSITION_OFFSET;
+};
+
+struct VertexShaderOutput
+{
+	float4 Position : SV_POSITION;
+#if ALPHA_TEST
+	float2 TexCoord : TEXCOORD;
+	nointerpolation uint MaterialID : MATERIAL_ID;
+#endif
 };
 
 struct LightMatrix
@@ -11,13 +28,21 @@ struct LightMatrix
 
 ConstantBuffer<LightMatrix> LightMatrixCB : register(b0);
 
-float4 main(VertexShaderInput IN) : SV_POSITION
+VertexShaderOutput main(VertexShaderInput IN)
 {
-	float4 lightViewSpacePos = float4(IN.Position, 1.0f);
+	// Quantized positions are relative to the bounds of the mesh
+	float4 lightViewSpacePos = float4(IN.Position * IN.PositionScale + IN.PositionOffset, 1.0f);
 
 	// Transform vertex into light view space
 	lightViewSpacePos = mul(IN.Transform, lightViewSpacePos);
 	lightViewSpacePos = mul(LightMatrixCB.LightViewProjection, lightViewSpacePos);
 
-	return lightViewSpacePos;
+	VertexShaderOutput OUT;
+	OUT.Position = lightViewSpacePos;
+#if ALPHA_TEST
+	OUT.TexCoord = IN.TexCoord;
+	OUT.MaterialID = IN.MaterialID;
+#endif
+
+	return OUT;
 }
\ No newline at end of file
@@ -4,15 +4,21 @@
 #include "Graphics/Renderer.h"
 #include "Graphics/DebugRenderer.h"
 #include "Graphics/GUIRenderer.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
+#include "Graphics/Backend/D3D12RenderBackend.h"
 #include "Scene/Scene.h"
 #include "InputHandler.h"
 #include "Resource/ResourceManager.h"
+#include "Resource/ResourceCache.h"
+#include "Util/JobSystem.h"
 
 #include <imgui/imgui.h>
 
 static Application* s_Instance = nullptr;
 
+// Frames a benchmark runs before it measures, so loading and pipeline creation stay out of the statistics
+static constexpr uint32_t APPLICATION_BENCHMARK_WARMUP_FRAMES = 60;
+
 void Application::Create()
 {
 	if (!s_Instance)
@@ -42,7 +48,12 @@ Application::~Application()
 
 void Application::Initialize(HINSTANCE hInst, uint32_t width, uint32_t height)
 {
+	Logger::AddFileSink("Logs/DX12Renderer.log");
 	Random::Initialize();
+	Profiler::SetThreadName("Main thread");
+
+	JobSystem::Initialize();
+	LOG_INFO("[JobSystem] Initialized JobSystem with {} workers", JobSystem::GetNumWorkers());
 
 	WindowProps windowProps = {};
 	windowProps.Title = L"DX12 Renderer";
@@ -54,7 +65,8 @@ void Application::Initialize(HINSTANCE hInst, uint32_t width, uint32_t height)
 	m_Window->Show();
 	LOG_INFO("[Window] Initialized Window");
 
-	Renderer::Initialize(m_Window->GetHandle(), m_Window->GetWidth(), m_Window->GetHeight());
+	Renderer::Initialize(std::make_unique<D3D12RenderBackend>(m_Window->GetHandle(), m_Window->GetWidth(), m_Window->GetHeight()),
+		m_Window->GetWidth(), m_Window->GetHeight());
 	LOG_INFO("[Renderer] Initialized Renderer");
 
 	DebugRenderer::Initialize(m_Window->GetWidth(), m_Window->GetHeight());
@@ -78,11 +90,10 @@ void Application::Run()
 {
 	std::chrono::time_point current = std::chrono::high_resolution_clock::now(), last = std::chrono::high_resolution_clock::now();
 	std::chrono::duration<float> deltaTime = std::chrono::duration<float>(0.0f);
+	uint32_t numFrames = 0;
 
 	while (!m_Window->ShouldClose())
 	{
-		SCOPED_TIMER("Frametime");
-
 		current = std::chrono::high_resolution_clock::now();
 		deltaTime = current - last;
 
@@ -91,6 +102,26 @@ void Application::Run()
 		Render();
 
 		last = current;
+		Profiler::EndFrame();
+		MemoryTracker::EndFrame();
+
+		if (m_NumBenchmarkFrames > 0)
+		{
+			numFrames++;
+			if (numFrames == APPLICATION_BENCHMARK_WARMUP_FRAMES)
+			{
+				Profiler::SetStatisticsWindow(m_NumBenchmarkFrames);
+			}
+			else if (numFrames == APPLICATION_BENCHMARK_WARMUP_FRAMES + m_NumBenchmarkFrames)
+			{
+				FrameTimeStatistics stats = Profiler::GetFrameStatistics().GetStatistics();
+				LOG_INFO("[Benchmark] {} frames: avg {} ms, p50 {} ms, p99 {} ms, p99.9 {} ms, {} stutters", stats.NumSamples, stats.Average, stats.P50,
+					stats.P99, stats.P999, stats.NumStutters);
+
+				Profiler::WriteStatisticsReport(m_BenchmarkReportFilepath);
+				break;
+			}
+		}
 	}
 }
 
@@ -105,8 +136,23 @@ void Application::Finalize()
 	Renderer::Finalize();
 	LOG_INFO("Finalized Renderer");
 
+	// Every GPU resource belongs to the renderer, so anything still alive at this point leaked
+	MemoryTracker::ReportLeaks();
+
 	m_Window->Finalize();
 	LOG_INFO("Finalized Window");
+
+	JobSystem::Finalize();
+	LOG_INFO("Finalized JobSystem");
+
+	Profiler::Finalize();
+	Logger::Finalize();
+}
+
+void Application::SetBenchmarkMode(uint32_t numFrames, const std::string& reportFilepath)
+{
+	m_NumBenchmarkFrames = numFrames;
+	m_BenchmarkReportFilepath = reportFilepath;
 }
 
 void Application::OnWindowResize(uint32_t width, uint32_t height)
@@ -178,7 +224,29 @@ void Application::Render()
 			ImGui::PushID("Render Backend");
 			ImGui::Indent(10.0f);
 
-			RenderBackend::OnImGuiRender();
+			D3D12Backend::OnImGuiRender();
+
+			ImGui::Unindent(10.0f);
+			ImGui::PopID();
+		}
+
+		if (ImGui::CollapsingHeader("Resource Cache"))
+		{
+			ImGui::PushID("Resource Cache");
+			ImGui::Indent(10.0f);
+
+			ResourceCache::OnImGuiRender();
+
+			ImGui::Unindent(10.0f);
+			ImGui::PopID();
+		}
+
+		if (ImGui::CollapsingHeader("Memory Tracker"))
+		{
+			ImGui::PushID("Memory Tracker");
+			ImGui::Indent(10.0f);
+
+			MemoryTracker::OnImGuiRender();
 
 			ImGui::Unindent(10.0f);
 			ImGui::PopID();
@@ -191,8 +259,6 @@ void Application::Render()
 		GUIRenderer::EndFrame();
 	}
 
-	Profiler::Reset();
-
 	DebugRenderer::EndScene();
 	Renderer::EndScene();
 
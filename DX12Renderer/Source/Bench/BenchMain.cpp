@@ -0,0 +1,2323 @@
+#include "Pch.h"
+#include "Graphics/Backend/HeadlessBackend.h"
+#include "Graphics/Backend/PipelineStateCache.h"
+#include "Graphics/FrameCapture.h"
+#include "Graphics/LightClustering.h"
+#include "Graphics/Renderer.h"
+#include "Graphics/RenderState.h"
+#include "Graphics/ShaderCache.h"
+#include "Graphics/ShaderPermutation.h"
+#include "Components/DirLightComponent.h"
+#include "Components/PointLightComponent.h"
+#include "Components/SpotLightComponent.h"
+#include "Resource/GLTFDocument.h"
+#include "Resource/ModelImporter.h"
+#include "Resource/ResourceCache.h"
+#include "Scene/BoundingVolume.h"
+#include "Scene/Camera/Camera.h"
+#include "Util/JobSystem.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+/*
+
+	dx12r_bench: drives full frames of the bundled scenes through the renderer on the headless backend.
+	Everything the renderer does on the CPU per frame (scene update, culling, LOD selection, light culling, shadow atlas and
+	shadow update scheduling, scene tables, command recording and submission) is timed without a GPU, so frame CPU time
+	regressions can be tracked on any machine. The bench only loads the scenes and submits them every frame like the scene
+	components do, every frame goes through Renderer::BeginFrame, BeginScene, Submit, Render, EndScene and EndFrame.
+
+	Frames can be written to a capture with --capture, which uses Renderer::BeginCapture like the capture button of the application.
+	--replay runs the frames of a capture instead of the scenes, e.g. one made in the application. The captured meshes and materials are
+	created with zeroed buffers and placeholder textures of the same sizes, and every frame submits the captured camera, meshes and lights
+	through the renderer with the captured settings.
+
+	--lights adds randomly placed spot and pointlights to the scene, up to the number of lights the renderer supports.
+	The renderer culls them into light clusters, --per-instance-lights makes it build the per instance light lists instead.
+	Shadow maps are tiles of the shadow atlas of the renderer and keep their static casters cached, --no-shadow-cache records
+	every caster every frame and --no-caster-culling turns off shadow caster culling. --shadow-draw-budget and --shadow-triangle-budget
+	limit the estimated cost of the shadow views updated per frame, the other views keep their last shadow map.
+	Atlas occupancy and the lights that got new, resized or evicted tiles are reported per frame. The first 60 frames show a static scene,
+	the run fails if the atlas still changes tiles after 30 of them.
+
+	The frame phases are profiler zones, --trace writes the zones of all measured frames to a Chrome trace JSON file.
+	--profiler-overhead measures the cost of an empty zone, of adding a sample to the frame statistics and of counting a tracked allocation
+	instead of running frames. --logger-throughput measures the cost of a log message at the call site and the messages per second
+	the logger thread writes, into a sink that only counts them. --log-file also writes the log to a file.
+	--shader-cache compiles the shaders of the renderer with a stub compiler that takes as long as DXC, one after the other like the passes did,
+	in parallel, from disk and from memory, then edits a copy of Common.hlsl and checks that exactly the shaders including it are recompiled.
+	--pipeline-states requests the pipeline states of the renderer passes several times each through the pipeline state cache, with a stub
+	creation that takes as long as a driver, and compares creating them one after the other with creating them on the job system while frames go on.
+	It checks that identical descriptions share one pipeline state and that keys only depend on the contents of a description.
+	--shader-permutations checks the variant selection against a brute force search, the bound of the manifests
+	and that every variant compiles to its own binary, then counts the pipeline state switches of random draws with and without sorting.
+	--hash-throughput measures the content hash of the resource cache on payloads from descriptor to texture size. --resource-cache loads
+	a generated scene with shared images and vertex data twice through the resource cache into the renderer, and checks that only the
+	unique resources were created, that the second load returns the same handles and that releasing every reference empties the cache.
+	GPU memory of the headless resources is counted by category like in the renderer, the totals and the growth over the measured frames
+	are reported, and resources still alive after the renderer was finalized are reported as leaks on shutdown.
+	--stats-report writes the statistics of the frame and all zones over the measured frames to CSV or JSON.
+	GPU zones are recorded around the passes by the renderer, and resolved from the fake GPU clock of the headless backend,
+	so they show up in traces next to the CPU zones of the frame that recorded them.
+	--light-clustering builds the light clusters of an orbiting camera with the CPU reference of the clustering pass for thousands of lights,
+	beyond the number of lights the renderer supports, and reports the build time, the assignments and the assignments dropped by full clusters.
+	Every light count is checked once against a build without the job system. --lights sets the largest light count.
+	--quantize-positions makes the renderer store positions as 16 bit positions relative to the mesh bounds instead of floats.
+
+*/
+
+struct BenchSettings
+{
+	uint32_t NumFrames = 600;
+	uint32_t NumWarmupFrames = 60;
+	uint32_t Width = 1920;
+	uint32_t Height = 1080;
+	uint32_t ShadowMapResolution = 2048;
+
+	// Same defaults as RenderSettings
+	bool EnableMeshLODs = true;
+	bool EnableShadowCache = true;
+	bool EnableShadowCasterCulling = true;
+	bool QuantizeMeshPositions = false;
+	LightCullingMode LightCulling = LightCullingMode::LIGHT_CULLING_MODE_CLUSTERED;
+	ShadowSchedulerSettings ShadowScheduler;
+
+	uint32_t NumLights = 0;
+
+	std::vector<std::string> Scenes;
+	std::string OutputFilepath;
+	std::string CaptureFilepath;
+	std::string ReplayFilepath;
+	std::string TraceFilepath;
+	std::string StatisticsFilepath;
+	bool HasFrameCount = false;
+	bool MeasureProfilerOverhead = false;
+	bool MeasureLoggerThroughput = false;
+	bool MeasureShaderCache = false;
+	bool MeasurePipelineStates = false;
+	bool MeasureShaderPermutations = false;
+	bool MeasureHashThroughput = false;
+	bool MeasureResourceCache = false;
+	bool MeasureLightClustering = false;
+	std::string LogFilepath;
+};
+
+struct BenchMesh
+{
+	RenderResourceHandle Handle;
+	BoundingBox BB;
+};
+
+struct BenchNode
+{
+	glm::mat4 Transform = glm::identity<glm::mat4>();
+	std::vector<std::size_t> Meshes;
+	std::vector<std::size_t> Children;
+};
+
+struct BenchInstance
+{
+	std::size_t Mesh = 0;
+	glm::mat4 Transform = glm::identity<glm::mat4>();
+};
+
+struct BenchSpotLight
+{
+	SpotLightData Data;
+	Camera LightCamera;
+};
+
+struct BenchPointLight
+{
+	PointLightData Data;
+	std::array<Camera, 6> LightCameras;
+};
+
+// Lights whose shadow atlas tiles changed this frame, zero once the atlas is stable.
+// Deferred resizes keep their tiles, a full atlas can defer the same lights every frame without re-rendering any shadow map
+static uint32_t GetShadowAtlasChurn(const RendererStatistics& stats)
+{
+	return stats.ShadowAtlasNewLightCount + stats.ShadowAtlasResizedLightCount + stats.ShadowAtlasEvictedLightCount;
+}
+
+// Sums of the renderer statistics over the measured frames
+struct BenchFrameStatistics
+{
+	void Add(const RendererStatistics& stats)
+	{
+		NumDraws += stats.DrawCallCount;
+		NumLODDraws += stats.LODDrawCallCount;
+		NumTriangles += stats.TriangleCount;
+		NumMeshes += stats.MeshCount;
+		NumShaderVariantSwitches += stats.PipelineStateSwitchCount;
+		for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
+			NumLightingDraws[i] += stats.LightingDrawCallCount[i];
+		NumDepthPrepassDraws += stats.DepthPrepassDrawCallCount;
+		NumDepthVertexBytes += stats.DepthVertexByteCount;
+		NumInstanceLightAssignments += stats.InstanceLightAssignmentCount;
+		NumShadowMaps += stats.ShadowMapCount;
+		NumCachedShadowMaps += stats.ShadowMapCacheHitCount;
+		NumCulledShadowCasters += stats.ShadowCasterCulledCount;
+		NumSkippedShadowViews += stats.ShadowViewSkippedCount;
+		NumUnshadowedShadowViews += stats.ShadowViewUnshadowedCount;
+		NumSceneTableUploadBytes += stats.SceneTableUploadByteCount;
+
+		ShadowAtlasOccupancy += stats.ShadowAtlasOccupancy;
+		MinShadowAtlasOccupancy = std::min(MinShadowAtlasOccupancy, stats.ShadowAtlasOccupancy);
+		MaxShadowAtlasOccupancy = std::max(MaxShadowAtlasOccupancy, stats.ShadowAtlasOccupancy);
+		NumNewShadowAtlasLights += stats.ShadowAtlasNewLightCount;
+		NumResizedShadowAtlasLights += stats.ShadowAtlasResizedLightCount;
+		NumDeferredShadowAtlasResizes += stats.ShadowAtlasDeferredResizeCount;
+		NumEvictedShadowAtlasLights += stats.ShadowAtlasEvictedLightCount;
+		NumShadowAtlasChurnFrames += GetShadowAtlasChurn(stats) > 0 ? 1 : 0;
+	}
+
+	uint64_t NumDraws = 0;
+	uint64_t NumLODDraws = 0;
+	uint64_t NumTriangles = 0;
+	uint64_t NumMeshes = 0;
+	uint64_t NumShaderVariantSwitches = 0;
+	uint64_t NumLightingDraws[TransparencyMode::NUM_ALPHA_MODES] = {};
+	uint64_t NumDepthPrepassDraws = 0;
+	uint64_t NumDepthVertexBytes = 0;
+	uint64_t NumInstanceLightAssignments = 0;
+	uint64_t NumShadowMaps = 0;
+	uint64_t NumCachedShadowMaps = 0;
+	uint64_t NumCulledShadowCasters = 0;
+	uint64_t NumSkippedShadowViews = 0;
+	uint64_t NumUnshadowedShadowViews = 0;
+	uint64_t NumSceneTableUploadBytes = 0;
+	uint64_t NumGPUZones = 0;
+
+	double ShadowAtlasOccupancy = 0.0;
+	float MinShadowAtlasOccupancy = 1.0f;
+	float MaxShadowAtlasOccupancy = 0.0f;
+	uint64_t NumNewShadowAtlasLights = 0;
+	uint64_t NumResizedShadowAtlasLights = 0;
+	uint64_t NumDeferredShadowAtlasResizes = 0;
+	uint64_t NumEvictedShadowAtlasLights = 0;
+	uint64_t NumShadowAtlasChurnFrames = 0;
+};
+
+struct InternalBenchData
+{
+	BenchSettings Settings;
+	bool IsRendererInitialized = false;
+
+	TrackedVector<BenchMesh, MEMORY_TAG_SCENE> Meshes;
+	TrackedVector<BenchNode, MEMORY_TAG_SCENE> Nodes;
+	std::vector<std::size_t> RootNodes;
+	TrackedVector<BenchInstance, MEMORY_TAG_SCENE> Instances;
+
+	// The directional light and the generated spot and pointlights, submitted every frame like the light components do
+	DirectionalLightData DirLight;
+	std::vector<BenchSpotLight> SpotLights;
+	std::vector<BenchPointLight> PointLights;
+
+	BoundingBox SceneBB;
+	float LoadTime = 0.0f;
+
+	// Replays only, meshes of the capture are in Meshes at the index of their capture ID
+	std::unique_ptr<FrameCaptureReader> CaptureReader;
+	CapturedFrame Frame;
+};
+
+static InternalBenchData s_Data;
+
+static bool ParseArguments(int argc, char* argv[])
+{
+	BenchSettings& settings = s_Data.Settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--frames" && hasValue)
+		{
+			settings.NumFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+			settings.HasFrameCount = true;
+		}
+		else if (arg == "--warmup" && hasValue)
+			settings.NumWarmupFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--width" && hasValue)
+			settings.Width = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--height" && hasValue)
+			settings.Height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--scene" && hasValue)
+			settings.Scenes.emplace_back(argv[++i]);
+		else if (arg == "--output" && hasValue)
+			settings.OutputFilepath = argv[++i];
+		else if (arg == "--capture" && hasValue)
+			settings.CaptureFilepath = argv[++i];
+		else if (arg == "--replay" && hasValue)
+			settings.ReplayFilepath = argv[++i];
+		else if (arg == "--lights" && hasValue)
+			settings.NumLights = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--per-instance-lights")
+			settings.LightCulling = LightCullingMode::LIGHT_CULLING_MODE_PER_INSTANCE;
+		else if (arg == "--no-lods")
+			settings.EnableMeshLODs = false;
+		else if (arg == "--no-shadow-cache")
+			settings.EnableShadowCache = false;
+		else if (arg == "--no-caster-culling")
+			settings.EnableShadowCasterCulling = false;
+		else if (arg == "--quantize-positions")
+			settings.QuantizeMeshPositions = true;
+		else if (arg == "--shadow-draw-budget" && hasValue)
+			settings.ShadowScheduler.DrawBudget = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--shadow-triangle-budget" && hasValue)
+			settings.ShadowScheduler.TriangleBudget = std::stoull(argv[++i]);
+		else if (arg == "--trace" && hasValue)
+			settings.TraceFilepath = argv[++i];
+		else if (arg == "--profiler-overhead")
+			settings.MeasureProfilerOverhead = true;
+		else if (arg == "--stats-report" && hasValue)
+			settings.StatisticsFilepath = argv[++i];
+		else if (arg == "--logger-throughput")
+			settings.MeasureLoggerThroughput = true;
+		else if (arg == "--log-file" && hasValue)
+			settings.LogFilepath = argv[++i];
+		else if (arg == "--shader-cache")
+			settings.MeasureShaderCache = true;
+		else if (arg == "--pipeline-states")
+			settings.MeasurePipelineStates = true;
+		else if (arg == "--shader-permutations")
+			settings.MeasureShaderPermutations = true;
+		else if (arg == "--hash-throughput")
+			settings.MeasureHashThroughput = true;
+		else if (arg == "--resource-cache")
+			settings.MeasureResourceCache = true;
+		else if (arg == "--light-clustering")
+			settings.MeasureLightClustering = true;
+		else
+		{
+			printf("Usage: dx12r_bench [--frames n] [--warmup n] [--width n] [--height n] [--scene file.gltf]... [--no-lods] [--no-shadow-cache] [--no-caster-culling]\n");
+			printf("                   [--lights n] [--per-instance-lights] [--output results.json] [--shadow-draw-budget n] [--shadow-triangle-budget n]\n");
+			printf("                   [--capture capture.dxrc | --replay capture.dxrc]\n");
+			printf("                   [--trace trace.json] [--stats-report stats.csv|stats.json] [--profiler-overhead] [--logger-throughput] [--log-file bench.log]\n");
+			printf("                   [--shader-cache] [--pipeline-states] [--shader-permutations] [--hash-throughput] [--resource-cache]\n");
+			printf("                   [--light-clustering] [--quantize-positions]\n");
+			return false;
+		}
+	}
+
+	if (!settings.ReplayFilepath.empty() && (!settings.CaptureFilepath.empty() || !settings.Scenes.empty() || settings.NumLights > 0))
+	{
+		printf("--replay cannot be combined with --capture, --scene or --lights\n");
+		return false;
+	}
+
+	// Same models as the application loads on startup
+	if (settings.Scenes.empty() && settings.ReplayFilepath.empty())
+	{
+		settings.Scenes.emplace_back("Resources/Models/SponzaOld/Sponza.gltf");
+		settings.Scenes.emplace_back("Resources/Models/ABeautifulGame/glTF/ABeautifulGame.gltf");
+		settings.Scenes.emplace_back("Resources/Models/Duck/Duck.gltf");
+	}
+
+	return settings.NumFrames > 0 && settings.Width > 0 && settings.Height > 0;
+}
+
+// Applies the settings of the bench to the renderer, the atlas resolution and position format are fixed once it is initialized
+static void InitializeRenderer(uint32_t width, uint32_t height)
+{
+	const BenchSettings& settings = s_Data.Settings;
+	RenderSettings& renderSettings = g_RenderState.Settings;
+
+	renderSettings.ShadowMapResolution = { settings.ShadowMapResolution, settings.ShadowMapResolution };
+	renderSettings.EnableVSync = false;
+	renderSettings.EnableMeshLODs = settings.EnableMeshLODs;
+	renderSettings.EnableShadowCache = settings.EnableShadowCache;
+	renderSettings.EnableShadowCasterCulling = settings.EnableShadowCasterCulling;
+	renderSettings.QuantizeMeshPositions = settings.QuantizeMeshPositions;
+	renderSettings.LightCulling = settings.LightCulling;
+	renderSettings.ShadowScheduler = settings.ShadowScheduler;
+
+	Renderer::Initialize(std::make_unique<HeadlessBackend>(), width, height);
+	s_Data.IsRendererInitialized = true;
+}
+
+// Creates the textures, materials and meshes of the scene like the resource manager does, images shared between materials are created once
+static bool LoadScene(const std::string& filepath)
+{
+	GLTFDocument document(filepath);
+	if (!document.IsValid())
+	{
+		LOG_ERR("[Bench] Failed to parse glTF model: {}", filepath);
+		return false;
+	}
+
+	std::vector<RenderResourceHandle> textures(document.GetImageCount(), RENDER_RESOURCE_HANDLE_NULL);
+	auto getOrCreateTexture = [&](int imageIndex, TextureFormat format) -> RenderResourceHandle
+	{
+		if (imageIndex < 0 || RENDER_RESOURCE_HANDLE_VALID(textures[imageIndex]))
+			return imageIndex < 0 ? RENDER_RESOURCE_HANDLE_NULL : textures[imageIndex];
+
+		const ImageInfo& image = document.AcquireImage(imageIndex);
+		if (image.Data)
+		{
+			TextureDesc textureDesc = {};
+			textureDesc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+			textureDesc.Format = format;
+			textureDesc.Width = static_cast<uint32_t>(image.Width);
+			textureDesc.Height = static_cast<uint32_t>(image.Height);
+			textureDesc.DataPtr = image.Data;
+			textureDesc.DebugName = filepath + " image " + std::to_string(imageIndex);
+
+			textures[imageIndex] = Renderer::CreateTexture(textureDesc);
+		}
+
+		// The upload queue keeps its own copy of the pixels
+		document.ReleaseImage(imageIndex);
+		return textures[imageIndex];
+	};
+
+	std::vector<RenderResourceHandle> materials;
+	for (const GLTFMaterial& gltfMaterial : document.GetMaterials())
+	{
+		MaterialDesc materialDesc = {};
+		materialDesc.AlbedoTexture = getOrCreateTexture(gltfMaterial.AlbedoImage, TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB);
+		materialDesc.NormalTexture = getOrCreateTexture(gltfMaterial.NormalImage, TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM);
+		materialDesc.MetallicRoughnessTexture = getOrCreateTexture(gltfMaterial.MetallicRoughnessImage, TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM);
+		materialDesc.Metalness = gltfMaterial.MetallicFactor;
+		materialDesc.Roughness = gltfMaterial.RoughnessFactor;
+		materialDesc.Transparency = ModelImporter::GetTransparencyMode(gltfMaterial.AlphaMode);
+		materialDesc.AlphaCutoff = gltfMaterial.AlphaCutoff;
+		materialDesc.DebugName = filepath + " material " + std::to_string(materials.size());
+
+		materials.push_back(Renderer::CreateMaterial(materialDesc));
+	}
+
+	ImportedGeometry geometry = ModelImporter::ReadGeometry(document);
+	ModelImporter::ProcessGeometry(geometry, Renderer::GetMeshPositionFormat());
+
+	// Primitives without a material use the glTF default material
+	RenderResourceHandle defaultMaterial = RENDER_RESOURCE_HANDLE_NULL;
+	std::size_t firstMesh = s_Data.Meshes.size();
+
+	for (const ImportedPrimitive& primitive : geometry.Primitives)
+	{
+		if (primitive.Material < 0 && !RENDER_RESOURCE_HANDLE_VALID(defaultMaterial))
+		{
+			MaterialDesc defaultMaterialDesc = {};
+			defaultMaterialDesc.Metalness = 1.0f;
+			defaultMaterialDesc.Roughness = 1.0f;
+			defaultMaterialDesc.Transparency = TransparencyMode::OPAQUE;
+
+			defaultMaterial = Renderer::CreateMaterial(defaultMaterialDesc);
+		}
+
+		MeshDesc meshDesc = {};
+		meshDesc.DebugName = primitive.DebugName;
+		meshDesc.PositionBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.PositionBufferDesc.NumElements = primitive.NumVertices;
+		meshDesc.PositionBufferDesc.ElementSize = ModelImporter::GetPositionByteSize(primitive.PositionFormat);
+		meshDesc.PositionBufferDesc.DataPtr = primitive.PositionStream.data();
+		meshDesc.PositionBufferDesc.DebugName = meshDesc.DebugName + " position buffer";
+		meshDesc.AttributeBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.AttributeBufferDesc.NumElements = primitive.NumVertices;
+		meshDesc.AttributeBufferDesc.ElementSize = sizeof(VertexAttributes);
+		meshDesc.AttributeBufferDesc.DataPtr = primitive.AttributeStream.data();
+		meshDesc.AttributeBufferDesc.DebugName = meshDesc.DebugName + " attribute buffer";
+		meshDesc.IndexBufferDesc.Usage = BufferUsage::BUFFER_USAGE_INDEX;
+		meshDesc.IndexBufferDesc.NumElements = primitive.Indices.size();
+		meshDesc.IndexBufferDesc.ElementSize = sizeof(uint32_t);
+		meshDesc.IndexBufferDesc.DataPtr = primitive.Indices.data();
+		meshDesc.IndexBufferDesc.DebugName = meshDesc.DebugName + " index buffer";
+		meshDesc.MaterialHandle = primitive.Material >= 0 ? materials[primitive.Material] : defaultMaterial;
+		meshDesc.PositionFormat = primitive.PositionFormat;
+		meshDesc.PositionScale = primitive.PositionScale;
+		meshDesc.PositionOffset = primitive.PositionOffset;
+		meshDesc.BB.Min = primitive.MinBounds;
+		meshDesc.BB.Max = primitive.MaxBounds;
+
+		for (std::size_t lod = 0; lod < primitive.LODs.size(); ++lod)
+		{
+			MeshLODDesc& lodDesc = meshDesc.LODs.emplace_back();
+			lodDesc.IndexBufferDesc.Usage = BufferUsage::BUFFER_USAGE_INDEX;
+			lodDesc.IndexBufferDesc.NumElements = primitive.LODs[lod].Indices.size();
+			lodDesc.IndexBufferDesc.ElementSize = sizeof(uint32_t);
+			lodDesc.IndexBufferDesc.DataPtr = primitive.LODs[lod].Indices.data();
+			lodDesc.IndexBufferDesc.DebugName = meshDesc.DebugName + " LOD" + std::to_string(lod + 1) + " index buffer";
+			lodDesc.Error = primitive.LODs[lod].Error;
+		}
+
+		s_Data.Meshes.push_back({ Renderer::CreateMesh(meshDesc), meshDesc.BB });
+	}
+
+	// Node hierarchy, documents without nodes get one root node per primitive like in the resource manager
+	std::size_t firstNode = s_Data.Nodes.size();
+
+	if (!document.GetNodes().empty())
+	{
+		for (const GLTFNode& gltfNode : document.GetNodes())
+		{
+			BenchNode& node = s_Data.Nodes.emplace_back();
+			node.Transform = gltfNode.Transform;
+
+			if (gltfNode.Mesh >= 0)
+			{
+				for (std::size_t prim = geometry.MeshFirstPrimitive[gltfNode.Mesh]; prim < geometry.MeshFirstPrimitive[gltfNode.Mesh + 1]; ++prim)
+					node.Meshes.push_back(firstMesh + prim);
+			}
+
+			for (std::size_t child : gltfNode.Children)
+				node.Children.push_back(firstNode + child);
+		}
+
+		std::vector<std::size_t> rootNodes = document.GetRootNodes();
+		if (rootNodes.empty())
+		{
+			for (std::size_t i = 0; i < document.GetNodes().size(); ++i)
+				rootNodes.push_back(i);
+		}
+
+		for (std::size_t rootNode : rootNodes)
+			s_Data.RootNodes.push_back(firstNode + rootNode);
+	}
+	else
+	{
+		for (std::size_t prim = 0; prim < geometry.Primitives.size(); ++prim)
+		{
+			s_Data.RootNodes.push_back(s_Data.Nodes.size());
+			s_Data.Nodes.emplace_back().Meshes.push_back(firstMesh + prim);
+		}
+	}
+
+	return true;
+}
+
+// Creates the meshes and materials of a capture, the renderer is initialized with the settings of the first captured frame
+static bool LoadCapture(const std::string& filepath)
+{
+	s_Data.CaptureReader = std::make_unique<FrameCaptureReader>(filepath);
+	const FrameCaptureReader& reader = *s_Data.CaptureReader;
+
+	if (!reader.IsValid() || reader.GetNumFrames() == 0 || !reader.ReadFrame(0, s_Data.Frame))
+	{
+		LOG_ERR("[Bench] Capture has no frames to replay: {}", filepath);
+		return false;
+	}
+
+	// The shadow atlas and position format are fixed once the renderer is initialized, the other settings are applied every frame
+	s_Data.Settings.ShadowMapResolution = s_Data.Frame.Settings.ShadowMapResolution;
+	s_Data.Settings.EnableMeshLODs = s_Data.Frame.Settings.EnableMeshLODs;
+	InitializeRenderer(s_Data.Frame.Settings.RenderWidth, s_Data.Frame.Settings.RenderHeight);
+
+	// Captures only record which textures a material has, their contents and sizes do not change CPU timings
+	const uint32_t placeholderSize = 4;
+	std::vector<uint8_t> placeholderPixels(placeholderSize * placeholderSize * 4, 0);
+
+	auto createPlaceholderTexture = [&](TextureFormat format, const std::string& debugName)
+	{
+		TextureDesc textureDesc = {};
+		textureDesc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+		textureDesc.Format = format;
+		textureDesc.Width = placeholderSize;
+		textureDesc.Height = placeholderSize;
+		textureDesc.DataPtr = placeholderPixels.data();
+		textureDesc.DebugName = debugName;
+
+		return Renderer::CreateTexture(textureDesc);
+	};
+
+	RenderResourceHandle albedoTexture = createPlaceholderTexture(TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB, "Replay albedo texture");
+	RenderResourceHandle normalTexture = createPlaceholderTexture(TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM, "Replay normal texture");
+	RenderResourceHandle metallicRoughnessTexture = createPlaceholderTexture(TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM, "Replay metallic roughness texture");
+
+	std::vector<RenderResourceHandle> materials;
+	for (const CapturedMaterial& capturedMaterial : reader.GetMaterials())
+	{
+		MaterialDesc materialDesc = {};
+		materialDesc.AlbedoTexture = capturedMaterial.HasAlbedoTexture ? albedoTexture : RENDER_RESOURCE_HANDLE_NULL;
+		materialDesc.NormalTexture = capturedMaterial.HasNormalTexture ? normalTexture : RENDER_RESOURCE_HANDLE_NULL;
+		materialDesc.MetallicRoughnessTexture = capturedMaterial.HasMetallicRoughnessTexture ? metallicRoughnessTexture : RENDER_RESOURCE_HANDLE_NULL;
+		materialDesc.Metalness = capturedMaterial.Metalness;
+		materialDesc.Roughness = capturedMaterial.Roughness;
+		materialDesc.Transparency = capturedMaterial.Transparency;
+		materialDesc.AlphaCutoff = capturedMaterial.AlphaCutoff;
+		materialDesc.DebugName = "Replay material " + std::to_string(materials.size());
+
+		materials.push_back(Renderer::CreateMaterial(materialDesc));
+	}
+
+	// Buffer contents do not change CPU timings either, only their sizes do, so captured meshes are uploaded as zeroes
+	VertexPositionFormat positionFormat = Renderer::GetMeshPositionFormat();
+	std::vector<uint8_t> zeroes;
+
+	for (const CapturedMesh& capturedMesh : reader.GetMeshes())
+	{
+		std::size_t maxNumIndices = capturedMesh.NumIndices;
+		for (const CapturedMeshLOD& lod : capturedMesh.LODs)
+			maxNumIndices = std::max(maxNumIndices, static_cast<std::size_t>(lod.NumIndices));
+
+		zeroes.resize(std::max({ zeroes.size(), capturedMesh.NumVertices * sizeof(VertexAttributes), maxNumIndices * sizeof(uint32_t) }));
+
+		MeshDesc meshDesc = {};
+		meshDesc.DebugName = "Replay mesh " + std::to_string(s_Data.Meshes.size());
+		meshDesc.PositionBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.PositionBufferDesc.NumElements = capturedMesh.NumVertices;
+		meshDesc.PositionBufferDesc.ElementSize = ModelImporter::GetPositionByteSize(positionFormat);
+		meshDesc.PositionBufferDesc.DataPtr = zeroes.data();
+		meshDesc.PositionBufferDesc.DebugName = meshDesc.DebugName + " position buffer";
+		meshDesc.AttributeBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.AttributeBufferDesc.NumElements = capturedMesh.NumVertices;
+		meshDesc.AttributeBufferDesc.ElementSize = sizeof(VertexAttributes);
+		meshDesc.AttributeBufferDesc.DataPtr = zeroes.data();
+		meshDesc.AttributeBufferDesc.DebugName = meshDesc.DebugName + " attribute buffer";
+		meshDesc.IndexBufferDesc.Usage = BufferUsage::BUFFER_USAGE_INDEX;
+		meshDesc.IndexBufferDesc.NumElements = capturedMesh.NumIndices;
+		meshDesc.IndexBufferDesc.ElementSize = sizeof(uint32_t);
+		meshDesc.IndexBufferDesc.DataPtr = zeroes.data();
+		meshDesc.IndexBufferDesc.DebugName = meshDesc.DebugName + " index buffer";
+		meshDesc.MaterialHandle = materials[capturedMesh.Material];
+		meshDesc.PositionFormat = positionFormat;
+		meshDesc.BB = capturedMesh.BB;
+
+		// Quantized positions are relative to the mesh bounds
+		if (positionFormat == VertexPositionFormat::VERTEX_POSITION_FORMAT_UNORM16)
+		{
+			meshDesc.PositionScale = capturedMesh.BB.Max - capturedMesh.BB.Min;
+			meshDesc.PositionOffset = capturedMesh.BB.Min;
+		}
+
+		for (std::size_t lod = 0; lod < capturedMesh.LODs.size(); ++lod)
+		{
+			MeshLODDesc& lodDesc = meshDesc.LODs.emplace_back();
+			lodDesc.IndexBufferDesc.Usage = BufferUsage::BUFFER_USAGE_INDEX;
+			lodDesc.IndexBufferDesc.NumElements = capturedMesh.LODs[lod].NumIndices;
+			lodDesc.IndexBufferDesc.ElementSize = sizeof(uint32_t);
+			lodDesc.IndexBufferDesc.DataPtr = zeroes.data();
+			lodDesc.IndexBufferDesc.DebugName = meshDesc.DebugName + " LOD" + std::to_string(lod + 1) + " index buffer";
+			lodDesc.Error = capturedMesh.LODs[lod].Error;
+		}
+
+		s_Data.Meshes.push_back({ Renderer::CreateMesh(meshDesc), meshDesc.BB });
+	}
+
+	return true;
+}
+
+static Camera MakeCapturedCamera(const CapturedView& view)
+{
+	Camera camera(view.View, view.Projection, view.Near, view.Far);
+	camera.SetFrustumCulling(view.FrustumCulling);
+
+	return camera;
+}
+
+// Submits a captured frame like SubmitScene submits the loaded scenes, captured submissions are identified by their index in the frame
+static void SubmitCapturedFrame(const CapturedFrame& frame)
+{
+	SCOPED_TIMER("Bench::SubmitCapturedFrame");
+
+	RenderSettings& renderSettings = g_RenderState.Settings;
+	renderSettings.EnableMeshLODs = frame.Settings.EnableMeshLODs;
+	renderSettings.LODErrorThreshold = frame.Settings.LODErrorThreshold;
+	renderSettings.ShadowLODErrorThreshold = frame.Settings.ShadowLODErrorThreshold;
+	Renderer::Resize(frame.Settings.RenderWidth, frame.Settings.RenderHeight);
+
+	Renderer::BeginScene(MakeCapturedCamera(frame.SceneView));
+
+	for (std::size_t i = 0; i < frame.MeshSubmissions.size(); ++i)
+	{
+		const CapturedMeshSubmission& submission = frame.MeshSubmissions[i];
+		Renderer::Submit(s_Data.Meshes[submission.Mesh].Handle, submission.Transform, submission.PrevFrameTransform, i);
+	}
+
+	uint64_t lightID = 0;
+	for (const CapturedLight& light : frame.Lights)
+	{
+		switch (light.Type)
+		{
+		case CapturedLightType::CAPTURED_LIGHT_TYPE_DIRECTIONAL:
+		{
+			// The ambient term is not captured, the cascades are fitted to the scene camera by the renderer again
+			DirectionalLightData dirLight(light.Direction, glm::vec3(0.0f), light.Color);
+			Renderer::Submit(dirLight, lightID++);
+			break;
+		}
+		case CapturedLightType::CAPTURED_LIGHT_TYPE_SPOT:
+		{
+			if (light.ShadowViews.size() != 1)
+				break;
+
+			// Cone angles are captured as the cosines the renderer stores
+			SpotLightData spotLight;
+			spotLight.Position = light.Position;
+			spotLight.Direction = light.Direction;
+			spotLight.Color = light.Color;
+			spotLight.Attenuation = light.Attenuation;
+			spotLight.Range = light.Range;
+			spotLight.InnerConeAngle = light.InnerConeAngle;
+			spotLight.OuterConeAngle = light.OuterConeAngle;
+
+			Camera lightCamera = MakeCapturedCamera(light.ShadowViews[0]);
+			spotLight.ViewProjection = lightCamera.GetViewProjection();
+			Renderer::Submit(spotLight, lightCamera, lightID++);
+			break;
+		}
+		case CapturedLightType::CAPTURED_LIGHT_TYPE_POINT:
+		{
+			if (light.ShadowViews.size() != 6)
+				break;
+
+			PointLightData pointLight(light.Attenuation, light.Color);
+			pointLight.Position = light.Position;
+			pointLight.Range = light.Range;
+
+			std::array<Camera, 6> lightCameras;
+			for (uint32_t face = 0; face < 6; ++face)
+				lightCameras[face] = MakeCapturedCamera(light.ShadowViews[face]);
+
+			Renderer::Submit(pointLight, lightCameras, lightID++);
+			break;
+		}
+		}
+	}
+}
+
+static void UpdateScene()
+{
+	SCOPED_TIMER("Bench::UpdateScene");
+
+	s_Data.Instances.clear();
+
+	// Depth first traversal, world transforms are rebuilt every frame like the transform components do
+	std::vector<std::pair<std::size_t, glm::mat4>> stack;
+	for (std::size_t rootNode : s_Data.RootNodes)
+		stack.emplace_back(rootNode, glm::identity<glm::mat4>());
+
+	while (!stack.empty())
+	{
+		auto [nodeIndex, parentTransform] = stack.back();
+		stack.pop_back();
+
+		const BenchNode& node = s_Data.Nodes[nodeIndex];
+		glm::mat4 worldTransform = parentTransform * node.Transform;
+
+		for (std::size_t mesh : node.Meshes)
+			s_Data.Instances.push_back({ mesh, worldTransform });
+
+		for (std::size_t child : node.Children)
+			stack.emplace_back(child, worldTransform);
+	}
+}
+
+static void CalculateSceneBounds()
+{
+	s_Data.SceneBB.Min = glm::vec3(std::numeric_limits<float>::max());
+	s_Data.SceneBB.Max = glm::vec3(std::numeric_limits<float>::lowest());
+
+	for (const BenchInstance& instance : s_Data.Instances)
+	{
+		const BoundingBox& bb = s_Data.Meshes[instance.Mesh].BB;
+		s_Data.SceneBB.Min = glm::min(s_Data.SceneBB.Min, glm::vec3(instance.Transform * glm::vec4(bb.Min, 1.0f)));
+		s_Data.SceneBB.Max = glm::max(s_Data.SceneBB.Max, glm::vec3(instance.Transform * glm::vec4(bb.Max, 1.0f)));
+	}
+}
+
+// Places lights uniformly in the scene bounds, with a fixed seed so every run gets the same lights
+// Lights alternate between point and spotlights, the light cameras are made like the light components make them
+static void GenerateLights(uint32_t numLights, float sceneRadius)
+{
+	const glm::vec3 faceDirections[6] = {
+		{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }
+	};
+	const glm::vec3 faceUpVectors[6] = {
+		{ 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f },
+		{ 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 1.0f },
+		{ 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }
+	};
+
+	uint32_t maxLights = RenderState::MAX_POINT_LIGHTS + RenderState::MAX_SPOT_LIGHTS;
+	if (numLights > maxLights)
+	{
+		LOG_WARN("[Bench] The renderer supports {} spot and {} pointlights, generating {} lights instead of {}", RenderState::MAX_SPOT_LIGHTS,
+			RenderState::MAX_POINT_LIGHTS, maxLights, numLights);
+		numLights = maxLights;
+	}
+
+	std::mt19937 engine(1337);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	for (uint32_t i = 0; i < numLights; ++i)
+	{
+		glm::vec3 position = glm::mix(s_Data.SceneBB.Min, s_Data.SceneBB.Max, glm::vec3(unit(engine), unit(engine), unit(engine)));
+		glm::vec3 color = glm::vec3(unit(engine), unit(engine), unit(engine));
+		glm::vec3 attenuation = glm::vec3(1.0f, 0.09f, 0.032f);
+		float range = sceneRadius * (0.02f + 0.06f * unit(engine));
+
+		if (i % 2 == 0)
+		{
+			BenchPointLight& light = s_Data.PointLights.emplace_back();
+			light.Data = PointLightData(attenuation, color);
+			light.Data.Position = position;
+			light.Data.Range = range;
+
+			for (uint32_t face = 0; face < 6; ++face)
+			{
+				glm::mat4 lightView = glm::lookAtLH(position, position + faceDirections[face], faceUpVectors[face]);
+				light.LightCameras[face] = Camera(lightView, 90.0f, 1.0f, range, 0.1f);
+			}
+		}
+		else
+		{
+			glm::vec3 direction = glm::vec3(unit(engine), unit(engine), unit(engine)) * 2.0f - 1.0f;
+			direction = glm::length(direction) > 0.001f ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+			float outerConeAngle = 15.0f + 45.0f * unit(engine);
+
+			// Cone angles are stored as cosines
+			BenchSpotLight& light = s_Data.SpotLights.emplace_back();
+			light.Data = SpotLightData(attenuation, outerConeAngle * 0.8f, outerConeAngle, color);
+			light.Data.Position = position;
+			light.Data.Direction = direction;
+			light.Data.Range = range;
+
+			glm::vec3 up = std::abs(direction.z) < 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+			light.LightCamera = Camera(glm::lookAtLH(position, position + direction, up), outerConeAngle * 2.0f, 1.0f, range, 0.1f);
+			light.Data.ViewProjection = light.LightCamera.GetViewProjection();
+		}
+	}
+}
+
+// Submits the scene like the mesh and light components do, instances are identified by their index in the scene
+static void SubmitScene(const Camera& sceneCamera)
+{
+	SCOPED_TIMER("Bench::SubmitScene");
+
+	Renderer::BeginScene(sceneCamera);
+
+	for (std::size_t i = 0; i < s_Data.Instances.size(); ++i)
+	{
+		const BenchInstance& instance = s_Data.Instances[i];
+		Renderer::Submit(s_Data.Meshes[instance.Mesh].Handle, instance.Transform, instance.Transform, i);
+	}
+
+	uint64_t lightID = 0;
+	Renderer::Submit(s_Data.DirLight, lightID++);
+
+	for (BenchSpotLight& light : s_Data.SpotLights)
+		Renderer::Submit(light.Data, light.LightCamera, lightID++);
+	for (BenchPointLight& light : s_Data.PointLights)
+		Renderer::Submit(light.Data, light.LightCameras, lightID++);
+}
+
+// Finalizing the renderer releases all of its resources, whatever the memory tracker still counts afterwards is a leak
+static void Shutdown()
+{
+	if (s_Data.IsRendererInitialized)
+		Renderer::Finalize();
+	s_Data.IsRendererInitialized = false;
+
+	// Swapped with empty containers, clearing would keep their memory
+	decltype(s_Data.Meshes)().swap(s_Data.Meshes);
+	decltype(s_Data.Nodes)().swap(s_Data.Nodes);
+	decltype(s_Data.Instances)().swap(s_Data.Instances);
+	s_Data.CaptureReader.reset();
+	s_Data.Frame = CapturedFrame();
+
+	JobSystem::Finalize();
+	Profiler::Finalize();
+	MemoryTracker::ReportLeaks();
+}
+
+static float Percentile(std::vector<float> values, float percentile)
+{
+	std::size_t index = std::min(static_cast<std::size_t>(percentile * values.size()), values.size() - 1);
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+static float Average(const std::vector<float>& values)
+{
+	double sum = 0.0;
+	for (float value : values)
+		sum += value;
+
+	return static_cast<float>(sum / values.size());
+}
+
+// Times batches of empty zones, the overhead of a zone is the time of a batch minus the time of the same loop without zones
+static int MeasureProfilerOverhead()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	const uint32_t numZonesPerBatch = 10000;
+	const uint32_t numBatches = 500;
+
+	auto measureBatches = [&](bool recordZones)
+	{
+		std::vector<float> batchTimes;
+		for (uint32_t batch = 0; batch < numBatches; ++batch)
+		{
+			auto batchStart = std::chrono::steady_clock::now();
+			for (uint32_t i = 0; i < numZonesPerBatch; ++i)
+			{
+				if (recordZones)
+				{
+					SCOPED_TIMER("Bench::EmptyZone");
+				}
+				// Keeps the compiler from removing the loop
+				std::atomic_signal_fence(std::memory_order_seq_cst);
+			}
+			batchTimes.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - batchStart).count() / numZonesPerBatch);
+
+			// Drains the ring so no zone is dropped, outside of the measured time
+			Profiler::EndFrame();
+		}
+		return batchTimes;
+	};
+
+	std::vector<float> loopTimes = measureBatches(false);
+	std::vector<float> zoneTimes = measureBatches(true);
+
+	float loopTime = Percentile(loopTimes, 0.5f);
+	float zoneMedian = Percentile(zoneTimes, 0.5f) - loopTime;
+	float zoneP95 = Percentile(zoneTimes, 0.95f) - loopTime;
+	ProfilerStatistics stats = Profiler::GetStatistics();
+
+	LOG_INFO("[Bench] Profiler zone overhead: median {} ns, p95 {} ns per zone over {} zones, {} dropped", zoneMedian, zoneP95,
+		numBatches * numZonesPerBatch, stats.NumDroppedZones);
+
+	// Frame times around 16 ms with a spike every few hundred frames, the same sequence for every window size
+	std::mt19937 randomEngine(1234);
+	std::uniform_real_distribution<float> frameTimeDistribution(14.0f, 18.0f);
+	std::vector<float> samples(numZonesPerBatch);
+	for (uint32_t i = 0; i < numZonesPerBatch; ++i)
+		samples[i] = i % 300 == 0 ? 50.0f : frameTimeDistribution(randomEngine);
+
+	// Adding a sample has to take the same time for any window size
+	auto measureStatistics = [&](uint32_t windowSize)
+	{
+		RollingFrameStatistics statistics(windowSize);
+		std::vector<float> batchTimes;
+		for (uint32_t batch = 0; batch < numBatches; ++batch)
+		{
+			auto batchStart = std::chrono::steady_clock::now();
+			for (float sample : samples)
+				statistics.AddSample(sample);
+			batchTimes.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - batchStart).count() / numZonesPerBatch);
+		}
+
+		FrameTimeStatistics frameStats = statistics.GetStatistics();
+		LOG_INFO("[Bench] Frame statistics over {} samples: median {} ns per sample, p50 {} ms, p99.9 {} ms, {} stutters", windowSize,
+			Percentile(batchTimes, 0.5f), frameStats.P50, frameStats.P999, frameStats.NumStutters);
+		return Percentile(batchTimes, 0.5f);
+	};
+
+	float smallWindowSampleTime = measureStatistics(1024);
+	float largeWindowSampleTime = measureStatistics(65536);
+
+	// Counting an allocation and its free, the memory tracker stays on in every build so this has to be negligible next to the allocation
+	std::vector<float> trackingTimes;
+	for (uint32_t batch = 0; batch < numBatches; ++batch)
+	{
+		auto batchStart = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < numZonesPerBatch; ++i)
+		{
+			MemoryTracker::TrackAllocation(MEMORY_TAG_SCENE, 64);
+			MemoryTracker::TrackFree(MEMORY_TAG_SCENE, 64);
+		}
+		trackingTimes.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - batchStart).count() / numZonesPerBatch - loopTime);
+	}
+
+	float trackingTime = Percentile(trackingTimes, 0.5f);
+	LOG_INFO("[Bench] Memory tracking overhead: median {} ns per tracked allocation and free", trackingTime);
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"profiler_zones\": " << numBatches * numZonesPerBatch << ",\n";
+		output << "\t\"profiler_zone_median_ns\": " << zoneMedian << ",\n";
+		output << "\t\"profiler_zone_p95_ns\": " << zoneP95 << ",\n";
+		output << "\t\"profiler_dropped_zones\": " << stats.NumDroppedZones << ",\n";
+		output << "\t\"statistics_sample_1024_median_ns\": " << smallWindowSampleTime << ",\n";
+		output << "\t\"statistics_sample_65536_median_ns\": " << largeWindowSampleTime << ",\n";
+		output << "\t\"memory_tracking_median_ns\": " << trackingTime << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Counts what the logger writes without the cost of a console or a disk
+class CountingLogSink : public LogSink
+{
+public:
+	virtual void Write(Logger::Severity severity, const std::string& line) override
+	{
+		m_NumLines++;
+		m_NumBytes += line.size();
+	}
+
+	uint64_t GetNumLines() const { return m_NumLines; }
+
+private:
+	uint64_t m_NumLines = 0;
+	uint64_t m_NumBytes = 0;
+
+};
+
+// Times the call site cost of a message, and how many messages per second the logger thread formats and writes
+static int MeasureLoggerThroughput()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	// A batch fits into the ring of the thread, so batches measure the call site and not the logger thread
+	const uint32_t numMessagesPerBatch = 1000;
+	const uint32_t numBatches = 500;
+	const uint32_t numThroughputMessages = 1000000;
+	const uint32_t numThroughputThreads = 4;
+
+	auto sink = std::make_shared<CountingLogSink>();
+	Logger::Flush();
+	Logger::SetConsoleOutput(false);
+	Logger::AddSink(sink);
+
+	std::string filepath = "Resources/Models/DamagedHelmet/DamagedHelmet.gltf";
+	auto measureBatches = [&](auto logMessage)
+	{
+		std::vector<float> batchTimes;
+		for (uint32_t batch = 0; batch < numBatches; ++batch)
+		{
+			auto batchStart = std::chrono::steady_clock::now();
+			for (uint32_t i = 0; i < numMessagesPerBatch; ++i)
+				logMessage(i, batch);
+			batchTimes.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - batchStart).count() / numMessagesPerBatch);
+
+			// Outside of the measured time, so the next batch starts with an empty ring
+			Logger::Flush();
+		}
+		return Percentile(batchTimes, 0.5f);
+	};
+
+	float messageTime = measureBatches([&](uint32_t i, uint32_t batch) { LOG_INFO("[Bench] Loaded {} in {} ms ({} of {})", filepath, 0.5f * i, i, batch); });
+	// The message built by the caller, like the call sites before the format strings, as the baseline
+	float stringMessageTime = measureBatches([&](uint32_t i, uint32_t batch) {
+		LOG_INFO("[Bench] Loaded " + filepath + " in " + std::to_string(0.5f * i) + " ms (" + std::to_string(i) + " of " + std::to_string(batch) + ")");
+	});
+	float filteredMessageTime = 0.0f;
+	{
+		Logger::SetMinSeverity(Logger::Severity::WARN);
+		filteredMessageTime = measureBatches([&](uint32_t i, uint32_t batch) { LOG_INFO("[Bench] Loaded {} in {} ms ({} of {})", filepath, 0.5f * i, i, batch); });
+		Logger::SetMinSeverity(Logger::Severity::INFO);
+	}
+
+	// End to end, from the first message until the logger thread wrote the last one
+	auto measureThroughput = [&](uint32_t numThreads)
+	{
+		uint64_t numLinesBefore = sink->GetNumLines();
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<std::thread> threads;
+		for (uint32_t thread = 0; thread < numThreads; ++thread)
+		{
+			threads.emplace_back([&, thread]() {
+				for (uint32_t i = thread; i < numThroughputMessages; i += numThreads)
+					LOG_INFO("[Bench] Loaded {} in {} ms ({} of {})", filepath, 0.5f * i, i, thread);
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+		Logger::Flush();
+
+		float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+		ASSERT(sink->GetNumLines() - numLinesBefore == numThroughputMessages, "Logger lost messages");
+		return numThroughputMessages / seconds;
+	};
+
+	float singleThreadThroughput = measureThroughput(1);
+	float multiThreadThroughput = measureThroughput(numThroughputThreads);
+	LoggerStatistics stats = Logger::GetStatistics();
+
+	Logger::RemoveSink(sink);
+	Logger::SetConsoleOutput(true);
+
+	LOG_INFO("[Bench] Logger call site: median {} ns per message, {} ns with the message built as a string, {} ns when filtered out",
+		messageTime, stringMessageTime, filteredMessageTime);
+	LOG_INFO("[Bench] Logger throughput: {} messages per second from 1 thread, {} from {} threads, {} messages waited for room in a ring",
+		singleThreadThroughput, multiThreadThroughput, numThroughputThreads, stats.NumBlockedMessages);
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"logger_message_median_ns\": " << messageTime << ",\n";
+		output << "\t\"logger_string_message_median_ns\": " << stringMessageTime << ",\n";
+		output << "\t\"logger_filtered_message_median_ns\": " << filteredMessageTime << ",\n";
+		output << "\t\"logger_messages_per_second\": " << singleThreadThroughput << ",\n";
+		output << "\t\"logger_messages_per_second_" << numThroughputThreads << "_threads\": " << multiThreadThroughput << ",\n";
+		output << "\t\"logger_blocked_messages\": " << stats.NumBlockedMessages << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int MeasureShaderCache()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	// About what DXC takes for one of the shaders of the renderer
+	const float compileTime = 20.0f;
+	const std::filesystem::path benchDirectory = "Cache/ShaderCacheBench/";
+	const std::string shaderDirectory = (benchDirectory / "Shaders/").generic_string();
+	const std::string editedInclude = "Common.hlsl";
+
+	// Shaders are copied, so the include can be edited without touching the shaders of the renderer
+	std::error_code error;
+	std::filesystem::remove_all(benchDirectory, error);
+	std::filesystem::create_directories(shaderDirectory, error);
+	std::filesystem::copy("Resources/Shaders/", shaderDirectory, std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing, error);
+
+	if (error)
+	{
+		LOG_ERR("[Bench] Could not copy the shaders to {}", shaderDirectory);
+		return 1;
+	}
+
+	ShaderCacheDesc cacheDesc;
+	cacheDesc.Directory = (benchDirectory / "Binaries/").generic_string();
+	ShaderCache::Initialize(std::make_unique<HeadlessShaderCompiler>(compileTime), cacheDesc);
+
+	std::vector<ShaderCompileDesc> descs;
+	ShaderCache::GetDirectoryShaders(shaderDirectory, descs);
+
+	if (descs.empty())
+	{
+		LOG_ERR("[Bench] No shaders found in {}", shaderDirectory);
+		ShaderCache::Finalize();
+		return 1;
+	}
+
+	auto measure = [](auto compile)
+	{
+		auto start = std::chrono::steady_clock::now();
+		compile();
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	float serialTime = measure([&]() {
+		for (const ShaderCompileDesc& desc : descs)
+			ShaderCache::GetShader(desc);
+	});
+
+	// Cold again, nothing in memory and nothing on disk
+	ShaderCache::ClearMemory();
+	std::filesystem::remove_all(cacheDesc.Directory, error);
+	std::filesystem::create_directories(cacheDesc.Directory, error);
+
+	uint32_t numFailed = 0;
+	float parallelTime = measure([&]() { numFailed = ShaderCache::CompileDirectory(shaderDirectory); });
+	ShaderCache::ClearMemory();
+	float diskTime = measure([&]() { ShaderCache::CompileDirectory(shaderDirectory); });
+	float memoryTime = measure([&]() { ShaderCache::CompileDirectory(shaderDirectory); });
+
+	// Shaders that include the edited file, directly or through another include, are the only ones that may be recompiled
+	uint32_t numDependents = 0;
+	for (const ShaderCompileDesc& desc : descs)
+	{
+		ShaderSources sources;
+		ShaderCache::LoadSources(desc.Filepath, sources);
+
+		auto isEditedInclude = [&](const ShaderSourceFile& source) { return source.Filepath == shaderDirectory + editedInclude; };
+		if (std::any_of(sources.begin() + 1, sources.end(), isEditedInclude))
+			numDependents++;
+	}
+
+	{
+		std::ofstream include(shaderDirectory + editedInclude, std::ios::app);
+		include << "\n// Edited by dx12r_bench\n";
+	}
+
+	ShaderCache::ClearMemory();
+	uint32_t numCompiledBefore = ShaderCache::GetStatistics().NumCompiled;
+	float invalidationTime = measure([&]() { ShaderCache::CompileDirectory(shaderDirectory); });
+	uint32_t numRecompiled = ShaderCache::GetStatistics().NumCompiled - numCompiledBefore;
+
+	ShaderCacheStatistics stats = ShaderCache::GetStatistics();
+	ShaderCache::Finalize();
+	std::filesystem::remove_all(benchDirectory, error);
+
+	LOG_INFO("[Bench] Shader cache, {} shaders at {} ms each with {} job workers: {} ms one by one, {} ms in parallel, {} ms from disk, {} ms from memory",
+		descs.size(), compileTime, JobSystem::GetNumWorkers(), serialTime, parallelTime, diskTime, memoryTime);
+	LOG_INFO("[Bench] Shader cache, editing {} recompiled {} of {} shaders that include it in {} ms, hashing took {} ms in total",
+		editedInclude, numRecompiled, numDependents, invalidationTime, stats.HashTime);
+
+	if (numFailed > 0 || numRecompiled != numDependents)
+	{
+		LOG_ERR("[Bench] Shader cache failed {} shaders and recompiled {} instead of {} after the edit", numFailed, numRecompiled, numDependents);
+		return 1;
+	}
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"shader_cache_num_shaders\": " << descs.size() << ",\n";
+		output << "\t\"shader_cache_serial_ms\": " << serialTime << ",\n";
+		output << "\t\"shader_cache_parallel_ms\": " << parallelTime << ",\n";
+		output << "\t\"shader_cache_disk_ms\": " << diskTime << ",\n";
+		output << "\t\"shader_cache_memory_ms\": " << memoryTime << ",\n";
+		output << "\t\"shader_cache_invalidation_ms\": " << invalidationTime << ",\n";
+		output << "\t\"shader_cache_recompiled_shaders\": " << numRecompiled << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// The members of the D3D12 descriptions the passes of the renderer differ in
+struct BenchPipelineStateDesc
+{
+	std::string VertexShaderPath;
+	std::string PixelShaderPath;
+	std::string ComputeShaderPath;
+	std::vector<std::string> InputSemantics;
+
+	uint32_t NumRenderTargets = 1;
+	bool DepthEnabled = true;
+	bool BlendEnabled = false;
+	int DepthBias = 0;
+};
+
+static Hash128 HashBenchPipelineStateDesc(const BenchPipelineStateDesc& desc)
+{
+	PipelineStateHasher hasher;
+
+	// Bytecode is hashed like in the renderer, so identical shaders from different files would share a pipeline state as well
+	auto addShader = [&hasher](const std::string& filepath, const char* target)
+	{
+		std::shared_ptr<const ShaderBinary> binary;
+		if (!filepath.empty())
+			binary = ShaderCache::GetShader({ filepath, "main", target });
+
+		hasher.AddBytes(binary ? binary->Bytecode.data() : nullptr, binary ? binary->Bytecode.size() : 0);
+	};
+
+	addShader(desc.VertexShaderPath, SHADER_TARGET_VERTEX);
+	addShader(desc.PixelShaderPath, SHADER_TARGET_PIXEL);
+	addShader(desc.ComputeShaderPath, SHADER_TARGET_COMPUTE);
+
+	hasher.Add(static_cast<uint32_t>(desc.InputSemantics.size()));
+	for (const std::string& semantic : desc.InputSemantics)
+		hasher.AddString(semantic.c_str());
+
+	hasher.Add(desc.NumRenderTargets);
+	hasher.Add(desc.DepthEnabled);
+	hasher.Add(desc.BlendEnabled);
+	hasher.Add(desc.DepthBias);
+
+	return hasher.GetHash();
+}
+
+static int MeasurePipelineStates()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	// About what a driver takes for one of the pipeline states of the renderer without a pipeline library
+	const float creationTime = 30.0f;
+	const float frameTime = 16.0f;
+	// Every state is requested from several places, like the materials of a scene sharing the states of the passes
+	const uint32_t numRequestsPerState = 4;
+	const std::string shaderDirectory = "Resources/Shaders/";
+	const std::filesystem::path benchDirectory = "Cache/PipelineStateBench/";
+
+	ShaderCacheDesc cacheDesc;
+	cacheDesc.Directory = benchDirectory.generic_string();
+	ShaderCache::Initialize(std::make_unique<HeadlessShaderCompiler>(), cacheDesc);
+
+	std::vector<BenchPipelineStateDesc> descs;
+	descs.push_back({ shaderDirectory + "ShadowMapping_VS.hlsl", shaderDirectory + "ShadowMapping_PS.hlsl", "", { "POSITION" }, 0, true, false, 100 });
+	descs.push_back({ shaderDirectory + "ShadowCompose_VS.hlsl", shaderDirectory + "ShadowCompose_PS.hlsl", "", {}, 0 });
+	descs.push_back({ shaderDirectory + "DepthPrepass_VS.hlsl", shaderDirectory + "DepthPrepass_PS.hlsl", "", { "POSITION", "TEXCOORD" }, 0 });
+	descs.push_back({ shaderDirectory + "Lighting_VS.hlsl", shaderDirectory + "Lighting_PS.hlsl", "", { "POSITION", "TEXCOORD", "NORMAL", "TANGENT" }, 2, true, true });
+	descs.push_back({ shaderDirectory + "DebugLine_VS.hlsl", shaderDirectory + "DebugLine_PS.hlsl", "", { "POSITION", "COLOR" }, 1 });
+	descs.push_back({ "", "", shaderDirectory + "LightClustering_CS.hlsl", {}, 0, false });
+	descs.push_back({ "", "", shaderDirectory + "TemporalAA_CS.hlsl", {}, 0, false });
+	descs.push_back({ "", "", shaderDirectory + "PostProcess_CS.hlsl", {}, 0, false });
+	descs.push_back({ "", "", shaderDirectory + "MipMapGen_CS.hlsl", {}, 0, false });
+
+	auto measure = [](auto function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	std::atomic<uint32_t> numCreated = 0;
+	std::atomic<uint32_t> numReleased = 0;
+	auto create = [&numCreated, creationTime]() -> void*
+	{
+		std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(creationTime));
+		numCreated++;
+		return new uint32_t(numCreated.load());
+	};
+	auto release = [&numReleased](void* pipelineState)
+	{
+		delete static_cast<uint32_t*>(pipelineState);
+		numReleased++;
+	};
+
+	// Keys only depend on the contents of a description, a copy gives the same key and changing a single member gives another one
+	std::vector<Hash128> keys;
+	for (const BenchPipelineStateDesc& desc : descs)
+		keys.push_back(HashBenchPipelineStateDesc(desc));
+
+	BenchPipelineStateDesc changedDesc = descs[0];
+	changedDesc.DepthBias++;
+	bool areKeysStable = HashBenchPipelineStateDesc(BenchPipelineStateDesc(descs[0])) == keys[0] && HashBenchPipelineStateDesc(changedDesc) != keys[0];
+
+	// How the passes created their pipeline states before, one after the other while the renderer initializes
+	float serialTime = measure([&]()
+	{
+		for (std::size_t i = 0; i < descs.size(); ++i)
+			release(create());
+	});
+
+	uint32_t numFramesWaiting = 0;
+	uint32_t numMismatchedIDs = 0;
+	float requestTime = 0.0f, readyTime = 0.0f;
+	PipelineStateCacheStatistics stats;
+
+	{
+		PipelineStateCache cache(release);
+		std::vector<uint32_t> ids(descs.size(), PIPELINE_STATE_CACHE_INVALID_ID);
+
+		auto start = std::chrono::steady_clock::now();
+		requestTime = measure([&]()
+		{
+			for (uint32_t request = 0; request < numRequestsPerState; ++request)
+			{
+				for (std::size_t i = 0; i < descs.size(); ++i)
+				{
+					uint32_t id = cache.Request(HashBenchPipelineStateDesc(descs[i]), "Bench pipeline state", create);
+					if (request > 0 && id != ids[i])
+						numMismatchedIDs++;
+
+					ids[i] = id;
+				}
+			}
+		});
+
+		// Frames go on and skip their draws until every pipeline state is ready, like the renderer does
+		auto isReady = [&]() { return std::all_of(ids.begin(), ids.end(), [&](uint32_t id) { return cache.GetPipelineState(id) != nullptr; }); };
+		while (!isReady())
+		{
+			numFramesWaiting++;
+			std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(frameTime));
+		}
+
+		readyTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		stats = cache.GetStatistics();
+	}
+
+	ShaderCache::Finalize();
+	std::error_code error;
+	std::filesystem::remove_all(benchDirectory, error);
+
+	uint32_t numRequests = static_cast<uint32_t>(descs.size()) * numRequestsPerState;
+	LOG_INFO("[Bench] Pipeline states, {} states at {} ms each with {} job workers: {} ms one by one, requests returned after {} ms, all ready after {} ms ({} frames skipped)",
+		descs.size(), creationTime, JobSystem::GetNumWorkers(), serialTime, requestTime, readyTime, numFramesWaiting);
+	LOG_INFO("[Bench] Pipeline states, {} requests created {} states, {} were deduplicated, {} released",
+		numRequests, stats.NumCreated, stats.NumDeduplicated, numReleased.load() - descs.size());
+
+	bool isDeduplicated = stats.NumCreated == descs.size() && stats.NumDeduplicated == numRequests - descs.size() && numMismatchedIDs == 0;
+	bool isReleased = numReleased.load() == 2 * descs.size();
+	if (!areKeysStable || !isDeduplicated || !isReleased)
+	{
+		LOG_ERR("[Bench] Pipeline state cache failed, stable keys: {}, deduplicated: {}, released: {}", areKeysStable, isDeduplicated, isReleased);
+		return 1;
+	}
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"pipeline_states_num_states\": " << descs.size() << ",\n";
+		output << "\t\"pipeline_states_num_requests\": " << numRequests << ",\n";
+		output << "\t\"pipeline_states_serial_ms\": " << serialTime << ",\n";
+		output << "\t\"pipeline_states_request_ms\": " << requestTime << ",\n";
+		output << "\t\"pipeline_states_ready_ms\": " << readyTime << ",\n";
+		output << "\t\"pipeline_states_frames_skipped\": " << numFramesWaiting << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int MeasureShaderPermutations()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	const uint32_t numDraws = 10000;
+	const uint32_t numMaterials = 256;
+	const std::filesystem::path benchDirectory = "Cache/ShaderPermutationBench/";
+	const ShaderPermutationManifest& manifest = ShaderPermutation::GetLightingManifest();
+	ShaderPermutationSet permutations(manifest);
+
+	// The selection table against a search over all variants, no compatible variant may have a subset of the capabilities
+	// of the selected one, or the same capabilities and a superset of its specializations
+	auto isSubset = [](uint32_t lhs, uint32_t rhs) { return (lhs & ~rhs) == 0 && lhs != rhs; };
+	uint32_t numWrongSelections = 0;
+
+	for (uint32_t drawFeatures = 0; drawFeatures <= SHADER_FEATURE_ALL; ++drawFeatures)
+	{
+		uint32_t features = drawFeatures & manifest.SupportedFeatures;
+		uint32_t selectedFeatures = manifest.Variants[permutations.SelectVariant(drawFeatures)];
+
+		if (!ShaderPermutation::IsVariantCompatible(selectedFeatures, features))
+		{
+			numWrongSelections++;
+			continue;
+		}
+
+		for (uint32_t variantFeatures : manifest.Variants)
+		{
+			uint32_t capabilities = variantFeatures & SHADER_FEATURE_CAPABILITIES;
+			uint32_t selectedCapabilities = selectedFeatures & SHADER_FEATURE_CAPABILITIES;
+			bool isBetter = isSubset(capabilities, selectedCapabilities) ||
+				(capabilities == selectedCapabilities && isSubset(selectedFeatures & SHADER_FEATURE_SPECIALIZATIONS, variantFeatures & SHADER_FEATURE_SPECIALIZATIONS));
+
+			if (ShaderPermutation::IsVariantCompatible(variantFeatures, features) && isBetter)
+			{
+				numWrongSelections++;
+				break;
+			}
+		}
+	}
+
+	// Manifests are bounded, one variant more than allowed is rejected
+	ShaderPermutationManifest oversizedManifest = manifest;
+	for (uint32_t features = 0; oversizedManifest.Variants.size() <= SHADER_PERMUTATION_MAX_VARIANTS; ++features)
+		oversizedManifest.Variants.push_back(manifest.Variants[0] | (features << SHADER_FEATURE_NUM_BITS));
+
+	LOG_INFO("[Bench] Shader permutations, a manifest with {} variants has to be rejected:", oversizedManifest.Variants.size());
+	bool isBounded = ShaderPermutation::ValidateManifest(manifest) && !ShaderPermutation::ValidateManifest(oversizedManifest);
+
+	// Every variant compiles to a binary of its own, compiling them again only hits the memory of the shader cache
+	std::error_code error;
+	std::filesystem::remove_all(benchDirectory, error);
+
+	ShaderCacheDesc cacheDesc;
+	cacheDesc.Directory = benchDirectory.generic_string();
+	ShaderCache::Initialize(std::make_unique<HeadlessShaderCompiler>(), cacheDesc);
+
+	std::vector<ShaderCompileDesc> descs(permutations.GetNumVariants());
+	for (uint32_t variant = 0; variant < permutations.GetNumVariants(); ++variant)
+	{
+		descs[variant].Filepath = "Resources/Shaders/Lighting_PS.hlsl";
+		descs[variant].Target = SHADER_TARGET_PIXEL;
+		ShaderPermutation::GetDefines(permutations.GetVariantFeatures(variant), descs[variant].Defines);
+	}
+
+	std::vector<std::shared_ptr<const ShaderBinary>> binaries;
+	ShaderCache::CompileShaders(descs, binaries);
+	uint32_t numCompiled = ShaderCache::GetStatistics().NumCompiled;
+	ShaderCache::CompileShaders(descs, binaries);
+	ShaderCacheStatistics cacheStats = ShaderCache::GetStatistics();
+
+	std::unordered_map<Hash128, uint32_t, Hash128Hasher> distinctBinaries;
+	for (const auto& binary : binaries)
+	{
+		if (binary)
+			distinctBinaries[Hash::Bytes(binary->Bytecode.data(), binary->Bytecode.size())]++;
+	}
+
+	ShaderCache::Finalize();
+	std::filesystem::remove_all(benchDirectory, error);
+
+	bool areVariantsCompiled = distinctBinaries.size() == descs.size() && numCompiled == descs.size() && cacheStats.NumCompiled == numCompiled &&
+		cacheStats.NumMemoryHits == descs.size();
+
+	// Random draws of materials with and without textures, recorded in submission order and in the order of their sort keys
+	std::mt19937 random(1234);
+	std::vector<uint32_t> materialFeatures(numMaterials);
+	for (uint32_t& features : materialFeatures)
+		features = random() & (SHADER_FEATURE_NORMAL_MAP | SHADER_FEATURE_METALLIC_ROUGHNESS_MAP);
+
+	std::vector<uint64_t> sortKeys(numDraws);
+	for (uint64_t& sortKey : sortKeys)
+	{
+		uint32_t material = random() % numMaterials;
+		sortKey = ShaderPermutation::MakeDrawSortKey(materialFeatures[material], material, random() % 1024);
+	}
+
+	auto countSwitches = [&](const std::vector<uint64_t>& keys, uint32_t frameFeatures)
+	{
+		uint32_t numSwitches = 0;
+		uint32_t boundVariant = 0;
+
+		for (uint64_t sortKey : keys)
+		{
+			uint32_t variant = permutations.SelectVariant(ShaderPermutation::GetDrawSortKeyFeatures(sortKey) | frameFeatures);
+			numSwitches += variant != boundVariant ? 1 : 0;
+			boundVariant = variant;
+		}
+
+		return numSwitches;
+	};
+
+	uint32_t numUnsortedSwitches = countSwitches(sortKeys, SHADER_FEATURE_NONE);
+	std::sort(sortKeys.begin(), sortKeys.end());
+	uint32_t numSortedSwitches = countSwitches(sortKeys, SHADER_FEATURE_NONE);
+	uint32_t numSortedShadowedSwitches = countSwitches(sortKeys, SHADER_FEATURE_SHADOWED_LIGHTS_ONLY);
+
+	// Sorted draws switch at most once per variant, and every key still gives back its features
+	bool areKeysSorted = numSortedSwitches < permutations.GetNumVariants() && numSortedShadowedSwitches < permutations.GetNumVariants() &&
+		std::all_of(sortKeys.begin(), sortKeys.end(), [&](uint64_t sortKey)
+		{
+			uint32_t material = static_cast<uint32_t>(sortKey >> 32) & 0x0FFFFFFF;
+			return ShaderPermutation::GetDrawSortKeyFeatures(sortKey) == materialFeatures[material];
+		});
+
+	LOG_INFO("[Bench] Shader permutations, {} has {} of at most {} variants, {} of {} feature combinations selected a wrong variant, {} distinct binaries",
+		manifest.Name, permutations.GetNumVariants(), SHADER_PERMUTATION_MAX_VARIANTS, numWrongSelections, SHADER_FEATURE_ALL + 1, distinctBinaries.size());
+	LOG_INFO("[Bench] Shader permutations, {} draws of {} materials switch pipeline states {} times in submission order and {} times sorted ({} with shadowed lights only)",
+		numDraws, numMaterials, numUnsortedSwitches, numSortedSwitches, numSortedShadowedSwitches);
+
+	if (numWrongSelections > 0 || !isBounded || !areVariantsCompiled || !areKeysSorted)
+	{
+		LOG_ERR("[Bench] Shader permutations failed, wrong selections: {}, bounded: {}, variants compiled: {}, keys sorted: {}",
+			numWrongSelections, isBounded, areVariantsCompiled, areKeysSorted);
+		return 1;
+	}
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"shader_permutations_num_variants\": " << permutations.GetNumVariants() << ",\n";
+		output << "\t\"shader_permutations_max_variants\": " << SHADER_PERMUTATION_MAX_VARIANTS << ",\n";
+		output << "\t\"shader_permutations_num_draws\": " << numDraws << ",\n";
+		output << "\t\"shader_permutations_unsorted_switches\": " << numUnsortedSwitches << ",\n";
+		output << "\t\"shader_permutations_sorted_switches\": " << numSortedSwitches << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Hashes payloads the size of small descriptors, vertex streams and textures with the hash of the resource cache
+static int MeasureHashThroughput()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	const std::size_t payloadByteSizes[] = { 64, 4 * 1024, 256 * 1024, 16 * 1024 * 1024 };
+	// Every payload size hashes about the same number of bytes
+	const std::size_t numBytesPerPayloadSize = 1024ull * 1024 * 1024;
+
+	std::vector<uint8_t> payload(payloadByteSizes[std::size(payloadByteSizes) - 1]);
+	std::mt19937 engine(1337);
+	for (uint8_t& byte : payload)
+		byte = static_cast<uint8_t>(engine());
+
+	// Every hash uses another seed and is folded into the checksum, so none of them can be skipped by the compiler
+	uint64_t checksum = 0;
+	std::vector<float> throughputs;
+
+	for (std::size_t payloadByteSize : payloadByteSizes)
+	{
+		std::size_t numHashes = std::max<std::size_t>(numBytesPerPayloadSize / payloadByteSize, 1);
+
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < numHashes; ++i)
+		{
+			Hash128 hash = Hash::Bytes(payload.data(), payloadByteSize, i);
+			checksum ^= hash.Low ^ hash.High;
+		}
+		float time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		float throughput = static_cast<float>(TO_MEGABYTE(static_cast<double>(payloadByteSize * numHashes)) / 1024.0 / (time / 1000.0f));
+		throughputs.push_back(throughput);
+
+		LOG_INFO("[Bench] Hash::Bytes of {} bytes: {} ns per hash, {} GB/s", payloadByteSize, time * 1000000.0f / numHashes, throughput);
+	}
+
+	LOG_INFO("[Bench] Hash checksum: {}", checksum);
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		for (std::size_t i = 0; i < throughputs.size(); ++i)
+			output << "\t\"hash_" << payloadByteSizes[i] << "_bytes_gb_per_s\": " << throughputs[i] << (i + 1 < throughputs.size() ? ",\n" : "\n");
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+
+	Loads a generated scene through the resource cache into the renderer on the headless backend, twice, like loading two models
+	that share all of their content. Materials use three of a small set of images and meshes reuse a small set of vertex payloads,
+	all index buffers are the same, so the first load already deduplicates most resources and the second load only has hits.
+	Checks that the second load returns the handles of the first, that the renderer only received the unique resources,
+	and that releasing every reference leaves nothing in the cache.
+
+*/
+static int MeasureResourceCache()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	const uint32_t numImages = 32;
+	const uint32_t imageSize = 256;
+	const uint32_t numMaterials = 128;
+	const uint32_t numVertexPayloads = 64;
+	const uint32_t numVertices = 4096;
+	const uint32_t numMeshes = 512;
+	const uint32_t numLoads = 2;
+
+	InitializeRenderer(settings.Width, settings.Height);
+	HeadlessBackend& backend = static_cast<HeadlessBackend&>(Renderer::GetBackend());
+
+	std::mt19937 engine(1337);
+	auto fillRandom = [&engine](std::vector<uint8_t>& bytes, std::size_t byteSize)
+	{
+		bytes.resize(byteSize);
+		for (uint8_t& byte : bytes)
+			byte = static_cast<uint8_t>(engine());
+	};
+
+	std::vector<std::vector<uint8_t>> images(numImages);
+	for (std::vector<uint8_t>& image : images)
+		fillRandom(image, imageSize * imageSize * 4);
+
+	VertexPositionFormat positionFormat = Renderer::GetMeshPositionFormat();
+	std::vector<std::vector<uint8_t>> positionStreams(numVertexPayloads), attributeStreams(numVertexPayloads);
+	for (uint32_t payload = 0; payload < numVertexPayloads; ++payload)
+	{
+		fillRandom(positionStreams[payload], numVertices * ModelImporter::GetPositionByteSize(positionFormat));
+		fillRandom(attributeStreams[payload], numVertices * sizeof(VertexAttributes));
+	}
+
+	std::vector<uint32_t> indices(numVertices);
+	for (uint32_t i = 0; i < numVertices; ++i)
+		indices[i] = i;
+
+	auto makeTextureDesc = [&](TextureDesc& textureDesc, uint32_t image, TextureFormat format)
+	{
+		textureDesc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+		textureDesc.Format = format;
+		textureDesc.Width = imageSize;
+		textureDesc.Height = imageSize;
+		textureDesc.DataPtr = images[image].data();
+		textureDesc.DebugName = "Resource cache bench image " + std::to_string(image);
+	};
+
+	std::vector<MaterialDesc> materialDescs(numMaterials);
+	for (uint32_t material = 0; material < numMaterials; ++material)
+	{
+		MaterialDesc& materialDesc = materialDescs[material];
+		makeTextureDesc(materialDesc.AlbedoDesc, (material * 3) % numImages, TextureFormat::TEXTURE_FORMAT_RGBA8_SRGB);
+		makeTextureDesc(materialDesc.NormalDesc, (material * 3 + 1) % numImages, TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM);
+		makeTextureDesc(materialDesc.MetallicRoughnessDesc, (material * 3 + 2) % numImages, TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM);
+		materialDesc.Roughness = static_cast<float>(material) / numMaterials;
+	}
+
+	// Mesh i uses vertex payload i % numVertexPayloads and material i % numMaterials, which gives numMaterials unique meshes
+	std::vector<MeshDesc> meshDescs(numMeshes);
+	for (uint32_t mesh = 0; mesh < numMeshes; ++mesh)
+	{
+		uint32_t payload = mesh % numVertexPayloads;
+
+		MeshDesc& meshDesc = meshDescs[mesh];
+		meshDesc.DebugName = "Resource cache bench mesh " + std::to_string(mesh);
+		meshDesc.PositionBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.PositionBufferDesc.NumElements = numVertices;
+		meshDesc.PositionBufferDesc.ElementSize = ModelImporter::GetPositionByteSize(positionFormat);
+		meshDesc.PositionBufferDesc.DataPtr = positionStreams[payload].data();
+		meshDesc.PositionBufferDesc.DebugName = meshDesc.DebugName + " position buffer";
+		meshDesc.AttributeBufferDesc.Usage = BufferUsage::BUFFER_USAGE_VERTEX;
+		meshDesc.AttributeBufferDesc.NumElements = numVertices;
+		meshDesc.AttributeBufferDesc.ElementSize = sizeof(VertexAttributes);
+		meshDesc.AttributeBufferDesc.DataPtr = attributeStreams[payload].data();
+		meshDesc.AttributeBufferDesc.DebugName = meshDesc.DebugName + " attribute buffer";
+		meshDesc.IndexBufferDesc.Usage = BufferUsage::BUFFER_USAGE_INDEX;
+		meshDesc.IndexBufferDesc.NumElements = numVertices;
+		meshDesc.IndexBufferDesc.ElementSize = sizeof(uint32_t);
+		meshDesc.IndexBufferDesc.DataPtr = indices.data();
+		meshDesc.IndexBufferDesc.DebugName = meshDesc.DebugName + " index buffer";
+		meshDesc.PositionFormat = positionFormat;
+		meshDesc.BB.Min = glm::vec3(-1.0f);
+		meshDesc.BB.Max = glm::vec3(1.0f);
+	}
+
+	HeadlessBackendStatistics backendStatsBefore = backend.GetStatistics();
+
+	std::vector<RenderResourceHandle> materialHandles[numLoads], meshHandles[numLoads];
+	float loadTimes[numLoads] = {};
+	ResourceCacheStatistics loadStats[numLoads];
+
+	for (uint32_t load = 0; load < numLoads; ++load)
+	{
+		ResourceCacheStatistics statsBefore = ResourceCache::GetStatistics();
+		auto start = std::chrono::steady_clock::now();
+
+		for (const MaterialDesc& materialDesc : materialDescs)
+			materialHandles[load].push_back(ResourceCache::GetOrCreateMaterial(materialDesc));
+
+		for (uint32_t mesh = 0; mesh < numMeshes; ++mesh)
+		{
+			MeshDesc meshDesc = meshDescs[mesh];
+			meshDesc.MaterialHandle = materialHandles[load][mesh % numMaterials];
+			meshHandles[load].push_back(ResourceCache::GetOrCreateMesh(meshDesc));
+		}
+
+		loadTimes[load] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		const ResourceCacheStatistics& statsAfter = ResourceCache::GetStatistics();
+		loadStats[load].NumHits = statsAfter.NumHits - statsBefore.NumHits;
+		loadStats[load].NumMisses = statsAfter.NumMisses - statsBefore.NumMisses;
+		loadStats[load].NumCollisions = statsAfter.NumCollisions - statsBefore.NumCollisions;
+		loadStats[load].BytesHashed = statsAfter.BytesHashed - statsBefore.BytesHashed;
+		loadStats[load].BytesDeduplicated = statsAfter.BytesDeduplicated - statsBefore.BytesDeduplicated;
+		loadStats[load].HashTime = statsAfter.HashTime - statsBefore.HashTime;
+
+		LOG_INFO("[Bench] Resource cache load {}: {} ms, {} hits, {} misses, {} collisions, hashed {} MB in {} ms, deduplicated {} MB",
+			load, loadTimes[load], loadStats[load].NumHits, loadStats[load].NumMisses, loadStats[load].NumCollisions,
+			TO_MEGABYTE(static_cast<double>(loadStats[load].BytesHashed)), loadStats[load].HashTime, TO_MEGABYTE(static_cast<double>(loadStats[load].BytesDeduplicated)));
+	}
+
+	// Only the unique textures and buffers may reach the renderer, the second load must not create anything
+	// Every image is used as an sRGB albedo texture and as a UNORM texture, the format is part of the texture key
+	const HeadlessBackendStatistics& backendStats = backend.GetStatistics();
+	uint32_t numCreatedTextures = backendStats.NumTextures - backendStatsBefore.NumTextures;
+	uint32_t numCreatedBuffers = backendStats.NumBuffers - backendStatsBefore.NumBuffers;
+	bool isDeduplicated = numCreatedTextures == 2 * numImages && numCreatedBuffers == 2 * numVertexPayloads + 1 &&
+		loadStats[1].NumMisses == 0 && loadStats[0].NumCollisions == 0;
+	auto isSameHandle = [](RenderResourceHandle lhs, RenderResourceHandle rhs) { return lhs.Handle == rhs.Handle; };
+	bool isSameHandles = std::equal(materialHandles[0].begin(), materialHandles[0].end(), materialHandles[1].begin(), isSameHandle) &&
+		std::equal(meshHandles[0].begin(), meshHandles[0].end(), meshHandles[1].begin(), isSameHandle);
+
+	LOG_INFO("[Bench] Resource cache: {} materials and {} meshes created {} textures and {} buffers in the renderer",
+		numMaterials, numMeshes, numCreatedTextures, numCreatedBuffers);
+
+	// Every GetOrCreate added a reference, releasing them all also releases the textures and buffers they depend on
+	auto releaseStart = std::chrono::steady_clock::now();
+	for (uint32_t load = 0; load < numLoads; ++load)
+	{
+		for (RenderResourceHandle handle : meshHandles[load])
+			ResourceCache::Release(CachedResourceType::CACHED_RESOURCE_TYPE_MESH, handle);
+		for (RenderResourceHandle handle : materialHandles[load])
+			ResourceCache::Release(CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL, handle);
+	}
+	float releaseTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - releaseStart).count();
+
+	bool isReleased = std::all_of(meshHandles[0].begin(), meshHandles[0].end(),
+		[](RenderResourceHandle handle) { return ResourceCache::GetRefCount(CachedResourceType::CACHED_RESOURCE_TYPE_MESH, handle) == 0; }) &&
+		std::all_of(materialHandles[0].begin(), materialHandles[0].end(),
+		[](RenderResourceHandle handle) { return ResourceCache::GetRefCount(CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL, handle) == 0; });
+
+	LOG_INFO("[Bench] Resource cache: released every reference in {} ms", releaseTime);
+
+	if (!isDeduplicated || !isSameHandles || !isReleased)
+	{
+		LOG_ERR("[Bench] Resource cache failed, deduplicated: {}, same handles: {}, released: {}", isDeduplicated, isSameHandles, isReleased);
+		return 1;
+	}
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"resource_cache_first_load_ms\": " << loadTimes[0] << ",\n";
+		output << "\t\"resource_cache_second_load_ms\": " << loadTimes[1] << ",\n";
+		output << "\t\"resource_cache_first_load_hits\": " << loadStats[0].NumHits << ",\n";
+		output << "\t\"resource_cache_first_load_misses\": " << loadStats[0].NumMisses << ",\n";
+		output << "\t\"resource_cache_second_load_hits\": " << loadStats[1].NumHits << ",\n";
+		output << "\t\"resource_cache_hash_ms\": " << loadStats[0].HashTime + loadStats[1].HashTime << ",\n";
+		output << "\t\"resource_cache_deduplicated_bytes\": " << loadStats[0].BytesDeduplicated + loadStats[1].BytesDeduplicated << ",\n";
+		output << "\t\"resource_cache_release_ms\": " << releaseTime << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+struct LightClusteringResult
+{
+	uint32_t NumLights = 0;
+	std::vector<float> BuildTimes;
+	uint64_t NumLightAssignments = 0;
+	uint64_t NumDroppedAssignments = 0;
+	uint64_t NumOccupiedClusters = 0;
+	uint32_t MaxLightsInCluster = 0;
+	uint32_t NumMismatchingClusters = 0;
+};
+
+/*
+
+	Builds the light clusters like the renderer does every frame, from spot and pointlights spread over a city sized volume,
+	without the light limits of the renderer. The camera orbits through the volume, so the lights move through the grid every frame.
+	The first frame of every light count is also built without the job system, both builds have to produce the same lists.
+
+*/
+static int MeasureLightClustering()
+{
+	const BenchSettings& settings = s_Data.Settings;
+	const uint32_t maxLights = settings.NumLights > 0 ? settings.NumLights : 16384;
+	const uint32_t numFrames = settings.HasFrameCount ? settings.NumFrames : 120;
+	const glm::vec3 volumeExtent = glm::vec3(200.0f, 40.0f, 200.0f);
+
+	std::vector<uint32_t> lightCounts;
+	for (uint32_t numLights = 1024; numLights < maxLights; numLights *= 4)
+		lightCounts.push_back(numLights);
+	lightCounts.push_back(maxLights);
+
+	std::vector<LightClusteringResult> results;
+	LightClusterLists lists, referenceLists;
+	std::vector<glm::vec4> worldSpheres, viewSpheres;
+
+	for (uint32_t numLights : lightCounts)
+	{
+		// Fixed seed like GenerateLights, so every run gets the same lights, spotlights come first like the renderer uploads them
+		std::mt19937 engine(1337);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		uint32_t numSpotLights = numLights / 2;
+
+		worldSpheres.clear();
+		for (uint32_t i = 0; i < numLights; ++i)
+		{
+			glm::vec3 position = (glm::vec3(unit(engine), unit(engine), unit(engine)) - 0.5f) * volumeExtent;
+			float range = 2.0f + 6.0f * unit(engine);
+
+			if (i < numSpotLights)
+			{
+				glm::vec3 direction = glm::vec3(unit(engine), unit(engine), unit(engine)) * 2.0f - 1.0f;
+				direction = glm::length(direction) > 0.001f ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+				float cosOuterConeAngle = glm::cos(glm::radians(15.0f + 45.0f * unit(engine)));
+				worldSpheres.push_back(LightClustering::GetSpotLightBoundingSphere(position, direction, range, cosOuterConeAngle));
+			}
+			else
+			{
+				worldSpheres.push_back(LightClustering::GetPointLightBoundingSphere(position, range));
+			}
+		}
+
+		LightClusteringResult& result = results.emplace_back();
+		result.NumLights = numLights;
+
+		for (uint32_t frame = 0; frame < numFrames; ++frame)
+		{
+			float orbitAngle = static_cast<float>(frame) / numFrames * glm::two_pi<float>();
+			glm::vec3 eye = glm::vec3(glm::cos(orbitAngle), 0.0f, glm::sin(orbitAngle)) * volumeExtent * 0.3f;
+			Camera camera(glm::lookAtLH(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)), 60.0f,
+				static_cast<float>(settings.Width) / settings.Height, 0.1f, 1000.0f);
+
+			auto buildStart = std::chrono::steady_clock::now();
+
+			const ViewFrustum& frustum = camera.GetViewFrustum();
+			LightClusterGridData grid = LightClustering::MakeGridData(camera.GetViewMatrix(), camera.GetProjectionMatrix(), frustum.GetNear(), frustum.GetFar(),
+				glm::vec2(settings.Width, settings.Height), numSpotLights, numLights - numSpotLights);
+			LightClustering::TransformSpheresToViewSpace(grid, worldSpheres, viewSpheres);
+			LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+			result.BuildTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - buildStart).count());
+
+			LightClusterStatistics stats = LightClustering::GetStatistics(lists, numLights);
+			result.NumLightAssignments += stats.NumLightAssignments;
+			result.NumDroppedAssignments += stats.NumDroppedAssignments;
+			result.NumOccupiedClusters += stats.NumOccupiedClusters;
+			result.MaxLightsInCluster = std::max(result.MaxLightsInCluster, stats.MaxLightsInCluster);
+
+			if (frame == 0)
+			{
+				referenceLists.LightCounts.resize(LIGHT_CLUSTER_COUNT);
+				referenceLists.LightIndices.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+				LightClustering::BuildClusters(grid, viewSpheres, referenceLists, 0, LIGHT_CLUSTER_COUNT);
+				result.NumMismatchingClusters = LightClustering::CompareClusters(lists, referenceLists);
+			}
+		}
+
+		float frames = static_cast<float>(numFrames);
+		LOG_INFO("[Bench] Light clustering of {} lights: avg {} ms, p95 {} ms, max {} ms per frame", numLights,
+			Average(result.BuildTimes), Percentile(result.BuildTimes, 0.95f), Percentile(result.BuildTimes, 1.0f));
+		LOG_INFO("[Bench]     {} assignments, {} dropped by full clusters and {} occupied clusters per frame, at most {} lights in a cluster",
+			result.NumLightAssignments / frames, result.NumDroppedAssignments / frames, result.NumOccupiedClusters / frames, result.MaxLightsInCluster);
+	}
+
+	bool isMatching = std::all_of(results.begin(), results.end(), [](const LightClusteringResult& result) { return result.NumMismatchingClusters == 0; });
+	if (!isMatching)
+	{
+		for (const LightClusteringResult& result : results)
+			LOG_ERR("[Bench] Light clustering of {} lights: {} clusters differ from the build without jobs", result.NumLights, result.NumMismatchingClusters);
+		return 1;
+	}
+
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			const LightClusteringResult& result = results[i];
+			float frames = static_cast<float>(numFrames);
+			std::string prefix = "\t\"light_clustering_" + std::to_string(result.NumLights) + "_lights_";
+
+			output << prefix << "avg_ms\": " << Average(result.BuildTimes) << ",\n";
+			output << prefix << "p95_ms\": " << Percentile(result.BuildTimes, 0.95f) << ",\n";
+			output << prefix << "assignments_per_frame\": " << result.NumLightAssignments / frames << ",\n";
+			output << prefix << "dropped_assignments_per_frame\": " << result.NumDroppedAssignments / frames << ",\n";
+			output << prefix << "max_lights_in_cluster\": " << result.MaxLightsInCluster << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!ParseArguments(argc, argv))
+		return 1;
+
+	BenchSettings& settings = s_Data.Settings;
+
+	if (!settings.LogFilepath.empty() && !Logger::AddFileSink(settings.LogFilepath))
+		return 1;
+
+	Profiler::SetThreadName("Main thread");
+	if (settings.MeasureProfilerOverhead)
+	{
+		int result = MeasureProfilerOverhead();
+		Profiler::Finalize();
+		return result;
+	}
+
+	if (settings.MeasureLoggerThroughput)
+		return MeasureLoggerThroughput();
+
+	if (settings.MeasureShaderCache)
+	{
+		JobSystem::Initialize();
+		int result = MeasureShaderCache();
+		JobSystem::Finalize();
+		return result;
+	}
+
+	if (settings.MeasurePipelineStates)
+	{
+		JobSystem::Initialize();
+		int result = MeasurePipelineStates();
+		JobSystem::Finalize();
+		return result;
+	}
+
+	if (settings.MeasureShaderPermutations)
+	{
+		JobSystem::Initialize();
+		int result = MeasureShaderPermutations();
+		JobSystem::Finalize();
+		return result;
+	}
+
+	if (settings.MeasureHashThroughput)
+		return MeasureHashThroughput();
+
+	if (settings.MeasureLightClustering)
+	{
+		JobSystem::Initialize();
+		int result = MeasureLightClustering();
+		JobSystem::Finalize();
+		return result;
+	}
+
+	if (settings.MeasureResourceCache)
+	{
+		JobSystem::Initialize();
+		int result = MeasureResourceCache();
+		Shutdown();
+		return result;
+	}
+
+	bool isReplay = !settings.ReplayFilepath.empty();
+	JobSystem::Initialize();
+
+	auto loadStart = std::chrono::steady_clock::now();
+	if (isReplay)
+	{
+		if (!LoadCapture(settings.ReplayFilepath))
+		{
+			Shutdown();
+			return 1;
+		}
+	}
+	else
+	{
+		InitializeRenderer(settings.Width, settings.Height);
+
+		for (const std::string& scene : settings.Scenes)
+		{
+			if (!LoadScene(scene))
+			{
+				Shutdown();
+				return 1;
+			}
+		}
+	}
+
+	// Frames are measured with all data resident, streaming is covered by the load time
+	HeadlessBackend& backend = static_cast<HeadlessBackend&>(Renderer::GetBackend());
+	backend.Flush();
+	s_Data.LoadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+	// A replay runs every captured frame once unless a frame count was given, warmup frames start at the beginning of the capture as well
+	uint32_t numCapturedFrames = isReplay ? s_Data.CaptureReader->GetNumFrames() : 0;
+	if (isReplay && !settings.HasFrameCount)
+		settings.NumFrames = numCapturedFrames;
+
+	UpdateScene();
+	CalculateSceneBounds();
+
+	glm::vec3 sceneCenter = (s_Data.SceneBB.Min + s_Data.SceneBB.Max) * 0.5f;
+	float sceneRadius = glm::length(s_Data.SceneBB.Max - s_Data.SceneBB.Min) * 0.5f;
+	GenerateLights(settings.NumLights, sceneRadius);
+
+	// Directional light, the renderer fits its shadow cascades to the scene camera every frame
+	s_Data.DirLight = DirectionalLightData(glm::normalize(glm::vec3(-0.2f, -1.0f, 0.3f)), glm::vec3(0.1f), glm::vec3(1.0f));
+
+	const float fov = 60.0f;
+	Camera sceneCamera(glm::identity<glm::mat4>(), fov, static_cast<float>(settings.Width) / settings.Height, 0.1f, 10000.0f);
+
+	// The scene stays static for the first frames, once the hysteresis of the shadow atlas settled it has to keep every tile
+	const uint32_t numStaticFrames = 60;
+	const uint32_t numSettleFrames = 30;
+	uint32_t numStaticAtlasChurnFrames = 0;
+
+	uint32_t numSceneFrames = settings.NumWarmupFrames + settings.NumFrames;
+	uint32_t numTotalFrames = numStaticFrames + numSceneFrames;
+	uint32_t firstMeasuredFrame = numStaticFrames + settings.NumWarmupFrames;
+
+	BenchFrameStatistics totalStats;
+	// Memory after the first measured frame, anything the measured frames add on top of it is growth
+	MemoryStatistics warmupMemoryStats;
+
+	std::vector<float> frameTimes, updateTimes, submitTimes, renderTimes;
+
+	for (uint32_t frame = 0; frame < numTotalFrames; ++frame)
+	{
+		// Static frames show the first frame of the scene or capture
+		uint32_t sceneFrame = frame < numStaticFrames ? 0 : frame - numStaticFrames;
+
+		if (frame == numStaticFrames && !settings.CaptureFilepath.empty())
+		{
+			Renderer::BeginCapture(settings.CaptureFilepath, numSceneFrames);
+			if (!Renderer::IsCapturing())
+			{
+				LOG_ERR("[Bench] Could not start a capture to {}", settings.CaptureFilepath);
+				Shutdown();
+				return 1;
+			}
+		}
+
+		if (frame == firstMeasuredFrame && !settings.TraceFilepath.empty())
+			Profiler::CaptureTrace(settings.TraceFilepath, settings.NumFrames);
+		if (frame == firstMeasuredFrame)
+			Profiler::SetStatisticsWindow(settings.NumFrames);
+
+		auto frameStart = std::chrono::steady_clock::now();
+		Renderer::BeginFrame();
+
+		uint64_t numGPUZones = backend.GetGPUProfiler().GetZones().size();
+
+		if (isReplay)
+		{
+			// Decoding the captured frame takes the place of the scene update
+			if (!s_Data.CaptureReader->ReadFrame(sceneFrame % numCapturedFrames, s_Data.Frame))
+			{
+				LOG_ERR("[Bench] Captured frame {} is corrupt", sceneFrame % numCapturedFrames);
+				Shutdown();
+				return 1;
+			}
+		}
+		else
+		{
+			// Scene update, the camera orbits the scene at varying distance so LOD selection and culling change every frame
+			UpdateScene();
+
+			float t = static_cast<float>(sceneFrame) / numSceneFrames;
+			float orbitAngle = t * glm::two_pi<float>();
+			float orbitDistance = sceneRadius * (0.15f + 0.85f * (0.5f + 0.5f * glm::cos(orbitAngle * 3.0f)));
+			glm::vec3 eye = sceneCenter + glm::vec3(glm::cos(orbitAngle) * orbitDistance, sceneRadius * 0.2f, glm::sin(orbitAngle) * orbitDistance);
+			sceneCamera.SetViewMatrix(glm::lookAtLH(eye, sceneCenter, glm::vec3(0.0f, 1.0f, 0.0f)));
+		}
+
+		auto submitStart = std::chrono::steady_clock::now();
+		if (isReplay)
+			SubmitCapturedFrame(s_Data.Frame);
+		else
+			SubmitScene(sceneCamera);
+
+		auto renderStart = std::chrono::steady_clock::now();
+		Renderer::Render();
+		auto renderEnd = std::chrono::steady_clock::now();
+
+		// The statistics are reset when the frame ends
+		RendererStatistics frameStats = g_RenderState.Stats;
+
+		Renderer::EndScene();
+		Renderer::EndFrame();
+		auto frameEnd = std::chrono::steady_clock::now();
+
+		Profiler::EndFrame();
+		MemoryTracker::EndFrame();
+
+		if (frame >= numSettleFrames && frame < numStaticFrames && GetShadowAtlasChurn(frameStats) > 0)
+			numStaticAtlasChurnFrames++;
+
+		if (frame == firstMeasuredFrame)
+			warmupMemoryStats = MemoryTracker::GetStatistics();
+		if (frame < firstMeasuredFrame)
+			continue;
+
+		frameTimes.push_back(std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+		updateTimes.push_back(std::chrono::duration<float, std::milli>(submitStart - frameStart).count());
+		submitTimes.push_back(std::chrono::duration<float, std::milli>(renderStart - submitStart).count());
+		renderTimes.push_back(std::chrono::duration<float, std::milli>(renderEnd - renderStart).count());
+
+		totalStats.Add(frameStats);
+		totalStats.NumGPUZones += numGPUZones;
+	}
+
+	const HeadlessBackendStatistics& backendStats = backend.GetStatistics();
+	float numFrames = static_cast<float>(settings.NumFrames);
+
+	// Measured frames replayed through the statistics engine, percentiles above are exact
+	RollingFrameStatistics measuredFrameStatistics(settings.NumFrames, Profiler::GetStutterFactor());
+	for (float frameTime : frameTimes)
+		measuredFrameStatistics.AddSample(frameTime);
+
+	FrameTimeStatistics frameStatistics = measuredFrameStatistics.GetStatistics();
+	uint64_t frameStutters = measuredFrameStatistics.GetNumTotalStutters();
+
+	// Replays report the resolution the frames were captured at
+	uint32_t width = isReplay ? s_Data.Frame.Settings.RenderWidth : settings.Width;
+	uint32_t height = isReplay ? s_Data.Frame.Settings.RenderHeight : settings.Height;
+
+	// Replays report the lights of the last captured frame that was submitted
+	std::size_t numSpotLights = s_Data.SpotLights.size();
+	std::size_t numPointLights = s_Data.PointLights.size();
+	if (isReplay)
+	{
+		numSpotLights = std::count_if(s_Data.Frame.Lights.begin(), s_Data.Frame.Lights.end(),
+			[](const CapturedLight& light) { return light.Type == CapturedLightType::CAPTURED_LIGHT_TYPE_SPOT; });
+		numPointLights = std::count_if(s_Data.Frame.Lights.begin(), s_Data.Frame.Lights.end(),
+			[](const CapturedLight& light) { return light.Type == CapturedLightType::CAPTURED_LIGHT_TYPE_POINT; });
+	}
+
+	if (isReplay)
+	{
+		LOG_INFO("[Bench] Loaded capture {} with {} frames in {} ms: {} meshes, {} MB of resources", settings.ReplayFilepath, numCapturedFrames,
+			s_Data.LoadTime, s_Data.Meshes.size(), TO_MEGABYTE(backendStats.ResourceByteSize));
+	}
+	else
+	{
+		LOG_INFO("[Bench] Loaded {} scenes in {} ms: {} meshes, {} instances, {} MB of resources", settings.Scenes.size(), s_Data.LoadTime,
+			s_Data.Meshes.size(), s_Data.Instances.size(), TO_MEGABYTE(backendStats.ResourceByteSize));
+	}
+
+	LOG_INFO("[Bench] {} frames at {}x{}, mesh LODs {}, {} light culling", settings.NumFrames, width, height, settings.EnableMeshLODs ? "on" : "off",
+		LightCullingModeToString(settings.LightCulling));
+	LOG_INFO("[Bench] Frame CPU time: avg {} ms, median {} ms, p95 {} ms, p99 {} ms, p99.9 {} ms, max {} ms, stddev {} ms, {} stutters over {}x the median",
+		Average(frameTimes), Percentile(frameTimes, 0.5f), Percentile(frameTimes, 0.95f), Percentile(frameTimes, 0.99f), Percentile(frameTimes, 0.999f),
+		Percentile(frameTimes, 1.0f), frameStatistics.StdDev, frameStutters, Profiler::GetStutterFactor());
+	LOG_INFO("[Bench] Average begin frame and update {} ms, submission {} ms, render {} ms", Average(updateTimes), Average(submitTimes), Average(renderTimes));
+	LOG_INFO("[Bench] Per frame: {} meshes, {} draws, {} LOD draws, {} triangles, {} shader variant switches", totalStats.NumMeshes / numFrames,
+		totalStats.NumDraws / numFrames, totalStats.NumLODDraws / numFrames, totalStats.NumTriangles / numFrames, totalStats.NumShaderVariantSwitches / numFrames);
+	LOG_INFO("[Bench] Lighting draws per frame: {} opaque, {} masked, {} transparent, {} depth pre-pass draws",
+		totalStats.NumLightingDraws[TransparencyMode::OPAQUE] / numFrames, totalStats.NumLightingDraws[TransparencyMode::MASKED] / numFrames,
+		totalStats.NumLightingDraws[TransparencyMode::TRANSPARENT] / numFrames, totalStats.NumDepthPrepassDraws / numFrames);
+	LOG_INFO("[Bench] Depth pass vertex streams: {} KB per frame, positions {}", TO_KILOBYTE(totalStats.NumDepthVertexBytes / numFrames),
+		settings.QuantizeMeshPositions ? "quantized" : "float");
+	LOG_INFO("[Bench] Lights: {} spot and {} pointlights, {} instance light assignments per frame", numSpotLights, numPointLights,
+		totalStats.NumInstanceLightAssignments / numFrames);
+	LOG_INFO("[Bench] Scene tables: {} bytes uploaded per frame", totalStats.NumSceneTableUploadBytes / numFrames);
+	LOG_INFO("[Bench] Shadow maps: {} per frame, {} reused their cached static casters, shadow cache {}", totalStats.NumShadowMaps / numFrames,
+		totalStats.NumCachedShadowMaps / numFrames, settings.EnableShadowCache ? "on" : "off");
+	LOG_INFO("[Bench] Shadow updates: {} views skipped and {} unshadowed per frame, draw budget {}, triangle budget {}", totalStats.NumSkippedShadowViews / numFrames,
+		totalStats.NumUnshadowedShadowViews / numFrames, settings.ShadowScheduler.DrawBudget, settings.ShadowScheduler.TriangleBudget);
+	LOG_INFO("[Bench] Shadow atlas: {}% occupied on average ({}% to {}%), per frame {} new, {} resized, {} deferred resizes and {} evicted lights",
+		totalStats.ShadowAtlasOccupancy / numFrames * 100.0, totalStats.MinShadowAtlasOccupancy * 100.0f, totalStats.MaxShadowAtlasOccupancy * 100.0f,
+		totalStats.NumNewShadowAtlasLights / numFrames, totalStats.NumResizedShadowAtlasLights / numFrames, totalStats.NumDeferredShadowAtlasResizes / numFrames,
+		totalStats.NumEvictedShadowAtlasLights / numFrames);
+	LOG_INFO("[Bench] Shadow atlas churn in {} of {} measured frames, and in {} of {} static frames after {} frames to settle",
+		totalStats.NumShadowAtlasChurnFrames, settings.NumFrames, numStaticAtlasChurnFrames, numStaticFrames - numSettleFrames, numSettleFrames);
+	LOG_INFO("[Bench] Shadow caster culling {}, {} casters culled per frame", settings.EnableShadowCasterCulling ? "on" : "off",
+		totalStats.NumCulledShadowCasters / numFrames);
+	LOG_INFO("[Bench] Executed {} command lists with {} commands, {} draws", backendStats.NumCommandListsExecuted, backendStats.NumCommandsExecuted,
+		backendStats.NumDrawsExecuted);
+
+	GPUProfilerStatistics gpuProfilerStats = backend.GetGPUProfiler().GetStatistics();
+	LOG_INFO("[Bench] GPU zones: {} resolved per frame, {} dropped, {} queries per frame", totalStats.NumGPUZones / numFrames,
+		gpuProfilerStats.NumDroppedZones, gpuProfilerStats.NumQueriesPerFrame);
+
+	MemoryStatistics memoryStats = MemoryTracker::GetStatistics();
+	int64_t cpuMemoryGrowth = static_cast<int64_t>(memoryStats.CPUByteSize) - static_cast<int64_t>(warmupMemoryStats.CPUByteSize);
+	int64_t gpuMemoryGrowth = static_cast<int64_t>(memoryStats.GPUByteSize) - static_cast<int64_t>(warmupMemoryStats.GPUByteSize);
+
+	std::string gpuCategories, cpuTags;
+	for (uint32_t category = 0; category < NUM_GPU_MEMORY_CATEGORIES; ++category)
+	{
+		if (memoryStats.GPUCategories[category].NumResources > 0)
+		{
+			gpuCategories += std::string(gpuCategories.empty() ? "" : ", ") + MemoryTracker::GetGPUCategoryName(static_cast<GPUMemoryCategory>(category)) + " " +
+				std::to_string(TO_MEGABYTE(static_cast<double>(memoryStats.GPUCategories[category].ByteSize))) + " MB";
+		}
+	}
+	for (uint32_t tag = 0; tag < NUM_MEMORY_TAGS; ++tag)
+	{
+		cpuTags += std::string(tag == 0 ? "" : ", ") + MemoryTracker::GetTagName(static_cast<MemoryTag>(tag)) + " " +
+			std::to_string(TO_MEGABYTE(static_cast<double>(memoryStats.Tags[tag].ByteSize))) + " MB";
+	}
+
+	LOG_INFO("[Bench] GPU memory: {} MB ({}), {} bytes grown over the measured frames", TO_MEGABYTE(static_cast<double>(memoryStats.GPUByteSize)), gpuCategories,
+		gpuMemoryGrowth);
+	LOG_INFO("[Bench] Tracked CPU memory: {} MB ({}), {} bytes grown over the measured frames", TO_MEGABYTE(static_cast<double>(memoryStats.CPUByteSize)), cpuTags,
+		cpuMemoryGrowth);
+
+	std::vector<GPUMemoryResource> largestResources;
+	MemoryTracker::GetLargestGPUResources(5, largestResources);
+	for (const GPUMemoryResource& resource : largestResources)
+	{
+		LOG_INFO("[Bench]     {} ({}): {} KB", resource.Name, MemoryTracker::GetGPUCategoryName(resource.Category), TO_KILOBYTE(resource.ByteSize));
+	}
+
+	if (!settings.StatisticsFilepath.empty() && !Profiler::WriteStatisticsReport(settings.StatisticsFilepath))
+	{
+		Shutdown();
+		return 1;
+	}
+
+	// Flat JSON object, easy to pick up by CI scripts that track regressions
+	if (!settings.OutputFilepath.empty())
+	{
+		std::ofstream output(settings.OutputFilepath);
+		output << "{\n";
+		output << "\t\"frames\": " << settings.NumFrames << ",\n";
+		output << "\t\"replay\": " << (isReplay ? "true" : "false") << ",\n";
+		output << "\t\"width\": " << width << ",\n";
+		output << "\t\"height\": " << height << ",\n";
+		output << "\t\"mesh_lods\": " << (settings.EnableMeshLODs ? "true" : "false") << ",\n";
+		output << "\t\"light_culling\": \"" << LightCullingModeToString(settings.LightCulling) << "\",\n";
+		output << "\t\"load_ms\": " << s_Data.LoadTime << ",\n";
+		output << "\t\"frame_avg_ms\": " << Average(frameTimes) << ",\n";
+		output << "\t\"frame_median_ms\": " << Percentile(frameTimes, 0.5f) << ",\n";
+		output << "\t\"frame_p95_ms\": " << Percentile(frameTimes, 0.95f) << ",\n";
+		output << "\t\"frame_p99_ms\": " << Percentile(frameTimes, 0.99f) << ",\n";
+		output << "\t\"frame_p999_ms\": " << Percentile(frameTimes, 0.999f) << ",\n";
+		output << "\t\"frame_max_ms\": " << Percentile(frameTimes, 1.0f) << ",\n";
+		output << "\t\"frame_stddev_ms\": " << frameStatistics.StdDev << ",\n";
+		output << "\t\"frame_stutters\": " << frameStutters << ",\n";
+		output << "\t\"update_avg_ms\": " << Average(updateTimes) << ",\n";
+		output << "\t\"submit_avg_ms\": " << Average(submitTimes) << ",\n";
+		output << "\t\"render_avg_ms\": " << Average(renderTimes) << ",\n";
+		output << "\t\"meshes_per_frame\": " << totalStats.NumMeshes / numFrames << ",\n";
+		output << "\t\"draws_per_frame\": " << totalStats.NumDraws / numFrames << ",\n";
+		output << "\t\"lod_draws_per_frame\": " << totalStats.NumLODDraws / numFrames << ",\n";
+		output << "\t\"triangles_per_frame\": " << totalStats.NumTriangles / numFrames << ",\n";
+		output << "\t\"shader_variant_switches_per_frame\": " << totalStats.NumShaderVariantSwitches / numFrames << ",\n";
+		output << "\t\"lighting_draws_opaque_per_frame\": " << totalStats.NumLightingDraws[TransparencyMode::OPAQUE] / numFrames << ",\n";
+		output << "\t\"lighting_draws_masked_per_frame\": " << totalStats.NumLightingDraws[TransparencyMode::MASKED] / numFrames << ",\n";
+		output << "\t\"lighting_draws_transparent_per_frame\": " << totalStats.NumLightingDraws[TransparencyMode::TRANSPARENT] / numFrames << ",\n";
+		output << "\t\"depth_prepass_draws_per_frame\": " << totalStats.NumDepthPrepassDraws / numFrames << ",\n";
+		output << "\t\"depth_vertex_bytes_per_frame\": " << totalStats.NumDepthVertexBytes / numFrames << ",\n";
+		output << "\t\"spot_lights\": " << numSpotLights << ",\n";
+		output << "\t\"point_lights\": " << numPointLights << ",\n";
+		output << "\t\"instance_light_assignments_per_frame\": " << totalStats.NumInstanceLightAssignments / numFrames << ",\n";
+		output << "\t\"scene_table_upload_bytes_per_frame\": " << totalStats.NumSceneTableUploadBytes / numFrames << ",\n";
+		output << "\t\"gpu_zones_per_frame\": " << totalStats.NumGPUZones / numFrames << ",\n";
+		output << "\t\"gpu_dropped_zones\": " << gpuProfilerStats.NumDroppedZones << ",\n";
+		output << "\t\"shadow_cache\": " << (settings.EnableShadowCache ? "true" : "false") << ",\n";
+		output << "\t\"shadow_maps_per_frame\": " << totalStats.NumShadowMaps / numFrames << ",\n";
+		output << "\t\"cached_shadow_maps_per_frame\": " << totalStats.NumCachedShadowMaps / numFrames << ",\n";
+		output << "\t\"shadow_caster_culling\": " << (settings.EnableShadowCasterCulling ? "true" : "false") << ",\n";
+		output << "\t\"culled_shadow_casters_per_frame\": " << totalStats.NumCulledShadowCasters / numFrames << ",\n";
+		output << "\t\"shadow_draw_budget\": " << settings.ShadowScheduler.DrawBudget << ",\n";
+		output << "\t\"shadow_triangle_budget\": " << settings.ShadowScheduler.TriangleBudget << ",\n";
+		output << "\t\"skipped_shadow_views_per_frame\": " << totalStats.NumSkippedShadowViews / numFrames << ",\n";
+		output << "\t\"unshadowed_shadow_views_per_frame\": " << totalStats.NumUnshadowedShadowViews / numFrames << ",\n";
+		output << "\t\"shadow_atlas_occupancy\": " << totalStats.ShadowAtlasOccupancy / numFrames << ",\n";
+		output << "\t\"shadow_atlas_min_occupancy\": " << totalStats.MinShadowAtlasOccupancy << ",\n";
+		output << "\t\"shadow_atlas_max_occupancy\": " << totalStats.MaxShadowAtlasOccupancy << ",\n";
+		output << "\t\"shadow_atlas_new_lights_per_frame\": " << totalStats.NumNewShadowAtlasLights / numFrames << ",\n";
+		output << "\t\"shadow_atlas_resized_lights_per_frame\": " << totalStats.NumResizedShadowAtlasLights / numFrames << ",\n";
+		output << "\t\"shadow_atlas_deferred_resizes_per_frame\": " << totalStats.NumDeferredShadowAtlasResizes / numFrames << ",\n";
+		output << "\t\"shadow_atlas_evicted_lights_per_frame\": " << totalStats.NumEvictedShadowAtlasLights / numFrames << ",\n";
+		output << "\t\"shadow_atlas_churn_frames\": " << totalStats.NumShadowAtlasChurnFrames << ",\n";
+		output << "\t\"shadow_atlas_static_churn_frames\": " << numStaticAtlasChurnFrames << ",\n";
+		output << "\t\"gpu_memory_bytes\": " << memoryStats.GPUByteSize << ",\n";
+		output << "\t\"gpu_memory_growth_bytes\": " << gpuMemoryGrowth << ",\n";
+		output << "\t\"cpu_memory_bytes\": " << memoryStats.CPUByteSize << ",\n";
+		output << "\t\"cpu_memory_growth_bytes\": " << cpuMemoryGrowth << "\n";
+		output << "}\n";
+
+		if (!output)
+		{
+			LOG_ERR("[Bench] Could not write results to {}", settings.OutputFilepath);
+			Shutdown();
+			return 1;
+		}
+	}
+
+	Shutdown();
+
+	// Tiles that keep changing while nothing moves mean the atlas policy oscillates, every change renders the shadow maps of a light again
+	if (numStaticAtlasChurnFrames > 0)
+	{
+		LOG_ERR("[Bench] The shadow atlas changed tiles in {} frames of a static scene", numStaticAtlasChurnFrames);
+		return 1;
+	}
+
+	return 0;
+}
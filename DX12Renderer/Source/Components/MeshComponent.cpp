@@ -25,7 +25,7 @@ void MeshComponent::Update(float deltaTime)
 void MeshComponent::Render()
 {
 	const Transform& objectTransform = Scene::GetSceneObject(m_ObjectID).GetComponent<TransformComponent>().GetTransform();
-	Renderer::Submit(m_Mesh, objectTransform.GetTransformMatrix(), m_PrevFrameTransform);
+	Renderer::Submit(m_Mesh, objectTransform.GetTransformMatrix(), m_PrevFrameTransform, m_ObjectID);
 
 	m_PrevFrameTransform = objectTransform.GetTransformMatrix();
 }
@@ -2,7 +2,6 @@
 #include "Components/PointLightComponent.h"
 #include "Graphics/Renderer.h"
 #include "Graphics/RenderAPI.h"
-#include "Graphics/Texture.h"
 #include "Scene/Scene.h"
 #include "Scene/SceneObject.h"
 #include "Components/TransformComponent.h"
@@ -32,19 +31,6 @@ PointLightComponent::PointLightComponent(const PointLightData& pointLightData)
 		// This will construct a camera with a reverse-z perspective projection and an infinite far plane
 		m_Cameras[i] = Camera(lightViewFace, 90.0f, 1.0f, m_PointLightData.Range, 0.1f);
 	}
-
-	const Resolution& shadowRes = Renderer::GetShadowResolution();
-
-	// Create shadow map
-	TextureDesc shadowMapDesc = {};
-	shadowMapDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
-	shadowMapDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-	shadowMapDesc.Dimension = TextureDimension::TEXTURE_DIMENSION_CUBE;
-	shadowMapDesc.Width = shadowRes.x;
-	shadowMapDesc.Height = shadowRes.y;
-	shadowMapDesc.DebugName = "Pointlight shadow map";
-
-	m_ShadowMap = Renderer::CreateTexture(shadowMapDesc);
 }
 
 PointLightComponent::~PointLightComponent()
@@ -66,7 +52,7 @@ void PointLightComponent::Update(float deltaTime)
 
 void PointLightComponent::Render()
 {
-	Renderer::Submit(m_PointLightData, m_Cameras, m_ShadowMap);
+	Renderer::Submit(m_PointLightData, m_Cameras, m_ObjectID);
 }
 
 void PointLightComponent::OnImGuiRender()
@@ -3,7 +3,6 @@
 #include "Graphics/Renderer.h"
 #include "Graphics/RenderAPI.h"
 #include "Graphics/DebugRenderer.h"
-#include "Graphics/Texture.h"
 #include "Scene/Scene.h"
 #include "Scene/SceneObject.h"
 #include "Components/TransformComponent.h"
@@ -19,18 +18,6 @@ SpotLightComponent::SpotLightComponent(const SpotLightData& spotLightData)
 	// This will construct a camera with a reverse-z perspective projection and an infinite far plane
 	m_Camera = Camera(lightView, glm::degrees(m_SpotLightData.OuterConeAngle), 1.0f, m_SpotLightData.Range, 0.1f);
 
-	const Resolution& shadowRes = Renderer::GetShadowResolution();
-
-	// Create shadow map
-	TextureDesc shadowMapDesc = {};
-	shadowMapDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
-	shadowMapDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-	shadowMapDesc.Width = shadowRes.x;
-	shadowMapDesc.Height = shadowRes.y;
-	shadowMapDesc.DebugName = "Spotlight shadow map";
-
-	m_ShadowMap = Renderer::CreateTexture(shadowMapDesc);
-
 	m_SpotLightData.ViewProjection = m_Camera.GetViewProjection();
 
 	m_GUIData.InnerConeAngle = glm::degrees(m_SpotLightData.InnerConeAngle);
@@ -55,7 +42,7 @@ void SpotLightComponent::Update(float deltaTime)
 
 void SpotLightComponent::Render()
 {
-	Renderer::Submit(m_SpotLightData, m_Camera, m_ShadowMap);
+	Renderer::Submit(m_SpotLightData, m_Camera, m_ObjectID);
 }
 
 void SpotLightComponent::OnImGuiRender()
@@ -4,11 +4,12 @@
 #include "Graphics/RasterPass.h"
 #include "Graphics/Backend/DescriptorHeap.h"
 #include "Graphics/Backend/UploadBuffer.h"
+#include "Graphics/Backend/GPUProfiler.h"
 
 CommandList::CommandList(D3D12_COMMAND_LIST_TYPE type)
 	: m_d3d12CommandListType(type)
 {
-	auto d3d12Device = RenderBackend::GetD3D12Device();
+	auto d3d12Device = D3D12Backend::GetD3D12Device();
 	DX_CALL(d3d12Device->CreateCommandAllocator(m_d3d12CommandListType, IID_PPV_ARGS(&m_d3d12CommandAllocator)));
 	DX_CALL(d3d12Device->CreateCommandList(0, m_d3d12CommandListType, m_d3d12CommandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_d3d12CommandList)));
 	
@@ -38,6 +39,11 @@ void CommandList::ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsv, float d
 	m_d3d12CommandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, depth, 0, 0, nullptr);
 }
 
+void CommandList::ClearDepthStencilView(D3D12_CPU_DESCRIPTOR_HANDLE dsv, float depth, uint32_t numRects, const D3D12_RECT* rects)
+{
+	m_d3d12CommandList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, depth, 0, numRects, rects);
+}
+
 void CommandList::SetViewports(uint32_t numViewports, D3D12_VIEWPORT* viewports)
 {
 	m_d3d12CommandList->RSSetViewports(numViewports, viewports);
@@ -55,7 +61,8 @@ void CommandList::SetRenderTargets(uint32_t numRTVS, D3D12_CPU_DESCRIPTOR_HANDLE
 
 void CommandList::SetRenderPassBindables(const RasterPass& renderPass)
 {
-	// Set the pipeline state
+	// Set the pipeline state, callers skip passes whose pipeline state is still being created
+	ASSERT(renderPass.IsReady(), "Render pass is bound before its pipeline state was created");
 	m_d3d12CommandList->SetPipelineState(renderPass.GetD3D12PipelineState());
 
 	// Set the root signature
@@ -70,6 +77,11 @@ void CommandList::SetRenderPassBindables(const RasterPass& renderPass)
 	m_d3d12CommandList->IASetPrimitiveTopology(renderPass.GetDesc().Topology);
 }
 
+void CommandList::SetPipelineState(const RasterPass& renderPass, uint32_t variant)
+{
+	m_d3d12CommandList->SetPipelineState(renderPass.GetD3D12PipelineState(variant));
+}
+
 void CommandList::SetRootConstants(uint32_t rootIndex, uint32_t numValues, const void* data, uint32_t offset)
 {
 	m_d3d12CommandList->SetGraphicsRoot32BitConstants(rootIndex, numValues, data, offset);
@@ -130,6 +142,12 @@ void CommandList::SetRootConstantBufferView(uint32_t rootParameterIndex, Buffer&
 	TrackObject(buffer.GetD3D12Resource());
 }
 
+void CommandList::SetRootConstantBufferView(uint32_t rootParameterIndex, Buffer& buffer, std::size_t byteOffset, D3D12_RESOURCE_STATES stateAfter)
+{
+	m_d3d12CommandList->SetGraphicsRootConstantBufferView(rootParameterIndex, buffer.GetD3D12Resource()->GetGPUVirtualAddress() + byteOffset);
+	TrackObject(buffer.GetD3D12Resource());
+}
+
 void CommandList::SetRootShaderResourceView(uint32_t rootParameterIndex, Texture& texture, D3D12_RESOURCE_STATES stateAfter)
 {
 	//auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(texture.GetD3D12Resource().Get(), D3D12_RESOURCE_STATE_COMMON, stateAfter, 0);
@@ -139,28 +157,36 @@ void CommandList::SetRootShaderResourceView(uint32_t rootParameterIndex, Texture
 	TrackObject(texture.GetD3D12Resource());
 }
 
-void CommandList::BeginTimestampQuery(const std::string& name)
+void CommandList::SetRootShaderResourceView(uint32_t rootParameterIndex, Buffer& buffer, D3D12_RESOURCE_STATES stateAfter)
 {
-	uint32_t queryIndex = RenderBackend::GetNextQueryIndex(m_BackBufferIndex);
-	m_d3d12CommandList->EndQuery(RenderBackend::GetD3D12TimestampQueryHeap(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
-
-	auto query = m_TimestampQueries.find(name);
-	if (query == m_TimestampQueries.end())
-		query = m_TimestampQueries.insert(std::pair<std::string, TimestampQuery>(name, TimestampQuery())).first;
+	m_d3d12CommandList->SetGraphicsRootShaderResourceView(rootParameterIndex, buffer.GetD3D12Resource()->GetGPUVirtualAddress());
+	TrackObject(buffer.GetD3D12Resource());
+}
 
-	query->second.StartIndex = queryIndex;
-	query->second.NumQueries++;
+void CommandList::SetRootShaderResourceView(uint32_t rootParameterIndex, Buffer& buffer, std::size_t byteOffset, D3D12_RESOURCE_STATES stateAfter)
+{
+	m_d3d12CommandList->SetGraphicsRootShaderResourceView(rootParameterIndex, buffer.GetD3D12Resource()->GetGPUVirtualAddress() + byteOffset);
+	TrackObject(buffer.GetD3D12Resource());
 }
 
-void CommandList::EndTimestampQuery(const std::string& name)
+void CommandList::BeginGPUZone(uint32_t zoneID)
 {
-	uint32_t queryIndex = RenderBackend::GetNextQueryIndex(m_BackBufferIndex);
-	m_d3d12CommandList->EndQuery(RenderBackend::GetD3D12TimestampQueryHeap(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+	uint32_t queryIndex = D3D12Backend::GetGPUProfiler().BeginZone(zoneID);
+	if (queryIndex == GPU_PROFILER_INVALID_QUERY)
+		return;
+
+	m_d3d12CommandList->EndQuery(D3D12Backend::GetD3D12TimestampQueryHeap(m_BackBufferIndex), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+	m_TimestampQueries.push_back(queryIndex);
+}
 
-	auto query = m_TimestampQueries.find(name);
-	ASSERT(query != m_TimestampQueries.end(), "A timestamp query was ended that has not been started");
+void CommandList::EndGPUZone()
+{
+	uint32_t queryIndex = D3D12Backend::GetGPUProfiler().EndZone();
+	if (queryIndex == GPU_PROFILER_INVALID_QUERY)
+		return;
 
-	query->second.NumQueries++;
+	m_d3d12CommandList->EndQuery(D3D12Backend::GetD3D12TimestampQueryHeap(m_BackBufferIndex), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex);
+	m_TimestampQueries.push_back(queryIndex);
 }
 
 void CommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
@@ -230,7 +256,7 @@ void CommandList::CopyTexture(const UploadBufferAllocation& uploadBuffer, Textur
 
 		D3D12_SUBRESOURCE_DATA subresourceData = {};
 		subresourceData.pData = textureData;
-		subresourceData.RowPitch = static_cast<std::size_t>(textureDesc.Width * 4);
+		subresourceData.RowPitch = static_cast<std::size_t>(textureDesc.Width) * GetTextureFormatByteSize(textureDesc.Format);
 		subresourceData.SlicePitch = subresourceData.RowPitch * textureDesc.Height;
 
 		UpdateSubresources(m_d3d12CommandList.Get(), destTexture.GetD3D12Resource().Get(),
@@ -240,6 +266,33 @@ void CommandList::CopyTexture(const UploadBufferAllocation& uploadBuffer, Textur
 	}
 }
 
+void CommandList::CopyTextureRegion(const UploadBufferAllocation& uploadBuffer, Texture& destTexture, uint32_t firstRow, uint32_t numRows, std::size_t rowPitch)
+{
+	const TextureDesc& textureDesc = destTexture.GetTextureDesc();
+	ASSERT(firstRow + numRows <= textureDesc.Height, "Texture region exceeds the destination texture height");
+
+	Transition(destTexture, D3D12_RESOURCE_STATE_COPY_DEST);
+
+	// The rows in the upload buffer are laid out as a placed footprint, only covering the rows of this region
+	D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+	srcLocation.pResource = uploadBuffer.D3D12Resource;
+	srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	srcLocation.PlacedFootprint.Offset = uploadBuffer.OffsetInBuffer;
+	srcLocation.PlacedFootprint.Footprint.Format = TextureFormatToDXGIFormat(textureDesc.Format);
+	srcLocation.PlacedFootprint.Footprint.Width = textureDesc.Width;
+	srcLocation.PlacedFootprint.Footprint.Height = numRows;
+	srcLocation.PlacedFootprint.Footprint.Depth = 1;
+	srcLocation.PlacedFootprint.Footprint.RowPitch = static_cast<UINT>(rowPitch);
+
+	D3D12_TEXTURE_COPY_LOCATION destLocation = {};
+	destLocation.pResource = destTexture.GetD3D12Resource().Get();
+	destLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	destLocation.SubresourceIndex = 0;
+
+	m_d3d12CommandList->CopyTextureRegion(&destLocation, 0, firstRow, 0, &srcLocation, nullptr);
+	TrackObject(destTexture.GetD3D12Resource());
+}
+
 void CommandList::GenerateMips(Texture& texture)
 {
 	auto srcResource = texture.GetD3D12Resource();
@@ -258,7 +311,7 @@ void CommandList::GenerateMips(Texture& texture)
 		return;
 	}
 	
-	ID3D12Device2* d3d12Device = RenderBackend::GetD3D12Device();
+	ID3D12Device2* d3d12Device = D3D12Backend::GetD3D12Device();
 	ComPtr<ID3D12Resource> uavResource = srcResource;
 	ComPtr<ID3D12Resource> aliasResource;
 
@@ -326,11 +379,11 @@ void CommandList::GenerateMips(Texture& texture)
 		glm::vec2 TexelSize;   // 1.0 / OutMip0.Dimensions
 	} mipGenCB;
 
-	DescriptorAllocation srvDescriptors = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1);
-	DescriptorAllocation uavDescriptors = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srcResourceDesc.MipLevels);
+	DescriptorAllocation srvDescriptors = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1);
+	DescriptorAllocation uavDescriptors = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, srcResourceDesc.MipLevels);
 
-	m_d3d12CommandList->SetPipelineState(RenderBackend::GetMipGenPSO());
-	ID3D12RootSignature* d3d12RootSignature = RenderBackend::GetMipGenRootSig();
+	m_d3d12CommandList->SetPipelineState(D3D12Backend::GetMipGenPSO());
+	ID3D12RootSignature* d3d12RootSignature = D3D12Backend::GetMipGenRootSig();
 	if (m_RootSignature != d3d12RootSignature)
 	{
 		m_RootSignature = d3d12RootSignature;
@@ -389,9 +442,9 @@ void CommandList::GenerateMips(Texture& texture)
 
 		m_d3d12CommandList->SetComputeRoot32BitConstants(0, 8, &mipGenCB, 0);
 
-		SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-		m_d3d12CommandList->SetComputeRootDescriptorTable(1, RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetGPUBaseDescriptor());
-		m_d3d12CommandList->SetComputeRootDescriptorTable(2, RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetGPUBaseDescriptor());
+		SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
+		m_d3d12CommandList->SetComputeRootDescriptorTable(1, D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetGPUBaseDescriptor());
+		m_d3d12CommandList->SetComputeRootDescriptorTable(2, D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetGPUBaseDescriptor());
 
 		m_d3d12CommandList->Dispatch(MathHelper::DivideUp(destWidth, 8u), MathHelper::DivideUp(destHeight, 8u), 1);
 		
@@ -473,12 +526,22 @@ void CommandList::Reset()
 
 void CommandList::ResolveTimestampQueries()
 {
-	for (auto& [name, query] : m_TimestampQueries)
+	// Only queries this list wrote may be resolved by it, consecutive ones are resolved together
+	std::sort(m_TimestampQueries.begin(), m_TimestampQueries.end());
+
+	std::size_t first = 0;
+	while (first < m_TimestampQueries.size())
 	{
-		std::size_t byteOffset = static_cast<std::size_t>(query.StartIndex * 8);
-		m_d3d12CommandList->ResolveQueryData(RenderBackend::GetD3D12TimestampQueryHeap(), D3D12_QUERY_TYPE_TIMESTAMP,
-			query.StartIndex, query.NumQueries, RenderBackend::GetQueryReadbackBuffer(m_BackBufferIndex).GetD3D12Resource().Get(), MathHelper::AlignUp(byteOffset, 8));
-		RenderBackend::TrackTimestampQueryResult(name, query, m_BackBufferIndex);
+		std::size_t last = first;
+		while (last + 1 < m_TimestampQueries.size() && m_TimestampQueries[last + 1] == m_TimestampQueries[last] + 1)
+			last++;
+
+		uint32_t startIndex = m_TimestampQueries[first];
+		uint32_t numQueries = static_cast<uint32_t>(last - first + 1);
+		m_d3d12CommandList->ResolveQueryData(D3D12Backend::GetD3D12TimestampQueryHeap(m_BackBufferIndex), D3D12_QUERY_TYPE_TIMESTAMP,
+			startIndex, numQueries, D3D12Backend::GetQueryReadbackBuffer(m_BackBufferIndex).GetD3D12Resource().Get(), startIndex * sizeof(uint64_t));
+
+		first = last + 1;
 	}
 
 	m_TimestampQueries.clear();
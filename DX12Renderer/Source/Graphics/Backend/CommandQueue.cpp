@@ -1,7 +1,7 @@
 #include "Pch.h"
 #include "Graphics/Backend/CommandQueue.h"
 #include "Graphics/Backend/CommandList.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 #include "Graphics/Backend/SwapChain.h"
 
 CommandQueue::CommandQueue(D3D12_COMMAND_LIST_TYPE type, D3D12_COMMAND_QUEUE_PRIORITY priority)
@@ -13,7 +13,7 @@ CommandQueue::CommandQueue(D3D12_COMMAND_LIST_TYPE type, D3D12_COMMAND_QUEUE_PRI
     queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
     queueDesc.NodeMask = 0;
 
-    auto d3d12Device = RenderBackend::GetD3D12Device();
+    auto d3d12Device = D3D12Backend::GetD3D12Device();
 
     DX_CALL(d3d12Device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_d3d12CommandQueue)));
     DX_CALL(d3d12Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_d3d12Fence)));
@@ -26,17 +26,14 @@ CommandQueue::~CommandQueue()
 
 std::shared_ptr<CommandList> CommandQueue::GetCommandList()
 {
+    // Single pop attempt, since command lists can be requested from multiple threads (e.g. the upload queue worker)
     std::shared_ptr<CommandList> commandList;
-    if (!m_AvailableCommandLists.Empty())
-    {
-        m_AvailableCommandLists.TryPop(commandList);
-    }
-    else
+    if (!m_AvailableCommandLists.TryPop(commandList))
     {
         commandList = std::make_shared<CommandList>(m_d3d12CommandListType);
     }
 
-    commandList->SetBackBufferAssociation(RenderBackend::GetSwapChain().GetCurrentBackBufferIndex());
+    commandList->SetBackBufferAssociation(D3D12Backend::GetSwapChain().GetCurrentBackBufferIndex());
     return commandList;
 }
 
@@ -45,14 +42,23 @@ uint64_t CommandQueue::ExecuteCommandList(std::shared_ptr<CommandList> commandLi
     commandList->Close();
 
     ID3D12CommandList* const ppCommandLists[] = { commandList->GetGraphicsCommandList().Get() };
+
+    // In flight command lists are pushed under the same lock, so they are reset in the order of their fence values
+    std::scoped_lock<std::mutex> lock(m_SubmitMutex);
     m_d3d12CommandQueue->ExecuteCommandLists(1, ppCommandLists);
-    uint64_t fenceValue = Signal();
+    uint64_t fenceValue = SignalUnlocked();
 
     m_InFlightCommandLists.Push({ commandList, fenceValue });
     return fenceValue;
 }
 
 uint64_t CommandQueue::Signal()
+{
+    std::scoped_lock<std::mutex> lock(m_SubmitMutex);
+    return SignalUnlocked();
+}
+
+uint64_t CommandQueue::SignalUnlocked()
 {
     uint64_t fenceValue = ++m_FenceValue;
     m_d3d12CommandQueue->Signal(m_d3d12Fence.Get(), fenceValue);
@@ -62,12 +68,17 @@ uint64_t CommandQueue::Signal()
 
 bool CommandQueue::IsFenceComplete() const
 {
-    return m_d3d12Fence->GetCompletedValue() >= m_FenceValue;
+    return m_d3d12Fence->GetCompletedValue() >= m_FenceValue.load();
+}
+
+uint64_t CommandQueue::GetCompletedFenceValue() const
+{
+    return m_d3d12Fence->GetCompletedValue();
 }
 
 void CommandQueue::WaitForFenceValue(uint64_t fenceValue) const
 {
-    if (!IsFenceComplete())
+    if (m_d3d12Fence->GetCompletedValue() < fenceValue)
     {
         HANDLE fenceEvent = ::CreateEvent(NULL, FALSE, FALSE, NULL);
         ASSERT(fenceEvent, "Failed to creat efence event handle");
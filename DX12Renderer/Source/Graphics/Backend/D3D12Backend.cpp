@@ -0,0 +1,1020 @@
+#include "Pch.h"
+#include "Graphics/Backend/D3D12Backend.h"
+#include "Graphics/Backend/SwapChain.h"
+#include "Graphics/Backend/DescriptorHeap.h"
+#include "Graphics/Backend/CommandQueue.h"
+#include "Graphics/Backend/CommandList.h"
+#include "Graphics/Backend/UploadBuffer.h"
+#include "Graphics/Backend/GPUProfiler.h"
+#include "Graphics/Backend/PipelineStateCache.h"
+#include "Graphics/Shader.h"
+#include "Graphics/RenderState.h"
+
+#include <imgui/imgui.h>
+
+#include <fstream>
+#include <filesystem>
+
+// Driver compiled pipeline states of earlier runs, written on shutdown when new pipeline states were created
+static constexpr const char* PIPELINE_LIBRARY_FILEPATH = "Cache/PipelineLibrary.bin";
+
+class D3D12GPUProfilerQuerySource;
+
+struct InternalD3D12BackendData
+{
+	ComPtr<IDXGIAdapter4> DXGIAdapter4;
+	ComPtr<ID3D12Device2> D3D12Device2;
+
+	DXGI_QUERY_VIDEO_MEMORY_INFO DXGIQueryVideoMemoryInfo;
+
+	std::unique_ptr<SwapChain> SwapChain;
+	std::unique_ptr<DescriptorHeap> DescriptorHeaps[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
+
+	std::unique_ptr<GPUProfiler> GPUProfiler;
+	// Owned by the GPU profiler
+	D3D12GPUProfilerQuerySource* GPUQuerySource = nullptr;
+
+	std::shared_ptr<CommandQueue> CommandQueueDirect;
+	std::unique_ptr<CommandQueue> CommandQueueCompute;
+	std::unique_ptr<CommandQueue> CommandQueueCopy;
+
+	std::unique_ptr<UploadBuffer> UploadBuffer;
+	std::unique_ptr<UploadQueue> UploadQueue;
+
+	std::unique_ptr<PipelineStateCache> PipelineStateCache;
+	// nullptr when the device does not support pipeline libraries, pipeline states are then created without one
+	ComPtr<ID3D12PipelineLibrary> PipelineLibrary;
+	// The library reads from the blob it was created from, so the blob has to outlive it
+	std::vector<uint8_t> PipelineLibraryBlob;
+	std::atomic<uint32_t> NumPipelineLibraryHits = 0;
+	std::atomic<uint32_t> NumPipelineLibraryStores = 0;
+
+	uint32_t MipMapGenPipelineStateID = PIPELINE_STATE_CACHE_INVALID_ID;
+	ComPtr<ID3D12RootSignature> MipMapGenRootSig;
+	std::unique_ptr<Shader> MipMapGenShader;
+
+	std::thread ProcessInFlightCommandListsThread;
+	std::atomic_bool ProcessInFlightCommandLists;
+
+	uint32_t CurrentBackBufferIndex = 0;
+
+	bool VSync = true;
+};
+
+static InternalD3D12BackendData s_Data;
+
+/*
+
+	Records the upload queue batches on the copy queue, staging memory is a persistently mapped upload heap buffer.
+	Textures are copied with placed footprints so a texture can be split into multiple row ranges.
+
+*/
+class D3D12UploadQueueBackend : public UploadQueueBackend
+{
+public:
+	D3D12UploadQueueBackend(std::size_t stagingByteSize)
+		: m_StagingByteSize(stagingByteSize)
+	{
+		CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(m_StagingByteSize);
+		D3D12Backend::CreateBuffer(m_d3d12StagingResource, D3D12_HEAP_TYPE_UPLOAD, desc, D3D12_RESOURCE_STATE_GENERIC_READ);
+		m_d3d12StagingResource->SetName(L"Upload queue staging buffer");
+		m_MemoryTrackerID = MemoryTracker::AddGPUResource("Upload queue staging buffer", GPU_MEMORY_CATEGORY_UPLOAD, m_StagingByteSize);
+
+		m_d3d12StagingResource->Map(0, nullptr, reinterpret_cast<void**>(&m_StagingPtr));
+	}
+
+	virtual ~D3D12UploadQueueBackend()
+	{
+		m_d3d12StagingResource->Unmap(0, nullptr);
+		MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
+	}
+
+	virtual uint8_t* GetStagingMemory() { return m_StagingPtr; }
+	virtual std::size_t GetStagingByteSize() const { return m_StagingByteSize; }
+	virtual std::size_t GetTextureRowPitchAlignment() const { return D3D12_TEXTURE_DATA_PITCH_ALIGNMENT; }
+	virtual std::size_t GetTextureSliceAlignment() const { return D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT; }
+
+	virtual void BeginBatch()
+	{
+		m_CommandList = s_Data.CommandQueueCopy->GetCommandList();
+	}
+
+	virtual void RecordCopy(const UploadRequest& request, const UploadSlice& slice)
+	{
+		UploadBufferAllocation upload = {};
+		upload.D3D12Resource = m_d3d12StagingResource.Get();
+		upload.OffsetInBuffer = slice.StagingOffset;
+
+		if (request.Type == UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER)
+		{
+			upload.Size = slice.NumBytes;
+			m_CommandList->CopyBufferRegion(upload, *static_cast<Buffer*>(request.Destination), slice.ByteOffset, slice.NumBytes);
+		}
+		else
+		{
+			upload.Size = slice.NumRows * slice.StagingRowPitch;
+			m_CommandList->CopyTextureRegion(upload, *static_cast<Texture*>(request.Destination), slice.FirstRow, slice.NumRows, slice.StagingRowPitch);
+		}
+	}
+
+	virtual uint64_t SubmitBatch()
+	{
+		uint64_t fenceValue = s_Data.CommandQueueCopy->ExecuteCommandList(m_CommandList);
+		m_CommandList.reset();
+
+		return fenceValue;
+	}
+
+	virtual uint64_t GetCompletedFenceValue() const { return s_Data.CommandQueueCopy->GetCompletedFenceValue(); }
+	virtual void WaitForFenceValue(uint64_t fenceValue) { s_Data.CommandQueueCopy->WaitForFenceValue(fenceValue); }
+
+	virtual void OnUploadComplete(UploadRequestType type, void* destination)
+	{
+		if (type == UploadRequestType::UPLOAD_REQUEST_TYPE_TEXTURE)
+		{
+			Texture* texture = static_cast<Texture*>(destination);
+			if (texture->GetTextureDesc().NumMips > 1)
+				D3D12Backend::GenerateMips(*texture);
+		}
+	}
+
+private:
+	ComPtr<ID3D12Resource> m_d3d12StagingResource;
+	uint8_t* m_StagingPtr = nullptr;
+	uint32_t m_MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
+	std::size_t m_StagingByteSize = 0;
+
+	std::shared_ptr<CommandList> m_CommandList;
+
+};
+
+/*
+
+	Timestamp queries of the direct queue, every frame in flight has its own query heap and readback buffer.
+	Command lists resolve the queries they wrote into the readback buffer of their frame when they are closed.
+
+*/
+class D3D12GPUProfilerQuerySource : public GPUProfilerQuerySource
+{
+public:
+	virtual void ResizeQueries(uint32_t frameIndex, uint32_t numQueries)
+	{
+		D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+		queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+		queryHeapDesc.Count = numQueries;
+		queryHeapDesc.NodeMask = 0;
+		DX_CALL(s_Data.D3D12Device2->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_QueryHeaps[frameIndex])));
+
+		BufferDesc queryReadbackDesc = {};
+		queryReadbackDesc.Usage = BufferUsage::BUFFER_USAGE_READBACK;
+		queryReadbackDesc.NumElements = numQueries;
+		queryReadbackDesc.ElementSize = sizeof(uint64_t);
+		queryReadbackDesc.DebugName = "Query result readback buffer";
+
+		m_ReadbackBuffers[frameIndex] = std::make_unique<Buffer>(queryReadbackDesc);
+	}
+
+	virtual void ReadTimestamps(uint32_t frameIndex, uint32_t numQueries, uint64_t* outTimestamps)
+	{
+		m_ReadbackBuffers[frameIndex]->ReadBackData(outTimestamps, numQueries * sizeof(uint64_t));
+	}
+
+	virtual uint64_t GetTimestampFrequency() const { return s_Data.CommandQueueDirect->GetTimestampFrequency(); }
+
+	virtual GPUClockCalibration GetClockCalibration()
+	{
+		uint64_t gpuTimestamp = 0, cpuTimestamp = 0;
+		DX_CALL(s_Data.CommandQueueDirect->GetD3D12CommandQueue()->GetClockCalibration(&gpuTimestamp, &cpuTimestamp));
+
+		// The CPU timestamp is a QueryPerformanceCounter value, steady_clock counts the same ticks in nanoseconds
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+
+		uint64_t ticksPerSecond = static_cast<uint64_t>(frequency.QuadPart);
+		uint64_t nanoseconds = (cpuTimestamp / ticksPerSecond) * 1000000000 + (cpuTimestamp % ticksPerSecond) * 1000000000 / ticksPerSecond;
+
+		GPUClockCalibration calibration;
+		calibration.GPUTimestamp = gpuTimestamp;
+		calibration.CPUTime = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+		return calibration;
+	}
+
+	ID3D12QueryHeap* GetQueryHeap(uint32_t frameIndex) const { return m_QueryHeaps[frameIndex].Get(); }
+	const Buffer& GetReadbackBuffer(uint32_t frameIndex) const { return *m_ReadbackBuffers[frameIndex]; }
+
+private:
+	ComPtr<ID3D12QueryHeap> m_QueryHeaps[RenderState::BACK_BUFFER_COUNT];
+	std::unique_ptr<Buffer> m_ReadbackBuffers[RenderState::BACK_BUFFER_COUNT];
+
+};
+
+void EnableDebugLayer()
+{
+#if defined(_DEBUG)
+	ComPtr<ID3D12Debug> d3d12DebugController0;
+	ComPtr<ID3D12Debug1> d3d12DebugController1;
+
+	DX_CALL(D3D12GetDebugInterface(IID_PPV_ARGS(&d3d12DebugController0)));
+	d3d12DebugController0->EnableDebugLayer();
+
+	if (GPU_VALIDATION_ENABLED)
+	{
+		DX_CALL(d3d12DebugController0->QueryInterface(IID_PPV_ARGS(&d3d12DebugController1)));
+		d3d12DebugController1->SetEnableGPUBasedValidation(true);
+		LOG_INFO("[Device] Enabled GPU based validation");
+	}
+#endif
+}
+
+void CreateAdapter()
+{
+	ComPtr<IDXGIFactory4> dxgiFactory;
+	UINT createFactoryFlags = 0;
+
+#if defined(_DEBUG)
+	createFactoryFlags = DXGI_CREATE_FACTORY_DEBUG;
+#endif
+
+	DX_CALL(CreateDXGIFactory2(createFactoryFlags, IID_PPV_ARGS(&dxgiFactory)));
+
+	ComPtr<IDXGIAdapter1> dxgiAdapter1;
+
+	SIZE_T maxDedicatedVideoMemory = 0;
+	for (UINT i = 0; dxgiFactory->EnumAdapters1(i, &dxgiAdapter1) != DXGI_ERROR_NOT_FOUND; ++i)
+	{
+		DXGI_ADAPTER_DESC1 dxgiAdapterDesc1;
+		dxgiAdapter1->GetDesc1(&dxgiAdapterDesc1);
+
+		if ((dxgiAdapterDesc1.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) == 0 &&
+			SUCCEEDED(D3D12CreateDevice(dxgiAdapter1.Get(), D3D_FEATURE_LEVEL_11_0,
+				__uuidof(ID3D12Device), nullptr)) && dxgiAdapterDesc1.DedicatedVideoMemory > maxDedicatedVideoMemory)
+		{
+			maxDedicatedVideoMemory = dxgiAdapterDesc1.DedicatedVideoMemory;
+			DX_CALL(dxgiAdapter1.As(&s_Data.DXGIAdapter4));
+		}
+	}
+}
+
+void CreateDevice()
+{
+	DX_CALL(D3D12CreateDevice(s_Data.DXGIAdapter4.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&s_Data.D3D12Device2)));
+
+#if defined(_DEBUG)
+	if (GPU_VALIDATION_ENABLED)
+	{
+		// Set up GPU validation
+		ComPtr<ID3D12DebugDevice1> d3d12DebugDevice;
+		DX_CALL(s_Data.D3D12Device2->QueryInterface(IID_PPV_ARGS(&d3d12DebugDevice)));
+
+		D3D12_DEBUG_DEVICE_GPU_BASED_VALIDATION_SETTINGS debugValidationSettings = {};
+		debugValidationSettings.MaxMessagesPerCommandList = 10;
+		debugValidationSettings.DefaultShaderPatchMode = D3D12_GPU_BASED_VALIDATION_SHADER_PATCH_MODE_GUARDED_VALIDATION;
+		debugValidationSettings.PipelineStateCreateFlags = D3D12_GPU_BASED_VALIDATION_PIPELINE_STATE_CREATE_FLAG_FRONT_LOAD_CREATE_GUARDED_VALIDATION_SHADERS;
+		DX_CALL(d3d12DebugDevice->SetDebugParameter(D3D12_DEBUG_DEVICE_PARAMETER_GPU_BASED_VALIDATION_SETTINGS, &debugValidationSettings, sizeof(D3D12_DEBUG_DEVICE_GPU_BASED_VALIDATION_SETTINGS)));
+	}
+
+	// Set up info queue with filters
+	ComPtr<ID3D12InfoQueue> pInfoQueue;
+
+	if (SUCCEEDED(s_Data.D3D12Device2.As(&pInfoQueue)))
+	{
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_CORRUPTION, TRUE);
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_ERROR, TRUE);
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_WARNING, TRUE);
+
+		// Suppress whole categories of messages
+		//D3D12_MESSAGE_CATEGORY categories[] = {};
+
+		// Suppress messages based on their severity level
+		D3D12_MESSAGE_SEVERITY severities[] =
+		{
+			D3D12_MESSAGE_SEVERITY_INFO
+		};
+
+		// Suppress individual messages by their ID
+		D3D12_MESSAGE_ID denyIds[] =
+		{
+			D3D12_MESSAGE_ID_CLEARRENDERTARGETVIEW_MISMATCHINGCLEARVALUE,
+			D3D12_MESSAGE_ID_MAP_INVALID_NULLRANGE,
+			D3D12_MESSAGE_ID_UNMAP_INVALID_NULLRANGE,
+			// This is a temporary fix for Windows 11 due to a bug that has not been fixed yet
+			D3D12_MESSAGE_ID_RESOURCE_BARRIER_MISMATCHING_COMMAND_LIST_TYPE,
+		};
+
+		D3D12_INFO_QUEUE_FILTER newFilter = {};
+		//newFilter.DenyList.NumCategories = _countof(categories);
+		//newFilter.DenyList.pCategoryList = categories;
+		newFilter.DenyList.NumSeverities = _countof(severities);
+		newFilter.DenyList.pSeverityList = severities;
+		newFilter.DenyList.NumIDs = _countof(denyIds);
+		newFilter.DenyList.pIDList = denyIds;
+
+		DX_CALL(pInfoQueue->PushStorageFilter(&newFilter));
+	}
+#endif
+}
+
+/*
+
+	A pipeline library written by another driver or adapter is rejected when it is created, it is then replaced by an empty one,
+	the pipeline states are recreated and the file is overwritten on shutdown.
+
+*/
+void CreatePipelineLibrary()
+{
+	std::ifstream file(PIPELINE_LIBRARY_FILEPATH, std::ios::binary | std::ios::ate);
+	if (file)
+	{
+		s_Data.PipelineLibraryBlob.resize(static_cast<std::size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(s_Data.PipelineLibraryBlob.data()), s_Data.PipelineLibraryBlob.size());
+
+		if (!file)
+			s_Data.PipelineLibraryBlob.clear();
+	}
+
+	if (!s_Data.PipelineLibraryBlob.empty())
+	{
+		if (SUCCEEDED(s_Data.D3D12Device2->CreatePipelineLibrary(s_Data.PipelineLibraryBlob.data(), s_Data.PipelineLibraryBlob.size(),
+			IID_PPV_ARGS(&s_Data.PipelineLibrary))))
+		{
+			LOG_INFO("[D3D12Backend] Loaded pipeline library {} ({} bytes)", PIPELINE_LIBRARY_FILEPATH, s_Data.PipelineLibraryBlob.size());
+			return;
+		}
+
+		LOG_WARN("[D3D12Backend] Pipeline library {} was written by another driver or is corrupt, pipeline states are recreated", PIPELINE_LIBRARY_FILEPATH);
+		s_Data.PipelineLibraryBlob.clear();
+	}
+
+	if (FAILED(s_Data.D3D12Device2->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&s_Data.PipelineLibrary))))
+	{
+		LOG_WARN("[D3D12Backend] Pipeline libraries are not supported, pipeline states are not stored between runs");
+		s_Data.PipelineLibrary.Reset();
+	}
+}
+
+void SavePipelineLibrary()
+{
+	if (!s_Data.PipelineLibrary || s_Data.NumPipelineLibraryStores == 0)
+		return;
+
+	std::vector<uint8_t> blob(s_Data.PipelineLibrary->GetSerializedSize());
+	if (FAILED(s_Data.PipelineLibrary->Serialize(blob.data(), blob.size())))
+	{
+		LOG_WARN("[D3D12Backend] Could not serialize the pipeline library");
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::path filepath = PIPELINE_LIBRARY_FILEPATH;
+	std::filesystem::create_directories(filepath.parent_path(), error);
+
+	// Written next to the final file and renamed once complete, so a crash while writing never leaves a truncated library behind
+	std::filesystem::path tempFilepath = filepath;
+	tempFilepath += ".tmp";
+
+	{
+		std::ofstream file(tempFilepath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+
+		if (!file)
+		{
+			LOG_WARN("[D3D12Backend] Could not write pipeline library: {}", tempFilepath.string());
+			return;
+		}
+	}
+
+	std::filesystem::rename(tempFilepath, filepath, error);
+	if (error)
+	{
+		LOG_WARN("[D3D12Backend] Could not write pipeline library: {}", filepath.string());
+		std::filesystem::remove(tempFilepath, error);
+		return;
+	}
+
+	LOG_INFO("[D3D12Backend] Stored {} new pipeline states in {} ({} bytes)", s_Data.NumPipelineLibraryStores.load(), PIPELINE_LIBRARY_FILEPATH, blob.size());
+}
+
+// Pipeline states are stored in the library under their key, so a changed description never loads a stale pipeline state
+std::wstring GetPipelineLibraryName(const Hash128& key)
+{
+	wchar_t name[33];
+	swprintf(name, _countof(name), L"%016llx%016llx", key.High, key.Low);
+
+	return name;
+}
+
+void AddShaderBytecode(PipelineStateHasher& hasher, const D3D12_SHADER_BYTECODE& bytecode)
+{
+	hasher.AddBytes(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+}
+
+// D3D12_BLEND_DESC and D3D12_DEPTH_STENCIL_DESC have padding, so the descriptions are hashed member by member
+Hash128 HashGraphicsPipelineStateDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash)
+{
+	PipelineStateHasher hasher;
+	hasher.AddHash(rootSignatureHash);
+
+	AddShaderBytecode(hasher, desc.VS);
+	AddShaderBytecode(hasher, desc.PS);
+	AddShaderBytecode(hasher, desc.DS);
+	AddShaderBytecode(hasher, desc.HS);
+	AddShaderBytecode(hasher, desc.GS);
+
+	hasher.Add(desc.BlendState.AlphaToCoverageEnable);
+	hasher.Add(desc.BlendState.IndependentBlendEnable);
+	for (const D3D12_RENDER_TARGET_BLEND_DESC& blend : desc.BlendState.RenderTarget)
+	{
+		hasher.Add(blend.BlendEnable);
+		hasher.Add(blend.LogicOpEnable);
+		hasher.Add(blend.SrcBlend);
+		hasher.Add(blend.DestBlend);
+		hasher.Add(blend.BlendOp);
+		hasher.Add(blend.SrcBlendAlpha);
+		hasher.Add(blend.DestBlendAlpha);
+		hasher.Add(blend.BlendOpAlpha);
+		hasher.Add(blend.LogicOp);
+		hasher.Add(blend.RenderTargetWriteMask);
+	}
+	hasher.Add(desc.SampleMask);
+
+	// Only 4 byte members, so the rasterizer description has no padding
+	hasher.Add(desc.RasterizerState);
+
+	const D3D12_DEPTH_STENCIL_DESC& depthStencil = desc.DepthStencilState;
+	hasher.Add(depthStencil.DepthEnable);
+	hasher.Add(depthStencil.DepthWriteMask);
+	hasher.Add(depthStencil.DepthFunc);
+	hasher.Add(depthStencil.StencilEnable);
+	hasher.Add(depthStencil.StencilReadMask);
+	hasher.Add(depthStencil.StencilWriteMask);
+	hasher.Add(depthStencil.FrontFace);
+	hasher.Add(depthStencil.BackFace);
+
+	hasher.Add(desc.InputLayout.NumElements);
+	for (uint32_t i = 0; i < desc.InputLayout.NumElements; ++i)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+		hasher.AddString(element.SemanticName);
+		hasher.Add(element.SemanticIndex);
+		hasher.Add(element.Format);
+		hasher.Add(element.InputSlot);
+		hasher.Add(element.AlignedByteOffset);
+		hasher.Add(element.InputSlotClass);
+		hasher.Add(element.InstanceDataStepRate);
+	}
+
+	hasher.Add(desc.StreamOutput.NumEntries);
+	hasher.Add(desc.IBStripCutValue);
+	hasher.Add(desc.PrimitiveTopologyType);
+	hasher.Add(desc.NumRenderTargets);
+	for (uint32_t i = 0; i < desc.NumRenderTargets; ++i)
+		hasher.Add(desc.RTVFormats[i]);
+	hasher.Add(desc.DSVFormat);
+	hasher.Add(desc.SampleDesc);
+	hasher.Add(desc.NodeMask);
+	hasher.Add(desc.Flags);
+
+	return hasher.GetHash();
+}
+
+Hash128 HashComputePipelineStateDesc(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash)
+{
+	PipelineStateHasher hasher;
+	hasher.AddHash(rootSignatureHash);
+
+	AddShaderBytecode(hasher, desc.CS);
+	hasher.Add(desc.NodeMask);
+	hasher.Add(desc.Flags);
+
+	return hasher.GetHash();
+}
+
+HRESULT LoadFromPipelineLibrary(const std::wstring& libraryName, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	return s_Data.PipelineLibrary->LoadGraphicsPipeline(libraryName.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+}
+
+HRESULT LoadFromPipelineLibrary(const std::wstring& libraryName, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	return s_Data.PipelineLibrary->LoadComputePipeline(libraryName.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+}
+
+HRESULT CreateD3D12PipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	return s_Data.D3D12Device2->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+}
+
+HRESULT CreateD3D12PipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& pipelineState)
+{
+	return s_Data.D3D12Device2->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+}
+
+// Runs on a job system thread, every key is only loaded or stored once since the pipeline state cache deduplicates them
+template<typename PipelineStateDesc>
+void* LoadOrCreatePipelineState(const Hash128& key, const std::string& name, const PipelineStateDesc& desc)
+{
+	std::wstring libraryName = GetPipelineLibraryName(key);
+	ComPtr<ID3D12PipelineState> pipelineState;
+
+	if (s_Data.PipelineLibrary && SUCCEEDED(LoadFromPipelineLibrary(libraryName, desc, pipelineState)))
+	{
+		s_Data.NumPipelineLibraryHits++;
+	}
+	else
+	{
+		if (FAILED(CreateD3D12PipelineState(desc, pipelineState)))
+			return nullptr;
+
+		if (s_Data.PipelineLibrary && SUCCEEDED(s_Data.PipelineLibrary->StorePipeline(libraryName.c_str(), pipelineState.Get())))
+			s_Data.NumPipelineLibraryStores++;
+	}
+
+	pipelineState->SetName(StringHelper::StringToWString(name).c_str());
+	return pipelineState.Detach();
+}
+
+void CreateMipMapComputeState()
+{
+	// Root signature
+	CD3DX12_DESCRIPTOR_RANGE1 ranges[2] = {};
+	ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+	ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+	CD3DX12_ROOT_PARAMETER1 rootParameters[3] = {};
+	rootParameters[0].InitAsConstants(8, 0);
+	rootParameters[1].InitAsDescriptorTable(1, &ranges[0]);
+	rootParameters[2].InitAsDescriptorTable(1, &ranges[1]);
+
+	D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+	// Default texture sampler (antisotropic)
+	CD3DX12_STATIC_SAMPLER_DESC staticSamplers[1] = {};
+	staticSamplers[0].Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+	staticSamplers[0].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	staticSamplers[0].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	staticSamplers[0].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	staticSamplers[0].MaxAnisotropy = 0;
+	staticSamplers[0].ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+	staticSamplers[0].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	staticSamplers[0].MinLOD = 0.0f;
+	staticSamplers[0].MaxLOD = D3D12_FLOAT32_MAX;
+	staticSamplers[0].MipLODBias = 0;
+	staticSamplers[0].ShaderRegister = 0;
+	staticSamplers[0].RegisterSpace = 0;
+	staticSamplers[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC versionedRootSignatureDesc = {};
+	versionedRootSignatureDesc.Init_1_1(_countof(rootParameters), &rootParameters[0], _countof(staticSamplers), &staticSamplers[0], rootSignatureFlags);
+
+	ComPtr<ID3DBlob> serializedRootSig;
+	ComPtr<ID3DBlob> errorBlob;
+
+	HRESULT hr = D3D12SerializeVersionedRootSignature(&versionedRootSignatureDesc, &serializedRootSig, &errorBlob);
+	if (!SUCCEEDED(hr) || errorBlob)
+	{
+		LOG_ERR(static_cast<const char*>(errorBlob->GetBufferPointer()));
+		errorBlob->Release();
+	}
+
+	DX_CALL(s_Data.D3D12Device2->CreateRootSignature(0, serializedRootSig->GetBufferPointer(),
+		serializedRootSig->GetBufferSize(), IID_PPV_ARGS(&s_Data.MipMapGenRootSig)));
+	s_Data.MipMapGenRootSig->SetName(StringHelper::StringToWString("Mip map root signature").c_str());
+
+	// Shader
+	s_Data.MipMapGenShader = std::make_unique<Shader>("Resources/Shaders/MipMapGen_CS.hlsl", "main", SHADER_TARGET_COMPUTE);
+
+	// Pipeline state
+	D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+	psoDesc.pRootSignature = s_Data.MipMapGenRootSig.Get();
+	psoDesc.CS = s_Data.MipMapGenShader->GetShaderByteCode();
+	psoDesc.NodeMask = 0;
+	psoDesc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+
+	Hash128 rootSignatureHash = Hash::Bytes(serializedRootSig->GetBufferPointer(), serializedRootSig->GetBufferSize());
+	s_Data.MipMapGenPipelineStateID = D3D12Backend::CreateComputePipelineState("Mip map pipeline state", psoDesc, rootSignatureHash);
+}
+
+void QueryVideoMemoryInfo()
+{
+	s_Data.DXGIAdapter4->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &s_Data.DXGIQueryVideoMemoryInfo);
+}
+
+void D3D12Backend::Initialize(HWND hWnd, uint32_t width, uint32_t height)
+{
+	EnableDebugLayer();
+	CreateAdapter();
+	CreateDevice();
+
+	uint32_t numDescriptorsPerHeap[4] = { 4096, 1, 512, 512 };
+	for (uint32_t i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; ++i)
+		s_Data.DescriptorHeaps[i] = std::make_unique<DescriptorHeap>(static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(i), numDescriptorsPerHeap[i]);
+
+	s_Data.CommandQueueDirect = std::make_shared<CommandQueue>(D3D12_COMMAND_LIST_TYPE_DIRECT);
+	s_Data.CommandQueueCompute = std::make_unique<CommandQueue>(D3D12_COMMAND_LIST_TYPE_COMPUTE);
+	s_Data.CommandQueueCopy = std::make_unique<CommandQueue>(D3D12_COMMAND_LIST_TYPE_COPY);
+
+	s_Data.UploadBuffer = std::make_unique<UploadBuffer>(MEGABYTE(100));
+	s_Data.UploadQueue = std::make_unique<UploadQueue>(std::make_unique<D3D12UploadQueueBackend>(MEGABYTE(64)));
+	s_Data.SwapChain = std::make_unique<SwapChain>(hWnd, s_Data.CommandQueueDirect, width, height);
+
+	auto gpuQuerySource = std::make_unique<D3D12GPUProfilerQuerySource>();
+	s_Data.GPUQuerySource = gpuQuerySource.get();
+	s_Data.GPUProfiler = std::make_unique<GPUProfiler>(std::move(gpuQuerySource), RenderState::BACK_BUFFER_COUNT);
+
+	// Every shader is compiled up front, in parallel on the job system, the passes then take theirs from the shader cache
+	ShaderCache::Initialize(std::make_unique<DXCShaderCompiler>());
+	ShaderCache::CompileDirectory("Resources/Shaders/");
+
+	CreatePipelineLibrary();
+	s_Data.PipelineStateCache = std::make_unique<PipelineStateCache>([](void* pipelineState) { static_cast<ID3D12PipelineState*>(pipelineState)->Release(); });
+
+	CreateMipMapComputeState();
+
+	s_Data.ProcessInFlightCommandLists = true;
+	s_Data.ProcessInFlightCommandListsThread = std::thread([]() {
+		while (s_Data.ProcessInFlightCommandLists)
+		{
+			s_Data.CommandQueueDirect->ResetCommandLists();
+			s_Data.CommandQueueCompute->ResetCommandLists();
+			s_Data.CommandQueueCopy->ResetCommandLists();
+
+			std::this_thread::yield();
+		}
+		});
+}
+
+void D3D12Backend::BeginFrame()
+{
+	QueryVideoMemoryInfo();
+
+	// Finished uploads are processed on the render thread, since mip generation allocates descriptors
+	s_Data.UploadQueue->ProcessCompletions();
+	s_Data.UploadQueue->BeginFrame();
+
+	// The frame that last used this back buffer completed, so its GPU zones can be read back
+	s_Data.GPUProfiler->BeginFrame(s_Data.CurrentBackBufferIndex);
+	Profiler::AddGPUZones(s_Data.GPUProfiler->GetZones());
+}
+
+void D3D12Backend::OnImGuiRender()
+{
+	if (ImGui::CollapsingHeader("GPU Memory Usage"))
+	{
+		ImGui::Indent(10.0f);
+
+		ImGui::Text("Usage: %u MB", (uint64_t)(TO_MEGABYTE(s_Data.DXGIQueryVideoMemoryInfo.CurrentUsage)));
+		ImGui::Text("Total budget: %u MB", (uint64_t)(TO_MEGABYTE(s_Data.DXGIQueryVideoMemoryInfo.Budget)));
+		ImGui::Text("Reserved: %u MB", (uint64_t)(TO_MEGABYTE(s_Data.DXGIQueryVideoMemoryInfo.CurrentReservation)));
+		ImGui::Text("Available reserve: %u MB", (uint64_t)(TO_MEGABYTE(s_Data.DXGIQueryVideoMemoryInfo.AvailableForReservation)));
+
+		ImGui::Unindent(10.0f);
+	}
+
+	if (ImGui::CollapsingHeader("Upload Queue"))
+	{
+		ImGui::Indent(10.0f);
+
+		UploadQueueStatistics uploadStats = s_Data.UploadQueue->GetStatistics();
+		ImGui::Text("Pending requests: %u", (uint32_t)uploadStats.NumPendingRequests);
+		ImGui::Text("Pending: %.2f MB", uploadStats.NumPendingBytes / (1024.0f * 1024.0f));
+		ImGui::Text("Uploaded this frame: %.2f MB", uploadStats.BytesUploadedThisFrame / (1024.0f * 1024.0f));
+		ImGui::Text("Batches submitted: %llu", uploadStats.NumBatchesSubmitted);
+		ImGui::Text("Requests completed: %llu", uploadStats.NumRequestsCompleted);
+
+		ImGui::Unindent(10.0f);
+	}
+
+	if (ImGui::CollapsingHeader("GPU Profiler"))
+	{
+		ImGui::Indent(10.0f);
+
+		GPUProfilerStatistics gpuProfilerStats = s_Data.GPUProfiler->GetStatistics();
+		ImGui::Text("Registered zones: %u", gpuProfilerStats.NumRegisteredZones);
+		ImGui::Text("Zones last frame: %u", gpuProfilerStats.NumZones);
+		ImGui::Text("Queries per frame: %u", gpuProfilerStats.NumQueriesPerFrame);
+		ImGui::Text("Dropped zones: %llu", gpuProfilerStats.NumDroppedZones);
+
+		ImGui::Unindent(10.0f);
+	}
+
+	if (ImGui::CollapsingHeader("Shader Cache"))
+	{
+		ImGui::Indent(10.0f);
+
+		ShaderCacheStatistics shaderCacheStats = ShaderCache::GetStatistics();
+		ImGui::Text("From memory: %u", shaderCacheStats.NumMemoryHits);
+		ImGui::Text("From disk: %u", shaderCacheStats.NumDiskHits);
+		ImGui::Text("Compiled: %u", shaderCacheStats.NumCompiled);
+		ImGui::Text("Failed: %u", shaderCacheStats.NumFailed);
+		ImGui::Text("Hashing: %.2f ms", shaderCacheStats.HashTime);
+		ImGui::Text("Compilation: %.2f ms (summed over threads)", shaderCacheStats.CompileTime);
+		ImGui::Text("Last batch: %.2f ms", shaderCacheStats.LastBatchTime);
+
+		ImGui::Unindent(10.0f);
+	}
+
+	if (ImGui::CollapsingHeader("Pipeline States"))
+	{
+		ImGui::Indent(10.0f);
+
+		PipelineStateCacheStatistics pipelineStateStats = s_Data.PipelineStateCache->GetStatistics();
+		ImGui::Text("Requests: %u", pipelineStateStats.NumRequests);
+		ImGui::Text("Deduplicated: %u", pipelineStateStats.NumDeduplicated);
+		ImGui::Text("Created: %u", pipelineStateStats.NumCreated);
+		ImGui::Text("Pending: %u", pipelineStateStats.NumPending);
+		ImGui::Text("Failed: %u", pipelineStateStats.NumFailed);
+		ImGui::Text("From pipeline library: %u", s_Data.NumPipelineLibraryHits.load());
+		ImGui::Text("Stored in pipeline library: %u", s_Data.NumPipelineLibraryStores.load());
+		ImGui::Text("Creation: %.2f ms (summed over threads)", pipelineStateStats.CreationTime);
+
+		ImGui::Unindent(10.0f);
+	}
+}
+
+void D3D12Backend::EndFrame()
+{
+	s_Data.SwapChain->SwapBuffers(s_Data.VSync);
+	s_Data.CurrentBackBufferIndex = s_Data.SwapChain->GetCurrentBackBufferIndex();
+}
+
+void D3D12Backend::Finalize()
+{
+	s_Data.UploadQueue.reset();
+	Flush();
+
+	s_Data.ProcessInFlightCommandLists = false;
+
+	if (s_Data.ProcessInFlightCommandListsThread.joinable())
+		s_Data.ProcessInFlightCommandListsThread.join();
+
+	// Pipeline states still being created are stored in the library as well
+	s_Data.PipelineStateCache->WaitForAll();
+	SavePipelineLibrary();
+	s_Data.PipelineStateCache.reset();
+	s_Data.PipelineLibrary.Reset();
+	s_Data.PipelineLibraryBlob.clear();
+
+	ShaderCache::Finalize();
+}
+
+void D3D12Backend::CreateBuffer(ComPtr<ID3D12Resource>& d3d12Resource, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& bufferDesc, D3D12_RESOURCE_STATES initialState)
+{
+	CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+	DX_CALL(s_Data.D3D12Device2->CreateCommittedResource(
+		&heapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&bufferDesc,
+		initialState,
+		nullptr,
+		IID_PPV_ARGS(&d3d12Resource)
+	));
+}
+
+void D3D12Backend::CreateTexture(ComPtr<ID3D12Resource>& d3d12Resource, const D3D12_RESOURCE_DESC& resourceDesc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue)
+{
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+	DX_CALL(s_Data.D3D12Device2->CreateCommittedResource(
+		&heapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&resourceDesc,
+		initialState,
+		clearValue,
+		IID_PPV_ARGS(&d3d12Resource)
+	));
+}
+
+UploadTicket D3D12Backend::UploadBufferData(Buffer& destBuffer, const void* bufferData)
+{
+	return s_Data.UploadQueue->UploadBuffer(&destBuffer, bufferData, destBuffer.GetByteSize());
+}
+
+void D3D12Backend::UploadBufferDataRegion(Buffer& destBuffer, std::size_t destOffset, std::size_t numBytes)
+{
+	UploadBufferAllocation upload = s_Data.UploadBuffer->Allocate(destBuffer.GetByteSize());
+
+	auto commandList = s_Data.CommandQueueCopy->GetCommandList();
+	commandList->CopyBufferRegion(upload, destBuffer, destOffset, numBytes);
+	uint64_t fenceValue = s_Data.CommandQueueCopy->ExecuteCommandList(commandList);
+	s_Data.CommandQueueCopy->WaitForFenceValue(fenceValue);
+}
+
+UploadTicket D3D12Backend::UploadTextureData(Texture& destTexture, const void* textureData)
+{
+	// Only the first mip is uploaded, rows of texture data are tightly packed in the format of the texture
+	const TextureDesc& textureDesc = destTexture.GetTextureDesc();
+	std::size_t rowPitch = static_cast<std::size_t>(textureDesc.Width) * GetTextureFormatByteSize(textureDesc.Format);
+	ASSERT(rowPitch > 0, "Texture data uploaded to a texture without a format");
+
+	return s_Data.UploadQueue->UploadTexture(&destTexture, textureData, rowPitch, textureDesc.Height);
+}
+
+bool D3D12Backend::IsUploadComplete(UploadTicket ticket)
+{
+	return s_Data.UploadQueue->IsComplete(ticket);
+}
+
+void D3D12Backend::WaitForUpload(UploadTicket ticket)
+{
+	s_Data.UploadQueue->WaitForTicket(ticket);
+}
+
+void D3D12Backend::GenerateMips(Texture& texture)
+{
+	auto computeCommandList = s_Data.CommandQueueCompute->GetCommandList();
+	computeCommandList->GenerateMips(texture);
+	uint64_t computeFenceValue = s_Data.CommandQueueCompute->ExecuteCommandList(computeCommandList);
+	s_Data.CommandQueueCompute->WaitForFenceValue(computeFenceValue);
+}
+
+GPUProfiler& D3D12Backend::GetGPUProfiler()
+{
+	return *s_Data.GPUProfiler;
+}
+
+ID3D12QueryHeap* D3D12Backend::GetD3D12TimestampQueryHeap(uint32_t backBufferIndex)
+{
+	return s_Data.GPUQuerySource->GetQueryHeap(backBufferIndex);
+}
+
+const Buffer& D3D12Backend::GetQueryReadbackBuffer(uint32_t backBufferIndex)
+{
+	return s_Data.GPUQuerySource->GetReadbackBuffer(backBufferIndex);
+}
+
+uint32_t D3D12Backend::CreateGraphicsPipelineState(const std::string& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash)
+{
+	ASSERT(!desc.DS.pShaderBytecode && !desc.HS.pShaderBytecode && !desc.GS.pShaderBytecode && desc.StreamOutput.NumEntries == 0,
+		"Pipeline states with tessellation, geometry shaders or stream output are not supported");
+	Hash128 key = HashGraphicsPipelineStateDesc(desc, rootSignatureHash);
+
+	// The description points into memory of the caller, the creation job works on its own copies
+	std::vector<uint8_t> vertexShader(static_cast<const uint8_t*>(desc.VS.pShaderBytecode), static_cast<const uint8_t*>(desc.VS.pShaderBytecode) + desc.VS.BytecodeLength);
+	std::vector<uint8_t> pixelShader(static_cast<const uint8_t*>(desc.PS.pShaderBytecode), static_cast<const uint8_t*>(desc.PS.pShaderBytecode) + desc.PS.BytecodeLength);
+	std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout(desc.InputLayout.pInputElementDescs, desc.InputLayout.pInputElementDescs + desc.InputLayout.NumElements);
+	std::vector<std::string> semanticNames;
+	for (const D3D12_INPUT_ELEMENT_DESC& element : inputLayout)
+		semanticNames.push_back(element.SemanticName);
+	ComPtr<ID3D12RootSignature> rootSignature = desc.pRootSignature;
+
+	return s_Data.PipelineStateCache->Request(key, name, [=]()
+	{
+		std::vector<D3D12_INPUT_ELEMENT_DESC> jobInputLayout = inputLayout;
+		for (std::size_t i = 0; i < jobInputLayout.size(); ++i)
+			jobInputLayout[i].SemanticName = semanticNames[i].c_str();
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC jobDesc = desc;
+		jobDesc.VS = { vertexShader.data(), vertexShader.size() };
+		jobDesc.PS = { pixelShader.data(), pixelShader.size() };
+		jobDesc.InputLayout = { jobInputLayout.data(), static_cast<uint32_t>(jobInputLayout.size()) };
+		jobDesc.pRootSignature = rootSignature.Get();
+
+		return LoadOrCreatePipelineState(key, name, jobDesc);
+	});
+}
+
+uint32_t D3D12Backend::CreateComputePipelineState(const std::string& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc, const Hash128& rootSignatureHash)
+{
+	Hash128 key = HashComputePipelineStateDesc(desc, rootSignatureHash);
+
+	std::vector<uint8_t> computeShader(static_cast<const uint8_t*>(desc.CS.pShaderBytecode), static_cast<const uint8_t*>(desc.CS.pShaderBytecode) + desc.CS.BytecodeLength);
+	ComPtr<ID3D12RootSignature> rootSignature = desc.pRootSignature;
+
+	return s_Data.PipelineStateCache->Request(key, name, [=]()
+	{
+		D3D12_COMPUTE_PIPELINE_STATE_DESC jobDesc = desc;
+		jobDesc.CS = { computeShader.data(), computeShader.size() };
+		jobDesc.pRootSignature = rootSignature.Get();
+
+		return LoadOrCreatePipelineState(key, name, jobDesc);
+	});
+}
+
+ID3D12PipelineState* D3D12Backend::GetPipelineState(uint32_t pipelineStateID)
+{
+	return static_cast<ID3D12PipelineState*>(s_Data.PipelineStateCache->GetPipelineState(pipelineStateID));
+}
+
+ID3D12PipelineState* D3D12Backend::WaitForPipelineState(uint32_t pipelineStateID)
+{
+	return static_cast<ID3D12PipelineState*>(s_Data.PipelineStateCache->WaitForPipelineState(pipelineStateID));
+}
+
+void D3D12Backend::Resize(uint32_t width, uint32_t height)
+{
+	width = std::max(1u, width);
+	height = std::max(1u, height);
+
+	Flush();
+
+	s_Data.SwapChain->Resize(width, height);
+}
+
+void D3D12Backend::Flush()
+{
+	// Uploads are recorded on the copy queue, so they have to be submitted before it is flushed
+	if (s_Data.UploadQueue)
+		s_Data.UploadQueue->Flush();
+
+	s_Data.CommandQueueDirect->Flush();
+	s_Data.CommandQueueCompute->Flush();
+	s_Data.CommandQueueCopy->Flush();
+}
+
+void D3D12Backend::SetVSync(bool vSync)
+{
+	s_Data.VSync = vSync;
+}
+
+IDXGIAdapter4* D3D12Backend::GetDXGIAdapter()
+{
+	return s_Data.DXGIAdapter4.Get();
+}
+
+ID3D12Device2* D3D12Backend::GetD3D12Device()
+{
+	return s_Data.D3D12Device2.Get();
+}
+
+SwapChain& D3D12Backend::GetSwapChain()
+{
+	return *s_Data.SwapChain.get();
+}
+
+ID3D12PipelineState* D3D12Backend::GetMipGenPSO()
+{
+	// Textures can be uploaded right after initialization, mip generation cannot be skipped, so it waits for its pipeline state
+	return WaitForPipelineState(s_Data.MipMapGenPipelineStateID);
+}
+
+ID3D12RootSignature* D3D12Backend::GetMipGenRootSig()
+{
+	return s_Data.MipMapGenRootSig.Get();
+}
+
+DescriptorAllocation D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors)
+{
+	return s_Data.DescriptorHeaps[type]->Allocate(numDescriptors);
+}
+
+DescriptorHeap& D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type)
+{
+	return *s_Data.DescriptorHeaps[type].get();
+}
+
+std::shared_ptr<CommandList> D3D12Backend::GetCommandList(D3D12_COMMAND_LIST_TYPE type)
+{
+	switch (type)
+	{
+	case D3D12_COMMAND_LIST_TYPE_DIRECT:
+		return s_Data.CommandQueueDirect->GetCommandList();
+	case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+		return s_Data.CommandQueueCompute->GetCommandList();
+	case D3D12_COMMAND_LIST_TYPE_COPY:
+		return s_Data.CommandQueueCopy->GetCommandList();
+	}
+
+	ASSERT(false, "Tried to retrieve command list from a command queue type that is not supported.");
+	return nullptr;
+}
+
+void D3D12Backend::ExecuteCommandList(std::shared_ptr<CommandList> commandList)
+{
+	switch (commandList->GetCommandListType())
+	{
+	case D3D12_COMMAND_LIST_TYPE_DIRECT:
+		s_Data.CommandQueueDirect->ExecuteCommandList(commandList);
+		return;
+	case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+		s_Data.CommandQueueCompute->ExecuteCommandList(commandList);
+		return;
+	case D3D12_COMMAND_LIST_TYPE_COPY:
+		s_Data.CommandQueueCopy->ExecuteCommandList(commandList);
+		return;
+	}
+
+	ASSERT(false, "Tried to execute command list on a command queue type that is not supported.");
+}
+
+void D3D12Backend::ExecuteCommandListAndWait(std::shared_ptr<CommandList> commandList)
+{
+	uint64_t fenceValue = 0;
+
+	switch (commandList->GetCommandListType())
+	{
+	case D3D12_COMMAND_LIST_TYPE_DIRECT:
+		fenceValue = s_Data.CommandQueueDirect->ExecuteCommandList(commandList);
+		s_Data.CommandQueueDirect->WaitForFenceValue(fenceValue);
+		return;
+	case D3D12_COMMAND_LIST_TYPE_COMPUTE:
+		fenceValue = s_Data.CommandQueueCompute->ExecuteCommandList(commandList);
+		s_Data.CommandQueueCompute->WaitForFenceValue(fenceValue);
+		return;
+	case D3D12_COMMAND_LIST_TYPE_COPY:
+		fenceValue = s_Data.CommandQueueCopy->ExecuteCommandList(commandList);
+		s_Data.CommandQueueCopy->WaitForFenceValue(fenceValue);
+		return;
+	}
+
+	ASSERT(false, "Tried to execute command list on a command queue type that is not supported.");
+}
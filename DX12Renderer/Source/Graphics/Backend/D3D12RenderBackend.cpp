@@ -0,0 +1,892 @@
+#include "Pch.h"
+#include "Graphics/Backend/D3D12RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
+#include "Graphics/Backend/CommandList.h"
+#include "Graphics/Backend/DescriptorHeap.h"
+#include "Graphics/Backend/SwapChain.h"
+#include "Graphics/Buffer.h"
+#include "Graphics/Texture.h"
+#include "Graphics/RasterPass.h"
+#include "Graphics/ComputePass.h"
+#include "Graphics/RenderState.h"
+#include "Graphics/LightClustering.h"
+#include "Graphics/ShaderPermutation.h"
+
+// Buffers and textures are handed out as Resource pointers, so they can be released without knowing their type
+static Resource* ToResource(void* resource)
+{
+	return static_cast<Resource*>(resource);
+}
+
+static Buffer& ToBuffer(void* buffer)
+{
+	return *static_cast<Buffer*>(ToResource(buffer));
+}
+
+D3D12RenderBackend::D3D12RenderBackend(HWND hWnd, uint32_t width, uint32_t height)
+	: m_RenderResolution({ width, height })
+{
+	D3D12Backend::Initialize(hWnd, width, height);
+}
+
+D3D12RenderBackend::~D3D12RenderBackend()
+{
+	D3D12Backend::Flush();
+
+	// Everything created on the device has to be released before the device is
+	for (auto& renderPass : m_RenderPasses)
+		renderPass.reset();
+	for (auto& computePass : m_ComputePasses)
+		computePass.reset();
+	for (auto& renderBuffer : m_RenderBuffers)
+		renderBuffer.reset();
+
+	m_DepthPrepassDepthTarget.reset();
+	m_HDRColorTarget.reset();
+	m_SDRColorTarget.reset();
+	m_TAAResolveTarget.reset();
+	m_TAAHistory.reset();
+	m_VelocityTarget.reset();
+	m_VelocityTargetPrevious.reset();
+	m_ShadowAtlas.reset();
+	m_ShadowAtlasStaticLayer.reset();
+
+	D3D12Backend::Finalize();
+}
+
+void D3D12RenderBackend::BeginFrame()
+{
+	D3D12Backend::BeginFrame();
+
+	auto commandList = D3D12Backend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+	// Copy current velocity into previous velocity
+	commandList->CopyResource(*m_VelocityTargetPrevious, *m_VelocityTarget);
+
+	commandList->Transition(*m_DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	commandList->Transition(*m_VelocityTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	commandList->Transition(*m_HDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	commandList->Transition(*m_SDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	commandList->ClearDepthStencilView(m_DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV), m_DepthPrepassDepthTarget->GetTextureDesc().ClearColor.x);
+	commandList->ClearRenderTargetView(m_VelocityTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(m_VelocityTarget->GetTextureDesc().ClearColor));
+	commandList->ClearRenderTargetView(m_HDRColorTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(m_HDRColorTarget->GetTextureDesc().ClearColor));
+	commandList->ClearRenderTargetView(m_SDRColorTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(m_SDRColorTarget->GetTextureDesc().ClearColor));
+
+	D3D12Backend::ExecuteCommandList(commandList);
+}
+
+void D3D12RenderBackend::EndFrame()
+{
+	D3D12Backend::GetSwapChain().ResolveToBackBuffer(*m_SDRColorTarget);
+	D3D12Backend::EndFrame();
+}
+
+void D3D12RenderBackend::Flush()
+{
+	D3D12Backend::Flush();
+}
+
+void D3D12RenderBackend::Resize(uint32_t width, uint32_t height)
+{
+	m_RenderResolution = { width, height };
+	D3D12Backend::Resize(width, height);
+
+	m_DepthPrepassDepthTarget->Resize(width, height);
+	m_HDRColorTarget->Resize(width, height);
+	m_SDRColorTarget->Resize(width, height);
+
+	m_TAAResolveTarget->Resize(width, height);
+	m_TAAHistory->Resize(width, height);
+	m_VelocityTarget->Resize(width, height);
+	m_VelocityTargetPrevious->Resize(width, height);
+}
+
+void D3D12RenderBackend::SetVSync(bool vSync)
+{
+	D3D12Backend::SetVSync(vSync);
+}
+
+uint32_t D3D12RenderBackend::GetBackBufferIndex() const
+{
+	return D3D12Backend::GetSwapChain().GetCurrentBackBufferIndex();
+}
+
+GPUProfiler& D3D12RenderBackend::GetGPUProfiler()
+{
+	return D3D12Backend::GetGPUProfiler();
+}
+
+void D3D12RenderBackend::CreateRenderPasses(const RenderSettings& settings)
+{
+	D3D12_RENDER_TARGET_BLEND_DESC defaultBlendDesc = {};
+	defaultBlendDesc.BlendEnable = TRUE;
+	defaultBlendDesc.LogicOpEnable = FALSE;
+	defaultBlendDesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	defaultBlendDesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	defaultBlendDesc.BlendOp = D3D12_BLEND_OP_ADD;
+	defaultBlendDesc.SrcBlendAlpha = D3D12_BLEND_SRC_ALPHA;
+	defaultBlendDesc.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+	defaultBlendDesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	defaultBlendDesc.LogicOp = D3D12_LOGIC_OP_NOOP;
+	defaultBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+
+	// Every pass reads positions from the position stream in slot 0, the lighting pass reads the other attributes from slot 2
+	DXGI_FORMAT positionFormat = settings.QuantizeMeshPositions ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT;
+
+	{
+		// Shadow mapping render pass
+		RasterPassDesc desc;
+		desc.VertexShaderPath = "Resources/Shaders/ShadowMapping_VS.hlsl";
+		desc.PixelShaderPath = "Resources/Shaders/ShadowMapping_PS.hlsl";
+
+		desc.NumColorAttachments = 0;
+		desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
+		desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.DepthAttachmentDesc.Width = settings.ShadowMapResolution.x;
+		desc.DepthAttachmentDesc.Height = settings.ShadowMapResolution.y;
+
+		desc.DepthBias = -50;
+		desc.SlopeScaledDepthBias = -5.0f;
+		desc.DepthBiasClamp = 1.0f;
+
+		desc.RootParameters.resize(1);
+		desc.RootParameters[0].InitAsConstants(16, 0); // Light VP
+
+		desc.ShaderInputLayout.push_back({ "POSITION", 0, positionFormat, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_SCALE", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 140, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_OFFSET", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 152, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+
+		m_RenderPasses[RenderPassType::SHADOW_MAPPING] = std::make_unique<RasterPass>("Shadow mapping", desc);
+
+		// Masked casters alpha test in the same shaders, with the texture coordinates from slot 2 and the material of their instance
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[1] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(3);
+		desc.RootParameters[1].InitAsConstantBufferView(2, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Material constant buffer
+		desc.RootParameters[2].InitAsDescriptorTable(_countof(ranges), &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL); // Bindless SRV table
+
+		desc.ShaderInputLayout.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 2, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "MATERIAL_ID", 0, DXGI_FORMAT_R32_UINT, 1, 128, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderDefines.push_back(ShaderPermutation::GetFeatureDefine(SHADER_FEATURE_ALPHA_TEST));
+
+		m_RenderPasses[RenderPassType::SHADOW_MAPPING_MASKED] = std::make_unique<RasterPass>("Shadow mapping (masked)", desc);
+	}
+
+	{
+		// Shadow compose render pass, copies the cached static layer of shadow atlas tiles into the shadow atlas
+		// Depth formats can only be copied as a whole, so the tiles are copied by writing the depth in a pixel shader
+		RasterPassDesc desc;
+		desc.VertexShaderPath = "Resources/Shaders/ShadowCompose_VS.hlsl";
+		desc.PixelShaderPath = "Resources/Shaders/ShadowCompose_PS.hlsl";
+
+		desc.NumColorAttachments = 0;
+		desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
+		desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.DepthAttachmentDesc.Width = settings.ShadowAtlas.AtlasResolution;
+		desc.DepthAttachmentDesc.Height = settings.ShadowAtlas.AtlasResolution;
+		desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[1] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(2);
+		desc.RootParameters[0].InitAsConstants(1, 0); // Static layer SRV index
+		desc.RootParameters[1].InitAsDescriptorTable(_countof(ranges), &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL); // Bindless SRV table
+
+		m_RenderPasses[RenderPassType::SHADOW_COMPOSE] = std::make_unique<RasterPass>("Shadow compose", desc);
+	}
+
+	{
+		// Depth pre-pass
+		RasterPassDesc desc;
+		desc.VertexShaderPath = "Resources/Shaders/DepthPrepass_VS.hlsl";
+		desc.PixelShaderPath = "Resources/Shaders/DepthPrepass_PS.hlsl";
+
+		desc.NumColorAttachments = 0;
+		desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH;
+		desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.DepthAttachmentDesc.Width = settings.RenderResolution.x;
+		desc.DepthAttachmentDesc.Height = settings.RenderResolution.y;
+
+		desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_LESS;
+
+		desc.RootParameters.resize(2);
+		desc.RootParameters[0].InitAsConstantBufferView(0); // Global constant buffer
+		desc.RootParameters[1].InitAsConstantBufferView(1); // Scene data constant buffer
+
+		desc.ShaderInputLayout.push_back({ "POSITION", 0, positionFormat, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_SCALE", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 140, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_OFFSET", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 152, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+
+		m_RenderPasses[RenderPassType::DEPTH_PREPASS] = std::make_unique<RasterPass>("Depth pre-pass", desc);
+
+		// Opaque geometry has no pixel shader work and keeps early-Z, masked geometry discards the pixels below its alpha cutoff
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[1] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(4);
+		desc.RootParameters[2].InitAsConstantBufferView(2, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Material constant buffer
+		desc.RootParameters[3].InitAsDescriptorTable(_countof(ranges), &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL); // Bindless SRV table
+
+		desc.ShaderInputLayout.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 2, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "MATERIAL_ID", 0, DXGI_FORMAT_R32_UINT, 1, 128, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderDefines.push_back(ShaderPermutation::GetFeatureDefine(SHADER_FEATURE_ALPHA_TEST));
+
+		m_RenderPasses[RenderPassType::DEPTH_PREPASS_MASKED] = std::make_unique<RasterPass>("Depth pre-pass (masked)", desc);
+	}
+
+	{
+		// Lighting render pass
+		RasterPassDesc desc;
+		desc.VertexShaderPath = "Resources/Shaders/Lighting_VS.hlsl";
+		desc.PixelShaderPath = "Resources/Shaders/Lighting_PS.hlsl";
+
+		// Opaque and masked geometry overwrites the color, the depth pre-pass already discarded the pixels masked geometry does not cover
+		desc.NumColorAttachments = 2;
+		desc.ColorBlendDesc[0] = defaultBlendDesc;
+		desc.ColorBlendDesc[0].BlendEnable = FALSE;
+		desc.ColorAttachmentDesc[0].Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
+		desc.ColorAttachmentDesc[0].Format = TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT;
+		desc.ColorAttachmentDesc[0].Width = settings.RenderResolution.x;
+		desc.ColorAttachmentDesc[0].Height = settings.RenderResolution.y;
+
+		desc.ColorBlendDesc[1] = defaultBlendDesc;
+		desc.ColorBlendDesc[1].BlendEnable = FALSE;
+		desc.ColorAttachmentDesc[1].Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
+		desc.ColorAttachmentDesc[1].Format = TextureFormat::TEXTURE_FORMAT_RG16_FLOAT;
+		desc.ColorAttachmentDesc[1].Width = settings.RenderResolution.x;
+		desc.ColorAttachmentDesc[1].Height = settings.RenderResolution.y;
+
+		desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH;
+		desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.DepthAttachmentDesc.Width = settings.RenderResolution.x;
+		desc.DepthAttachmentDesc.Height = settings.RenderResolution.y;
+
+		desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_EQUAL;
+
+		// Need to mark the bindless descriptor range as DESCRIPTORS_VOLATILE since it will contain empty descriptors
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[2] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(9);
+		desc.RootParameters[0].InitAsConstantBufferView(0); // Global constant buffer
+		desc.RootParameters[1].InitAsConstantBufferView(1); // Scene data constant buffer
+		desc.RootParameters[2].InitAsConstantBufferView(2); // Material constant buffer
+		desc.RootParameters[3].InitAsConstantBufferView(3); // Light constant buffer
+		desc.RootParameters[4].InitAsDescriptorTable(_countof(ranges), &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL); // Bindless SRV table
+		desc.RootParameters[5].InitAsConstantBufferView(4, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Light cluster constant buffer
+		desc.RootParameters[6].InitAsShaderResourceView(0, 2, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Cluster light counts
+		desc.RootParameters[7].InitAsShaderResourceView(1, 2, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Cluster light indices
+		desc.RootParameters[8].InitAsShaderResourceView(2, 2, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_PIXEL); // Instance light indices
+
+		desc.ShaderInputLayout.push_back({ "POSITION", 0, positionFormat, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 2, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 2, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 2, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 2, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 80, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 96, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 112, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "MATERIAL_ID", 0, DXGI_FORMAT_R32_UINT, 1, 128, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "LIGHT_LIST", 0, DXGI_FORMAT_R32G32_UINT, 1, 132, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_SCALE", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 140, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+		desc.ShaderInputLayout.push_back({ "POSITION_OFFSET", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, 152, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
+
+		// Materials without normal or metallic roughness textures skip the samples, frames without unshadowed lights skip the checks for them
+		desc.PixelShaderPermutations = ShaderPermutation::GetLightingManifest();
+
+		m_RenderPasses[RenderPassType::LIGHTING] = std::make_unique<RasterPass>("Lighting", desc);
+
+		// Transparent geometry has no depth pre-pass, it is blended back to front over the depth of the opaque and masked geometry without writing it
+		desc.ColorBlendDesc[0].BlendEnable = TRUE;
+		desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_LESS;
+		desc.DepthWriteEnabled = false;
+
+		m_RenderPasses[RenderPassType::LIGHTING_TRANSPARENT] = std::make_unique<RasterPass>("Lighting (transparent)", desc);
+	}
+
+	{
+		// Light clustering pass
+		ComputePassDesc desc;
+		desc.ComputeShaderPath = "Resources/Shaders/LightClustering_CS.hlsl";
+		desc.NumThreadsX = 64;
+		desc.NumThreadsY = 1;
+		desc.NumThreadsZ = 1;
+
+		desc.RootParameters.resize(4);
+		desc.RootParameters[0].InitAsConstantBufferView(0); // Light cluster constant buffer
+		desc.RootParameters[1].InitAsShaderResourceView(0); // View space light spheres
+		desc.RootParameters[2].InitAsUnorderedAccessView(0); // Cluster light counts (dest)
+		desc.RootParameters[3].InitAsUnorderedAccessView(1); // Cluster light indices (dest)
+
+		m_ComputePasses[ComputePassType::LIGHT_CLUSTERING] = std::make_unique<ComputePass>("Light clustering", desc);
+	}
+
+	{
+		// Temporal anti-aliasing pass
+		ComputePassDesc desc;
+		desc.ComputeShaderPath = "Resources/Shaders/TemporalAA_CS.hlsl";
+		desc.NumThreadsX = 64;
+		desc.NumThreadsY = 64;
+		desc.NumThreadsZ = 1;
+
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[6] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 2, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[3].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 3, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[4].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 4, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[5].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(7);
+		desc.RootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE); // Global constant buffer
+		desc.RootParameters[1].InitAsDescriptorTable(1, &ranges[0]); // HDR color target (current frame)
+		desc.RootParameters[2].InitAsDescriptorTable(1, &ranges[1]); // Depth target (current frame)
+		desc.RootParameters[3].InitAsDescriptorTable(1, &ranges[2]); // Velocity target (current frame)
+		desc.RootParameters[4].InitAsDescriptorTable(1, &ranges[3]); // Velocity target previous (last frame)
+		desc.RootParameters[5].InitAsDescriptorTable(1, &ranges[4]); // TAA history (accumulated last frames)
+		desc.RootParameters[6].InitAsDescriptorTable(1, &ranges[5]); // TAA resolve target (dest)
+
+		m_ComputePasses[ComputePassType::TEMPORAL_ANTI_ALIASING] = std::make_unique<ComputePass>("Temporal anti-aliasing", desc);
+	}
+
+	{
+		// Tonemapping render pass
+		ComputePassDesc desc;
+		desc.ComputeShaderPath = "Resources/Shaders/PostProcess_CS.hlsl";
+		desc.NumThreadsX = 64;
+		desc.NumThreadsY = 64;
+		desc.NumThreadsZ = 1;
+
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[2] = {};
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+		ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
+
+		desc.RootParameters.resize(3);
+		desc.RootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE); // Global constant buffer
+		desc.RootParameters[1].InitAsDescriptorTable(1, &ranges[0]); // Source texture
+		desc.RootParameters[2].InitAsDescriptorTable(1, &ranges[1]); // SDR color target (dest)
+
+		m_ComputePasses[ComputePassType::POST_PROCESS] = std::make_unique<ComputePass>("Post-process", desc);
+	}
+}
+
+void D3D12RenderBackend::CreateRenderTargets(const RenderSettings& settings)
+{
+	m_RenderResolution = settings.RenderResolution;
+
+	{
+		// Depth pre-pass depth target
+		TextureDesc desc = {};
+		desc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
+		desc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.Width = settings.RenderResolution.x;
+		desc.Height = settings.RenderResolution.y;
+		desc.ClearColor = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+		desc.DebugName = "Depth pre-pass depth target";
+
+		m_DepthPrepassDepthTarget = std::make_unique<Texture>(desc);
+	}
+
+	{
+		// HDR color target, TAA resolve target, TAA history
+		TextureDesc desc = {};
+		desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
+		desc.Format = TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT;
+		desc.Width = settings.RenderResolution.x;
+		desc.Height = settings.RenderResolution.y;
+		desc.DebugName = "HDR color target";
+
+		m_HDRColorTarget = std::make_unique<Texture>(desc);
+
+		desc.Usage = TextureUsage::TEXTURE_USAGE_READ | TextureUsage::TEXTURE_USAGE_WRITE;
+		desc.DebugName = "TAA resolve target";
+		m_TAAResolveTarget = std::make_unique<Texture>(desc);
+
+		desc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+		desc.DebugName = "TAA history";
+		m_TAAHistory = std::make_unique<Texture>(desc);
+	}
+
+	{
+		// SDR color target
+		TextureDesc desc = {};
+		desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_WRITE;
+		desc.Format = TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM;
+		desc.Width = settings.RenderResolution.x;
+		desc.Height = settings.RenderResolution.y;
+		desc.DebugName = "SDR color target";
+
+		m_SDRColorTarget = std::make_unique<Texture>(desc);
+	}
+
+	{
+		// Velocity target
+		TextureDesc desc = {};
+		desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
+		desc.Format = TextureFormat::TEXTURE_FORMAT_RG16_FLOAT;
+		desc.Width = settings.RenderResolution.x;
+		desc.Height = settings.RenderResolution.y;
+		desc.DebugName = "Velocity target";
+
+		m_VelocityTarget = std::make_unique<Texture>(desc);
+
+		desc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+		desc.DebugName = "Velocity target previous";
+
+		m_VelocityTargetPrevious = std::make_unique<Texture>(desc);
+	}
+
+	{
+		// Shadow atlas, the static layer is only created while shadow caching is enabled
+		TextureDesc desc = {};
+		desc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
+		desc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
+		desc.Width = settings.ShadowAtlas.AtlasResolution;
+		desc.Height = settings.ShadowAtlas.AtlasResolution;
+		desc.ClearColor = glm::vec4(0.0f);
+		desc.MemoryCategory = GPU_MEMORY_CATEGORY_SHADOW_MAPS;
+		desc.DebugName = "Shadow atlas";
+
+		m_ShadowAtlas = std::make_unique<Texture>(desc);
+	}
+}
+
+bool D3D12RenderBackend::ArePipelineStatesReady() const
+{
+	for (const auto& renderPass : m_RenderPasses)
+	{
+		if (!renderPass->IsReady())
+			return false;
+	}
+
+	for (const auto& computePass : m_ComputePasses)
+	{
+		if (!computePass->IsReady())
+			return false;
+	}
+
+	return true;
+}
+
+void D3D12RenderBackend::CreateRenderBuffer(RenderBufferType type, const BufferDesc& desc)
+{
+	m_RenderBuffers[static_cast<uint32_t>(type)] = std::make_unique<Buffer>(desc);
+}
+
+void D3D12RenderBackend::WriteRenderBuffer(RenderBufferType type, const void* data, std::size_t byteSize, std::size_t byteOffset)
+{
+	GetRenderBuffer(type).SetBufferDataAtOffset(data, byteSize, byteOffset);
+}
+
+std::size_t D3D12RenderBackend::GetRenderBufferCopyOffset(RenderBufferType type, uint32_t sceneTableCopyIndex)
+{
+	// Buffers that are rewritten every frame hold one equally sized copy per back buffer
+	const BufferDesc& desc = GetRenderBuffer(type).GetBufferDesc();
+	return sceneTableCopyIndex * (desc.NumElements / RenderState::BACK_BUFFER_COUNT) * desc.ElementSize;
+}
+
+void* D3D12RenderBackend::CreateBuffer(const BufferDesc& desc)
+{
+	Resource* buffer = new Buffer(desc);
+	return buffer;
+}
+
+void* D3D12RenderBackend::CreateTexture(const TextureDesc& desc)
+{
+	Resource* texture = new Texture(desc);
+	return texture;
+}
+
+void D3D12RenderBackend::ReleaseResource(void* resource)
+{
+	// Pending uploads still point at the resource
+	D3D12Backend::WaitForUpload(ToResource(resource)->GetUploadTicket());
+	delete ToResource(resource);
+}
+
+bool D3D12RenderBackend::IsResourceReady(void* resource) const
+{
+	return ToResource(resource)->IsValid() && ToResource(resource)->IsReady();
+}
+
+uint32_t D3D12RenderBackend::GetTextureIndex(void* texture) const
+{
+	return ToResource(texture)->GetDescriptorHeapIndex(DescriptorType::SRV);
+}
+
+uint32_t D3D12RenderBackend::GetShadowAtlasIndex() const
+{
+	return m_ShadowAtlas->GetDescriptorHeapIndex(DescriptorType::SRV);
+}
+
+void D3D12RenderBackend::BeginCommandList()
+{
+	m_CommandList = D3D12Backend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+}
+
+void D3D12RenderBackend::ExecuteCommandList()
+{
+	D3D12Backend::ExecuteCommandList(m_CommandList);
+	m_CommandList.reset();
+}
+
+void D3D12RenderBackend::BeginGPUZone(uint32_t zoneID)
+{
+	m_CommandList->BeginGPUZone(zoneID);
+}
+
+void D3D12RenderBackend::EndGPUZone()
+{
+	m_CommandList->EndGPUZone();
+}
+
+void D3D12RenderBackend::BindRenderPass(RenderPassType pass, uint32_t sceneTableCopyIndex)
+{
+	CommandList& commandList = *m_CommandList;
+	auto& bindlessDescriptorHeap = D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	std::size_t materialTableOffset = sceneTableCopyIndex * GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS).GetBufferDesc().ElementSize;
+
+	switch (pass)
+	{
+	case RenderPassType::SHADOW_MAPPING:
+	{
+		commandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessDescriptorHeap);
+		commandList.SetRenderPassBindables(*m_RenderPasses[pass]);
+		break;
+	}
+	case RenderPassType::SHADOW_MAPPING_MASKED:
+	{
+		// Masked casters alpha test with the material of their instance, the light VP is set after binding
+		commandList.SetRenderPassBindables(*m_RenderPasses[pass]);
+		commandList.SetRootConstantBufferView(1, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS), materialTableOffset, D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootDescriptorTable(2, bindlessDescriptorHeap.GetGPUBaseDescriptor());
+		break;
+	}
+	case RenderPassType::SHADOW_COMPOSE:
+	{
+		commandList.Transition(*m_ShadowAtlasStaticLayer, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		commandList.SetRenderPassBindables(*m_RenderPasses[pass]);
+
+		uint32_t staticLayerIndex = m_ShadowAtlasStaticLayer->GetDescriptorHeapIndex(DescriptorType::SRV);
+		commandList.SetRootConstants(0, 1, &staticLayerIndex, 0);
+		commandList.SetRootDescriptorTable(1, bindlessDescriptorHeap.GetGPUBaseDescriptor());
+		return;
+	}
+	case RenderPassType::DEPTH_PREPASS:
+	case RenderPassType::DEPTH_PREPASS_MASKED:
+	{
+		commandList.Transition(*m_DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+		commandList.SetRenderPassBindables(*m_RenderPasses[pass]);
+		SetRenderResolutionViewport();
+
+		D3D12_CPU_DESCRIPTOR_HANDLE dsv = m_DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
+		commandList.SetRenderTargets(0, nullptr, &dsv);
+
+		commandList.SetRootConstantBufferView(0, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS), D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootConstantBufferView(1, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_SCENE_DATA), D3D12_RESOURCE_STATE_COMMON);
+
+		// Masked geometry samples the albedo alpha of its material
+		if (pass == RenderPassType::DEPTH_PREPASS_MASKED)
+		{
+			commandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessDescriptorHeap);
+			commandList.SetRootConstantBufferView(2, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS), materialTableOffset, D3D12_RESOURCE_STATE_COMMON);
+			commandList.SetRootDescriptorTable(3, bindlessDescriptorHeap.GetGPUBaseDescriptor());
+		}
+		break;
+	}
+	case RenderPassType::LIGHTING:
+	case RenderPassType::LIGHTING_TRANSPARENT:
+	{
+		// Transition the shadow atlas to the pixel shader resource state
+		commandList.Transition(*m_ShadowAtlas, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+		commandList.Transition(GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		commandList.Transition(GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		commandList.Transition(*m_HDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		commandList.Transition(*m_VelocityTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+		commandList.Transition(*m_DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+		// Set bindless descriptor heap
+		commandList.SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessDescriptorHeap);
+
+		// Bind render pass bindables (sets pipeline state, root signature and primitive topology)
+		commandList.SetRenderPassBindables(*m_RenderPasses[pass]);
+		SetRenderResolutionViewport();
+
+		D3D12_CPU_DESCRIPTOR_HANDLE rtvs[] = {
+			m_HDRColorTarget->GetDescriptor(DescriptorType::RTV),
+			m_VelocityTarget->GetDescriptor(DescriptorType::RTV)
+		};
+		D3D12_CPU_DESCRIPTOR_HANDLE dsv = m_DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
+		commandList.SetRenderTargets(2, rtvs, &dsv);
+
+		// Set root CBV for constant buffers
+		commandList.SetRootConstantBufferView(0, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS), D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootConstantBufferView(1, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_SCENE_DATA), D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootConstantBufferView(2, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS), materialTableOffset, D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootConstantBufferView(3, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHTS), D3D12_RESOURCE_STATE_COMMON);
+
+		// Set root descriptor table for bindless CBV_SRV_UAV descriptor array
+		commandList.SetRootDescriptorTable(4, bindlessDescriptorHeap.GetGPUBaseDescriptor());
+
+		// Set the light cluster grid and the per cluster light lists
+		commandList.SetRootConstantBufferView(5, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS),
+			GetRenderBufferCopyOffset(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS, sceneTableCopyIndex), D3D12_RESOURCE_STATE_COMMON);
+		commandList.SetRootShaderResourceView(6, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		commandList.SetRootShaderResourceView(7, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+		commandList.SetRootShaderResourceView(8, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_INSTANCE_LIGHT_INDICES),
+			GetRenderBufferCopyOffset(RenderBufferType::RENDER_BUFFER_TYPE_INSTANCE_LIGHT_INDICES, sceneTableCopyIndex), D3D12_RESOURCE_STATE_GENERIC_READ);
+		break;
+	}
+	default:
+		ASSERT(false, "Render pass cannot be bound");
+		return;
+	}
+
+	// Instances are drawn from the instance table, draws pass the instance of the table copy of the current back buffer
+	commandList.SetVertexBuffers(1, 1, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MESH_INSTANCES));
+}
+
+void D3D12RenderBackend::SetPipelineVariant(RenderPassType pass, uint32_t variant)
+{
+	m_CommandList->SetPipelineState(*m_RenderPasses[pass], variant);
+}
+
+void D3D12RenderBackend::SetViewProjection(const glm::mat4& viewProjection)
+{
+	m_CommandList->SetRootConstants(0, 16, &viewProjection[0][0], 0);
+}
+
+void D3D12RenderBackend::DrawMesh(void* positionBuffer, void* attributeBuffer, void* indexBuffer, uint32_t numIndices, uint32_t instance)
+{
+	m_CommandList->SetVertexBuffers(0, 1, ToBuffer(positionBuffer));
+	if (attributeBuffer)
+		m_CommandList->SetVertexBuffers(2, 1, ToBuffer(attributeBuffer));
+	m_CommandList->SetIndexBuffer(ToBuffer(indexBuffer));
+
+	m_CommandList->DrawIndexed(numIndices, 1, 0, 0, instance);
+}
+
+void D3D12RenderBackend::BeginShadowAtlasLayer(ShadowAtlasLayer layer)
+{
+	m_CommandList->Transition(GetShadowAtlasLayer(layer), D3D12_RESOURCE_STATE_DEPTH_WRITE);
+}
+
+void D3D12RenderBackend::ClearShadowAtlasTiles(ShadowAtlasLayer layer, const std::vector<ShadowAtlasTile>& tiles)
+{
+	if (tiles.empty())
+		return;
+
+	m_ShadowAtlasClearRects.clear();
+	for (const ShadowAtlasTile& tile : tiles)
+		m_ShadowAtlasClearRects.push_back(CD3DX12_RECT(tile.X, tile.Y, tile.X + tile.Size, tile.Y + tile.Size));
+
+	m_CommandList->ClearDepthStencilView(GetShadowAtlasLayer(layer).GetDescriptor(DescriptorType::DSV), 0.0f,
+		static_cast<uint32_t>(m_ShadowAtlasClearRects.size()), m_ShadowAtlasClearRects.data());
+}
+
+void D3D12RenderBackend::SetShadowAtlasTile(ShadowAtlasLayer layer, const ShadowAtlasTile& tile)
+{
+	CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(static_cast<float>(tile.X), static_cast<float>(tile.Y),
+		static_cast<float>(tile.Size), static_cast<float>(tile.Size), 0.0f, 1.0f);
+	D3D12_RECT scissorRect = CD3DX12_RECT(tile.X, tile.Y, tile.X + tile.Size, tile.Y + tile.Size);
+
+	m_CommandList->SetViewports(1, &viewport);
+	m_CommandList->SetScissorRects(1, &scissorRect);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE dsv = GetShadowAtlasLayer(layer).GetDescriptor(DescriptorType::DSV);
+	m_CommandList->SetRenderTargets(0, nullptr, &dsv);
+}
+
+void D3D12RenderBackend::ComposeShadowAtlasTile(const ShadowAtlasTile& tile)
+{
+	// A fullscreen triangle covers the tile, the static layer has the same tiles as the shadow atlas
+	SetShadowAtlasTile(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC, tile);
+	m_CommandList->Draw(3, 1, 0, 0);
+}
+
+void D3D12RenderBackend::CreateShadowAtlasStaticLayer()
+{
+	TextureDesc desc = m_ShadowAtlas->GetTextureDesc();
+	desc.DebugName = "Shadow atlas static layer";
+
+	m_ShadowAtlasStaticLayer = std::make_unique<Texture>(desc);
+}
+
+void D3D12RenderBackend::ReleaseShadowAtlasStaticLayer()
+{
+	m_ShadowAtlasStaticLayer.reset();
+}
+
+void D3D12RenderBackend::DispatchLightClustering(uint32_t sceneTableCopyIndex)
+{
+	CommandList& commandList = *m_CommandList;
+	const ComputePass& lightClusteringPass = *m_ComputePasses[ComputePassType::LIGHT_CLUSTERING];
+
+	commandList.Transition(GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+	commandList.Transition(GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES), D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	commandList.GetGraphicsCommandList()->SetComputeRootSignature(lightClusteringPass.GetD3D12RootSignature().Get());
+	commandList.GetGraphicsCommandList()->SetPipelineState(lightClusteringPass.GetD3D12PipelineState());
+
+	commandList.GetGraphicsCommandList()->SetComputeRootConstantBufferView(0, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS).GetD3D12Resource()->GetGPUVirtualAddress() +
+		GetRenderBufferCopyOffset(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS, sceneTableCopyIndex));
+	commandList.GetGraphicsCommandList()->SetComputeRootShaderResourceView(1, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_SPHERES).GetD3D12Resource()->GetGPUVirtualAddress() +
+		GetRenderBufferCopyOffset(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_SPHERES, sceneTableCopyIndex));
+	commandList.GetGraphicsCommandList()->SetComputeRootUnorderedAccessView(2, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS).GetD3D12Resource()->GetGPUVirtualAddress());
+	commandList.GetGraphicsCommandList()->SetComputeRootUnorderedAccessView(3, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES).GetD3D12Resource()->GetGPUVirtualAddress());
+
+	commandList.GetGraphicsCommandList()->Dispatch(MathHelper::AlignUp(LIGHT_CLUSTER_COUNT, 64) / 64, 1, 1);
+}
+
+void D3D12RenderBackend::ReadBackLightClusters(LightClusterLists& outLists)
+{
+	// Copy the GPU lists to readback buffers and wait for them
+	BufferDesc desc = {};
+	desc.Usage = BufferUsage::BUFFER_USAGE_READBACK;
+	desc.ElementSize = sizeof(uint32_t);
+	desc.NumElements = LIGHT_CLUSTER_COUNT;
+	desc.DebugName = "Cluster light count readback buffer";
+	Buffer countReadback(desc);
+
+	desc.NumElements = LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS;
+	desc.DebugName = "Cluster light index readback buffer";
+	Buffer indexReadback(desc);
+
+	m_CommandList->CopyResource(countReadback, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS));
+	m_CommandList->CopyResource(indexReadback, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES));
+	D3D12Backend::ExecuteCommandListAndWait(m_CommandList);
+	m_CommandList.reset();
+
+	outLists.LightCounts.resize(LIGHT_CLUSTER_COUNT);
+	outLists.LightIndices.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+	countReadback.ReadBackData(outLists.LightCounts.data(), outLists.LightCounts.size() * sizeof(uint32_t));
+	indexReadback.ReadBackData(outLists.LightIndices.data(), outLists.LightIndices.size() * sizeof(uint32_t));
+}
+
+void D3D12RenderBackend::ResolveTemporalAA(bool enableTAA)
+{
+	CommandList& commandList = *m_CommandList;
+
+	if (enableTAA)
+	{
+		const ComputePass& taaPass = *m_ComputePasses[ComputePassType::TEMPORAL_ANTI_ALIASING];
+
+		// Transition sdr history and sdr target into correct states
+		commandList.Transition(*m_HDRColorTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.Transition(*m_DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.Transition(*m_VelocityTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.Transition(*m_VelocityTargetPrevious, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.Transition(*m_TAAHistory, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+		commandList.Transition(*m_TAAResolveTarget, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+		commandList.GetGraphicsCommandList()->SetComputeRootSignature(taaPass.GetD3D12RootSignature().Get());
+		commandList.GetGraphicsCommandList()->SetPipelineState(taaPass.GetD3D12PipelineState());
+
+		ID3D12DescriptorHeap* const heaps = { D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetD3D12DescriptorHeap().Get() };
+		commandList.GetGraphicsCommandList()->SetDescriptorHeaps(1, &heaps);
+
+		commandList.GetGraphicsCommandList()->SetComputeRootConstantBufferView(0, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS).GetD3D12Resource()->GetGPUVirtualAddress());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(1, m_HDRColorTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(2, m_DepthPrepassDepthTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(3, m_VelocityTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(4, m_VelocityTargetPrevious->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(5, m_TAAHistory->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+		commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(6, m_TAAResolveTarget->GetDescriptorAllocation(DescriptorType::UAV).GetGPUDescriptorHandle());
+
+		uint32_t threadX = MathHelper::AlignUp(m_RenderResolution.x, 8) / 8;
+		uint32_t threadY = MathHelper::AlignUp(m_RenderResolution.y, 8) / 8;
+		commandList.GetGraphicsCommandList()->Dispatch(threadX, threadY, 1);
+	}
+	else
+	{
+		commandList.CopyResource(*m_TAAResolveTarget, *m_HDRColorTarget);
+	}
+
+	// Update TAA history with the current TAA resolve
+	commandList.CopyResource(*m_TAAHistory, *m_TAAResolveTarget);
+}
+
+void D3D12RenderBackend::PostProcess(DebugShowTextureMode debugShowTextureMode)
+{
+	CommandList& commandList = *m_CommandList;
+	const ComputePass& postProcessPass = *m_ComputePasses[ComputePassType::POST_PROCESS];
+
+	// Transition the HDR render target to pixel shader resource state
+	commandList.Transition(*m_TAAResolveTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
+	commandList.Transition(*m_SDRColorTarget, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	commandList.GetGraphicsCommandList()->SetComputeRootSignature(postProcessPass.GetD3D12RootSignature().Get());
+	commandList.GetGraphicsCommandList()->SetPipelineState(postProcessPass.GetD3D12PipelineState());
+
+	ID3D12DescriptorHeap* const heaps = { D3D12Backend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetD3D12DescriptorHeap().Get() };
+	commandList.GetGraphicsCommandList()->SetDescriptorHeaps(1, &heaps);
+
+	commandList.GetGraphicsCommandList()->SetComputeRootConstantBufferView(0, GetRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS).GetD3D12Resource()->GetGPUVirtualAddress());
+	commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(1, GetDebugShowTextureModeTexture(debugShowTextureMode).GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
+	commandList.GetGraphicsCommandList()->SetComputeRootDescriptorTable(2, m_SDRColorTarget->GetDescriptorAllocation(DescriptorType::UAV).GetGPUDescriptorHandle());
+
+	uint32_t threadX = MathHelper::AlignUp(m_RenderResolution.x, 8) / 8;
+	uint32_t threadY = MathHelper::AlignUp(m_RenderResolution.y, 8) / 8;
+	commandList.GetGraphicsCommandList()->Dispatch(threadX, threadY, 1);
+}
+
+void D3D12RenderBackend::SetOverlayRenderTargets(CommandList& commandList)
+{
+	commandList.Transition(*m_SDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	commandList.Transition(*m_DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_SDRColorTarget->GetDescriptor(DescriptorType::RTV);
+	D3D12_CPU_DESCRIPTOR_HANDLE dsv = m_DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
+	commandList.SetRenderTargets(1, &rtv, &dsv);
+}
+
+Texture& D3D12RenderBackend::GetShadowAtlasLayer(ShadowAtlasLayer layer)
+{
+	ASSERT(layer == ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC || m_ShadowAtlasStaticLayer, "The static shadow atlas layer does not exist");
+	return layer == ShadowAtlasLayer::SHADOW_ATLAS_LAYER_STATIC ? *m_ShadowAtlasStaticLayer : *m_ShadowAtlas;
+}
+
+const Texture& D3D12RenderBackend::GetDebugShowTextureModeTexture(DebugShowTextureMode mode) const
+{
+	switch (mode)
+	{
+	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_DEFAULT:
+		return *m_TAAResolveTarget;
+	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_TAA_RESOLVE:
+		return *m_TAAResolveTarget;
+	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_TAA_HISTORY:
+		return *m_TAAHistory;
+	case DebugShowTextureMode::DEBUG_SHOW_TEXTURE_MODE_VELOCITY:
+		return *m_VelocityTarget;
+	default:
+		return *m_TAAResolveTarget;
+	}
+}
+
+void D3D12RenderBackend::SetRenderResolutionViewport()
+{
+	CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, static_cast<float>(m_RenderResolution.x),
+		static_cast<float>(m_RenderResolution.y), 0.0f, 1.0f);
+	CD3DX12_RECT scissorRect = CD3DX12_RECT(0.0f, 0.0f, LONG_MAX, LONG_MAX);
+
+	m_CommandList->SetViewports(1, &viewport);
+	m_CommandList->SetScissorRects(1, &scissorRect);
+}
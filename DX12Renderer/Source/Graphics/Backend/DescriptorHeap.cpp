@@ -1,6 +1,6 @@
 #include "Pch.h"
 #include "Graphics/Backend/DescriptorHeap.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 DescriptorHeap::DescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDescriptors)
     : m_Type(type), m_NumDescriptors(numDescriptors)
@@ -12,10 +12,12 @@ DescriptorHeap::DescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDesc
     // Set the flag to shader visible if the descriptor heap is of type CBV_SRV_UAV for bindless rendering
     heapDesc.Flags = type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 
-    auto d3d12Device = RenderBackend::GetD3D12Device();
+    auto d3d12Device = D3D12Backend::GetD3D12Device();
 
     DX_CALL(d3d12Device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_d3d12DescriptorHeap)));
     m_DescriptorHandleIncrementSize = d3d12Device->GetDescriptorHandleIncrementSize(type);
+    m_MemoryTrackerID = MemoryTracker::AddGPUResource("Descriptor heap (type " + std::to_string(type) + ")", GPU_MEMORY_CATEGORY_DESCRIPTOR_HEAPS,
+        static_cast<uint64_t>(m_NumDescriptors) * m_DescriptorHandleIncrementSize);
 
     m_CPUBaseDescriptor = m_d3d12DescriptorHeap->GetCPUDescriptorHandleForHeapStart();
 
@@ -25,6 +27,7 @@ DescriptorHeap::DescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t numDesc
 
 DescriptorHeap::~DescriptorHeap()
 {
+    MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
 }
 
 DescriptorAllocation DescriptorHeap::Allocate(uint32_t numDescriptors)
@@ -0,0 +1,133 @@
+#include "Pch.h"
+#include "Graphics/Backend/GPUProfiler.h"
+
+GPUProfiler::GPUProfiler(std::unique_ptr<GPUProfilerQuerySource> source, uint32_t numFramesInFlight, uint32_t numQueriesPerFrame)
+	: m_Source(std::move(source)), m_NumRequiredQueries(numQueriesPerFrame)
+{
+	m_Frames.resize(numFramesInFlight);
+}
+
+uint32_t GPUProfiler::RegisterZone(const std::string& name)
+{
+	auto iter = m_ZoneIDs.find(name);
+	if (iter != m_ZoneIDs.end())
+		return iter->second;
+
+	uint32_t zoneID = static_cast<uint32_t>(m_ZoneNames.size());
+	m_ZoneNames.emplace_back(name.data(), name.size());
+	m_ZoneIDs.emplace(name, zoneID);
+
+	return zoneID;
+}
+
+const char* GPUProfiler::GetZoneName(uint32_t zoneID) const
+{
+	return zoneID < m_ZoneNames.size() ? m_ZoneNames[zoneID].c_str() : "";
+}
+
+void GPUProfiler::BeginFrame(uint32_t frameIndex)
+{
+	ASSERT(m_OpenZones.empty(), "A GPU zone is still open at the beginning of a frame");
+	m_OpenZones.clear();
+	m_NumOpenRecordedZones = 0;
+
+	m_CurrentFrame = frameIndex;
+	FrameQueries& frame = m_Frames[frameIndex];
+	ResolveFrame(frame);
+
+	frame.Records.clear();
+	frame.NumQueries = 0;
+
+	if (frame.Capacity < m_NumRequiredQueries)
+	{
+		frame.Capacity = m_NumRequiredQueries;
+		m_Source->ResizeQueries(frameIndex, frame.Capacity);
+	}
+}
+
+uint32_t GPUProfiler::BeginZone(uint32_t zoneID)
+{
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+
+	// Every open zone keeps a query for its end, so ends never run out
+	uint32_t numRequired = frame.NumQueries + m_NumOpenRecordedZones + 2;
+	if (numRequired > frame.Capacity)
+	{
+		m_NumRequiredQueries = std::max(m_NumRequiredQueries, numRequired);
+		m_NumDroppedZones++;
+		m_OpenZones.push_back(GPU_PROFILER_INVALID_QUERY);
+		return GPU_PROFILER_INVALID_QUERY;
+	}
+
+	ZoneRecord& record = frame.Records.emplace_back();
+	record.ZoneID = zoneID;
+	record.Depth = static_cast<uint32_t>(m_OpenZones.size());
+	record.BeginQuery = frame.NumQueries++;
+
+	m_OpenZones.push_back(static_cast<uint32_t>(frame.Records.size() - 1));
+	m_NumOpenRecordedZones++;
+
+	return record.BeginQuery;
+}
+
+uint32_t GPUProfiler::EndZone()
+{
+	ASSERT(!m_OpenZones.empty(), "A GPU zone was ended that has not been begun");
+	if (m_OpenZones.empty())
+		return GPU_PROFILER_INVALID_QUERY;
+
+	uint32_t recordIndex = m_OpenZones.back();
+	m_OpenZones.pop_back();
+
+	if (recordIndex == GPU_PROFILER_INVALID_QUERY)
+		return GPU_PROFILER_INVALID_QUERY;
+
+	FrameQueries& frame = m_Frames[m_CurrentFrame];
+	frame.Records[recordIndex].EndQuery = frame.NumQueries++;
+	m_NumOpenRecordedZones--;
+
+	return frame.Records[recordIndex].EndQuery;
+}
+
+GPUProfilerStatistics GPUProfiler::GetStatistics() const
+{
+	GPUProfilerStatistics stats;
+	stats.NumRegisteredZones = static_cast<uint32_t>(m_ZoneNames.size());
+	stats.NumZones = static_cast<uint32_t>(m_Zones.size());
+	stats.NumQueriesPerFrame = m_NumRequiredQueries;
+	stats.NumDroppedZones = m_NumDroppedZones;
+
+	return stats;
+}
+
+void GPUProfiler::ResolveFrame(FrameQueries& frame)
+{
+	m_Zones.clear();
+	if (frame.NumQueries == 0)
+		return;
+
+	m_Timestamps.resize(frame.NumQueries);
+	m_Source->ReadTimestamps(m_CurrentFrame, frame.NumQueries, m_Timestamps.data());
+
+	// The calibration is sampled after the frame completed, so the zones lie before it on both clocks
+	GPUClockCalibration calibration = m_Source->GetClockCalibration();
+	double nanosecondsPerTick = 1000000000.0 / static_cast<double>(m_Source->GetTimestampFrequency());
+
+	for (const ZoneRecord& record : frame.Records)
+	{
+		if (record.EndQuery == GPU_PROFILER_INVALID_QUERY)
+			continue;
+
+		uint64_t beginTimestamp = m_Timestamps[record.BeginQuery];
+		uint64_t endTimestamp = m_Timestamps[record.EndQuery];
+
+		// Zones lie before the calibration, so the offset is negative
+		double beginOffset = static_cast<double>(static_cast<int64_t>(beginTimestamp - calibration.GPUTimestamp)) * nanosecondsPerTick;
+
+		ProfilerGPUZone& zone = m_Zones.emplace_back();
+		zone.Name = GetZoneName(record.ZoneID);
+		zone.Depth = record.Depth;
+		zone.BeginTime = calibration.CPUTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::nano>(beginOffset));
+		zone.Duration = endTimestamp > beginTimestamp ? static_cast<float>(static_cast<double>(endTimestamp - beginTimestamp) * nanosecondsPerTick / 1000000.0) : 0.0f;
+	}
+}
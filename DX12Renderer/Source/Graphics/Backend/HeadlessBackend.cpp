@@ -0,0 +1,723 @@
+#include "Pch.h"
+#include "Graphics/Backend/HeadlessBackend.h"
+#include "Graphics/LightClustering.h"
+#include "Graphics/RenderState.h"
+
+static_assert(HEADLESS_FRAMES_IN_FLIGHT == RenderState::BACK_BUFFER_COUNT, "The headless backend keeps a copy of the per frame data for every back buffer");
+
+// Render buffers that are rewritten every frame hold one equally sized copy per back buffer
+static std::size_t GetRenderBufferCopyOffset(const HeadlessResource& buffer, uint32_t sceneTableCopyIndex)
+{
+	return sceneTableCopyIndex * (buffer.Memory.size() / HEADLESS_FRAMES_IN_FLIGHT);
+}
+
+class HeadlessUploadQueueBackend : public UploadQueueBackend
+{
+public:
+	HeadlessUploadQueueBackend(std::size_t stagingByteSize)
+		: m_StagingMemory(stagingByteSize)
+	{
+		m_MemoryTrackerID = MemoryTracker::AddGPUResource("Upload queue staging buffer", GPU_MEMORY_CATEGORY_UPLOAD, stagingByteSize);
+	}
+
+	virtual ~HeadlessUploadQueueBackend()
+	{
+		MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
+	}
+
+	virtual uint8_t* GetStagingMemory() override { return m_StagingMemory.data(); }
+	virtual std::size_t GetStagingByteSize() const override { return m_StagingMemory.size(); }
+
+	// Same alignment rules as D3D12, so the upload queue splits and pads the same way it does on the GPU backend
+	virtual std::size_t GetTextureRowPitchAlignment() const override { return 256; }
+	virtual std::size_t GetTextureSliceAlignment() const override { return 512; }
+
+	virtual void BeginBatch() override
+	{
+	}
+
+	virtual void RecordCopy(const UploadRequest& request, const UploadSlice& slice) override
+	{
+		HeadlessResource* resource = static_cast<HeadlessResource*>(request.Destination);
+		const uint8_t* staging = m_StagingMemory.data() + slice.StagingOffset;
+
+		if (request.Type == UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER)
+		{
+			memcpy(resource->Memory.data() + slice.ByteOffset, staging, slice.NumBytes);
+			return;
+		}
+
+		for (uint32_t row = 0; row < slice.NumRows; ++row)
+		{
+			memcpy(resource->Memory.data() + (slice.FirstRow + row) * resource->RowPitch, staging + row * slice.StagingRowPitch, resource->RowPitch);
+		}
+	}
+
+	virtual uint64_t SubmitBatch() override
+	{
+		// Copies are done while recording, so a batch is complete as soon as it is submitted
+		m_CompletedFenceValue++;
+		return m_CompletedFenceValue;
+	}
+
+	virtual uint64_t GetCompletedFenceValue() const override { return m_CompletedFenceValue; }
+	virtual void WaitForFenceValue(uint64_t fenceValue) override {}
+
+	virtual void OnUploadComplete(UploadRequestType type, void* destination) override
+	{
+		static_cast<HeadlessResource*>(destination)->IsReady = true;
+	}
+
+private:
+	std::vector<uint8_t> m_StagingMemory;
+	uint32_t m_MemoryTrackerID = MEMORY_TRACKER_INVALID_ID;
+	std::atomic<uint64_t> m_CompletedFenceValue = 0;
+
+};
+
+/*
+
+	Timestamps of the fake GPU, which runs at a nanosecond clock in step with steady_clock and only spends time on draws.
+	Every command list starts executing when it is executed on the CPU, or when the previous one ended if that is later.
+
+*/
+class HeadlessGPUQuerySource : public GPUProfilerQuerySource
+{
+public:
+	HeadlessGPUQuerySource()
+		: m_StartTime(std::chrono::steady_clock::now())
+	{
+	}
+
+	virtual void ResizeQueries(uint32_t frameIndex, uint32_t numQueries) override
+	{
+		m_Timestamps[frameIndex].resize(numQueries);
+	}
+
+	virtual void ReadTimestamps(uint32_t frameIndex, uint32_t numQueries, uint64_t* outTimestamps) override
+	{
+		memcpy(outTimestamps, m_Timestamps[frameIndex].data(), numQueries * sizeof(uint64_t));
+	}
+
+	virtual uint64_t GetTimestampFrequency() const override { return 1000000000; }
+
+	virtual GPUClockCalibration GetClockCalibration() override
+	{
+		GPUClockCalibration calibration;
+		calibration.CPUTime = std::chrono::steady_clock::now();
+		calibration.GPUTimestamp = ToGPUTimestamp(calibration.CPUTime);
+		return calibration;
+	}
+
+	void BeginCommandList()
+	{
+		m_GPUTimestamp = std::max(m_GPUTimestamp, ToGPUTimestamp(std::chrono::steady_clock::now()));
+	}
+
+	void Draw(uint64_t numIndices)
+	{
+		// Made up cost, zones only need a duration that grows with the work in them
+		m_GPUTimestamp += 1000 + numIndices / 10;
+	}
+
+	void Dispatch(uint64_t numGroups)
+	{
+		m_GPUTimestamp += 1000 + numGroups * 10;
+	}
+
+	void WriteTimestamp(uint32_t frameIndex, uint32_t queryIndex)
+	{
+		ASSERT(queryIndex < m_Timestamps[frameIndex].size(), "Timestamp query is outside of the queries of the frame");
+		if (queryIndex < m_Timestamps[frameIndex].size())
+			m_Timestamps[frameIndex][queryIndex] = m_GPUTimestamp;
+	}
+
+private:
+	uint64_t ToGPUTimestamp(std::chrono::steady_clock::time_point time) const
+	{
+		// The fake GPU clock does not start at zero, so code that assumes both clocks share an origin shows up wrong
+		const uint64_t gpuClockOrigin = 1ull << 40;
+		return gpuClockOrigin + static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_StartTime).count());
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_StartTime;
+	uint64_t m_GPUTimestamp = 0;
+	std::vector<uint64_t> m_Timestamps[HEADLESS_FRAMES_IN_FLIGHT];
+
+};
+
+void HeadlessCommandList::Reset()
+{
+	m_CommandStream.clear();
+	m_NumCommands = 0;
+}
+
+void HeadlessCommandList::SetVertexBuffer(uint32_t slot, const HeadlessResource& vertexBuffer)
+{
+	const HeadlessResource* resource = &vertexBuffer;
+	uint8_t payload[sizeof(resource) + sizeof(slot)];
+	memcpy(payload, &resource, sizeof(resource));
+	memcpy(payload + sizeof(resource), &slot, sizeof(slot));
+
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_VERTEX_BUFFER, &payload, sizeof(payload));
+}
+
+void HeadlessCommandList::SetIndexBuffer(const HeadlessResource& indexBuffer)
+{
+	const HeadlessResource* resource = &indexBuffer;
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_INDEX_BUFFER, &resource, sizeof(resource));
+}
+
+void HeadlessCommandList::SetRootConstants(const void* data, uint32_t numBytes)
+{
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_ROOT_CONSTANTS, data, numBytes);
+}
+
+void HeadlessCommandList::SetPipelineState(uint32_t pipelineState)
+{
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_PIPELINE_STATE, &pipelineState, sizeof(pipelineState));
+}
+
+void HeadlessCommandList::SetViewport(const ShadowAtlasTile& tile)
+{
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_VIEWPORT, &tile, sizeof(tile));
+}
+
+void HeadlessCommandList::ClearDepth(const std::vector<ShadowAtlasTile>& tiles)
+{
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_CLEAR_DEPTH, tiles.data(), static_cast<uint32_t>(tiles.size() * sizeof(ShadowAtlasTile)));
+}
+
+void HeadlessCommandList::Draw(uint32_t numVertices, uint32_t numInstances)
+{
+	uint32_t args[2] = { numVertices, numInstances };
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_DRAW, args, sizeof(args));
+}
+
+void HeadlessCommandList::DrawIndexed(uint32_t numIndices, uint32_t numInstances, uint32_t firstIndex, uint32_t firstInstance)
+{
+	uint32_t args[4] = { numIndices, numInstances, firstIndex, firstInstance };
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_DRAW_INDEXED, args, sizeof(args));
+}
+
+void HeadlessCommandList::Dispatch(HeadlessComputePassType pass, uint32_t numGroupsX, uint32_t numGroupsY, uint32_t numGroupsZ)
+{
+	uint32_t args[4] = { static_cast<uint32_t>(pass), numGroupsX, numGroupsY, numGroupsZ };
+	RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_DISPATCH, args, sizeof(args));
+}
+
+void HeadlessCommandList::BeginGPUZone(GPUProfiler& gpuProfiler, uint32_t zoneID)
+{
+	WriteTimestamp(gpuProfiler.BeginZone(zoneID));
+}
+
+void HeadlessCommandList::EndGPUZone(GPUProfiler& gpuProfiler)
+{
+	WriteTimestamp(gpuProfiler.EndZone());
+}
+
+void HeadlessCommandList::WriteTimestamp(uint32_t queryIndex)
+{
+	if (queryIndex != GPU_PROFILER_INVALID_QUERY)
+		RecordCommand(HeadlessCommandType::HEADLESS_COMMAND_TYPE_WRITE_TIMESTAMP, &queryIndex, sizeof(queryIndex));
+}
+
+void HeadlessCommandList::RecordCommand(HeadlessCommandType type, const void* payload, uint32_t payloadByteSize)
+{
+	CommandHeader header = { type, payloadByteSize };
+
+	std::size_t offset = m_CommandStream.size();
+	m_CommandStream.resize(offset + sizeof(CommandHeader) + payloadByteSize);
+
+	memcpy(m_CommandStream.data() + offset, &header, sizeof(CommandHeader));
+	memcpy(m_CommandStream.data() + offset + sizeof(CommandHeader), payload, payloadByteSize);
+	m_NumCommands++;
+}
+
+HeadlessBackend::HeadlessBackend(const UploadQueueDesc& uploadQueueDesc)
+{
+	m_UploadQueue = std::make_unique<UploadQueue>(std::make_unique<HeadlessUploadQueueBackend>(MEGABYTE(64)), uploadQueueDesc);
+
+	auto gpuQuerySource = std::make_unique<HeadlessGPUQuerySource>();
+	m_GPUQuerySource = gpuQuerySource.get();
+	m_GPUProfiler = std::make_unique<GPUProfiler>(std::move(gpuQuerySource), HEADLESS_FRAMES_IN_FLIGHT);
+}
+
+HeadlessBackend::~HeadlessBackend()
+{
+	// The upload worker writes into the resources, so it has to be gone before they are
+	m_UploadQueue.reset();
+
+	for (HeadlessResource* renderBuffer : m_RenderBuffers)
+	{
+		if (renderBuffer)
+			ReleaseResource(renderBuffer);
+	}
+
+	ReleaseShadowAtlasStaticLayer();
+	UntrackRenderTargets();
+}
+
+void HeadlessBackend::BeginFrame()
+{
+	m_UploadQueue->ProcessCompletions();
+	m_UploadQueue->BeginFrame();
+
+	// The headless GPU finishes every frame when it is executed, the zones of the frame in flight are resolved when it comes around again
+	m_FrameIndex = (m_FrameIndex + 1) % HEADLESS_FRAMES_IN_FLIGHT;
+	m_GPUProfiler->BeginFrame(m_FrameIndex);
+	Profiler::AddGPUZones(m_GPUProfiler->GetZones());
+}
+
+void HeadlessBackend::EndFrame()
+{
+	// Nothing to present
+}
+
+void HeadlessBackend::Flush()
+{
+	m_UploadQueue->Flush();
+}
+
+void HeadlessBackend::Resize(uint32_t width, uint32_t height)
+{
+	m_RenderResolution = { width, height };
+
+	UntrackRenderTargets();
+	TrackRenderTargets();
+}
+
+void HeadlessBackend::SetVSync(bool vSync)
+{
+}
+
+void HeadlessBackend::CreateRenderPasses(const RenderSettings& settings)
+{
+	// Pipeline states are the pass type in the high and the variant in the low 16 bits, there is nothing to create
+}
+
+void HeadlessBackend::CreateRenderTargets(const RenderSettings& settings)
+{
+	m_RenderResolution = settings.RenderResolution;
+	m_ShadowAtlasResolution = settings.ShadowAtlas.AtlasResolution;
+
+	UntrackRenderTargets();
+	TrackRenderTargets();
+}
+
+void HeadlessBackend::CreateRenderBuffer(RenderBufferType type, const BufferDesc& desc)
+{
+	HeadlessResource*& renderBuffer = m_RenderBuffers[static_cast<uint32_t>(type)];
+	if (renderBuffer)
+		ReleaseResource(renderBuffer);
+
+	renderBuffer = CreateResource(desc.NumElements * desc.ElementSize, desc.DebugName, GetBufferMemoryCategory(desc));
+	renderBuffer->IsReady = true;
+
+	if (type == RenderBufferType::RENDER_BUFFER_TYPE_MESH_INSTANCES)
+		m_NumInstanceTableEntries = desc.NumElements;
+}
+
+void HeadlessBackend::WriteRenderBuffer(RenderBufferType type, const void* data, std::size_t byteSize, std::size_t byteOffset)
+{
+	HeadlessResource* renderBuffer = m_RenderBuffers[static_cast<uint32_t>(type)];
+	ASSERT(renderBuffer && byteOffset + byteSize <= renderBuffer->Memory.size(), "Write is outside of the render buffer");
+
+	memcpy(renderBuffer->Memory.data() + byteOffset, data, byteSize);
+}
+
+void* HeadlessBackend::CreateBuffer(const BufferDesc& desc)
+{
+	HeadlessResource* buffer = CreateResource(desc.NumElements * desc.ElementSize, desc.DebugName, GetBufferMemoryCategory(desc));
+
+	if (desc.DataPtr)
+		buffer->Ticket = m_UploadQueue->UploadBuffer(buffer, desc.DataPtr, buffer->Memory.size());
+	else
+		buffer->IsReady = true;
+
+	return buffer;
+}
+
+void* HeadlessBackend::CreateTexture(const TextureDesc& desc)
+{
+	HeadlessResource* texture = m_Resources.emplace_back(std::make_unique<HeadlessResource>()).get();
+	texture->Width = desc.Width;
+	texture->Height = desc.Height;
+	texture->RowPitch = desc.Width * GetTextureFormatByteSize(desc.Format);
+	texture->Memory.resize(texture->RowPitch * desc.Height);
+	texture->DebugName = desc.DebugName;
+	texture->TextureIndex = m_NextTextureIndex++;
+	texture->MemoryTrackerID = MemoryTracker::AddGPUResource(desc.DebugName, GetTextureMemoryCategory(desc), texture->Memory.size());
+
+	m_Stats.NumTextures++;
+	m_Stats.ResourceByteSize += texture->Memory.size();
+
+	if (desc.DataPtr)
+		texture->Ticket = m_UploadQueue->UploadTexture(texture, desc.DataPtr, texture->RowPitch, texture->Height);
+	else
+		texture->IsReady = true;
+
+	return texture;
+}
+
+void HeadlessBackend::ReleaseResource(void* resource)
+{
+	HeadlessResource* headlessResource = static_cast<HeadlessResource*>(resource);
+	auto iter = std::find_if(m_Resources.begin(), m_Resources.end(), [headlessResource](const auto& other) { return other.get() == headlessResource; });
+	ASSERT(iter != m_Resources.end(), "Released a resource that was not created by this backend");
+	if (iter == m_Resources.end())
+		return;
+
+	// The upload worker may still be copying into it
+	if (m_UploadQueue)
+		m_UploadQueue->WaitForTicket(headlessResource->Ticket);
+
+	if (headlessResource->Width > 0)
+		m_Stats.NumTextures--;
+	else
+		m_Stats.NumBuffers--;
+	m_Stats.ResourceByteSize -= headlessResource->Memory.size();
+
+	MemoryTracker::RemoveGPUResource(headlessResource->MemoryTrackerID);
+	m_Resources.erase(iter);
+}
+
+bool HeadlessBackend::IsResourceReady(void* resource) const
+{
+	return static_cast<const HeadlessResource*>(resource)->IsReady;
+}
+
+uint32_t HeadlessBackend::GetTextureIndex(void* texture) const
+{
+	return static_cast<const HeadlessResource*>(texture)->TextureIndex;
+}
+
+void HeadlessBackend::BeginCommandList()
+{
+	m_CommandList.Reset();
+}
+
+void HeadlessBackend::ExecuteCommandList()
+{
+	Execute(m_CommandList);
+	m_CommandList.Reset();
+}
+
+void HeadlessBackend::BeginGPUZone(uint32_t zoneID)
+{
+	m_CommandList.BeginGPUZone(*m_GPUProfiler, zoneID);
+}
+
+void HeadlessBackend::EndGPUZone()
+{
+	m_CommandList.EndGPUZone(*m_GPUProfiler);
+}
+
+void HeadlessBackend::BindRenderPass(RenderPassType pass, uint32_t sceneTableCopyIndex)
+{
+	m_CommandList.SetPipelineState(pass << 16);
+
+	// The copy index selects the instance and material table of the frame, draws address instances relative to the copy
+	m_CommandList.SetRootConstants(&sceneTableCopyIndex, sizeof(sceneTableCopyIndex));
+	if (pass != SHADOW_COMPOSE)
+		m_CommandList.SetVertexBuffer(1, *m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_MESH_INSTANCES)]);
+}
+
+void HeadlessBackend::SetPipelineVariant(RenderPassType pass, uint32_t variant)
+{
+	m_CommandList.SetPipelineState((pass << 16) | variant);
+}
+
+void HeadlessBackend::SetViewProjection(const glm::mat4& viewProjection)
+{
+	m_CommandList.SetRootConstants(&viewProjection, sizeof(viewProjection));
+}
+
+void HeadlessBackend::DrawMesh(void* positionBuffer, void* attributeBuffer, void* indexBuffer, uint32_t numIndices, uint32_t instance)
+{
+	m_CommandList.SetVertexBuffer(0, *static_cast<HeadlessResource*>(positionBuffer));
+	if (attributeBuffer)
+		m_CommandList.SetVertexBuffer(2, *static_cast<HeadlessResource*>(attributeBuffer));
+	m_CommandList.SetIndexBuffer(*static_cast<HeadlessResource*>(indexBuffer));
+	m_CommandList.DrawIndexed(numIndices, 1, 0, instance);
+}
+
+void HeadlessBackend::BeginShadowAtlasLayer(ShadowAtlasLayer layer)
+{
+	ASSERT(layer == ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC || HasShadowAtlasStaticLayer(), "The static shadow atlas layer does not exist");
+}
+
+void HeadlessBackend::ClearShadowAtlasTiles(ShadowAtlasLayer layer, const std::vector<ShadowAtlasTile>& tiles)
+{
+	if (!tiles.empty())
+		m_CommandList.ClearDepth(tiles);
+}
+
+void HeadlessBackend::SetShadowAtlasTile(ShadowAtlasLayer layer, const ShadowAtlasTile& tile)
+{
+	m_CommandList.SetViewport(tile);
+}
+
+void HeadlessBackend::ComposeShadowAtlasTile(const ShadowAtlasTile& tile)
+{
+	m_CommandList.SetViewport(tile);
+	m_CommandList.Draw(3, 1);
+}
+
+void HeadlessBackend::CreateShadowAtlasStaticLayer()
+{
+	if (HasShadowAtlasStaticLayer())
+		return;
+
+	std::size_t byteSize = static_cast<std::size_t>(m_ShadowAtlasResolution) * m_ShadowAtlasResolution * GetTextureFormatByteSize(TextureFormat::TEXTURE_FORMAT_DEPTH32);
+	m_ShadowAtlasStaticLayerTrackerID = MemoryTracker::AddGPUResource("Shadow atlas static layer", GPU_MEMORY_CATEGORY_SHADOW_MAPS, byteSize);
+}
+
+void HeadlessBackend::ReleaseShadowAtlasStaticLayer()
+{
+	if (!HasShadowAtlasStaticLayer())
+		return;
+
+	MemoryTracker::RemoveGPUResource(m_ShadowAtlasStaticLayerTrackerID);
+	m_ShadowAtlasStaticLayerTrackerID = MEMORY_TRACKER_INVALID_ID;
+}
+
+void HeadlessBackend::DispatchLightClustering(uint32_t sceneTableCopyIndex)
+{
+	// The copy index selects the light cluster grid and light spheres the dispatch reads
+	m_CommandList.SetRootConstants(&sceneTableCopyIndex, sizeof(sceneTableCopyIndex));
+	m_CommandList.Dispatch(HeadlessComputePassType::HEADLESS_COMPUTE_PASS_TYPE_LIGHT_CLUSTERING,
+		LIGHT_CLUSTER_GRID_SIZE_X, LIGHT_CLUSTER_GRID_SIZE_Y, LIGHT_CLUSTER_GRID_SIZE_Z);
+}
+
+void HeadlessBackend::ReadBackLightClusters(LightClusterLists& outLists)
+{
+	ExecuteCommandList();
+
+	const HeadlessResource* countBuffer = m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS)];
+	const HeadlessResource* indexBuffer = m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES)];
+
+	outLists.LightCounts.resize(LIGHT_CLUSTER_COUNT);
+	outLists.LightIndices.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+	memcpy(outLists.LightCounts.data(), countBuffer->Memory.data(), outLists.LightCounts.size() * sizeof(uint32_t));
+	memcpy(outLists.LightIndices.data(), indexBuffer->Memory.data(), outLists.LightIndices.size() * sizeof(uint32_t));
+}
+
+void HeadlessBackend::ResolveTemporalAA(bool enableTAA)
+{
+	if (enableTAA)
+	{
+		m_CommandList.Dispatch(HeadlessComputePassType::HEADLESS_COMPUTE_PASS_TYPE_TEMPORAL_ANTI_ALIASING,
+			(m_RenderResolution.x + 7) / 8, (m_RenderResolution.y + 7) / 8, 1);
+	}
+}
+
+void HeadlessBackend::PostProcess(DebugShowTextureMode debugShowTextureMode)
+{
+	m_CommandList.Dispatch(HeadlessComputePassType::HEADLESS_COMPUTE_PASS_TYPE_POST_PROCESS,
+		(m_RenderResolution.x + 7) / 8, (m_RenderResolution.y + 7) / 8, 1);
+}
+
+HeadlessResource* HeadlessBackend::CreateResource(std::size_t byteSize, const std::string& debugName, GPUMemoryCategory memoryCategory)
+{
+	HeadlessResource* buffer = m_Resources.emplace_back(std::make_unique<HeadlessResource>()).get();
+	buffer->Memory.resize(byteSize);
+	buffer->DebugName = debugName;
+	buffer->MemoryTrackerID = MemoryTracker::AddGPUResource(debugName, memoryCategory, byteSize);
+
+	m_Stats.NumBuffers++;
+	m_Stats.ResourceByteSize += byteSize;
+	return buffer;
+}
+
+void HeadlessBackend::TrackRenderTargets()
+{
+	// Same targets and formats as the D3D12 backend, only their memory is counted since the headless GPU never writes a pixel
+	const std::size_t numPixels = static_cast<std::size_t>(m_RenderResolution.x) * m_RenderResolution.y;
+	const std::pair<const char*, TextureFormat> renderTargets[] =
+	{
+		{ "Depth pre-pass depth target", TextureFormat::TEXTURE_FORMAT_DEPTH32 },
+		{ "HDR color target", TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT },
+		{ "TAA resolve target", TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT },
+		{ "TAA history", TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT },
+		{ "SDR color target", TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM },
+		{ "Velocity target", TextureFormat::TEXTURE_FORMAT_RG16_FLOAT },
+		{ "Velocity target previous", TextureFormat::TEXTURE_FORMAT_RG16_FLOAT }
+	};
+
+	for (const auto& [debugName, format] : renderTargets)
+		m_RenderTargetTrackerIDs.push_back(MemoryTracker::AddGPUResource(debugName, GPU_MEMORY_CATEGORY_RENDER_TARGETS, numPixels * GetTextureFormatByteSize(format)));
+
+	std::size_t shadowAtlasByteSize = static_cast<std::size_t>(m_ShadowAtlasResolution) * m_ShadowAtlasResolution * GetTextureFormatByteSize(TextureFormat::TEXTURE_FORMAT_DEPTH32);
+	m_RenderTargetTrackerIDs.push_back(MemoryTracker::AddGPUResource("Shadow atlas", GPU_MEMORY_CATEGORY_SHADOW_MAPS, shadowAtlasByteSize));
+}
+
+void HeadlessBackend::UntrackRenderTargets()
+{
+	for (uint32_t trackerID : m_RenderTargetTrackerIDs)
+		MemoryTracker::RemoveGPUResource(trackerID);
+
+	m_RenderTargetTrackerIDs.clear();
+}
+
+uint64_t HeadlessBackend::Execute(const HeadlessCommandList& commandList)
+{
+	const std::vector<uint8_t>& stream = commandList.GetCommandStream();
+	std::size_t offset = 0;
+
+	// Walk the stream like a GPU front end would, this also catches draws without bound buffers
+	const HeadlessResource* indexBuffer = nullptr;
+	uint32_t sceneTableCopyIndex = 0;
+	m_GPUQuerySource->BeginCommandList();
+
+	while (offset < stream.size())
+	{
+		HeadlessCommandList::CommandHeader header;
+		memcpy(&header, stream.data() + offset, sizeof(header));
+		const uint8_t* payload = stream.data() + offset + sizeof(header);
+
+		switch (header.Type)
+		{
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_INDEX_BUFFER:
+			memcpy(&indexBuffer, payload, sizeof(indexBuffer));
+			break;
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_ROOT_CONSTANTS:
+			// Passes and dispatches set the scene table copy index as their only root constant
+			if (header.PayloadByteSize == sizeof(sceneTableCopyIndex))
+				memcpy(&sceneTableCopyIndex, payload, sizeof(sceneTableCopyIndex));
+			break;
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_SET_VIEWPORT:
+		{
+			ShadowAtlasTile tile;
+			memcpy(&tile, payload, sizeof(tile));
+			ASSERT(tile.X + tile.Size <= m_ShadowAtlasResolution && tile.Y + tile.Size <= m_ShadowAtlasResolution, "Viewport is outside of the shadow atlas");
+			break;
+		}
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_DRAW:
+		{
+			uint32_t args[2];
+			memcpy(args, payload, sizeof(args));
+
+			m_Stats.NumDrawsExecuted++;
+			m_GPUQuerySource->Draw(static_cast<uint64_t>(args[0]) * args[1]);
+			break;
+		}
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_DRAW_INDEXED:
+		{
+			uint32_t args[4];
+			memcpy(args, payload, sizeof(args));
+
+			ASSERT(indexBuffer && (args[2] + args[0]) * sizeof(uint32_t) <= indexBuffer->Memory.size(), "Draw reads outside of the bound index buffer");
+			ASSERT(args[3] + args[1] <= m_NumInstanceTableEntries, "Draw reads outside of the instance table");
+			m_Stats.NumDrawsExecuted++;
+			m_Stats.NumIndicesExecuted += static_cast<uint64_t>(args[0]) * args[1];
+			m_GPUQuerySource->Draw(static_cast<uint64_t>(args[0]) * args[1]);
+			break;
+		}
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_DISPATCH:
+		{
+			uint32_t args[4];
+			memcpy(args, payload, sizeof(args));
+
+			if (static_cast<HeadlessComputePassType>(args[0]) == HeadlessComputePassType::HEADLESS_COMPUTE_PASS_TYPE_LIGHT_CLUSTERING)
+				ExecuteLightClustering(sceneTableCopyIndex);
+			m_GPUQuerySource->Dispatch(static_cast<uint64_t>(args[1]) * args[2] * args[3]);
+			break;
+		}
+		case HeadlessCommandType::HEADLESS_COMMAND_TYPE_WRITE_TIMESTAMP:
+		{
+			uint32_t queryIndex;
+			memcpy(&queryIndex, payload, sizeof(queryIndex));
+			m_GPUQuerySource->WriteTimestamp(m_FrameIndex, queryIndex);
+			break;
+		}
+		default:
+			break;
+		}
+
+		offset += sizeof(header) + header.PayloadByteSize;
+		m_Stats.NumCommandsExecuted++;
+	}
+
+	m_Stats.NumCommandListsExecuted++;
+	m_Stats.CommandStreamByteSize += stream.size();
+	return ++m_Stats.LastFenceValue;
+}
+
+void HeadlessBackend::ExecuteLightClustering(uint32_t sceneTableCopyIndex)
+{
+	// The CPU reference produces the same lists as LightClustering_CS, so the lighting pass reads what it would on a GPU
+	const HeadlessResource* gridBuffer = m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS)];
+	LightClusterGridData grid;
+	memcpy(&grid, gridBuffer->Memory.data() + GetRenderBufferCopyOffset(*gridBuffer, sceneTableCopyIndex), sizeof(grid));
+
+	const HeadlessResource* sphereBuffer = m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_SPHERES)];
+	std::size_t sphereCopyOffset = GetRenderBufferCopyOffset(*sphereBuffer, sceneTableCopyIndex);
+	std::vector<glm::vec4> viewSpheres(grid.NumSpotLights + grid.NumPointLights);
+	ASSERT(viewSpheres.size() * sizeof(glm::vec4) <= sphereBuffer->Memory.size() / HEADLESS_FRAMES_IN_FLIGHT, "Light cluster grid has more lights than the light sphere buffer");
+	memcpy(viewSpheres.data(), sphereBuffer->Memory.data() + sphereCopyOffset, viewSpheres.size() * sizeof(glm::vec4));
+
+	LightClusterLists lists;
+	LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+	memcpy(m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS)]->Memory.data(), lists.LightCounts.data(), lists.LightCounts.size() * sizeof(uint32_t));
+	memcpy(m_RenderBuffers[static_cast<uint32_t>(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES)]->Memory.data(), lists.LightIndices.data(), lists.LightIndices.size() * sizeof(uint32_t));
+}
+
+HeadlessShaderCompiler::HeadlessShaderCompiler(float compileTime)
+	: m_CompileTime(compileTime)
+{
+}
+
+Hash128 HeadlessShaderCompiler::GetVersionHash() const
+{
+	static constexpr char version[] = "HeadlessShaderCompiler 1";
+	return Hash::Bytes(version, sizeof(version));
+}
+
+bool HeadlessShaderCompiler::Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages)
+{
+	if (m_CompileTime > 0.0f)
+		std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(m_CompileTime));
+
+	for (const ShaderSourceFile& source : sources)
+	{
+		if (!source.Exists)
+		{
+			outMessages = "Cannot open include file: " + source.Filepath;
+			return false;
+		}
+	}
+
+	const std::string& mainCode = sources[0].Code;
+	if (mainCode.find(" " + desc.EntryPoint + "(") == std::string::npos)
+	{
+		outMessages = "Missing entry point definition: " + desc.EntryPoint;
+		return false;
+	}
+
+	Hash128 hash = ShaderCache::HashShader(desc, sources);
+	outBinary.Bytecode.resize(sizeof(Hash128) + mainCode.size());
+	memcpy(outBinary.Bytecode.data(), &hash, sizeof(Hash128));
+	memcpy(outBinary.Bytecode.data() + sizeof(Hash128), mainCode.data(), mainCode.size());
+
+	outBinary.Reflection.clear();
+	for (const ShaderSourceFile& source : sources)
+	{
+		std::size_t lineStart = 0;
+		while (lineStart < source.Code.size())
+		{
+			std::size_t lineEnd = std::min(source.Code.find('\n', lineStart), source.Code.size());
+			if (source.Code.find("register(", lineStart) < lineEnd)
+			{
+				outBinary.Reflection.insert(outBinary.Reflection.end(), source.Code.begin() + lineStart, source.Code.begin() + lineEnd);
+				outBinary.Reflection.push_back('\n');
+			}
+
+			lineStart = lineEnd + 1;
+		}
+	}
+
+	return true;
+}
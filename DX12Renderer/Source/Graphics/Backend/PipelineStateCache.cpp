@@ -0,0 +1,154 @@
+#include "Pch.h"
+#include "Graphics/Backend/PipelineStateCache.h"
+
+void PipelineStateHasher::AddBytes(const void* data, std::size_t byteSize)
+{
+	// The size is part of the hash, so adjacent variable length fields cannot shift bytes into each other
+	AddHash(Hash::Value(static_cast<uint64_t>(byteSize)));
+	if (byteSize > 0)
+		AddHash(Hash::Bytes(data, byteSize));
+}
+
+void PipelineStateHasher::AddString(const char* string)
+{
+	AddBytes(string, string ? std::strlen(string) : 0);
+}
+
+void PipelineStateHasher::AddHash(const Hash128& hash)
+{
+	m_Hash = Hash::Combine(m_Hash, hash);
+}
+
+PipelineStateCache::PipelineStateCache(ReleaseFunction release)
+	: m_Release(release)
+{
+}
+
+PipelineStateCache::~PipelineStateCache()
+{
+	WaitForAll();
+
+	for (Entry& entry : m_Entries)
+	{
+		if (entry.PipelineState)
+			m_Release(entry.PipelineState);
+	}
+}
+
+uint32_t PipelineStateCache::Request(const Hash128& key, const std::string& name, CreateFunction create)
+{
+	Entry* entry = nullptr;
+	uint32_t id = PIPELINE_STATE_CACHE_INVALID_ID;
+
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		auto iter = m_KeyToID.find(key);
+		if (iter != m_KeyToID.end())
+		{
+			m_NumDeduplicated++;
+			return iter->second;
+		}
+
+		id = static_cast<uint32_t>(m_Entries.size());
+		entry = &m_Entries.emplace_back();
+		entry->Key = key;
+		entry->Name = name;
+		m_KeyToID.emplace(key, id);
+	}
+
+	JobSystem::Execute(entry->Counter, [this, entry, create]()
+	{
+		SCOPED_TIMER("PipelineStateCache::Create");
+		auto start = std::chrono::steady_clock::now();
+
+		void* pipelineState = create();
+
+		auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		m_CreationTimeNanoseconds += static_cast<uint64_t>(duration.count());
+
+		if (pipelineState)
+		{
+			m_NumCreated++;
+		}
+		else
+		{
+			m_NumFailed++;
+			LOG_ERR("[PipelineStateCache] Failed to create pipeline state {}", entry->Name);
+		}
+
+		// The status publishes the pipeline state, readers only look at it once they saw READY
+		entry->PipelineState = pipelineState;
+		entry->Status.store(pipelineState ? PipelineStateStatus::PIPELINE_STATE_STATUS_READY : PipelineStateStatus::PIPELINE_STATE_STATUS_FAILED,
+			std::memory_order_release);
+	});
+
+	return id;
+}
+
+PipelineStateStatus PipelineStateCache::GetStatus(uint32_t id) const
+{
+	return GetEntry(id).Status.load(std::memory_order_acquire);
+}
+
+void* PipelineStateCache::GetPipelineState(uint32_t id) const
+{
+	const Entry& entry = GetEntry(id);
+	if (entry.Status.load(std::memory_order_acquire) != PipelineStateStatus::PIPELINE_STATE_STATUS_READY)
+		return nullptr;
+
+	return entry.PipelineState;
+}
+
+void* PipelineStateCache::WaitForPipelineState(uint32_t id)
+{
+	JobSystem::Wait(GetEntry(id).Counter);
+
+	return GetPipelineState(id);
+}
+
+void PipelineStateCache::WaitForAll()
+{
+	uint32_t numEntries = GetNumPipelineStates();
+	for (uint32_t id = 0; id < numEntries; ++id)
+		WaitForPipelineState(id);
+}
+
+const std::string& PipelineStateCache::GetName(uint32_t id) const
+{
+	return GetEntry(id).Name;
+}
+
+const Hash128& PipelineStateCache::GetKey(uint32_t id) const
+{
+	return GetEntry(id).Key;
+}
+
+uint32_t PipelineStateCache::GetNumPipelineStates() const
+{
+	std::scoped_lock lock(m_Mutex);
+	return static_cast<uint32_t>(m_Entries.size());
+}
+
+PipelineStateCacheStatistics PipelineStateCache::GetStatistics() const
+{
+	PipelineStateCacheStatistics stats;
+	stats.NumDeduplicated = m_NumDeduplicated.load();
+	stats.NumCreated = m_NumCreated.load();
+	stats.NumFailed = m_NumFailed.load();
+	stats.CreationTime = static_cast<float>(m_CreationTimeNanoseconds.load()) / 1000000.0f;
+
+	uint32_t numPipelineStates = GetNumPipelineStates();
+	stats.NumRequests = numPipelineStates + stats.NumDeduplicated;
+	stats.NumPending = numPipelineStates - stats.NumCreated - stats.NumFailed;
+
+	return stats;
+}
+
+const PipelineStateCache::Entry& PipelineStateCache::GetEntry(uint32_t id) const
+{
+	std::scoped_lock lock(m_Mutex);
+	ASSERT(id < m_Entries.size(), "Pipeline state ID is out of range");
+
+	return m_Entries[id];
+}
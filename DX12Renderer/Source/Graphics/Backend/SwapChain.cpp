@@ -3,7 +3,7 @@
 #include "Graphics/Texture.h"
 #include "Graphics/Backend/CommandQueue.h"
 #include "Graphics/Backend/CommandList.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 SwapChain::SwapChain(HWND hWnd, std::shared_ptr<CommandQueue> commandQueue, uint32_t width, uint32_t height)
     : m_CommandQueueDirect(commandQueue)
@@ -11,7 +11,7 @@ SwapChain::SwapChain(HWND hWnd, std::shared_ptr<CommandQueue> commandQueue, uint
     ComPtr<IDXGIFactory> dxgiFactory;
     ComPtr<IDXGIFactory5> dxgiFactory5;
 
-    DX_CALL(RenderBackend::GetDXGIAdapter()->GetParent(IID_PPV_ARGS(&dxgiFactory)));
+    DX_CALL(D3D12Backend::GetDXGIAdapter()->GetParent(IID_PPV_ARGS(&dxgiFactory)));
     DX_CALL(dxgiFactory.As(&dxgiFactory5));
 
     BOOL allowTearing = false;
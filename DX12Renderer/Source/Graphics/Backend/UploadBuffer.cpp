@@ -1,12 +1,13 @@
 #include "Pch.h"
 #include "Graphics/Backend/UploadBuffer.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 UploadBuffer::UploadBuffer(std::size_t totalByteSize)
 	: m_TotalByteSize(totalByteSize)
 {
 	CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(m_TotalByteSize);
-	RenderBackend::CreateBuffer(m_d3d12Resource, D3D12_HEAP_TYPE_UPLOAD, desc, D3D12_RESOURCE_STATE_GENERIC_READ);
+	D3D12Backend::CreateBuffer(m_d3d12Resource, D3D12_HEAP_TYPE_UPLOAD, desc, D3D12_RESOURCE_STATE_GENERIC_READ);
+	m_MemoryTrackerID = MemoryTracker::AddGPUResource("Upload buffer", GPU_MEMORY_CATEGORY_UPLOAD, m_TotalByteSize);
 
 	m_d3d12Resource->Map(0, nullptr, &m_CPUPtr);
 }
@@ -14,6 +15,7 @@ UploadBuffer::UploadBuffer(std::size_t totalByteSize)
 UploadBuffer::~UploadBuffer()
 {
 	m_d3d12Resource->Unmap(0, nullptr);
+	MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
 }
 
 // This implementation assumes that this buffer is never written to twice before waiting on it to finish being used
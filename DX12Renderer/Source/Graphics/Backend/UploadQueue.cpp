@@ -0,0 +1,373 @@
+#include "Pch.h"
+#include "Graphics/Backend/UploadQueue.h"
+
+UploadQueue::UploadQueue(std::unique_ptr<UploadQueueBackend> backend, const UploadQueueDesc& desc)
+	: m_Backend(std::move(backend)), m_Desc(desc)
+{
+	m_FrameBudgetRemaining = m_Desc.MaxBytesPerFrame;
+	m_WorkerThread = std::thread(&UploadQueue::WorkerLoop, this);
+}
+
+UploadQueue::~UploadQueue()
+{
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_WorkCV.notify_one();
+	m_WorkerThread.join();
+
+	// Staging memory might still be read by the GPU
+	m_Backend->WaitForFenceValue(m_LastSubmittedFence);
+}
+
+UploadTicket UploadQueue::UploadBuffer(void* destination, const void* data, std::size_t numBytes)
+{
+	if (!data || numBytes == 0)
+		return UploadTicket();
+
+	UploadRequest request;
+	request.Type = UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER;
+	request.Destination = destination;
+	request.Data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + numBytes);
+
+	return Enqueue(std::move(request));
+}
+
+UploadTicket UploadQueue::UploadTexture(void* destination, const void* data, std::size_t rowPitch, uint32_t numRows)
+{
+	if (!data || rowPitch == 0 || numRows == 0)
+		return UploadTicket();
+
+	ASSERT(MathHelper::AlignUp(rowPitch, m_Backend->GetTextureRowPitchAlignment()) <= m_Backend->GetStagingByteSize(),
+		"A single texture row does not fit into the upload staging memory");
+
+	UploadRequest request;
+	request.Type = UploadRequestType::UPLOAD_REQUEST_TYPE_TEXTURE;
+	request.Destination = destination;
+	request.Data.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + rowPitch * numRows);
+	request.RowPitch = rowPitch;
+	request.NumRows = numRows;
+
+	return Enqueue(std::move(request));
+}
+
+void UploadQueue::BeginFrame()
+{
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_FrameBudgetRemaining = m_Desc.MaxBytesPerFrame;
+		m_Stats.BytesUploadedThisFrame = 0;
+	}
+	m_WorkCV.notify_one();
+}
+
+void UploadQueue::ProcessCompletions()
+{
+	uint64_t completedFenceValue = m_Backend->GetCompletedFenceValue();
+	std::vector<CompletedUpload> completedUploads;
+
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		while (!m_InFlightBatches.empty() && m_InFlightBatches.front().FenceValue <= completedFenceValue)
+		{
+			InFlightBatch& batch = m_InFlightBatches.front();
+			completedUploads.insert(completedUploads.end(), batch.CompletedUploads.begin(), batch.CompletedUploads.end());
+			m_InFlightBatches.pop_front();
+		}
+
+		m_Stats.NumRequestsCompleted += completedUploads.size();
+	}
+
+	// Requests are recorded in order and batches retire in order, so tickets complete in order as well
+	for (auto& upload : completedUploads)
+	{
+		m_Backend->OnUploadComplete(upload.Type, upload.Destination);
+		m_CompletedTicket = upload.Ticket.Value;
+	}
+}
+
+bool UploadQueue::IsComplete(UploadTicket ticket) const
+{
+	return ticket.Value <= m_CompletedTicket;
+}
+
+void UploadQueue::WaitForTicket(UploadTicket ticket)
+{
+	if (IsComplete(ticket))
+		return;
+
+	// Lift the frame budget until the ticket is done, otherwise we might wait for several frames
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_FlushRequests++;
+	}
+	m_WorkCV.notify_one();
+
+	while (!IsComplete(ticket))
+	{
+		ProcessCompletions();
+		if (IsComplete(ticket))
+			break;
+
+		uint64_t lastSubmittedFence = m_LastSubmittedFence;
+		if (lastSubmittedFence > m_Backend->GetCompletedFenceValue())
+			m_Backend->WaitForFenceValue(lastSubmittedFence);
+		else
+			std::this_thread::yield();
+	}
+
+	std::scoped_lock lock(m_Mutex);
+	m_FlushRequests--;
+}
+
+void UploadQueue::Flush()
+{
+	UploadTicket lastTicket;
+	{
+		std::scoped_lock lock(m_Mutex);
+		lastTicket.Value = m_NextTicket - 1;
+	}
+
+	WaitForTicket(lastTicket);
+}
+
+UploadQueueStatistics UploadQueue::GetStatistics() const
+{
+	std::scoped_lock lock(m_Mutex);
+
+	UploadQueueStatistics stats = m_Stats;
+	stats.NumPendingRequests = m_PendingRequests.size();
+	return stats;
+}
+
+UploadTicket UploadQueue::Enqueue(UploadRequest&& request)
+{
+	UploadTicket ticket;
+	{
+		std::scoped_lock lock(m_Mutex);
+
+		ticket.Value = m_NextTicket++;
+		request.Ticket = ticket;
+		m_Stats.NumPendingBytes += request.Data.size();
+		m_PendingRequests.push_back(std::move(request));
+	}
+	m_WorkCV.notify_one();
+
+	return ticket;
+}
+
+void UploadQueue::WorkerLoop()
+{
+	Profiler::SetThreadName("Upload queue");
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkCV.wait(lock, [this] {
+				return m_Stop || (!m_PendingRequests.empty() && (m_FrameBudgetRemaining > 0 || m_FlushRequests > 0));
+			});
+
+			if (m_Stop)
+				return;
+		}
+
+		ProcessBatch();
+	}
+}
+
+void UploadQueue::ProcessBatch()
+{
+	SCOPED_TIMER("UploadQueue::ProcessBatch");
+	RetireStaging();
+
+	std::vector<CompletedUpload> completedUploads;
+	std::size_t batchBytes = 0;
+	bool stagingFull = false;
+
+	while (batchBytes < m_Desc.MaxBytesPerBatch)
+	{
+		// Only the worker pops requests, so the front stays valid while the lock is released
+		UploadRequest* request = nullptr;
+		std::size_t budget = 0;
+		{
+			std::scoped_lock lock(m_Mutex);
+			if (m_PendingRequests.empty())
+				break;
+
+			request = &m_PendingRequests.front();
+			budget = m_FlushRequests > 0 ? std::numeric_limits<std::size_t>::max() : m_FrameBudgetRemaining;
+		}
+
+		budget = std::min(budget, m_Desc.MaxBytesPerBatch - batchBytes);
+		if (budget == 0)
+			break;
+
+		std::size_t recordedBytes = request->Type == UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER ?
+			RecordBufferSlice(*request, budget) : RecordTextureSlice(*request, budget);
+
+		if (recordedBytes == 0)
+		{
+			stagingFull = true;
+			break;
+		}
+
+		batchBytes += recordedBytes;
+
+		std::scoped_lock lock(m_Mutex);
+		m_FrameBudgetRemaining -= std::min(m_FrameBudgetRemaining, recordedBytes);
+		m_Stats.BytesUploadedThisFrame += recordedBytes;
+		m_Stats.NumPendingBytes -= recordedBytes;
+
+		if (IsFinished(*request))
+		{
+			completedUploads.push_back({ request->Ticket, request->Type, request->Destination });
+			m_PendingRequests.pop_front();
+		}
+	}
+
+	if (!m_BatchOpen)
+	{
+		// Nothing fit into the staging ring, wait for the oldest batch to free up its memory
+		if (stagingFull && !m_StagingRetireQueue.empty())
+		{
+			m_Backend->WaitForFenceValue(m_StagingRetireQueue.front().first);
+			RetireStaging();
+		}
+		return;
+	}
+
+	uint64_t fenceValue = m_Backend->SubmitBatch();
+	m_BatchOpen = false;
+
+	m_StagingRetireQueue.emplace_back(fenceValue, m_BatchStagingBytes);
+	m_BatchStagingBytes = 0;
+	m_LastSubmittedFence = fenceValue;
+
+	std::scoped_lock lock(m_Mutex);
+	m_InFlightBatches.push_back({ fenceValue, std::move(completedUploads) });
+	m_Stats.NumBatchesSubmitted++;
+}
+
+bool UploadQueue::AllocateStaging(std::size_t byteSize, std::size_t align, std::size_t& outOffset)
+{
+	std::size_t capacity = m_Backend->GetStagingByteSize();
+	if (m_StagingUsed == 0)
+		m_StagingHead = 0;
+
+	std::size_t offset = MathHelper::AlignUp(m_StagingHead, align);
+	std::size_t consumed = offset - m_StagingHead + byteSize;
+
+	// Wrap around, the space left at the end of the ring is consumed as well
+	if (offset + byteSize > capacity)
+	{
+		offset = 0;
+		consumed = capacity - m_StagingHead + byteSize;
+	}
+
+	if (m_StagingUsed + consumed > capacity)
+		return false;
+
+	m_StagingHead = offset + byteSize;
+	m_StagingUsed += consumed;
+	m_BatchStagingBytes += consumed;
+
+	outOffset = offset;
+	return true;
+}
+
+void UploadQueue::RetireStaging()
+{
+	uint64_t completedFenceValue = m_Backend->GetCompletedFenceValue();
+
+	while (!m_StagingRetireQueue.empty() && m_StagingRetireQueue.front().first <= completedFenceValue)
+	{
+		m_StagingUsed -= m_StagingRetireQueue.front().second;
+		m_StagingRetireQueue.pop_front();
+	}
+}
+
+std::size_t UploadQueue::RecordBufferSlice(UploadRequest& request, std::size_t budget)
+{
+	std::size_t remainingBytes = request.Data.size() - request.NextByte;
+	std::size_t minSliceBytes = std::min<std::size_t>(remainingBytes, KILOBYTE(64));
+	std::size_t numBytes = std::max(std::min(remainingBytes, budget), minSliceBytes);
+
+	// Shrink the slice until it fits into the staging ring
+	std::size_t stagingOffset = 0;
+	while (!AllocateStaging(numBytes, m_Desc.BufferAlignment, stagingOffset))
+	{
+		if (numBytes == minSliceBytes)
+			return 0;
+
+		numBytes = std::max(numBytes / 2, minSliceBytes);
+	}
+
+	memcpy(m_Backend->GetStagingMemory() + stagingOffset, request.Data.data() + request.NextByte, numBytes);
+
+	UploadSlice slice;
+	slice.StagingOffset = stagingOffset;
+	slice.ByteOffset = request.NextByte;
+	slice.NumBytes = numBytes;
+	RecordCopy(request, slice);
+
+	request.NextByte += numBytes;
+	return numBytes;
+}
+
+std::size_t UploadQueue::RecordTextureSlice(UploadRequest& request, std::size_t budget)
+{
+	std::size_t stagingRowPitch = MathHelper::AlignUp(request.RowPitch, m_Backend->GetTextureRowPitchAlignment());
+	uint32_t remainingRows = request.NumRows - request.NextRow;
+
+	// Always copy at least one row so big textures make progress on a small budget
+	std::size_t budgetRows = std::max<std::size_t>(budget / request.RowPitch, 1);
+	uint32_t numRows = static_cast<uint32_t>(std::min<std::size_t>(remainingRows, budgetRows));
+
+	std::size_t stagingOffset = 0;
+	while (!AllocateStaging(numRows * stagingRowPitch, m_Backend->GetTextureSliceAlignment(), stagingOffset))
+	{
+		if (numRows == 1)
+			return 0;
+
+		numRows /= 2;
+	}
+
+	uint8_t* staging = m_Backend->GetStagingMemory() + stagingOffset;
+	for (uint32_t row = 0; row < numRows; ++row)
+	{
+		memcpy(staging + row * stagingRowPitch, request.Data.data() + (request.NextRow + row) * request.RowPitch, request.RowPitch);
+	}
+
+	UploadSlice slice;
+	slice.StagingOffset = stagingOffset;
+	slice.StagingRowPitch = stagingRowPitch;
+	slice.FirstRow = request.NextRow;
+	slice.NumRows = numRows;
+	RecordCopy(request, slice);
+
+	request.NextRow += numRows;
+	return numRows * request.RowPitch;
+}
+
+void UploadQueue::RecordCopy(const UploadRequest& request, const UploadSlice& slice)
+{
+	// Batches are opened lazily, so we never submit an empty command list
+	if (!m_BatchOpen)
+	{
+		m_Backend->BeginBatch();
+		m_BatchOpen = true;
+	}
+
+	m_Backend->RecordCopy(request, slice);
+}
+
+bool UploadQueue::IsFinished(const UploadRequest& request) const
+{
+	if (request.Type == UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER)
+		return request.NextByte == request.Data.size();
+
+	return request.NextRow == request.NumRows;
+}
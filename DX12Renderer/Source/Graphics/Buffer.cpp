@@ -1,6 +1,6 @@
 #include "Pch.h"
 #include "Graphics/Buffer.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 Buffer::Buffer(const BufferDesc& desc)
 	: Resource(desc.DebugName), m_BufferDesc(desc)
@@ -61,7 +61,7 @@ void Buffer::SetBufferData(const void* data, std::size_t byteSize)
 	if (IsCPUAccessible())
 		memcpy(m_CPUPtr, data, dataByteSize);
 	else
-		RenderBackend::UploadBufferData(*this, data);
+		m_UploadTicket = D3D12Backend::UploadBufferData(*this, data);
 }
 
 void Buffer::SetBufferDataAtOffset(const void* data, std::size_t byteSize, std::size_t byteOffset)
@@ -69,7 +69,7 @@ void Buffer::SetBufferDataAtOffset(const void* data, std::size_t byteSize, std::
 	if (IsCPUAccessible())
 		memcpy(static_cast<unsigned char*>(m_CPUPtr) + byteOffset, data, byteSize);
 	else
-		RenderBackend::UploadBufferDataRegion(*this, byteOffset, byteSize);
+		D3D12Backend::UploadBufferDataRegion(*this, byteOffset, byteSize);
 }
 
 void Buffer::CreateD3D12Resource()
@@ -94,8 +94,14 @@ void Buffer::CreateD3D12Resource()
 		m_d3d12ResourceState = D3D12_RESOURCE_STATE_COPY_DEST;
 	}
 
-	CD3DX12_RESOURCE_DESC d3d12ResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_ByteSize);
-	RenderBackend::CreateBuffer(m_d3d12Resource, heapType, d3d12ResourceDesc, m_d3d12ResourceState);
+	// Buffers written by compute shaders need unordered access, only default heap buffers can have it
+	D3D12_RESOURCE_FLAGS resourceFlags = D3D12_RESOURCE_FLAG_NONE;
+	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_WRITE && heapType == D3D12_HEAP_TYPE_DEFAULT)
+		resourceFlags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+	CD3DX12_RESOURCE_DESC d3d12ResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_ByteSize, resourceFlags);
+	D3D12Backend::CreateBuffer(m_d3d12Resource, heapType, d3d12ResourceDesc, m_d3d12ResourceState);
+	TrackGPUMemory(m_BufferDesc.DebugName, GetBufferMemoryCategory(m_BufferDesc));
 
 	if (IsCPUAccessible())
 		m_d3d12Resource->Map(0, nullptr, &m_CPUPtr);
@@ -105,15 +111,15 @@ void Buffer::AllocateDescriptors()
 {
 	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_READ)
 	{
-		m_DescriptorAllocations[DescriptorType::SRV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_DescriptorAllocations[DescriptorType::SRV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	}
 	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_WRITE)
 	{
-		m_DescriptorAllocations[DescriptorType::UAV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_DescriptorAllocations[DescriptorType::UAV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	}
 	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_CONSTANT)
 	{
-		m_DescriptorAllocations[DescriptorType::CBV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_DescriptorAllocations[DescriptorType::CBV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 	}
 }
 
@@ -133,7 +139,7 @@ void Buffer::CreateViews()
 		srvDesc.Buffer.StructureByteStride = static_cast<uint32_t>(m_BufferDesc.ElementSize);
 		srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 
-		RenderBackend::GetD3D12Device()->CreateShaderResourceView(m_d3d12Resource.Get(), &srvDesc, srvAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateShaderResourceView(m_d3d12Resource.Get(), &srvDesc, srvAllocation.GetCPUDescriptorHandle());
 	}
 	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_WRITE)
 	{
@@ -142,14 +148,14 @@ void Buffer::CreateViews()
 
 		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
 		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-		uavDesc.Format = DXGI_FORMAT_R32_FLOAT;
+		uavDesc.Format = DXGI_FORMAT_UNKNOWN;
 		uavDesc.Buffer.FirstElement = 0;
 		uavDesc.Buffer.NumElements = static_cast<uint32_t>(m_BufferDesc.NumElements);
 		uavDesc.Buffer.StructureByteStride = static_cast<uint32_t>(m_BufferDesc.ElementSize);
 		uavDesc.Buffer.CounterOffsetInBytes = 0;
 		uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
 
-		RenderBackend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &uavDesc, uavAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &uavDesc, uavAllocation.GetCPUDescriptorHandle());
 	}
 	if (m_BufferDesc.Usage & BufferUsage::BUFFER_USAGE_CONSTANT)
 	{
@@ -160,6 +166,6 @@ void Buffer::CreateViews()
 		cbvDesc.BufferLocation = m_d3d12Resource->GetGPUVirtualAddress();
 		cbvDesc.SizeInBytes = m_ByteSize;
 
-		RenderBackend::GetD3D12Device()->CreateConstantBufferView(&cbvDesc, cbvAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateConstantBufferView(&cbvDesc, cbvAllocation.GetCPUDescriptorHandle());
 	}
 }
@@ -1,7 +1,7 @@
 #include "Pch.h"
 #include "Graphics/ComputePass.h"
 #include "Graphics/Shader.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 ComputePass::ComputePass(const std::string& name, const ComputePassDesc& desc)
 	: m_Name(name), m_Desc(desc)
@@ -10,6 +10,11 @@ ComputePass::ComputePass(const std::string& name, const ComputePassDesc& desc)
 	CreatePipelineState();
 }
 
+ID3D12PipelineState* ComputePass::GetD3D12PipelineState() const
+{
+	return D3D12Backend::GetPipelineState(m_PipelineStateID);
+}
+
 void ComputePass::CreateRootSignature()
 {
 	D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
@@ -44,14 +49,15 @@ void ComputePass::CreateRootSignature()
 		errorBlob->Release();
 	}
 
-	DX_CALL(RenderBackend::GetD3D12Device()->CreateRootSignature(0, serializedRootSig->GetBufferPointer(),
+	DX_CALL(D3D12Backend::GetD3D12Device()->CreateRootSignature(0, serializedRootSig->GetBufferPointer(),
 		serializedRootSig->GetBufferSize(), IID_PPV_ARGS(&m_d3d12RootSignature)));
 	m_d3d12RootSignature->SetName(StringHelper::StringToWString(m_Name + " root signature").c_str());
+	m_RootSignatureHash = Hash::Bytes(serializedRootSig->GetBufferPointer(), serializedRootSig->GetBufferSize());
 }
 
 void ComputePass::CreatePipelineState()
 {
-	m_ComputeShader = std::make_unique<Shader>(StringHelper::StringToWString(m_Desc.ComputeShaderPath), "main", "cs_6_0");
+	m_ComputeShader = std::make_unique<Shader>(m_Desc.ComputeShaderPath, "main", SHADER_TARGET_COMPUTE);
 
 	D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.CS = m_ComputeShader->GetShaderByteCode();
@@ -59,6 +65,5 @@ void ComputePass::CreatePipelineState()
 	psoDesc.NodeMask = 0;
 	psoDesc.pRootSignature = m_d3d12RootSignature.Get();
 
-	DX_CALL(RenderBackend::GetD3D12Device()->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_d3d12PipelineState)));
-	m_d3d12PipelineState->SetName(StringHelper::StringToWString(m_Name + " pipeline state").c_str());
+	m_PipelineStateID = D3D12Backend::CreateComputePipelineState(m_Name + " pipeline state", psoDesc, m_RootSignatureHash);
 }
@@ -6,7 +6,8 @@
 #include "Graphics/Buffer.h"
 #include "Graphics/Shader.h"
 #include "Graphics/RasterPass.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
+#include "Graphics/Backend/D3D12RenderBackend.h"
 #include "Graphics/Backend/CommandList.h"
 #include "Graphics/Backend/SwapChain.h"
 
@@ -26,6 +27,7 @@ struct LineVertex
 struct InternalDebugRendererData
 {
     std::unique_ptr<RasterPass> RasterPass;
+    std::unique_ptr<Buffer> DebugLineBuffer;
     DebugRendererSettings DebugRenderSettings;
 
     glm::mat4 CameraViewProjection = glm::identity<glm::mat4>();
@@ -90,7 +92,7 @@ namespace DebugRenderer
         debugLineBufferDesc.ElementSize = sizeof(LineVertex);
         debugLineBufferDesc.DebugName = "Debug line buffer";
 
-        g_RenderState.DebugLineBuffer = std::make_unique<Buffer>(debugLineBufferDesc);
+        s_Data.DebugLineBuffer = std::make_unique<Buffer>(debugLineBufferDesc);
     }
 
 }
@@ -103,6 +105,8 @@ void DebugRenderer::Initialize(uint32_t width, uint32_t height)
 
 void DebugRenderer::Finalize()
 {
+    s_Data.DebugLineBuffer.reset();
+    s_Data.RasterPass.reset();
 }
 
 void DebugRenderer::BeginScene(const Camera& sceneCamera)
@@ -115,10 +119,11 @@ void DebugRenderer::Render()
 {
     SCOPED_TIMER("DebugRenderer::Render");
 
-    if (!s_Data.DebugRenderSettings.DrawLines || s_Data.DebugLineAt == 0)
+    // The pipeline state is created on the job system, lines are not drawn until it is ready
+    if (!s_Data.DebugRenderSettings.DrawLines || s_Data.DebugLineAt == 0 || !s_Data.RasterPass->IsReady())
         return;
 
-    auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+    auto commandList = D3D12Backend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
 
     // Set viewports, scissor rects and render targets
     commandList->SetRenderPassBindables(*s_Data.RasterPass);
@@ -130,20 +135,16 @@ void DebugRenderer::Render()
     commandList->SetViewports(1, &viewport);
     commandList->SetScissorRects(1, &scissorRect);
 
-    commandList->Transition(*g_RenderState.SDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-    commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-
-    D3D12_CPU_DESCRIPTOR_HANDLE rtv = g_RenderState.SDRColorTarget->GetDescriptor(DescriptorType::RTV);
-    D3D12_CPU_DESCRIPTOR_HANDLE dsv = g_RenderState.DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
-    commandList->SetRenderTargets(1, &rtv, &dsv);
+    // Lines are drawn over the final output, the application always runs the renderer on the D3D12 backend
+    static_cast<D3D12RenderBackend&>(Renderer::GetBackend()).SetOverlayRenderTargets(*commandList);
 
     commandList->SetRootConstants(0, 16, &s_Data.CameraViewProjection, 0);
 
-    commandList->SetVertexBuffers(0, 1, *g_RenderState.DebugLineBuffer);
+    commandList->SetVertexBuffers(0, 1, *s_Data.DebugLineBuffer);
 
     commandList->Draw(s_Data.DebugLineAt, 1);
 
-    RenderBackend::ExecuteCommandList(commandList);
+    D3D12Backend::ExecuteCommandList(commandList);
 }
 
 void DebugRenderer::OnImGuiRender()
@@ -177,7 +178,7 @@ void DebugRenderer::Submit(const glm::vec3& lineStart, const glm::vec3& lineEnd,
         { lineStart, color },
         { lineEnd, color }
     };
-    g_RenderState.DebugLineBuffer->SetBufferDataAtOffset(&vertices, 2 * sizeof(LineVertex), s_Data.DebugLineAt * 2 * sizeof(LineVertex));
+    s_Data.DebugLineBuffer->SetBufferDataAtOffset(&vertices, 2 * sizeof(LineVertex), s_Data.DebugLineAt * 2 * sizeof(LineVertex));
     s_Data.DebugLineAt++;
 }
 
@@ -0,0 +1,375 @@
+#include "Pch.h"
+#include "Graphics/FrameCapture.h"
+
+// "DXRC" in little endian, the version is bumped whenever a record layout changes
+static constexpr uint32_t FRAME_CAPTURE_MAGIC = 0x43525844;
+static constexpr uint32_t FRAME_CAPTURE_VERSION = 2;
+
+struct FrameCaptureHeader
+{
+	uint32_t Magic = FRAME_CAPTURE_MAGIC;
+	uint32_t Version = FRAME_CAPTURE_VERSION;
+};
+
+struct FrameCaptureRecordHeader
+{
+	FrameCaptureRecordType Type;
+	uint32_t ByteSize;
+};
+
+enum FrameCaptureSubmissionFlags : uint32_t
+{
+	FRAME_CAPTURE_SUBMISSION_FLAGS_NONE = 0,
+	FRAME_CAPTURE_SUBMISSION_FLAGS_MOVED = (1 << 0)
+};
+
+/*
+
+	Bounds checked cursor over a record payload, reads past the end fail instead of touching memory outside the mapping.
+
+*/
+class FrameCaptureStream
+{
+public:
+	FrameCaptureStream(const uint8_t* data, std::size_t byteSize)
+		: m_Data(data), m_ByteSize(byteSize) {}
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		if (m_Offset + sizeof(T) > m_ByteSize)
+			return false;
+
+		memcpy(&value, m_Data + m_Offset, sizeof(T));
+		m_Offset += sizeof(T);
+		return true;
+	}
+
+	bool ReadView(CapturedView& view)
+	{
+		uint32_t frustumCulling = 0;
+		bool success = Read(view.View) && Read(view.Projection) && Read(view.Near) && Read(view.Far) && Read(frustumCulling);
+
+		view.FrustumCulling = frustumCulling != 0;
+		return success;
+	}
+
+	// Counts are validated against the remaining bytes, so a corrupt count cannot trigger huge allocations
+	bool ReadCount(uint32_t& count, std::size_t minElementByteSize)
+	{
+		return Read(count) && static_cast<std::size_t>(count) * minElementByteSize <= m_ByteSize - m_Offset;
+	}
+
+private:
+	const uint8_t* m_Data = nullptr;
+	std::size_t m_ByteSize = 0;
+	std::size_t m_Offset = 0;
+
+};
+
+FrameCaptureWriter::FrameCaptureWriter(const std::string& filepath)
+	: m_File(filepath, std::ios::out | std::ios::binary | std::ios::trunc)
+{
+	if (!m_File.is_open())
+	{
+		LOG_ERR("[FrameCapture] Could not open capture file for writing: {}", filepath);
+		return;
+	}
+
+	FrameCaptureHeader header;
+	m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_ByteSize += sizeof(header);
+}
+
+FrameCaptureWriter::~FrameCaptureWriter()
+{
+	if (m_File.is_open())
+		m_File.close();
+}
+
+uint32_t FrameCaptureWriter::FindMaterial(uint64_t key) const
+{
+	auto iter = m_MaterialIDs.find(key);
+	return iter != m_MaterialIDs.end() ? iter->second : FRAME_CAPTURE_INVALID_ID;
+}
+
+uint32_t FrameCaptureWriter::AddMaterial(uint64_t key, const CapturedMaterial& material)
+{
+	uint32_t materialID = FindMaterial(key);
+	if (materialID != FRAME_CAPTURE_INVALID_ID)
+		return materialID;
+
+	uint32_t textureFlags = (material.HasAlbedoTexture ? 1 : 0) | (material.HasNormalTexture ? 2 : 0) | (material.HasMetallicRoughnessTexture ? 4 : 0);
+
+	Write(static_cast<uint32_t>(material.Transparency));
+	Write(material.AlphaCutoff);
+	Write(material.Metalness);
+	Write(material.Roughness);
+	Write(textureFlags);
+	WriteRecord(FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_MATERIAL);
+
+	materialID = static_cast<uint32_t>(m_MaterialIDs.size());
+	m_MaterialIDs.emplace(key, materialID);
+	return materialID;
+}
+
+uint32_t FrameCaptureWriter::FindMesh(uint64_t key) const
+{
+	auto iter = m_MeshIDs.find(key);
+	return iter != m_MeshIDs.end() ? iter->second : FRAME_CAPTURE_INVALID_ID;
+}
+
+uint32_t FrameCaptureWriter::AddMesh(uint64_t key, const CapturedMesh& mesh)
+{
+	uint32_t meshID = FindMesh(key);
+	if (meshID != FRAME_CAPTURE_INVALID_ID)
+		return meshID;
+
+	ASSERT(mesh.Material < m_MaterialIDs.size(), "Mesh references a material that was not added to the capture");
+
+	Write(mesh.NumVertices);
+	Write(mesh.NumIndices);
+	Write(mesh.BB.Min);
+	Write(mesh.BB.Max);
+	Write(mesh.Material);
+	Write(static_cast<uint32_t>(mesh.LODs.size()));
+
+	for (const CapturedMeshLOD& lod : mesh.LODs)
+	{
+		Write(lod.NumIndices);
+		Write(lod.Error);
+	}
+
+	WriteRecord(FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_MESH);
+
+	meshID = static_cast<uint32_t>(m_MeshIDs.size());
+	m_MeshIDs.emplace(key, meshID);
+	return meshID;
+}
+
+void FrameCaptureWriter::WriteFrame(const CapturedFrame& frame)
+{
+	const CapturedSettings& settings = frame.Settings;
+	Write(settings.RenderWidth);
+	Write(settings.RenderHeight);
+	Write(settings.ShadowMapResolution);
+	Write(static_cast<uint32_t>(settings.EnableMeshLODs));
+	Write(settings.LODErrorThreshold);
+	Write(settings.ShadowLODErrorThreshold);
+
+	WriteView(frame.SceneView);
+
+	Write(static_cast<uint32_t>(frame.MeshSubmissions.size()));
+	for (const CapturedMeshSubmission& submission : frame.MeshSubmissions)
+	{
+		bool moved = submission.PrevFrameTransform != submission.Transform;
+
+		Write(submission.Mesh);
+		Write(moved ? FRAME_CAPTURE_SUBMISSION_FLAGS_MOVED : FRAME_CAPTURE_SUBMISSION_FLAGS_NONE);
+		Write(submission.Transform);
+
+		if (moved)
+			Write(submission.PrevFrameTransform);
+	}
+
+	Write(static_cast<uint32_t>(frame.Lights.size()));
+	for (const CapturedLight& light : frame.Lights)
+	{
+		Write(light.Type);
+		Write(light.Position);
+		Write(light.Direction);
+		Write(light.Color);
+		Write(light.Attenuation);
+		Write(light.Range);
+		Write(light.InnerConeAngle);
+		Write(light.OuterConeAngle);
+
+		Write(static_cast<uint32_t>(light.ShadowViews.size()));
+		for (const CapturedView& shadowView : light.ShadowViews)
+			WriteView(shadowView);
+	}
+
+	WriteRecord(FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_FRAME);
+	m_NumFrames++;
+}
+
+void FrameCaptureWriter::WriteRecord(FrameCaptureRecordType type)
+{
+	FrameCaptureRecordHeader header = { type, static_cast<uint32_t>(m_RecordData.size()) };
+	m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_File.write(reinterpret_cast<const char*>(m_RecordData.data()), m_RecordData.size());
+
+	m_ByteSize += sizeof(header) + m_RecordData.size();
+	m_RecordData.clear();
+}
+
+void FrameCaptureWriter::WriteView(const CapturedView& view)
+{
+	Write(view.View);
+	Write(view.Projection);
+	Write(view.Near);
+	Write(view.Far);
+	Write(static_cast<uint32_t>(view.FrustumCulling));
+}
+
+FrameCaptureReader::FrameCaptureReader(const std::string& filepath)
+	: m_File(filepath)
+{
+	if (!m_File.IsValid())
+		return;
+
+	m_IsValid = ParseRecords();
+	if (!m_IsValid)
+		LOG_ERR("[FrameCapture] Invalid or corrupt capture file: {}", filepath);
+}
+
+bool FrameCaptureReader::ReadFrame(uint32_t frameIndex, CapturedFrame& frame) const
+{
+	ASSERT(frameIndex < m_FrameOffsets.size(), "Frame index is out of range");
+
+	FrameCaptureRecordHeader header;
+	memcpy(&header, m_File.GetData() + m_FrameOffsets[frameIndex], sizeof(header));
+	FrameCaptureStream stream(m_File.GetData() + m_FrameOffsets[frameIndex] + sizeof(header), header.ByteSize);
+
+	frame.Reset();
+
+	CapturedSettings& settings = frame.Settings;
+	uint32_t enableMeshLODs = 0;
+
+	if (!stream.Read(settings.RenderWidth) || !stream.Read(settings.RenderHeight) || !stream.Read(settings.ShadowMapResolution) ||
+		!stream.Read(enableMeshLODs) || !stream.Read(settings.LODErrorThreshold) || !stream.Read(settings.ShadowLODErrorThreshold))
+		return false;
+
+	settings.EnableMeshLODs = enableMeshLODs != 0;
+
+	if (!stream.ReadView(frame.SceneView))
+		return false;
+
+	uint32_t numSubmissions = 0;
+	if (!stream.ReadCount(numSubmissions, sizeof(uint32_t) * 2 + sizeof(glm::mat4)))
+		return false;
+
+	frame.MeshSubmissions.resize(numSubmissions);
+	for (CapturedMeshSubmission& submission : frame.MeshSubmissions)
+	{
+		uint32_t flags = 0;
+		if (!stream.Read(submission.Mesh) || !stream.Read(flags) || !stream.Read(submission.Transform) || submission.Mesh >= m_Meshes.size())
+			return false;
+
+		if (flags & FRAME_CAPTURE_SUBMISSION_FLAGS_MOVED)
+		{
+			if (!stream.Read(submission.PrevFrameTransform))
+				return false;
+		}
+		else
+		{
+			submission.PrevFrameTransform = submission.Transform;
+		}
+	}
+
+	uint32_t numLights = 0;
+	if (!stream.ReadCount(numLights, sizeof(uint32_t) * 2 + sizeof(glm::vec3) * 4 + sizeof(float) * 3))
+		return false;
+
+	frame.Lights.resize(numLights);
+	for (CapturedLight& light : frame.Lights)
+	{
+		uint32_t numShadowViews = 0;
+		if (!stream.Read(light.Type) || !stream.Read(light.Position) || !stream.Read(light.Direction) || !stream.Read(light.Color) ||
+			!stream.Read(light.Attenuation) || !stream.Read(light.Range) || !stream.Read(light.InnerConeAngle) || !stream.Read(light.OuterConeAngle) ||
+			!stream.ReadCount(numShadowViews, sizeof(glm::mat4) * 2))
+			return false;
+
+		light.ShadowViews.resize(numShadowViews);
+		for (CapturedView& shadowView : light.ShadowViews)
+		{
+			if (!stream.ReadView(shadowView))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool FrameCaptureReader::ParseRecords()
+{
+	const uint8_t* data = m_File.GetData();
+	std::size_t byteSize = m_File.GetByteSize();
+
+	FrameCaptureHeader header;
+	if (byteSize < sizeof(header))
+		return false;
+
+	memcpy(&header, data, sizeof(header));
+	if (header.Magic != FRAME_CAPTURE_MAGIC)
+		return false;
+
+	if (header.Version != FRAME_CAPTURE_VERSION)
+	{
+		LOG_ERR("[FrameCapture] Capture version {} is not supported, expected version {}", header.Version, FRAME_CAPTURE_VERSION);
+		return false;
+	}
+
+	std::size_t offset = sizeof(header);
+	while (offset + sizeof(FrameCaptureRecordHeader) <= byteSize)
+	{
+		FrameCaptureRecordHeader recordHeader;
+		memcpy(&recordHeader, data + offset, sizeof(recordHeader));
+
+		if (offset + sizeof(recordHeader) + recordHeader.ByteSize > byteSize)
+		{
+			// A capture that was cut off while writing still replays up to its last complete record
+			LOG_WARN("[FrameCapture] Capture ends with a truncated record, it is ignored");
+			break;
+		}
+
+		FrameCaptureStream stream(data + offset + sizeof(recordHeader), recordHeader.ByteSize);
+
+		switch (recordHeader.Type)
+		{
+		case FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_MATERIAL:
+		{
+			CapturedMaterial& material = m_Materials.emplace_back();
+			uint32_t transparency = 0, textureFlags = 0;
+
+			if (!stream.Read(transparency) || !stream.Read(material.AlphaCutoff) || !stream.Read(material.Metalness) ||
+				!stream.Read(material.Roughness) || !stream.Read(textureFlags) ||
+				transparency >= TransparencyMode::NUM_ALPHA_MODES)
+				return false;
+
+			material.Transparency = static_cast<TransparencyMode>(transparency);
+			material.HasAlbedoTexture = textureFlags & 1;
+			material.HasNormalTexture = textureFlags & 2;
+			material.HasMetallicRoughnessTexture = textureFlags & 4;
+			break;
+		}
+		case FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_MESH:
+		{
+			CapturedMesh& mesh = m_Meshes.emplace_back();
+			uint32_t numLODs = 0;
+
+			if (!stream.Read(mesh.NumVertices) || !stream.Read(mesh.NumIndices) || !stream.Read(mesh.BB.Min) || !stream.Read(mesh.BB.Max) ||
+				!stream.Read(mesh.Material) || mesh.Material >= m_Materials.size() || !stream.ReadCount(numLODs, sizeof(CapturedMeshLOD)))
+				return false;
+
+			mesh.LODs.resize(numLODs);
+			for (CapturedMeshLOD& lod : mesh.LODs)
+			{
+				if (!stream.Read(lod.NumIndices) || !stream.Read(lod.Error))
+					return false;
+			}
+			break;
+		}
+		case FrameCaptureRecordType::FRAME_CAPTURE_RECORD_TYPE_FRAME:
+			m_FrameOffsets.push_back(offset);
+			break;
+		default:
+			// Record types this reader does not know about are skipped
+			break;
+		}
+
+		offset += sizeof(recordHeader) + recordHeader.ByteSize;
+	}
+
+	return true;
+}
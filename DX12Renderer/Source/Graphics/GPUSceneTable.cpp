@@ -0,0 +1,113 @@
+#include "Pch.h"
+#include "Graphics/GPUSceneTable.h"
+
+GPUSceneTable::GPUSceneTable(uint32_t elementSize, uint32_t capacity, uint32_t numCopies)
+	: m_ElementSize(elementSize), m_Capacity(capacity)
+{
+	m_Data.resize(static_cast<std::size_t>(elementSize) * capacity);
+	m_SlotStates.resize(capacity);
+	m_CopyVersions.resize(numCopies, 0);
+}
+
+void GPUSceneTable::BeginFrame()
+{
+	m_Version++;
+	m_Stats = GPUSceneTableStatistics();
+
+	for (uint32_t slot = 0; slot < m_NumUsedSlots; ++slot)
+		m_SlotStates[slot].IsUpdated = false;
+}
+
+uint32_t GPUSceneTable::Update(uint64_t key, const void* data)
+{
+	unsigned char* slotData = nullptr;
+	uint32_t slot = GPU_SCENE_TABLE_INVALID_SLOT;
+
+	auto iter = m_KeyToSlot.find(key);
+	if (iter != m_KeyToSlot.end())
+	{
+		slot = iter->second;
+		slotData = m_Data.data() + static_cast<std::size_t>(slot) * m_ElementSize;
+
+		if (memcmp(slotData, data, m_ElementSize) != 0)
+		{
+			memcpy(slotData, data, m_ElementSize);
+			m_SlotStates[slot].Version = m_Version;
+			m_Stats.NumChangedEntries++;
+		}
+	}
+	else
+	{
+		if (!m_FreeSlots.empty())
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else if (m_NumUsedSlots < m_Capacity)
+		{
+			slot = m_NumUsedSlots++;
+		}
+
+		ASSERT(slot != GPU_SCENE_TABLE_INVALID_SLOT, "Exceeded the capacity of a GPU scene table");
+		if (slot == GPU_SCENE_TABLE_INVALID_SLOT)
+			return slot;
+
+		slotData = m_Data.data() + static_cast<std::size_t>(slot) * m_ElementSize;
+		memcpy(slotData, data, m_ElementSize);
+
+		SlotState& state = m_SlotStates[slot];
+		state.Key = key;
+		state.Version = m_Version;
+		state.IsAllocated = true;
+
+		m_KeyToSlot.emplace(key, slot);
+		m_Stats.NumNewEntries++;
+	}
+
+	m_SlotStates[slot].IsUpdated = true;
+	return slot;
+}
+
+void GPUSceneTable::EndFrame(uint32_t copyIndex, std::vector<GPUSceneTableUpload>& outUploads)
+{
+	outUploads.clear();
+
+	uint64_t copyVersion = m_CopyVersions[copyIndex];
+	bool isInRange = false;
+
+	for (uint32_t slot = 0; slot < m_NumUsedSlots; ++slot)
+	{
+		SlotState& state = m_SlotStates[slot];
+
+		if (state.IsAllocated && !state.IsUpdated)
+		{
+			m_KeyToSlot.erase(state.Key);
+			m_FreeSlots.push_back(slot);
+			state.IsAllocated = false;
+			m_Stats.NumReleasedEntries++;
+		}
+
+		// Released slots are not referenced by anything the GPU reads this frame, so they do not need to be uploaded
+		bool isDirty = state.IsAllocated && state.Version > copyVersion;
+		if (isDirty && isInRange)
+			outUploads.back().ByteSize += m_ElementSize;
+		else if (isDirty)
+			outUploads.push_back({ static_cast<std::size_t>(slot) * m_ElementSize, m_ElementSize });
+
+		isInRange = isDirty;
+	}
+
+	m_CopyVersions[copyIndex] = m_Version;
+
+	m_Stats.NumEntries = static_cast<uint32_t>(m_KeyToSlot.size());
+	m_Stats.NumUploadRanges = static_cast<uint32_t>(outUploads.size());
+
+	for (const GPUSceneTableUpload& upload : outUploads)
+		m_Stats.NumUploadedBytes += upload.ByteSize;
+}
+
+uint32_t GPUSceneTable::GetSlot(uint64_t key) const
+{
+	auto iter = m_KeyToSlot.find(key);
+	return iter != m_KeyToSlot.end() ? iter->second : GPU_SCENE_TABLE_INVALID_SLOT;
+}
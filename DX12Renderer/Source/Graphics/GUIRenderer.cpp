@@ -1,13 +1,15 @@
 #include "Pch.h"
 #include "Graphics/GUIRenderer.h"
-#include "Graphics/RenderState.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/Backend/CommandQueue.h"
 #include "Graphics/Backend/CommandList.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
+#include "Graphics/Backend/D3D12RenderBackend.h"
 
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_win32.h>
 #include <imgui/imgui_impl_dx12.h>
+#include <implot/implot.h>
 
 ComPtr<ID3D12DescriptorHeap> m_d3d12DescriptorHeap;
 
@@ -16,6 +18,7 @@ void GUIRenderer::Initialize(HWND hWnd)
 	// Set up ImGui context, styles and flags
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
+	ImPlot::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
 
 	io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
@@ -38,7 +41,7 @@ void GUIRenderer::Initialize(HWND hWnd)
 	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	heapDesc.NodeMask = 0;
 
-	auto device = RenderBackend::GetD3D12Device();
+	auto device = D3D12Backend::GetD3D12Device();
 	device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_d3d12DescriptorHeap));
 
 	ImGui_ImplWin32_Init(hWnd);
@@ -60,15 +63,9 @@ void GUIRenderer::EndFrame()
 {
 	ImGui::Render();
 
-	auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+	auto commandList = D3D12Backend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
 	
-	commandList->Transition(*g_RenderState.SDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-	commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-
-	D3D12_CPU_DESCRIPTOR_HANDLE rtv = g_RenderState.SDRColorTarget->GetDescriptor(DescriptorType::RTV);
-	D3D12_CPU_DESCRIPTOR_HANDLE dsv = g_RenderState.DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
-
-	commandList->SetRenderTargets(1, &rtv, &dsv);
+	static_cast<D3D12RenderBackend&>(Renderer::GetBackend()).SetOverlayRenderTargets(*commandList);
 	ID3D12DescriptorHeap* descriptorHeap = m_d3d12DescriptorHeap.Get();
 	commandList->GetGraphicsCommandList()->SetDescriptorHeaps(1, &descriptorHeap);
 
@@ -80,12 +77,13 @@ void GUIRenderer::EndFrame()
 		ImGui::RenderPlatformWindowsDefault(NULL, (void*)commandList->GetGraphicsCommandList().Get());
 	}*/
 
-	RenderBackend::ExecuteCommandListAndWait(commandList);
+	D3D12Backend::ExecuteCommandListAndWait(commandList);
 }
 
 void GUIRenderer::Finalize()
 {
 	ImGui_ImplDX12_Shutdown();
 	ImGui_ImplWin32_Shutdown();
+	ImPlot::DestroyContext();
 	ImGui::DestroyContext();
 }
@@ -0,0 +1,189 @@
+#include "Pch.h"
+#include "Graphics/LightAssignment.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIGHT_ASSIGNMENT_SSE2 1
+#include <emmintrin.h>
+#else
+#define LIGHT_ASSIGNMENT_SSE2 0
+#endif
+
+#include <cmath>
+
+namespace LightAssignment
+{
+
+	struct BoxTestData
+	{
+		glm::vec3 Center;
+		glm::vec3 Extents;
+		// Radius of the bounding sphere of the box, used by the cone test
+		float Radius;
+	};
+
+	static BoxTestData MakeBoxTestData(const BoundingBox& bb)
+	{
+		BoxTestData box;
+		box.Center = (bb.Min + bb.Max) * 0.5f;
+		box.Extents = (bb.Max - bb.Min) * 0.5f;
+		box.Radius = std::sqrt(box.Extents.x * box.Extents.x + box.Extents.y * box.Extents.y + box.Extents.z * box.Extents.z);
+
+		return box;
+	}
+
+	static void AddLight(LightAssignmentLights& lights, const glm::vec3& position, float range, const glm::vec3& direction, float cosAngle, float sinAngle)
+	{
+		lights.PositionX.push_back(position.x);
+		lights.PositionY.push_back(position.y);
+		lights.PositionZ.push_back(position.z);
+		lights.Range.push_back(range);
+		lights.DirectionX.push_back(direction.x);
+		lights.DirectionY.push_back(direction.y);
+		lights.DirectionZ.push_back(direction.z);
+		lights.CosConeAngle.push_back(cosAngle);
+		lights.SinConeAngle.push_back(sinAngle);
+		lights.NumLights++;
+	}
+
+	// Sphere against box by the squared distance to the box, cone against the bounding sphere of the box
+	static bool TestLight(const LightAssignmentLights& lights, uint32_t i, const BoxTestData& box)
+	{
+		float dx = std::max(std::abs(lights.PositionX[i] - box.Center.x) - box.Extents.x, 0.0f);
+		float dy = std::max(std::abs(lights.PositionY[i] - box.Center.y) - box.Extents.y, 0.0f);
+		float dz = std::max(std::abs(lights.PositionZ[i] - box.Center.z) - box.Extents.z, 0.0f);
+		float distanceSquared = dx * dx + dy * dy + dz * dz;
+		bool inRange = distanceSquared <= lights.Range[i] * lights.Range[i];
+
+		float vx = box.Center.x - lights.PositionX[i];
+		float vy = box.Center.y - lights.PositionY[i];
+		float vz = box.Center.z - lights.PositionZ[i];
+		float lengthSquared = vx * vx + vy * vy + vz * vz;
+		float axisDistance = vx * lights.DirectionX[i] + vy * lights.DirectionY[i] + vz * lights.DirectionZ[i];
+		float closestDistance = lights.CosConeAngle[i] * std::sqrt(std::max(lengthSquared - axisDistance * axisDistance, 0.0f)) - axisDistance * lights.SinConeAngle[i];
+
+		bool outsideCone = closestDistance > box.Radius;
+		bool inFront = axisDistance > box.Radius + lights.Range[i];
+		bool behind = axisDistance < -box.Radius;
+
+		return inRange && !outsideCone && !inFront && !behind;
+	}
+
+}
+
+void LightAssignment::AddSpotLight(LightAssignmentLights& lights, const glm::vec3& position, const glm::vec3& direction, float range, float cosOuterConeAngle)
+{
+	ASSERT(lights.NumSpotLights == lights.NumLights, "Spotlights have to be added before pointlights");
+
+	float cosAngle = glm::clamp(cosOuterConeAngle, 0.0f, 1.0f);
+	AddLight(lights, position, range, glm::normalize(direction), cosAngle, std::sqrt(1.0f - cosAngle * cosAngle));
+	lights.NumSpotLights++;
+}
+
+void LightAssignment::AddPointLight(LightAssignmentLights& lights, const glm::vec3& position, float range)
+{
+	AddLight(lights, position, range, glm::vec3(0.0f), 0.0f, 0.0f);
+}
+
+BoundingBox LightAssignment::TransformBoundingBox(const BoundingBox& bb, const glm::mat4& transform)
+{
+	// Every world axis gets the extent of the absolute transformed local extents, which is the box around all transformed corners
+	glm::vec3 center = transform * glm::vec4((bb.Min + bb.Max) * 0.5f, 1.0f);
+	glm::vec3 extents = (bb.Max - bb.Min) * 0.5f;
+
+	glm::vec3 worldExtents = glm::abs(glm::vec3(transform[0])) * extents.x + glm::abs(glm::vec3(transform[1])) * extents.y +
+		glm::abs(glm::vec3(transform[2])) * extents.z;
+
+	BoundingBox worldBB;
+	worldBB.Min = center - worldExtents;
+	worldBB.Max = center + worldExtents;
+
+	return worldBB;
+}
+
+uint32_t LightAssignment::AssignLights(const LightAssignmentLights& lights, const BoundingBox& worldBB, std::vector<uint32_t>& outLightIndices)
+{
+#if LIGHT_ASSIGNMENT_SSE2
+	BoxTestData box = MakeBoxTestData(worldBB);
+	std::size_t firstIndex = outLightIndices.size();
+
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 centerX = _mm_set1_ps(box.Center.x);
+	const __m128 centerY = _mm_set1_ps(box.Center.y);
+	const __m128 centerZ = _mm_set1_ps(box.Center.z);
+	const __m128 extentsX = _mm_set1_ps(box.Extents.x);
+	const __m128 extentsY = _mm_set1_ps(box.Extents.y);
+	const __m128 extentsZ = _mm_set1_ps(box.Extents.z);
+	const __m128 radius = _mm_set1_ps(box.Radius);
+	const __m128 negativeRadius = _mm_set1_ps(-box.Radius);
+
+	uint32_t numSIMDLights = lights.NumLights & ~3u;
+
+	for (uint32_t i = 0; i < numSIMDLights; i += 4)
+	{
+		__m128 positionX = _mm_loadu_ps(&lights.PositionX[i]);
+		__m128 positionY = _mm_loadu_ps(&lights.PositionY[i]);
+		__m128 positionZ = _mm_loadu_ps(&lights.PositionZ[i]);
+		__m128 range = _mm_loadu_ps(&lights.Range[i]);
+
+		// Range sphere against the box
+		__m128 dx = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(signMask, _mm_sub_ps(positionX, centerX)), extentsX), zero);
+		__m128 dy = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(signMask, _mm_sub_ps(positionY, centerY)), extentsY), zero);
+		__m128 dz = _mm_max_ps(_mm_sub_ps(_mm_andnot_ps(signMask, _mm_sub_ps(positionZ, centerZ)), extentsZ), zero);
+		__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 inRange = _mm_cmple_ps(distanceSquared, _mm_mul_ps(range, range));
+
+		// Cone against the bounding sphere of the box
+		__m128 vx = _mm_sub_ps(centerX, positionX);
+		__m128 vy = _mm_sub_ps(centerY, positionY);
+		__m128 vz = _mm_sub_ps(centerZ, positionZ);
+		__m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+		__m128 axisDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(&lights.DirectionX[i])), _mm_mul_ps(vy, _mm_loadu_ps(&lights.DirectionY[i]))),
+			_mm_mul_ps(vz, _mm_loadu_ps(&lights.DirectionZ[i])));
+		__m128 perpendicularDistance = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lengthSquared, _mm_mul_ps(axisDistance, axisDistance)), zero));
+		__m128 closestDistance = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(&lights.CosConeAngle[i]), perpendicularDistance),
+			_mm_mul_ps(axisDistance, _mm_loadu_ps(&lights.SinConeAngle[i])));
+
+		__m128 outsideCone = _mm_cmpgt_ps(closestDistance, radius);
+		__m128 inFront = _mm_cmpgt_ps(axisDistance, _mm_add_ps(radius, range));
+		__m128 behind = _mm_cmplt_ps(axisDistance, negativeRadius);
+		__m128 culled = _mm_or_ps(_mm_or_ps(outsideCone, inFront), behind);
+
+		int overlapMask = _mm_movemask_ps(_mm_andnot_ps(culled, inRange));
+		while (overlapMask)
+		{
+			uint32_t lane = 0;
+			while (!(overlapMask & (1 << lane)))
+				lane++;
+
+			outLightIndices.push_back(i + lane);
+			overlapMask &= overlapMask - 1;
+		}
+	}
+
+	// Remaining lights that do not fill a full register
+	for (uint32_t i = numSIMDLights; i < lights.NumLights; ++i)
+	{
+		if (TestLight(lights, i, box))
+			outLightIndices.push_back(i);
+	}
+
+	return static_cast<uint32_t>(outLightIndices.size() - firstIndex);
+#else
+	return AssignLightsScalar(lights, worldBB, outLightIndices);
+#endif
+}
+
+uint32_t LightAssignment::AssignLightsScalar(const LightAssignmentLights& lights, const BoundingBox& worldBB, std::vector<uint32_t>& outLightIndices)
+{
+	BoxTestData box = MakeBoxTestData(worldBB);
+	std::size_t firstIndex = outLightIndices.size();
+
+	for (uint32_t i = 0; i < lights.NumLights; ++i)
+	{
+		if (TestLight(lights, i, box))
+			outLightIndices.push_back(i);
+	}
+
+	return static_cast<uint32_t>(outLightIndices.size() - firstIndex);
+}
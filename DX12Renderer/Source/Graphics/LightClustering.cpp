@@ -0,0 +1,260 @@
+#include "Pch.h"
+#include "Graphics/LightClustering.h"
+#include "Util/JobSystem.h"
+
+#include <cmath>
+
+namespace LightClustering
+{
+
+	static inline float GetPackedFloat(const glm::vec4* values, uint32_t index)
+	{
+		return values[index / 4][index % 4];
+	}
+
+	static inline void SetPackedFloat(glm::vec4* values, uint32_t index, float value)
+	{
+		values[index / 4][index % 4] = value;
+	}
+
+	// Distance along one axis between a sphere center and the cluster bounds, written exactly like in LightClustering_CS.hlsl
+	static inline float GetAxisDistance(float center, float boundsMin, float boundsMax)
+	{
+		return std::max(std::max(boundsMin - center, center - boundsMax), 0.0f);
+	}
+
+}
+
+LightClusterGridData LightClustering::MakeGridData(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane,
+	const glm::vec2& screenSize, uint32_t numSpotLights, uint32_t numPointLights)
+{
+	ASSERT(nearPlane > 0.0f && farPlane > nearPlane, "Cluster grid needs a positive near plane in front of the far plane");
+	ASSERT(projection[2][3] != 0.0f, "Cluster grid needs a perspective projection");
+
+	LightClusterGridData grid = {};
+	grid.View = view;
+	grid.ScreenSize = screenSize;
+	grid.NumSpotLights = numSpotLights;
+	grid.NumPointLights = numPointLights;
+
+	float logDepthRange = std::log(farPlane / nearPlane);
+	grid.SliceScale = static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_Z) / logDepthRange;
+	grid.SliceBias = -static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_Z) * std::log(nearPlane) / logDepthRange;
+
+	// Tile boundaries in NDC scaled by the inverse projection scale give the view space position per unit of depth,
+	// pixel rows go down while NDC y goes up, so the y slopes start at the top of the screen
+	float invScaleX = 1.0f / projection[0][0];
+	float invScaleY = 1.0f / projection[1][1];
+
+	for (uint32_t x = 0; x <= LIGHT_CLUSTER_GRID_SIZE_X; ++x)
+	{
+		float ndc = 2.0f * static_cast<float>(x) / static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_X) - 1.0f;
+		SetPackedFloat(grid.TileSlopesX, x, ndc * invScaleX);
+	}
+
+	for (uint32_t y = 0; y <= LIGHT_CLUSTER_GRID_SIZE_Y; ++y)
+	{
+		float ndc = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_Y);
+		SetPackedFloat(grid.TileSlopesY, y, ndc * invScaleY);
+	}
+
+	// Exponential slices keep clusters roughly cubic, the outer boundaries are set directly to avoid drift from pow
+	for (uint32_t z = 0; z <= LIGHT_CLUSTER_GRID_SIZE_Z; ++z)
+	{
+		float depth = nearPlane * std::pow(farPlane / nearPlane, static_cast<float>(z) / static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_Z));
+		SetPackedFloat(grid.SliceDepths, z, depth);
+	}
+	SetPackedFloat(grid.SliceDepths, 0, nearPlane);
+	SetPackedFloat(grid.SliceDepths, LIGHT_CLUSTER_GRID_SIZE_Z, farPlane);
+
+	return grid;
+}
+
+glm::vec4 LightClustering::GetPointLightBoundingSphere(const glm::vec3& position, float range)
+{
+	return glm::vec4(position, range);
+}
+
+glm::vec4 LightClustering::GetSpotLightBoundingSphere(const glm::vec3& position, const glm::vec3& direction, float range, float cosOuterConeAngle)
+{
+	// Smallest sphere around the cone, wide cones are bounded by their cap, narrow ones by the sphere through the apex and the cap rim
+	glm::vec3 dir = glm::normalize(direction);
+	float cosAngle = glm::clamp(cosOuterConeAngle, 0.0f, 1.0f);
+
+	if (cosAngle < 0.70710678f)
+	{
+		float sinAngle = std::sqrt(1.0f - cosAngle * cosAngle);
+		return glm::vec4(position + dir * range * cosAngle, range * sinAngle);
+	}
+
+	float radius = range / (2.0f * cosAngle);
+	return glm::vec4(position + dir * radius, radius);
+}
+
+void LightClustering::TransformSpheresToViewSpace(const LightClusterGridData& grid, const std::vector<glm::vec4>& worldSpheres, std::vector<glm::vec4>& viewSpheres)
+{
+	viewSpheres.resize(worldSpheres.size());
+
+	for (std::size_t i = 0; i < worldSpheres.size(); ++i)
+	{
+		glm::vec4 viewCenter = grid.View * glm::vec4(glm::vec3(worldSpheres[i]), 1.0f);
+		viewSpheres[i] = glm::vec4(glm::vec3(viewCenter), worldSpheres[i].w);
+	}
+}
+
+void LightClustering::CalculateClusterBounds(const LightClusterGridData& grid, uint32_t clusterIndex, glm::vec3& outMin, glm::vec3& outMax)
+{
+	uint32_t x = clusterIndex % LIGHT_CLUSTER_GRID_SIZE_X;
+	uint32_t y = (clusterIndex / LIGHT_CLUSTER_GRID_SIZE_X) % LIGHT_CLUSTER_GRID_SIZE_Y;
+	uint32_t z = clusterIndex / (LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y);
+
+	float nearDepth = GetPackedFloat(grid.SliceDepths, z);
+	float farDepth = GetPackedFloat(grid.SliceDepths, z + 1);
+
+	// The frustum widens with depth, so the extremes of the left/bottom boundaries and the right/top boundaries are at either slice depth
+	float slopeLeft = GetPackedFloat(grid.TileSlopesX, x);
+	float slopeRight = GetPackedFloat(grid.TileSlopesX, x + 1);
+	float slopeBottom = GetPackedFloat(grid.TileSlopesY, y + 1);
+	float slopeTop = GetPackedFloat(grid.TileSlopesY, y);
+
+	outMin.x = std::min(slopeLeft * nearDepth, slopeLeft * farDepth);
+	outMax.x = std::max(slopeRight * nearDepth, slopeRight * farDepth);
+	outMin.y = std::min(slopeBottom * nearDepth, slopeBottom * farDepth);
+	outMax.y = std::max(slopeTop * nearDepth, slopeTop * farDepth);
+	outMin.z = nearDepth;
+	outMax.z = farDepth;
+}
+
+uint32_t LightClustering::GetClusterIndex(const LightClusterGridData& grid, const glm::vec2& pixel, float viewDepth)
+{
+	uint32_t x = std::min(static_cast<uint32_t>(pixel.x / grid.ScreenSize.x * LIGHT_CLUSTER_GRID_SIZE_X), LIGHT_CLUSTER_GRID_SIZE_X - 1);
+	uint32_t y = std::min(static_cast<uint32_t>(pixel.y / grid.ScreenSize.y * LIGHT_CLUSTER_GRID_SIZE_Y), LIGHT_CLUSTER_GRID_SIZE_Y - 1);
+
+	float slice = std::log(std::max(viewDepth, 1e-6f)) * grid.SliceScale + grid.SliceBias;
+	uint32_t z = static_cast<uint32_t>(glm::clamp(slice, 0.0f, static_cast<float>(LIGHT_CLUSTER_GRID_SIZE_Z - 1)));
+
+	return x + y * LIGHT_CLUSTER_GRID_SIZE_X + z * LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y;
+}
+
+void LightClustering::BuildClusters(const LightClusterGridData& grid, const std::vector<glm::vec4>& viewSpheres, LightClusterLists& lists, uint32_t firstCluster, uint32_t numClusters)
+{
+	ASSERT(lists.LightCounts.size() == LIGHT_CLUSTER_COUNT && lists.LightIndices.size() == LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS, "Light cluster lists are not sized for the grid");
+	ASSERT(firstCluster + numClusters <= LIGHT_CLUSTER_COUNT, "Cluster range is out of bounds");
+
+	// The y and z bounds are shared by a row of clusters, lights that fail the y and z part of the test are skipped for the whole row.
+	// Rounding is monotonic and the skipped terms are never negative, so this never rejects a light the full test below accepts
+	std::vector<uint32_t> rowLights;
+	rowLights.reserve(viewSpheres.size());
+	uint32_t currentRow = ~0u;
+
+	for (uint32_t clusterIndex = firstCluster; clusterIndex < firstCluster + numClusters; ++clusterIndex)
+	{
+		glm::vec3 boundsMin, boundsMax;
+		CalculateClusterBounds(grid, clusterIndex, boundsMin, boundsMax);
+
+		uint32_t row = clusterIndex / LIGHT_CLUSTER_GRID_SIZE_X;
+		if (row != currentRow)
+		{
+			currentRow = row;
+			rowLights.clear();
+
+			for (uint32_t lightIndex = 0; lightIndex < static_cast<uint32_t>(viewSpheres.size()); ++lightIndex)
+			{
+				const glm::vec4& sphere = viewSpheres[lightIndex];
+				float dy = GetAxisDistance(sphere.y, boundsMin.y, boundsMax.y);
+				float dz = GetAxisDistance(sphere.z, boundsMin.z, boundsMax.z);
+
+				if (dy * dy + dz * dz <= sphere.w * sphere.w)
+					rowLights.push_back(lightIndex);
+			}
+		}
+
+		uint32_t numLights = 0;
+		uint32_t* clusterLights = &lists.LightIndices[clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS];
+
+		for (uint32_t lightIndex : rowLights)
+		{
+			const glm::vec4& sphere = viewSpheres[lightIndex];
+			float dx = GetAxisDistance(sphere.x, boundsMin.x, boundsMax.x);
+			float dy = GetAxisDistance(sphere.y, boundsMin.y, boundsMax.y);
+			float dz = GetAxisDistance(sphere.z, boundsMin.z, boundsMax.z);
+
+			float distanceSquared = dx * dx + dy * dy;
+			distanceSquared = distanceSquared + dz * dz;
+
+			if (distanceSquared <= sphere.w * sphere.w)
+			{
+				if (numLights < LIGHT_CLUSTER_MAX_LIGHTS)
+					clusterLights[numLights] = lightIndex;
+
+				numLights++;
+			}
+		}
+
+		lists.LightCounts[clusterIndex] = numLights;
+	}
+}
+
+void LightClustering::BuildClusters(const LightClusterGridData& grid, const std::vector<glm::vec4>& viewSpheres, LightClusterLists& lists)
+{
+	lists.LightCounts.resize(LIGHT_CLUSTER_COUNT);
+	lists.LightIndices.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+
+	// One job per depth slice, every job writes its own range of the lists
+	constexpr uint32_t numClustersPerSlice = LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y;
+	JobCounter jobs;
+
+	for (uint32_t z = 0; z < LIGHT_CLUSTER_GRID_SIZE_Z; ++z)
+	{
+		JobSystem::Execute(jobs, [&grid, &viewSpheres, &lists, z]()
+		{
+			BuildClusters(grid, viewSpheres, lists, z * numClustersPerSlice, numClustersPerSlice);
+		});
+	}
+
+	JobSystem::Wait(jobs);
+}
+
+LightClusterStatistics LightClustering::GetStatistics(const LightClusterLists& lists, uint32_t numLights)
+{
+	LightClusterStatistics stats;
+	stats.NumLights = numLights;
+
+	for (uint32_t count : lists.LightCounts)
+	{
+		uint32_t numStored = std::min(count, LIGHT_CLUSTER_MAX_LIGHTS);
+
+		stats.NumLightAssignments += numStored;
+		stats.NumDroppedAssignments += count - numStored;
+		stats.NumOccupiedClusters += count > 0 ? 1 : 0;
+		stats.MaxLightsInCluster = std::max(stats.MaxLightsInCluster, count);
+	}
+
+	return stats;
+}
+
+uint32_t LightClustering::CompareClusters(const LightClusterLists& lhs, const LightClusterLists& rhs)
+{
+	ASSERT(lhs.LightCounts.size() == LIGHT_CLUSTER_COUNT && rhs.LightCounts.size() == LIGHT_CLUSTER_COUNT, "Light cluster lists are not sized for the grid");
+
+	uint32_t numMismatches = 0;
+
+	for (uint32_t clusterIndex = 0; clusterIndex < LIGHT_CLUSTER_COUNT; ++clusterIndex)
+	{
+		uint32_t count = lhs.LightCounts[clusterIndex];
+		if (count != rhs.LightCounts[clusterIndex])
+		{
+			numMismatches++;
+			continue;
+		}
+
+		// Only the stored slots are meaningful, the remaining ones are never written
+		std::size_t first = clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS;
+		uint32_t numStored = std::min(count, LIGHT_CLUSTER_MAX_LIGHTS);
+
+		if (!std::equal(lhs.LightIndices.begin() + first, lhs.LightIndices.begin() + first + numStored, rhs.LightIndices.begin() + first))
+			numMismatches++;
+	}
+
+	return numMismatches;
+}
@@ -1,15 +1,34 @@
 #include "Pch.h"
 #include "Graphics/RasterPass.h"
 #include "Graphics/Shader.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 RasterPass::RasterPass(const std::string& name, const RasterPassDesc& desc)
 	: m_Name(name), m_Desc(desc)
 {
+	if (!m_Desc.PixelShaderPermutations.Variants.empty())
+		m_Permutations = ShaderPermutationSet(m_Desc.PixelShaderPermutations);
+
 	CreateRootSignature();
 	CreatePipelineState();
 }
 
+ID3D12PipelineState* RasterPass::GetD3D12PipelineState(uint32_t variant) const
+{
+	return D3D12Backend::GetPipelineState(m_PipelineStateIDs[variant]);
+}
+
+bool RasterPass::IsReady() const
+{
+	for (uint32_t pipelineStateID : m_PipelineStateIDs)
+	{
+		if (!D3D12Backend::GetPipelineState(pipelineStateID))
+			return false;
+	}
+
+	return true;
+}
+
 void RasterPass::CreateRootSignature()
 {
 	D3D12_ROOT_SIGNATURE_FLAGS rootSignatureFlags =
@@ -64,15 +83,35 @@ void RasterPass::CreateRootSignature()
 		errorBlob->Release();
 	}
 
-	DX_CALL(RenderBackend::GetD3D12Device()->CreateRootSignature(0, serializedRootSig->GetBufferPointer(),
+	DX_CALL(D3D12Backend::GetD3D12Device()->CreateRootSignature(0, serializedRootSig->GetBufferPointer(),
 		serializedRootSig->GetBufferSize(), IID_PPV_ARGS(&m_d3d12RootSignature)));
 	m_d3d12RootSignature->SetName(StringHelper::StringToWString(m_Name + " root signature").c_str());
+	m_RootSignatureHash = Hash::Bytes(serializedRootSig->GetBufferPointer(), serializedRootSig->GetBufferSize());
 }
 
 void RasterPass::CreatePipelineState()
 {
-	m_VertexShader = std::make_unique<Shader>(StringHelper::StringToWString(m_Desc.VertexShaderPath), "main", "vs_6_0");
-	m_PixelShader = std::make_unique<Shader>(StringHelper::StringToWString(m_Desc.PixelShaderPath), "main", "ps_6_0");
+	// The variants are compiled in one batch so they compile in parallel, the shaders below take them from the memory of the shader cache
+	uint32_t numVariants = m_Permutations.GetNumVariants();
+	std::vector<ShaderCompileDesc> shaderDescs(numVariants + 1);
+	shaderDescs[0].Filepath = m_Desc.VertexShaderPath;
+	shaderDescs[0].Target = SHADER_TARGET_VERTEX;
+	shaderDescs[0].Defines = m_Desc.ShaderDefines;
+
+	for (uint32_t variant = 0; variant < numVariants; ++variant)
+	{
+		shaderDescs[variant + 1].Filepath = m_Desc.PixelShaderPath;
+		shaderDescs[variant + 1].Target = SHADER_TARGET_PIXEL;
+		ShaderPermutation::GetDefines(m_Permutations.GetVariantFeatures(variant), shaderDescs[variant + 1].Defines);
+		shaderDescs[variant + 1].Defines.insert(shaderDescs[variant + 1].Defines.begin(), m_Desc.ShaderDefines.begin(), m_Desc.ShaderDefines.end());
+	}
+
+	std::vector<std::shared_ptr<const ShaderBinary>> binaries;
+	ShaderCache::CompileShaders(shaderDescs, binaries);
+
+	m_VertexShader = std::make_unique<Shader>(m_Desc.VertexShaderPath, "main", SHADER_TARGET_VERTEX, m_Desc.ShaderDefines);
+	for (uint32_t variant = 0; variant < numVariants; ++variant)
+		m_PixelShaders.push_back(std::make_unique<Shader>(m_Desc.PixelShaderPath, "main", SHADER_TARGET_PIXEL, shaderDescs[variant + 1].Defines));
 
 	D3D12_BLEND_DESC blendDesc = {};
 	blendDesc.AlphaToCoverageEnable = FALSE;
@@ -81,9 +120,9 @@ void RasterPass::CreatePipelineState()
 		blendDesc.RenderTarget[i] = m_Desc.ColorBlendDesc[i];
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-	psoDesc.InputLayout = { &m_Desc.ShaderInputLayout[0], static_cast<uint32_t>(m_Desc.ShaderInputLayout.size()) };
+	// Passes that generate their vertices in the vertex shader have no input layout
+	psoDesc.InputLayout = { m_Desc.ShaderInputLayout.data(), static_cast<uint32_t>(m_Desc.ShaderInputLayout.size()) };
 	psoDesc.VS = m_VertexShader->GetShaderByteCode();
-	psoDesc.PS = m_PixelShader->GetShaderByteCode();
 	psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	psoDesc.BlendState = blendDesc;
 	psoDesc.DepthStencilState.DepthEnable = m_Desc.DepthEnabled ? TRUE : FALSE;
@@ -91,7 +130,7 @@ void RasterPass::CreatePipelineState()
 	if (m_Desc.DepthEnabled)
 	{
 		psoDesc.DSVFormat = TextureFormatToDXGIFormat(m_Desc.DepthAttachmentDesc.Format);
-		psoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
+		psoDesc.DepthStencilState.DepthWriteMask = m_Desc.DepthWriteEnabled ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
 		psoDesc.DepthStencilState.DepthFunc = m_Desc.DepthComparisonFunc;
 		psoDesc.RasterizerState.DepthBias = m_Desc.DepthBias;
 		psoDesc.RasterizerState.SlopeScaledDepthBias = m_Desc.SlopeScaledDepthBias;
@@ -109,6 +148,14 @@ void RasterPass::CreatePipelineState()
 	psoDesc.SampleDesc.Count = 1;
 	psoDesc.pRootSignature = m_d3d12RootSignature.Get();
 
-	DX_CALL(RenderBackend::GetD3D12Device()->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_d3d12PipelineState)));
-	m_d3d12PipelineState->SetName(StringHelper::StringToWString(m_Name + " pipeline state").c_str());
+	for (uint32_t variant = 0; variant < numVariants; ++variant)
+	{
+		psoDesc.PS = m_PixelShaders[variant]->GetShaderByteCode();
+
+		std::string name = m_Name + " pipeline state";
+		if (numVariants > 1)
+			name += " (" + ShaderPermutation::GetFeatureString(m_Permutations.GetVariantFeatures(variant)) + ")";
+
+		m_PipelineStateIDs.push_back(D3D12Backend::CreateGraphicsPipelineState(name, psoDesc, m_RootSignatureHash));
+	}
 }
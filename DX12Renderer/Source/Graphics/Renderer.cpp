@@ -3,22 +3,31 @@
 #include "Graphics/RenderState.h"
 #include "Graphics/RenderAPI.h"
 #include "Graphics/ResourceSlotmap.h"
-#include "Graphics/DebugRenderer.h"
-#include "Graphics/Buffer.h"
-#include "Graphics/Texture.h"
-#include "Graphics/Shader.h"
-#include "Graphics/RasterPass.h"
-#include "Graphics/ComputePass.h"
+#include "Graphics/LODSelection.h"
+#include "Graphics/FrameCapture.h"
+#include "Graphics/LightClustering.h"
+#include "Graphics/LightAssignment.h"
+#include "Graphics/ShadowCascades.h"
+#include "Graphics/ShadowCache.h"
+#include "Graphics/ShadowCasterCulling.h"
+#include "Graphics/ShadowAtlas.h"
+#include "Graphics/ShadowScheduler.h"
+#include "Graphics/GPUSceneTable.h"
+#include "Graphics/ShaderPermutation.h"
 #include "Components/DirLightComponent.h"
 #include "Components/SpotLightComponent.h"
 #include "Components/PointLightComponent.h"
 
-#include "Graphics/Backend/CommandList.h"
-#include "Graphics/Backend/SwapChain.h"
-#include "Graphics/Backend/DescriptorHeap.h"
 #include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/GPUProfiler.h"
 
+// The portable core (see CMakeLists.txt) is built without the debug renderer and ImGui
+#if !defined(DX12R_PORTABLE_CORE)
+#include "Graphics/DebugRenderer.h"
 #include <imgui/imgui.h>
+#endif
+
+#include <filesystem>
 
 static constexpr glm::vec2 HaltonJitterSamples[16] = {
     { 0.500000f, 0.333333f },
@@ -44,21 +53,6 @@ glm::vec2 GetRandomHaltonJitter(uint32_t renderWidth, uint32_t renderHeight)
     return (2.0f * HaltonJitterSamples[Random::UintRange(0, 15)] - 1.0f) / glm::vec2(renderWidth, renderHeight);
 }
 
-enum RenderPassType : uint32_t
-{
-    SHADOW_MAPPING,
-    DEPTH_PREPASS,
-    LIGHTING,
-    NUM_RENDER_PASSES
-};
-
-enum ComputePassType : uint32_t
-{
-    TEMPORAL_ANTI_ALIASING,
-    POST_PROCESS,
-    NUM_COMPUTE_PASSES
-};
-
 struct MaterialData
 {
     uint32_t AlbedoTextureIndex = 0;
@@ -66,7 +60,8 @@ struct MaterialData
     uint32_t MetallicRoughnessTextureIndex = 0;
     float Metalness = 0.0f;
     float Roughness = 0.3f;
-    BYTE_PADDING(12);
+    float AlphaCutoff = 0.5f;
+    BYTE_PADDING(8);
 };;
 
 struct MeshInstanceData
@@ -74,40 +69,209 @@ struct MeshInstanceData
     glm::mat4 Transform = glm::identity<glm::mat4>();
     glm::mat4 PrevFrameTransform = glm::identity<glm::mat4>();
     uint32_t MaterialID = 0;
+    // Range of the instance in the instance light index buffer, written in Render once all lights are submitted
+    uint32_t LightListOffset = 0;
+    uint32_t NumLights = 0;
+    // Dequantization of the position stream of the mesh
+    glm::vec3 PositionScale = glm::vec3(1.0f);
+    glm::vec3 PositionOffset = glm::vec3(0.0f);
+};
+
+// Instances of all transparency modes share the instance table, every copy of the material table starts at a constant buffer boundary
+static constexpr uint32_t MAX_INSTANCE_TABLE_ENTRIES = RenderState::MAX_MESH_INSTANCES * TransparencyMode::NUM_ALPHA_MODES;
+static constexpr std::size_t MATERIAL_TABLE_COPY_BYTE_SIZE = (RenderState::MAX_MATERIALS * sizeof(MaterialData) + 255) & ~static_cast<std::size_t>(255);
+// The light cluster grid and the light spheres are rewritten every frame, so they have one copy per back buffer as well
+static constexpr std::size_t LIGHT_CLUSTER_GRID_COPY_BYTE_SIZE = (sizeof(LightClusterGridData) + 255) & ~static_cast<std::size_t>(255);
+static constexpr uint32_t MAX_LIGHT_SPHERES = RenderState::MAX_SPOT_LIGHTS + RenderState::MAX_POINT_LIGHTS;
+// Per instance light lists, worst case every instance of every transparency mode overlaps every light
+static constexpr uint32_t MAX_INSTANCE_LIGHT_INDICES = MAX_INSTANCE_TABLE_ENTRIES * (RenderState::MAX_SPOT_LIGHTS + RenderState::MAX_POINT_LIGHTS);
+
+// Which mesh submissions a shadow map draws, static casters are drawn separately when they are cached
+// Depth-only passes bind the position stream of a mesh, the lighting pass binds its attribute stream as well.
+// Alpha tested depth-only passes bind both for the texture coordinates, they are counted as depth pass vertex data
+enum MeshVertexStreams : uint32_t
+{
+    MESH_VERTEX_STREAMS_POSITIONS,
+    MESH_VERTEX_STREAMS_ALPHA_TEST,
+    MESH_VERTEX_STREAMS_ALL
+};
+
+enum ShadowCasterFilter : uint32_t
+{
+    SHADOW_CASTERS_ALL,
+    SHADOW_CASTERS_STATIC,
+    SHADOW_CASTERS_DYNAMIC
 };
 
 struct MeshSubmission
 {
-    Mesh* Mesh;
+    ::Mesh* Mesh;
+    RenderResourceHandle MeshHandle;
     MeshInstanceData InstanceData;
+    // Key and slot of the instance in the instance table, the slot is assigned once all lights are submitted
+    uint64_t ObjectID;
+    uint32_t InstanceSlot;
+    // Shader features of the material in the high bits, opaque and masked submissions are drawn in the order of their keys
+    uint64_t SortKey;
+    // Did not move since the previous frame
+    bool IsStatic;
+};
+
+// Part of the shadow atlas light ID, so one scene object can have lights of different types
+enum ShadowLightType : uint64_t
+{
+    SHADOW_LIGHT_TYPE_DIRECTIONAL,
+    SHADOW_LIGHT_TYPE_SPOT,
+    SHADOW_LIGHT_TYPE_POINT,
+    SHADOW_LIGHT_TYPE_NUM_TYPES
 };
 
 struct LightSubmission
 {
-    Texture* ShadowMap;
-    uint32_t Face;
+    // All submissions of a light are consecutive, one per shadow atlas tile (cascade or pointlight face)
+    uint64_t LightID;
+    uint32_t Tile;
     Camera LightCamera;
+    // Type of the light and its index in the submitted lights of that type, used to point the light data at the shadow map of the view
+    ShadowLightType LightType;
+    std::size_t LightIndex;
+};
+
+// A light submission with a tile in the shadow atlas, shadow maps are cached and updated per view
+struct ShadowView
+{
+    std::size_t LightSubmission = 0;
+    ShadowAtlasTile Tile;
+    uint64_t ViewID = 0;
+
+    // Rendered this frame, otherwise the tile keeps the shadow map of the last update
+    bool Update = false;
+
+    bool RenderStaticLayer = false;
+    bool ComposeStaticLayer = false;
+    bool HasDynamicCasters = false;
+};
+
+struct ShadowViewState
+{
+    ShadowCacheEntry CacheEntry;
+    // The tile in the shadow atlas still contains exactly the static layer, no dynamic caster was drawn into it since
+    bool HoldsStaticLayer = false;
+
+    // Tile and view projection of the last update, a view that is not rendered in a frame is sampled with them
+    bool HasContent = false;
+    ShadowAtlasTile RenderedTile;
+    glm::mat4 RenderedViewProjection = glm::identity<glm::mat4>();
+
+    // States of views that are no longer in the shadow atlas are released
+    bool IsUsed = false;
+};
+
+// The depth pre-pass and lighting zones are nested in the geometry zone of their transparency mode
+struct RendererGPUZones
+{
+    uint32_t Scene = 0;
+    uint32_t ShadowMapping = 0;
+    uint32_t LightClustering = 0;
+    uint32_t Geometry[TransparencyMode::NUM_ALPHA_MODES] = {};
+    uint32_t DepthPrepass = 0;
+    uint32_t Lighting = 0;
+    uint32_t TemporalAA = 0;
+    uint32_t PostProcess = 0;
 };
 
 struct InternalRendererData
 {
-    // Render passes
-    std::unique_ptr<RasterPass> RenderPasses[RenderPassType::NUM_RENDER_PASSES];
-    std::unique_ptr<ComputePass> ComputePasses[ComputePassType::NUM_COMPUTE_PASSES];
+    // Graphics API the renderer records its passes with
+    std::unique_ptr<RenderBackend> Backend;
+    // Variants of the lighting passes, a draw picks the variant that fits the shader features of its material
+    ShaderPermutationSet LightingPermutations = ShaderPermutationSet(ShaderPermutation::GetLightingManifest());
+    // Frames that were not rendered since the pipeline states of the passes were still being created
+    uint32_t NumFramesWaitingForPipelineStates = 0;
+    bool ArePipelineStatesReady = false;
 
     // Scene data and buffer
     Camera SceneCamera;
-    SceneData SceneData;
+    ::SceneData SceneData;
 
-    // Trackers for current mesh, mesh instance, and material count
-    std::size_t OpaqueMeshCount = 0;
-    std::size_t TransparentMeshCount = 0;
-    std::size_t MaterialCount = 0;
+    // Trackers for current mesh and mesh instance count
+    std::size_t MeshCounts[TransparencyMode::NUM_ALPHA_MODES] = {};
     std::size_t LightCount = 0;
 
-    std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES> OpaqueMeshSubmissions;
-    std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES> TransparentMeshSubmissions;
-    std::array<LightSubmission, RenderState::MAX_DIR_LIGHTS * RenderState::MAX_SPOT_LIGHTS * (RenderState::MAX_POINT_LIGHTS * 6)> LightSubmissions;
+    // Shader features every draw of the frame meets, added to the features of the material when a draw picks its shader variant
+    uint32_t FrameShaderFeatures = SHADER_FEATURE_NONE;
+
+    // Persistent instance and material tables, instances are keyed by their object ID and materials by their handle.
+    // The GPU reads the copy of the current back buffer, which only receives the entries that changed since it was last used
+    // Both are allocated in Initialize and released in Finalize
+    GPUSceneTable InstanceTable = GPUSceneTable(sizeof(MeshInstanceData), 0, RenderState::BACK_BUFFER_COUNT);
+    GPUSceneTable MaterialTable = GPUSceneTable(sizeof(MaterialData), 0, RenderState::BACK_BUFFER_COUNT);
+    std::vector<GPUSceneTableUpload> SceneTableUploads;
+    uint32_t SceneTableCopyIndex = 0;
+
+    // Submissions split by the transparency mode of their material, everything indexed by submission follows the order of the modes
+    std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES> MeshSubmissions[TransparencyMode::NUM_ALPHA_MODES];
+    std::array<LightSubmission, RenderState::MAX_DIR_LIGHTS * MAX_SHADOW_CASCADES + RenderState::MAX_SPOT_LIGHTS + RenderState::MAX_POINT_LIGHTS * 6> LightSubmissions;
+
+    // Submitted directional light, its shadow cascades are fitted to the scene camera once all meshes of the frame are known
+    DirectionalLightData DirLight;
+    uint64_t DirLightID = 0;
+    std::array<ShadowCascade, MAX_SHADOW_CASCADES> DirLightCascades;
+    std::size_t CapturedDirLightIndex = 0;
+
+    // Shadow atlas tiles of all lights, assigned every frame once the lights are known
+    ShadowAtlas ShadowAtlasTiles;
+    std::vector<ShadowAtlasRequest> ShadowAtlasRequests;
+    std::vector<ShadowView> ShadowViews;
+    std::vector<ShadowAtlasTile> ShadowAtlasClearTiles;
+
+    // Time-sliced shadow updates, the cached static layer and the last update of every shadow view, by view ID
+    ShadowScheduler ShadowUpdateScheduler;
+    std::vector<ShadowViewRequest> ShadowViewRequests;
+    std::vector<uint8_t> ShadowViewUpdates;
+    std::unordered_map<uint64_t, ShadowViewState> ShadowViewStates;
+
+    // Shadow caster culling, world bounds of all mesh submissions (opaque first, then transparent) and the visible receiver region
+    // Every light submission has one visibility byte per mesh submission, at LightSubmission index * number of mesh submissions
+    BoundingBox SceneBB;
+    std::vector<BoundingBox> ShadowCasterBounds;
+    std::vector<glm::vec3> ShadowReceiverPoints;
+    std::vector<uint8_t> ShadowCasterMasks;
+
+    // Submitted spot and pointlights, used for light culling and shadow atlas tiles once all lights of the frame are known
+    // The light data is uploaded once the shadow atlas rects are known
+    std::vector<SpotLightData> SpotLights;
+    std::vector<uint64_t> SpotLightIDs;
+    std::vector<PointLightData> PointLights;
+    std::vector<uint64_t> PointLightIDs;
+
+    // Clustered lighting
+    std::vector<glm::vec4> ViewLightSpheres;
+    LightClusterGridData ClusterGrid;
+
+    // Per instance light lists
+    LightAssignmentLights AssignmentLights;
+    std::vector<uint32_t> InstanceLightIndices;
+
+    // Validation of the GPU cluster build against the CPU reference, requested from ImGui and run during the next frame
+    bool IsClusterValidationRequested = false;
+    bool HasClusterValidation = false;
+    uint32_t NumClusterMismatches = 0;
+    LightClusterStatistics ClusterStats;
+
+    // Frame capture, a capture only starts at the next BeginScene so partially submitted frames are never written
+    std::unique_ptr<FrameCaptureWriter> CaptureWriter;
+    ::CapturedFrame CapturedFrame;
+    uint32_t NumFramesToCapture = 0;
+    bool IsCapturingFrame = false;
+
+    // GPU profiler zones, registered once when the renderer is initialized
+    RendererGPUZones GPUZones;
+
+    // Destroyed buffers and textures with the frame they were destroyed in, they stay in their slotmap until the frames in flight are done with them
+    uint64_t FrameIndex = 0;
+    std::vector<std::pair<RenderResourceHandle, uint64_t>> DestroyedBuffers;
+    std::vector<std::pair<RenderResourceHandle, uint64_t>> DestroyedTextures;
 };
 
 static InternalRendererData s_Data;
@@ -115,184 +279,28 @@ static InternalRendererData s_Data;
 namespace Renderer
 {
 
-    void CreateRenderPasses()
+    template<typename Resource_t>
+    void EraseDestroyedResources(ResourceSlotmap<Resource_t>& slotmap, std::vector<std::pair<RenderResourceHandle, uint64_t>>& destroyedResources, bool eraseAll)
     {
-        D3D12_RENDER_TARGET_BLEND_DESC defaultBlendDesc = {};
-        defaultBlendDesc.BlendEnable = TRUE;
-        defaultBlendDesc.LogicOpEnable = FALSE;
-        defaultBlendDesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
-        defaultBlendDesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
-        defaultBlendDesc.BlendOp = D3D12_BLEND_OP_ADD;
-        defaultBlendDesc.SrcBlendAlpha = D3D12_BLEND_SRC_ALPHA;
-        defaultBlendDesc.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
-        defaultBlendDesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
-        defaultBlendDesc.LogicOp = D3D12_LOGIC_OP_NOOP;
-        defaultBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
-
-        {
-            // Shadow mapping render pass
-            RasterPassDesc desc;
-            desc.VertexShaderPath = "Resources/Shaders/ShadowMapping_VS.hlsl";
-            desc.PixelShaderPath = "Resources/Shaders/ShadowMapping_PS.hlsl";
-
-            desc.NumColorAttachments = 0;
-            desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
-            desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-            desc.DepthAttachmentDesc.Width = g_RenderState.Settings.ShadowMapResolution.x;
-            desc.DepthAttachmentDesc.Height = g_RenderState.Settings.ShadowMapResolution.y;
-
-            desc.DepthBias = -50;
-            desc.SlopeScaledDepthBias = -5.0f;
-            desc.DepthBiasClamp = 1.0f;
-
-            desc.RootParameters.resize(1);
-            desc.RootParameters[0].InitAsConstants(16, 0); // Light VP
-
-            desc.ShaderInputLayout.push_back({ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-
-            s_Data.RenderPasses[RenderPassType::SHADOW_MAPPING] = std::make_unique<RasterPass>("Shadow mapping", desc);
-        }
+        auto iter = std::remove_if(destroyedResources.begin(), destroyedResources.end(), [&slotmap, eraseAll](const std::pair<RenderResourceHandle, uint64_t>& destroyed) {
+            if (!eraseAll && destroyed.second + RenderState::BACK_BUFFER_COUNT > s_Data.FrameIndex)
+                return false;
 
-        {
-            // Depth pre-pass
-            RasterPassDesc desc;
-            desc.VertexShaderPath = "Resources/Shaders/DepthPrepass_VS.hlsl";
-            desc.PixelShaderPath = "Resources/Shaders/DepthPrepass_PS.hlsl";
-
-            desc.NumColorAttachments = 0;
-            desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH;
-            desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-            desc.DepthAttachmentDesc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.DepthAttachmentDesc.Height = g_RenderState.Settings.RenderResolution.y;
-
-            desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_LESS;
-
-            desc.RootParameters.resize(2);
-            desc.RootParameters[0].InitAsConstantBufferView(0); // Global constant buffer
-            desc.RootParameters[1].InitAsConstantBufferView(1); // Scene data constant buffer
-
-            desc.ShaderInputLayout.push_back({ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-
-            s_Data.RenderPasses[RenderPassType::DEPTH_PREPASS] = std::make_unique<RasterPass>("Depth pre-pass", desc);
-        }
+            Resource_t* resource = slotmap.Find(destroyed.first);
+            if (resource)
+                s_Data.Backend->ReleaseResource(resource->Resource);
 
-        {
-            // Lighting render pass
-            RasterPassDesc desc;
-            desc.VertexShaderPath = "Resources/Shaders/Lighting_VS.hlsl";
-            desc.PixelShaderPath = "Resources/Shaders/Lighting_PS.hlsl";
-
-            desc.NumColorAttachments = 2;
-            desc.ColorBlendDesc[0] = defaultBlendDesc;
-            desc.ColorAttachmentDesc[0].Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
-            desc.ColorAttachmentDesc[0].Format = TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT;
-            desc.ColorAttachmentDesc[0].Width = g_RenderState.Settings.RenderResolution.x;
-            desc.ColorAttachmentDesc[0].Height = g_RenderState.Settings.RenderResolution.y;
-
-            desc.ColorBlendDesc[1] = defaultBlendDesc;
-            desc.ColorBlendDesc[1].BlendEnable = FALSE;
-            desc.ColorAttachmentDesc[1].Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
-            desc.ColorAttachmentDesc[1].Format = TextureFormat::TEXTURE_FORMAT_RG16_FLOAT;
-            desc.ColorAttachmentDesc[1].Width = g_RenderState.Settings.RenderResolution.x;
-            desc.ColorAttachmentDesc[1].Height = g_RenderState.Settings.RenderResolution.y;
-
-            desc.DepthAttachmentDesc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH;
-            desc.DepthAttachmentDesc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-            desc.DepthAttachmentDesc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.DepthAttachmentDesc.Height = g_RenderState.Settings.RenderResolution.y;
-
-            desc.DepthComparisonFunc = D3D12_COMPARISON_FUNC_EQUAL;
-
-            // Need to mark the bindless descriptor range as DESCRIPTORS_VOLATILE since it will contain empty descriptors
-            CD3DX12_DESCRIPTOR_RANGE1 ranges[2] = {};
-            ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4096, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-
-            desc.RootParameters.resize(5);
-            desc.RootParameters[0].InitAsConstantBufferView(0); // Global constant buffer
-            desc.RootParameters[1].InitAsConstantBufferView(1); // Scene data constant buffer
-            desc.RootParameters[2].InitAsConstantBufferView(2); // Material constant buffer
-            desc.RootParameters[3].InitAsConstantBufferView(3); // Light constant buffer
-            desc.RootParameters[4].InitAsDescriptorTable(_countof(ranges), &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL); // Bindless SRV table
-
-            desc.ShaderInputLayout.push_back({ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 80, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 96, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "PREV_FRAME_TRANSFORM", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 112, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-            desc.ShaderInputLayout.push_back({ "MATERIAL_ID", 0, DXGI_FORMAT_R32_UINT, 1, 128, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 });
-
-            s_Data.RenderPasses[RenderPassType::LIGHTING] = std::make_unique<RasterPass>("Lighting", desc);
-        }
+            slotmap.Erase(destroyed.first);
+            return true;
+        });
 
-        {
-            // Temporal anti-aliasing pass
-            ComputePassDesc desc;
-            desc.ComputeShaderPath = "Resources/Shaders/TemporalAA_CS.hlsl";
-            desc.NumThreadsX = 64;
-            desc.NumThreadsY = 64;
-            desc.NumThreadsZ = 1;
-
-            CD3DX12_DESCRIPTOR_RANGE1 ranges[6] = {};
-            ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 1, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[2].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 2, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[3].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 3, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[4].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 4, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[5].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-
-            desc.RootParameters.resize(7);
-            desc.RootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE); // Global constant buffer
-            desc.RootParameters[1].InitAsDescriptorTable(1, &ranges[0]); // HDR color target (current frame)
-            desc.RootParameters[2].InitAsDescriptorTable(1, &ranges[1]); // Depth target (current frame)
-            desc.RootParameters[3].InitAsDescriptorTable(1, &ranges[2]); // Velocity target (current frame)
-            desc.RootParameters[4].InitAsDescriptorTable(1, &ranges[3]); // Velocity target previous (last frame)
-            desc.RootParameters[5].InitAsDescriptorTable(1, &ranges[4]); // TAA history (accumulated last frames)
-            desc.RootParameters[6].InitAsDescriptorTable(1, &ranges[5]); // TAA resolve target (dest)
-
-            s_Data.ComputePasses[ComputePassType::TEMPORAL_ANTI_ALIASING] = std::make_unique<ComputePass>("Temporal anti-aliasing", desc);
-        }
-
-        {
-            // Tonemapping render pass
-            ComputePassDesc desc;
-            desc.ComputeShaderPath = "Resources/Shaders/PostProcess_CS.hlsl";
-            desc.NumThreadsX = 64;
-            desc.NumThreadsY = 64;
-            desc.NumThreadsZ = 1;
-
-            CD3DX12_DESCRIPTOR_RANGE1 ranges[2] = {};
-            ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-            ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE, 0);
-
-            desc.RootParameters.resize(3);
-            desc.RootParameters[0].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE); // Global constant buffer
-            desc.RootParameters[1].InitAsDescriptorTable(1, &ranges[0]); // Source texture
-            desc.RootParameters[2].InitAsDescriptorTable(1, &ranges[1]); // SDR color target (dest)
-
-            s_Data.ComputePasses[ComputePassType::POST_PROCESS] = std::make_unique<ComputePass>("Post-process", desc);
-        }
+        destroyedResources.erase(iter, destroyedResources.end());
     }
 
     void CreateBuffers()
     {
         // TODO: Constant buffers should be replaced by a giant upload/constant buffer which can be suballocated from
+        RenderBackend& backend = *s_Data.Backend;
 
         {
             // Global constant buffer
@@ -302,33 +310,28 @@ namespace Renderer
             desc.ElementSize = sizeof(GlobalConstantBufferData);
             desc.DebugName = "Global constant buffer";
 
-            g_RenderState.GlobalConstantBuffer = std::make_unique<Buffer>(desc);
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS, desc);
         }
         
         {
-            // Mesh instance buffers (opaque and transparent meshes)
+            // Mesh instance buffer (opaque, masked and transparent meshes), one copy of the instance table per back buffer
             BufferDesc desc = {};
             desc.Usage = BufferUsage::BUFFER_USAGE_UPLOAD;
-            //meshBufferDesc.NumElements = g_RenderState.MAX_MESH_INSTANCES * g_RenderState.BACK_BUFFER_COUNT;
-            desc.NumElements = g_RenderState.MAX_MESH_INSTANCES;
+            desc.NumElements = MAX_INSTANCE_TABLE_ENTRIES * g_RenderState.BACK_BUFFER_COUNT;
             desc.ElementSize = sizeof(MeshInstanceData);
-            desc.DebugName = "Mesh instance buffer opaque";
-            g_RenderState.MeshInstanceBufferOpaque = std::make_unique<Buffer>(desc);
-
-            desc.DebugName = "Mesh instance buffer transparent";
-            g_RenderState.MeshInstanceBufferTransparent = std::make_unique<Buffer>(desc);
+            desc.DebugName = "Mesh instance buffer";
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MESH_INSTANCES, desc);
         }
 
         {
-            // Material constant buffer
+            // Material constant buffer, one copy of the material table per back buffer
             BufferDesc desc = {};
             desc.Usage = BufferUsage::BUFFER_USAGE_CONSTANT;
-            //materialBufferDesc.NumElements = g_RenderState.MAX_MATERIALS * g_RenderState.BACK_BUFFER_COUNT;
-            desc.NumElements = g_RenderState.MAX_MATERIALS;
-            desc.ElementSize = sizeof(MaterialData);
+            desc.NumElements = g_RenderState.BACK_BUFFER_COUNT;
+            desc.ElementSize = MATERIAL_TABLE_COPY_BYTE_SIZE;
             desc.DebugName = "Material constant buffer";
 
-            g_RenderState.MaterialConstantBuffer = std::make_unique<Buffer>(desc);
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS, desc);
         }
 
         {
@@ -340,7 +343,7 @@ namespace Renderer
             desc.ElementSize = 1 * g_RenderState.BACK_BUFFER_COUNT;
             desc.DebugName = "Light constant buffer";
 
-            g_RenderState.LightConstantBuffer = std::make_unique<Buffer>(desc);
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHTS, desc);
         }
 
         {
@@ -351,252 +354,1056 @@ namespace Renderer
             desc.ElementSize = sizeof(SceneData);
             desc.DebugName = "Scene data constant buffer";
 
-            g_RenderState.SceneDataConstantBuffer = std::make_unique<Buffer>(desc);
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_SCENE_DATA, desc);
+        }
+
+        {
+            // Light cluster constant buffer, one copy of the grid per back buffer
+            BufferDesc desc = {};
+            desc.Usage = BufferUsage::BUFFER_USAGE_CONSTANT;
+            desc.NumElements = g_RenderState.BACK_BUFFER_COUNT;
+            desc.ElementSize = LIGHT_CLUSTER_GRID_COPY_BYTE_SIZE;
+            desc.DebugName = "Light cluster constant buffer";
+
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS, desc);
+        }
+
+        {
+            // View space light bounding spheres, spotlights followed by pointlights, one copy per back buffer
+            BufferDesc desc = {};
+            desc.Usage = BufferUsage::BUFFER_USAGE_UPLOAD;
+            desc.NumElements = MAX_LIGHT_SPHERES * g_RenderState.BACK_BUFFER_COUNT;
+            desc.ElementSize = sizeof(glm::vec4);
+            desc.DebugName = "Light sphere buffer";
+
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_SPHERES, desc);
+        }
+
+        {
+            // Cluster light lists, written by the light clustering pass and read by the lighting pass
+            BufferDesc desc = {};
+            desc.Usage = BufferUsage::BUFFER_USAGE_READ | BufferUsage::BUFFER_USAGE_WRITE;
+            desc.NumElements = LIGHT_CLUSTER_COUNT;
+            desc.ElementSize = sizeof(uint32_t);
+            desc.DebugName = "Cluster light count buffer";
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_COUNTS, desc);
+
+            desc.NumElements = LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS;
+            desc.DebugName = "Cluster light index buffer";
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_CLUSTER_LIGHT_INDICES, desc);
+        }
+
+        {
+            // Per instance light lists, worst case every instance of every transparency mode overlaps every light, one copy per back buffer
+            BufferDesc desc = {};
+            desc.Usage = BufferUsage::BUFFER_USAGE_UPLOAD;
+            desc.NumElements = MAX_INSTANCE_LIGHT_INDICES * g_RenderState.BACK_BUFFER_COUNT;
+            desc.ElementSize = sizeof(uint32_t);
+            desc.DebugName = "Instance light index buffer";
+
+            backend.CreateRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_INSTANCE_LIGHT_INDICES, desc);
+        }
+    }
+
+    void CreateDefaultTextures()
+    {
+        // Make default white and normal textures
+        uint32_t defaultWhiteTextureData = 0xFFFFFFFF;
+
+        TextureDesc defaultTextureDesc = {};
+        defaultTextureDesc.Usage = TextureUsage::TEXTURE_USAGE_READ;
+        defaultTextureDesc.Format = TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM;
+        defaultTextureDesc.Width = 1;
+        defaultTextureDesc.Height = 1;
+        defaultTextureDesc.DataPtr = &defaultWhiteTextureData;
+        defaultTextureDesc.DebugName = "Default white texture";
+
+        g_RenderState.DefaultWhiteTexture = s_Data.Backend->CreateTexture(defaultTextureDesc);
+
+        // Texture data is in ABGR layout, the default normal will point forward in tangent space (blue)
+        uint32_t defaultNormalTextureData = (255 << 24) | (255 << 16) | (127 << 8) | (127 << 0);
+        defaultTextureDesc.DataPtr = &defaultNormalTextureData;
+        defaultTextureDesc.DebugName = "Default normal texture";
+
+        g_RenderState.DefaultNormalTexture = s_Data.Backend->CreateTexture(defaultTextureDesc);
+
+        // Default textures replace textures that are still uploading, so they have to be resident right away
+        s_Data.Backend->Flush();
+    }
+
+    bool CullViewFrustum(const ViewFrustum& frustum, const Mesh* mesh, const MeshInstanceData& meshInstance)
+    {
+        BoundingBox meshInstanceBB = mesh->BB;
+        meshInstanceBB.Min = meshInstance.Transform * glm::vec4(mesh->BB.Min, 1.0f);
+        meshInstanceBB.Max = meshInstance.Transform * glm::vec4(mesh->BB.Max, 1.0f);
+
+#if !defined(DX12R_PORTABLE_CORE)
+        DebugRenderer::SubmitAABB(meshInstanceBB.Min, meshInstanceBB.Max, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
+#endif
+
+        return frustum.IsBoxInViewFrustum(meshInstanceBB.Min, meshInstanceBB.Max);
+    }
+
+    uint32_t SelectMeshLOD(const Camera& camera, float viewHeight, float errorThreshold, const Mesh* mesh, const MeshInstanceData& meshInstance)
+    {
+        if (!g_RenderState.Settings.EnableMeshLODs || mesh->LODs.empty())
+            return 0;
+
+        float pixelsPerUnit = LODSelection::CalculatePixelsPerUnit(camera.GetViewMatrix(), camera.GetProjectionMatrix(), viewHeight, mesh->BB, meshInstance.Transform);
+        return LODSelection::SelectLOD(mesh->LODs, pixelsPerUnit, errorThreshold);
+    }
+
+    // casterMask has one byte per submission of the transparency mode, submissions with a zero are skipped
+    // With a permutation pass every draw binds the lighting shader variant of that pass that fits its features, the pass has to be bound with variant 0.
+    // Returns the number of draws
+    uint32_t RenderGeometry(const Camera& camera, TransparencyMode transparency, float viewHeight, float lodErrorThreshold,
+        MeshVertexStreams vertexStreams, ShadowCasterFilter casterFilter = SHADOW_CASTERS_ALL, const uint8_t* casterMask = nullptr,
+        const RenderPassType* permutationPass = nullptr)
+    {
+        RenderBackend& backend = *s_Data.Backend;
+        std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>* meshSubmissions = &s_Data.MeshSubmissions[transparency];
+        std::size_t numSubmissions = s_Data.MeshCounts[transparency];
+
+        // Instances are drawn from the instance table copy of the current back buffer
+        uint32_t firstTableInstance = s_Data.SceneTableCopyIndex * MAX_INSTANCE_TABLE_ENTRIES;
+
+        uint32_t boundVariant = 0;
+        uint32_t numDraws = 0;
+
+        for (std::size_t m = 0; m < numSubmissions; ++m)
+        {
+            const auto mesh = (*meshSubmissions)[m].Mesh;
+            const auto& meshInstance = (*meshSubmissions)[m].InstanceData;
+
+            if ((casterFilter == SHADOW_CASTERS_STATIC && !(*meshSubmissions)[m].IsStatic) ||
+                (casterFilter == SHADOW_CASTERS_DYNAMIC && (*meshSubmissions)[m].IsStatic) ||
+                (casterMask && !casterMask[m]))
+            {
+                continue;
+            }
+
+            if (camera.IsFrustumCullingEnabled())
+            {
+                if (!CullViewFrustum(camera.GetViewFrustum(), mesh, meshInstance))
+                {
+                    continue;
+                }
+            }
+
+            uint32_t lod = SelectMeshLOD(camera, viewHeight, lodErrorThreshold, mesh, meshInstance);
+
+            RenderBuffer* positionBuffer = g_RenderState.BufferSlotmap.Find(mesh->PositionBuffer);
+            RenderBuffer* indexBuffer = g_RenderState.BufferSlotmap.Find(lod > 0 ? mesh->LODs[lod - 1].IndexBuffer : mesh->IndexBuffer);
+            RenderBuffer* attributeBuffer = nullptr;
+
+            // LOD index buffers finish uploading after the full detail one, so fall back until they are resident
+            if (!backend.IsResourceReady(indexBuffer->Resource))
+            {
+                indexBuffer = g_RenderState.BufferSlotmap.Find(mesh->IndexBuffer);
+                lod = 0;
+            }
+
+            if (vertexStreams != MESH_VERTEX_STREAMS_POSITIONS)
+            {
+                attributeBuffer = g_RenderState.BufferSlotmap.Find(mesh->AttributeBuffer);
+
+                if (vertexStreams == MESH_VERTEX_STREAMS_ALPHA_TEST)
+                    g_RenderState.Stats.DepthVertexByteCount += attributeBuffer->Desc.NumElements * attributeBuffer->Desc.ElementSize;
+            }
+
+            if (vertexStreams != MESH_VERTEX_STREAMS_ALL)
+                g_RenderState.Stats.DepthVertexByteCount += positionBuffer->Desc.NumElements * positionBuffer->Desc.ElementSize;
+
+            if (permutationPass)
+            {
+                uint32_t drawFeatures = ShaderPermutation::GetDrawSortKeyFeatures((*meshSubmissions)[m].SortKey) | s_Data.FrameShaderFeatures;
+                uint32_t variant = s_Data.LightingPermutations.SelectVariant(drawFeatures);
+
+                if (variant != boundVariant)
+                {
+                    backend.SetPipelineVariant(*permutationPass, variant);
+                    boundVariant = variant;
+                    g_RenderState.Stats.PipelineStateSwitchCount++;
+                }
+            }
+
+            uint32_t numIndices = static_cast<uint32_t>(indexBuffer->Desc.NumElements);
+            backend.DrawMesh(positionBuffer->Resource, attributeBuffer ? attributeBuffer->Resource : nullptr, indexBuffer->Resource,
+                numIndices, firstTableInstance + (*meshSubmissions)[m].InstanceSlot);
+
+            numDraws++;
+            g_RenderState.Stats.DrawCallCount++;
+            g_RenderState.Stats.TriangleCount += numIndices / 3;
+            if (lod > 0)
+                g_RenderState.Stats.LODDrawCallCount++;
+        }
+
+        return numDraws;
+    }
+
+    uint64_t MakeShadowLightID(uint64_t lightID, ShadowLightType type)
+    {
+        return lightID * SHADOW_LIGHT_TYPE_NUM_TYPES + type;
+    }
+
+    uint64_t MakeShadowViewID(uint64_t shadowLightID, uint32_t tile)
+    {
+        return shadowLightID * MAX_SHADOW_ATLAS_TILES_PER_LIGHT + tile;
+    }
+
+    // Caster visibility of a light submission for the submissions of one transparency mode, nullptr if caster culling is disabled
+    const uint8_t* GetShadowCasterMask(std::size_t lightSubmission, TransparencyMode transparency)
+    {
+        if (!g_RenderState.Settings.EnableShadowCasterCulling)
+            return nullptr;
+
+        // The casters of a light submission are ordered by transparency mode
+        std::size_t offset = lightSubmission * s_Data.ShadowCasterBounds.size();
+        for (uint32_t i = 0; i < transparency; ++i)
+            offset += s_Data.MeshCounts[i];
+
+        return s_Data.ShadowCasterMasks.data() + offset;
+    }
+
+    void RenderShadowMap(const ShadowView& view, ShadowAtlasLayer layer, ShadowCasterFilter casterFilter)
+    {
+        RenderBackend& backend = *s_Data.Backend;
+        const Camera& lightCamera = s_Data.LightSubmissions[view.LightSubmission].LightCamera;
+        backend.SetShadowAtlasTile(layer, view.Tile);
+
+        // Set root constant (light VP)
+        const glm::mat4& lightViewProjection = lightCamera.GetViewProjection();
+        backend.SetViewProjection(lightViewProjection);
+
+        // Transparent casters shadow like opaque ones
+        float shadowMapHeight = static_cast<float>(view.Tile.Size);
+        RenderGeometry(lightCamera, TransparencyMode::OPAQUE, shadowMapHeight, g_RenderState.Settings.ShadowLODErrorThreshold,
+            MESH_VERTEX_STREAMS_POSITIONS, casterFilter, GetShadowCasterMask(view.LightSubmission, TransparencyMode::OPAQUE));
+        RenderGeometry(lightCamera, TransparencyMode::TRANSPARENT, shadowMapHeight, g_RenderState.Settings.ShadowLODErrorThreshold,
+            MESH_VERTEX_STREAMS_POSITIONS, casterFilter, GetShadowCasterMask(view.LightSubmission, TransparencyMode::TRANSPARENT));
+
+        // Masked casters are alpha tested in a pass of their own, the shadow mapping pass is bound again for the next view
+        if (s_Data.MeshCounts[TransparencyMode::MASKED] > 0)
+        {
+            backend.BindRenderPass(RenderPassType::SHADOW_MAPPING_MASKED, s_Data.SceneTableCopyIndex);
+            backend.SetViewProjection(lightViewProjection);
+
+            RenderGeometry(lightCamera, TransparencyMode::MASKED, shadowMapHeight, g_RenderState.Settings.ShadowLODErrorThreshold,
+                MESH_VERTEX_STREAMS_ALPHA_TEST, casterFilter, GetShadowCasterMask(view.LightSubmission, TransparencyMode::MASKED));
+
+            backend.BindRenderPass(RenderPassType::SHADOW_MAPPING, s_Data.SceneTableCopyIndex);
+        }
+    }
+
+    // Culls the casters of every shadow view against the visible receivers, in one batch per view
+    void CullShadowCasters()
+    {
+        if (!g_RenderState.Settings.EnableShadowCasterCulling)
+            return;
+
+        std::size_t numCasters = s_Data.ShadowCasterBounds.size();
+        s_Data.ShadowCasterMasks.resize(s_Data.LightCount * numCasters);
+
+        for (const ShadowView& view : s_Data.ShadowViews)
+        {
+            const Camera& lightCamera = s_Data.LightSubmissions[view.LightSubmission].LightCamera;
+            ShadowCasterVolume volume = ShadowCasterCulling::MakeCasterVolume(lightCamera.GetViewMatrix(), lightCamera.GetProjectionMatrix(), s_Data.ShadowReceiverPoints);
+
+            g_RenderState.Stats.ShadowCasterCulledCount += ShadowCasterCulling::CullCasters(volume, s_Data.ShadowCasterBounds.data(), numCasters,
+                s_Data.ShadowCasterMasks.data() + view.LightSubmission * numCasters);
+        }
+    }
+
+    // Calls func for every mesh submission a shadow view draws, the casters that survive caster culling and the frustum test of RenderGeometry
+    template<typename Func>
+    void ForEachShadowCaster(const ShadowView& view, Func&& func)
+    {
+        const Camera& lightCamera = s_Data.LightSubmissions[view.LightSubmission].LightCamera;
+
+        auto addSubmissions = [&](const std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>& submissions, std::size_t numSubmissions, const uint8_t* casterMask)
+        {
+            for (std::size_t m = 0; m < numSubmissions; ++m)
+            {
+                const MeshSubmission& submission = submissions[m];
+
+                if (casterMask && !casterMask[m])
+                    continue;
+
+                // Same bounds as CullViewFrustum tests
+                if (lightCamera.IsFrustumCullingEnabled())
+                {
+                    glm::vec3 instanceMin = submission.InstanceData.Transform * glm::vec4(submission.Mesh->BB.Min, 1.0f);
+                    glm::vec3 instanceMax = submission.InstanceData.Transform * glm::vec4(submission.Mesh->BB.Max, 1.0f);
+
+                    if (!lightCamera.GetViewFrustum().IsBoxInViewFrustum(instanceMin, instanceMax))
+                        continue;
+                }
+
+                func(submission);
+            }
+        };
+
+        for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
+            addSubmissions(s_Data.MeshSubmissions[i], s_Data.MeshCounts[i], GetShadowCasterMask(view.LightSubmission, static_cast<TransparencyMode>(i)));
+    }
+
+    // Clears the tiles of the views updated this frame, or only of the ones that render their static layer
+    void ClearShadowViews(ShadowAtlasLayer layer, bool onlyStaticLayers)
+    {
+        s_Data.ShadowAtlasClearTiles.clear();
+
+        for (const ShadowView& view : s_Data.ShadowViews)
+        {
+            if (!view.Update || (onlyStaticLayers && !view.RenderStaticLayer))
+                continue;
+
+            s_Data.ShadowAtlasClearTiles.push_back(view.Tile);
+        }
+
+        if (!s_Data.ShadowAtlasClearTiles.empty())
+            s_Data.Backend->ClearShadowAtlasTiles(layer, s_Data.ShadowAtlasClearTiles);
+    }
+
+    // Signature of the static layer of a view, which covers its tile so a view that moved in the atlas renders its static layer again
+    Hash128 CalculateStaticShadowSignature(const ShadowView& view, uint32_t& outNumDynamicCasters)
+    {
+        Hash128 signature;
+        outNumDynamicCasters = 0;
+
+        const LightSubmission& lightSubmission = s_Data.LightSubmissions[view.LightSubmission];
+        ShadowCache::AddView(signature, lightSubmission.LightCamera.GetViewProjection(), glm::uvec3(view.Tile.X, view.Tile.Y, view.Tile.Size));
+
+        // Culled casters are not in the static layer, so a caster that starts or stops shadowing visible receivers invalidates it
+        ForEachShadowCaster(view, [&](const MeshSubmission& submission)
+        {
+            if (submission.IsStatic)
+                ShadowCache::AddStaticCaster(signature, submission.MeshHandle.Handle, submission.InstanceData.Transform);
+            else
+                outNumDynamicCasters++;
+        });
+
+        return signature;
+    }
+
+    void ComposeStaticShadowLayers()
+    {
+        RenderBackend& backend = *s_Data.Backend;
+
+        backend.BeginShadowAtlasLayer(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC);
+        backend.BindRenderPass(RenderPassType::SHADOW_COMPOSE, s_Data.SceneTableCopyIndex);
+
+        for (const ShadowView& view : s_Data.ShadowViews)
+        {
+            if (view.ComposeStaticLayer)
+                backend.ComposeShadowAtlasTile(view.Tile);
+        }
+
+        backend.BindRenderPass(RenderPassType::SHADOW_MAPPING, s_Data.SceneTableCopyIndex);
+    }
+
+    // Renders the shadow views scheduled for this frame into their shadow atlas tiles, reusing the cached static layer of views where it is still valid.
+    // The tiles of the other views keep the shadow map of their last update
+    void RenderShadowMaps()
+    {
+        RenderBackend& backend = *s_Data.Backend;
+
+        if (!g_RenderState.Settings.EnableShadowCache)
+        {
+            for (auto& [viewID, state] : s_Data.ShadowViewStates)
+                ShadowCache::Invalidate(state.CacheEntry);
+
+            if (backend.HasShadowAtlasStaticLayer())
+                backend.ReleaseShadowAtlasStaticLayer();
+
+            backend.BeginShadowAtlasLayer(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC);
+            ClearShadowViews(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC, false);
+
+            for (const ShadowView& view : s_Data.ShadowViews)
+            {
+                if (view.Update)
+                    RenderShadowMap(view, ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC, SHADOW_CASTERS_ALL);
+            }
+
+            return;
+        }
+
+        if (!backend.HasShadowAtlasStaticLayer())
+        {
+            backend.CreateShadowAtlasStaticLayer();
+
+            for (auto& [viewID, state] : s_Data.ShadowViewStates)
+                ShadowCache::Invalidate(state.CacheEntry);
+        }
+
+        bool renderStaticLayers = false, composeStaticLayers = false, hasDynamicCasters = false;
+
+        for (ShadowView& view : s_Data.ShadowViews)
+        {
+            if (!view.Update)
+                continue;
+
+            uint32_t numDynamicCasters = 0;
+            Hash128 signature = CalculateStaticShadowSignature(view, numDynamicCasters);
+
+            ShadowViewState& state = s_Data.ShadowViewStates[view.ViewID];
+
+            if (ShadowCache::Validate(state.CacheEntry, signature))
+            {
+                g_RenderState.Stats.ShadowMapCacheHitCount++;
+
+                // Only restore the static layer if dynamic casters were drawn over it
+                view.ComposeStaticLayer = !state.HoldsStaticLayer;
+            }
+            else
+            {
+                view.RenderStaticLayer = true;
+                view.ComposeStaticLayer = true;
+            }
+
+            view.HasDynamicCasters = numDynamicCasters > 0;
+            state.HoldsStaticLayer = numDynamicCasters == 0;
+
+            renderStaticLayers |= view.RenderStaticLayer;
+            composeStaticLayers |= view.ComposeStaticLayer;
+            hasDynamicCasters |= view.HasDynamicCasters;
+        }
+
+        if (renderStaticLayers)
+        {
+            backend.BeginShadowAtlasLayer(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_STATIC);
+            ClearShadowViews(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_STATIC, true);
+
+            for (const ShadowView& view : s_Data.ShadowViews)
+            {
+                if (view.RenderStaticLayer)
+                    RenderShadowMap(view, ShadowAtlasLayer::SHADOW_ATLAS_LAYER_STATIC, SHADOW_CASTERS_STATIC);
+            }
+        }
+
+        if (composeStaticLayers)
+            ComposeStaticShadowLayers();
+
+        if (hasDynamicCasters)
+        {
+            backend.BeginShadowAtlasLayer(ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC);
+
+            for (const ShadowView& view : s_Data.ShadowViews)
+            {
+                if (view.HasDynamicCasters)
+                    RenderShadowMap(view, ShadowAtlasLayer::SHADOW_ATLAS_LAYER_DYNAMIC, SHADOW_CASTERS_DYNAMIC);
+            }
+        }
+    }
+
+    CapturedView MakeCapturedView(const Camera& camera)
+    {
+        CapturedView view;
+        view.View = camera.GetViewMatrix();
+        view.Projection = camera.GetProjectionMatrix();
+        view.Near = camera.GetViewFrustum().GetNear();
+        view.Far = camera.GetViewFrustum().GetFar();
+        view.FrustumCulling = camera.IsFrustumCullingEnabled();
+
+        return view;
+    }
+
+    void CaptureMeshSubmission(RenderResourceHandle meshHandle, const Mesh& mesh, const glm::mat4& transform, const glm::mat4& prevFrameTransform)
+    {
+        FrameCaptureWriter& writer = *s_Data.CaptureWriter;
+        uint32_t meshID = writer.FindMesh(meshHandle.Handle);
+
+        // Meshes and their materials are written to the capture the first time they are submitted
+        if (meshID == FRAME_CAPTURE_INVALID_ID)
+        {
+            const Material* material = g_RenderState.MaterialSlotmap.Find(mesh.Material);
+
+            CapturedMaterial capturedMaterial;
+            capturedMaterial.Transparency = material->Transparency;
+            capturedMaterial.AlphaCutoff = material->AlphaCutoff;
+            capturedMaterial.Metalness = material->MetalnessFactor;
+            capturedMaterial.Roughness = material->RoughnessFactor;
+            capturedMaterial.HasAlbedoTexture = RENDER_RESOURCE_HANDLE_VALID(material->AlbedoTexture);
+            capturedMaterial.HasNormalTexture = RENDER_RESOURCE_HANDLE_VALID(material->NormalTexture);
+            capturedMaterial.HasMetallicRoughnessTexture = RENDER_RESOURCE_HANDLE_VALID(material->MetallicRoughnessTexture);
+
+            CapturedMesh capturedMesh;
+            capturedMesh.NumVertices = static_cast<uint32_t>(g_RenderState.BufferSlotmap.Find(mesh.PositionBuffer)->Desc.NumElements);
+            capturedMesh.NumIndices = static_cast<uint32_t>(g_RenderState.BufferSlotmap.Find(mesh.IndexBuffer)->Desc.NumElements);
+            capturedMesh.BB = mesh.BB;
+            capturedMesh.Material = writer.AddMaterial(mesh.Material.Handle, capturedMaterial);
+
+            for (const MeshLOD& lod : mesh.LODs)
+            {
+                uint32_t numLODIndices = static_cast<uint32_t>(g_RenderState.BufferSlotmap.Find(lod.IndexBuffer)->Desc.NumElements);
+                capturedMesh.LODs.push_back({ numLODIndices, lod.Error });
+            }
+
+            meshID = writer.AddMesh(meshHandle.Handle, capturedMesh);
+        }
+
+        s_Data.CapturedFrame.MeshSubmissions.push_back({ meshID, transform, prevFrameTransform });
+    }
+
+    void UpdateLightClusterData()
+    {
+        const ViewFrustum& frustum = s_Data.SceneCamera.GetViewFrustum();
+        uint32_t numSpotLights = static_cast<uint32_t>(s_Data.SpotLights.size());
+        uint32_t numPointLights = static_cast<uint32_t>(s_Data.PointLights.size());
+
+        s_Data.ClusterGrid = LightClustering::MakeGridData(s_Data.SceneCamera.GetViewMatrix(), s_Data.SceneCamera.GetProjectionMatrix(),
+            frustum.GetNear(), frustum.GetFar(), glm::vec2(g_RenderState.Settings.RenderResolution.x, g_RenderState.Settings.RenderResolution.y), numSpotLights, numPointLights);
+
+        // Spotlight indices come first in the cluster lists, so the spheres are uploaded in the same order
+        std::vector<glm::vec4> worldSpheres;
+        for (const SpotLightData& spotLight : s_Data.SpotLights)
+            worldSpheres.push_back(LightClustering::GetSpotLightBoundingSphere(spotLight.Position, spotLight.Direction, spotLight.Range, spotLight.OuterConeAngle));
+        for (const PointLightData& pointLight : s_Data.PointLights)
+            worldSpheres.push_back(LightClustering::GetPointLightBoundingSphere(pointLight.Position, pointLight.Range));
+
+        LightClustering::TransformSpheresToViewSpace(s_Data.ClusterGrid, worldSpheres, s_Data.ViewLightSpheres);
+
+        // Earlier frames might still be clustering and lighting with their copy
+        s_Data.Backend->WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_CLUSTERS, &s_Data.ClusterGrid, sizeof(LightClusterGridData),
+            s_Data.SceneTableCopyIndex * LIGHT_CLUSTER_GRID_COPY_BYTE_SIZE);
+        if (!s_Data.ViewLightSpheres.empty())
+        {
+            s_Data.Backend->WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHT_SPHERES, s_Data.ViewLightSpheres.data(),
+                s_Data.ViewLightSpheres.size() * sizeof(glm::vec4), s_Data.SceneTableCopyIndex * MAX_LIGHT_SPHERES * sizeof(glm::vec4));
         }
     }
 
-    void CreateRenderTargets()
+    // Opaque and masked draws are sorted by their keys, so draws with the same shader variant follow each other.
+    // Transparent draws are sorted back to front by the view depth of their bounds center, so they blend over whatever is behind them.
+    // Everything indexed by submission (caster bounds and masks, instance slots) is built after this
+    void SortMeshSubmissions()
     {
+        for (TransparencyMode transparency : { TransparencyMode::OPAQUE, TransparencyMode::MASKED })
         {
-            // Depth pre-pass depth target
-            TextureDesc desc = {};
-            desc.Usage = TextureUsage::TEXTURE_USAGE_DEPTH | TextureUsage::TEXTURE_USAGE_READ;
-            desc.Format = TextureFormat::TEXTURE_FORMAT_DEPTH32;
-            desc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.Height = g_RenderState.Settings.RenderResolution.y;
-            desc.ClearColor = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
-            desc.DebugName = "Depth pre-pass depth target";
-
-            g_RenderState.DepthPrepassDepthTarget = std::make_unique<Texture>(desc);
+            std::stable_sort(s_Data.MeshSubmissions[transparency].begin(), s_Data.MeshSubmissions[transparency].begin() + s_Data.MeshCounts[transparency],
+                [](const MeshSubmission& lhs, const MeshSubmission& rhs) { return lhs.SortKey < rhs.SortKey; });
         }
 
-        {
-            // HDR color target, TAA resolve target, TAA history
-            TextureDesc desc = {};
-            desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
-            desc.Format = TextureFormat::TEXTURE_FORMAT_RGBA16_FLOAT;
-            desc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.Height = g_RenderState.Settings.RenderResolution.y;
-            desc.DebugName = "HDR color target";
-
-            g_RenderState.HDRColorTarget = std::make_unique<Texture>(desc);
-
-            desc.Usage = TextureUsage::TEXTURE_USAGE_READ | TextureUsage::TEXTURE_USAGE_WRITE;
-            desc.DebugName = "TAA resolve target";
-            g_RenderState.TAAResolveTarget = std::make_unique<Texture>(desc);
-
-            desc.Usage = TextureUsage::TEXTURE_USAGE_READ;
-            desc.DebugName = "TAA history";
-            g_RenderState.TAAHistory = std::make_unique<Texture>(desc);
+        glm::mat4 view = s_Data.SceneCamera.GetViewMatrix();
+        auto getViewDepth = [&view](const MeshSubmission& submission)
+        {
+            glm::vec3 center = 0.5f * (submission.Mesh->BB.Min + submission.Mesh->BB.Max);
+            return (view * submission.InstanceData.Transform * glm::vec4(center, 1.0f)).z;
+        };
+
+        auto& transparentSubmissions = s_Data.MeshSubmissions[TransparencyMode::TRANSPARENT];
+        std::stable_sort(transparentSubmissions.begin(), transparentSubmissions.begin() + s_Data.MeshCounts[TransparencyMode::TRANSPARENT],
+            [&getViewDepth](const MeshSubmission& lhs, const MeshSubmission& rhs) { return getViewDepth(lhs) > getViewDepth(rhs); });
+    }
+
+    // Once the shadow views are known, lights without a shadow map have zero atlas rects
+    void UpdateFrameShaderFeatures()
+    {
+        bool hasUnshadowedLights = false;
+
+        if (s_Data.SceneData.DirLightCount > 0)
+        {
+            for (uint32_t i = 0; i < s_Data.DirLight.NumCascades; ++i)
+                hasUnshadowedLights |= s_Data.DirLight.CascadeAtlasRects[i].z == 0.0f;
+        }
+
+        for (const SpotLightData& spotLight : s_Data.SpotLights)
+            hasUnshadowedLights |= spotLight.ShadowAtlasRect.z == 0.0f;
+
+        for (const PointLightData& pointLight : s_Data.PointLights)
+        {
+            for (uint32_t face = 0; face < 6; ++face)
+                hasUnshadowedLights |= pointLight.ShadowAtlasRects[face].z == 0.0f;
+        }
+
+        s_Data.FrameShaderFeatures = hasUnshadowedLights ? SHADER_FEATURE_NONE : SHADER_FEATURE_SHADOWED_LIGHTS_ONLY;
+    }
+
+    // World bounds of all submissions and the part of the camera frustum inside them, which holds every receiver the camera can see
+    void UpdateShadowReceivers()
+    {
+        s_Data.SceneBB.Min = glm::vec3(std::numeric_limits<float>::max());
+        s_Data.SceneBB.Max = glm::vec3(std::numeric_limits<float>::lowest());
+        s_Data.ShadowCasterBounds.clear();
+
+        auto addSubmissions = [](const std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>& submissions, std::size_t numSubmissions)
+        {
+            for (std::size_t i = 0; i < numSubmissions; ++i)
+            {
+                BoundingBox worldBB = LightAssignment::TransformBoundingBox(submissions[i].Mesh->BB, submissions[i].InstanceData.Transform);
+                s_Data.SceneBB.Min = glm::min(s_Data.SceneBB.Min, worldBB.Min);
+                s_Data.SceneBB.Max = glm::max(s_Data.SceneBB.Max, worldBB.Max);
+                s_Data.ShadowCasterBounds.push_back(worldBB);
+            }
+        };
+
+        for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
+            addSubmissions(s_Data.MeshSubmissions[i], s_Data.MeshCounts[i]);
+
+        ShadowCasterCulling::CalculateReceiverRegion(s_Data.SceneCamera.GetViewProjection(), s_Data.SceneBB, s_Data.ShadowReceiverPoints);
+    }
+
+    void UpdateShadowCascades()
+    {
+        DirectionalLightData& dirLight = s_Data.DirLight;
+        dirLight.NumCascades = 0;
+
+        if (s_Data.SceneData.DirLightCount == 0)
+            return;
+
+        // The bounds of all casters and receivers limit the depth range of the cascades
+        const BoundingBox& sceneBB = s_Data.SceneBB;
+
+        const RenderSettings& settings = g_RenderState.Settings;
+        ShadowCascadeSettings cascadeSettings;
+        cascadeSettings.NumCascades = settings.NumShadowCascades;
+        cascadeSettings.SplitLambda = settings.CascadeSplitLambda;
+        cascadeSettings.MaxShadowDistance = settings.ShadowDistance;
+        cascadeSettings.ShadowMapResolution = settings.ShadowMapResolution.x;
+
+        const Camera& sceneCamera = s_Data.SceneCamera;
+        uint32_t numCascades = ShadowCascades::CalculateCascades(cascadeSettings, sceneCamera.GetViewMatrix(), sceneCamera.GetProjectionMatrix(),
+            sceneCamera.GetViewFrustum().GetNear(), sceneCamera.GetViewFrustum().GetFar(), dirLight.Direction, sceneBB, s_Data.DirLightCascades.data());
+
+        for (uint32_t i = 0; i < numCascades; ++i)
+        {
+            // Every cascade is rendered and culled with its own orthographic camera, with reverse-z like the other cameras
+            const ShadowCascade& cascade = s_Data.DirLightCascades[i];
+            Camera cascadeCamera(cascade.View, cascade.Left, cascade.Right, cascade.Bottom, cascade.Top, cascade.Far, cascade.Near);
+
+            dirLight.CascadeViewProjections[i] = cascadeCamera.GetViewProjection();
+            dirLight.NumCascades++;
+
+            s_Data.LightSubmissions[s_Data.LightCount].LightID = s_Data.DirLightID;
+            s_Data.LightSubmissions[s_Data.LightCount].Tile = i;
+            s_Data.LightSubmissions[s_Data.LightCount].LightCamera = cascadeCamera;
+            s_Data.LightSubmissions[s_Data.LightCount].LightType = SHADOW_LIGHT_TYPE_DIRECTIONAL;
+            s_Data.LightSubmissions[s_Data.LightCount].LightIndex = 0;
+            s_Data.LightCount++;
+
+            if (s_Data.IsCapturingFrame)
+                s_Data.CapturedFrame.Lights[s_Data.CapturedDirLightIndex].ShadowViews.push_back(MakeCapturedView(cascadeCamera));
+        }
+    }
+
+    glm::vec4 GetShadowAtlasRect(const ShadowAtlasAllocation* allocation, uint32_t tile)
+    {
+        return allocation ? s_Data.ShadowAtlasTiles.GetTileUVRect(allocation->Tiles[tile]) : glm::vec4(0.0f);
+    }
+
+    // Assigns the shadow atlas tiles of all lights of the frame and points the light data at their atlas rects
+    void UpdateShadowAtlas()
+    {
+        const RenderSettings& settings = g_RenderState.Settings;
+        const Camera& sceneCamera = s_Data.SceneCamera;
+        float viewHeight = static_cast<float>(settings.RenderResolution.y);
+
+        std::vector<ShadowAtlasRequest>& requests = s_Data.ShadowAtlasRequests;
+        requests.clear();
+
+        // Cascades always get their full resolution, spot and pointlights get a tile size from their size on screen
+        if (s_Data.DirLight.NumCascades > 0)
+        {
+            ShadowAtlasRequest& request = requests.emplace_back();
+            request.LightID = s_Data.DirLightID;
+            request.NumTiles = s_Data.DirLight.NumCascades;
+            request.FixedTileSize = settings.ShadowMapResolution.x;
+        }
+
+        for (std::size_t i = 0; i < s_Data.SpotLights.size(); ++i)
+        {
+            const SpotLightData& spotLight = s_Data.SpotLights[i];
+            glm::vec4 sphere = LightClustering::GetSpotLightBoundingSphere(spotLight.Position, spotLight.Direction, spotLight.Range, spotLight.OuterConeAngle);
+
+            ShadowAtlasRequest& request = requests.emplace_back();
+            request.LightID = s_Data.SpotLightIDs[i];
+            request.ScreenCoverage = ShadowAtlas::CalculateScreenCoverage(sceneCamera.GetViewMatrix(), sceneCamera.GetProjectionMatrix(), viewHeight, sphere);
+        }
+
+        for (std::size_t i = 0; i < s_Data.PointLights.size(); ++i)
+        {
+            const PointLightData& pointLight = s_Data.PointLights[i];
+            glm::vec4 sphere = LightClustering::GetPointLightBoundingSphere(pointLight.Position, pointLight.Range);
+
+            ShadowAtlasRequest& request = requests.emplace_back();
+            request.LightID = s_Data.PointLightIDs[i];
+            request.NumTiles = 6;
+            request.ScreenCoverage = ShadowAtlas::CalculateScreenCoverage(sceneCamera.GetViewMatrix(), sceneCamera.GetProjectionMatrix(), viewHeight, sphere);
+        }
+
+        // The atlas resolution and tile size range are fixed once the atlas texture exists
+        ShadowAtlasSettings atlasSettings = settings.ShadowAtlas;
+        atlasSettings.AtlasResolution = s_Data.ShadowAtlasTiles.GetSettings().AtlasResolution;
+        atlasSettings.MinTileSize = s_Data.ShadowAtlasTiles.GetSettings().MinTileSize;
+        atlasSettings.MaxTileSize = s_Data.ShadowAtlasTiles.GetSettings().MaxTileSize;
+
+        s_Data.ShadowAtlasTiles.SetSettings(atlasSettings);
+        s_Data.ShadowAtlasTiles.Update(requests);
+
+        const ShadowAtlasStatistics& atlasStats = s_Data.ShadowAtlasTiles.GetStatistics();
+        float atlasTexels = static_cast<float>(atlasSettings.AtlasResolution) * atlasSettings.AtlasResolution;
+        g_RenderState.Stats.ShadowAtlasOccupancy = static_cast<float>(atlasStats.NumAllocatedTexels) / atlasTexels;
+        g_RenderState.Stats.ShadowAtlasNewLightCount = atlasStats.NumNewLights;
+        g_RenderState.Stats.ShadowAtlasResizedLightCount = atlasStats.NumResizedLights;
+        g_RenderState.Stats.ShadowAtlasDeferredResizeCount = atlasStats.NumDeferredResizes;
+        g_RenderState.Stats.ShadowAtlasEvictedLightCount = atlasStats.NumEvictedLights;
+
+        s_Data.SceneData.ShadowAtlasIndex = s_Data.Backend->GetShadowAtlasIndex();
+
+        DirectionalLightData& dirLight = s_Data.DirLight;
+        const ShadowAtlasAllocation* dirLightAllocation = s_Data.ShadowAtlasTiles.GetAllocation(s_Data.DirLightID);
+
+        for (uint32_t i = 0; i < MAX_SHADOW_CASCADES; ++i)
+            dirLight.CascadeAtlasRects[i] = i < dirLight.NumCascades ? GetShadowAtlasRect(dirLightAllocation, i) : glm::vec4(0.0f);
+
+        for (std::size_t i = 0; i < s_Data.SpotLights.size(); ++i)
+            s_Data.SpotLights[i].ShadowAtlasRect = GetShadowAtlasRect(s_Data.ShadowAtlasTiles.GetAllocation(s_Data.SpotLightIDs[i]), 0);
+
+        for (std::size_t i = 0; i < s_Data.PointLights.size(); ++i)
+        {
+            const ShadowAtlasAllocation* allocation = s_Data.ShadowAtlasTiles.GetAllocation(s_Data.PointLightIDs[i]);
+
+            for (uint32_t face = 0; face < 6; ++face)
+                s_Data.PointLights[i].ShadowAtlasRects[face] = GetShadowAtlasRect(allocation, face);
+        }
+    }
+
+    // The shadow atlas requests are made in the order directional light, spotlights, pointlights
+    const ShadowAtlasRequest& GetShadowAtlasRequest(const LightSubmission& lightSubmission)
+    {
+        std::size_t firstSpotLight = s_Data.DirLight.NumCascades > 0 ? 1 : 0;
+
+        switch (lightSubmission.LightType)
+        {
+        case SHADOW_LIGHT_TYPE_SPOT:
+            return s_Data.ShadowAtlasRequests[firstSpotLight + lightSubmission.LightIndex];
+        case SHADOW_LIGHT_TYPE_POINT:
+            return s_Data.ShadowAtlasRequests[firstSpotLight + s_Data.SpotLights.size() + lightSubmission.LightIndex];
+        default:
+            return s_Data.ShadowAtlasRequests[0];
+        }
+    }
+
+    // Points the light data of a shadow view at the shadow map in its tile, which was rendered with viewProjection, or leaves the view unshadowed
+    void SetShadowViewLightData(const LightSubmission& lightSubmission, const glm::mat4& viewProjection, bool isUnshadowed)
+    {
+        uint32_t tile = lightSubmission.Tile;
+
+        switch (lightSubmission.LightType)
+        {
+        case SHADOW_LIGHT_TYPE_DIRECTIONAL:
+            s_Data.DirLight.CascadeViewProjections[tile] = viewProjection;
+            if (isUnshadowed)
+                s_Data.DirLight.CascadeAtlasRects[tile] = glm::vec4(0.0f);
+            break;
+        case SHADOW_LIGHT_TYPE_SPOT:
+            s_Data.SpotLights[lightSubmission.LightIndex].ViewProjection = viewProjection;
+            if (isUnshadowed)
+                s_Data.SpotLights[lightSubmission.LightIndex].ShadowAtlasRect = glm::vec4(0.0f);
+            break;
+        case SHADOW_LIGHT_TYPE_POINT:
+            s_Data.PointLights[lightSubmission.LightIndex].FaceViewProjections[tile] = viewProjection;
+            if (isUnshadowed)
+                s_Data.PointLights[lightSubmission.LightIndex].ShadowAtlasRects[tile] = glm::vec4(0.0f);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Builds the shadow views of all lights with tiles in the shadow atlas and schedules which of them are rendered this frame.
+    // A view that is not rendered is sampled with the view projection of its last update, or is unshadowed if its tile holds no shadow map of it yet
+    void UpdateShadowViews()
+    {
+        s_Data.ShadowViews.clear();
+
+        // Lights without tiles are not shadowed and have no views
+        for (std::size_t i = 0; i < s_Data.LightCount; ++i)
+        {
+            const LightSubmission& lightSubmission = s_Data.LightSubmissions[i];
+            const ShadowAtlasAllocation* allocation = s_Data.ShadowAtlasTiles.GetAllocation(lightSubmission.LightID);
+
+            if (!allocation)
+                continue;
+
+            ShadowView& view = s_Data.ShadowViews.emplace_back();
+            view.LightSubmission = i;
+            view.Tile = allocation->Tiles[lightSubmission.Tile];
+            view.ViewID = MakeShadowViewID(lightSubmission.LightID, lightSubmission.Tile);
         }
 
-        {
-            // SDR color target
-            TextureDesc desc = {};
-            desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_WRITE;
-            desc.Format = TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM;
-            desc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.Height = g_RenderState.Settings.RenderResolution.y;
-            desc.DebugName = "SDR color target";
-
-            g_RenderState.SDRColorTarget = std::make_unique<Texture>(desc);
-        }
+        CullShadowCasters();
 
-        {
-            // Velocity target
-            TextureDesc desc = {};
-            desc.Usage = TextureUsage::TEXTURE_USAGE_RENDER_TARGET | TextureUsage::TEXTURE_USAGE_READ;
-            desc.Format = TextureFormat::TEXTURE_FORMAT_RG16_FLOAT;
-            desc.Width = g_RenderState.Settings.RenderResolution.x;
-            desc.Height = g_RenderState.Settings.RenderResolution.y;
-            desc.DebugName = "Velocity target";
+        for (auto& [viewID, state] : s_Data.ShadowViewStates)
+            state.IsUsed = false;
 
-            g_RenderState.VelocityTarget = std::make_unique<Texture>(desc);
+        glm::vec3 cameraPosition = s_Data.SceneCamera.GetTransform().GetPosition();
+        std::vector<ShadowViewRequest>& requests = s_Data.ShadowViewRequests;
+        requests.clear();
 
-            desc.Usage = TextureUsage::TEXTURE_USAGE_READ;
-            desc.DebugName = "Velocity target previous";
+        for (const ShadowView& view : s_Data.ShadowViews)
+        {
+            const LightSubmission& lightSubmission = s_Data.LightSubmissions[view.LightSubmission];
+            ShadowViewState& state = s_Data.ShadowViewStates[view.ViewID];
+            state.IsUsed = true;
+
+            ShadowViewRequest& request = requests.emplace_back();
+            request.ViewID = view.ViewID;
+            request.ScreenCoverage = GetShadowAtlasRequest(lightSubmission).ScreenCoverage;
+            request.HasMoved = state.RenderedViewProjection != lightSubmission.LightCamera.GetViewProjection();
+            request.IsInvalid = !state.HasContent || state.RenderedTile != view.Tile;
+            // Cascades follow the camera, a stale cascade would not cover what the camera sees
+            request.AlwaysUpdate = lightSubmission.LightType == SHADOW_LIGHT_TYPE_DIRECTIONAL;
+
+            if (lightSubmission.LightType == SHADOW_LIGHT_TYPE_SPOT)
+                request.Distance = glm::distance(cameraPosition, s_Data.SpotLights[lightSubmission.LightIndex].Position);
+            else if (lightSubmission.LightType == SHADOW_LIGHT_TYPE_POINT)
+                request.Distance = glm::distance(cameraPosition, s_Data.PointLights[lightSubmission.LightIndex].Position);
+
+            // Estimated with the full detail meshes, shadow maps usually draw coarser LODs and cached views only their dynamic casters
+            ForEachShadowCaster(view, [&](const MeshSubmission& submission)
+            {
+                const RenderBuffer* indexBuffer = g_RenderState.BufferSlotmap.Find(submission.Mesh->IndexBuffer);
 
-            g_RenderState.VelocityTargetPrevious = std::make_unique<Texture>(desc);
+                request.NumDraws++;
+                request.NumTriangles += indexBuffer->Desc.NumElements / 3;
+                request.HasDynamicCasters |= !submission.IsStatic;
+            });
         }
-    }
 
-    void CreateDefaultTextures()
-    {
-        // Make default white and normal textures
-        uint32_t defaultWhiteTextureData = 0xFFFFFFFF;
+        s_Data.ShadowUpdateScheduler.SetSettings(g_RenderState.Settings.ShadowScheduler);
+        s_Data.ShadowUpdateScheduler.Schedule(requests, s_Data.ShadowViewUpdates);
 
-        TextureDesc defaultTextureDesc = {};
-        defaultTextureDesc.Usage = TextureUsage::TEXTURE_USAGE_READ;
-        defaultTextureDesc.Format = TextureFormat::TEXTURE_FORMAT_RGBA8_UNORM;
-        defaultTextureDesc.Width = 1;
-        defaultTextureDesc.Height = 1;
-        defaultTextureDesc.DataPtr = &defaultWhiteTextureData;
-        defaultTextureDesc.DebugName = "Default white texture";
+        const ShadowSchedulerStatistics& scheduleStats = s_Data.ShadowUpdateScheduler.GetStatistics();
+        g_RenderState.Stats.ShadowViewSkippedCount = scheduleStats.NumSkippedViews;
+        g_RenderState.Stats.ShadowViewUnshadowedCount = scheduleStats.NumUnshadowedViews;
 
-        g_RenderState.DefaultWhiteTexture = std::make_unique<Texture>(defaultTextureDesc);
+        for (std::size_t i = 0; i < s_Data.ShadowViews.size(); ++i)
+        {
+            ShadowView& view = s_Data.ShadowViews[i];
+            const LightSubmission& lightSubmission = s_Data.LightSubmissions[view.LightSubmission];
+            ShadowViewState& state = s_Data.ShadowViewStates[view.ViewID];
 
-        // Texture data is in ABGR layout, the default normal will point forward in tangent space (blue)
-        uint32_t defaultNormalTextureData = (255 << 24) | (255 << 16) | (127 << 8) | (127 << 0);
-        defaultTextureDesc.DataPtr = &defaultNormalTextureData;
-        defaultTextureDesc.DebugName = "Default normal texture";
+            view.Update = s_Data.ShadowViewUpdates[i] != 0;
+
+            if (view.Update)
+            {
+                state.HasContent = true;
+                state.RenderedTile = view.Tile;
+                state.RenderedViewProjection = lightSubmission.LightCamera.GetViewProjection();
+
+                g_RenderState.Stats.ShadowMapCount++;
+            }
+            else
+            {
+                SetShadowViewLightData(lightSubmission, state.RenderedViewProjection, requests[i].IsInvalid);
+            }
+        }
 
-        g_RenderState.DefaultNormalTexture = std::make_unique<Texture>(defaultTextureDesc);
+        for (auto iter = s_Data.ShadowViewStates.begin(); iter != s_Data.ShadowViewStates.end();)
+        {
+            if (!iter->second.IsUsed)
+                iter = s_Data.ShadowViewStates.erase(iter);
+            else
+                ++iter;
+        }
     }
 
-    void CopyPreviousFrameRenderTargets()
+    void UploadLightData()
     {
-        auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+        RenderBackend& backend = *s_Data.Backend;
+        backend.WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHTS, &s_Data.DirLight, sizeof(DirectionalLightData), 0);
 
-        // Copy current velocity into previous velocity
-        commandList->CopyResource(*g_RenderState.VelocityTargetPrevious, *g_RenderState.VelocityTarget);
+        for (std::size_t i = 0; i < s_Data.SpotLights.size(); ++i)
+        {
+            backend.WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHTS, &s_Data.SpotLights[i], sizeof(SpotLightData),
+                sizeof(DirectionalLightData) + i * sizeof(SpotLightData));
+        }
 
-        RenderBackend::ExecuteCommandList(commandList);
+        for (std::size_t i = 0; i < s_Data.PointLights.size(); ++i)
+        {
+            backend.WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_LIGHTS, &s_Data.PointLights[i], sizeof(PointLightData),
+                sizeof(DirectionalLightData) + g_RenderState.MAX_SPOT_LIGHTS * sizeof(SpotLightData) + i * sizeof(PointLightData));
+        }
     }
 
-    void ClearRenderTargets()
+    void UpdateInstanceLightLists()
     {
-        auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+        LightAssignmentLights& lights = s_Data.AssignmentLights;
+        lights.Reset();
 
-        commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-        commandList->Transition(*g_RenderState.VelocityTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-        commandList->Transition(*g_RenderState.HDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-        commandList->Transition(*g_RenderState.SDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        for (const SpotLightData& spotLight : s_Data.SpotLights)
+            LightAssignment::AddSpotLight(lights, spotLight.Position, spotLight.Direction, spotLight.Range, spotLight.OuterConeAngle);
+        for (const PointLightData& pointLight : s_Data.PointLights)
+            LightAssignment::AddPointLight(lights, pointLight.Position, pointLight.Range);
 
-        commandList->ClearDepthStencilView(g_RenderState.DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV), g_RenderState.DepthPrepassDepthTarget->GetTextureDesc().ClearColor.x);
-        commandList->ClearRenderTargetView(g_RenderState.VelocityTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(g_RenderState.VelocityTarget->GetTextureDesc().ClearColor));
-        commandList->ClearRenderTargetView(g_RenderState.HDRColorTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(g_RenderState.HDRColorTarget->GetTextureDesc().ClearColor));
-        commandList->ClearRenderTargetView(g_RenderState.SDRColorTarget->GetDescriptor(DescriptorType::RTV), glm::value_ptr<float>(g_RenderState.SDRColorTarget->GetTextureDesc().ClearColor));
+        s_Data.InstanceLightIndices.clear();
 
-        RenderBackend::ExecuteCommandList(commandList);
-    }
+        // The light list range is written into the instance data of the submissions, before they are written to the instance table
+        auto assignLights = [&lights](std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>& submissions, std::size_t numSubmissions)
+        {
+            for (std::size_t i = 0; i < numSubmissions; ++i)
+            {
+                MeshInstanceData& instance = submissions[i].InstanceData;
+                BoundingBox worldBB = LightAssignment::TransformBoundingBox(submissions[i].Mesh->BB, instance.Transform);
 
-    void ResizeResolutionDependentResources(uint32_t width, uint32_t height)
-    {
-        g_RenderState.DepthPrepassDepthTarget->Resize(width, height);
-        g_RenderState.HDRColorTarget->Resize(width, height);
-        g_RenderState.SDRColorTarget->Resize(width, height);
-
-        g_RenderState.TAAResolveTarget->Resize(width, height);
-        g_RenderState.TAAHistory->Resize(width, height);
-        g_RenderState.VelocityTarget->Resize(width, height);
-        g_RenderState.VelocityTargetPrevious->Resize(width, height);
-    }
+                instance.LightListOffset = static_cast<uint32_t>(s_Data.InstanceLightIndices.size());
+                instance.NumLights = LightAssignment::AssignLights(lights, worldBB, s_Data.InstanceLightIndices);
+            }
+        };
 
-    bool CullViewFrustum(const ViewFrustum& frustum, const Mesh* mesh, const MeshInstanceData& meshInstance)
-    {
-        BoundingBox meshInstanceBB = mesh->BB;
-        meshInstanceBB.Min = meshInstance.Transform * glm::vec4(mesh->BB.Min, 1.0f);
-        meshInstanceBB.Max = meshInstance.Transform * glm::vec4(mesh->BB.Max, 1.0f);
+        for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
+            assignLights(s_Data.MeshSubmissions[i], s_Data.MeshCounts[i]);
 
-        DebugRenderer::SubmitAABB(meshInstanceBB.Min, meshInstanceBB.Max, glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
+        ASSERT(s_Data.InstanceLightIndices.size() <= MAX_INSTANCE_LIGHT_INDICES, "Exceeded the size of the instance light index buffer");
 
-        return frustum.IsBoxInViewFrustum(meshInstanceBB.Min, meshInstanceBB.Max);
+        // Light list offsets are relative to the copy of the frame, earlier frames might still be reading theirs
+        if (!s_Data.InstanceLightIndices.empty())
+        {
+            s_Data.Backend->WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_INSTANCE_LIGHT_INDICES, s_Data.InstanceLightIndices.data(),
+                s_Data.InstanceLightIndices.size() * sizeof(uint32_t), s_Data.SceneTableCopyIndex * MAX_INSTANCE_LIGHT_INDICES * sizeof(uint32_t));
+        }
+
+        g_RenderState.Stats.InstanceLightAssignmentCount = static_cast<uint32_t>(s_Data.InstanceLightIndices.size());
     }
 
-    void RenderGeometry(CommandList& commandList, const Camera& camera, TransparencyMode transparency)
+    void UploadSceneTable(GPUSceneTable& table, RenderBufferType buffer, std::size_t copyByteOffset)
     {
-        std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>* meshSubmissions;
-        std::size_t numSubmissions;
+        table.EndFrame(s_Data.SceneTableCopyIndex, s_Data.SceneTableUploads);
 
-        if (transparency == TransparencyMode::OPAQUE)
-        {
-            commandList.SetVertexBuffers(1, 1, *g_RenderState.MeshInstanceBufferOpaque);
-            meshSubmissions = &s_Data.OpaqueMeshSubmissions;
-            numSubmissions = s_Data.OpaqueMeshCount;
-        }
-        else
-        {
-            commandList.SetVertexBuffers(1, 1, *g_RenderState.MeshInstanceBufferTransparent);
-            meshSubmissions = &s_Data.TransparentMeshSubmissions;
-            numSubmissions = s_Data.TransparentMeshCount;
-        }
+        for (const GPUSceneTableUpload& upload : s_Data.SceneTableUploads)
+            s_Data.Backend->WriteRenderBuffer(buffer, table.GetData() + upload.ByteOffset, upload.ByteSize, copyByteOffset + upload.ByteOffset);
 
-        uint32_t currentInstance = 0;
-        //RenderResourceHandle prevVertexBufferHandle;
+        g_RenderState.Stats.SceneTableUploadByteCount += table.GetStatistics().NumUploadedBytes;
+    }
 
-        for (std::size_t m = 0; m < numSubmissions; ++m)
+    void UpdateSceneTables()
+    {
+        auto updateInstances = [](std::array<MeshSubmission, RenderState::MAX_MESH_INSTANCES>& submissions, std::size_t numSubmissions)
         {
-            const auto mesh = (*meshSubmissions)[m].Mesh;
-            const auto& meshInstance = (*meshSubmissions)[m].InstanceData;
-
-            if (camera.IsFrustumCullingEnabled())
-            {
-                if (!CullViewFrustum(camera.GetViewFrustum(), mesh, meshInstance))
-                {
-                    currentInstance++;
-                    continue;
-                }
-            }
+            for (std::size_t i = 0; i < numSubmissions; ++i)
+                submissions[i].InstanceSlot = s_Data.InstanceTable.Update(submissions[i].ObjectID, &submissions[i].InstanceData);
+        };
 
-            auto vertexBuffer = g_RenderState.BufferSlotmap.Find(mesh->VertexBuffer);
-            auto indexBuffer = g_RenderState.BufferSlotmap.Find(mesh->IndexBuffer);
+        for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
+            updateInstances(s_Data.MeshSubmissions[i], s_Data.MeshCounts[i]);
 
-            commandList.SetVertexBuffers(0, 1, *vertexBuffer);
-            commandList.SetIndexBuffer(*indexBuffer);
+        UploadSceneTable(s_Data.InstanceTable, RenderBufferType::RENDER_BUFFER_TYPE_MESH_INSTANCES,
+            s_Data.SceneTableCopyIndex * MAX_INSTANCE_TABLE_ENTRIES * sizeof(MeshInstanceData));
+        UploadSceneTable(s_Data.MaterialTable, RenderBufferType::RENDER_BUFFER_TYPE_MATERIALS, s_Data.SceneTableCopyIndex * MATERIAL_TABLE_COPY_BYTE_SIZE);
+    }
 
-            /*if (RENDER_RESOURCE_HANDLE_COMPARE(prevVertexBufferHandle, mesh->VertexBuffer))
-            {
-                prevVertexBufferHandle = mesh->VertexBuffer;
+    void ValidateLightClusters()
+    {
+        // Waits for the GPU lists, this stalls the frame and is only meant for debugging
+        LightClusterLists gpuLists;
+        s_Data.Backend->ReadBackLightClusters(gpuLists);
 
-                commandList.SetVertexBuffers(0, 1, *vertexBuffer);
-                commandList.SetIndexBuffer(*indexBuffer);
-            }*/
+        LightClusterLists cpuLists;
+        LightClustering::BuildClusters(s_Data.ClusterGrid, s_Data.ViewLightSpheres, cpuLists);
 
-            commandList.DrawIndexed(static_cast<uint32_t>(indexBuffer->GetBufferDesc().NumElements), 1, 0, 0, currentInstance);
+        s_Data.NumClusterMismatches = LightClustering::CompareClusters(cpuLists, gpuLists);
+        s_Data.ClusterStats = LightClustering::GetStatistics(cpuLists, static_cast<uint32_t>(s_Data.ViewLightSpheres.size()));
+        s_Data.HasClusterValidation = true;
 
-            g_RenderState.Stats.DrawCallCount++;
-            currentInstance++;
-        }
+        if (s_Data.NumClusterMismatches == 0)
+            LOG_INFO("[LightClustering] GPU cluster lists match the CPU reference for {} lights", s_Data.ClusterStats.NumLights);
+        else
+            LOG_WARN("[LightClustering] {} clusters differ between the GPU lists and the CPU reference", s_Data.NumClusterMismatches);
     }
 
-    void RenderShadowMap(CommandList& commandList, const Camera& lightCamera, const Texture& shadowMap, uint32_t descriptorOffset)
+    void RegisterGPUZones()
     {
-        CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, static_cast<float>(shadowMap.GetTextureDesc().Width),
-            static_cast<float>(shadowMap.GetTextureDesc().Height), 0.0f, 1.0f);
-        CD3DX12_RECT scissorRect = CD3DX12_RECT(0.0f, 0.0f, LONG_MAX, LONG_MAX);
+        GPUProfiler& gpuProfiler = s_Data.Backend->GetGPUProfiler();
+
+        s_Data.GPUZones.Scene = gpuProfiler.RegisterZone("Scene");
+        s_Data.GPUZones.ShadowMapping = gpuProfiler.RegisterZone("Shadow mapping");
+        s_Data.GPUZones.LightClustering = gpuProfiler.RegisterZone("Light clustering");
+        s_Data.GPUZones.Geometry[TransparencyMode::OPAQUE] = gpuProfiler.RegisterZone("Geometry (opaque)");
+        s_Data.GPUZones.Geometry[TransparencyMode::MASKED] = gpuProfiler.RegisterZone("Geometry (masked)");
+        s_Data.GPUZones.Geometry[TransparencyMode::TRANSPARENT] = gpuProfiler.RegisterZone("Geometry (transparent)");
+        s_Data.GPUZones.DepthPrepass = gpuProfiler.RegisterZone("Depth pre-pass");
+        s_Data.GPUZones.Lighting = gpuProfiler.RegisterZone("Lighting");
+        s_Data.GPUZones.TemporalAA = gpuProfiler.RegisterZone("Temporal-AA");
+        s_Data.GPUZones.PostProcess = gpuProfiler.RegisterZone("Post-process");
+    }
 
-        commandList.SetViewports(1, &viewport);
-        commandList.SetScissorRects(1, &scissorRect);
+    bool ArePassPipelineStatesReady()
+    {
+        if (s_Data.ArePipelineStatesReady)
+            return true;
 
-        D3D12_CPU_DESCRIPTOR_HANDLE dsv = shadowMap.GetDescriptor(DescriptorType::DSV, descriptorOffset);
-        commandList.SetRenderTargets(0, nullptr, &dsv);
+        if (!s_Data.Backend->ArePipelineStatesReady())
+            return false;
 
-        // Set root constant (light VP)
-        const glm::mat4& lightViewProjection = lightCamera.GetViewProjection();
-        commandList.SetRootConstants(0, 16, &lightViewProjection[0][0], 0);
+        s_Data.ArePipelineStatesReady = true;
+        LOG_INFO("[Renderer] Pipeline states of all passes are ready after {} frames", s_Data.NumFramesWaitingForPipelineStates);
 
-        RenderGeometry(commandList, lightCamera, TransparencyMode::OPAQUE);
-        RenderGeometry(commandList, lightCamera, TransparencyMode::TRANSPARENT);
+        return true;
     }
 
 }
 
-void Renderer::Initialize(HWND hWnd, uint32_t width, uint32_t height)
+void Renderer::Initialize(std::unique_ptr<RenderBackend> backend, uint32_t width, uint32_t height)
 {
-    RenderBackend::Initialize(hWnd, width, height);
+    s_Data.Backend = std::move(backend);
+    RegisterGPUZones();
+
+    s_Data.InstanceTable = GPUSceneTable(sizeof(MeshInstanceData), MAX_INSTANCE_TABLE_ENTRIES, RenderState::BACK_BUFFER_COUNT);
+    s_Data.MaterialTable = GPUSceneTable(sizeof(MaterialData), RenderState::MAX_MATERIALS, RenderState::BACK_BUFFER_COUNT);
 
     g_RenderState.Settings.RenderResolution.x = width;
     g_RenderState.Settings.RenderResolution.y = height;
 
-    CreateRenderPasses();
-    CreateRenderTargets();
+    s_Data.Backend->CreateRenderPasses(g_RenderState.Settings);
+    s_Data.Backend->CreateRenderTargets(g_RenderState.Settings);
+    s_Data.ShadowAtlasTiles.SetSettings(g_RenderState.Settings.ShadowAtlas);
+
     CreateBuffers();
     CreateDefaultTextures();
 }
 
 void Renderer::Finalize()
 {
-    RenderBackend::Finalize();
+    RenderBackend& backend = *s_Data.Backend;
+
+    backend.Flush();
+    EraseDestroyedResources(g_RenderState.BufferSlotmap, s_Data.DestroyedBuffers, true);
+    EraseDestroyedResources(g_RenderState.TextureSlotmap, s_Data.DestroyedTextures, true);
+
+    // Buffers and textures that were never destroyed are released with the backend
+    g_RenderState.BufferSlotmap.ForEach([&backend](RenderBuffer& buffer) {
+        backend.ReleaseResource(buffer.Resource);
+        buffer.Resource = nullptr;
+    });
+    g_RenderState.TextureSlotmap.ForEach([&backend](RenderTexture& texture) {
+        backend.ReleaseResource(texture.Resource);
+        texture.Resource = nullptr;
+    });
+
+    backend.ReleaseResource(g_RenderState.DefaultWhiteTexture);
+    backend.ReleaseResource(g_RenderState.DefaultNormalTexture);
+    g_RenderState.DefaultWhiteTexture = nullptr;
+    g_RenderState.DefaultNormalTexture = nullptr;
+
+    // The scene tables are tracked render memory, they are replaced by empty ones so they are not reported as leaks
+    s_Data.InstanceTable = GPUSceneTable(sizeof(MeshInstanceData), 0, RenderState::BACK_BUFFER_COUNT);
+    s_Data.MaterialTable = GPUSceneTable(sizeof(MaterialData), 0, RenderState::BACK_BUFFER_COUNT);
+    s_Data.CaptureWriter.reset();
+
+    s_Data.ArePipelineStatesReady = false;
+    s_Data.Backend.reset();
 }
 
 void Renderer::BeginFrame()
 {
     SCOPED_TIMER("Renderer::BeginFrame");
 
-    RenderBackend::BeginFrame();
+    s_Data.Backend->BeginFrame();
 
-    CopyPreviousFrameRenderTargets();
-    ClearRenderTargets();
+    // Beginning the frame waited for the oldest frame in flight, which frees the resources destroyed in it
+    s_Data.FrameIndex++;
+    EraseDestroyedResources(g_RenderState.BufferSlotmap, s_Data.DestroyedBuffers, false);
+    EraseDestroyedResources(g_RenderState.TextureSlotmap, s_Data.DestroyedTextures, false);
 }
 
 void Renderer::BeginScene(const Camera& sceneCamera)
@@ -610,219 +1417,183 @@ void Renderer::BeginScene(const Camera& sceneCamera)
     s_Data.SceneCamera = sceneCamera;
     s_Data.SceneData.ViewProjection = sceneCamera.GetViewProjection();
     s_Data.SceneData.CameraPosition = sceneCamera.GetTransform().GetPosition();
+
+    s_Data.InstanceTable.BeginFrame();
+    s_Data.MaterialTable.BeginFrame();
+
+    s_Data.IsCapturingFrame = s_Data.CaptureWriter != nullptr;
+    if (s_Data.IsCapturingFrame)
+    {
+        const RenderSettings& settings = g_RenderState.Settings;
+
+        s_Data.CapturedFrame.Reset();
+        s_Data.CapturedFrame.Settings.RenderWidth = settings.RenderResolution.x;
+        s_Data.CapturedFrame.Settings.RenderHeight = settings.RenderResolution.y;
+        s_Data.CapturedFrame.Settings.ShadowMapResolution = settings.ShadowMapResolution.x;
+        s_Data.CapturedFrame.Settings.EnableMeshLODs = settings.EnableMeshLODs;
+        s_Data.CapturedFrame.Settings.LODErrorThreshold = settings.LODErrorThreshold;
+        s_Data.CapturedFrame.Settings.ShadowLODErrorThreshold = settings.ShadowLODErrorThreshold;
+        s_Data.CapturedFrame.SceneView = MakeCapturedView(sceneCamera);
+    }
 }
 
 void Renderer::Render()
 {
     SCOPED_TIMER("Renderer::Render");
 
+    // Pipeline states are created on the job system, the passes depend on each other, so the scene is only drawn once all of them are ready.
+    // Until then the render targets keep the values they were cleared to in BeginFrame
+    if (!ArePassPipelineStatesReady())
+    {
+        s_Data.NumFramesWaitingForPipelineStates++;
+        return;
+    }
+
+    RenderBackend& backend = *s_Data.Backend;
+
+    // The copies of a back buffer are not read by the GPU anymore once the frame can be recorded
+    s_Data.SceneTableCopyIndex = backend.GetBackBufferIndex();
+
     g_RenderState.GlobalCBData.Resolution = g_RenderState.Settings.RenderResolution;
     g_RenderState.GlobalCBData.TAA_HaltonJitter = GetRandomHaltonJitter(g_RenderState.Settings.RenderResolution.x, g_RenderState.Settings.RenderResolution.y);
     g_RenderState.GlobalCBData.TM_Exposure = s_Data.SceneCamera.GetExposure();
     g_RenderState.GlobalCBData.TM_Gamma = s_Data.SceneCamera.GetGamma();
-    g_RenderState.GlobalConstantBuffer->SetBufferData(&g_RenderState.GlobalCBData);
+    backend.WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_GLOBAL_CONSTANTS, &g_RenderState.GlobalCBData, sizeof(GlobalConstantBufferData));
 
-    g_RenderState.SceneDataConstantBuffer->SetBufferData(&s_Data.SceneData);
-    g_RenderState.Stats.MeshCount = s_Data.OpaqueMeshCount + s_Data.TransparentMeshCount;
+    g_RenderState.Stats.MeshCount = 0;
+    for (std::size_t meshCount : s_Data.MeshCounts)
+        g_RenderState.Stats.MeshCount += static_cast<uint32_t>(meshCount);
 
-    for (std::size_t i = 0; i < s_Data.OpaqueMeshCount; ++i)
-    {
-        Buffer* indexBuffer = g_RenderState.BufferSlotmap.Find(s_Data.OpaqueMeshSubmissions[i].Mesh->IndexBuffer);
-        g_RenderState.Stats.TriangleCount += indexBuffer->GetBufferDesc().NumElements / 3;
-    }
+    SortMeshSubmissions();
+    UpdateShadowReceivers();
+    UpdateShadowCascades();
+    UpdateShadowAtlas();
+    UpdateShadowViews();
+    UpdateFrameShaderFeatures();
+    UploadLightData();
 
-    for (std::size_t i = 0; i < s_Data.TransparentMeshCount; ++i)
-    {
-        Buffer* indexBuffer = g_RenderState.BufferSlotmap.Find(s_Data.TransparentMeshSubmissions[i].Mesh->IndexBuffer);
-        g_RenderState.Stats.TriangleCount += indexBuffer->GetBufferDesc().NumElements / 3;
-    }
+    // Per instance light lists are part of the instance data, so they are assigned before the instance table is uploaded
+    if (g_RenderState.Settings.LightCulling == LightCullingMode::LIGHT_CULLING_MODE_PER_INSTANCE)
+        UpdateInstanceLightLists();
+
+    UpdateSceneTables();
 
-    auto& bindlessDescriptorHeap = RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    s_Data.SceneData.LightCulling = g_RenderState.Settings.LightCulling;
+    backend.WriteRenderBuffer(RenderBufferType::RENDER_BUFFER_TYPE_SCENE_DATA, &s_Data.SceneData, sizeof(SceneData));
 
     {
         /* Shadow mapping render pass */
-        auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
-        commandList->BeginTimestampQuery("Shadow mapping");
+        backend.BeginCommandList();
+        backend.BeginGPUZone(s_Data.GPUZones.Scene);
+        backend.BeginGPUZone(s_Data.GPUZones.ShadowMapping);
 
-        // Clear all shadow map textures and transition them to the depth write state
-        for (std::size_t i = 0; i < s_Data.LightCount; ++i)
-        {
-            commandList->Transition(*s_Data.LightSubmissions[i].ShadowMap, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-            commandList->ClearDepthStencilView(s_Data.LightSubmissions[i].ShadowMap->GetDescriptor(DescriptorType::DSV), 0.0f);
-        }
+        backend.BindRenderPass(RenderPassType::SHADOW_MAPPING, s_Data.SceneTableCopyIndex);
+
+        // Every shadow view renders into its own shadow atlas tile, a pointlight has one tile per face which is cached and updated on its own
+        RenderShadowMaps();
 
-        // Set bindless descriptor heap
-        commandList->SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessDescriptorHeap);
+        backend.EndGPUZone();
+        backend.ExecuteCommandList();
+    }
 
-        // Bind render pass bindables (sets viewport, scissor rect, render targets, pipeline state, root signature and primitive topology)
-        commandList->SetRenderPassBindables(*s_Data.RenderPasses[RenderPassType::SHADOW_MAPPING]);
+    // The lighting shader reads the light counts from the cluster grid in both light culling modes
+    UpdateLightClusterData();
 
-        for (std::size_t i = 0; i < s_Data.LightCount; ++i)
+    if (g_RenderState.Settings.LightCulling != LightCullingMode::LIGHT_CULLING_MODE_PER_INSTANCE)
+    {
+        /* Light clustering pass */
+        backend.BeginCommandList();
+        backend.BeginGPUZone(s_Data.GPUZones.LightClustering);
+
+        backend.DispatchLightClustering(s_Data.SceneTableCopyIndex);
+
+        backend.EndGPUZone();
+
+        if (s_Data.IsClusterValidationRequested)
         {
-            RenderShadowMap(*commandList, s_Data.LightSubmissions[i].LightCamera, *s_Data.LightSubmissions[i].ShadowMap, s_Data.LightSubmissions[i].Face);
+            s_Data.IsClusterValidationRequested = false;
+            ValidateLightClusters();
+        }
+        else
+        {
+            backend.ExecuteCommandList();
         }
-
-        commandList->EndTimestampQuery("Shadow mapping");
-        RenderBackend::ExecuteCommandList(commandList);
     }
 
-    const std::string timestampNames[4] = { "Depth pre-pass (opaque)", "Depth pre-pass (transparent)", "Lighting (opaque)", "Lighting (transparent)" };
-
+    // Opaque, masked and transparent geometry in that order, transparent geometry has no depth pre-pass
     for (uint32_t i = 0; i < TransparencyMode::NUM_ALPHA_MODES; ++i)
     {
+        TransparencyMode transparency = static_cast<TransparencyMode>(i);
+        bool hasDepthPrepass = transparency != TransparencyMode::TRANSPARENT;
+
+        if (hasDepthPrepass)
         {
             /* Depth pre-pass render pass */
-            auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
-            commandList->BeginTimestampQuery(timestampNames[i]);
-            commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+            backend.BeginCommandList();
+            backend.BeginGPUZone(s_Data.GPUZones.Geometry[i]);
+            backend.BeginGPUZone(s_Data.GPUZones.DepthPrepass);
 
-            // Bind render pass bindables
-            commandList->SetRenderPassBindables(*s_Data.RenderPasses[RenderPassType::DEPTH_PREPASS]);
-            
-            CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, static_cast<float>(g_RenderState.Settings.RenderResolution.x),
-                static_cast<float>(g_RenderState.Settings.RenderResolution.y), 0.0f, 1.0f);
-            CD3DX12_RECT scissorRect = CD3DX12_RECT(0.0f, 0.0f, LONG_MAX, LONG_MAX);
+            // Masked geometry samples the albedo alpha of its material
+            bool isMasked = transparency == TransparencyMode::MASKED;
+            backend.BindRenderPass(isMasked ? RenderPassType::DEPTH_PREPASS_MASKED : RenderPassType::DEPTH_PREPASS, s_Data.SceneTableCopyIndex);
 
-            commandList->SetViewports(1, &viewport);
-            commandList->SetScissorRects(1, &scissorRect);
+            g_RenderState.Stats.DepthPrepassDrawCallCount += RenderGeometry(s_Data.SceneCamera, transparency,
+                static_cast<float>(g_RenderState.Settings.RenderResolution.y), g_RenderState.Settings.LODErrorThreshold,
+                isMasked ? MESH_VERTEX_STREAMS_ALPHA_TEST : MESH_VERTEX_STREAMS_POSITIONS);
 
-            D3D12_CPU_DESCRIPTOR_HANDLE dsv = g_RenderState.DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
-            commandList->SetRenderTargets(0, nullptr, &dsv);
-
-            commandList->SetRootConstantBufferView(0, *g_RenderState.GlobalConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-            commandList->SetRootConstantBufferView(1, *g_RenderState.SceneDataConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-
-            RenderGeometry(*commandList, s_Data.SceneCamera, static_cast<TransparencyMode>(i));
-
-            commandList->EndTimestampQuery(timestampNames[i]);
-            RenderBackend::ExecuteCommandList(commandList);
+            backend.EndGPUZone();
+            backend.ExecuteCommandList();
         }
 
         {
             /* Lighting render pass */
-            auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
-            commandList->BeginTimestampQuery(timestampNames[2 + i]);
-
-            // Transition all shadow maps to the pixel shader resource state
-            for (std::size_t i = 0; i < s_Data.LightCount; ++i)
-            {
-                commandList->Transition(*s_Data.LightSubmissions[i].ShadowMap, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-            }
-
-            commandList->Transition(*g_RenderState.HDRColorTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-            commandList->Transition(*g_RenderState.VelocityTarget, D3D12_RESOURCE_STATE_RENDER_TARGET);
-            commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-
-            // Set bindless descriptor heap
-            commandList->SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessDescriptorHeap);
+            backend.BeginCommandList();
+            if (!hasDepthPrepass)
+                backend.BeginGPUZone(s_Data.GPUZones.Geometry[i]);
+            backend.BeginGPUZone(s_Data.GPUZones.Lighting);
 
-            // Bind render pass bindables (sets viewport, scissor rect, render targets, pipeline state, root signature and primitive topology)
-            commandList->SetRenderPassBindables(*s_Data.RenderPasses[RenderPassType::LIGHTING]);
+            RenderPassType lightingPass = hasDepthPrepass ? RenderPassType::LIGHTING : RenderPassType::LIGHTING_TRANSPARENT;
+            backend.BindRenderPass(lightingPass, s_Data.SceneTableCopyIndex);
 
-            CD3DX12_VIEWPORT viewport = CD3DX12_VIEWPORT(0.0f, 0.0f, static_cast<float>(g_RenderState.Settings.RenderResolution.x),
-                static_cast<float>(g_RenderState.Settings.RenderResolution.y), 0.0f, 1.0f);
-            CD3DX12_RECT scissorRect = CD3DX12_RECT(0.0f, 0.0f, LONG_MAX, LONG_MAX);
+            g_RenderState.Stats.LightingDrawCallCount[i] += RenderGeometry(s_Data.SceneCamera, transparency,
+                static_cast<float>(g_RenderState.Settings.RenderResolution.y), g_RenderState.Settings.LODErrorThreshold,
+                MESH_VERTEX_STREAMS_ALL, SHADOW_CASTERS_ALL, nullptr, &lightingPass);
 
-            commandList->SetViewports(1, &viewport);
-            commandList->SetScissorRects(1, &scissorRect);
-
-            D3D12_CPU_DESCRIPTOR_HANDLE rtvs[] = {
-                g_RenderState.HDRColorTarget->GetDescriptor(DescriptorType::RTV),
-                g_RenderState.VelocityTarget->GetDescriptor(DescriptorType::RTV)
-            };
-            D3D12_CPU_DESCRIPTOR_HANDLE dsv = g_RenderState.DepthPrepassDepthTarget->GetDescriptor(DescriptorType::DSV);
-            commandList->SetRenderTargets(2, rtvs, &dsv);
-
-            // Set root CBV for constant buffers
-            commandList->SetRootConstantBufferView(0, *g_RenderState.GlobalConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-            commandList->SetRootConstantBufferView(1, *g_RenderState.SceneDataConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-            commandList->SetRootConstantBufferView(2, *g_RenderState.MaterialConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-            commandList->SetRootConstantBufferView(3, *g_RenderState.LightConstantBuffer, D3D12_RESOURCE_STATE_COMMON);
-
-            // Set root descriptor table for bindless CBV_SRV_UAV descriptor array
-            commandList->SetRootDescriptorTable(4, bindlessDescriptorHeap.GetGPUBaseDescriptor());
-
-            RenderGeometry(*commandList, s_Data.SceneCamera, static_cast<TransparencyMode>(i));
-
-            commandList->EndTimestampQuery(timestampNames[2 + i]);
-            RenderBackend::ExecuteCommandList(commandList);
+            backend.EndGPUZone();
+            backend.EndGPUZone();
+            backend.ExecuteCommandList();
         }
     }
 
     {
-        auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
+        /* Temporal anti-aliasing pass */
+        backend.BeginCommandList();
 
         if (g_RenderState.Settings.EnableTAA)
-        {
-            /* Temporal anti-aliasing pass */
-            commandList->BeginTimestampQuery("Temporal-AA");
-
-            // Transition sdr history and sdr target into correct states
-            commandList->Transition(*g_RenderState.HDRColorTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-            commandList->Transition(*g_RenderState.DepthPrepassDepthTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-            commandList->Transition(*g_RenderState.VelocityTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-            commandList->Transition(*g_RenderState.VelocityTargetPrevious, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-            commandList->Transition(*g_RenderState.TAAHistory, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-            commandList->Transition(*g_RenderState.TAAResolveTarget, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-
-            commandList->GetGraphicsCommandList()->SetComputeRootSignature(s_Data.ComputePasses[ComputePassType::TEMPORAL_ANTI_ALIASING]->GetD3D12RootSignature().Get());
-            commandList->GetGraphicsCommandList()->SetPipelineState(s_Data.ComputePasses[ComputePassType::TEMPORAL_ANTI_ALIASING]->GetD3D12PipelineState().Get());
-
-            ID3D12DescriptorHeap* const heaps = { RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetD3D12DescriptorHeap().Get() };
-            commandList->GetGraphicsCommandList()->SetDescriptorHeaps(1, &heaps);
-
-            commandList->GetGraphicsCommandList()->SetComputeRootConstantBufferView(0, g_RenderState.GlobalConstantBuffer->GetD3D12Resource()->GetGPUVirtualAddress());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(1, g_RenderState.HDRColorTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(2, g_RenderState.DepthPrepassDepthTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(3, g_RenderState.VelocityTarget->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(4, g_RenderState.VelocityTargetPrevious->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(5, g_RenderState.TAAHistory->GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-            commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(6, g_RenderState.TAAResolveTarget->GetDescriptorAllocation(DescriptorType::UAV).GetGPUDescriptorHandle());
-
-            uint32_t threadX = MathHelper::AlignUp(g_RenderState.Settings.RenderResolution.x, 8) / 8;
-            uint32_t threadY = MathHelper::AlignUp(g_RenderState.Settings.RenderResolution.y, 8) / 8;
-            commandList->GetGraphicsCommandList()->Dispatch(threadX, threadY, 1);
-
-            commandList->EndTimestampQuery("Temporal-AA");
-        }
-        else
-        {
-            commandList->CopyResource(*g_RenderState.TAAResolveTarget, *g_RenderState.HDRColorTarget);
-        }
+            backend.BeginGPUZone(s_Data.GPUZones.TemporalAA);
+
+        backend.ResolveTemporalAA(g_RenderState.Settings.EnableTAA);
+
+        if (g_RenderState.Settings.EnableTAA)
+            backend.EndGPUZone();
 
-        // Update TAA history with the current TAA resolve
-        commandList->CopyResource(*g_RenderState.TAAHistory, *g_RenderState.TAAResolveTarget);
-        RenderBackend::ExecuteCommandList(commandList);
+        backend.ExecuteCommandList();
     }
 
     {
         /* Post-process pass */
-        auto commandList = RenderBackend::GetCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT);
-        commandList->BeginTimestampQuery("Post-process");
-
-        // Transition the HDR render target to pixel shader resource state
-        commandList->Transition(*g_RenderState.TAAResolveTarget, D3D12_RESOURCE_STATE_ALL_SHADER_RESOURCE);
-        commandList->Transition(*g_RenderState.SDRColorTarget, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-
-        commandList->GetGraphicsCommandList()->SetComputeRootSignature(s_Data.ComputePasses[ComputePassType::POST_PROCESS]->GetD3D12RootSignature().Get());
-        commandList->GetGraphicsCommandList()->SetPipelineState(s_Data.ComputePasses[ComputePassType::POST_PROCESS]->GetD3D12PipelineState().Get());
-
-        ID3D12DescriptorHeap* const heaps = { RenderBackend::GetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV).GetD3D12DescriptorHeap().Get() };
-        commandList->GetGraphicsCommandList()->SetDescriptorHeaps(1, &heaps);
+        backend.BeginCommandList();
+        backend.BeginGPUZone(s_Data.GPUZones.PostProcess);
 
-        commandList->GetGraphicsCommandList()->SetComputeRootConstantBufferView(0, g_RenderState.GlobalConstantBuffer->GetD3D12Resource()->GetGPUVirtualAddress());
-        commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(1, GetDebugShowDebugModeTexture(g_RenderState.GlobalCBData.PP_DebugShowTextureMode).GetDescriptorAllocation(DescriptorType::SRV).GetGPUDescriptorHandle());
-        commandList->GetGraphicsCommandList()->SetComputeRootDescriptorTable(2, g_RenderState.SDRColorTarget->GetDescriptorAllocation(DescriptorType::UAV).GetGPUDescriptorHandle());
+        backend.PostProcess(g_RenderState.GlobalCBData.PP_DebugShowTextureMode);
 
-        uint32_t threadX = MathHelper::AlignUp(g_RenderState.Settings.RenderResolution.x, 8) / 8;
-        uint32_t threadY = MathHelper::AlignUp(g_RenderState.Settings.RenderResolution.y, 8) / 8;
-        commandList->GetGraphicsCommandList()->Dispatch(threadX, threadY, 1);
-
-        commandList->EndTimestampQuery("Post-process");
-        RenderBackend::ExecuteCommandList(commandList);
+        backend.EndGPUZone();
+        backend.EndGPUZone();
+        backend.ExecuteCommandList();
     }
 }
 
+#if !defined(DX12R_PORTABLE_CORE)
 void Renderer::OnImGuiRender()
 {
     auto& renderSettings = g_RenderState.Settings;
@@ -834,7 +1605,8 @@ void Renderer::OnImGuiRender()
         ImGui::Indent(10.0f);
 
         ImGui::Text("Render resolution: %ux%u", renderSettings.RenderResolution.x, renderSettings.RenderResolution.y);
-        ImGui::Text("Shadow map resolution: %ux%u", renderSettings.ShadowMapResolution, renderSettings.ShadowMapResolution);
+        ImGui::Text("Cascade resolution: %ux%u", renderSettings.ShadowMapResolution.x, renderSettings.ShadowMapResolution.y);
+        ImGui::Text("Shadow atlas resolution: %ux%u", s_Data.ShadowAtlasTiles.GetSettings().AtlasResolution, s_Data.ShadowAtlasTiles.GetSettings().AtlasResolution);
         ImGui::Text("VSync: %s", renderSettings.EnableVSync ? "On" : "Off");
 
         ImGui::Text("Debug show texture");
@@ -877,6 +1649,64 @@ void Renderer::OnImGuiRender()
 
         ImGui::Separator();
 
+        ImGui::Text("Light culling");
+        std::string previewCullingMode = LightCullingModeToString(renderSettings.LightCulling);
+        if (ImGui::BeginCombo("##LightCulling", previewCullingMode.c_str()))
+        {
+            for (uint32_t i = 0; i < static_cast<uint32_t>(LightCullingMode::LIGHT_CULLING_MODE_NUM_MODES); ++i)
+            {
+                std::string mode = LightCullingModeToString(static_cast<LightCullingMode>(i));
+                bool isSelected = previewCullingMode == mode;
+
+                if (ImGui::Selectable(mode.c_str(), isSelected))
+                    renderSettings.LightCulling = static_cast<LightCullingMode>(i);
+                if (isSelected)
+                    ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::EndCombo();
+        }
+
+        ImGui::Separator();
+
+        ImGui::Checkbox("Mesh LODs", &renderSettings.EnableMeshLODs);
+        ImGui::DragFloat("LOD error threshold (px)", &renderSettings.LODErrorThreshold, 0.1f, 0.0f, 100.0f);
+        ImGui::DragFloat("Shadow LOD error threshold (px)", &renderSettings.ShadowLODErrorThreshold, 0.1f, 0.0f, 100.0f);
+
+        ImGui::Separator();
+
+        int numShadowCascades = static_cast<int>(renderSettings.NumShadowCascades);
+        if (ImGui::SliderInt("Shadow cascades", &numShadowCascades, 1, MAX_SHADOW_CASCADES))
+            renderSettings.NumShadowCascades = static_cast<uint32_t>(numShadowCascades);
+        ImGui::DragFloat("Cascade split lambda", &renderSettings.CascadeSplitLambda, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Shadow distance", &renderSettings.ShadowDistance, 10.0f, 1.0f, 100000.0f);
+        ImGui::Checkbox("Cache static shadow casters", &renderSettings.EnableShadowCache);
+        ImGui::Checkbox("Cull shadow casters outside of the visible receivers", &renderSettings.EnableShadowCasterCulling);
+        ImGui::DragFloat("Shadow atlas resolution scale", &renderSettings.ShadowAtlas.ResolutionScale, 0.01f, 0.01f, 16.0f);
+        ImGui::DragFloat("Shadow atlas size hysteresis", &renderSettings.ShadowAtlas.SizeHysteresis, 0.01f, 0.0f, 1.0f);
+        ImGui::DragFloat("Shadow atlas priority hysteresis", &renderSettings.ShadowAtlas.PriorityHysteresis, 0.01f, 0.0f, 10.0f);
+        ImGui::DragFloat("Shadow atlas max occupancy", &renderSettings.ShadowAtlas.MaxOccupancy, 0.01f, 0.05f, 1.0f);
+
+        int shadowDrawBudget = static_cast<int>(renderSettings.ShadowScheduler.DrawBudget);
+        if (ImGui::DragInt("Shadow update draw budget (0 = unlimited)", &shadowDrawBudget, 1.0f, 0, 1000000))
+            renderSettings.ShadowScheduler.DrawBudget = static_cast<uint32_t>(shadowDrawBudget);
+
+        int shadowTriangleBudget = static_cast<int>(std::min<uint64_t>(renderSettings.ShadowScheduler.TriangleBudget, std::numeric_limits<int>::max()));
+        if (ImGui::DragInt("Shadow update triangle budget (0 = unlimited)", &shadowTriangleBudget, 1000.0f, 0, std::numeric_limits<int>::max()))
+            renderSettings.ShadowScheduler.TriangleBudget = static_cast<uint64_t>(shadowTriangleBudget);
+
+        ImGui::DragFloat("Shadow update motion weight", &renderSettings.ShadowScheduler.MotionWeight, 0.1f, 1.0f, 100.0f);
+        ImGui::DragFloat("Shadow update unchanged weight", &renderSettings.ShadowScheduler.UnchangedWeight, 0.01f, 0.01f, 1.0f);
+        ImGui::DragFloat("Shadow update distance falloff", &renderSettings.ShadowScheduler.DistanceFalloff, 0.001f, 0.0f, 1.0f);
+
+        for (uint32_t i = 0; i < s_Data.DirLight.NumCascades; ++i)
+        {
+            const ShadowCascade& cascade = s_Data.DirLightCascades[i];
+            ImGui::Text("Cascade %u: %.1f - %.1f, radius %.1f, depth range %.1f", i, cascade.SplitNear, cascade.SplitFar, cascade.Sphere.Radius, cascade.Far - cascade.Near);
+        }
+
+        ImGui::Separator();
+
         ImGui::Text("Tonemapping type");
         std::string previewValue = TonemapTypeToString(g_RenderState.GlobalCBData.TM_Type);
         if (ImGui::BeginCombo("##TonemapType", previewValue.c_str()))
@@ -905,20 +1735,108 @@ void Renderer::OnImGuiRender()
         ImGui::Text("Draw calls: %u", renderStats.DrawCallCount);
         ImGui::Text("Triangle count: %u", renderStats.TriangleCount);
         ImGui::Text("Mesh count: %u", renderStats.MeshCount);
+        ImGui::Text("LOD draw calls: %u", renderStats.LODDrawCallCount);
+        ImGui::Text("Shader variant switches: %u", renderStats.PipelineStateSwitchCount);
+        ImGui::Text("Lighting draw calls: %u opaque, %u masked, %u transparent", renderStats.LightingDrawCallCount[TransparencyMode::OPAQUE],
+            renderStats.LightingDrawCallCount[TransparencyMode::MASKED], renderStats.LightingDrawCallCount[TransparencyMode::TRANSPARENT]);
+        ImGui::Text("Depth pre-pass draw calls: %u", renderStats.DepthPrepassDrawCallCount);
+        ImGui::Text("Depth pass vertex data: %.2f MB", renderStats.DepthVertexByteCount / (1024.0f * 1024.0f));
         ImGui::Text("Directional light count: %u", s_Data.SceneData.DirLightCount);
         ImGui::Text("Point light count: %u", s_Data.SceneData.PointLightCount);
         ImGui::Text("Spot light count: %u", s_Data.SceneData.SpotLightCount);
+        ImGui::Text("Instance light assignments: %u", renderStats.InstanceLightAssignmentCount);
+        ImGui::Text("Shadow maps: %u (%u cached)", renderStats.ShadowMapCount, renderStats.ShadowMapCacheHitCount);
+        ImGui::Text("Shadow casters culled: %u", renderStats.ShadowCasterCulledCount);
+
+        const ShadowAtlasStatistics& atlasStats = s_Data.ShadowAtlasTiles.GetStatistics();
+        uint32_t atlasResolution = s_Data.ShadowAtlasTiles.GetSettings().AtlasResolution;
+        float atlasOccupancy = static_cast<float>(atlasStats.NumAllocatedTexels) / (static_cast<float>(atlasResolution) * atlasResolution);
+
+        ImGui::Text("Shadow atlas: %u/%u lights, %u tiles, %.1f%% occupied", atlasStats.NumAllocatedLights, atlasStats.NumLights, atlasStats.NumAllocatedTiles, atlasOccupancy * 100.0f);
+        ImGui::Text("Shadow atlas changes: %u new, %u resized, %u deferred, %u evicted, demand scale %.2f", atlasStats.NumNewLights, atlasStats.NumResizedLights,
+            atlasStats.NumDeferredResizes, atlasStats.NumEvictedLights, atlasStats.DemandScale);
+
+        const ShadowSchedulerStatistics& scheduleStats = s_Data.ShadowUpdateScheduler.GetStatistics();
+        ImGui::Text("Shadow updates: %u/%u views, %u unshadowed, oldest %u frames", scheduleStats.NumUpdatedViews, scheduleStats.NumViews,
+            scheduleStats.NumUnshadowedViews, scheduleStats.MaxFramesSinceUpdate);
+        ImGui::Text("Shadow update cost: %u draws, %llu triangles (estimated)", scheduleStats.NumUpdatedDraws,
+            static_cast<unsigned long long>(scheduleStats.NumUpdatedTriangles));
+
+        const GPUSceneTableStatistics& instanceTableStats = s_Data.InstanceTable.GetStatistics();
+        const GPUSceneTableStatistics& materialTableStats = s_Data.MaterialTable.GetStatistics();
+        ImGui::Text("Instance table: %u entries, %u new, %u changed, %u released", instanceTableStats.NumEntries, instanceTableStats.NumNewEntries,
+            instanceTableStats.NumChangedEntries, instanceTableStats.NumReleasedEntries);
+        ImGui::Text("Material table: %u entries, %u new, %u changed, %u released", materialTableStats.NumEntries, materialTableStats.NumNewEntries,
+            materialTableStats.NumChangedEntries, materialTableStats.NumReleasedEntries);
+        ImGui::Text("Scene table uploads: %.2f KB in %u ranges", (instanceTableStats.NumUploadedBytes + materialTableStats.NumUploadedBytes) / 1024.0f,
+            instanceTableStats.NumUploadRanges + materialTableStats.NumUploadRanges);
+
+        ImGui::Unindent(10.0f);
+    }
+
+    if (ImGui::CollapsingHeader("Light clusters"))
+    {
+        ImGui::Indent(10.0f);
+
+        ImGui::Text("Cluster grid: %ux%ux%u, %u lights per cluster", LIGHT_CLUSTER_GRID_SIZE_X, LIGHT_CLUSTER_GRID_SIZE_Y, LIGHT_CLUSTER_GRID_SIZE_Z, LIGHT_CLUSTER_MAX_LIGHTS);
+
+        if (ImGui::Button("Validate against CPU reference"))
+            s_Data.IsClusterValidationRequested = true;
+
+        if (s_Data.HasClusterValidation)
+        {
+            const LightClusterStatistics& stats = s_Data.ClusterStats;
+
+            ImGui::Text("Mismatching clusters: %u", s_Data.NumClusterMismatches);
+            ImGui::Text("Lights: %u", stats.NumLights);
+            ImGui::Text("Light assignments: %u", stats.NumLightAssignments);
+            ImGui::Text("Occupied clusters: %u/%u", stats.NumOccupiedClusters, LIGHT_CLUSTER_COUNT);
+            ImGui::Text("Max lights in a cluster: %u", stats.MaxLightsInCluster);
+            ImGui::Text("Dropped assignments: %u", stats.NumDroppedAssignments);
+        }
+
+        ImGui::Unindent(10.0f);
+    }
+
+    if (ImGui::CollapsingHeader("Frame capture"))
+    {
+        ImGui::Indent(10.0f);
+
+        static int numCaptureFrames = 300;
+        ImGui::DragInt("Frames", &numCaptureFrames, 1.0f, 1, 100000);
+
+        if (IsCapturing())
+            ImGui::Text("Capturing, %u frames left", s_Data.NumFramesToCapture);
+        else if (ImGui::Button("Capture to Captures/Capture.dxrc"))
+            BeginCapture("Captures/Capture.dxrc", static_cast<uint32_t>(numCaptureFrames));
 
         ImGui::Unindent(10.0f);
     }
 }
+#endif
 
 void Renderer::EndScene()
 {
-    s_Data.OpaqueMeshCount = 0;
-    s_Data.TransparentMeshCount = 0;
-    s_Data.MaterialCount = 0;
+    if (s_Data.IsCapturingFrame)
+    {
+        s_Data.CaptureWriter->WriteFrame(s_Data.CapturedFrame);
+        s_Data.NumFramesToCapture--;
+        s_Data.IsCapturingFrame = false;
+
+        if (s_Data.NumFramesToCapture == 0 || !s_Data.CaptureWriter->IsValid())
+        {
+            LOG_INFO("[FrameCapture] Captured {} frames, {} KB", s_Data.CaptureWriter->GetNumFrames(), TO_KILOBYTE(s_Data.CaptureWriter->GetByteSize()));
+            s_Data.CaptureWriter.reset();
+        }
+    }
+
+    for (std::size_t& meshCount : s_Data.MeshCounts)
+        meshCount = 0;
     s_Data.LightCount = 0;
+    s_Data.SpotLights.clear();
+    s_Data.SpotLightIDs.clear();
+    s_Data.PointLights.clear();
+    s_Data.PointLightIDs.clear();
 
     s_Data.SceneData.Reset();
 }
@@ -927,36 +1845,54 @@ void Renderer::EndFrame()
 {
     SCOPED_TIMER("Renderer::EndFrame");
 
-    RenderBackend::GetSwapChain().ResolveToBackBuffer(*g_RenderState.SDRColorTarget);
-    RenderBackend::EndFrame();
+    s_Data.Backend->EndFrame();
 
     g_RenderState.Stats.Reset();
 }
 
-void Renderer::Submit(RenderResourceHandle meshPrimitiveHandle, const glm::mat4& transform, const glm::mat4& prevFrameTransform)
+void Renderer::Submit(RenderResourceHandle meshPrimitiveHandle, const glm::mat4& transform, const glm::mat4& prevFrameTransform, uint64_t objectID)
 {
-    ASSERT(s_Data.MaterialCount <= g_RenderState.MAX_MATERIALS, "Total number of materials has exceeded the maximum amount of 1000");
-
     Mesh* mesh = g_RenderState.MeshSlotmap.Find(meshPrimitiveHandle);
     Material* material = g_RenderState.MaterialSlotmap.Find(mesh->Material);
 
-    uint32_t albedoTextureIndex = g_RenderState.DefaultWhiteTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
-    Texture* albedoTexture = g_RenderState.TextureSlotmap.Find(material->AlbedoTexture);
+    // Meshes are only drawn once their vertex streams and index data finished uploading
+    RenderBackend& backend = *s_Data.Backend;
+    RenderBuffer* positionBuffer = g_RenderState.BufferSlotmap.Find(mesh->PositionBuffer);
+    RenderBuffer* attributeBuffer = g_RenderState.BufferSlotmap.Find(mesh->AttributeBuffer);
+    RenderBuffer* indexBuffer = g_RenderState.BufferSlotmap.Find(mesh->IndexBuffer);
 
-    if (albedoTexture && albedoTexture->IsValid())
-        albedoTextureIndex = albedoTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
+    if (!backend.IsResourceReady(positionBuffer->Resource) || !backend.IsResourceReady(attributeBuffer->Resource) || !backend.IsResourceReady(indexBuffer->Resource))
+        return;
 
-    uint32_t normalTextureIndex = g_RenderState.DefaultNormalTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
-    Texture* normalTexture = g_RenderState.TextureSlotmap.Find(material->NormalTexture);
+    if (s_Data.IsCapturingFrame)
+        CaptureMeshSubmission(meshPrimitiveHandle, *mesh, transform, prevFrameTransform);
 
-    if (normalTexture && normalTexture->IsValid())
-        normalTextureIndex = normalTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
+    uint32_t albedoTextureIndex = backend.GetTextureIndex(g_RenderState.DefaultWhiteTexture);
+    RenderTexture* albedoTexture = g_RenderState.TextureSlotmap.Find(material->AlbedoTexture);
 
-    uint32_t metallicRoughnessTextureIndex = g_RenderState.DefaultWhiteTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
-    Texture* metallicRoughnessTexture = g_RenderState.TextureSlotmap.Find(material->MetallicRoughnessTexture);
+    if (albedoTexture && backend.IsResourceReady(albedoTexture->Resource))
+        albedoTextureIndex = backend.GetTextureIndex(albedoTexture->Resource);
 
-    if (metallicRoughnessTexture && metallicRoughnessTexture->IsValid())
-        metallicRoughnessTextureIndex = metallicRoughnessTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
+    // Shader variants without a texture capability are only picked while the default texture is bound in its place
+    uint32_t shaderFeatures = SHADER_FEATURE_NONE;
+
+    uint32_t normalTextureIndex = backend.GetTextureIndex(g_RenderState.DefaultNormalTexture);
+    RenderTexture* normalTexture = g_RenderState.TextureSlotmap.Find(material->NormalTexture);
+
+    if (normalTexture && backend.IsResourceReady(normalTexture->Resource))
+    {
+        normalTextureIndex = backend.GetTextureIndex(normalTexture->Resource);
+        shaderFeatures |= SHADER_FEATURE_NORMAL_MAP;
+    }
+
+    uint32_t metallicRoughnessTextureIndex = backend.GetTextureIndex(g_RenderState.DefaultWhiteTexture);
+    RenderTexture* metallicRoughnessTexture = g_RenderState.TextureSlotmap.Find(material->MetallicRoughnessTexture);
+
+    if (metallicRoughnessTexture && backend.IsResourceReady(metallicRoughnessTexture->Resource))
+    {
+        metallicRoughnessTextureIndex = backend.GetTextureIndex(metallicRoughnessTexture->Resource);
+        shaderFeatures |= SHADER_FEATURE_METALLIC_ROUGHNESS_MAP;
+    }
 
     MaterialData materialData = {};
     materialData.AlbedoTextureIndex = albedoTextureIndex;
@@ -964,114 +1900,175 @@ void Renderer::Submit(RenderResourceHandle meshPrimitiveHandle, const glm::mat4&
     materialData.MetallicRoughnessTextureIndex = metallicRoughnessTextureIndex;
     materialData.Metalness = material->MetalnessFactor;
     materialData.Roughness = material->RoughnessFactor;
+    materialData.AlphaCutoff = material->AlphaCutoff;
 
-    g_RenderState.MaterialConstantBuffer->SetBufferDataAtOffset(&materialData, sizeof(MaterialData), s_Data.MaterialCount * sizeof(MaterialData));
+    // Submissions of the same material share its entry in the material table, which is only uploaded again when it changes
+    uint32_t materialSlot = s_Data.MaterialTable.Update(mesh->Material.Handle, &materialData);
+
+    bool isStatic = ShadowCache::IsStaticCaster(transform, prevFrameTransform);
 
     MeshInstanceData meshInstance = {};
     meshInstance.Transform = transform;
     meshInstance.PrevFrameTransform = prevFrameTransform;
-    meshInstance.MaterialID = s_Data.MaterialCount;
-
-    if (material->Transparency == TransparencyMode::OPAQUE)
-    {
-        ASSERT(s_Data.OpaqueMeshCount <= g_RenderState.MAX_MESH_INSTANCES, "Exceeded the maximum amount of mesh instances for opaque meshes");
-
-        g_RenderState.MeshInstanceBufferOpaque->SetBufferDataAtOffset(&meshInstance, sizeof(MeshInstanceData), s_Data.OpaqueMeshCount * sizeof(MeshInstanceData));
-        s_Data.OpaqueMeshSubmissions[s_Data.OpaqueMeshCount].Mesh = mesh;
-        s_Data.OpaqueMeshSubmissions[s_Data.OpaqueMeshCount].InstanceData.Transform = transform;
-        s_Data.OpaqueMeshSubmissions[s_Data.OpaqueMeshCount].InstanceData.MaterialID = s_Data.MaterialCount;
-
-        s_Data.OpaqueMeshCount++;
-    }
-    else
-    {
-        ASSERT(s_Data.TransparentMeshCount <= g_RenderState.MAX_MESH_INSTANCES, "Exceeded the maximum amount of mesh instances for transparent meshes");
-
-        g_RenderState.MeshInstanceBufferTransparent->SetBufferDataAtOffset(&meshInstance, sizeof(MeshInstanceData), s_Data.TransparentMeshCount * sizeof(MeshInstanceData));
-        s_Data.TransparentMeshSubmissions[s_Data.TransparentMeshCount].Mesh = mesh;
-        s_Data.TransparentMeshSubmissions[s_Data.TransparentMeshCount].InstanceData.Transform = transform;
-        s_Data.TransparentMeshSubmissions[s_Data.TransparentMeshCount].InstanceData.MaterialID = s_Data.MaterialCount;
-
-        s_Data.TransparentMeshCount++;
-    }
-
-    s_Data.MaterialCount++;
+    meshInstance.MaterialID = materialSlot;
+    meshInstance.PositionScale = mesh->PositionScale;
+    meshInstance.PositionOffset = mesh->PositionOffset;
+
+    uint64_t sortKey = ShaderPermutation::MakeDrawSortKey(shaderFeatures, materialSlot, meshPrimitiveHandle.Index);
+
+    // The instance data is written to the instance table in Render, once the light lists are known
+    TransparencyMode transparency = material->Transparency;
+    std::size_t& meshCount = s_Data.MeshCounts[transparency];
+    ASSERT(meshCount < g_RenderState.MAX_MESH_INSTANCES, "Exceeded the maximum amount of mesh instances for a transparency mode");
+
+    MeshSubmission& submission = s_Data.MeshSubmissions[transparency][meshCount];
+    submission.Mesh = mesh;
+    submission.MeshHandle = meshPrimitiveHandle;
+    submission.IsStatic = isStatic;
+    submission.InstanceData = meshInstance;
+    submission.ObjectID = objectID;
+    submission.SortKey = sortKey;
+
+    meshCount++;
 }
 
-void Renderer::Submit(DirectionalLightData& dirLightData, const Camera& lightCamera, RenderResourceHandle shadowMapHandle)
+void Renderer::Submit(DirectionalLightData& dirLightData, uint64_t lightID)
 {
     ASSERT(s_Data.SceneData.DirLightCount <= g_RenderState.MAX_DIR_LIGHTS, "Exceeded the maximum amount of directional lights");
 
-    Texture* shadowMapTexture = g_RenderState.TextureSlotmap.Find(shadowMapHandle);
-    if (shadowMapTexture)
-        dirLightData.ShadowMapIndex = shadowMapTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
+    // The light data is uploaded in Render, together with the cascades
+    s_Data.DirLight = dirLightData;
+    s_Data.DirLightID = MakeShadowLightID(lightID, SHADOW_LIGHT_TYPE_DIRECTIONAL);
 
-    g_RenderState.LightConstantBuffer->SetBufferDataAtOffset(&dirLightData, sizeof(DirectionalLightData), 0);
-    s_Data.LightSubmissions[s_Data.LightCount].ShadowMap = shadowMapTexture;
-    s_Data.LightSubmissions[s_Data.LightCount].Face = 0;
-    s_Data.LightSubmissions[s_Data.LightCount].LightCamera = lightCamera;
+    if (s_Data.IsCapturingFrame)
+    {
+        // Shadow views are added once the cascades are known
+        s_Data.CapturedDirLightIndex = s_Data.CapturedFrame.Lights.size();
+
+        CapturedLight& capturedLight = s_Data.CapturedFrame.Lights.emplace_back();
+        capturedLight.Type = CapturedLightType::CAPTURED_LIGHT_TYPE_DIRECTIONAL;
+        capturedLight.Direction = dirLightData.Direction;
+        capturedLight.Color = dirLightData.Color;
+    }
 
     s_Data.SceneData.DirLightCount++;
-    s_Data.LightCount++;
 }
 
-void Renderer::Submit(SpotLightData& spotLightData, const Camera& lightCamera, RenderResourceHandle shadowMapHandle)
+void Renderer::Submit(SpotLightData& spotLightData, const Camera& lightCamera, uint64_t lightID)
 {
     ASSERT(s_Data.SceneData.SpotLightCount <= g_RenderState.MAX_SPOT_LIGHTS, "Exceeded the maximum amount of spotlights");
 
-    Texture* shadowMapTexture = g_RenderState.TextureSlotmap.Find(shadowMapHandle);
-    if (shadowMapTexture)
-        spotLightData.ShadowMapIndex = shadowMapTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
-
-    g_RenderState.LightConstantBuffer->SetBufferDataAtOffset(&spotLightData, sizeof(SpotLightData),
-        sizeof(DirectionalLightData) + s_Data.SceneData.SpotLightCount * sizeof(SpotLightData));
-    s_Data.LightSubmissions[s_Data.LightCount].ShadowMap = shadowMapTexture;
-    s_Data.LightSubmissions[s_Data.LightCount].Face = 0;
+    // The light data is uploaded in Render, once the light has its shadow atlas tile
+    uint64_t shadowLightID = MakeShadowLightID(lightID, SHADOW_LIGHT_TYPE_SPOT);
+    s_Data.LightSubmissions[s_Data.LightCount].LightID = shadowLightID;
+    s_Data.LightSubmissions[s_Data.LightCount].Tile = 0;
     s_Data.LightSubmissions[s_Data.LightCount].LightCamera = lightCamera;
+    s_Data.LightSubmissions[s_Data.LightCount].LightType = SHADOW_LIGHT_TYPE_SPOT;
+    s_Data.LightSubmissions[s_Data.LightCount].LightIndex = s_Data.SpotLights.size();
+
+    if (s_Data.IsCapturingFrame)
+    {
+        CapturedLight& capturedLight = s_Data.CapturedFrame.Lights.emplace_back();
+        capturedLight.Type = CapturedLightType::CAPTURED_LIGHT_TYPE_SPOT;
+        capturedLight.Position = spotLightData.Position;
+        capturedLight.Direction = spotLightData.Direction;
+        capturedLight.Color = spotLightData.Color;
+        capturedLight.Attenuation = spotLightData.Attenuation;
+        capturedLight.Range = spotLightData.Range;
+        capturedLight.InnerConeAngle = spotLightData.InnerConeAngle;
+        capturedLight.OuterConeAngle = spotLightData.OuterConeAngle;
+        capturedLight.ShadowViews.push_back(MakeCapturedView(lightCamera));
+    }
+
+    s_Data.SpotLights.push_back(spotLightData);
+    s_Data.SpotLightIDs.push_back(shadowLightID);
 
     s_Data.SceneData.SpotLightCount++;
     s_Data.LightCount++;
 }
 
-void Renderer::Submit(PointLightData& pointLightData, const std::array<Camera, 6>& lightCameras, RenderResourceHandle shadowMapHandle)
+void Renderer::Submit(PointLightData& pointLightData, const std::array<Camera, 6>& lightCameras, uint64_t lightID)
 {
     ASSERT(s_Data.SceneData.PointLightCount <= g_RenderState.MAX_POINT_LIGHTS, "Exceeded the maximum amount of pointlights");
 
-    Texture* shadowMapTexture = g_RenderState.TextureSlotmap.Find(shadowMapHandle);
-    if (shadowMapTexture)
-        pointLightData.ShadowMapIndex = shadowMapTexture->GetDescriptorHeapIndex(DescriptorType::SRV);
-
-    g_RenderState.LightConstantBuffer->SetBufferDataAtOffset(&pointLightData, sizeof(PointLightData),
-        sizeof(DirectionalLightData) + g_RenderState.MAX_SPOT_LIGHTS * sizeof(SpotLightData) + s_Data.SceneData.PointLightCount * sizeof(PointLightData));
+    // The light data is uploaded in Render, once the faces have their shadow atlas tiles
+    uint64_t shadowLightID = MakeShadowLightID(lightID, SHADOW_LIGHT_TYPE_POINT);
 
-    for (std::size_t i = 0; i < 6; ++i)
+    for (uint32_t i = 0; i < 6; ++i)
     {
-        s_Data.LightSubmissions[s_Data.LightCount + i].ShadowMap = shadowMapTexture;
-        s_Data.LightSubmissions[s_Data.LightCount + i].Face = i + 1;
+        pointLightData.FaceViewProjections[i] = lightCameras[i].GetViewProjection();
+
+        s_Data.LightSubmissions[s_Data.LightCount + i].LightID = shadowLightID;
+        s_Data.LightSubmissions[s_Data.LightCount + i].Tile = i;
         s_Data.LightSubmissions[s_Data.LightCount + i].LightCamera = lightCameras[i];
+        s_Data.LightSubmissions[s_Data.LightCount + i].LightType = SHADOW_LIGHT_TYPE_POINT;
+        s_Data.LightSubmissions[s_Data.LightCount + i].LightIndex = s_Data.PointLights.size();
+    }
+
+    if (s_Data.IsCapturingFrame)
+    {
+        CapturedLight& capturedLight = s_Data.CapturedFrame.Lights.emplace_back();
+        capturedLight.Type = CapturedLightType::CAPTURED_LIGHT_TYPE_POINT;
+        capturedLight.Position = pointLightData.Position;
+        capturedLight.Color = pointLightData.Color;
+        capturedLight.Attenuation = pointLightData.Attenuation;
+        capturedLight.Range = pointLightData.Range;
+
+        for (const Camera& lightCamera : lightCameras)
+            capturedLight.ShadowViews.push_back(MakeCapturedView(lightCamera));
     }
 
+    s_Data.PointLights.push_back(pointLightData);
+    s_Data.PointLightIDs.push_back(shadowLightID);
+
     s_Data.SceneData.PointLightCount++;
     s_Data.LightCount += 6;
 }
 
 RenderResourceHandle Renderer::CreateBuffer(const BufferDesc& desc)
 {
-    return g_RenderState.BufferSlotmap.Insert(desc);
+    // The data is uploaded by the backend, the desc does not keep pointing at it
+    RenderBuffer buffer;
+    buffer.Desc = desc;
+    buffer.Desc.DataPtr = nullptr;
+    buffer.Resource = s_Data.Backend->CreateBuffer(desc);
+
+    return g_RenderState.BufferSlotmap.Insert(buffer);
 }
 
 RenderResourceHandle Renderer::CreateTexture(const TextureDesc& desc)
 {
-    return g_RenderState.TextureSlotmap.Insert(desc);
+    RenderTexture texture;
+    texture.Desc = desc;
+    texture.Desc.DataPtr = nullptr;
+    texture.Resource = s_Data.Backend->CreateTexture(desc);
+
+    return g_RenderState.TextureSlotmap.Insert(texture);
 }
 
 RenderResourceHandle Renderer::CreateMesh(const MeshDesc& desc)
 {
+    // The position format is part of the input layout of the passes, so every mesh has to use the one of the renderer
+    ASSERT(desc.PositionFormat == GetMeshPositionFormat(), "Mesh position format does not match the position format of the renderer");
+
     Mesh mesh = {};
-    mesh.VertexBuffer = CreateBuffer(desc.VertexBufferDesc);
-    mesh.IndexBuffer = CreateBuffer(desc.IndexBufferDesc);
+    mesh.PositionBuffer = RENDER_RESOURCE_HANDLE_VALID(desc.PositionBuffer) ? desc.PositionBuffer : CreateBuffer(desc.PositionBufferDesc);
+    mesh.AttributeBuffer = RENDER_RESOURCE_HANDLE_VALID(desc.AttributeBuffer) ? desc.AttributeBuffer : CreateBuffer(desc.AttributeBufferDesc);
+    mesh.IndexBuffer = RENDER_RESOURCE_HANDLE_VALID(desc.IndexBuffer) ? desc.IndexBuffer : CreateBuffer(desc.IndexBufferDesc);
+    mesh.PositionScale = desc.PositionScale;
+    mesh.PositionOffset = desc.PositionOffset;
     mesh.Material = desc.MaterialHandle;
     mesh.BB = desc.BB;
+
+    for (const MeshLODDesc& lodDesc : desc.LODs)
+    {
+        MeshLOD lod = {};
+        lod.IndexBuffer = RENDER_RESOURCE_HANDLE_VALID(lodDesc.IndexBuffer) ? lodDesc.IndexBuffer : CreateBuffer(lodDesc.IndexBufferDesc);
+        lod.Error = lodDesc.Error;
+
+        mesh.LODs.push_back(lod);
+    }
+
     mesh.DebugName = desc.DebugName;
 
     return g_RenderState.MeshSlotmap.Insert(mesh);
@@ -1079,17 +2076,48 @@ RenderResourceHandle Renderer::CreateMesh(const MeshDesc& desc)
 
 RenderResourceHandle Renderer::CreateMaterial(const MaterialDesc& desc)
 {
+    // Material textures without data would never be written to, Submit falls back to the default textures for null handles
+    auto getOrCreateTexture = [](RenderResourceHandle handle, const TextureDesc& textureDesc) {
+        if (RENDER_RESOURCE_HANDLE_VALID(handle))
+            return handle;
+
+        return textureDesc.DataPtr ? CreateTexture(textureDesc) : RENDER_RESOURCE_HANDLE_NULL;
+    };
+
     Material material = {};
-    material.AlbedoTexture = CreateTexture(desc.AlbedoDesc);
-    material.NormalTexture = CreateTexture(desc.NormalDesc);
-    material.MetallicRoughnessTexture = CreateTexture(desc.MetallicRoughnessDesc);
+    material.AlbedoTexture = getOrCreateTexture(desc.AlbedoTexture, desc.AlbedoDesc);
+    material.NormalTexture = getOrCreateTexture(desc.NormalTexture, desc.NormalDesc);
+    material.MetallicRoughnessTexture = getOrCreateTexture(desc.MetallicRoughnessTexture, desc.MetallicRoughnessDesc);
     material.MetalnessFactor = desc.Metalness;
     material.RoughnessFactor = desc.Roughness;
     material.Transparency = desc.Transparency;
+    material.AlphaCutoff = desc.AlphaCutoff;
 
     return g_RenderState.MaterialSlotmap.Insert(material);
 }
 
+void Renderer::DestroyBuffer(RenderResourceHandle handle)
+{
+    if (g_RenderState.BufferSlotmap.Find(handle))
+        s_Data.DestroyedBuffers.emplace_back(handle, s_Data.FrameIndex);
+}
+
+void Renderer::DestroyTexture(RenderResourceHandle handle)
+{
+    if (g_RenderState.TextureSlotmap.Find(handle))
+        s_Data.DestroyedTextures.emplace_back(handle, s_Data.FrameIndex);
+}
+
+void Renderer::DestroyMesh(RenderResourceHandle handle)
+{
+    g_RenderState.MeshSlotmap.Erase(handle);
+}
+
+void Renderer::DestroyMaterial(RenderResourceHandle handle)
+{
+    g_RenderState.MaterialSlotmap.Erase(handle);
+}
+
 void Renderer::Resize(uint32_t width, uint32_t height)
 {
     if (g_RenderState.Settings.RenderResolution.x != width || g_RenderState.Settings.RenderResolution.y != height)
@@ -1097,15 +2125,14 @@ void Renderer::Resize(uint32_t width, uint32_t height)
         g_RenderState.Settings.RenderResolution.x = std::max(1u, width);
         g_RenderState.Settings.RenderResolution.y = std::max(1u, height);
 
-        RenderBackend::Resize(g_RenderState.Settings.RenderResolution.x, g_RenderState.Settings.RenderResolution.y);
-        ResizeResolutionDependentResources(g_RenderState.Settings.RenderResolution.x, g_RenderState.Settings.RenderResolution.y);
+        s_Data.Backend->Resize(g_RenderState.Settings.RenderResolution.x, g_RenderState.Settings.RenderResolution.y);
     }
 }
 
 void Renderer::ToggleVSync()
 {
     g_RenderState.Settings.EnableVSync = !g_RenderState.Settings.EnableVSync;
-    RenderBackend::SetVSync(g_RenderState.Settings.EnableVSync);
+    s_Data.Backend->SetVSync(g_RenderState.Settings.EnableVSync);
 }
 
 bool Renderer::IsVSyncEnabled()
@@ -1113,12 +2140,43 @@ bool Renderer::IsVSyncEnabled()
     return g_RenderState.Settings.EnableVSync;
 }
 
+RenderBackend& Renderer::GetBackend()
+{
+    return *s_Data.Backend;
+}
+
 const Resolution& Renderer::GetRenderResolution()
 {
     return g_RenderState.Settings.RenderResolution;
 }
 
-const Resolution& Renderer::GetShadowResolution()
+VertexPositionFormat Renderer::GetMeshPositionFormat()
+{
+    return g_RenderState.Settings.QuantizeMeshPositions ? VertexPositionFormat::VERTEX_POSITION_FORMAT_UNORM16 : VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3;
+}
+
+void Renderer::BeginCapture(const std::string& filepath, uint32_t numFrames)
+{
+    ASSERT(!IsCapturing(), "A frame capture is already in progress");
+
+    std::filesystem::path captureDirectory = std::filesystem::path(filepath).parent_path();
+    std::error_code error;
+    if (!captureDirectory.empty())
+        std::filesystem::create_directories(captureDirectory, error);
+
+    s_Data.CaptureWriter = std::make_unique<FrameCaptureWriter>(filepath);
+    s_Data.NumFramesToCapture = numFrames;
+
+    if (!s_Data.CaptureWriter->IsValid() || numFrames == 0)
+    {
+        s_Data.CaptureWriter.reset();
+        return;
+    }
+
+    LOG_INFO("[FrameCapture] Capturing {} frames to {}", numFrames, filepath);
+}
+
+bool Renderer::IsCapturing()
 {
-    return g_RenderState.Settings.ShadowMapResolution;
+    return s_Data.CaptureWriter != nullptr;
 }
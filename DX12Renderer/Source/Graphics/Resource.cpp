@@ -1,5 +1,6 @@
 #include "Pch.h"
 #include "Graphics/Resource.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 Resource::Resource(const std::string& name)
 {
@@ -7,6 +8,12 @@ Resource::Resource(const std::string& name)
 
 Resource::~Resource()
 {
+	MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
+}
+
+bool Resource::IsReady() const
+{
+	return D3D12Backend::IsUploadComplete(m_UploadTicket);
 }
 
 const DescriptorAllocation& Resource::GetDescriptorAllocation(DescriptorType type) const
@@ -30,6 +37,16 @@ void Resource::SetName(const std::string& name)
 	m_d3d12Resource->SetName(StringHelper::StringToWString(name).c_str());
 }
 
+void Resource::TrackGPUMemory(const std::string& name, GPUMemoryCategory category)
+{
+	MemoryTracker::RemoveGPUResource(m_MemoryTrackerID);
+
+	// The allocation size includes the alignment and padding of textures, unlike m_ByteSize
+	D3D12_RESOURCE_DESC d3d12ResourceDesc = m_d3d12Resource->GetDesc();
+	D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = D3D12Backend::GetD3D12Device()->GetResourceAllocationInfo(0, 1, &d3d12ResourceDesc);
+	m_MemoryTrackerID = MemoryTracker::AddGPUResource(name, category, allocationInfo.SizeInBytes);
+}
+
 void Resource::ResetDescriptorAllocations()
 {
 	for (uint32_t i = 0; i < DescriptorType::NUM_DESCRIPTOR_TYPES; ++i)
@@ -1,76 +1,178 @@
 #include "Pch.h"
 #include "Graphics/Shader.h"
-#include "Resource/FileLoader.h"
 
-Shader::Shader(const std::wstring& filepath, const std::string& entryPoint, const std::string& target)
-{
-    Compile(filepath, entryPoint, target);
-}
+#include <filesystem>
 
-Shader::~Shader()
-{
-}
+/*
+
+    Serves the includes of a compilation from the sources the shader cache hashed.
+    Lives on the stack for the duration of a single compilation, so it is not reference counted.
 
-void Shader::Compile(const std::wstring& filepath, const std::string& entryPoint, const std::string& target)
+*/
+class DXCIncludeHandler : public IDxcIncludeHandler
 {
-    std::vector<LPCWSTR> args;
-    //args.emplace_back(DXC_ARG_SKIP_VALIDATION);
+public:
+    DXCIncludeHandler(IDxcUtils* utils, const ShaderSources& sources)
+        : m_Utils(utils), m_Sources(sources)
+    {
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE LoadSource(LPCWSTR pFilename, IDxcBlob** ppIncludeSource) override
+    {
+        *ppIncludeSource = nullptr;
+
+        // DXC passes the include joined with the directory of the including file, e.g. ./Resources/Shaders/Common.hlsl
+        std::string filepath = std::filesystem::path(pFilename).lexically_normal().generic_string();
 
-#ifdef _DEBUG
-    args.emplace_back(DXC_ARG_DEBUG);
-    args.emplace_back(DXC_ARG_SKIP_OPTIMIZATIONS);
-#endif
+        for (const ShaderSourceFile& source : m_Sources)
+        {
+            if (source.Exists && source.Filepath == filepath)
+            {
+                ComPtr<IDxcBlobEncoding> sourceBlob;
+                HRESULT hr = m_Utils->CreateBlob(source.Code.data(), static_cast<uint32_t>(source.Code.size()), CP_UTF8, &sourceBlob);
+                *ppIncludeSource = sourceBlob.Detach();
 
-    ComPtr<IDxcLibrary> library;
-    DX_CALL(DxcCreateInstance(CLSID_DxcLibrary, IID_PPV_ARGS(&library)));
+                return hr;
+            }
+        }
 
-    ComPtr<IDxcCompiler> compiler;
+        return E_FAIL;
+    }
+
+    virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if (riid == __uuidof(IDxcIncludeHandler) || riid == __uuidof(IUnknown))
+        {
+            *ppvObject = this;
+            return S_OK;
+        }
+
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    virtual ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+    virtual ULONG STDMETHODCALLTYPE Release() override { return 1; }
+
+private:
+    IDxcUtils* m_Utils;
+    const ShaderSources& m_Sources;
+
+};
+
+DXCShaderCompiler::DXCShaderCompiler()
+{
+    ComPtr<IDxcCompiler3> compiler;
     DX_CALL(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler)));
 
-    uint32_t codePage = CP_UTF8;
-    ComPtr<IDxcBlobEncoding> sourceBlob;
-    DX_CALL(library->CreateBlobFromFile(filepath.c_str(), &codePage, &sourceBlob));
+    uint32_t version[2] = {};
+    ComPtr<IDxcVersionInfo> versionInfo;
+    if (SUCCEEDED(compiler.As(&versionInfo)))
+        versionInfo->GetVersion(&version[0], &version[1]);
+
+    m_VersionHash = Hash::Value(version);
+
+    // Builds of the same version can still produce different code, the commit tells them apart
+    ComPtr<IDxcVersionInfo2> versionInfo2;
+    uint32_t commitCount = 0;
+    char* commitHash = nullptr;
+
+    if (SUCCEEDED(compiler.As(&versionInfo2)) && SUCCEEDED(versionInfo2->GetCommitInfo(&commitCount, &commitHash)) && commitHash)
+    {
+        m_VersionHash = Hash::Combine(m_VersionHash, Hash::Bytes(commitHash, std::strlen(commitHash)));
+        CoTaskMemFree(commitHash);
+    }
+}
 
+bool DXCShaderCompiler::Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages)
+{
     ComPtr<IDxcUtils> utils;
     DX_CALL(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils)));
 
-    ComPtr<IDxcIncludeHandler> defaultIncludeHandler;
-    DX_CALL(utils->CreateDefaultIncludeHandler(&defaultIncludeHandler));
+    ComPtr<IDxcCompiler3> compiler;
+    DX_CALL(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler)));
 
-    ComPtr<IDxcOperationResult> result;
+    std::wstring filepath = StringHelper::StringToWString(desc.Filepath);
+    std::wstring entryPoint = StringHelper::StringToWString(desc.EntryPoint);
+    std::wstring target = StringHelper::StringToWString(desc.Target);
 
-    HRESULT hr = compiler->Compile(
-        sourceBlob.Get(),
-        filepath.c_str(),
-        StringHelper::StringToWString(entryPoint).c_str(),
-        StringHelper::StringToWString(target).c_str(),
-        args.data(), static_cast<uint32_t>(args.size()),
-        NULL, 0,
-        defaultIncludeHandler.Get(),
-        &result
-    );
+    std::vector<LPCWSTR> args = { filepath.c_str(), L"-E", entryPoint.c_str(), L"-T", target.c_str(), L"-Qstrip_reflect" };
+    //args.emplace_back(DXC_ARG_SKIP_VALIDATION);
 
-    if (!SUCCEEDED(hr))
+    if (desc.Flags & SHADER_COMPILE_FLAG_DEBUG)
     {
-        if (result)
-        {
-            ComPtr<IDxcBlobEncoding> errorBlob;
-            hr = result->GetErrorBuffer(&errorBlob);
+        args.emplace_back(DXC_ARG_DEBUG);
+        args.emplace_back(L"-Qembed_debug");
+    }
 
-            if (SUCCEEDED(hr) && errorBlob)
-            {
-                LOG_ERR(static_cast<const char*>(errorBlob->GetBufferPointer()));
-                errorBlob->Release();
-            }
-        }
+    if (desc.Flags & SHADER_COMPILE_FLAG_SKIP_OPTIMIZATIONS)
+        args.emplace_back(DXC_ARG_SKIP_OPTIMIZATIONS);
+
+    // The wide strings have to outlive the argument list
+    std::vector<std::wstring> defines;
+    defines.reserve(desc.Defines.size());
+    for (const std::string& define : desc.Defines)
+    {
+        defines.push_back(StringHelper::StringToWString(define));
+        args.emplace_back(L"-D");
+        args.emplace_back(defines.back().c_str());
     }
-    else
+
+    DxcBuffer sourceBuffer = {};
+    sourceBuffer.Ptr = sources[0].Code.data();
+    sourceBuffer.Size = sources[0].Code.size();
+    sourceBuffer.Encoding = DXC_CP_UTF8;
+
+    DXCIncludeHandler includeHandler(utils.Get(), sources);
+    ComPtr<IDxcResult> result;
+
+    HRESULT hr = compiler->Compile(&sourceBuffer, args.data(), static_cast<uint32_t>(args.size()), &includeHandler, IID_PPV_ARGS(&result));
+    if (FAILED(hr) || !result)
     {
-        result->GetStatus(&hr);
+        outMessages = "DXC could not be invoked";
+        return false;
     }
 
-    result->GetResult(&m_ShaderByteBlob);
+    ComPtr<IDxcBlobUtf8> errorBlob;
+    if (SUCCEEDED(result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errorBlob), nullptr)) && errorBlob && errorBlob->GetStringLength() > 0)
+        outMessages.assign(errorBlob->GetStringPointer(), errorBlob->GetStringLength());
 
-    m_ShaderByteCode.pShaderBytecode = m_ShaderByteBlob->GetBufferPointer();
-    m_ShaderByteCode.BytecodeLength = m_ShaderByteBlob->GetBufferSize();
+    HRESULT status = S_OK;
+    result->GetStatus(&status);
+
+    ComPtr<IDxcBlob> bytecodeBlob;
+    if (FAILED(status) || FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&bytecodeBlob), nullptr)) || !bytecodeBlob)
+        return false;
+
+    const uint8_t* bytecode = static_cast<const uint8_t*>(bytecodeBlob->GetBufferPointer());
+    outBinary.Bytecode.assign(bytecode, bytecode + bytecodeBlob->GetBufferSize());
+
+    ComPtr<IDxcBlob> reflectionBlob;
+    if (SUCCEEDED(result->GetOutput(DXC_OUT_REFLECTION, IID_PPV_ARGS(&reflectionBlob), nullptr)) && reflectionBlob)
+    {
+        const uint8_t* reflection = static_cast<const uint8_t*>(reflectionBlob->GetBufferPointer());
+        outBinary.Reflection.assign(reflection, reflection + reflectionBlob->GetBufferSize());
+    }
+
+    return true;
+}
+
+Shader::Shader(const std::string& filepath, const std::string& entryPoint, const std::string& target, const std::vector<std::string>& defines)
+{
+    ShaderCompileDesc desc;
+    desc.Filepath = filepath;
+    desc.EntryPoint = entryPoint;
+    desc.Target = target;
+    desc.Defines = defines;
+
+    // Shaders that were compiled up front by ShaderCache::CompileDirectory are taken from memory
+    m_Binary = ShaderCache::GetShader(desc);
+    ASSERT(m_Binary, "Failed to compile shader: " + filepath);
+
+    m_ShaderByteCode.pShaderBytecode = m_Binary->Bytecode.data();
+    m_ShaderByteCode.BytecodeLength = m_Binary->Bytecode.size();
+}
+
+Shader::~Shader()
+{
 }
@@ -0,0 +1,480 @@
+#include "Pch.h"
+#include "Graphics/ShaderCache.h"
+#include "Util/JobSystem.h"
+
+#include <fstream>
+#include <numeric>
+#include <filesystem>
+
+static constexpr uint32_t SHADER_CACHE_MAGIC = 0x52444853;
+static constexpr uint32_t SHADER_CACHE_VERSION = 1;
+
+struct ShaderCacheHeader
+{
+	uint32_t Magic = SHADER_CACHE_MAGIC;
+	uint32_t Version = SHADER_CACHE_VERSION;
+	Hash128 Key;
+	uint64_t BytecodeByteSize = 0;
+	uint64_t ReflectionByteSize = 0;
+};
+
+struct InternalShaderCacheData
+{
+	std::unique_ptr<ShaderCompiler> Compiler;
+	Hash128 CompilerVersionHash;
+	ShaderCacheDesc Desc;
+
+	// Guards the binaries and the statistics
+	std::mutex Mutex;
+	std::unordered_map<Hash128, std::shared_ptr<const ShaderBinary>, Hash128Hasher> Binaries;
+	ShaderCacheStatistics Stats;
+};
+
+static InternalShaderCacheData s_Data;
+
+static std::string NormalizePath(const std::filesystem::path& path)
+{
+	return path.lexically_normal().generic_string();
+}
+
+static bool ReadFile(const std::string& filepath, std::string& outCode)
+{
+	std::ifstream file(filepath, std::ios::binary);
+	if (!file)
+		return false;
+
+	outCode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static Hash128 HashString(const std::string& string)
+{
+	return Hash::Bytes(string.data(), string.size());
+}
+
+// Comments are skipped, includes in inactive preprocessor branches are found as well, which only costs an unnecessary recompile
+static void FindIncludes(const std::string& code, std::vector<std::string>& outIncludes)
+{
+	std::string strippedCode;
+	strippedCode.reserve(code.size());
+
+	for (std::size_t i = 0; i < code.size(); ++i)
+	{
+		if (code[i] == '/' && i + 1 < code.size() && code[i + 1] == '/')
+		{
+			while (i < code.size() && code[i] != '\n')
+				++i;
+		}
+		else if (code[i] == '/' && i + 1 < code.size() && code[i + 1] == '*')
+		{
+			// Newlines are kept, so a directive after the comment still starts a line
+			for (i += 2; i + 1 < code.size() && !(code[i] == '*' && code[i + 1] == '/'); ++i)
+			{
+				if (code[i] == '\n')
+					strippedCode += '\n';
+			}
+			++i;
+			continue;
+		}
+
+		if (i < code.size())
+			strippedCode += code[i];
+	}
+
+	std::size_t lineStart = 0;
+	while (lineStart < strippedCode.size())
+	{
+		std::size_t lineEnd = strippedCode.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = strippedCode.size();
+
+		std::size_t pos = strippedCode.find_first_not_of(" \t", lineStart);
+		if (pos < lineEnd && strippedCode[pos] == '#')
+		{
+			pos = strippedCode.find_first_not_of(" \t", pos + 1);
+			if (pos < lineEnd && strippedCode.compare(pos, 7, "include") == 0)
+			{
+				pos = strippedCode.find_first_not_of(" \t", pos + 7);
+				if (pos < lineEnd && (strippedCode[pos] == '"' || strippedCode[pos] == '<'))
+				{
+					char delimiter = strippedCode[pos] == '"' ? '"' : '>';
+					std::size_t nameEnd = strippedCode.find(delimiter, pos + 1);
+
+					if (nameEnd < lineEnd)
+						outIncludes.push_back(strippedCode.substr(pos + 1, nameEnd - pos - 1));
+				}
+			}
+		}
+
+		lineStart = lineEnd + 1;
+	}
+}
+
+static ShaderSourceFile ResolveInclude(const std::filesystem::path& directory, const std::string& include)
+{
+	ShaderSourceFile includeFile;
+	includeFile.Filepath = NormalizePath(directory / include);
+	includeFile.Exists = ReadFile(includeFile.Filepath, includeFile.Code);
+
+	return includeFile;
+}
+
+static std::filesystem::path GetCacheFilepath(const Hash128& key)
+{
+	char filename[48];
+	snprintf(filename, sizeof(filename), "%016llx%016llx.shader", (unsigned long long)key.High, (unsigned long long)key.Low);
+
+	return std::filesystem::path(s_Data.Desc.Directory) / filename;
+}
+
+static bool ReadFromDisk(const Hash128& key, ShaderBinary& outBinary)
+{
+	std::ifstream file(GetCacheFilepath(key), std::ios::binary);
+	if (!file)
+		return false;
+
+	ShaderCacheHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(ShaderCacheHeader));
+
+	if (!file || header.Magic != SHADER_CACHE_MAGIC || header.Version != SHADER_CACHE_VERSION || header.Key != key || header.BytecodeByteSize == 0)
+		return false;
+
+	outBinary.Bytecode.resize(header.BytecodeByteSize);
+	outBinary.Reflection.resize(header.ReflectionByteSize);
+	file.read(reinterpret_cast<char*>(outBinary.Bytecode.data()), outBinary.Bytecode.size());
+	file.read(reinterpret_cast<char*>(outBinary.Reflection.data()), outBinary.Reflection.size());
+
+	return static_cast<bool>(file);
+}
+
+static void WriteToDisk(const Hash128& key, const ShaderBinary& binary)
+{
+	ShaderCacheHeader header;
+	header.Key = key;
+	header.BytecodeByteSize = binary.Bytecode.size();
+	header.ReflectionByteSize = binary.Reflection.size();
+
+	// Written next to the final file and renamed once complete, so another process never reads a partially written binary
+	std::filesystem::path filepath = GetCacheFilepath(key);
+	std::filesystem::path tempFilepath = filepath;
+	tempFilepath += ".tmp";
+
+	{
+		std::ofstream file(tempFilepath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(ShaderCacheHeader));
+		file.write(reinterpret_cast<const char*>(binary.Bytecode.data()), binary.Bytecode.size());
+		file.write(reinterpret_cast<const char*>(binary.Reflection.data()), binary.Reflection.size());
+
+		if (!file)
+		{
+			LOG_WARN("[ShaderCache] Could not write shader cache file: {}", tempFilepath.string());
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilepath, filepath, error);
+
+	if (error)
+	{
+		LOG_WARN("[ShaderCache] Could not write shader cache file: {}", filepath.string());
+		std::filesystem::remove(tempFilepath, error);
+	}
+}
+
+static std::shared_ptr<const ShaderBinary> LoadOrCompile(const ShaderCompileDesc& desc, const ShaderSources& sources, const Hash128& key)
+{
+	SCOPED_TIMER("ShaderCache::LoadOrCompile");
+
+	auto binary = std::make_shared<ShaderBinary>();
+	if (ReadFromDisk(key, *binary))
+	{
+		std::scoped_lock lock(s_Data.Mutex);
+		s_Data.Stats.NumDiskHits++;
+		return binary;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::string messages;
+	bool compiled = s_Data.Compiler->Compile(desc, sources, *binary, messages);
+	float compileTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	{
+		std::scoped_lock lock(s_Data.Mutex);
+		s_Data.Stats.CompileTime += compileTime;
+
+		if (compiled)
+			s_Data.Stats.NumCompiled++;
+		else
+			s_Data.Stats.NumFailed++;
+	}
+
+	if (!compiled)
+	{
+		LOG_ERR("[ShaderCache] Failed to compile {} ({}, {}):\n{}", desc.Filepath, desc.EntryPoint, desc.Target, messages);
+		return nullptr;
+	}
+
+	if (!messages.empty())
+		LOG_WARN("[ShaderCache] Compiled {} ({}, {}) with warnings:\n{}", desc.Filepath, desc.EntryPoint, desc.Target, messages);
+
+	WriteToDisk(key, *binary);
+	return binary;
+}
+
+// A single shader gains nothing from the job system, running it inline also keeps JobSystem::Wait from picking up
+// unrelated long jobs, like pipeline state creation, while a pass takes its shaders from the cache
+template<typename Function>
+static void ForEachParallel(const std::vector<std::size_t>& indices, Function function)
+{
+	if (indices.size() == 1)
+	{
+		function(indices[0]);
+		return;
+	}
+
+	JobCounter counter;
+	for (std::size_t i : indices)
+		JobSystem::Execute(counter, [&function, i]() { function(i); });
+	JobSystem::Wait(counter);
+}
+
+static void CompileBatch(const std::vector<ShaderCompileDesc>& descs, std::vector<std::shared_ptr<const ShaderBinary>>& outBinaries)
+{
+	ASSERT(s_Data.Compiler, "Shader cache was not initialized");
+	outBinaries.assign(descs.size(), nullptr);
+
+	// Sources are loaded and hashed on the job system as well, every shader reads its own copy of the files it includes
+	std::vector<ShaderSources> sources(descs.size());
+	std::vector<Hash128> keys(descs.size());
+	std::vector<uint8_t> hasSources(descs.size(), 0);
+
+	std::vector<std::size_t> indices(descs.size());
+	std::iota(indices.begin(), indices.end(), 0);
+
+	ForEachParallel(indices, [&](std::size_t i) {
+		auto start = std::chrono::steady_clock::now();
+
+		hasSources[i] = ShaderCache::LoadSources(descs[i].Filepath, sources[i]);
+		if (hasSources[i])
+			keys[i] = ShaderCache::HashShader(descs[i], sources[i]);
+
+		float hashTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		std::scoped_lock lock(s_Data.Mutex);
+		s_Data.Stats.HashTime += hashTime;
+	});
+
+	// Binaries in memory are used right away, the first request of every other key is loaded or compiled, later ones share its binary
+	std::vector<std::size_t> misses;
+	std::unordered_map<Hash128, std::size_t, Hash128Hasher> firstMissIndices;
+	{
+		std::scoped_lock lock(s_Data.Mutex);
+		for (std::size_t i = 0; i < descs.size(); ++i)
+		{
+			if (!hasSources[i])
+			{
+				s_Data.Stats.NumFailed++;
+				continue;
+			}
+
+			auto iter = s_Data.Binaries.find(keys[i]);
+			if (iter != s_Data.Binaries.end())
+			{
+				outBinaries[i] = iter->second;
+				s_Data.Stats.NumMemoryHits++;
+			}
+			else if (firstMissIndices.emplace(keys[i], i).second)
+			{
+				misses.push_back(i);
+			}
+		}
+	}
+
+	ForEachParallel(misses, [&](std::size_t i) { outBinaries[i] = LoadOrCompile(descs[i], sources[i], keys[i]); });
+
+	std::scoped_lock lock(s_Data.Mutex);
+	for (std::size_t i : misses)
+	{
+		if (outBinaries[i])
+			s_Data.Binaries.emplace(keys[i], outBinaries[i]);
+	}
+
+	for (std::size_t i = 0; i < descs.size(); ++i)
+	{
+		auto iter = firstMissIndices.find(keys[i]);
+		if (hasSources[i] && !outBinaries[i] && iter != firstMissIndices.end())
+			outBinaries[i] = outBinaries[iter->second];
+	}
+}
+
+void ShaderCache::Initialize(std::unique_ptr<ShaderCompiler> compiler, const ShaderCacheDesc& desc)
+{
+	s_Data.Compiler = std::move(compiler);
+	s_Data.CompilerVersionHash = s_Data.Compiler->GetVersionHash();
+	s_Data.Desc = desc;
+
+	std::error_code error;
+	std::filesystem::create_directories(s_Data.Desc.Directory, error);
+
+	if (error)
+		LOG_WARN("[ShaderCache] Could not create shader cache directory {}, compiled shaders are only kept in memory", s_Data.Desc.Directory);
+}
+
+void ShaderCache::Finalize()
+{
+	std::scoped_lock lock(s_Data.Mutex);
+	s_Data.Binaries.clear();
+	s_Data.Compiler.reset();
+}
+
+bool ShaderCache::LoadSources(const std::string& filepath, ShaderSources& outSources)
+{
+	outSources.clear();
+
+	ShaderSourceFile mainFile;
+	mainFile.Filepath = NormalizePath(filepath);
+	mainFile.Exists = ReadFile(mainFile.Filepath, mainFile.Code);
+
+	if (!mainFile.Exists)
+	{
+		LOG_ERR("[ShaderCache] Could not open shader file: {}", filepath);
+		return false;
+	}
+
+	outSources.push_back(std::move(mainFile));
+
+	// Every file is only added once, like with include guards, nested includes are resolved relative to the file that includes them
+	for (std::size_t i = 0; i < outSources.size(); ++i)
+	{
+		if (!outSources[i].Exists)
+			continue;
+
+		std::vector<std::string> includes;
+		FindIncludes(outSources[i].Code, includes);
+		std::filesystem::path directory = std::filesystem::path(outSources[i].Filepath).parent_path();
+
+		for (const std::string& include : includes)
+		{
+			ShaderSourceFile includeFile = ResolveInclude(directory, include);
+			auto isSameFile = [&includeFile](const ShaderSourceFile& source) { return source.Filepath == includeFile.Filepath; };
+
+			if (std::none_of(outSources.begin(), outSources.end(), isSameFile))
+				outSources.push_back(std::move(includeFile));
+		}
+	}
+
+	return true;
+}
+
+Hash128 ShaderCache::HashShader(const ShaderCompileDesc& desc, const ShaderSources& sources)
+{
+	// Every field is hashed on its own before it is combined, so moving characters from one field into the next changes the key
+	Hash128 hash = Hash::Combine(Hash::Value(SHADER_CACHE_VERSION), s_Data.CompilerVersionHash);
+	hash = Hash::Combine(hash, HashString(desc.EntryPoint));
+	hash = Hash::Combine(hash, HashString(desc.Target));
+	hash = Hash::Combine(hash, Hash::Value(desc.Flags));
+
+	hash = Hash::Combine(hash, Hash::Value(static_cast<uint64_t>(desc.Defines.size())));
+	for (const std::string& define : desc.Defines)
+		hash = Hash::Combine(hash, HashString(define));
+
+	for (const ShaderSourceFile& source : sources)
+	{
+		hash = Hash::Combine(hash, HashString(source.Filepath));
+		hash = Hash::Combine(hash, Hash::Value(source.Exists));
+		hash = Hash::Combine(hash, HashString(source.Code));
+	}
+
+	return hash;
+}
+
+void ShaderCache::CompileShaders(const std::vector<ShaderCompileDesc>& descs, std::vector<std::shared_ptr<const ShaderBinary>>& outBinaries)
+{
+	SCOPED_TIMER("ShaderCache::CompileShaders");
+
+	auto start = std::chrono::steady_clock::now();
+	CompileBatch(descs, outBinaries);
+	float batchTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::scoped_lock lock(s_Data.Mutex);
+	s_Data.Stats.LastBatchTime = batchTime;
+}
+
+std::shared_ptr<const ShaderBinary> ShaderCache::GetShader(const ShaderCompileDesc& desc)
+{
+	std::vector<std::shared_ptr<const ShaderBinary>> binaries;
+	CompileBatch({ desc }, binaries);
+
+	return binaries[0];
+}
+
+void ShaderCache::GetDirectoryShaders(const std::string& directory, std::vector<ShaderCompileDesc>& outDescs)
+{
+	outDescs.clear();
+
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+	{
+		std::string stem = entry.path().stem().string();
+		if (entry.path().extension() != ".hlsl" || stem.size() < 3)
+			continue;
+
+		std::string suffix = stem.substr(stem.size() - 3);
+		const char* target = nullptr;
+
+		if (suffix == "_VS")
+			target = SHADER_TARGET_VERTEX;
+		else if (suffix == "_PS")
+			target = SHADER_TARGET_PIXEL;
+		else if (suffix == "_CS")
+			target = SHADER_TARGET_COMPUTE;
+		else
+			continue;
+
+		ShaderCompileDesc desc;
+		desc.Filepath = NormalizePath(entry.path());
+		desc.Target = target;
+		outDescs.push_back(desc);
+	}
+
+	if (error)
+		LOG_ERR("[ShaderCache] Could not list shader directory: {}", directory);
+
+	// Directory order is unspecified, sorted so the batches and their logs are the same on every launch
+	std::sort(outDescs.begin(), outDescs.end(), [](const ShaderCompileDesc& lhs, const ShaderCompileDesc& rhs) { return lhs.Filepath < rhs.Filepath; });
+}
+
+uint32_t ShaderCache::CompileDirectory(const std::string& directory)
+{
+	std::vector<ShaderCompileDesc> descs;
+	GetDirectoryShaders(directory, descs);
+
+	ShaderCacheStatistics statsBefore = GetStatistics();
+	std::vector<std::shared_ptr<const ShaderBinary>> binaries;
+	CompileShaders(descs, binaries);
+	ShaderCacheStatistics stats = GetStatistics();
+
+	LOG_INFO("[ShaderCache] {} shaders of {} in {} ms: {} from memory, {} from disk, {} compiled, {} failed", descs.size(), directory, stats.LastBatchTime,
+		stats.NumMemoryHits - statsBefore.NumMemoryHits, stats.NumDiskHits - statsBefore.NumDiskHits, stats.NumCompiled - statsBefore.NumCompiled,
+		stats.NumFailed - statsBefore.NumFailed);
+
+	return static_cast<uint32_t>(std::count(binaries.begin(), binaries.end(), nullptr));
+}
+
+void ShaderCache::ClearMemory()
+{
+	std::scoped_lock lock(s_Data.Mutex);
+	s_Data.Binaries.clear();
+}
+
+ShaderCacheStatistics ShaderCache::GetStatistics()
+{
+	std::scoped_lock lock(s_Data.Mutex);
+	return s_Data.Stats;
+}
+
+void ShaderCache::ResetStatistics()
+{
+	std::scoped_lock lock(s_Data.Mutex);
+	s_Data.Stats = ShaderCacheStatistics();
+}
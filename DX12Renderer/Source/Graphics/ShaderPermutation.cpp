@@ -0,0 +1,186 @@
+#include "Pch.h"
+#include "Graphics/ShaderPermutation.h"
+
+static constexpr uint32_t DRAW_SORT_KEY_MATERIAL_BITS = 64 - SHADER_FEATURE_NUM_BITS - 32;
+
+static uint32_t CountBits(uint32_t bits)
+{
+	uint32_t count = 0;
+	for (; bits != 0; bits &= bits - 1)
+		count++;
+
+	return count;
+}
+
+ShaderPermutationSet::ShaderPermutationSet()
+{
+	m_Manifest.Variants.push_back(SHADER_FEATURE_NONE);
+}
+
+ShaderPermutationSet::ShaderPermutationSet(const ShaderPermutationManifest& manifest)
+	: m_Manifest(manifest)
+{
+	bool isValid = ShaderPermutation::ValidateManifest(manifest);
+	ASSERT(isValid, "Invalid shader permutation manifest: " + manifest.Name);
+
+	for (uint32_t drawFeatures = 0; drawFeatures < m_VariantLookup.size(); ++drawFeatures)
+	{
+		uint32_t features = drawFeatures & manifest.SupportedFeatures;
+		uint32_t bestVariant = 0;
+		uint32_t bestExtraCapabilities = std::numeric_limits<uint32_t>::max();
+		uint32_t bestSpecializations = 0;
+
+		for (uint32_t variant = 0; variant < manifest.Variants.size(); ++variant)
+		{
+			uint32_t variantFeatures = manifest.Variants[variant];
+			if (!ShaderPermutation::IsVariantCompatible(variantFeatures, features))
+				continue;
+
+			uint32_t extraCapabilities = CountBits(variantFeatures & ~features & SHADER_FEATURE_CAPABILITIES);
+			uint32_t specializations = CountBits(variantFeatures & SHADER_FEATURE_SPECIALIZATIONS);
+
+			if (extraCapabilities < bestExtraCapabilities || (extraCapabilities == bestExtraCapabilities && specializations > bestSpecializations))
+			{
+				bestVariant = variant;
+				bestExtraCapabilities = extraCapabilities;
+				bestSpecializations = specializations;
+			}
+		}
+
+		m_VariantLookup[drawFeatures] = static_cast<uint8_t>(bestVariant);
+	}
+}
+
+namespace ShaderPermutation
+{
+
+	const char* GetFeatureDefine(ShaderFeature feature)
+	{
+		switch (feature)
+		{
+		case SHADER_FEATURE_NORMAL_MAP:
+			return "HAS_NORMAL_MAP";
+		case SHADER_FEATURE_METALLIC_ROUGHNESS_MAP:
+			return "HAS_METALLIC_ROUGHNESS_MAP";
+		case SHADER_FEATURE_ALPHA_TEST:
+			return "ALPHA_TEST";
+		case SHADER_FEATURE_SHADOWED_LIGHTS_ONLY:
+			return "SHADOWED_LIGHTS_ONLY";
+		default:
+			return "";
+		}
+	}
+
+	void GetDefines(uint32_t features, std::vector<std::string>& outDefines)
+	{
+		outDefines.clear();
+
+		for (uint32_t bit = 0; bit < SHADER_FEATURE_NUM_BITS; ++bit)
+		{
+			if (features & (1 << bit))
+				outDefines.push_back(GetFeatureDefine(static_cast<ShaderFeature>(1 << bit)));
+		}
+	}
+
+	std::string GetFeatureString(uint32_t features)
+	{
+		std::vector<std::string> defines;
+		GetDefines(features, defines);
+
+		if (defines.empty())
+			return "NONE";
+
+		std::string featureString = defines[0];
+		for (std::size_t i = 1; i < defines.size(); ++i)
+			featureString += "|" + defines[i];
+
+		return featureString;
+	}
+
+	bool IsVariantCompatible(uint32_t variantFeatures, uint32_t drawFeatures)
+	{
+		uint32_t missingCapabilities = drawFeatures & ~variantFeatures & SHADER_FEATURE_CAPABILITIES;
+		uint32_t unmetSpecializations = variantFeatures & ~drawFeatures & SHADER_FEATURE_SPECIALIZATIONS;
+
+		return missingCapabilities == 0 && unmetSpecializations == 0;
+	}
+
+	bool ValidateManifest(const ShaderPermutationManifest& manifest)
+	{
+		if (manifest.Variants.empty() || manifest.Variants.size() > SHADER_PERMUTATION_MAX_VARIANTS)
+		{
+			LOG_ERR("[ShaderPermutation] {} has {} variants, it needs between 1 and {}", manifest.Name, manifest.Variants.size(), SHADER_PERMUTATION_MAX_VARIANTS);
+			return false;
+		}
+
+		if ((manifest.SupportedFeatures & ~SHADER_FEATURE_ALL) != 0)
+		{
+			LOG_ERR("[ShaderPermutation] {} supports unknown feature bits {}", manifest.Name, manifest.SupportedFeatures);
+			return false;
+		}
+
+		uint32_t fallback = manifest.SupportedFeatures & SHADER_FEATURE_CAPABILITIES;
+		if (manifest.Variants[0] != fallback)
+		{
+			LOG_ERR("[ShaderPermutation] The first variant of {} is {}, the fallback has to be {}", manifest.Name,
+				GetFeatureString(manifest.Variants[0]), GetFeatureString(fallback));
+			return false;
+		}
+
+		for (std::size_t i = 0; i < manifest.Variants.size(); ++i)
+		{
+			if ((manifest.Variants[i] & ~manifest.SupportedFeatures) != 0)
+			{
+				LOG_ERR("[ShaderPermutation] Variant {} of {} uses features the manifest does not support", GetFeatureString(manifest.Variants[i]), manifest.Name);
+				return false;
+			}
+
+			if (std::find(manifest.Variants.begin(), manifest.Variants.begin() + i, manifest.Variants[i]) != manifest.Variants.begin() + i)
+			{
+				LOG_ERR("[ShaderPermutation] Variant {} of {} is listed twice", GetFeatureString(manifest.Variants[i]), manifest.Name);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const ShaderPermutationManifest& GetLightingManifest()
+	{
+		static const ShaderPermutationManifest manifest = []()
+		{
+			ShaderPermutationManifest lighting;
+			lighting.Name = "Lighting_PS";
+			lighting.SupportedFeatures = SHADER_FEATURE_NORMAL_MAP | SHADER_FEATURE_METALLIC_ROUGHNESS_MAP | SHADER_FEATURE_SHADOWED_LIGHTS_ONLY;
+
+			// Fallback first, the other variants follow in order of decreasing capabilities
+			uint32_t capabilities = lighting.SupportedFeatures & SHADER_FEATURE_CAPABILITIES;
+			for (uint32_t withoutCapabilities = 0; withoutCapabilities <= capabilities; ++withoutCapabilities)
+			{
+				if ((withoutCapabilities & ~capabilities) != 0)
+					continue;
+
+				lighting.Variants.push_back(capabilities & ~withoutCapabilities);
+				lighting.Variants.push_back((capabilities & ~withoutCapabilities) | SHADER_FEATURE_SHADOWED_LIGHTS_ONLY);
+			}
+
+			return lighting;
+		}();
+
+		return manifest;
+	}
+
+	uint64_t MakeDrawSortKey(uint32_t shaderFeatures, uint32_t material, uint32_t mesh)
+	{
+		uint64_t materialMask = (1ull << DRAW_SORT_KEY_MATERIAL_BITS) - 1;
+
+		return (static_cast<uint64_t>(shaderFeatures & SHADER_FEATURE_ALL) << (64 - SHADER_FEATURE_NUM_BITS)) |
+			((static_cast<uint64_t>(material) & materialMask) << 32) | mesh;
+	}
+
+	uint32_t GetDrawSortKeyFeatures(uint64_t sortKey)
+	{
+		return static_cast<uint32_t>(sortKey >> (64 - SHADER_FEATURE_NUM_BITS));
+	}
+
+}
@@ -0,0 +1,430 @@
+#include "Pch.h"
+#include "Graphics/ShadowAtlas.h"
+
+#include <cmath>
+
+static bool IsPowerOfTwo(uint32_t value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+static uint32_t Log2(uint32_t value)
+{
+	uint32_t log = 0;
+	while (value >>= 1)
+		log++;
+
+	return log;
+}
+
+ShadowAtlasAllocator::ShadowAtlasAllocator(uint32_t atlasSize, uint32_t minTileSize)
+	: m_AtlasSize(atlasSize), m_MinTileSize(minTileSize)
+{
+	ASSERT(IsPowerOfTwo(atlasSize) && IsPowerOfTwo(minTileSize) && minTileSize <= atlasSize,
+		"Shadow atlas and tile sizes have to be powers of two");
+
+	m_NumLevels = Log2(atlasSize / minTileSize) + 1;
+	m_NodeStates.resize(m_NumLevels);
+	m_NumFreeNodes.resize(m_NumLevels);
+
+	for (uint32_t level = 0; level < m_NumLevels; ++level)
+		m_NodeStates[level].resize(static_cast<std::size_t>(1) << (2 * level));
+
+	Reset();
+}
+
+bool ShadowAtlasAllocator::Allocate(uint32_t tileSize, ShadowAtlasTile& outTile)
+{
+	if (tileSize < m_MinTileSize || tileSize > m_AtlasSize || !IsPowerOfTwo(tileSize))
+		return false;
+
+	uint32_t level = GetLevel(tileSize);
+
+	// Take a free node of the requested size, or split the smallest free node that is larger
+	int32_t freeLevel = static_cast<int32_t>(level);
+	while (freeLevel >= 0 && m_NumFreeNodes[freeLevel] == 0)
+		freeLevel--;
+
+	if (freeLevel < 0)
+		return false;
+
+	const std::vector<uint8_t>& freeStates = m_NodeStates[freeLevel];
+	uint32_t node = static_cast<uint32_t>(std::find(freeStates.begin(), freeStates.end(), NODE_STATE_FREE) - freeStates.begin());
+
+	for (uint32_t splitLevel = static_cast<uint32_t>(freeLevel); splitLevel < level; ++splitLevel)
+	{
+		uint32_t dim = 1u << splitLevel;
+		uint32_t x = node % dim, y = node / dim;
+		uint32_t childDim = dim * 2;
+
+		SetState(splitLevel, node, NODE_STATE_SPLIT);
+		SetState(splitLevel + 1, (2 * y) * childDim + 2 * x, NODE_STATE_FREE);
+		SetState(splitLevel + 1, (2 * y) * childDim + 2 * x + 1, NODE_STATE_FREE);
+		SetState(splitLevel + 1, (2 * y + 1) * childDim + 2 * x, NODE_STATE_FREE);
+		SetState(splitLevel + 1, (2 * y + 1) * childDim + 2 * x + 1, NODE_STATE_FREE);
+
+		node = (2 * y) * childDim + 2 * x;
+	}
+
+	SetState(level, node, NODE_STATE_ALLOCATED);
+
+	uint32_t dim = 1u << level;
+	outTile.X = (node % dim) * tileSize;
+	outTile.Y = (node / dim) * tileSize;
+	outTile.Size = tileSize;
+
+	m_AllocatedTexels += static_cast<uint64_t>(tileSize) * tileSize;
+	return true;
+}
+
+void ShadowAtlasAllocator::Free(const ShadowAtlasTile& tile)
+{
+	uint32_t level = GetLevel(tile.Size);
+	uint32_t dim = 1u << level;
+	uint32_t x = tile.X / tile.Size, y = tile.Y / tile.Size;
+
+	ASSERT(m_NodeStates[level][y * dim + x] == NODE_STATE_ALLOCATED, "Freed a shadow atlas tile that was not allocated");
+	SetState(level, y * dim + x, NODE_STATE_FREE);
+	m_AllocatedTexels -= static_cast<uint64_t>(tile.Size) * tile.Size;
+
+	// Merge four free siblings into their parent
+	while (level > 0)
+	{
+		uint32_t firstX = x & ~1u, firstY = y & ~1u;
+		uint32_t siblings[4] = { firstY * dim + firstX, firstY * dim + firstX + 1, (firstY + 1) * dim + firstX, (firstY + 1) * dim + firstX + 1 };
+
+		for (uint32_t sibling : siblings)
+		{
+			if (m_NodeStates[level][sibling] != NODE_STATE_FREE)
+				return;
+		}
+
+		for (uint32_t sibling : siblings)
+			SetState(level, sibling, NODE_STATE_NONE);
+
+		level--;
+		dim /= 2;
+		x /= 2;
+		y /= 2;
+
+		SetState(level, y * dim + x, NODE_STATE_FREE);
+	}
+}
+
+void ShadowAtlasAllocator::Reset()
+{
+	for (uint32_t level = 0; level < m_NumLevels; ++level)
+	{
+		std::fill(m_NodeStates[level].begin(), m_NodeStates[level].end(), static_cast<uint8_t>(NODE_STATE_NONE));
+		m_NumFreeNodes[level] = 0;
+	}
+
+	if (m_NumLevels > 0)
+		SetState(0, 0, NODE_STATE_FREE);
+
+	m_AllocatedTexels = 0;
+}
+
+uint32_t ShadowAtlasAllocator::GetLevel(uint32_t tileSize) const
+{
+	return Log2(m_AtlasSize / tileSize);
+}
+
+void ShadowAtlasAllocator::SetState(uint32_t level, uint32_t node, NodeState state)
+{
+	uint8_t& nodeState = m_NodeStates[level][node];
+
+	if (nodeState == NODE_STATE_FREE)
+		m_NumFreeNodes[level]--;
+	if (state == NODE_STATE_FREE)
+		m_NumFreeNodes[level]++;
+
+	nodeState = state;
+}
+
+ShadowAtlas::ShadowAtlas(const ShadowAtlasSettings& settings)
+{
+	SetSettings(settings);
+}
+
+void ShadowAtlas::Update(const std::vector<ShadowAtlasRequest>& requests)
+{
+	m_Stats = ShadowAtlasStatistics();
+	m_Stats.NumLights = static_cast<uint32_t>(requests.size());
+
+	for (auto& [lightID, light] : m_Lights)
+		light.IsRequested = false;
+
+	m_DemandScale = CalculateDemandScale(requests);
+
+	for (const ShadowAtlasRequest& request : requests)
+	{
+		ASSERT(request.NumTiles > 0 && request.NumTiles <= MAX_SHADOW_ATLAS_TILES_PER_LIGHT, "Invalid number of shadow atlas tiles requested");
+
+		LightState& light = m_Lights[request.LightID];
+		ASSERT(!light.IsRequested, "Light requested shadow atlas tiles more than once");
+
+		light.IsRequested = true;
+		light.Priority = request.FixedTileSize > 0 ? std::numeric_limits<float>::max() : request.ScreenCoverage * request.Importance;
+		light.TargetTileSize = CalculateTargetTileSize(request, light.Allocation.TileSize);
+
+		// A different number of tiles (e.g. cascades) is handled like a resize
+		if (light.Allocation.TileSize > 0 && light.Allocation.NumTiles != request.NumTiles)
+		{
+			FreeTiles(light.Allocation);
+			m_Stats.NumResizedLights++;
+		}
+	}
+
+	// Lights that are gone release their tiles first
+	for (auto iter = m_Lights.begin(); iter != m_Lights.end();)
+	{
+		if (!iter->second.IsRequested)
+		{
+			FreeTiles(iter->second.Allocation);
+			iter = m_Lights.erase(iter);
+			continue;
+		}
+
+		++iter;
+	}
+
+	// Shrinking always fits into the space the light frees, and makes room for the lights below
+	for (const ShadowAtlasRequest& request : requests)
+	{
+		LightState& light = m_Lights[request.LightID];
+
+		if (light.Allocation.TileSize > light.TargetTileSize)
+		{
+			FreeTiles(light.Allocation);
+			bool isAllocated = AllocateTiles(light.TargetTileSize, request.NumTiles, light.Allocation);
+			ASSERT(isAllocated, "Shrinking shadow atlas tiles failed");
+
+			m_Stats.NumResizedLights++;
+		}
+	}
+
+	// Growing and new lights by priority, the light ID breaks ties so the order does not depend on the request order
+	m_RequestOrder.resize(requests.size());
+	for (std::size_t i = 0; i < requests.size(); ++i)
+		m_RequestOrder[i] = i;
+
+	std::sort(m_RequestOrder.begin(), m_RequestOrder.end(), [this, &requests](std::size_t lhs, std::size_t rhs)
+	{
+		float lhsPriority = m_Lights[requests[lhs].LightID].Priority;
+		float rhsPriority = m_Lights[requests[rhs].LightID].Priority;
+
+		if (lhsPriority != rhsPriority)
+			return lhsPriority > rhsPriority;
+
+		return requests[lhs].LightID < requests[rhs].LightID;
+	});
+
+	std::size_t evictionCandidate = m_RequestOrder.size();
+
+	for (std::size_t order = 0; order < m_RequestOrder.size(); ++order)
+	{
+		const ShadowAtlasRequest& request = requests[m_RequestOrder[order]];
+		LightState& light = m_Lights[request.LightID];
+
+		if (light.Allocation.TileSize > 0)
+		{
+			// Grow into new tiles before releasing the current ones, if the atlas is full the light keeps its tiles
+			if (light.Allocation.TileSize < light.TargetTileSize)
+			{
+				ShadowAtlasAllocation grownAllocation;
+				if (AllocateTiles(light.TargetTileSize, request.NumTiles, grownAllocation))
+				{
+					FreeTiles(light.Allocation);
+					light.Allocation = grownAllocation;
+					m_Stats.NumResizedLights++;
+				}
+				else
+				{
+					m_Stats.NumDeferredResizes++;
+				}
+			}
+
+			continue;
+		}
+
+		// New lights take the largest size up to their target that fits, fixed size tiles do not get smaller
+		uint32_t minTileSize = request.FixedTileSize > 0 ? light.TargetTileSize : m_Settings.MinTileSize;
+		bool isAllocated = false;
+
+		while (!isAllocated)
+		{
+			for (uint32_t tileSize = light.TargetTileSize; tileSize >= minTileSize && !isAllocated; tileSize /= 2)
+				isAllocated = AllocateTiles(tileSize, request.NumTiles, light.Allocation);
+
+			if (isAllocated)
+				break;
+
+			// Evict the allocated light with the lowest priority, if it is clearly less important than this one
+			while (evictionCandidate > order + 1)
+			{
+				LightState& candidate = m_Lights[requests[m_RequestOrder[evictionCandidate - 1]].LightID];
+				if (candidate.Allocation.TileSize > 0)
+					break;
+
+				evictionCandidate--;
+			}
+
+			if (evictionCandidate <= order + 1)
+				break;
+
+			LightState& candidate = m_Lights[requests[m_RequestOrder[evictionCandidate - 1]].LightID];
+			if (candidate.Priority * (1.0f + m_Settings.PriorityHysteresis) >= light.Priority || candidate.Priority == std::numeric_limits<float>::max())
+				break;
+
+			FreeTiles(candidate.Allocation);
+			m_Stats.NumEvictedLights++;
+			evictionCandidate--;
+		}
+
+		if (isAllocated)
+			m_Stats.NumNewLights++;
+	}
+
+	for (const auto& [lightID, light] : m_Lights)
+	{
+		if (light.Allocation.TileSize > 0)
+		{
+			m_Stats.NumAllocatedLights++;
+			m_Stats.NumAllocatedTiles += light.Allocation.NumTiles;
+		}
+		else
+		{
+			m_Stats.NumUnallocatedLights++;
+		}
+	}
+
+	m_Stats.NumAllocatedTexels = m_Allocator.GetAllocatedTexels();
+	m_Stats.DemandScale = m_DemandScale;
+}
+
+void ShadowAtlas::SetSettings(const ShadowAtlasSettings& settings)
+{
+	bool isLayoutChanged = settings.AtlasResolution != m_Settings.AtlasResolution || settings.MinTileSize != m_Settings.MinTileSize ||
+		settings.MaxTileSize != m_Settings.MaxTileSize || m_Allocator.GetAtlasSize() == 0;
+
+	m_Settings = settings;
+	m_Settings.MaxTileSize = glm::clamp(m_Settings.MaxTileSize, m_Settings.MinTileSize, m_Settings.AtlasResolution);
+
+	if (isLayoutChanged)
+	{
+		m_Allocator = ShadowAtlasAllocator(m_Settings.AtlasResolution, m_Settings.MinTileSize);
+		m_Lights.clear();
+	}
+}
+
+const ShadowAtlasAllocation* ShadowAtlas::GetAllocation(uint64_t lightID) const
+{
+	auto iter = m_Lights.find(lightID);
+	if (iter == m_Lights.end() || iter->second.Allocation.TileSize == 0)
+		return nullptr;
+
+	return &iter->second.Allocation;
+}
+
+glm::vec4 ShadowAtlas::GetTileUVRect(const ShadowAtlasTile& tile) const
+{
+	float invAtlasResolution = 1.0f / static_cast<float>(m_Settings.AtlasResolution);
+	return glm::vec4(tile.X, tile.Y, tile.Size, tile.Size) * invAtlasResolution;
+}
+
+float ShadowAtlas::CalculateScreenCoverage(const glm::mat4& view, const glm::mat4& projection, float viewHeight, const glm::vec4& sphere)
+{
+	glm::vec4 viewCenter = view * glm::vec4(glm::vec3(sphere), 1.0f);
+	float radius = sphere.w;
+
+	if (viewCenter.z + radius <= 0.0f)
+		return 0.0f;
+
+	if (glm::dot(glm::vec3(viewCenter), glm::vec3(viewCenter)) <= radius * radius)
+		return viewHeight;
+
+	// Clip space w at the closest point of the sphere, like LOD selection, so orthographic views are handled as well
+	float w = projection[2][3] * (viewCenter.z - radius) + projection[3][3];
+	if (w <= 0.0f)
+		return viewHeight;
+
+	return std::min(2.0f * radius * std::abs(projection[1][1]) * 0.5f * viewHeight / w, viewHeight);
+}
+
+uint32_t ShadowAtlas::CalculateTargetTileSize(const ShadowAtlasRequest& request, uint32_t currentTileSize) const
+{
+	if (request.FixedTileSize > 0)
+		return glm::clamp(request.FixedTileSize, m_Settings.MinTileSize, m_Settings.AtlasResolution);
+
+	float desiredSize = glm::clamp(request.ScreenCoverage * request.Importance * m_Settings.ResolutionScale * m_DemandScale,
+		static_cast<float>(m_Settings.MinTileSize), static_cast<float>(m_Settings.MaxTileSize));
+	float desiredLevel = std::log2(desiredSize);
+
+	// Keep the current size until the desired size is clearly closer to another power of two
+	if (currentTileSize > 0)
+	{
+		float currentLevel = static_cast<float>(Log2(currentTileSize));
+		if (std::abs(desiredLevel - currentLevel) <= 0.5f + m_Settings.SizeHysteresis)
+			return glm::clamp(currentTileSize, m_Settings.MinTileSize, m_Settings.MaxTileSize);
+	}
+
+	uint32_t tileSize = 1u << static_cast<uint32_t>(std::round(desiredLevel));
+	return glm::clamp(tileSize, m_Settings.MinTileSize, m_Settings.MaxTileSize);
+}
+
+float ShadowAtlas::CalculateDemandScale(const std::vector<ShadowAtlasRequest>& requests) const
+{
+	// Texels all lights would like to have, fixed size tiles are taken from the available texels instead
+	double availableTexels = static_cast<double>(m_Settings.AtlasResolution) * m_Settings.AtlasResolution * m_Settings.MaxOccupancy;
+	double desiredTexels = 0.0;
+
+	for (const ShadowAtlasRequest& request : requests)
+	{
+		if (request.FixedTileSize > 0)
+		{
+			availableTexels -= static_cast<double>(request.FixedTileSize) * request.FixedTileSize * request.NumTiles;
+			continue;
+		}
+
+		double desiredSize = glm::clamp(request.ScreenCoverage * request.Importance * m_Settings.ResolutionScale,
+			static_cast<float>(m_Settings.MinTileSize), static_cast<float>(m_Settings.MaxTileSize));
+		desiredTexels += desiredSize * desiredSize * request.NumTiles;
+	}
+
+	if (desiredTexels <= availableTexels || availableTexels <= 0.0)
+		return availableTexels <= 0.0 ? 0.0f : 1.0f;
+
+	// Scales the edge length of all tiles, so the summed area fits
+	return static_cast<float>(std::sqrt(availableTexels / desiredTexels));
+}
+
+bool ShadowAtlas::AllocateTiles(uint32_t tileSize, uint32_t numTiles, ShadowAtlasAllocation& outAllocation)
+{
+	ShadowAtlasAllocation allocation;
+	allocation.TileSize = tileSize;
+
+	for (uint32_t i = 0; i < numTiles; ++i)
+	{
+		if (!m_Allocator.Allocate(tileSize, allocation.Tiles[i]))
+		{
+			for (uint32_t j = 0; j < i; ++j)
+				m_Allocator.Free(allocation.Tiles[j]);
+
+			return false;
+		}
+
+		allocation.NumTiles++;
+	}
+
+	outAllocation = allocation;
+	return true;
+}
+
+void ShadowAtlas::FreeTiles(ShadowAtlasAllocation& allocation)
+{
+	for (uint32_t i = 0; i < allocation.NumTiles; ++i)
+		m_Allocator.Free(allocation.Tiles[i]);
+
+	allocation = ShadowAtlasAllocation();
+}
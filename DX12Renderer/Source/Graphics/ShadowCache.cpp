@@ -0,0 +1,49 @@
+#include "Pch.h"
+#include "Graphics/ShadowCache.h"
+
+namespace ShadowCache
+{
+
+	// Different seeds keep a view and a caster with the same matrix from cancelling each other out
+	constexpr uint64_t VIEW_SEED = 0x5ad0c0de;
+	constexpr uint64_t CASTER_SEED = 0xca57e125;
+
+	// Wrapping addition is commutative, so the signature is the same for any order of views and casters
+	static void Accumulate(Hash128& signature, const Hash128& hash)
+	{
+		signature.Low += hash.Low;
+		signature.High += hash.High;
+	}
+
+}
+
+bool ShadowCache::IsStaticCaster(const glm::mat4& transform, const glm::mat4& prevFrameTransform)
+{
+	return transform == prevFrameTransform;
+}
+
+void ShadowCache::AddView(Hash128& signature, const glm::mat4& viewProjection, const glm::uvec3& atlasTile)
+{
+	Accumulate(signature, Hash::Combine(Hash::Value(viewProjection, VIEW_SEED), Hash::Value(atlasTile, VIEW_SEED)));
+}
+
+void ShadowCache::AddStaticCaster(Hash128& signature, uint64_t meshID, const glm::mat4& transform)
+{
+	Accumulate(signature, Hash::Combine(Hash::Value(meshID, CASTER_SEED), Hash::Value(transform, CASTER_SEED)));
+}
+
+bool ShadowCache::Validate(ShadowCacheEntry& entry, const Hash128& signature)
+{
+	if (entry.IsValid && entry.Signature == signature)
+		return true;
+
+	entry.Signature = signature;
+	entry.IsValid = true;
+
+	return false;
+}
+
+void ShadowCache::Invalidate(ShadowCacheEntry& entry)
+{
+	entry.IsValid = false;
+}
@@ -0,0 +1,138 @@
+#include "Pch.h"
+#include "Graphics/ShadowCascades.h"
+
+namespace ShadowCascades
+{
+
+	// Radii are rounded up to this step, so float noise between frames never changes the texel size of a cascade
+	constexpr float SPHERE_RADIUS_STEP = 1.0f / 16.0f;
+	// Smallest depth range of a cascade, used when no receiver of the scene is inside the cascade
+	constexpr float MIN_DEPTH_RANGE = 0.01f;
+
+	static bool IsBoundingBoxEmpty(const BoundingBox& bb)
+	{
+		return bb.Min.x > bb.Max.x || bb.Min.y > bb.Max.y || bb.Min.z > bb.Max.z;
+	}
+
+}
+
+void ShadowCascades::CalculateSplitDistances(float nearPlane, float farPlane, uint32_t numCascades, float lambda, float* outSplits)
+{
+	ASSERT(numCascades > 0 && nearPlane > 0.0f && farPlane > nearPlane, "Invalid cascade split range");
+
+	outSplits[0] = nearPlane;
+	for (uint32_t i = 1; i < numCascades; ++i)
+	{
+		float t = static_cast<float>(i) / numCascades;
+		float logSplit = nearPlane * std::pow(farPlane / nearPlane, t);
+		float uniformSplit = nearPlane + (farPlane - nearPlane) * t;
+
+		outSplits[i] = glm::mix(uniformSplit, logSplit, lambda);
+	}
+	outSplits[numCascades] = farPlane;
+}
+
+BoundingSphere ShadowCascades::CalculateFrustumSliceBoundingSphere(const glm::mat4& cameraView, float tanHalfFovY, float aspectRatio, float sliceNear, float sliceFar)
+{
+	// The squared distance of a slice corner to the view axis is depth^2 * k, the center lies on the view axis
+	// where the near and far corners are equally far away, or on the far plane if that point is beyond it
+	float k = tanHalfFovY * tanHalfFovY * (1.0f + aspectRatio * aspectRatio);
+	float centerDepth = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + k), sliceFar);
+
+	float nearDistanceSquared = (centerDepth - sliceNear) * (centerDepth - sliceNear) + sliceNear * sliceNear * k;
+	float farDistanceSquared = (sliceFar - centerDepth) * (sliceFar - centerDepth) + sliceFar * sliceFar * k;
+	float radius = std::sqrt(std::max(nearDistanceSquared, farDistanceSquared));
+
+	BoundingSphere sphere;
+	sphere.Position = glm::inverse(cameraView) * glm::vec4(0.0f, 0.0f, centerDepth, 1.0f);
+	sphere.Radius = std::ceil(radius / SPHERE_RADIUS_STEP) * SPHERE_RADIUS_STEP;
+
+	return sphere;
+}
+
+glm::mat4 ShadowCascades::MakeLightView(const glm::vec3& lightDirection)
+{
+	glm::vec3 direction = glm::normalize(lightDirection);
+	glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+	return glm::lookAtLH(glm::vec3(0.0f), direction, up);
+}
+
+void ShadowCascades::FitCascade(const glm::mat4& lightView, const BoundingSphere& sphere, uint32_t shadowMapResolution, const BoundingBox& sceneBB, ShadowCascade& outCascade)
+{
+	ASSERT(shadowMapResolution > 2, "Shadow map resolution is too small for a cascade");
+
+	glm::vec3 center = lightView * glm::vec4(sphere.Position, 1.0f);
+	float radius = sphere.Radius;
+
+	// The bounds are one texel larger than the sphere on every side, so the sphere stays covered when the center is snapped below
+	float extent = radius * shadowMapResolution / (shadowMapResolution - 2.0f);
+	float texelSize = 2.0f * extent / static_cast<float>(shadowMapResolution);
+
+	// Move the center in whole texels only, the light view has no translation so this is stable for a fixed light direction
+	center.x = std::floor(center.x / texelSize) * texelSize;
+	center.y = std::floor(center.y / texelSize) * texelSize;
+
+	outCascade.Sphere = sphere;
+	outCascade.View = lightView;
+	outCascade.Left = center.x - extent;
+	outCascade.Right = center.x + extent;
+	outCascade.Bottom = center.y - extent;
+	outCascade.Top = center.y + extent;
+	outCascade.Near = center.z - radius;
+	outCascade.Far = center.z + radius;
+
+	if (!IsBoundingBoxEmpty(sceneBB))
+	{
+		float sceneNear = std::numeric_limits<float>::max();
+		float sceneFar = std::numeric_limits<float>::lowest();
+
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			glm::vec3 corner((i & 1) ? sceneBB.Max.x : sceneBB.Min.x, (i & 2) ? sceneBB.Max.y : sceneBB.Min.y, (i & 4) ? sceneBB.Max.z : sceneBB.Min.z);
+			float depth = (lightView * glm::vec4(corner, 1.0f)).z;
+
+			sceneNear = std::min(sceneNear, depth);
+			sceneFar = std::max(sceneFar, depth);
+		}
+
+		// Casters in front of the sphere still throw shadows into it, receivers behind the scene do not exist
+		outCascade.Near = sceneNear;
+		outCascade.Far = std::min(outCascade.Far, sceneFar);
+	}
+
+	outCascade.Far = std::max(outCascade.Far, outCascade.Near + MIN_DEPTH_RANGE);
+
+	outCascade.Projection = glm::orthoLH_ZO(outCascade.Left, outCascade.Right, outCascade.Bottom, outCascade.Top, outCascade.Far, outCascade.Near);
+	outCascade.ViewProjection = outCascade.Projection * outCascade.View;
+}
+
+uint32_t ShadowCascades::CalculateCascades(const ShadowCascadeSettings& settings, const glm::mat4& cameraView, const glm::mat4& cameraProjection, float cameraNear, float cameraFar,
+	const glm::vec3& lightDirection, const BoundingBox& sceneBB, ShadowCascade* outCascades)
+{
+	uint32_t numCascades = glm::clamp(settings.NumCascades, 1u, MAX_SHADOW_CASCADES);
+	float shadowFar = std::min(cameraFar, settings.MaxShadowDistance);
+
+	if (shadowFar <= cameraNear)
+		return 0;
+
+	float splits[MAX_SHADOW_CASCADES + 1] = {};
+	CalculateSplitDistances(cameraNear, shadowFar, numCascades, settings.SplitLambda, splits);
+
+	float tanHalfFovY = 1.0f / cameraProjection[1][1];
+	float aspectRatio = cameraProjection[1][1] / cameraProjection[0][0];
+	glm::mat4 lightView = MakeLightView(lightDirection);
+
+	for (uint32_t i = 0; i < numCascades; ++i)
+	{
+		ShadowCascade& cascade = outCascades[i];
+
+		BoundingSphere sphere = CalculateFrustumSliceBoundingSphere(cameraView, tanHalfFovY, aspectRatio, splits[i], splits[i + 1]);
+		FitCascade(lightView, sphere, settings.ShadowMapResolution, sceneBB, cascade);
+
+		cascade.SplitNear = splits[i];
+		cascade.SplitFar = splits[i + 1];
+	}
+
+	return numCascades;
+}
@@ -0,0 +1,230 @@
+#include "Pch.h"
+#include "Graphics/ShadowCasterCulling.h"
+
+namespace ShadowCasterCulling
+{
+
+	// Points closer to the plane of a perspective light than this have no stable ray direction
+	constexpr float MIN_PERSPECTIVE_DEPTH = 1e-4f;
+
+	// Corner i of the frustum has x = bit 0, y = bit 1, z = bit 2 of i, faces list their corners in order around the face
+	constexpr uint32_t FRUSTUM_FACES[6][4] = {
+		{ 0, 1, 3, 2 }, { 4, 5, 7, 6 },
+		{ 0, 2, 6, 4 }, { 1, 3, 7, 5 },
+		{ 0, 1, 5, 4 }, { 2, 3, 7, 6 }
+	};
+
+	static bool IsBoundingBoxEmpty(const BoundingBox& bb)
+	{
+		return bb.Min.x > bb.Max.x || bb.Min.y > bb.Max.y || bb.Min.z > bb.Max.z;
+	}
+
+	// Sutherland-Hodgman against one plane of the box, keeps the part of the polygon where sign * (p[axis] - value) >= 0
+	static void ClipPolygon(const std::vector<glm::vec3>& polygon, uint32_t axis, float value, float sign, std::vector<glm::vec3>& outPolygon)
+	{
+		outPolygon.clear();
+
+		for (std::size_t i = 0; i < polygon.size(); ++i)
+		{
+			const glm::vec3& current = polygon[i];
+			const glm::vec3& next = polygon[(i + 1) % polygon.size()];
+			float currentDistance = sign * (current[axis] - value);
+			float nextDistance = sign * (next[axis] - value);
+
+			if (currentDistance >= 0.0f)
+				outPolygon.push_back(current);
+
+			if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+			{
+				float t = currentDistance / (currentDistance - nextDistance);
+				glm::vec3 intersection = glm::mix(current, next, t);
+				// Exactly on the plane, so float error does not move it to the outside
+				intersection[axis] = value;
+				outPolygon.push_back(intersection);
+			}
+		}
+	}
+
+	static bool IsPointInFrustum(const glm::mat4& viewProjection, const glm::vec3& point)
+	{
+		glm::vec4 clip = viewProjection * glm::vec4(point, 1.0f);
+		return clip.w > 0.0f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w && clip.z >= 0.0f && clip.z <= clip.w;
+	}
+
+}
+
+void ShadowCasterCulling::CalculateReceiverRegion(const glm::mat4& cameraViewProjection, const BoundingBox& sceneBB, std::vector<glm::vec3>& outPoints)
+{
+	outPoints.clear();
+
+	if (IsBoundingBoxEmpty(sceneBB))
+		return;
+
+	// Reverse-z only swaps the near and far corners, the set of corners stays the same
+	glm::mat4 invViewProjection = glm::inverse(cameraViewProjection);
+	glm::vec3 frustumCorners[8];
+
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		glm::vec4 corner = invViewProjection * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+		frustumCorners[i] = glm::vec3(corner) / corner.w;
+	}
+
+	// The corners of the intersection are the frustum faces clipped to the box, and the box corners inside the frustum
+	std::vector<glm::vec3> polygon, clipped;
+
+	for (const auto& face : FRUSTUM_FACES)
+	{
+		polygon.assign({ frustumCorners[face[0]], frustumCorners[face[1]], frustumCorners[face[2]], frustumCorners[face[3]] });
+
+		for (uint32_t axis = 0; axis < 3 && !polygon.empty(); ++axis)
+		{
+			ClipPolygon(polygon, axis, sceneBB.Min[axis], 1.0f, clipped);
+			ClipPolygon(clipped, axis, sceneBB.Max[axis], -1.0f, polygon);
+		}
+
+		outPoints.insert(outPoints.end(), polygon.begin(), polygon.end());
+	}
+
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		glm::vec3 corner((i & 1) ? sceneBB.Max.x : sceneBB.Min.x, (i & 2) ? sceneBB.Max.y : sceneBB.Min.y, (i & 4) ? sceneBB.Max.z : sceneBB.Min.z);
+
+		if (IsPointInFrustum(cameraViewProjection, corner))
+			outPoints.push_back(corner);
+	}
+}
+
+ShadowCasterVolume ShadowCasterCulling::MakeCasterVolume(const glm::mat4& lightView, const glm::mat4& lightProjection, const std::vector<glm::vec3>& receiverPoints)
+{
+	ShadowCasterVolume volume;
+	volume.LightView = lightView;
+	volume.IsPerspective = lightProjection[2][3] != 0.0f;
+
+	// Light view xy bounds of an orthographic projection, ray direction bounds of a perspective one
+	glm::vec2 offset = volume.IsPerspective ? glm::vec2(lightProjection[2][0], lightProjection[2][1]) : glm::vec2(lightProjection[3][0], lightProjection[3][1]);
+	glm::vec2 scale = glm::vec2(lightProjection[0][0], lightProjection[1][1]);
+	glm::vec2 lightMin = (-1.0f - offset) / scale;
+	glm::vec2 lightMax = (1.0f - offset) / scale;
+
+	if (receiverPoints.empty())
+		return volume;
+
+	volume.ReceiverMin = glm::vec2(std::numeric_limits<float>::max());
+	volume.ReceiverMax = glm::vec2(std::numeric_limits<float>::lowest());
+	volume.ReceiverMaxDepth = std::numeric_limits<float>::lowest();
+	bool isBehindLight = false;
+
+	for (const glm::vec3& point : receiverPoints)
+	{
+		glm::vec3 lightSpacePoint = lightView * glm::vec4(point, 1.0f);
+		volume.ReceiverMaxDepth = std::max(volume.ReceiverMaxDepth, lightSpacePoint.z);
+
+		if (volume.IsPerspective)
+		{
+			// The receiver region reaches around the light, its rays can go in any direction
+			if (lightSpacePoint.z <= MIN_PERSPECTIVE_DEPTH)
+			{
+				isBehindLight = true;
+				continue;
+			}
+
+			glm::vec2 direction = glm::vec2(lightSpacePoint) / lightSpacePoint.z;
+			volume.ReceiverMin = glm::min(volume.ReceiverMin, direction);
+			volume.ReceiverMax = glm::max(volume.ReceiverMax, direction);
+		}
+		else
+		{
+			volume.ReceiverMin = glm::min(volume.ReceiverMin, glm::vec2(lightSpacePoint));
+			volume.ReceiverMax = glm::max(volume.ReceiverMax, glm::vec2(lightSpacePoint));
+		}
+	}
+
+	if (isBehindLight)
+	{
+		volume.ReceiverMin = lightMin;
+		volume.ReceiverMax = lightMax;
+	}
+
+	// Receivers outside of the light view are not shadowed by it
+	volume.ReceiverMin = glm::max(volume.ReceiverMin, lightMin);
+	volume.ReceiverMax = glm::min(volume.ReceiverMax, lightMax);
+
+	volume.IsEmpty = volume.ReceiverMin.x > volume.ReceiverMax.x || volume.ReceiverMin.y > volume.ReceiverMax.y ||
+		(volume.IsPerspective && volume.ReceiverMaxDepth <= MIN_PERSPECTIVE_DEPTH);
+
+	return volume;
+}
+
+bool ShadowCasterCulling::IsCasterInVolume(const ShadowCasterVolume& volume, const BoundingBox& worldBB)
+{
+	if (volume.IsEmpty)
+		return false;
+
+	glm::vec2 casterMin, casterMax;
+	float casterMinDepth;
+
+	if (!volume.IsPerspective)
+	{
+		// Light view bounds of the box from its center and the absolute rotation of its extents
+		glm::vec3 center = (worldBB.Min + worldBB.Max) * 0.5f;
+		glm::vec3 extent = (worldBB.Max - worldBB.Min) * 0.5f;
+
+		glm::mat3 rotation = glm::mat3(volume.LightView);
+		glm::mat3 absRotation = glm::mat3(glm::abs(rotation[0]), glm::abs(rotation[1]), glm::abs(rotation[2]));
+
+		glm::vec3 lightSpaceCenter = volume.LightView * glm::vec4(center, 1.0f);
+		glm::vec3 lightSpaceExtent = absRotation * extent;
+
+		casterMin = glm::vec2(lightSpaceCenter - lightSpaceExtent);
+		casterMax = glm::vec2(lightSpaceCenter + lightSpaceExtent);
+		casterMinDepth = lightSpaceCenter.z - lightSpaceExtent.z;
+	}
+	else
+	{
+		casterMin = glm::vec2(std::numeric_limits<float>::max());
+		casterMax = glm::vec2(std::numeric_limits<float>::lowest());
+		casterMinDepth = std::numeric_limits<float>::max();
+		float casterMaxDepth = std::numeric_limits<float>::lowest();
+
+		glm::vec3 corners[8];
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			glm::vec3 corner((i & 1) ? worldBB.Max.x : worldBB.Min.x, (i & 2) ? worldBB.Max.y : worldBB.Min.y, (i & 4) ? worldBB.Max.z : worldBB.Min.z);
+			corners[i] = volume.LightView * glm::vec4(corner, 1.0f);
+
+			casterMinDepth = std::min(casterMinDepth, corners[i].z);
+			casterMaxDepth = std::max(casterMaxDepth, corners[i].z);
+		}
+
+		// Casters behind the light never reach its view, casters around the light can throw their shadow in any direction
+		if (casterMaxDepth <= 0.0f)
+			return false;
+		if (casterMinDepth <= MIN_PERSPECTIVE_DEPTH)
+			return true;
+
+		for (const glm::vec3& corner : corners)
+		{
+			glm::vec2 direction = glm::vec2(corner) / corner.z;
+			casterMin = glm::min(casterMin, direction);
+			casterMax = glm::max(casterMax, direction);
+		}
+	}
+
+	return casterMin.x <= volume.ReceiverMax.x && casterMax.x >= volume.ReceiverMin.x &&
+		casterMin.y <= volume.ReceiverMax.y && casterMax.y >= volume.ReceiverMin.y &&
+		casterMinDepth <= volume.ReceiverMaxDepth;
+}
+
+uint32_t ShadowCasterCulling::CullCasters(const ShadowCasterVolume& volume, const BoundingBox* worldBBs, std::size_t numCasters, uint8_t* outVisible)
+{
+	uint32_t numCulled = 0;
+
+	for (std::size_t i = 0; i < numCasters; ++i)
+	{
+		outVisible[i] = IsCasterInVolume(volume, worldBBs[i]) ? 1 : 0;
+		numCulled += 1 - outVisible[i];
+	}
+
+	return numCulled;
+}
@@ -0,0 +1,129 @@
+#include "Pch.h"
+#include "Graphics/ShadowScheduler.h"
+
+// Views are ordered by tier first, so always updated and invalid views are considered before any stale one
+enum ShadowViewTier : uint32_t
+{
+	SHADOW_VIEW_TIER_ALWAYS_UPDATE,
+	SHADOW_VIEW_TIER_INVALID,
+	SHADOW_VIEW_TIER_STALE
+};
+
+static ShadowViewTier GetViewTier(const ShadowViewRequest& request)
+{
+	if (request.AlwaysUpdate)
+		return SHADOW_VIEW_TIER_ALWAYS_UPDATE;
+	if (request.IsInvalid)
+		return SHADOW_VIEW_TIER_INVALID;
+
+	return SHADOW_VIEW_TIER_STALE;
+}
+
+static bool IsWithinBudget(uint64_t used, uint64_t cost, uint64_t budget)
+{
+	return budget == 0 || used + cost <= budget;
+}
+
+ShadowScheduler::ShadowScheduler(const ShadowSchedulerSettings& settings)
+	: m_Settings(settings)
+{
+}
+
+void ShadowScheduler::Schedule(const std::vector<ShadowViewRequest>& requests, std::vector<uint8_t>& outUpdate)
+{
+	m_Stats = ShadowSchedulerStatistics();
+	m_Stats.NumViews = static_cast<uint32_t>(requests.size());
+
+	outUpdate.assign(requests.size(), 0);
+	m_Priorities.resize(requests.size());
+	m_RequestOrder.resize(requests.size());
+
+	for (std::size_t i = 0; i < requests.size(); ++i)
+	{
+		auto iter = m_Views.find(requests[i].ViewID);
+		uint32_t framesSinceUpdate = iter != m_Views.end() ? iter->second.FramesSinceUpdate : 0;
+
+		m_Priorities[i] = CalculatePriority(requests[i], framesSinceUpdate);
+		m_RequestOrder[i] = i;
+	}
+
+	std::sort(m_RequestOrder.begin(), m_RequestOrder.end(), [&](std::size_t lhs, std::size_t rhs) {
+		ShadowViewTier lhsTier = GetViewTier(requests[lhs]);
+		ShadowViewTier rhsTier = GetViewTier(requests[rhs]);
+
+		if (lhsTier != rhsTier)
+			return lhsTier < rhsTier;
+		if (m_Priorities[lhs] != m_Priorities[rhs])
+			return m_Priorities[lhs] > m_Priorities[rhs];
+
+		return requests[lhs].ViewID < requests[rhs].ViewID;
+	});
+
+	// Always updated views count against the budget as well, the rest of the budget goes to the views in priority order.
+	// Views that do not fit are skipped, but cheaper ones further down can still fill up the budget
+	bool hasBudgetedUpdate = false;
+
+	for (std::size_t requestIndex : m_RequestOrder)
+	{
+		const ShadowViewRequest& request = requests[requestIndex];
+
+		bool fitsBudget = IsWithinBudget(m_Stats.NumUpdatedDraws, request.NumDraws, m_Settings.DrawBudget) &&
+			IsWithinBudget(m_Stats.NumUpdatedTriangles, request.NumTriangles, m_Settings.TriangleBudget);
+
+		if (!request.AlwaysUpdate && !fitsBudget && hasBudgetedUpdate)
+			continue;
+
+		outUpdate[requestIndex] = 1;
+		hasBudgetedUpdate |= !request.AlwaysUpdate;
+
+		m_Stats.NumUpdatedViews++;
+		m_Stats.NumUpdatedDraws += request.NumDraws;
+		m_Stats.NumUpdatedTriangles += request.NumTriangles;
+	}
+
+	for (auto& [viewID, state] : m_Views)
+		state.IsRequested = false;
+
+	for (std::size_t i = 0; i < requests.size(); ++i)
+	{
+		ViewState& state = m_Views[requests[i].ViewID];
+		state.IsRequested = true;
+		state.FramesSinceUpdate = outUpdate[i] ? 0 : state.FramesSinceUpdate + 1;
+
+		if (!outUpdate[i])
+		{
+			m_Stats.NumSkippedViews++;
+			m_Stats.NumUnshadowedViews += requests[i].IsInvalid ? 1 : 0;
+		}
+
+		m_Stats.MaxFramesSinceUpdate = std::max(m_Stats.MaxFramesSinceUpdate, state.FramesSinceUpdate);
+	}
+
+	// Views that were not requested this frame belong to lights that were removed or lost their atlas tile
+	for (auto iter = m_Views.begin(); iter != m_Views.end();)
+	{
+		if (!iter->second.IsRequested)
+			iter = m_Views.erase(iter);
+		else
+			++iter;
+	}
+}
+
+uint32_t ShadowScheduler::GetFramesSinceUpdate(uint64_t viewID) const
+{
+	auto iter = m_Views.find(viewID);
+	return iter != m_Views.end() ? iter->second.FramesSinceUpdate : 0;
+}
+
+float ShadowScheduler::CalculatePriority(const ShadowViewRequest& request, uint32_t framesSinceUpdate) const
+{
+	float importance = (1.0f + std::max(request.ScreenCoverage, 0.0f)) / (1.0f + std::max(request.Distance, 0.0f) * m_Settings.DistanceFalloff);
+
+	if (request.HasMoved)
+		importance *= m_Settings.MotionWeight;
+	else if (!request.HasDynamicCasters)
+		importance *= m_Settings.UnchangedWeight;
+
+	// Grows every frame a view is skipped, so a view with a low importance still gets its turn eventually
+	return importance * static_cast<float>(framesSinceUpdate + 1);
+}
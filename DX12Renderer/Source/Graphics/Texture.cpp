@@ -1,6 +1,6 @@
 #include "Pch.h"
 #include "Graphics/Texture.h"
-#include "Graphics/Backend/RenderBackend.h"
+#include "Graphics/Backend/D3D12Backend.h"
 
 DXGI_FORMAT TextureFormatToDXGIFormat(TextureFormat format)
 {
@@ -73,12 +73,9 @@ Texture::Texture(const TextureDesc& desc)
 		CreateViews();
 		SetName(desc.DebugName);
 
+		// Mips are generated by the render backend once the upload has finished
 		if (desc.DataPtr)
-		{
-			RenderBackend::UploadTextureData(*this, desc.DataPtr);
-			if (m_TextureDesc.NumMips > 1)
-				RenderBackend::GenerateMips(*this);
-		}
+			m_UploadTicket = D3D12Backend::UploadTextureData(*this, desc.DataPtr);
 	}
 }
 
@@ -166,8 +163,9 @@ void Texture::CreateD3D12Resource()
 		d3d12ResourceDesc.DepthOrArraySize = 6;
 	}
 
-	RenderBackend::CreateTexture(m_d3d12Resource, d3d12ResourceDesc, m_d3d12ResourceState, hasClearValue ? &clearValue : nullptr);
+	D3D12Backend::CreateTexture(m_d3d12Resource, d3d12ResourceDesc, m_d3d12ResourceState, hasClearValue ? &clearValue : nullptr);
 	m_ByteSize = GetRequiredIntermediateSize(m_d3d12Resource.Get(), 0, 1);
+	TrackGPUMemory(m_TextureDesc.DebugName, GetTextureMemoryCategory(m_TextureDesc));
 }
 
 void Texture::AllocateDescriptors()
@@ -176,19 +174,19 @@ void Texture::AllocateDescriptors()
 
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_READ)
 	{
-		m_DescriptorAllocations[DescriptorType::SRV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, numDescriptors);
+		m_DescriptorAllocations[DescriptorType::SRV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, numDescriptors);
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_WRITE)
 	{
-		m_DescriptorAllocations[DescriptorType::UAV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, numDescriptors);
+		m_DescriptorAllocations[DescriptorType::UAV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, numDescriptors);
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_RENDER_TARGET)
 	{
-		m_DescriptorAllocations[DescriptorType::RTV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, numDescriptors);
+		m_DescriptorAllocations[DescriptorType::RTV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_RTV, numDescriptors);
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_DEPTH)
 	{
-		m_DescriptorAllocations[DescriptorType::DSV] = RenderBackend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, numDescriptors);
+		m_DescriptorAllocations[DescriptorType::DSV] = D3D12Backend::AllocateDescriptors(D3D12_DESCRIPTOR_HEAP_TYPE_DSV, numDescriptors);
 	}
 }
 
@@ -216,7 +214,7 @@ void Texture::CreateViews()
 			srvDesc.TextureCube.MipLevels = 1;
 		}
 
-		RenderBackend::GetD3D12Device()->CreateShaderResourceView(m_d3d12Resource.Get(), &srvDesc, srvAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateShaderResourceView(m_d3d12Resource.Get(), &srvDesc, srvAllocation.GetCPUDescriptorHandle());
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_WRITE)
 	{
@@ -238,11 +236,11 @@ void Texture::CreateViews()
 			for (uint32_t i = 1; i < 7; ++i)
 			{
 				cubeFaceUAVDesc.Texture2DArray.FirstArraySlice = i - 1;
-				RenderBackend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &cubeFaceUAVDesc, uavAllocation.GetCPUDescriptorHandle(i));
+				D3D12Backend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &cubeFaceUAVDesc, uavAllocation.GetCPUDescriptorHandle(i));
 			}
 		}
 
-		RenderBackend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &uavDesc, uavAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateUnorderedAccessView(m_d3d12Resource.Get(), nullptr, &uavDesc, uavAllocation.GetCPUDescriptorHandle());
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_RENDER_TARGET)
 	{
@@ -264,11 +262,11 @@ void Texture::CreateViews()
 			for (uint32_t i = 1; i < 7; ++i)
 			{
 				cubeFaceRTVDesc.Texture2DArray.FirstArraySlice = i - 1;
-				RenderBackend::GetD3D12Device()->CreateRenderTargetView(m_d3d12Resource.Get(), &cubeFaceRTVDesc, rtvAllocation.GetCPUDescriptorHandle(i));
+				D3D12Backend::GetD3D12Device()->CreateRenderTargetView(m_d3d12Resource.Get(), &cubeFaceRTVDesc, rtvAllocation.GetCPUDescriptorHandle(i));
 			}
 		}
 
-		RenderBackend::GetD3D12Device()->CreateRenderTargetView(m_d3d12Resource.Get(), &rtvDesc, rtvAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateRenderTargetView(m_d3d12Resource.Get(), &rtvDesc, rtvAllocation.GetCPUDescriptorHandle());
 	}
 	if (m_TextureDesc.Usage & TextureUsage::TEXTURE_USAGE_DEPTH)
 	{
@@ -291,10 +289,10 @@ void Texture::CreateViews()
 			for (uint32_t i = 1; i < 7; ++i)
 			{
 				cubeFaceDSVDesc.Texture2DArray.FirstArraySlice = i - 1;
-				RenderBackend::GetD3D12Device()->CreateDepthStencilView(m_d3d12Resource.Get(), &cubeFaceDSVDesc, dsvAllocation.GetCPUDescriptorHandle(i));
+				D3D12Backend::GetD3D12Device()->CreateDepthStencilView(m_d3d12Resource.Get(), &cubeFaceDSVDesc, dsvAllocation.GetCPUDescriptorHandle(i));
 			}
 		}
 
-		RenderBackend::GetD3D12Device()->CreateDepthStencilView(m_d3d12Resource.Get(), &dsvDesc, dsvAllocation.GetCPUDescriptorHandle());
+		D3D12Backend::GetD3D12Device()->CreateDepthStencilView(m_d3d12Resource.Get(), &dsvDesc, dsvAllocation.GetCPUDescriptorHandle());
 	}
 }
@@ -26,6 +26,7 @@ bool InputHandler::IsKeyPressed(KeyCode key)
 	return m_KeyStates[key];
 }
 
+#if defined(_WIN32)
 KeyCode InputHandler::WParamToKeyCode(WPARAM wParam)
 {
 	switch (wParam)
@@ -58,6 +59,7 @@ KeyCode InputHandler::WParamToKeyCode(WPARAM wParam)
 		return KeyCode::NONE;
 	}
 }
+#endif
 
 float InputHandler::GetInputAxis1D(KeyCode positiveX, KeyCode negativeX)
 {
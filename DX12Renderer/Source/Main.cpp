@@ -7,6 +7,22 @@ int main(int argc, char* argv[])
 
 	Application::Create();
 
+	// --benchmark n runs n frames and writes the frame statistics to --benchmark-report (CSV or JSON) before closing
+	uint32_t numBenchmarkFrames = 0;
+	std::string benchmarkReportFilepath = "Captures/Benchmark.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--benchmark" && i + 1 < argc)
+			numBenchmarkFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (arg == "--benchmark-report" && i + 1 < argc)
+			benchmarkReportFilepath = argv[++i];
+	}
+
+	if (numBenchmarkFrames > 0)
+		Application::Get().SetBenchmarkMode(numBenchmarkFrames, benchmarkReportFilepath);
+
 	Application::Get().Initialize(GetModuleHandle(NULL), 1280, 720);
 	Application::Get().Run();
 	Application::Get().Finalize();
@@ -1,12 +1,11 @@
 #include "Pch.h"
 #include "Resource/FileLoader.h"
 
-#define TINYGLTF_IMPLEMENTATION
-#define TINYGLTF_USE_CPP14
 #define STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #define STBI_MSC_SECURE_CRT
-#include <tinygltf/tiny_gltf.h>
+#include <tinygltf/stb_image.h>
+
+#include <fstream>
 
 ImageInfo FileLoader::LoadImage(const std::string& filepath)
 {
@@ -21,6 +20,25 @@ ImageInfo FileLoader::LoadImage(const std::string& filepath)
 	return imageInfo;
 }
 
+ImageInfo FileLoader::LoadImageFromMemory(const uint8_t* data, std::size_t byteSize)
+{
+	ImageInfo imageInfo = {};
+	imageInfo.Data = stbi_load_from_memory(data, static_cast<int>(byteSize), &imageInfo.Width, &imageInfo.Height, &imageInfo.ChannelsPerPixel, STBI_rgb_alpha);
+
+	if (imageInfo.Data == nullptr)
+	{
+		LOG_ERR("Failed to decode image from memory: {}", stbi_failure_reason());
+	}
+
+	return imageInfo;
+}
+
+void FileLoader::FreeImage(ImageInfo& imageInfo)
+{
+	stbi_image_free(imageInfo.Data);
+	imageInfo.Data = nullptr;
+}
+
 std::string FileLoader::LoadShader(const std::string& filepath)
 {
 	std::string shaderCode = "";
@@ -37,25 +55,8 @@ std::string FileLoader::LoadShader(const std::string& filepath)
 	}
 	else
 	{
-		LOG_ERR("Could not open shader file: " + filepath);
+		LOG_ERR("Could not open shader file: {}", filepath);
 	}
 
 	return shaderCode;
 }
-
-tinygltf::Model FileLoader::LoadGLTFModel(const std::string& filepath)
-{
-	tinygltf::Model tinygltf;
-	tinygltf::TinyGLTF loader;
-	std::string err;
-	std::string warn;
-
-	bool result = loader.LoadASCIIFromFile(&tinygltf, &err, &warn, filepath);
-	if (!warn.empty())
-		LOG_WARN(warn);
-	if (!err.empty())
-		LOG_ERR(err);
-
-	ASSERT(result, "Failed to parse glTF model: " + filepath);
-	return tinygltf;
-}
@@ -0,0 +1,803 @@
+#include "Pch.h"
+#include "Resource/GLTFDocument.h"
+
+#include <tinygltf/json.hpp>
+
+using json = nlohmann::json;
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67;
+static constexpr uint32_t GLB_VERSION = 2;
+static constexpr uint32_t GLB_CHUNK_TYPE_JSON = 0x4E4F534A;
+static constexpr uint32_t GLB_CHUNK_TYPE_BIN = 0x004E4942;
+
+static inline uint32_t Read32(const uint8_t* ptr)
+{
+	uint32_t value;
+	memcpy(&value, ptr, sizeof(uint32_t));
+	return value;
+}
+
+static uint32_t GetComponentByteSize(GLTFComponentType componentType)
+{
+	switch (componentType)
+	{
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_BYTE:
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		return 1;
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_SHORT:
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		return 2;
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_INT:
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_FLOAT:
+		return 4;
+	}
+
+	return 0;
+}
+
+static uint32_t GetNumComponents(const std::string& type)
+{
+	if (type == "SCALAR")
+		return 1;
+	if (type == "VEC2")
+		return 2;
+	if (type == "VEC3")
+		return 3;
+	if (type == "VEC4" || type == "MAT2")
+		return 4;
+	if (type == "MAT3")
+		return 9;
+	if (type == "MAT4")
+		return 16;
+
+	return 0;
+}
+
+static const json& GetArray(const json& object, const char* key)
+{
+	static const json emptyArray = json::array();
+
+	auto iter = object.find(key);
+	return iter != object.end() && iter->is_array() ? *iter : emptyArray;
+}
+
+// Integers only accept integer values, unsigned integers only non-negative ones, so a value never wraps around when it is converted
+template<typename T>
+static T GetNumber(const json& object, const char* key, T defaultValue)
+{
+	auto iter = object.find(key);
+	if (iter == object.end())
+		return defaultValue;
+
+	bool isValid = iter->is_number();
+	if constexpr (std::is_integral<T>::value)
+		isValid = std::is_unsigned<T>::value ? iter->is_number_unsigned() : iter->is_number_integer();
+
+	return isValid ? iter->get<T>() : defaultValue;
+}
+
+static std::string GetString(const json& object, const char* key)
+{
+	auto iter = object.find(key);
+	return iter != object.end() && iter->is_string() ? iter->get<std::string>() : std::string();
+}
+
+static bool GetBool(const json& object, const char* key, bool defaultValue)
+{
+	auto iter = object.find(key);
+	return iter != object.end() && iter->is_boolean() ? iter->get<bool>() : defaultValue;
+}
+
+// Reads the first count elements of a number array, fails for shorter arrays and elements that are not numbers
+static bool GetFloats(const json& array, float* out, std::size_t count)
+{
+	if (array.size() < count)
+		return false;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (!array[i].is_number())
+			return false;
+
+		out[i] = array[i].get<float>();
+	}
+
+	return true;
+}
+
+// Reads an optional index into an array of numElements elements, a missing index is -1
+static bool GetIndex(const json& object, const char* key, std::size_t numElements, int& outIndex)
+{
+	outIndex = -1;
+
+	auto iter = object.find(key);
+	if (iter == object.end())
+		return true;
+
+	if (!iter->is_number_integer() || iter->get<int64_t>() < 0 || iter->get<int64_t>() >= static_cast<int64_t>(numElements))
+	{
+		LOG_ERR("glTF {} index is out of range", key);
+		return false;
+	}
+
+	outIndex = iter->get<int>();
+	return true;
+}
+
+// Reads an array of indices into an array of numElements elements
+static bool GetIndices(const json& array, std::size_t numElements, std::vector<std::size_t>& outIndices)
+{
+	for (const json& element : array)
+	{
+		if (!element.is_number_integer() || element.get<int64_t>() < 0 || element.get<int64_t>() >= static_cast<int64_t>(numElements))
+			return false;
+
+		outIndices.push_back(element.get<std::size_t>());
+	}
+
+	return true;
+}
+
+static int DecodeHexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+static std::string DecodeUriPath(const std::string& uri)
+{
+	// Relative URIs may contain percent-encoded characters (e.g. spaces)
+	std::string path;
+	path.reserve(uri.size());
+
+	for (std::size_t i = 0; i < uri.size(); ++i)
+	{
+		int high = uri[i] == '%' && i + 2 < uri.size() ? DecodeHexDigit(uri[i + 1]) : -1;
+		int low = high >= 0 ? DecodeHexDigit(uri[i + 2]) : -1;
+
+		// A percent sign that does not start an escape sequence is kept as is
+		if (low >= 0)
+		{
+			path += static_cast<char>(high * 16 + low);
+			i += 2;
+		}
+		else
+		{
+			path += uri[i];
+		}
+	}
+
+	return path;
+}
+
+static bool DecodeBase64(const std::string& input, std::size_t offset, std::vector<uint8_t>& output)
+{
+	auto decodeChar = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+') return 62;
+		if (c == '/') return 63;
+		return -1;
+	};
+
+	output.reserve((input.size() - offset) / 4 * 3);
+
+	uint32_t bits = 0;
+	int numBits = 0;
+
+	for (std::size_t i = offset; i < input.size() && input[i] != '='; ++i)
+	{
+		int value = decodeChar(input[i]);
+		if (value < 0)
+			return false;
+
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		numBits += 6;
+
+		if (numBits >= 8)
+		{
+			numBits -= 8;
+			output.push_back(static_cast<uint8_t>((bits >> numBits) & 0xFF));
+		}
+	}
+
+	return true;
+}
+
+static bool LoadDataUri(const std::string& uri, std::vector<uint8_t>& output)
+{
+	std::size_t dataOffset = uri.find(";base64,");
+	if (dataOffset == std::string::npos)
+		return false;
+
+	return DecodeBase64(uri, dataOffset + 8, output);
+}
+
+static bool GetTextureInfoImage(const json& material, const char* key, const std::vector<int>& textureSources, int& outImage)
+{
+	outImage = -1;
+
+	auto textureInfo = material.find(key);
+	if (textureInfo == material.end())
+		return true;
+
+	int textureIndex = -1;
+	if (!GetIndex(*textureInfo, "index", textureSources.size(), textureIndex))
+		return false;
+
+	outImage = textureIndex >= 0 ? textureSources[textureIndex] : -1;
+	return true;
+}
+
+static bool MakeNodeTransform(const json& gltfNode, glm::mat4& outTransform)
+{
+	if (gltfNode.contains("matrix"))
+	{
+		float matrix[16];
+		if (!GetFloats(GetArray(gltfNode, "matrix"), matrix, 16))
+			return false;
+
+		for (uint32_t i = 0; i < 16; ++i)
+			outTransform[i / 4][i % 4] = matrix[i];
+
+		return true;
+	}
+
+	// Rotation is a quaternion stored as x, y, z, w
+	float translation[3] = { 0.0f, 0.0f, 0.0f };
+	float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float scale[3] = { 1.0f, 1.0f, 1.0f };
+
+	if (gltfNode.contains("translation") && !GetFloats(GetArray(gltfNode, "translation"), translation, 3))
+		return false;
+	if (gltfNode.contains("rotation") && !GetFloats(GetArray(gltfNode, "rotation"), rotation, 4))
+		return false;
+	if (gltfNode.contains("scale") && !GetFloats(GetArray(gltfNode, "scale"), scale, 3))
+		return false;
+
+	glm::mat4 translationMatrix = glm::translate(glm::identity<glm::mat4>(), glm::vec3(translation[0], translation[1], translation[2]));
+	glm::mat4 rotationMatrix = glm::mat4_cast(glm::fquat(rotation[3], rotation[0], rotation[1], rotation[2]));
+	glm::mat4 scaleMatrix = glm::scale(glm::identity<glm::mat4>(), glm::vec3(scale[0], scale[1], scale[2]));
+
+	outTransform = translationMatrix * rotationMatrix * scaleMatrix;
+	return true;
+}
+
+void GLTFAccessorView::ReadFloats(std::size_t index, float* out, uint32_t numComponents) const
+{
+	const uint8_t* element = Data + index * Stride;
+	uint32_t numComponentsToRead = std::min(numComponents, NumComponents);
+
+	for (uint32_t c = 0; c < numComponentsToRead; ++c)
+	{
+		switch (ComponentType)
+		{
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_FLOAT:
+		{
+			memcpy(&out[c], element + c * sizeof(float), sizeof(float));
+			break;
+		}
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		{
+			float value = static_cast<float>(element[c]);
+			out[c] = Normalized ? value / 255.0f : value;
+			break;
+		}
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_BYTE:
+		{
+			float value = static_cast<float>(static_cast<int8_t>(element[c]));
+			out[c] = Normalized ? std::max(value / 127.0f, -1.0f) : value;
+			break;
+		}
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+		{
+			uint16_t value;
+			memcpy(&value, element + c * sizeof(uint16_t), sizeof(uint16_t));
+			out[c] = Normalized ? value / 65535.0f : static_cast<float>(value);
+			break;
+		}
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_SHORT:
+		{
+			int16_t value;
+			memcpy(&value, element + c * sizeof(int16_t), sizeof(int16_t));
+			out[c] = Normalized ? std::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+			break;
+		}
+		case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_INT:
+		{
+			uint32_t value;
+			memcpy(&value, element + c * sizeof(uint32_t), sizeof(uint32_t));
+			out[c] = static_cast<float>(value);
+			break;
+		}
+		}
+	}
+
+	for (uint32_t c = numComponentsToRead; c < numComponents; ++c)
+		out[c] = 0.0f;
+}
+
+uint32_t GLTFAccessorView::ReadIndex(std::size_t index) const
+{
+	const uint8_t* element = Data + index * Stride;
+
+	switch (ComponentType)
+	{
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+	{
+		return static_cast<uint32_t>(*element);
+	}
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+	{
+		uint16_t value;
+		memcpy(&value, element, sizeof(uint16_t));
+		return static_cast<uint32_t>(value);
+	}
+	case GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_INT:
+	{
+		uint32_t value;
+		memcpy(&value, element, sizeof(uint32_t));
+		return value;
+	}
+	default:
+		break;
+	}
+
+	ASSERT(false, "Index accessor has an invalid component type");
+	return 0;
+}
+
+GLTFDocument::GLTFDocument(const std::string& filepath)
+{
+	m_BaseDir = filepath.substr(0, filepath.find_last_of("/\\") + 1);
+
+	auto file = std::make_unique<MappedFile>(filepath);
+	if (!file->IsValid())
+		return;
+
+	const uint8_t* fileData = file->GetData();
+	std::size_t fileByteSize = file->GetByteSize();
+
+	const char* jsonData = reinterpret_cast<const char*>(fileData);
+	std::size_t jsonByteSize = fileByteSize;
+	BufferRange glbBinaryChunk = {};
+
+	if (fileByteSize >= 12 && Read32(fileData) == GLB_MAGIC)
+	{
+		// GLB: 12 byte header, followed by a JSON chunk and an optional binary chunk, both with an 8 byte chunk header
+		uint32_t version = Read32(fileData + 4);
+		std::size_t length = std::min<std::size_t>(Read32(fileData + 8), fileByteSize);
+
+		if (version != GLB_VERSION || length < 20 || Read32(fileData + 16) != GLB_CHUNK_TYPE_JSON)
+		{
+			LOG_ERR("Invalid GLB header: {}", filepath);
+			return;
+		}
+
+		jsonData = reinterpret_cast<const char*>(fileData + 20);
+		jsonByteSize = Read32(fileData + 12);
+
+		std::size_t binChunkOffset = 20 + MathHelper::AlignUp<std::size_t>(jsonByteSize, 4);
+		if (binChunkOffset + 8 <= length && Read32(fileData + binChunkOffset + 4) == GLB_CHUNK_TYPE_BIN)
+		{
+			glbBinaryChunk.Data = fileData + binChunkOffset + 8;
+			glbBinaryChunk.ByteSize = std::min<std::size_t>(Read32(fileData + binChunkOffset), length - binChunkOffset - 8);
+		}
+
+		if (20 + jsonByteSize > length)
+		{
+			LOG_ERR("GLB JSON chunk exceeds the file size: {}", filepath);
+			return;
+		}
+	}
+
+	m_MappedFiles.push_back(std::move(file));
+	m_IsValid = Parse(jsonData, jsonByteSize, glbBinaryChunk);
+
+	if (!m_IsValid)
+		LOG_ERR("Failed to parse glTF file: {}", filepath);
+}
+
+GLTFDocument::~GLTFDocument()
+{
+	for (auto& image : m_Images)
+	{
+		if (image.Decoded.Data)
+			FileLoader::FreeImage(image.Decoded);
+	}
+}
+
+GLTFAccessorView GLTFDocument::GetAccessor(int accessorIndex) const
+{
+	GLTFAccessorView view;
+	if (accessorIndex < 0 || accessorIndex >= static_cast<int>(m_Accessors.size()))
+		return view;
+
+	const Accessor& accessor = m_Accessors[accessorIndex];
+	if (accessor.BufferView < 0)
+		return view;
+
+	const BufferView& bufferView = m_BufferViews[accessor.BufferView];
+	const BufferRange& buffer = m_Buffers[bufferView.Buffer];
+
+	view.Data = buffer.Data + bufferView.ByteOffset + accessor.ByteOffset;
+	view.Count = accessor.Count;
+	view.Stride = bufferView.ByteStride > 0 ? bufferView.ByteStride : GetComponentByteSize(accessor.ComponentType) * accessor.NumComponents;
+	view.ComponentType = accessor.ComponentType;
+	view.NumComponents = accessor.NumComponents;
+	view.Normalized = accessor.Normalized;
+	view.HasBounds = accessor.HasBounds;
+	view.Min = accessor.Min;
+	view.Max = accessor.Max;
+
+	return view;
+}
+
+const ImageInfo& GLTFDocument::AcquireImage(int imageIndex)
+{
+	Image& image = m_Images[imageIndex];
+	if (image.Decoded.Data)
+		return image.Decoded;
+
+	if (image.BufferView >= 0)
+	{
+		const BufferView& bufferView = m_BufferViews[image.BufferView];
+		const BufferRange& buffer = m_Buffers[bufferView.Buffer];
+
+		image.Decoded = FileLoader::LoadImageFromMemory(buffer.Data + bufferView.ByteOffset, bufferView.ByteLength);
+	}
+	else if (image.Uri.compare(0, 5, "data:") == 0)
+	{
+		std::vector<uint8_t> encodedImage;
+		if (LoadDataUri(image.Uri, encodedImage))
+			image.Decoded = FileLoader::LoadImageFromMemory(encodedImage.data(), encodedImage.size());
+	}
+	else
+	{
+		// External images are only mapped while decoding
+		MappedFile imageFile(m_BaseDir + DecodeUriPath(image.Uri));
+		if (imageFile.IsValid())
+			image.Decoded = FileLoader::LoadImageFromMemory(imageFile.GetData(), imageFile.GetByteSize());
+	}
+
+	return image.Decoded;
+}
+
+void GLTFDocument::ReleaseImage(int imageIndex)
+{
+	Image& image = m_Images[imageIndex];
+	if (image.RemainingUses > 0)
+		image.RemainingUses--;
+
+	if (image.RemainingUses == 0 && image.Decoded.Data)
+		FileLoader::FreeImage(image.Decoded);
+}
+
+bool GLTFDocument::Parse(const char* jsonData, std::size_t jsonByteSize, const BufferRange& glbBinaryChunk)
+{
+	json gltf = json::parse(jsonData, jsonData + jsonByteSize, nullptr, false);
+	if (gltf.is_discarded() || !gltf.is_object())
+		return false;
+
+	// Buffers
+	for (const json& gltfBuffer : GetArray(gltf, "buffers"))
+	{
+		std::size_t byteLength = GetNumber<std::size_t>(gltfBuffer, "byteLength", 0);
+		std::string uri = GetString(gltfBuffer, "uri");
+
+		BufferRange buffer = {};
+		if (uri.empty())
+		{
+			// Only the first buffer of a GLB file can refer to the binary chunk
+			if (m_Buffers.empty() && glbBinaryChunk.Data)
+				buffer = glbBinaryChunk;
+		}
+		else
+		{
+			buffer = LoadUri(uri);
+		}
+
+		if (!buffer.Data || buffer.ByteSize < byteLength)
+		{
+			LOG_ERR("glTF buffer is missing or smaller than its byte length: {}", uri);
+			return false;
+		}
+
+		buffer.ByteSize = byteLength;
+		m_Buffers.push_back(buffer);
+	}
+
+	// Buffer views
+	for (const json& gltfBufferView : GetArray(gltf, "bufferViews"))
+	{
+		BufferView bufferView;
+		if (!GetIndex(gltfBufferView, "buffer", m_Buffers.size(), bufferView.Buffer))
+			return false;
+
+		bufferView.ByteOffset = GetNumber<std::size_t>(gltfBufferView, "byteOffset", 0);
+		bufferView.ByteLength = GetNumber<std::size_t>(gltfBufferView, "byteLength", 0);
+		bufferView.ByteStride = GetNumber<std::size_t>(gltfBufferView, "byteStride", 0);
+
+		// Written so that huge offsets and lengths can not wrap around
+		if (bufferView.Buffer < 0 || bufferView.ByteLength > m_Buffers[bufferView.Buffer].ByteSize ||
+			bufferView.ByteOffset > m_Buffers[bufferView.Buffer].ByteSize - bufferView.ByteLength)
+		{
+			LOG_ERR("glTF buffer view exceeds its buffer");
+			return false;
+		}
+
+		m_BufferViews.push_back(bufferView);
+	}
+
+	// Accessors
+	for (const json& gltfAccessor : GetArray(gltf, "accessors"))
+	{
+		Accessor accessor;
+		if (!GetIndex(gltfAccessor, "bufferView", m_BufferViews.size(), accessor.BufferView))
+			return false;
+
+		accessor.ByteOffset = GetNumber<std::size_t>(gltfAccessor, "byteOffset", 0);
+		accessor.Count = GetNumber<std::size_t>(gltfAccessor, "count", 0);
+		accessor.ComponentType = static_cast<GLTFComponentType>(GetNumber<uint32_t>(gltfAccessor, "componentType", 0));
+		accessor.NumComponents = GetNumComponents(GetString(gltfAccessor, "type"));
+		accessor.Normalized = GetBool(gltfAccessor, "normalized", false);
+
+		// Bounds are optional, malformed ones are ignored like missing ones
+		float min[3], max[3];
+		if (GetFloats(GetArray(gltfAccessor, "min"), min, 3) && GetFloats(GetArray(gltfAccessor, "max"), max, 3))
+		{
+			accessor.HasBounds = true;
+			accessor.Min = glm::vec3(min[0], min[1], min[2]);
+			accessor.Max = glm::vec3(max[0], max[1], max[2]);
+		}
+
+		if (gltfAccessor.contains("sparse"))
+			LOG_WARN("Sparse glTF accessors are not supported, the sparse values are ignored");
+
+		if (accessor.BufferView >= 0 && accessor.Count > 0)
+		{
+			const BufferView& bufferView = m_BufferViews[accessor.BufferView];
+			std::size_t elementByteSize = GetComponentByteSize(accessor.ComponentType) * accessor.NumComponents;
+			std::size_t stride = bufferView.ByteStride > 0 ? bufferView.ByteStride : elementByteSize;
+
+			// Every element takes at least one byte of the buffer view, which keeps the size calculation below from overflowing
+			if (elementByteSize == 0 || accessor.Count > bufferView.ByteLength || stride > bufferView.ByteLength ||
+				accessor.ByteOffset > bufferView.ByteLength || accessor.ByteOffset + (accessor.Count - 1) * stride + elementByteSize > bufferView.ByteLength)
+			{
+				LOG_ERR("glTF accessor exceeds its buffer view");
+				return false;
+			}
+		}
+
+		m_Accessors.push_back(accessor);
+	}
+
+	// Images and textures, textures are resolved to their source image right away
+	for (const json& gltfImage : GetArray(gltf, "images"))
+	{
+		Image image;
+		image.Uri = GetString(gltfImage, "uri");
+
+		if (!GetIndex(gltfImage, "bufferView", m_BufferViews.size(), image.BufferView))
+			return false;
+
+		m_Images.push_back(image);
+	}
+
+	std::vector<int> textureSources;
+	for (const json& gltfTexture : GetArray(gltf, "textures"))
+	{
+		int source = -1;
+		if (!GetIndex(gltfTexture, "source", m_Images.size(), source))
+			return false;
+
+		textureSources.push_back(source);
+	}
+
+	// Materials
+	for (const json& gltfMaterial : GetArray(gltf, "materials"))
+	{
+		GLTFMaterial material;
+
+		auto pbr = gltfMaterial.find("pbrMetallicRoughness");
+		if (pbr != gltfMaterial.end())
+		{
+			if (!GetTextureInfoImage(*pbr, "baseColorTexture", textureSources, material.AlbedoImage) ||
+				!GetTextureInfoImage(*pbr, "metallicRoughnessTexture", textureSources, material.MetallicRoughnessImage))
+				return false;
+
+			material.MetallicFactor = GetNumber<float>(*pbr, "metallicFactor", 1.0f);
+			material.RoughnessFactor = GetNumber<float>(*pbr, "roughnessFactor", 1.0f);
+		}
+
+		if (!GetTextureInfoImage(gltfMaterial, "normalTexture", textureSources, material.NormalImage))
+			return false;
+
+		// Unknown alpha modes are opaque like a missing one
+		std::string alphaMode = GetString(gltfMaterial, "alphaMode");
+		if (alphaMode == "MASK")
+			material.AlphaMode = GLTFAlphaMode::GLTF_ALPHA_MODE_MASK;
+		else if (alphaMode == "BLEND")
+			material.AlphaMode = GLTFAlphaMode::GLTF_ALPHA_MODE_BLEND;
+
+		material.AlphaCutoff = GetNumber<float>(gltfMaterial, "alphaCutoff", 0.5f);
+
+		for (int imageIndex : { material.AlbedoImage, material.NormalImage, material.MetallicRoughnessImage })
+		{
+			if (imageIndex >= 0)
+				m_Images[imageIndex].RemainingUses++;
+		}
+
+		m_Materials.push_back(material);
+	}
+
+	// Meshes
+	for (const json& gltfMesh : GetArray(gltf, "meshes"))
+	{
+		GLTFMesh mesh;
+		mesh.Name = GetString(gltfMesh, "name");
+
+		for (const json& gltfPrimitive : GetArray(gltfMesh, "primitives"))
+		{
+			if (GetNumber<int>(gltfPrimitive, "mode", 4) != 4)
+				LOG_WARN("glTF primitive in mesh {} is not a triangle list, it will be interpreted as one", mesh.Name);
+
+			GLTFPrimitive primitive;
+			if (!GetIndex(gltfPrimitive, "indices", m_Accessors.size(), primitive.IndexAccessor) ||
+				!GetIndex(gltfPrimitive, "material", m_Materials.size(), primitive.Material))
+				return false;
+
+			auto attributes = gltfPrimitive.find("attributes");
+			if (attributes != gltfPrimitive.end())
+			{
+				if (!GetIndex(*attributes, "POSITION", m_Accessors.size(), primitive.PositionAccessor) ||
+					!GetIndex(*attributes, "NORMAL", m_Accessors.size(), primitive.NormalAccessor) ||
+					!GetIndex(*attributes, "TANGENT", m_Accessors.size(), primitive.TangentAccessor) ||
+					!GetIndex(*attributes, "TEXCOORD_0", m_Accessors.size(), primitive.TexCoordAccessor))
+					return false;
+			}
+
+			mesh.Primitives.push_back(primitive);
+		}
+
+		m_Meshes.push_back(mesh);
+	}
+
+	// Nodes and the root nodes of the default scene
+	const json& gltfNodes = GetArray(gltf, "nodes");
+	for (const json& gltfNode : gltfNodes)
+	{
+		GLTFNode node;
+		node.Name = GetString(gltfNode, "name");
+
+		if (!GetIndex(gltfNode, "mesh", m_Meshes.size(), node.Mesh))
+			return false;
+
+		if (!MakeNodeTransform(gltfNode, node.Transform))
+		{
+			LOG_ERR("glTF node {} has a malformed transform", node.Name);
+			return false;
+		}
+
+		if (!GetIndices(GetArray(gltfNode, "children"), gltfNodes.size(), node.Children))
+		{
+			LOG_ERR("glTF node {} has a child index that is out of range", node.Name);
+			return false;
+		}
+
+		m_Nodes.push_back(node);
+	}
+
+	if (!ValidateNodeHierarchy())
+		return false;
+
+	const json& scenes = GetArray(gltf, "scenes");
+	int defaultScene = -1;
+	if (!GetIndex(gltf, "scene", scenes.size(), defaultScene))
+		return false;
+
+	if (defaultScene < 0 && !scenes.empty())
+		defaultScene = 0;
+
+	if (defaultScene >= 0)
+	{
+		if (!GetIndices(GetArray(scenes[defaultScene], "nodes"), m_Nodes.size(), m_RootNodes))
+		{
+			LOG_ERR("glTF scene has a root node index that is out of range");
+			return false;
+		}
+	}
+	else
+	{
+		// Without scenes every node that is not the child of another node is a root
+		std::vector<bool> isChild(m_Nodes.size(), false);
+		for (const GLTFNode& node : m_Nodes)
+		{
+			for (std::size_t child : node.Children)
+				isChild[child] = true;
+		}
+
+		for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+		{
+			if (!isChild[i])
+				m_RootNodes.push_back(i);
+		}
+	}
+
+	return true;
+}
+
+bool GLTFDocument::ValidateNodeHierarchy() const
+{
+	// Nodes form disjoint trees, so every node has at most one parent, and every node with a parent is reachable from a node without one.
+	// Nodes that are not reachable that way are part of a cycle, which would make traversing the hierarchy loop forever
+	std::vector<uint32_t> numParents(m_Nodes.size(), 0);
+	for (const GLTFNode& node : m_Nodes)
+	{
+		for (std::size_t child : node.Children)
+		{
+			if (++numParents[child] > 1)
+			{
+				LOG_ERR("glTF node {} has more than one parent", child);
+				return false;
+			}
+		}
+	}
+
+	std::vector<std::size_t> stack;
+	for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+	{
+		if (numParents[i] == 0)
+			stack.push_back(i);
+	}
+
+	std::size_t numReachedNodes = 0;
+	while (!stack.empty())
+	{
+		std::size_t nodeIndex = stack.back();
+		stack.pop_back();
+		numReachedNodes++;
+
+		for (std::size_t child : m_Nodes[nodeIndex].Children)
+			stack.push_back(child);
+	}
+
+	if (numReachedNodes != m_Nodes.size())
+	{
+		LOG_ERR("glTF node hierarchy contains a cycle");
+		return false;
+	}
+
+	return true;
+}
+
+GLTFDocument::BufferRange GLTFDocument::LoadUri(const std::string& uri)
+{
+	BufferRange range = {};
+
+	if (uri.compare(0, 5, "data:") == 0)
+	{
+		std::vector<uint8_t> data;
+		if (!LoadDataUri(uri, data))
+			return range;
+
+		m_EmbeddedData.push_back(std::move(data));
+		range.Data = m_EmbeddedData.back().data();
+		range.ByteSize = m_EmbeddedData.back().size();
+	}
+	else
+	{
+		auto file = std::make_unique<MappedFile>(m_BaseDir + DecodeUriPath(uri));
+		if (!file->IsValid())
+			return range;
+
+		range.Data = file->GetData();
+		range.ByteSize = file->GetByteSize();
+		m_MappedFiles.push_back(std::move(file));
+	}
+
+	return range;
+}
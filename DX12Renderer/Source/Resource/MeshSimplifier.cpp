@@ -0,0 +1,451 @@
+#include "Pch.h"
+#include "Resource/MeshSimplifier.h"
+
+#include <numeric>
+
+// Meshes below this triangle count do not get any further levels of detail
+static constexpr std::size_t MIN_LOD_TRIANGLE_COUNT = 64;
+
+struct Quadric
+{
+	// Symmetric 3x3 matrix A, vector b and scalar c of the quadric form p^T A p + 2 b^T p + c
+	double A00 = 0.0, A01 = 0.0, A02 = 0.0, A11 = 0.0, A12 = 0.0, A22 = 0.0;
+	double B0 = 0.0, B1 = 0.0, B2 = 0.0;
+	double C = 0.0;
+
+	// Summed triangle area, used to turn the quadric error into a mean squared distance
+	double Weight = 0.0;
+};
+
+struct EdgeCollapse
+{
+	uint32_t From;
+	uint32_t To;
+	double Cost;
+};
+
+struct SimplifierState
+{
+	std::vector<glm::vec3> Positions;
+	std::vector<uint8_t> Locked;
+
+	// Carried over between levels of detail, so every level measures its error against the source surface
+	std::vector<Quadric> Quadrics;
+
+	// Scratch memory, reused by every pass
+	std::vector<uint32_t> TriangleOffsets;
+	std::vector<uint32_t> AdjacentTriangles;
+	std::vector<uint32_t> Remap;
+	std::vector<uint8_t> Touched;
+	std::vector<EdgeCollapse> BestCollapses;
+	std::vector<EdgeCollapse> Collapses;
+};
+
+struct InternalMeshSimplifierData
+{
+	std::mutex StatisticsMutex;
+	MeshSimplifierStatistics Stats;
+};
+
+static InternalMeshSimplifierData s_Data;
+
+static Quadric MakePlaneQuadric(const glm::dvec3& normal, double distance, double weight)
+{
+	Quadric quadric;
+	quadric.A00 = normal.x * normal.x * weight;
+	quadric.A01 = normal.x * normal.y * weight;
+	quadric.A02 = normal.x * normal.z * weight;
+	quadric.A11 = normal.y * normal.y * weight;
+	quadric.A12 = normal.y * normal.z * weight;
+	quadric.A22 = normal.z * normal.z * weight;
+	quadric.B0 = normal.x * distance * weight;
+	quadric.B1 = normal.y * distance * weight;
+	quadric.B2 = normal.z * distance * weight;
+	quadric.C = distance * distance * weight;
+	quadric.Weight = weight;
+
+	return quadric;
+}
+
+static void AddQuadric(Quadric& dest, const Quadric& source)
+{
+	dest.A00 += source.A00;
+	dest.A01 += source.A01;
+	dest.A02 += source.A02;
+	dest.A11 += source.A11;
+	dest.A12 += source.A12;
+	dest.A22 += source.A22;
+	dest.B0 += source.B0;
+	dest.B1 += source.B1;
+	dest.B2 += source.B2;
+	dest.C += source.C;
+	dest.Weight += source.Weight;
+}
+
+static double EvaluateQuadric(const Quadric& quadric, const glm::vec3& position)
+{
+	double x = position.x, y = position.y, z = position.z;
+
+	double error = quadric.A00 * x * x + quadric.A11 * y * y + quadric.A22 * z * z +
+		2.0 * (quadric.A01 * x * y + quadric.A02 * x * z + quadric.A12 * y * z) +
+		2.0 * (quadric.B0 * x + quadric.B1 * y + quadric.B2 * z) + quadric.C;
+
+	// Rounding can make the error slightly negative for points on all planes
+	return std::abs(error) / std::max(quadric.Weight, std::numeric_limits<double>::min());
+}
+
+static uint32_t HashPosition(const glm::vec3& position)
+{
+	uint32_t bits[3];
+	memcpy(bits, &position, sizeof(bits));
+
+	// Positive and negative zero compare equal, so they need to hash equally as well
+	for (uint32_t& b : bits)
+		b = b == 0x80000000 ? 0 : b;
+
+	return (bits[0] * 73856093) ^ (bits[1] * 19349663) ^ (bits[2] * 83492791);
+}
+
+static void BuildTriangleAdjacency(std::size_t numVertices, const uint32_t* indices, std::size_t numIndices,
+	std::vector<uint32_t>& triangleOffsets, std::vector<uint32_t>& adjacentTriangles)
+{
+	triangleOffsets.assign(numVertices + 1, 0);
+	for (std::size_t i = 0; i < numIndices; ++i)
+		triangleOffsets[indices[i] + 1]++;
+	for (std::size_t i = 0; i < numVertices; ++i)
+		triangleOffsets[i + 1] += triangleOffsets[i];
+
+	adjacentTriangles.resize(numIndices);
+	std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+
+	for (std::size_t i = 0; i < numIndices; ++i)
+		adjacentTriangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+}
+
+static void LockBorderAndSeamVertices(SimplifierState& state, const uint32_t* indices, std::size_t numIndices)
+{
+	const std::vector<glm::vec3>& positions = state.Positions;
+	std::size_t numVertices = positions.size();
+
+	// Vertices with equal positions are grouped, every group gets a single canonical vertex
+	std::size_t tableSize = 1;
+	while (tableSize < numVertices * 2)
+		tableSize *= 2;
+
+	std::vector<uint32_t> table(tableSize, std::numeric_limits<uint32_t>::max());
+	std::vector<uint32_t> canonical(numVertices);
+	std::vector<uint32_t> groupSizes(numVertices, 0);
+
+	for (uint32_t v = 0; v < numVertices; ++v)
+	{
+		std::size_t slot = HashPosition(positions[v]) & (tableSize - 1);
+		while (table[slot] != std::numeric_limits<uint32_t>::max() && positions[table[slot]] != positions[v])
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == std::numeric_limits<uint32_t>::max())
+			table[slot] = v;
+
+		canonical[v] = table[slot];
+		groupSizes[canonical[v]]++;
+	}
+
+	// Seams, the vertices of a group differ in their other attributes, so moving one of them would tear the mesh
+	std::vector<uint8_t>& locked = state.Locked;
+	for (std::size_t v = 0; v < numVertices; ++v)
+		locked[v] = groupSizes[canonical[v]] > 1;
+
+	// Open borders, an edge without its opposite edge only belongs to a single triangle
+	std::vector<uint32_t> canonicalIndices(numIndices);
+	for (std::size_t i = 0; i < numIndices; ++i)
+		canonicalIndices[i] = canonical[indices[i]];
+
+	BuildTriangleAdjacency(numVertices, canonicalIndices.data(), numIndices, state.TriangleOffsets, state.AdjacentTriangles);
+
+	for (std::size_t i = 0; i < numIndices; i += 3)
+	{
+		for (uint32_t e = 0; e < 3; ++e)
+		{
+			uint32_t a = canonicalIndices[i + e];
+			uint32_t b = canonicalIndices[i + (e + 1) % 3];
+			bool hasOppositeEdge = false;
+
+			for (uint32_t t = state.TriangleOffsets[b]; t < state.TriangleOffsets[b + 1] && !hasOppositeEdge; ++t)
+			{
+				const uint32_t* triangle = &canonicalIndices[state.AdjacentTriangles[t] * 3];
+				for (uint32_t f = 0; f < 3; ++f)
+					hasOppositeEdge |= triangle[f] == b && triangle[(f + 1) % 3] == a;
+			}
+
+			if (!hasOppositeEdge)
+			{
+				locked[a] = 1;
+				locked[b] = 1;
+			}
+		}
+	}
+
+	// Every vertex of a locked group is locked, not only the canonical one
+	for (std::size_t v = 0; v < numVertices; ++v)
+		locked[v] |= locked[canonical[v]];
+}
+
+static void InitializeState(SimplifierState& state, const MeshSimplifierInput& input)
+{
+	std::size_t numVertices = input.NumVertices;
+
+	state.Positions.resize(numVertices);
+	for (std::size_t i = 0; i < numVertices; ++i)
+		memcpy(&state.Positions[i], input.Vertices + i * input.VertexStride + input.PositionOffset, sizeof(glm::vec3));
+
+	state.Locked.assign(numVertices, 0);
+	LockBorderAndSeamVertices(state, input.Indices, input.NumIndices);
+
+	// Every vertex starts with the area weighted planes of the triangles around it
+	state.Quadrics.assign(numVertices, Quadric());
+
+	for (std::size_t i = 0; i < input.NumIndices; i += 3)
+	{
+		glm::dvec3 p0 = state.Positions[input.Indices[i]];
+		glm::dvec3 p1 = state.Positions[input.Indices[i + 1]];
+		glm::dvec3 p2 = state.Positions[input.Indices[i + 2]];
+
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double length = glm::length(normal);
+		if (length == 0.0)
+			continue;
+
+		normal /= length;
+		Quadric quadric = MakePlaneQuadric(normal, -glm::dot(normal, p0), length * 0.5);
+
+		for (uint32_t v = 0; v < 3; ++v)
+			AddQuadric(state.Quadrics[input.Indices[i + v]], quadric);
+	}
+
+	state.Remap.resize(numVertices);
+	state.Touched.resize(numVertices);
+	state.BestCollapses.resize(numVertices);
+}
+
+static bool CollapseFlipsTriangles(const SimplifierState& state, const std::vector<uint32_t>& indices,
+	const uint32_t* adjacentTriangles, std::size_t numAdjacentTriangles, const EdgeCollapse& collapse)
+{
+	const std::vector<glm::vec3>& positions = state.Positions;
+
+	for (std::size_t i = 0; i < numAdjacentTriangles; ++i)
+	{
+		// Neighbors might have been collapsed earlier in the same pass, so the triangle is checked in its current state
+		const uint32_t* triangle = &indices[adjacentTriangles[i] * 3];
+		uint32_t v[3] = { state.Remap[triangle[0]], state.Remap[triangle[1]], state.Remap[triangle[2]] };
+
+		// Triangles on the collapsed edge are removed entirely
+		if (v[0] == collapse.To || v[1] == collapse.To || v[2] == collapse.To || v[0] == v[1] || v[1] == v[2] || v[0] == v[2])
+			continue;
+
+		glm::vec3 p[3] = { positions[v[0]], positions[v[1]], positions[v[2]] };
+		glm::vec3 normalBefore = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			if (v[j] == collapse.From)
+				p[j] = positions[collapse.To];
+		}
+
+		glm::vec3 normalAfter = glm::cross(p[1] - p[0], p[2] - p[0]);
+		if (glm::dot(normalBefore, normalAfter) <= 0.0f)
+			return true;
+	}
+
+	return false;
+}
+
+// Returns the highest cost of all performed collapses
+static double SimplifyIndices(SimplifierState& state, std::vector<uint32_t>& indices, std::size_t targetIndexCount, double maxCost)
+{
+	std::size_t numVertices = state.Positions.size();
+	double maxCollapseCost = 0.0;
+
+	targetIndexCount -= targetIndexCount % 3;
+
+	while (indices.size() > targetIndexCount)
+	{
+		std::size_t numTriangles = indices.size() / 3;
+
+		// Rebuilt every pass since collapses change the topology
+		BuildTriangleAdjacency(numVertices, indices.data(), indices.size(), state.TriangleOffsets, state.AdjacentTriangles);
+
+		// Every unlocked vertex picks its cheapest collapse, locked vertices can only be collapsed onto
+		std::fill(state.BestCollapses.begin(), state.BestCollapses.end(), EdgeCollapse{ 0, 0, std::numeric_limits<double>::max() });
+
+		for (std::size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				uint32_t a = indices[i + e];
+				uint32_t b = indices[i + (e + 1) % 3];
+
+				for (const auto& [from, to] : { std::pair(a, b), std::pair(b, a) })
+				{
+					if (state.Locked[from])
+						continue;
+
+					// Evaluating both quadrics separately is the same as evaluating their sum
+					const Quadric& fromQuadric = state.Quadrics[from];
+					const Quadric& toQuadric = state.Quadrics[to];
+
+					double weight = fromQuadric.Weight + toQuadric.Weight;
+					double cost = (EvaluateQuadric(fromQuadric, state.Positions[to]) * fromQuadric.Weight +
+						EvaluateQuadric(toQuadric, state.Positions[to]) * toQuadric.Weight) / std::max(weight, std::numeric_limits<double>::min());
+
+					if (cost < state.BestCollapses[from].Cost)
+						state.BestCollapses[from] = { from, to, cost };
+				}
+			}
+		}
+
+		state.Collapses.clear();
+		for (const EdgeCollapse& collapse : state.BestCollapses)
+		{
+			// Locked vertices and vertices without triangles keep their empty candidate
+			if (collapse.From != collapse.To && collapse.Cost <= maxCost)
+				state.Collapses.push_back(collapse);
+		}
+
+		std::sort(state.Collapses.begin(), state.Collapses.end(), [](const EdgeCollapse& lhs, const EdgeCollapse& rhs) {
+			return lhs.Cost != rhs.Cost ? lhs.Cost < rhs.Cost : lhs.From < rhs.From;
+		});
+
+		// Cheapest collapses first, a vertex can only be part of a single collapse per pass
+		std::iota(state.Remap.begin(), state.Remap.end(), 0);
+		std::fill(state.Touched.begin(), state.Touched.end(), 0);
+
+		std::size_t trianglesToRemove = numTriangles - targetIndexCount / 3;
+		std::size_t numRemovedTriangles = 0;
+		std::size_t numCollapses = 0;
+
+		for (const EdgeCollapse& collapse : state.Collapses)
+		{
+			if (numRemovedTriangles >= trianglesToRemove)
+				break;
+
+			if (state.Touched[collapse.From] || state.Touched[collapse.To])
+				continue;
+
+			const uint32_t* fromTriangles = &state.AdjacentTriangles[state.TriangleOffsets[collapse.From]];
+			std::size_t numFromTriangles = state.TriangleOffsets[collapse.From + 1] - state.TriangleOffsets[collapse.From];
+
+			if (CollapseFlipsTriangles(state, indices, fromTriangles, numFromTriangles, collapse))
+				continue;
+
+			// Usually the two triangles sharing the edge, the exact count is only known once the indices are remapped
+			for (std::size_t i = 0; i < numFromTriangles; ++i)
+			{
+				const uint32_t* triangle = &indices[fromTriangles[i] * 3];
+				if (state.Remap[triangle[0]] == collapse.To || state.Remap[triangle[1]] == collapse.To || state.Remap[triangle[2]] == collapse.To)
+					numRemovedTriangles++;
+			}
+
+			state.Remap[collapse.From] = collapse.To;
+			state.Touched[collapse.From] = 1;
+			state.Touched[collapse.To] = 1;
+			AddQuadric(state.Quadrics[collapse.To], state.Quadrics[collapse.From]);
+
+			maxCollapseCost = std::max(maxCollapseCost, collapse.Cost);
+			numCollapses++;
+		}
+
+		if (numCollapses == 0)
+			break;
+
+		// Apply the collapses and remove the triangles that became degenerate
+		std::size_t numWrittenIndices = 0;
+
+		for (std::size_t i = 0; i < indices.size(); i += 3)
+		{
+			uint32_t a = state.Remap[indices[i]];
+			uint32_t b = state.Remap[indices[i + 1]];
+			uint32_t c = state.Remap[indices[i + 2]];
+
+			if (a == b || b == c || a == c)
+				continue;
+
+			indices[numWrittenIndices++] = a;
+			indices[numWrittenIndices++] = b;
+			indices[numWrittenIndices++] = c;
+		}
+
+		indices.resize(numWrittenIndices);
+	}
+
+	return maxCollapseCost;
+}
+
+MeshSimplifierResult MeshSimplifier::Simplify(const MeshSimplifierInput& input, std::size_t targetIndexCount, float maxError)
+{
+	ASSERT(input.NumIndices % 3 == 0, "Mesh simplification only supports triangle lists");
+
+	SimplifierState state;
+	InitializeState(state, input);
+
+	MeshSimplifierResult result;
+	result.Indices.assign(input.Indices, input.Indices + input.NumIndices);
+
+	double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+	result.Error = static_cast<float>(std::sqrt(SimplifyIndices(state, result.Indices, targetIndexCount, maxCost)));
+
+	return result;
+}
+
+std::vector<MeshSimplifierResult> MeshSimplifier::GenerateLODChain(const MeshSimplifierInput& input, uint32_t maxLODs)
+{
+	ASSERT(input.NumIndices % 3 == 0, "Mesh simplification only supports triangle lists");
+
+	auto start = std::chrono::steady_clock::now();
+
+	// Locks and quadrics are computed once for the source mesh and shared by all levels
+	SimplifierState state;
+	InitializeState(state, input);
+
+	std::vector<MeshSimplifierResult> lods;
+	std::vector<uint32_t> levelIndices(input.Indices, input.Indices + input.NumIndices);
+	uint64_t numLODTriangles = 0;
+	float error = 0.0f;
+
+	while (lods.size() < maxLODs && levelIndices.size() / 3 >= MIN_LOD_TRIANGLE_COUNT)
+	{
+		std::size_t previousIndexCount = levelIndices.size();
+		double maxCollapseCost = SimplifyIndices(state, levelIndices, previousIndexCount / 2, std::numeric_limits<double>::max());
+
+		// A level that barely removes any triangles is not worth switching to, locked vertices are usually the reason
+		if (levelIndices.size() * 5 > previousIndexCount * 4)
+			break;
+
+		error = std::max(error, static_cast<float>(std::sqrt(maxCollapseCost)));
+		numLODTriangles += levelIndices.size() / 3;
+
+		MeshSimplifierResult& lod = lods.emplace_back();
+		lod.Indices = levelIndices;
+		lod.Error = error;
+	}
+
+	float duration = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	s_Data.Stats.NumSourceTriangles += input.NumIndices / 3;
+	s_Data.Stats.NumLODTriangles += numLODTriangles;
+	s_Data.Stats.NumLODs += static_cast<uint32_t>(lods.size());
+	s_Data.Stats.SimplifyTime += duration;
+
+	return lods;
+}
+
+MeshSimplifierStatistics MeshSimplifier::GetStatistics()
+{
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	return s_Data.Stats;
+}
+
+void MeshSimplifier::ResetStatistics()
+{
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	s_Data.Stats = MeshSimplifierStatistics();
+}
@@ -0,0 +1,365 @@
+#include "Pch.h"
+#include "Resource/ModelImporter.h"
+#include "Resource/GLTFDocument.h"
+#include "Resource/TangentGenerator.h"
+#include "Resource/MeshSimplifier.h"
+#include "Util/JobSystem.h"
+
+static void LogGeometryProcessing(const ImportedGeometry& geometry, const TangentGeneratorStatistics& tangentStatsBefore,
+	const MeshSimplifierStatistics& simplifierStatsBefore, float wallTime)
+{
+	// Job times are summed over all workers, so they are reported as CPU time per million triangles
+	TangentGeneratorStatistics tangentStats = TangentGenerator::GetStatistics();
+	MeshSimplifierStatistics simplifierStats = MeshSimplifier::GetStatistics();
+
+	uint64_t numTangentTriangles = (tangentStats.NumTrianglesGenerated + tangentStats.NumTrianglesFromCache) -
+		(tangentStatsBefore.NumTrianglesGenerated + tangentStatsBefore.NumTrianglesFromCache);
+	uint64_t numSourceTriangles = simplifierStats.NumSourceTriangles - simplifierStatsBefore.NumSourceTriangles;
+
+	float tangentTime = tangentStats.GenerationTime - tangentStatsBefore.GenerationTime;
+	float simplifyTime = simplifierStats.SimplifyTime - simplifierStatsBefore.SimplifyTime;
+
+	LOG_INFO("[ModelImporter] Processed geometry in {} ms on {} workers", wallTime, JobSystem::GetNumWorkers());
+
+	if (numTangentTriangles > 0)
+	{
+		LOG_INFO("[ModelImporter] Tangents: {} triangles, {} ms CPU ({} ms per million triangles)", numTangentTriangles, tangentTime,
+			tangentTime / (numTangentTriangles / 1000000.0f));
+	}
+
+	if (numSourceTriangles > 0)
+	{
+		LOG_INFO("[ModelImporter] LOD chains: {} triangles, {} ms CPU ({} ms per million triangles)", numSourceTriangles, simplifyTime,
+			simplifyTime / (numSourceTriangles / 1000000.0f));
+	}
+
+	// Simplification quality per level, the error is relative to the bounding box diagonal of each primitive
+	for (uint32_t lod = 0; lod < ModelImporter::MAX_MESH_LODS; ++lod)
+	{
+		uint64_t numPrimitives = 0, numLevelSourceTriangles = 0, numLevelTriangles = 0;
+		float maxRelativeError = 0.0f;
+
+		for (const ImportedPrimitive& primitive : geometry.Primitives)
+		{
+			if (lod >= primitive.LODs.size())
+				continue;
+
+			float diagonal = std::max(glm::length(primitive.MaxBounds - primitive.MinBounds), std::numeric_limits<float>::min());
+
+			numPrimitives++;
+			numLevelSourceTriangles += primitive.Indices.size() / 3;
+			numLevelTriangles += primitive.LODs[lod].Indices.size() / 3;
+			maxRelativeError = std::max(maxRelativeError, primitive.LODs[lod].Error / diagonal);
+		}
+
+		if (numPrimitives == 0)
+			break;
+
+		LOG_INFO("[ModelImporter] LOD{}: {} primitives, {}% of triangles, max error {}% of bounds", lod + 1, numPrimitives,
+			100.0f * numLevelTriangles / numLevelSourceTriangles, 100.0f * maxRelativeError);
+	}
+
+	uint64_t numVertices = 0, positionBytes = 0, attributeBytes = 0;
+	for (const ImportedPrimitive& primitive : geometry.Primitives)
+	{
+		numVertices += primitive.NumVertices;
+		positionBytes += primitive.PositionStream.size();
+		attributeBytes += primitive.AttributeStream.size() * sizeof(VertexAttributes);
+	}
+
+	if (numVertices > 0)
+	{
+		LOG_INFO("[ModelImporter] Vertex streams: {} vertices, {} KB positions and {} KB attributes, depth-only passes read {} instead of {} bytes per vertex",
+			numVertices, positionBytes / 1024, attributeBytes / 1024, positionBytes / numVertices, sizeof(Vertex));
+	}
+}
+
+ImportedGeometry ModelImporter::ReadGeometry(const GLTFDocument& document)
+{
+	ImportedGeometry geometry;
+	std::vector<ImportedPrimitive>& primitives = geometry.Primitives;
+
+	for (const GLTFMesh& gltfMesh : document.GetMeshes())
+	{
+		geometry.MeshFirstPrimitive.push_back(primitives.size());
+
+		for (std::size_t primIndex = 0; primIndex < gltfMesh.Primitives.size(); ++primIndex)
+		{
+			const GLTFPrimitive& gltfPrim = gltfMesh.Primitives[primIndex];
+
+			// Malformed primitives are skipped, the rest of the model is still imported
+			auto rejectPrimitive = [&gltfMesh, primIndex](const char* reason) {
+				LOG_WARN("[ModelImporter] Skipped primitive {} of mesh {}: {}", primIndex, gltfMesh.Name, reason);
+			};
+
+			// Accessor views point straight into the mapped buffers
+			GLTFAccessorView positions = document.GetAccessor(gltfPrim.PositionAccessor);
+			if (!positions.IsValid() || positions.Count == 0 || positions.NumComponents < 3)
+			{
+				rejectPrimitive("POSITION is missing or has less than 3 components");
+				continue;
+			}
+
+			if (positions.Count > std::numeric_limits<uint32_t>::max())
+			{
+				rejectPrimitive("more vertices than 32-bit indices can address");
+				continue;
+			}
+
+			// Every vertex reads an element of each attribute, so the attributes need at least as many elements as there are positions
+			GLTFAccessorView texCoords = document.GetAccessor(gltfPrim.TexCoordAccessor);
+			if (!texCoords.IsValid() || texCoords.Count < positions.Count || texCoords.NumComponents < 2)
+			{
+				rejectPrimitive("TEXCOORD_0 is missing, has less than 2 components or less elements than POSITION");
+				continue;
+			}
+
+			GLTFAccessorView normals = document.GetAccessor(gltfPrim.NormalAccessor);
+			if (!normals.IsValid() || normals.Count < positions.Count || normals.NumComponents < 3)
+			{
+				rejectPrimitive("NORMAL is missing, has less than 3 components or less elements than POSITION");
+				continue;
+			}
+
+			// Unusable tangents are generated like missing ones
+			GLTFAccessorView tangents = document.GetAccessor(gltfPrim.TangentAccessor);
+			bool hasTangents = tangents.IsValid() && tangents.Count >= positions.Count && tangents.NumComponents >= 4;
+
+			// Indices have to be unsigned integer scalars that form whole triangles of existing vertices
+			GLTFAccessorView indexView = document.GetAccessor(gltfPrim.IndexAccessor);
+			if (gltfPrim.IndexAccessor >= 0)
+			{
+				bool isIndexType = indexView.ComponentType == GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_BYTE ||
+					indexView.ComponentType == GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_SHORT ||
+					indexView.ComponentType == GLTFComponentType::GLTF_COMPONENT_TYPE_UNSIGNED_INT;
+
+				if (!indexView.IsValid() || !isIndexType || indexView.NumComponents != 1)
+				{
+					rejectPrimitive("indices are not unsigned integer scalars");
+					continue;
+				}
+			}
+
+			std::size_t numIndices = indexView.IsValid() ? indexView.Count : positions.Count;
+			if (numIndices == 0 || numIndices % 3 != 0)
+			{
+				rejectPrimitive("the number of indices is not a multiple of 3");
+				continue;
+			}
+
+			TrackedVector<uint32_t, MEMORY_TAG_ASSETS> indices;
+			indices.resize(numIndices);
+
+			// Get index data, non-indexed primitives get a sequential index buffer
+			bool hasValidIndices = true;
+			for (std::size_t i = 0; i < numIndices; ++i)
+			{
+				indices[i] = indexView.IsValid() ? indexView.ReadIndex(i) : static_cast<uint32_t>(i);
+				hasValidIndices &= indices[i] < positions.Count;
+			}
+
+			if (!hasValidIndices)
+			{
+				rejectPrimitive("an index refers to a vertex that does not exist");
+				continue;
+			}
+
+			ImportedPrimitive& primitive = primitives.emplace_back();
+			primitive.HasTangents = hasTangents;
+			primitive.Indices = std::move(indices);
+
+			auto& vertices = primitive.Vertices;
+			vertices.resize(positions.Count);
+
+			// Interleave all vertex attributes in a single pass over the strided views
+			for (std::size_t i = 0; i < positions.Count; ++i)
+			{
+				Vertex& v = vertices[i];
+				positions.ReadFloats(i, &v.Position.x, 3);
+				texCoords.ReadFloats(i, &v.TexCoord.x, 2);
+				normals.ReadFloats(i, &v.Normal.x, 3);
+
+				if (primitive.HasTangents)
+				{
+					glm::vec4 tangent;
+					tangents.ReadFloats(i, &tangent.x, 4);
+
+					v.Tangent = glm::normalize(glm::vec3(tangent));
+					v.Bitangent = glm::normalize(glm::cross(v.Normal, v.Tangent) * tangent.w);
+				}
+			}
+
+			// Set the min and max bounds for the current primitive/mesh
+			primitive.MinBounds = positions.Min;
+			primitive.MaxBounds = positions.Max;
+
+			if (!positions.HasBounds)
+			{
+				primitive.MinBounds = glm::vec3(std::numeric_limits<float>::max());
+				primitive.MaxBounds = glm::vec3(std::numeric_limits<float>::lowest());
+
+				for (const Vertex& v : vertices)
+				{
+					primitive.MinBounds = glm::min(primitive.MinBounds, v.Position);
+					primitive.MaxBounds = glm::max(primitive.MaxBounds, v.Position);
+				}
+			}
+
+			primitive.DebugName = gltfMesh.Name + std::to_string(primitives.size() - 1);
+			primitive.Material = gltfPrim.Material;
+		}
+	}
+
+	geometry.MeshFirstPrimitive.push_back(primitives.size());
+	return geometry;
+}
+
+void ModelImporter::ProcessGeometry(ImportedGeometry& geometry, VertexPositionFormat positionFormat)
+{
+	// Missing tangents and the LOD chains are generated in parallel, every primitive gets independent jobs
+	auto geometryStart = std::chrono::steady_clock::now();
+	TangentGeneratorStatistics tangentStatsBefore = TangentGenerator::GetStatistics();
+	MeshSimplifierStatistics simplifierStatsBefore = MeshSimplifier::GetStatistics();
+	JobCounter geometryJobs;
+
+	for (ImportedPrimitive& primitive : geometry.Primitives)
+	{
+		if (!primitive.HasTangents)
+		{
+			JobSystem::Execute(geometryJobs, [&primitive]()
+			{
+				TangentGeneratorInput input = {};
+				input.Vertices = reinterpret_cast<uint8_t*>(primitive.Vertices.data());
+				input.VertexStride = sizeof(Vertex);
+				input.NumVertices = primitive.Vertices.size();
+				input.PositionOffset = offsetof(Vertex, Position);
+				input.NormalOffset = offsetof(Vertex, Normal);
+				input.TexCoordOffset = offsetof(Vertex, TexCoord);
+				input.TangentOffset = offsetof(Vertex, Tangent);
+				input.BitangentOffset = offsetof(Vertex, Bitangent);
+				input.Indices = primitive.Indices.data();
+				input.NumIndices = primitive.Indices.size();
+
+				TangentGenerator::Generate(input);
+			});
+		}
+
+		// Simplification only reads positions, so it can run next to the tangent job of the same primitive
+		JobSystem::Execute(geometryJobs, [&primitive]()
+		{
+			MeshSimplifierInput input = {};
+			input.Vertices = reinterpret_cast<const uint8_t*>(primitive.Vertices.data());
+			input.VertexStride = sizeof(Vertex);
+			input.NumVertices = primitive.Vertices.size();
+			input.PositionOffset = offsetof(Vertex, Position);
+			input.Indices = primitive.Indices.data();
+			input.NumIndices = primitive.Indices.size();
+
+			primitive.LODs = MeshSimplifier::GenerateLODChain(input, ModelImporter::MAX_MESH_LODS);
+		});
+	}
+
+	JobSystem::Wait(geometryJobs);
+
+	// The attribute stream needs the generated tangents, so the streams are built once every primitive is done
+	for (ImportedPrimitive& primitive : geometry.Primitives)
+		JobSystem::Execute(geometryJobs, [&primitive, positionFormat]() { BuildVertexStreams(primitive, positionFormat); });
+
+	JobSystem::Wait(geometryJobs);
+	LogGeometryProcessing(geometry, tangentStatsBefore, simplifierStatsBefore,
+		std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - geometryStart).count());
+}
+
+uint32_t ModelImporter::GetPositionByteSize(VertexPositionFormat format)
+{
+	switch (format)
+	{
+	case VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3:
+		return sizeof(glm::vec3);
+	case VertexPositionFormat::VERTEX_POSITION_FORMAT_UNORM16:
+		return sizeof(QuantizedPosition);
+	default:
+		ASSERT(false, "Unknown vertex position format");
+		return 0;
+	}
+}
+
+void ModelImporter::BuildVertexStreams(ImportedPrimitive& primitive, VertexPositionFormat positionFormat)
+{
+	const auto& vertices = primitive.Vertices;
+	std::size_t numVertices = vertices.size();
+
+	primitive.NumVertices = numVertices;
+	primitive.PositionFormat = positionFormat;
+	primitive.PositionStream.resize(numVertices * GetPositionByteSize(positionFormat));
+	primitive.AttributeStream.resize(numVertices);
+
+	for (std::size_t i = 0; i < numVertices; ++i)
+	{
+		VertexAttributes& attributes = primitive.AttributeStream[i];
+		attributes.TexCoord = vertices[i].TexCoord;
+		attributes.Normal = vertices[i].Normal;
+		attributes.Tangent = vertices[i].Tangent;
+		attributes.Bitangent = vertices[i].Bitangent;
+	}
+
+	if (positionFormat == VertexPositionFormat::VERTEX_POSITION_FORMAT_FLOAT3)
+	{
+		glm::vec3* positions = reinterpret_cast<glm::vec3*>(primitive.PositionStream.data());
+		for (std::size_t i = 0; i < numVertices; ++i)
+			positions[i] = vertices[i].Position;
+
+		primitive.PositionScale = glm::vec3(1.0f);
+		primitive.PositionOffset = glm::vec3(0.0f);
+	}
+	else
+	{
+		// The bounds of the accessor are not guaranteed to be exact, so the quantization range comes from the positions themselves
+		glm::vec3 minPosition = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 maxPosition = glm::vec3(std::numeric_limits<float>::lowest());
+
+		for (const Vertex& v : vertices)
+		{
+			minPosition = glm::min(minPosition, v.Position);
+			maxPosition = glm::max(maxPosition, v.Position);
+		}
+
+		if (numVertices == 0)
+			minPosition = maxPosition = glm::vec3(0.0f);
+
+		// Flat axes have no extent, all their positions quantize to zero and the offset alone restores them
+		glm::vec3 extent = maxPosition - minPosition;
+		glm::vec3 invExtent = glm::vec3(extent.x > 0.0f ? 1.0f / extent.x : 0.0f, extent.y > 0.0f ? 1.0f / extent.y : 0.0f, extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+		QuantizedPosition* positions = reinterpret_cast<QuantizedPosition*>(primitive.PositionStream.data());
+		for (std::size_t i = 0; i < numVertices; ++i)
+		{
+			glm::vec3 normalized = glm::clamp((vertices[i].Position - minPosition) * invExtent, 0.0f, 1.0f);
+			glm::vec3 quantized = glm::round(normalized * 65535.0f);
+
+			positions[i].X = static_cast<uint16_t>(quantized.x);
+			positions[i].Y = static_cast<uint16_t>(quantized.y);
+			positions[i].Z = static_cast<uint16_t>(quantized.z);
+			positions[i].W = 0;
+		}
+
+		primitive.PositionScale = extent;
+		primitive.PositionOffset = minPosition;
+	}
+
+	primitive.Vertices.clear();
+	primitive.Vertices.shrink_to_fit();
+}
+
+TransparencyMode ModelImporter::GetTransparencyMode(GLTFAlphaMode alphaMode)
+{
+	switch (alphaMode)
+	{
+	case GLTFAlphaMode::GLTF_ALPHA_MODE_MASK:
+		return TransparencyMode::MASKED;
+	case GLTFAlphaMode::GLTF_ALPHA_MODE_BLEND:
+		return TransparencyMode::TRANSPARENT;
+	default:
+		return TransparencyMode::OPAQUE;
+	}
+}
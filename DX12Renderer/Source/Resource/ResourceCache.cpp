@@ -0,0 +1,477 @@
+#include "Pch.h"
+#include "Resource/ResourceCache.h"
+#include "Graphics/Renderer.h"
+
+// The portable core (see CMakeLists.txt) is built without ImGui
+#if !defined(DX12R_PORTABLE_CORE)
+#include <imgui/imgui.h>
+#endif
+
+struct CacheEntry
+{
+	RenderResourceHandle Handle = {};
+	uint32_t RefCount = 0;
+
+	// Descriptor key and payload size of the resource, a hit has to match both so a hash collision never returns the wrong resource
+	std::vector<unsigned char> Key;
+	std::size_t PayloadByteSize = 0;
+
+	// References this entry holds on other cached resources, released together with the entry
+	std::vector<std::pair<CachedResourceType, RenderResourceHandle>> Dependencies;
+};
+
+struct ResourceTypeCache
+{
+	std::unordered_map<Hash128, CacheEntry, Hash128Hasher> Entries;
+	std::unordered_map<uint64_t, Hash128> HandleToHash;
+
+	// Resources whose hash collided with a different cached resource, they are never returned by a lookup but are reference counted the same way
+	std::unordered_map<uint64_t, CacheEntry> UncachedEntries;
+};
+
+struct InternalResourceCacheData
+{
+	std::array<ResourceTypeCache, static_cast<std::size_t>(CachedResourceType::CACHED_RESOURCE_TYPE_NUM_TYPES)> Caches;
+	ResourceCacheStatistics Stats;
+
+	std::mutex Mutex;
+};
+
+static InternalResourceCacheData s_Data;
+
+// Descriptor keys only use 64-bit fields so there is no uninitialized padding in the hashed bytes
+struct BufferKey
+{
+	uint64_t Usage;
+	uint64_t NumElements;
+	uint64_t ElementSize;
+};
+
+struct TextureKey
+{
+	uint64_t Usage;
+	uint64_t Format;
+	uint64_t Dimension;
+	uint64_t Width;
+	uint64_t Height;
+	uint64_t NumMips;
+};
+
+struct MaterialKey
+{
+	uint64_t AlbedoTexture;
+	uint64_t NormalTexture;
+	uint64_t MetallicRoughnessTexture;
+	float Metalness;
+	float Roughness;
+	float AlphaCutoff;
+	uint32_t Transparency;
+};
+
+struct MeshKey
+{
+	uint64_t PositionBuffer;
+	uint64_t AttributeBuffer;
+	uint64_t IndexBuffer;
+	uint64_t Material;
+	glm::vec4 BBMin;
+	glm::vec4 BBMax;
+	glm::vec4 PositionScale;
+	glm::vec4 PositionOffset;
+};
+
+static std::size_t GetTextureDataByteSize(const TextureDesc& desc)
+{
+	return static_cast<std::size_t>(desc.Width) * desc.Height * GetTextureFormatByteSize(desc.Format);
+}
+
+static ResourceTypeCache& GetTypeCache(CachedResourceType type)
+{
+	return s_Data.Caches[static_cast<std::size_t>(type)];
+}
+
+template<typename Key_t>
+static bool IsSameResource(const CacheEntry& entry, const Key_t& key, std::size_t payloadByteSize)
+{
+	return entry.Key.size() == sizeof(Key_t) && memcmp(entry.Key.data(), &key, sizeof(Key_t)) == 0 && entry.PayloadByteSize == payloadByteSize;
+}
+
+template<typename Key_t>
+static bool FindAndAddRef(CachedResourceType type, const Hash128& hash, const Key_t& key, std::size_t payloadByteSize, RenderResourceHandle& outHandle)
+{
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+	ResourceTypeCache& cache = GetTypeCache(type);
+
+	auto iter = cache.Entries.find(hash);
+	if (iter == cache.Entries.end())
+	{
+		s_Data.Stats.NumMisses++;
+		return false;
+	}
+
+	if (!IsSameResource(iter->second, key, payloadByteSize))
+	{
+		LOG_WARN("[ResourceCache] Hash collision between two different resources, the new resource is not cached");
+		s_Data.Stats.NumCollisions++;
+		s_Data.Stats.NumMisses++;
+		return false;
+	}
+
+	iter->second.RefCount++;
+	outHandle = iter->second.Handle;
+	s_Data.Stats.NumHits++;
+
+	return true;
+}
+
+static void DestroyResource(CachedResourceType type, RenderResourceHandle handle);
+
+// Returns the handle to use, every path takes ownership of the new resource and the references in dependencies
+// On a collision with a different resource the new resource is returned and tracked as uncached, so Release still frees it
+template<typename Key_t>
+static RenderResourceHandle InsertEntry(CachedResourceType type, const Hash128& hash, const Key_t& key, std::size_t payloadByteSize, RenderResourceHandle handle,
+	std::vector<std::pair<CachedResourceType, RenderResourceHandle>>&& dependencies = {})
+{
+	RenderResourceHandle existingHandle = {};
+
+	{
+		std::lock_guard<std::mutex> lock(s_Data.Mutex);
+		ResourceTypeCache& cache = GetTypeCache(type);
+
+		CacheEntry entry = {};
+		entry.Handle = handle;
+		entry.RefCount = 1;
+		entry.PayloadByteSize = payloadByteSize;
+		entry.Dependencies = std::move(dependencies);
+
+		auto iter = cache.Entries.find(hash);
+		if (iter == cache.Entries.end())
+		{
+			entry.Key.resize(sizeof(Key_t));
+			memcpy(entry.Key.data(), &key, sizeof(Key_t));
+
+			cache.Entries.emplace(hash, std::move(entry));
+			cache.HandleToHash.emplace(handle.Handle, hash);
+			return handle;
+		}
+
+		if (!IsSameResource(iter->second, key, payloadByteSize))
+		{
+			cache.UncachedEntries.emplace(handle.Handle, std::move(entry));
+			return handle;
+		}
+
+		// Another loader thread created the same resource in the meantime, keep the first one
+		iter->second.RefCount++;
+		existingHandle = iter->second.Handle;
+		dependencies = std::move(entry.Dependencies);
+	}
+
+	// The new resource lost the race, it and the references it took on its dependencies are not needed anymore
+	DestroyResource(type, handle);
+	for (auto& dependency : dependencies)
+		ResourceCache::Release(dependency.first, dependency.second);
+
+	return existingHandle;
+}
+
+static void DestroyResource(CachedResourceType type, RenderResourceHandle handle)
+{
+	switch (type)
+	{
+	case CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER:
+		Renderer::DestroyBuffer(handle);
+		break;
+	case CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE:
+		Renderer::DestroyTexture(handle);
+		break;
+	case CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL:
+		Renderer::DestroyMaterial(handle);
+		break;
+	case CachedResourceType::CACHED_RESOURCE_TYPE_MESH:
+		Renderer::DestroyMesh(handle);
+		break;
+	case CachedResourceType::CACHED_RESOURCE_TYPE_NUM_TYPES:
+		break;
+	}
+}
+
+static Hash128 HashPayload(const void* data, std::size_t byteSize, const Hash128& descHash)
+{
+	std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+	Hash128 hash = Hash::Combine(descHash, Hash::Bytes(data, byteSize));
+	std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+	s_Data.Stats.BytesHashed += byteSize;
+	s_Data.Stats.HashTime += elapsed.count() * 1000.0f;
+
+	return hash;
+}
+
+static BufferKey MakeBufferKey(const BufferDesc& desc)
+{
+	BufferKey key = {};
+	key.Usage = static_cast<uint64_t>(desc.Usage);
+	key.NumElements = desc.NumElements;
+	key.ElementSize = desc.ElementSize;
+
+	return key;
+}
+
+static TextureKey MakeTextureKey(const TextureDesc& desc)
+{
+	TextureKey key = {};
+	key.Usage = static_cast<uint64_t>(desc.Usage);
+	key.Format = static_cast<uint64_t>(desc.Format);
+	key.Dimension = static_cast<uint64_t>(desc.Dimension);
+	key.Width = desc.Width;
+	key.Height = desc.Height;
+	key.NumMips = desc.NumMips;
+
+	return key;
+}
+
+Hash128 ResourceCache::HashBufferDesc(const BufferDesc& desc)
+{
+	Hash128 descHash = Hash::Value(MakeBufferKey(desc));
+	if (!desc.DataPtr)
+		return descHash;
+
+	return HashPayload(desc.DataPtr, desc.NumElements * desc.ElementSize, descHash);
+}
+
+Hash128 ResourceCache::HashTextureDesc(const TextureDesc& desc)
+{
+	Hash128 descHash = Hash::Value(MakeTextureKey(desc));
+	if (!desc.DataPtr)
+		return descHash;
+
+	return HashPayload(desc.DataPtr, GetTextureDataByteSize(desc), descHash);
+}
+
+RenderResourceHandle ResourceCache::GetOrCreateBuffer(const BufferDesc& desc)
+{
+	// Buffers without initial data are not content addressable
+	if (!desc.DataPtr)
+		return Renderer::CreateBuffer(desc);
+
+	Hash128 hash = HashBufferDesc(desc);
+	BufferKey key = MakeBufferKey(desc);
+	std::size_t byteSize = desc.NumElements * desc.ElementSize;
+	RenderResourceHandle handle = {};
+
+	if (FindAndAddRef(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, hash, key, byteSize, handle))
+	{
+		std::lock_guard<std::mutex> lock(s_Data.Mutex);
+		s_Data.Stats.BytesDeduplicated += byteSize;
+		return handle;
+	}
+
+	return InsertEntry(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, hash, key, byteSize, Renderer::CreateBuffer(desc));
+}
+
+RenderResourceHandle ResourceCache::GetOrCreateTexture(const TextureDesc& desc)
+{
+	// Textures without initial data are not content addressable
+	if (!desc.DataPtr)
+		return RENDER_RESOURCE_HANDLE_NULL;
+
+	Hash128 hash = HashTextureDesc(desc);
+	TextureKey key = MakeTextureKey(desc);
+	std::size_t byteSize = GetTextureDataByteSize(desc);
+	RenderResourceHandle handle = {};
+
+	if (FindAndAddRef(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE, hash, key, byteSize, handle))
+	{
+		std::lock_guard<std::mutex> lock(s_Data.Mutex);
+		s_Data.Stats.BytesDeduplicated += byteSize;
+		return handle;
+	}
+
+	return InsertEntry(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE, hash, key, byteSize, Renderer::CreateTexture(desc));
+}
+
+RenderResourceHandle ResourceCache::GetOrCreateMaterial(const MaterialDesc& desc)
+{
+	MaterialDesc materialDesc = desc;
+	if (!RENDER_RESOURCE_HANDLE_VALID(materialDesc.AlbedoTexture))
+		materialDesc.AlbedoTexture = GetOrCreateTexture(desc.AlbedoDesc);
+	if (!RENDER_RESOURCE_HANDLE_VALID(materialDesc.NormalTexture))
+		materialDesc.NormalTexture = GetOrCreateTexture(desc.NormalDesc);
+	if (!RENDER_RESOURCE_HANDLE_VALID(materialDesc.MetallicRoughnessTexture))
+		materialDesc.MetallicRoughnessTexture = GetOrCreateTexture(desc.MetallicRoughnessDesc);
+
+	// Textures are already deduplicated, so the material can be keyed by the texture handles instead of the pixel data
+	MaterialKey key = {};
+	key.AlbedoTexture = materialDesc.AlbedoTexture.Handle;
+	key.NormalTexture = materialDesc.NormalTexture.Handle;
+	key.MetallicRoughnessTexture = materialDesc.MetallicRoughnessTexture.Handle;
+	key.Metalness = materialDesc.Metalness;
+	key.Roughness = materialDesc.Roughness;
+	// Materials that differ only in the unused alpha cutoff are the same material
+	key.AlphaCutoff = materialDesc.Transparency == TransparencyMode::MASKED ? materialDesc.AlphaCutoff : 0.0f;
+	key.Transparency = static_cast<uint32_t>(materialDesc.Transparency);
+
+	Hash128 hash = Hash::Value(key);
+	RenderResourceHandle handle = {};
+
+	std::vector<std::pair<CachedResourceType, RenderResourceHandle>> dependencies;
+	if (RENDER_RESOURCE_HANDLE_VALID(materialDesc.AlbedoTexture))
+		dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE, materialDesc.AlbedoTexture);
+	if (RENDER_RESOURCE_HANDLE_VALID(materialDesc.NormalTexture))
+		dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE, materialDesc.NormalTexture);
+	if (RENDER_RESOURCE_HANDLE_VALID(materialDesc.MetallicRoughnessTexture))
+		dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE, materialDesc.MetallicRoughnessTexture);
+
+	if (FindAndAddRef(CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL, hash, key, 0, handle))
+	{
+		// The existing material already holds references to its textures
+		for (auto& dependency : dependencies)
+			Release(dependency.first, dependency.second);
+
+		return handle;
+	}
+
+	return InsertEntry(CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL, hash, key, 0, Renderer::CreateMaterial(materialDesc), std::move(dependencies));
+}
+
+RenderResourceHandle ResourceCache::GetOrCreateMesh(const MeshDesc& desc)
+{
+	MeshDesc meshDesc = desc;
+	if (!RENDER_RESOURCE_HANDLE_VALID(meshDesc.PositionBuffer))
+		meshDesc.PositionBuffer = GetOrCreateBuffer(desc.PositionBufferDesc);
+	if (!RENDER_RESOURCE_HANDLE_VALID(meshDesc.AttributeBuffer))
+		meshDesc.AttributeBuffer = GetOrCreateBuffer(desc.AttributeBufferDesc);
+	if (!RENDER_RESOURCE_HANDLE_VALID(meshDesc.IndexBuffer))
+		meshDesc.IndexBuffer = GetOrCreateBuffer(desc.IndexBufferDesc);
+
+	// LODs are derived from the full detail index buffer, so they do not need to be part of the key
+	for (MeshLODDesc& lodDesc : meshDesc.LODs)
+	{
+		if (!RENDER_RESOURCE_HANDLE_VALID(lodDesc.IndexBuffer))
+			lodDesc.IndexBuffer = GetOrCreateBuffer(lodDesc.IndexBufferDesc);
+	}
+
+	MeshKey key = {};
+	key.PositionBuffer = meshDesc.PositionBuffer.Handle;
+	key.AttributeBuffer = meshDesc.AttributeBuffer.Handle;
+	key.IndexBuffer = meshDesc.IndexBuffer.Handle;
+	key.Material = meshDesc.MaterialHandle.Handle;
+	key.BBMin = glm::vec4(meshDesc.BB.Min, 0.0f);
+	key.BBMax = glm::vec4(meshDesc.BB.Max, 0.0f);
+	key.PositionScale = glm::vec4(meshDesc.PositionScale, 0.0f);
+	key.PositionOffset = glm::vec4(meshDesc.PositionOffset, 0.0f);
+
+	Hash128 hash = Hash::Value(key);
+	RenderResourceHandle handle = {};
+
+	std::vector<std::pair<CachedResourceType, RenderResourceHandle>> dependencies;
+	dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, meshDesc.PositionBuffer);
+	dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, meshDesc.AttributeBuffer);
+	dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, meshDesc.IndexBuffer);
+	for (const MeshLODDesc& lodDesc : meshDesc.LODs)
+		dependencies.emplace_back(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER, lodDesc.IndexBuffer);
+
+	if (FindAndAddRef(CachedResourceType::CACHED_RESOURCE_TYPE_MESH, hash, key, 0, handle))
+	{
+		for (auto& dependency : dependencies)
+			Release(dependency.first, dependency.second);
+
+		return handle;
+	}
+
+	return InsertEntry(CachedResourceType::CACHED_RESOURCE_TYPE_MESH, hash, key, 0, Renderer::CreateMesh(meshDesc), std::move(dependencies));
+}
+
+// Finds the cached or uncached entry of a handle, the cache mutex has to be locked
+static CacheEntry* FindEntry(ResourceTypeCache& cache, RenderResourceHandle handle)
+{
+	auto hashIter = cache.HandleToHash.find(handle.Handle);
+	if (hashIter != cache.HandleToHash.end())
+		return &cache.Entries.at(hashIter->second);
+
+	auto uncachedIter = cache.UncachedEntries.find(handle.Handle);
+	return uncachedIter != cache.UncachedEntries.end() ? &uncachedIter->second : nullptr;
+}
+
+uint32_t ResourceCache::AddRef(CachedResourceType type, RenderResourceHandle handle)
+{
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+
+	CacheEntry* entry = FindEntry(GetTypeCache(type), handle);
+	return entry ? ++entry->RefCount : 0;
+}
+
+uint32_t ResourceCache::Release(CachedResourceType type, RenderResourceHandle handle)
+{
+	std::vector<std::pair<CachedResourceType, RenderResourceHandle>> dependencies;
+
+	{
+		std::lock_guard<std::mutex> lock(s_Data.Mutex);
+		ResourceTypeCache& cache = GetTypeCache(type);
+
+		CacheEntry* entry = FindEntry(cache, handle);
+		if (!entry)
+			return 0;
+
+		ASSERT(entry->RefCount > 0, "Released a cached resource that has no references left");
+
+		uint32_t refCount = --entry->RefCount;
+		if (refCount > 0)
+			return refCount;
+
+		// Last reference, drop the entry so the next load creates the resource again
+		dependencies = std::move(entry->Dependencies);
+
+		auto hashIter = cache.HandleToHash.find(handle.Handle);
+		if (hashIter != cache.HandleToHash.end())
+		{
+			cache.Entries.erase(hashIter->second);
+			cache.HandleToHash.erase(hashIter);
+		}
+		else
+		{
+			cache.UncachedEntries.erase(handle.Handle);
+		}
+	}
+
+	DestroyResource(type, handle);
+
+	for (auto& dependency : dependencies)
+		Release(dependency.first, dependency.second);
+
+	return 0;
+}
+
+uint32_t ResourceCache::GetRefCount(CachedResourceType type, RenderResourceHandle handle)
+{
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+
+	const CacheEntry* entry = FindEntry(GetTypeCache(type), handle);
+	return entry ? entry->RefCount : 0;
+}
+
+ResourceCacheStatistics ResourceCache::GetStatistics()
+{
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+	return s_Data.Stats;
+}
+
+#if !defined(DX12R_PORTABLE_CORE)
+void ResourceCache::OnImGuiRender()
+{
+	std::lock_guard<std::mutex> lock(s_Data.Mutex);
+
+	ImGui::Text("Cached buffers: %u", static_cast<uint32_t>(GetTypeCache(CachedResourceType::CACHED_RESOURCE_TYPE_BUFFER).Entries.size()));
+	ImGui::Text("Cached textures: %u", static_cast<uint32_t>(GetTypeCache(CachedResourceType::CACHED_RESOURCE_TYPE_TEXTURE).Entries.size()));
+	ImGui::Text("Cached materials: %u", static_cast<uint32_t>(GetTypeCache(CachedResourceType::CACHED_RESOURCE_TYPE_MATERIAL).Entries.size()));
+	ImGui::Text("Cached meshes: %u", static_cast<uint32_t>(GetTypeCache(CachedResourceType::CACHED_RESOURCE_TYPE_MESH).Entries.size()));
+
+	ImGui::Separator();
+
+	ImGui::Text("Hits/misses: %u/%u, %u collisions", s_Data.Stats.NumHits, s_Data.Stats.NumMisses, s_Data.Stats.NumCollisions);
+	ImGui::Text("Hashed: %.3f MB in %.3f ms", static_cast<float>(s_Data.Stats.BytesHashed) / (1024.0f * 1024.0f), s_Data.Stats.HashTime);
+	ImGui::Text("Deduplicated: %.3f MB", static_cast<float>(s_Data.Stats.BytesDeduplicated) / (1024.0f * 1024.0f));
+}
+#endif
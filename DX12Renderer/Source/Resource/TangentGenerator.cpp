@@ -0,0 +1,231 @@
+#include "Pch.h"
+#include "Resource/TangentGenerator.h"
+#include "Util/Hash.h"
+
+#include "mikkt/mikktspace.h"
+
+#include <fstream>
+#include <filesystem>
+
+static constexpr const char* TANGENT_CACHE_DIRECTORY = "Cache/Tangents/";
+static constexpr uint32_t TANGENT_CACHE_MAGIC = 0x474E4154;
+static constexpr uint32_t TANGENT_CACHE_VERSION = 1;
+
+struct TangentCacheHeader
+{
+	uint32_t Magic = TANGENT_CACHE_MAGIC;
+	uint32_t Version = TANGENT_CACHE_VERSION;
+	uint64_t NumVertices = 0;
+};
+
+struct InternalTangentGeneratorData
+{
+	SMikkTSpaceInterface MikkTInterface = {};
+
+	std::mutex CacheMutex;
+	std::mutex StatisticsMutex;
+	TangentGeneratorStatistics Stats;
+};
+
+static InternalTangentGeneratorData s_Data;
+
+static inline const TangentGeneratorInput& GetInput(const SMikkTSpaceContext* context)
+{
+	return *static_cast<const TangentGeneratorInput*>(context->m_pUserData);
+}
+
+static inline uint8_t* GetVertex(const TangentGeneratorInput& input, int iFace, int iVert)
+{
+	// Triangle lists only, so the index can be fetched directly
+	return input.Vertices + input.Indices[iFace * 3 + iVert] * input.VertexStride;
+}
+
+static int GetNumFaces(const SMikkTSpaceContext* context)
+{
+	return static_cast<int>(GetInput(context).NumIndices / 3);
+}
+
+static int GetNumVerticesOfFace(const SMikkTSpaceContext* context, int iFace)
+{
+	return 3;
+}
+
+static void GetPosition(const SMikkTSpaceContext* context, float outpos[], int iFace, int iVert)
+{
+	const TangentGeneratorInput& input = GetInput(context);
+	memcpy(outpos, GetVertex(input, iFace, iVert) + input.PositionOffset, sizeof(float) * 3);
+}
+
+static void GetNormal(const SMikkTSpaceContext* context, float outnormal[], int iFace, int iVert)
+{
+	const TangentGeneratorInput& input = GetInput(context);
+	memcpy(outnormal, GetVertex(input, iFace, iVert) + input.NormalOffset, sizeof(float) * 3);
+}
+
+static void GetTexCoord(const SMikkTSpaceContext* context, float outuv[], int iFace, int iVert)
+{
+	const TangentGeneratorInput& input = GetInput(context);
+	memcpy(outuv, GetVertex(input, iFace, iVert) + input.TexCoordOffset, sizeof(float) * 2);
+}
+
+static void SetTSpaceBasic(const SMikkTSpaceContext* context, const float tangentu[], float fSign, int iFace, int iVert)
+{
+	const TangentGeneratorInput& input = GetInput(context);
+	uint8_t* vertex = GetVertex(input, iFace, iVert);
+
+	glm::vec3 normal;
+	memcpy(&normal, vertex + input.NormalOffset, sizeof(glm::vec3));
+
+	glm::vec3 tangent(tangentu[0], tangentu[1], tangentu[2]);
+	glm::vec3 bitangent = glm::cross(normal, tangent) * -(fSign);
+
+	memcpy(vertex + input.TangentOffset, &tangent, sizeof(glm::vec3));
+	memcpy(vertex + input.BitangentOffset, &bitangent, sizeof(glm::vec3));
+}
+
+static Hash128 HashInput(const TangentGeneratorInput& input)
+{
+	// Only the attributes that affect the result are hashed, the tangent slots may contain anything
+	std::vector<uint8_t> packedAttributes(input.NumVertices * 32);
+
+	for (std::size_t i = 0; i < input.NumVertices; ++i)
+	{
+		const uint8_t* vertex = input.Vertices + i * input.VertexStride;
+		uint8_t* packed = &packedAttributes[i * 32];
+
+		memcpy(packed, vertex + input.PositionOffset, 12);
+		memcpy(packed + 12, vertex + input.NormalOffset, 12);
+		memcpy(packed + 24, vertex + input.TexCoordOffset, 8);
+	}
+
+	Hash128 attributeHash = Hash::Bytes(packedAttributes.data(), packedAttributes.size());
+	Hash128 indexHash = Hash::Bytes(input.Indices, input.NumIndices * sizeof(uint32_t));
+
+	return Hash::Combine(attributeHash, indexHash);
+}
+
+static std::string GetCacheFilepath(const Hash128& hash)
+{
+	char filename[40];
+	snprintf(filename, sizeof(filename), "%016llx%016llx.tan", (unsigned long long)hash.High, (unsigned long long)hash.Low);
+
+	return std::string(TANGENT_CACHE_DIRECTORY) + filename;
+}
+
+static bool ReadFromCache(const TangentGeneratorInput& input, const Hash128& hash)
+{
+	std::scoped_lock lock(s_Data.CacheMutex);
+
+	std::ifstream file(GetCacheFilepath(hash), std::ios::binary);
+	if (!file)
+		return false;
+
+	TangentCacheHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(TangentCacheHeader));
+
+	if (!file || header.Magic != TANGENT_CACHE_MAGIC || header.Version != TANGENT_CACHE_VERSION || header.NumVertices != input.NumVertices)
+		return false;
+
+	// Tangent and bitangent per vertex
+	std::vector<glm::vec3> tangentFrames(input.NumVertices * 2);
+	file.read(reinterpret_cast<char*>(tangentFrames.data()), tangentFrames.size() * sizeof(glm::vec3));
+
+	if (!file)
+		return false;
+
+	for (std::size_t i = 0; i < input.NumVertices; ++i)
+	{
+		uint8_t* vertex = input.Vertices + i * input.VertexStride;
+		memcpy(vertex + input.TangentOffset, &tangentFrames[i * 2], sizeof(glm::vec3));
+		memcpy(vertex + input.BitangentOffset, &tangentFrames[i * 2 + 1], sizeof(glm::vec3));
+	}
+
+	return true;
+}
+
+static void WriteToCache(const TangentGeneratorInput& input, const Hash128& hash)
+{
+	std::vector<glm::vec3> tangentFrames(input.NumVertices * 2);
+
+	for (std::size_t i = 0; i < input.NumVertices; ++i)
+	{
+		const uint8_t* vertex = input.Vertices + i * input.VertexStride;
+		memcpy(&tangentFrames[i * 2], vertex + input.TangentOffset, sizeof(glm::vec3));
+		memcpy(&tangentFrames[i * 2 + 1], vertex + input.BitangentOffset, sizeof(glm::vec3));
+	}
+
+	TangentCacheHeader header;
+	header.NumVertices = input.NumVertices;
+
+	std::scoped_lock lock(s_Data.CacheMutex);
+
+	std::error_code error;
+	std::filesystem::create_directories(TANGENT_CACHE_DIRECTORY, error);
+
+	std::ofstream file(GetCacheFilepath(hash), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		LOG_WARN("[TangentGenerator] Could not write tangent cache file: {}", GetCacheFilepath(hash));
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(TangentCacheHeader));
+	file.write(reinterpret_cast<const char*>(tangentFrames.data()), tangentFrames.size() * sizeof(glm::vec3));
+}
+
+void TangentGenerator::Generate(const TangentGeneratorInput& input)
+{
+	ASSERT(input.NumIndices % 3 == 0, "Tangent generation only supports triangle lists");
+
+	auto start = std::chrono::steady_clock::now();
+	uint64_t numTriangles = input.NumIndices / 3;
+
+	Hash128 hash = HashInput(input);
+	bool cached = ReadFromCache(input, hash);
+
+	if (!cached)
+	{
+		SMikkTSpaceInterface mikkTInterface = {};
+		mikkTInterface.m_getNumFaces = GetNumFaces;
+		mikkTInterface.m_getNumVerticesOfFace = GetNumVerticesOfFace;
+		mikkTInterface.m_getPosition = GetPosition;
+		mikkTInterface.m_getNormal = GetNormal;
+		mikkTInterface.m_getTexCoord = GetTexCoord;
+		mikkTInterface.m_setTSpaceBasic = SetTSpaceBasic;
+
+		// Every call gets its own context, MikkTSpace itself keeps no global state
+		SMikkTSpaceContext mikkTContext = {};
+		mikkTContext.m_pInterface = &mikkTInterface;
+		mikkTContext.m_pUserData = const_cast<TangentGeneratorInput*>(&input);
+
+		genTangSpaceDefault(&mikkTContext);
+		WriteToCache(input, hash);
+	}
+
+	float duration = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	s_Data.Stats.GenerationTime += duration;
+
+	if (cached)
+	{
+		s_Data.Stats.NumTrianglesFromCache += numTriangles;
+		s_Data.Stats.NumCacheHits++;
+	}
+	else
+	{
+		s_Data.Stats.NumTrianglesGenerated += numTriangles;
+	}
+}
+
+TangentGeneratorStatistics TangentGenerator::GetStatistics()
+{
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	return s_Data.Stats;
+}
+
+void TangentGenerator::ResetStatistics()
+{
+	std::scoped_lock lock(s_Data.StatisticsMutex);
+	s_Data.Stats = TangentGeneratorStatistics();
+}
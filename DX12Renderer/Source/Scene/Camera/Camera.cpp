@@ -1,13 +1,14 @@
 #include "Pch.h"
 #include "Scene/Camera/Camera.h"
 #include "InputHandler.h"
-#include "Application.h"
-#include "Window.h"
 
+// The portable core (see CMakeLists.txt) is built without ImGui
+#if !defined(DX12R_PORTABLE_CORE)
 #include <imgui/imgui.h>
+#endif
 
 Camera::Camera(const glm::vec3& pos, float fov, float width, float height, float near, float far)
-	: m_FOV(fov), m_Width(width), m_Height(height)
+	: m_Width(width), m_Height(height), m_FOV(fov)
 {
 	m_AspectRatio = m_Width / m_Height;
 	m_ReversedZ = (near > far);
@@ -26,7 +27,7 @@ Camera::Camera(const glm::vec3& pos, float fov, float width, float height, float
 }
 
 Camera::Camera(const glm::mat4& view, float fov, float aspect, float near, float far)
-	: m_FOV(fov), m_Width(1.0f), m_Height(1.0f)
+	: m_Width(1.0f), m_Height(1.0f), m_FOV(fov)
 {
 	m_AspectRatio = aspect;
 	m_ReversedZ = (near > far);
@@ -47,17 +48,54 @@ Camera::Camera(const glm::mat4& view, float fov, float aspect, float near, float
 }
 
 Camera::Camera(const glm::mat4& view, float left, float right, float bottom, float top, float near, float far)
-	: m_EnableFrustumCulling(false)
 {
 	m_Transform = Transform(glm::inverse(view));
 	m_ReversedZ = (near > far);
 
+	m_ViewFrustum.SetNearFarTangent(near, far, 0.0f);
+	m_ViewFrustum.SetOrthographicBounds(left, right, bottom, top);
+
 	m_ViewMatrix = view;
 	m_ProjectionMatrix = glm::orthoLH_ZO(left, right, bottom, top, near, far);
 	/*m_ProjectionMatrix[2][2] = 0.0f;
 	m_ProjectionMatrix[3][2] = far;*/
 
 	m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
+
+	m_ViewFrustum.UpdatePlanes(m_Transform);
+}
+
+Camera::Camera(const glm::mat4& view, const glm::mat4& projection, float near, float far)
+{
+	m_Transform = Transform(glm::inverse(view));
+	m_ReversedZ = (near > far);
+
+	// The bounds are recovered from the LH_ZO projections the other constructors make, orthographic projections keep w at 1
+	if (projection[3][3] == 1.0f)
+	{
+		float left = (-1.0f - projection[3][0]) / projection[0][0];
+		float right = (1.0f - projection[3][0]) / projection[0][0];
+		float bottom = (-1.0f - projection[3][1]) / projection[1][1];
+		float top = (1.0f - projection[3][1]) / projection[1][1];
+
+		m_ViewFrustum.SetNearFarTangent(near, far, 0.0f);
+		m_ViewFrustum.SetOrthographicBounds(left, right, bottom, top);
+	}
+	else
+	{
+		float tangent = 1.0f / projection[1][1];
+		m_FOV = glm::degrees(2.0f * glm::atan(tangent));
+		m_AspectRatio = projection[1][1] / projection[0][0];
+
+		m_ViewFrustum.SetNearFarTangent(near, far, tangent);
+		m_ViewFrustum.UpdateBounds(m_AspectRatio);
+	}
+
+	m_ViewMatrix = view;
+	m_ProjectionMatrix = projection;
+	m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
+
+	m_ViewFrustum.UpdatePlanes(m_Transform);
 }
 
 Camera::~Camera()
@@ -104,6 +142,7 @@ void Camera::SetViewMatrix(const glm::mat4& view)
 	m_ViewFrustum.UpdatePlanes(m_Transform);
 }
 
+#if !defined(DX12R_PORTABLE_CORE)
 void Camera::OnImGuiRender()
 {
 	ImGui::Text("Camera");
@@ -123,9 +162,10 @@ void Camera::OnImGuiRender()
 	if (ImGui::Button("Debug print transform"))
 	{
 		glm::mat4 mat = m_Transform.GetTransformMatrix();
-		LOG_INFO("Camera transform: " + glm::to_string(mat));
+		LOG_INFO("Camera transform: {}", glm::to_string(mat));
 	}
 }
+#endif
 
 bool Camera::UpdateMovement(float deltaTime)
 {
@@ -14,12 +14,22 @@ void ViewFrustum::SetNearFarTangent(float near, float far, float tangent)
 
 void ViewFrustum::UpdateBounds(float aspectRatio)
 {
+	m_IsOrthographic = false;
 	m_NearHeight = m_Near * m_Tangent;
 	m_NearWidth = m_NearHeight * aspectRatio;
 	m_FarHeight = m_Far * m_Tangent;
 	m_FarWidth = m_FarHeight * aspectRatio;
 }
 
+void ViewFrustum::SetOrthographicBounds(float left, float right, float bottom, float top)
+{
+	m_IsOrthographic = true;
+	m_Left = left;
+	m_Right = right;
+	m_Bottom = bottom;
+	m_Top = top;
+}
+
 void ViewFrustum::UpdatePlanes(const Transform& transform)
 {
 	const glm::vec3& cameraPosition = transform.GetPosition();
@@ -35,6 +45,16 @@ void ViewFrustum::UpdatePlanes(const Transform& transform)
 	m_Planes[4] = { nearCenter, cameraForward };
 	m_Planes[5] = { farCenter, -cameraForward };
 
+	if (m_IsOrthographic)
+	{
+		// Side planes are parallel to the view direction
+		m_Planes[0] = { cameraPosition + cameraUp * m_Top, -cameraUp };
+		m_Planes[1] = { cameraPosition + cameraUp * m_Bottom, cameraUp };
+		m_Planes[2] = { cameraPosition + cameraRight * m_Left, cameraRight };
+		m_Planes[3] = { cameraPosition + cameraRight * m_Right, -cameraRight };
+		return;
+	}
+
 	glm::vec3 aux = glm::vec3(0.0f);
 	glm::vec3 normal = glm::vec3(0.0f);
 
@@ -13,7 +13,7 @@
 
 #include <imgui/imgui.h>
 
-static std::vector<std::unique_ptr<SceneObject>> m_SceneObjects;
+static TrackedVector<std::unique_ptr<SceneObject>, MEMORY_TAG_SCENE> m_SceneObjects;
 
 Scene::Scene()
 {
@@ -0,0 +1,55 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/FrameCapture.h"
+
+#include <filesystem>
+
+static const std::string CAPTURE_FILEPATH = (std::filesystem::temp_directory_path() / "dx12r_tests_capture.dxrc").string();
+
+static CapturedMaterial MakeMaterial(TransparencyMode transparency, float alphaCutoff)
+{
+	CapturedMaterial material;
+	material.Transparency = transparency;
+	material.AlphaCutoff = alphaCutoff;
+	material.HasAlbedoTexture = true;
+	return material;
+}
+
+TEST_CASE(FrameCaptureMaterialClasses)
+{
+	{
+		FrameCaptureWriter writer(CAPTURE_FILEPATH);
+		EXPECT(writer.IsValid());
+
+		EXPECT_EQ(writer.AddMaterial(10, MakeMaterial(TransparencyMode::OPAQUE, 0.5f)), 0u);
+		EXPECT_EQ(writer.AddMaterial(11, MakeMaterial(TransparencyMode::MASKED, 0.3f)), 1u);
+		EXPECT_EQ(writer.AddMaterial(12, MakeMaterial(TransparencyMode::TRANSPARENT, 0.5f)), 2u);
+		EXPECT_EQ(writer.AddMaterial(11, MakeMaterial(TransparencyMode::OPAQUE, 0.5f)), 1u);
+	}
+
+	// Replays draw every material in the class it was captured with, masked materials keep their cutoff
+	{
+		FrameCaptureReader reader(CAPTURE_FILEPATH);
+		EXPECT(reader.IsValid());
+
+		const std::vector<CapturedMaterial>& materials = reader.GetMaterials();
+		EXPECT_EQ(materials.size(), std::size_t(3));
+
+		if (materials.size() == 3)
+		{
+			EXPECT(materials[0].Transparency == TransparencyMode::OPAQUE);
+			EXPECT(materials[1].Transparency == TransparencyMode::MASKED && materials[1].AlphaCutoff == 0.3f);
+			EXPECT(materials[2].Transparency == TransparencyMode::TRANSPARENT);
+			EXPECT(materials[2].HasAlbedoTexture && !materials[2].HasNormalTexture);
+		}
+	}
+
+	// A material class the reader does not know makes the capture invalid
+	{
+		FrameCaptureWriter writer(CAPTURE_FILEPATH);
+		writer.AddMaterial(10, MakeMaterial(static_cast<TransparencyMode>(TransparencyMode::NUM_ALPHA_MODES), 0.5f));
+	}
+
+	EXPECT(!FrameCaptureReader(CAPTURE_FILEPATH).IsValid());
+	std::filesystem::remove(CAPTURE_FILEPATH);
+}
@@ -0,0 +1,154 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Util/FrameStatistics.h"
+
+#include <cmath>
+
+// Nearest rank percentile of the samples, like the histogram but exact
+static float GetExactPercentile(std::vector<float> samples, float percentile)
+{
+	std::sort(samples.begin(), samples.end());
+	std::size_t rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * samples.size() - 0.001));
+	return samples[std::max<std::size_t>(rank, 1) - 1];
+}
+
+// A bucket middle is at most half a bucket, 0.8%, away from any sample in the bucket
+static bool IsWithinBucketPrecision(float value, float exact)
+{
+	return std::abs(value - exact) <= exact * 0.008f;
+}
+
+TEST_CASE(FrameTimeHistogramBuckets)
+{
+	// Every time lies in its bucket, and buckets are at most 1.6% wide
+	for (float milliseconds = 0.001f; milliseconds < 16000.0f; milliseconds *= 1.0137f)
+	{
+		uint32_t bucket = FrameTimeHistogram::GetBucket(milliseconds);
+		float lowerBound = FrameTimeHistogram::GetBucketLowerBound(bucket);
+		float upperBound = FrameTimeHistogram::GetBucketLowerBound(bucket + 1);
+
+		EXPECT(bucket < FrameTimeHistogram::NUM_BUCKETS);
+		EXPECT(lowerBound <= milliseconds && milliseconds < upperBound);
+		EXPECT(upperBound - lowerBound <= lowerBound * 0.016f);
+	}
+
+	// Times outside the range and NaN go into the outermost buckets
+	EXPECT_EQ(FrameTimeHistogram::GetBucket(0.0f), 0u);
+	EXPECT_EQ(FrameTimeHistogram::GetBucket(-5.0f), 0u);
+	EXPECT_EQ(FrameTimeHistogram::GetBucket(std::nanf("")), 0u);
+	EXPECT_EQ(FrameTimeHistogram::GetBucket(1e9f), FrameTimeHistogram::NUM_BUCKETS - 1);
+	EXPECT_EQ(FrameTimeHistogram::GetBucket(std::numeric_limits<float>::infinity()), FrameTimeHistogram::NUM_BUCKETS - 1);
+}
+
+TEST_CASE(FrameTimeHistogramPercentiles)
+{
+	std::mt19937 random(1337);
+	std::lognormal_distribution<float> frameTimeDistribution(std::log(16.0f), 0.3f);
+
+	FrameTimeHistogram histogram;
+	EXPECT(histogram.GetPercentile(50.0f) == 0.0f);
+
+	std::vector<float> samples(1000);
+	for (float& sample : samples)
+	{
+		sample = frameTimeDistribution(random);
+		histogram.Add(sample);
+	}
+
+	EXPECT_EQ(histogram.GetNumSamples(), 1000u);
+	for (float percentile : { 0.0f, 1.0f, 50.0f, 95.0f, 99.0f, 99.9f, 100.0f })
+		EXPECT(IsWithinBucketPrecision(histogram.GetPercentile(percentile), GetExactPercentile(samples, percentile)));
+
+	// Removing samples gives the percentiles of the rest
+	for (std::size_t i = 0; i < 500; ++i)
+		histogram.Remove(samples[i]);
+	samples.erase(samples.begin(), samples.begin() + 500);
+
+	EXPECT_EQ(histogram.GetNumSamples(), 500u);
+	EXPECT(IsWithinBucketPrecision(histogram.GetPercentile(50.0f), GetExactPercentile(samples, 50.0f)));
+	EXPECT(IsWithinBucketPrecision(histogram.GetPercentile(99.0f), GetExactPercentile(samples, 99.0f)));
+
+	histogram.Clear();
+	EXPECT_EQ(histogram.GetNumSamples(), 0u);
+	EXPECT(histogram.GetPercentile(50.0f) == 0.0f);
+}
+
+TEST_CASE(RollingFrameStatisticsWindow)
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> frameTimeDistribution(10.0f, 20.0f);
+
+	RollingFrameStatistics statistics(100, 100.0f);
+	EXPECT_EQ(statistics.GetStatistics().NumSamples, 0u);
+
+	// Two and a half windows, only the last 100 samples count
+	std::vector<float> samples(250);
+	for (float& sample : samples)
+	{
+		sample = frameTimeDistribution(random);
+		statistics.AddSample(sample);
+	}
+
+	std::vector<float> window(samples.end() - 100, samples.end());
+	FrameTimeStatistics stats = statistics.GetStatistics();
+
+	double sum = 0.0, sumOfSquares = 0.0;
+	for (float sample : window)
+	{
+		sum += sample;
+		sumOfSquares += static_cast<double>(sample) * sample;
+	}
+	double average = sum / window.size();
+	double stdDev = std::sqrt(sumOfSquares / window.size() - average * average);
+
+	EXPECT_EQ(stats.NumSamples, 100u);
+	EXPECT(stats.Min == *std::min_element(window.begin(), window.end()));
+	EXPECT(stats.Max == *std::max_element(window.begin(), window.end()));
+	EXPECT(std::abs(stats.Average - average) < 1e-3);
+	EXPECT(std::abs(stats.StdDev - stdDev) < 1e-3);
+	EXPECT(IsWithinBucketPrecision(stats.P50, GetExactPercentile(window, 50.0f)));
+	EXPECT(IsWithinBucketPrecision(stats.P95, GetExactPercentile(window, 95.0f)));
+	EXPECT(stats.P999 <= stats.Max && stats.P50 >= stats.Min);
+
+	std::vector<float> windowSamples;
+	statistics.GetSamples(windowSamples);
+	EXPECT(windowSamples == window);
+
+	statistics.Clear();
+	statistics.AddSample(5.0f);
+	statistics.GetSamples(windowSamples);
+	EXPECT(windowSamples == std::vector<float>({ 5.0f }));
+	EXPECT(statistics.GetStatistics().Average == 5.0f);
+}
+
+TEST_CASE(RollingFrameStatisticsStutters)
+{
+	RollingFrameStatistics statistics(64, 2.0f);
+
+	// The median has to be known before a frame counts as a stutter
+	statistics.AddSample(100.0f);
+	for (uint32_t i = 0; i < 31; ++i)
+		statistics.AddSample(16.0f);
+
+	EXPECT_EQ(statistics.GetStatistics().NumStutters, 0u);
+
+	statistics.AddSample(40.0f);
+	statistics.AddSample(30.0f);
+	EXPECT_EQ(statistics.GetStatistics().NumStutters, 1u);
+	EXPECT_EQ(statistics.GetNumTotalStutters(), 1ull);
+
+	// The stutter leaves the window, the total keeps it
+	for (uint32_t i = 0; i < 64; ++i)
+		statistics.AddSample(16.0f);
+
+	EXPECT_EQ(statistics.GetStatistics().NumStutters, 0u);
+	EXPECT_EQ(statistics.GetNumTotalStutters(), 1ull);
+
+	statistics.SetStutterFactor(1.5f);
+	statistics.AddSample(30.0f);
+	EXPECT_EQ(statistics.GetStatistics().NumStutters, 1u);
+
+	statistics.Clear();
+	EXPECT_EQ(statistics.GetNumTotalStutters(), 0ull);
+	EXPECT_EQ(statistics.GetStatistics().NumStutters, 0u);
+}
@@ -0,0 +1,132 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Resource/GLTFDocument.h"
+
+#include <filesystem>
+
+// Triangle with one node and scene, the buffer holds three zero positions as an embedded base64 data URI
+static const char* VALID_DOCUMENT = R"({
+	"asset": { "version": "2.0" },
+	"buffers": [ { "byteLength": 36, "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA" } ],
+	"bufferViews": [ { "buffer": 0, "byteLength": 36 } ],
+	"accessors": [ { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [ 0, 0, 0 ], "max": [ 0, 0, 0 ] } ],
+	"images": [ { "uri": "image.png" } ],
+	"textures": [ { "source": 0 } ],
+	"materials": [ { "pbrMetallicRoughness": { "baseColorTexture": { "index": 0 } } } ],
+	"meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 }, "material": 0 } ] } ],
+	"nodes": [ { "mesh": 0, "children": [ 1 ] }, { "translation": [ 1, 2, 3 ] } ],
+	"scenes": [ { "nodes": [ 0 ] } ],
+	"scene": 0
+})";
+
+static bool LoadDocument(const std::string& document)
+{
+	std::string filepath = Test::WriteTemporaryFile("dx12r_tests_document.gltf", document);
+
+	bool isValid = GLTFDocument(filepath).IsValid();
+	std::filesystem::remove(filepath);
+
+	return isValid;
+}
+
+// Replaces the first occurrence of a part of the valid document
+static std::string MakeDocument(const std::string& from, const std::string& to)
+{
+	std::string document = VALID_DOCUMENT;
+	std::size_t offset = document.find(from);
+	if (offset == std::string::npos)
+	{
+		Test::ReportFailure(__FILE__, __LINE__, from + " to be part of the valid document");
+		return std::string();
+	}
+
+	return document.replace(offset, from.size(), to);
+}
+
+TEST_CASE(GLTFDocumentValid)
+{
+	std::string filepath = Test::WriteTemporaryFile("dx12r_tests_valid.gltf", VALID_DOCUMENT);
+
+	{
+		GLTFDocument document(filepath);
+		EXPECT(document.IsValid());
+		EXPECT_EQ(document.GetNodes().size(), 2u);
+		EXPECT_EQ(document.GetRootNodes().size(), 1u);
+		EXPECT(document.GetAccessor(0).IsValid());
+		EXPECT_EQ(document.GetAccessor(0).Count, 3u);
+		EXPECT_EQ(document.GetMaterials()[0].AlbedoImage, 0);
+		EXPECT(document.GetNodes()[1].Transform[3] == glm::vec4(1.0f, 2.0f, 3.0f, 1.0f));
+	}
+
+	std::filesystem::remove(filepath);
+}
+
+TEST_CASE(GLTFDocumentRejectsOutOfRangeIndices)
+{
+	EXPECT(!LoadDocument(MakeDocument(R"("children": [ 1 ])", R"("children": [ 2 ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("children": [ 1 ])", R"("children": [ -1 ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("nodes": [ 0 ])", R"("nodes": [ 5 ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("scene": 0)", R"("scene": 1)")));
+	EXPECT(!LoadDocument(MakeDocument(R"("mesh": 0)", R"("mesh": 1)")));
+	EXPECT(!LoadDocument(MakeDocument(R"("POSITION": 0)", R"("POSITION": 1)")));
+	EXPECT(!LoadDocument(MakeDocument(R"("material": 0)", R"("material": 3)")));
+	EXPECT(!LoadDocument(MakeDocument(R"({ "bufferView": 0, "componentType")", R"({ "bufferView": 1, "componentType")")));
+	EXPECT(!LoadDocument(MakeDocument(R"({ "uri": "image.png" })", R"({ "bufferView": 4 })")));
+	EXPECT(!LoadDocument(MakeDocument(R"("source": 0)", R"("source": 1)")));
+	EXPECT(!LoadDocument(MakeDocument(R"("baseColorTexture": { "index": 0 })", R"("baseColorTexture": { "index": 1 })")));
+	EXPECT(!LoadDocument(MakeDocument(R"("buffer": 0)", R"("buffer": 1)")));
+}
+
+TEST_CASE(GLTFDocumentRejectsMalformedValues)
+{
+	EXPECT(!LoadDocument(MakeDocument(R"("translation": [ 1, 2, 3 ])", R"("translation": [ 1, "2", 3 ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("translation": [ 1, 2, 3 ])", R"("translation": [ 1, 2 ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("children": [ 1 ])", R"("children": [ "1" ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("mesh": 0)", R"("mesh": 0.5)")));
+	EXPECT(!LoadDocument(MakeDocument(R"("byteLength": 36 } ])", R"("byteLength": 36, "byteOffset": 18446744073709551615 } ])")));
+	EXPECT(!LoadDocument(MakeDocument(R"("count": 3)", R"("count": 4611686018427387904)")));
+
+	// Malformed optional values fall back to their defaults instead of throwing
+	EXPECT(LoadDocument(MakeDocument(R"("max": [ 0, 0, 0 ])", R"("max": [ 0, null, 0 ], "normalized": 1)")));
+	EXPECT(LoadDocument(MakeDocument(R"("image.png")", R"("image%zz.png")")));
+}
+
+TEST_CASE(GLTFDocumentRejectsNodeCycles)
+{
+	EXPECT(!LoadDocument(MakeDocument(R"({ "translation": [ 1, 2, 3 ] })", R"({ "children": [ 0 ] })")));
+	EXPECT(!LoadDocument(MakeDocument(R"({ "translation": [ 1, 2, 3 ] })", R"({ "children": [ 1 ] })")));
+	EXPECT(!LoadDocument(MakeDocument(R"("children": [ 1 ])", R"("children": [ 1, 1 ])")));
+}
+
+TEST_CASE(GLTFDocumentAlphaModes)
+{
+	auto readMaterial = [](const std::string& alphaProperties)
+	{
+		std::string document = MakeDocument(R"("pbrMetallicRoughness")", alphaProperties + R"("pbrMetallicRoughness")");
+		std::string filepath = Test::WriteTemporaryFile("dx12r_tests_alpha.gltf", document);
+
+		GLTFMaterial material;
+		{
+			GLTFDocument gltfDocument(filepath);
+			EXPECT(gltfDocument.IsValid() && gltfDocument.GetMaterials().size() == 1);
+			if (gltfDocument.IsValid() && !gltfDocument.GetMaterials().empty())
+				material = gltfDocument.GetMaterials()[0];
+		}
+
+		std::filesystem::remove(filepath);
+		return material;
+	};
+
+	// Materials without an alpha mode, or with one the importer does not know, are opaque
+	EXPECT(readMaterial("").AlphaMode == GLTFAlphaMode::GLTF_ALPHA_MODE_OPAQUE);
+	EXPECT(readMaterial(R"("alphaMode": "OPAQUE", )").AlphaMode == GLTFAlphaMode::GLTF_ALPHA_MODE_OPAQUE);
+	EXPECT(readMaterial(R"("alphaMode": "CUTOUT", )").AlphaMode == GLTFAlphaMode::GLTF_ALPHA_MODE_OPAQUE);
+	EXPECT(readMaterial(R"("alphaMode": "BLEND", )").AlphaMode == GLTFAlphaMode::GLTF_ALPHA_MODE_BLEND);
+
+	GLTFMaterial masked = readMaterial(R"("alphaMode": "MASK", "alphaCutoff": 0.25, )");
+	EXPECT(masked.AlphaMode == GLTFAlphaMode::GLTF_ALPHA_MODE_MASK);
+	EXPECT(masked.AlphaCutoff == 0.25f);
+
+	// The cutoff defaults to 0.5 like in the glTF specification
+	EXPECT(readMaterial(R"("alphaMode": "MASK", )").AlphaCutoff == 0.5f);
+}
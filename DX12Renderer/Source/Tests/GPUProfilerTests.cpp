@@ -0,0 +1,205 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/Backend/GPUProfiler.h"
+
+/*
+
+	Timestamps are written by the test, on a 10 MHz clock that was calibrated against a fixed CPU time.
+	Resizes are counted so the test can tell when the profiler grows the queries of a frame.
+
+*/
+class FakeGPUQuerySource : public GPUProfilerQuerySource
+{
+public:
+	static constexpr uint64_t FREQUENCY = 10000000;
+	static constexpr uint64_t CALIBRATION_TIMESTAMP = 1000000;
+
+	FakeGPUQuerySource(uint32_t numFramesInFlight)
+		: m_Timestamps(numFramesInFlight)
+	{
+	}
+
+	virtual void ResizeQueries(uint32_t frameIndex, uint32_t numQueries) override
+	{
+		m_Timestamps[frameIndex].resize(numQueries);
+		NumResizes++;
+	}
+
+	virtual void ReadTimestamps(uint32_t frameIndex, uint32_t numQueries, uint64_t* outTimestamps) override
+	{
+		EXPECT(numQueries <= m_Timestamps[frameIndex].size());
+		memcpy(outTimestamps, m_Timestamps[frameIndex].data(), numQueries * sizeof(uint64_t));
+	}
+
+	virtual uint64_t GetTimestampFrequency() const override { return FREQUENCY; }
+
+	virtual GPUClockCalibration GetClockCalibration() override
+	{
+		GPUClockCalibration calibration;
+		calibration.GPUTimestamp = CALIBRATION_TIMESTAMP;
+		calibration.CPUTime = GetCalibrationTime();
+		return calibration;
+	}
+
+	void WriteTimestamp(uint32_t frameIndex, uint32_t queryIndex, uint64_t timestamp)
+	{
+		EXPECT(queryIndex != GPU_PROFILER_INVALID_QUERY && queryIndex < m_Timestamps[frameIndex].size());
+		if (queryIndex < m_Timestamps[frameIndex].size())
+			m_Timestamps[frameIndex][queryIndex] = timestamp;
+	}
+
+	static std::chrono::steady_clock::time_point GetCalibrationTime()
+	{
+		return std::chrono::steady_clock::time_point(std::chrono::seconds(100));
+	}
+
+public:
+	uint32_t NumResizes = 0;
+
+private:
+	std::vector<std::vector<uint64_t>> m_Timestamps;
+
+};
+
+// Milliseconds from the calibration to the beginning of the zone
+static double GetMillisecondsFromCalibration(const ProfilerGPUZone& zone)
+{
+	return std::chrono::duration<double, std::milli>(zone.BeginTime - FakeGPUQuerySource::GetCalibrationTime()).count();
+}
+
+TEST_CASE(GPUProfilerRegisterZones)
+{
+	GPUProfiler profiler(std::make_unique<FakeGPUQuerySource>(2), 2);
+
+	uint32_t shadowID = profiler.RegisterZone("Shadows");
+	uint32_t lightingID = profiler.RegisterZone("Lighting");
+
+	EXPECT(shadowID != lightingID);
+	EXPECT_EQ(profiler.RegisterZone(std::string("Shad") + "ows"), shadowID);
+	EXPECT(strcmp(profiler.GetZoneName(shadowID), "Shadows") == 0);
+	EXPECT(strcmp(profiler.GetZoneName(lightingID), "Lighting") == 0);
+	EXPECT(strcmp(profiler.GetZoneName(1000), "") == 0);
+	EXPECT_EQ(profiler.GetStatistics().NumRegisteredZones, 2u);
+}
+
+TEST_CASE(GPUProfilerResolve)
+{
+	auto querySource = std::make_unique<FakeGPUQuerySource>(2);
+	FakeGPUQuerySource& source = *querySource;
+	GPUProfiler profiler(std::move(querySource), 2);
+
+	uint32_t frameID = profiler.RegisterZone("Frame");
+	uint32_t shadowID = profiler.RegisterZone("Shadows");
+	uint32_t lightingID = profiler.RegisterZone("Lighting");
+
+	// Frame 0 ends 1 ms before the calibration, ticks are 100 ns
+	profiler.BeginFrame(0);
+	source.WriteTimestamp(0, profiler.BeginZone(frameID), 990000);
+	source.WriteTimestamp(0, profiler.BeginZone(shadowID), 990000);
+	source.WriteTimestamp(0, profiler.EndZone(), 993000);
+	source.WriteTimestamp(0, profiler.BeginZone(lightingID), 993000);
+	source.WriteTimestamp(0, profiler.EndZone(), 999000);
+	source.WriteTimestamp(0, profiler.EndZone(), 990000 + 10000);
+
+	// Frame 1 records a zone of its own, the zones of frame 0 are only resolved when frame 0 comes around again
+	profiler.BeginFrame(1);
+	EXPECT(profiler.GetZones().empty());
+	source.WriteTimestamp(1, profiler.BeginZone(lightingID), 995000);
+	source.WriteTimestamp(1, profiler.EndZone(), 995500);
+
+	profiler.BeginFrame(0);
+	const std::vector<ProfilerGPUZone>& zones = profiler.GetZones();
+	EXPECT_EQ(zones.size(), std::size_t(3));
+	EXPECT_EQ(profiler.GetStatistics().NumZones, 3u);
+
+	if (zones.size() == 3)
+	{
+		EXPECT(strcmp(zones[0].Name, "Frame") == 0 && zones[0].Depth == 0u);
+		EXPECT(strcmp(zones[1].Name, "Shadows") == 0 && zones[1].Depth == 1u);
+		EXPECT(strcmp(zones[2].Name, "Lighting") == 0 && zones[2].Depth == 1u);
+
+		EXPECT(std::abs(zones[0].Duration - 1.0f) < 1e-4f);
+		EXPECT(std::abs(zones[1].Duration - 0.3f) < 1e-4f);
+		EXPECT(std::abs(zones[2].Duration - 0.6f) < 1e-4f);
+
+		EXPECT(std::abs(GetMillisecondsFromCalibration(zones[0]) + 1.0) < 1e-4);
+		EXPECT(std::abs(GetMillisecondsFromCalibration(zones[1]) + 1.0) < 1e-4);
+		EXPECT(std::abs(GetMillisecondsFromCalibration(zones[2]) + 0.7) < 1e-4);
+	}
+
+	// Frame 0 recorded nothing the second time around
+	profiler.BeginFrame(1);
+	EXPECT_EQ(profiler.GetZones().size(), std::size_t(1));
+	EXPECT(std::abs(profiler.GetZones()[0].Duration - 0.05f) < 1e-4f);
+
+	profiler.BeginFrame(0);
+	EXPECT(profiler.GetZones().empty());
+}
+
+TEST_CASE(GPUProfilerTimestampOrder)
+{
+	auto querySource = std::make_unique<FakeGPUQuerySource>(1);
+	FakeGPUQuerySource& source = *querySource;
+	GPUProfiler profiler(std::move(querySource), 1);
+
+	uint32_t zoneID = profiler.RegisterZone("Zone");
+
+	// An end timestamp before the begin one, like a disjoint clock, does not turn into a huge duration
+	profiler.BeginFrame(0);
+	source.WriteTimestamp(0, profiler.BeginZone(zoneID), 999000);
+	source.WriteTimestamp(0, profiler.EndZone(), 998000);
+
+	profiler.BeginFrame(0);
+	EXPECT_EQ(profiler.GetZones().size(), std::size_t(1));
+	EXPECT(profiler.GetZones()[0].Duration == 0.0f);
+}
+
+TEST_CASE(GPUProfilerDroppedZones)
+{
+	auto querySource = std::make_unique<FakeGPUQuerySource>(2);
+	FakeGPUQuerySource& source = *querySource;
+	GPUProfiler profiler(std::move(querySource), 2, 4);
+
+	uint32_t outerID = profiler.RegisterZone("Outer");
+	uint32_t innerID = profiler.RegisterZone("Inner");
+	uint32_t droppedID = profiler.RegisterZone("Dropped");
+
+	profiler.BeginFrame(0);
+	EXPECT_EQ(source.NumResizes, 1u);
+
+	// Four queries hold the outer and inner zone, the third zone would leave no query for the ends of the open ones
+	source.WriteTimestamp(0, profiler.BeginZone(outerID), 990000);
+	source.WriteTimestamp(0, profiler.BeginZone(innerID), 991000);
+	EXPECT_EQ(profiler.BeginZone(droppedID), GPU_PROFILER_INVALID_QUERY);
+	EXPECT_EQ(profiler.EndZone(), GPU_PROFILER_INVALID_QUERY);
+	source.WriteTimestamp(0, profiler.EndZone(), 992000);
+	source.WriteTimestamp(0, profiler.EndZone(), 993000);
+
+	EXPECT_EQ(profiler.GetStatistics().NumDroppedZones, 1ull);
+	EXPECT_EQ(profiler.GetStatistics().NumQueriesPerFrame, 6u);
+
+	// The next frame grows its queries before recording, the dropped frame still resolves what it recorded
+	profiler.BeginFrame(1);
+	EXPECT_EQ(source.NumResizes, 2u);
+
+	profiler.BeginFrame(0);
+	EXPECT_EQ(source.NumResizes, 3u);
+	EXPECT_EQ(profiler.GetZones().size(), std::size_t(2));
+	EXPECT(strcmp(profiler.GetZones()[0].Name, "Outer") == 0);
+	EXPECT(strcmp(profiler.GetZones()[1].Name, "Inner") == 0 && profiler.GetZones()[1].Depth == 1u);
+
+	// With the grown queries the same zones fit
+	source.WriteTimestamp(0, profiler.BeginZone(outerID), 990000);
+	source.WriteTimestamp(0, profiler.BeginZone(innerID), 991000);
+	source.WriteTimestamp(0, profiler.BeginZone(droppedID), 991000);
+	source.WriteTimestamp(0, profiler.EndZone(), 991500);
+	source.WriteTimestamp(0, profiler.EndZone(), 992000);
+	source.WriteTimestamp(0, profiler.EndZone(), 993000);
+
+	EXPECT_EQ(profiler.GetStatistics().NumDroppedZones, 1ull);
+
+	profiler.BeginFrame(1);
+	profiler.BeginFrame(0);
+	EXPECT_EQ(profiler.GetZones().size(), std::size_t(3));
+	EXPECT_EQ(source.NumResizes, 3u);
+}
@@ -0,0 +1,75 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Util/Hash.h"
+
+// Known answers pin the hash function, cached pipeline libraries and shader caches are keyed by it and would be invalidated by any change
+static bool IsHash(const Hash128& hash, uint64_t low, uint64_t high)
+{
+	return hash.Low == low && hash.High == high;
+}
+
+static std::vector<uint8_t> MakeSequence(std::size_t byteSize)
+{
+	std::vector<uint8_t> bytes(byteSize);
+	for (std::size_t i = 0; i < byteSize; ++i)
+		bytes[i] = static_cast<uint8_t>(i);
+
+	return bytes;
+}
+
+TEST_CASE(HashKnownAnswers)
+{
+	std::vector<uint8_t> sequence = MakeSequence(100);
+
+	EXPECT(IsHash(Hash::Bytes(nullptr, 0), 0xFD346E999EF977C8ULL, 0x382A248B6A01FE86ULL));
+	EXPECT(IsHash(Hash::Bytes("abc", 3), 0x8BC7B6A198D87CD0ULL, 0x149014728F5D70D9ULL));
+	EXPECT(IsHash(Hash::Bytes("abc", 3, 42), 0x5DCC7E554BA7ED9BULL, 0x89DF0EE5F84BC5A7ULL));
+	// One full stripe, and three stripes followed by full words and tail bytes
+	EXPECT(IsHash(Hash::Bytes(sequence.data(), 32), 0x4C4CD981C1930255ULL, 0x2ED8EDBE2ED2420EULL));
+	EXPECT(IsHash(Hash::Bytes(sequence.data(), 100), 0x6F18ED34B2427312ULL, 0x072366C43EA346D7ULL));
+	EXPECT(IsHash(Hash::Combine(Hash::Bytes("abc", 3), Hash::Bytes(sequence.data(), 100)), 0x48ACCEA9AEAE44F8ULL, 0x2CFA033EC459D87EULL));
+}
+
+TEST_CASE(HashValueMatchesBytes)
+{
+	struct Key
+	{
+		uint64_t A;
+		uint64_t B;
+	};
+
+	Key key = { 1, 2 };
+	EXPECT(Hash::Value(key) == Hash::Bytes(&key, sizeof(key)));
+	EXPECT(Hash::Value(key, 7) == Hash::Bytes(&key, sizeof(key), 7));
+}
+
+TEST_CASE(HashDistinguishesLengthAndSeed)
+{
+	// The tail is zero padded, the length keeps trailing zero bytes from colliding with shorter input
+	const uint8_t bytes[2] = { 'a', 0 };
+	EXPECT(Hash::Bytes(bytes, 1) != Hash::Bytes(bytes, 2));
+	EXPECT(Hash::Bytes(bytes, 1, 0) != Hash::Bytes(bytes, 1, 1));
+
+	Hash128 lhs = Hash::Bytes("lhs", 3);
+	Hash128 rhs = Hash::Bytes("rhs", 3);
+	EXPECT(Hash::Combine(lhs, rhs) != Hash::Combine(rhs, lhs));
+}
+
+TEST_CASE(HashSingleBitChanges)
+{
+	// Every flipped input bit has to change both halves of the hash
+	std::vector<uint8_t> sequence = MakeSequence(64);
+	Hash128 reference = Hash::Bytes(sequence.data(), sequence.size());
+
+	uint32_t numUnchangedHalves = 0;
+	for (std::size_t bit = 0; bit < sequence.size() * 8; ++bit)
+	{
+		sequence[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+		Hash128 hash = Hash::Bytes(sequence.data(), sequence.size());
+		sequence[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+
+		numUnchangedHalves += (hash.Low == reference.Low ? 1 : 0) + (hash.High == reference.High ? 1 : 0);
+	}
+
+	EXPECT_EQ(numUnchangedHalves, 0u);
+}
@@ -0,0 +1,252 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/LightClustering.h"
+#include "Util/JobSystem.h"
+
+#include <random>
+
+static constexpr float CAMERA_NEAR = 0.1f;
+static constexpr float CAMERA_FAR = 200.0f;
+static const glm::vec2 SCREEN_SIZE = glm::vec2(1920.0f, 1080.0f);
+
+static glm::mat4 MakeProjection()
+{
+	return glm::perspectiveFovLH_ZO(glm::radians(60.0f), SCREEN_SIZE.x, SCREEN_SIZE.y, CAMERA_NEAR, CAMERA_FAR);
+}
+
+static LightClusterGridData MakeGrid(const glm::mat4& view, uint32_t numLights)
+{
+	return LightClustering::MakeGridData(view, MakeProjection(), CAMERA_NEAR, CAMERA_FAR, SCREEN_SIZE, 0, numLights);
+}
+
+// Axis aligned bounds of the eight frustum corners of a cluster, calculated from the projection instead of the grid data
+static void CalculateReferenceClusterBounds(uint32_t clusterIndex, glm::vec3& outMin, glm::vec3& outMax)
+{
+	glm::mat4 projection = MakeProjection();
+	uint32_t x = clusterIndex % LIGHT_CLUSTER_GRID_SIZE_X;
+	uint32_t y = (clusterIndex / LIGHT_CLUSTER_GRID_SIZE_X) % LIGHT_CLUSTER_GRID_SIZE_Y;
+	uint32_t z = clusterIndex / (LIGHT_CLUSTER_GRID_SIZE_X * LIGHT_CLUSTER_GRID_SIZE_Y);
+
+	outMin = glm::vec3(std::numeric_limits<float>::max());
+	outMax = glm::vec3(-std::numeric_limits<float>::max());
+
+	for (uint32_t corner = 0; corner < 8; ++corner)
+	{
+		float ndcX = 2.0f * static_cast<float>(x + (corner & 1)) / LIGHT_CLUSTER_GRID_SIZE_X - 1.0f;
+		float ndcY = 1.0f - 2.0f * static_cast<float>(y + ((corner >> 1) & 1)) / LIGHT_CLUSTER_GRID_SIZE_Y;
+		float depth = CAMERA_NEAR * std::pow(CAMERA_FAR / CAMERA_NEAR, static_cast<float>(z + (corner >> 2)) / LIGHT_CLUSTER_GRID_SIZE_Z);
+
+		glm::vec3 position = glm::vec3(ndcX * depth / projection[0][0], ndcY * depth / projection[1][1], depth);
+		outMin = glm::min(outMin, position);
+		outMax = glm::max(outMax, position);
+	}
+}
+
+enum class ReferenceOverlap
+{
+	OUTSIDE,
+	INSIDE,
+	// Too close to the bounds to tell, rounding of either calculation decides
+	AMBIGUOUS
+};
+
+static ReferenceOverlap TestReferenceOverlap(const glm::vec4& sphere, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+	glm::vec3 closest = glm::clamp(glm::vec3(sphere), boundsMin, boundsMax);
+	float distanceSquared = glm::dot(closest - glm::vec3(sphere), closest - glm::vec3(sphere));
+	float radiusSquared = sphere.w * sphere.w;
+
+	if (std::abs(distanceSquared - radiusSquared) <= 1e-3f * std::max(radiusSquared, 1.0f))
+		return ReferenceOverlap::AMBIGUOUS;
+
+	return distanceSquared < radiusSquared ? ReferenceOverlap::INSIDE : ReferenceOverlap::OUTSIDE;
+}
+
+static std::vector<glm::vec4> MakeRandomViewSpheres(uint32_t numLights, float minRadius, float maxRadius)
+{
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	std::vector<glm::vec4> spheres(numLights);
+	for (glm::vec4& sphere : spheres)
+	{
+		// Spread over the view frustum and a bit beyond it, so some lights only touch the grid or miss it
+		float depth = -5.0f + unit(random) * (CAMERA_FAR + 10.0f);
+		float x = (unit(random) * 2.4f - 1.2f) * depth * 0.58f * SCREEN_SIZE.x / SCREEN_SIZE.y;
+		float y = (unit(random) * 2.4f - 1.2f) * depth * 0.58f;
+		sphere = glm::vec4(x, y, depth, minRadius + unit(random) * (maxRadius - minRadius));
+	}
+
+	return spheres;
+}
+
+TEST_CASE(LightClusterAssignmentMatchesBruteForce)
+{
+	JobSystem::Initialize(2);
+
+	glm::mat4 view = glm::lookAtLH(glm::vec3(3.0f, 2.0f, -4.0f), glm::vec3(3.5f, 1.8f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	std::vector<glm::vec4> viewSpheres = MakeRandomViewSpheres(2000, 0.5f, 8.0f);
+	LightClusterGridData grid = MakeGrid(view, static_cast<uint32_t>(viewSpheres.size()));
+
+	LightClusterLists lists;
+	LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+	uint32_t numMissing = 0, numUnexpected = 0, numWrongCounts = 0, numUnordered = 0;
+	uint32_t numReferenceOverlaps = 0, numReferenceAmbiguous = 0;
+
+	for (uint32_t clusterIndex = 0; clusterIndex < LIGHT_CLUSTER_COUNT; ++clusterIndex)
+	{
+		glm::vec3 boundsMin, boundsMax;
+		CalculateReferenceClusterBounds(clusterIndex, boundsMin, boundsMax);
+
+		std::vector<ReferenceOverlap> overlaps(viewSpheres.size());
+		uint32_t numInside = 0, numAmbiguous = 0;
+		for (std::size_t lightIndex = 0; lightIndex < viewSpheres.size(); ++lightIndex)
+		{
+			overlaps[lightIndex] = TestReferenceOverlap(viewSpheres[lightIndex], boundsMin, boundsMax);
+			numInside += overlaps[lightIndex] == ReferenceOverlap::INSIDE ? 1 : 0;
+			numAmbiguous += overlaps[lightIndex] == ReferenceOverlap::AMBIGUOUS ? 1 : 0;
+		}
+
+		uint32_t count = lists.LightCounts[clusterIndex];
+		if (count < numInside || count > numInside + numAmbiguous)
+			numWrongCounts++;
+
+		numReferenceOverlaps += numInside;
+		numReferenceAmbiguous += numAmbiguous;
+
+		// The stored slots are the first overlapping lights in light order
+		uint32_t numStored = std::min(count, LIGHT_CLUSTER_MAX_LIGHTS);
+		const uint32_t* clusterLights = &lists.LightIndices[clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS];
+		uint32_t lastLight = 0;
+
+		for (uint32_t slot = 0; slot < numStored; ++slot)
+		{
+			numUnexpected += overlaps[clusterLights[slot]] == ReferenceOverlap::OUTSIDE ? 1 : 0;
+			numUnordered += slot > 0 && clusterLights[slot] <= lastLight ? 1 : 0;
+			lastLight = clusterLights[slot];
+		}
+
+		if (count <= LIGHT_CLUSTER_MAX_LIGHTS)
+		{
+			for (uint32_t lightIndex = 0; lightIndex < static_cast<uint32_t>(viewSpheres.size()); ++lightIndex)
+			{
+				if (overlaps[lightIndex] == ReferenceOverlap::INSIDE && std::find(clusterLights, clusterLights + numStored, lightIndex) == clusterLights + numStored)
+					numMissing++;
+			}
+		}
+	}
+
+	EXPECT_EQ(numWrongCounts, 0u);
+	EXPECT_EQ(numMissing, 0u);
+	EXPECT_EQ(numUnexpected, 0u);
+	EXPECT_EQ(numUnordered, 0u);
+
+	// Stored and dropped assignments add up to the reference overlaps, up to the lights that are too close to a cluster boundary to tell
+	LightClusterStatistics stats = LightClustering::GetStatistics(lists, static_cast<uint32_t>(viewSpheres.size()));
+	uint32_t numAssignments = stats.NumLightAssignments + stats.NumDroppedAssignments;
+	EXPECT_EQ(stats.NumLights, 2000u);
+	EXPECT(numAssignments >= numReferenceOverlaps && numAssignments <= numReferenceOverlaps + numReferenceAmbiguous);
+	EXPECT(stats.NumDroppedAssignments > 0);
+	EXPECT(stats.MaxLightsInCluster > LIGHT_CLUSTER_MAX_LIGHTS);
+
+	JobSystem::Finalize();
+}
+
+TEST_CASE(LightClusterJobsMatchSingleThreadedBuild)
+{
+	JobSystem::Initialize(4);
+
+	std::vector<glm::vec4> viewSpheres = MakeRandomViewSpheres(4000, 0.25f, 20.0f);
+	LightClusterGridData grid = MakeGrid(glm::identity<glm::mat4>(), static_cast<uint32_t>(viewSpheres.size()));
+
+	LightClusterLists jobLists;
+	LightClustering::BuildClusters(grid, viewSpheres, jobLists);
+
+	LightClusterLists singleLists;
+	singleLists.LightCounts.resize(LIGHT_CLUSTER_COUNT);
+	singleLists.LightIndices.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+	LightClustering::BuildClusters(grid, viewSpheres, singleLists, 0, LIGHT_CLUSTER_COUNT);
+
+	EXPECT_EQ(LightClustering::CompareClusters(jobLists, singleLists), 0u);
+
+	// A single different count or stored index is reported as one mismatching cluster
+	singleLists.LightCounts[17]++;
+	uint32_t occupiedCluster = static_cast<uint32_t>(std::find_if(jobLists.LightCounts.begin() + 18, jobLists.LightCounts.end(),
+		[](uint32_t count) { return count > 0; }) - jobLists.LightCounts.begin());
+	singleLists.LightIndices[occupiedCluster * LIGHT_CLUSTER_MAX_LIGHTS] += 1;
+	EXPECT_EQ(LightClustering::CompareClusters(jobLists, singleLists), 2u);
+
+	JobSystem::Finalize();
+}
+
+TEST_CASE(LightClusterDropsAssignmentsOfFullClusters)
+{
+	JobSystem::Initialize(2);
+
+	// Every light covers the whole view frustum
+	const uint32_t numLights = LIGHT_CLUSTER_MAX_LIGHTS + 36;
+	std::vector<glm::vec4> viewSpheres(numLights, glm::vec4(0.0f, 0.0f, 50.0f, 1000.0f));
+	LightClusterGridData grid = MakeGrid(glm::identity<glm::mat4>(), numLights);
+
+	LightClusterLists lists;
+	LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+	uint32_t numWrongCounts = 0, numWrongIndices = 0;
+	for (uint32_t clusterIndex = 0; clusterIndex < LIGHT_CLUSTER_COUNT; ++clusterIndex)
+	{
+		numWrongCounts += lists.LightCounts[clusterIndex] != numLights ? 1 : 0;
+		for (uint32_t slot = 0; slot < LIGHT_CLUSTER_MAX_LIGHTS; ++slot)
+			numWrongIndices += lists.LightIndices[clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS + slot] != slot ? 1 : 0;
+	}
+
+	EXPECT_EQ(numWrongCounts, 0u);
+	EXPECT_EQ(numWrongIndices, 0u);
+
+	LightClusterStatistics stats = LightClustering::GetStatistics(lists, numLights);
+	EXPECT_EQ(stats.NumLightAssignments, LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+	EXPECT_EQ(stats.NumDroppedAssignments, LIGHT_CLUSTER_COUNT * (numLights - LIGHT_CLUSTER_MAX_LIGHTS));
+	EXPECT_EQ(stats.NumOccupiedClusters, LIGHT_CLUSTER_COUNT);
+	EXPECT_EQ(stats.MaxLightsInCluster, numLights);
+
+	JobSystem::Finalize();
+}
+
+TEST_CASE(LightClusterIgnoresLightsOutsideTheFrustum)
+{
+	JobSystem::Initialize(2);
+
+	std::vector<glm::vec4> viewSpheres =
+	{
+		glm::vec4(0.0f, 0.0f, -2.0f, 1.5f),
+		glm::vec4(0.0f, 0.0f, CAMERA_FAR + 3.0f, 2.0f),
+		glm::vec4(500.0f, 0.0f, 50.0f, 10.0f),
+		glm::vec4(0.0f, -300.0f, 50.0f, 10.0f)
+	};
+	LightClusterGridData grid = MakeGrid(glm::identity<glm::mat4>(), static_cast<uint32_t>(viewSpheres.size()));
+
+	LightClusterLists lists;
+	LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+	LightClusterStatistics stats = LightClustering::GetStatistics(lists, static_cast<uint32_t>(viewSpheres.size()));
+	EXPECT_EQ(stats.NumLightAssignments, 0u);
+	EXPECT_EQ(stats.NumOccupiedClusters, 0u);
+
+	// A light in front of the camera is assigned to the cluster of its center
+	viewSpheres.push_back(glm::vec4(1.0f, 0.5f, 10.0f, 0.01f));
+	grid = MakeGrid(glm::identity<glm::mat4>(), static_cast<uint32_t>(viewSpheres.size()));
+	LightClustering::BuildClusters(grid, viewSpheres, lists);
+
+	glm::vec4 clipPosition = MakeProjection() * glm::vec4(1.0f, 0.5f, 10.0f, 1.0f);
+	glm::vec2 pixel = (glm::vec2(clipPosition.x, -clipPosition.y) / clipPosition.w * 0.5f + 0.5f) * SCREEN_SIZE;
+	uint32_t clusterIndex = LightClustering::GetClusterIndex(grid, pixel, 10.0f);
+
+	EXPECT(lists.LightCounts[clusterIndex] >= 1);
+	EXPECT_EQ(lists.LightIndices[clusterIndex * LIGHT_CLUSTER_MAX_LIGHTS], 4u);
+
+	glm::vec3 boundsMin, boundsMax;
+	LightClustering::CalculateClusterBounds(grid, clusterIndex, boundsMin, boundsMax);
+	EXPECT(glm::all(glm::lessThanEqual(boundsMin, glm::vec3(1.0f, 0.5f, 10.0f))) && glm::all(glm::lessThanEqual(glm::vec3(1.0f, 0.5f, 10.0f), boundsMax)));
+
+	JobSystem::Finalize();
+}
@@ -0,0 +1,242 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+
+#include <thread>
+
+// Lines the test logged, other tests and threads log as well, so only lines with the test prefix are kept
+class CaptureLogSink : public LogSink
+{
+public:
+	virtual void Write(Logger::Severity severity, const std::string& line) override
+	{
+		if (line.find("[LoggerTest]") == std::string::npos)
+			return;
+
+		std::scoped_lock lock(m_Mutex);
+		m_Lines.push_back(line);
+		m_Severities.push_back(severity);
+	}
+
+	std::vector<std::string> GetLines()
+	{
+		std::scoped_lock lock(m_Mutex);
+		return m_Lines;
+	}
+
+	std::vector<Logger::Severity> GetSeverities()
+	{
+		std::scoped_lock lock(m_Mutex);
+		return m_Severities;
+	}
+
+private:
+	std::mutex m_Mutex;
+	std::vector<std::string> m_Lines;
+	std::vector<Logger::Severity> m_Severities;
+
+};
+
+/*
+
+	Holds the first line it gets until it is opened, whoever writes to the sinks holds the drain lock meanwhile,
+	so nothing is drained and the rings of the logging threads fill up.
+
+*/
+class GateLogSink : public CaptureLogSink
+{
+public:
+	virtual void Write(Logger::Severity severity, const std::string& line) override
+	{
+		if (line.find("[LoggerTest]") != std::string::npos && !m_IsClosed.exchange(true))
+		{
+			std::unique_lock lock(m_GateMutex);
+			m_IsWaiting = true;
+			m_GateCondition.notify_all();
+			m_GateCondition.wait_for(lock, std::chrono::seconds(5), [this]() { return m_IsOpen; });
+		}
+
+		CaptureLogSink::Write(severity, line);
+	}
+
+	void WaitUntilClosed()
+	{
+		std::unique_lock lock(m_GateMutex);
+		m_GateCondition.wait_for(lock, std::chrono::seconds(5), [this]() { return m_IsWaiting; });
+	}
+
+	void Open()
+	{
+		std::scoped_lock lock(m_GateMutex);
+		m_IsOpen = true;
+		m_GateCondition.notify_all();
+	}
+
+private:
+	std::atomic<bool> m_IsClosed = false;
+	std::mutex m_GateMutex;
+	std::condition_variable m_GateCondition;
+	bool m_IsWaiting = false;
+	bool m_IsOpen = false;
+
+};
+
+// Runs a test with a sink of its own and without console output, so the test output stays readable
+template<typename Sink, typename Function>
+static void RunWithSink(Function function)
+{
+	auto sink = std::make_shared<Sink>();
+	Logger::Flush();
+	Logger::SetConsoleOutput(false);
+	Logger::AddSink(sink);
+
+	function(*sink);
+
+	Logger::RemoveSink(sink);
+	Logger::SetConsoleOutput(true);
+}
+
+TEST_CASE(LoggerFormat)
+{
+	RunWithSink<CaptureLogSink>([](CaptureLogSink& sink) {
+		std::string name = "Sponza";
+		TrackedString trackedName("Helmet");
+		const char* chars = "chars";
+
+		LOG_INFO("[LoggerTest] {} {} {} {} {}", 42, -7ll, 2.5f, true, 'x');
+		LOG_INFO("[LoggerTest] {} {} {} {}", name, trackedName, chars, std::string_view("view"));
+		LOG_INFO("[LoggerTest] {} and {} {}", 1);
+		LOG_INFO("[LoggerTest] {literal}");
+		Logger::Log(Logger::Severity::WARN, "[LoggerTest] built " + std::to_string(3));
+		Logger::Flush();
+
+		std::vector<std::string> lines = sink.GetLines();
+		EXPECT_EQ(lines.size(), std::size_t(5));
+
+		if (lines.size() == 5)
+		{
+			EXPECT(lines[0] == "[INFO] [LoggerTest] 42 -7 2.500000 true x\n");
+			EXPECT(lines[1] == "[INFO] [LoggerTest] Sponza Helmet chars view\n");
+			EXPECT(lines[2] == "[INFO] [LoggerTest] 1 and {} {}\n");
+			EXPECT(lines[3] == "[INFO] [LoggerTest] {literal}\n");
+			EXPECT(lines[4] == "[WARN] [LoggerTest] built 3\n");
+		}
+	});
+}
+
+TEST_CASE(LoggerSeverityFilter)
+{
+	RunWithSink<CaptureLogSink>([](CaptureLogSink& sink) {
+		uint64_t numMessages = Logger::GetStatistics().NumMessages;
+
+		// Filtered messages are not even copied into the ring
+		Logger::SetMinSeverity(Logger::Severity::WARN);
+		EXPECT(!Logger::IsEnabled(Logger::Severity::INFO));
+		EXPECT(Logger::IsEnabled(Logger::Severity::ERR));
+
+		LOG_INFO("[LoggerTest] filtered");
+		LOG_WARN("[LoggerTest] warning");
+		LOG_ERR("[LoggerTest] error");
+
+		Logger::SetMinSeverity(Logger::Severity::ERR);
+		LOG_WARN("[LoggerTest] filtered");
+
+		Logger::SetMinSeverity(Logger::Severity::INFO);
+		LOG_INFO("[LoggerTest] info");
+		Logger::Flush();
+
+		EXPECT_EQ(Logger::GetStatistics().NumMessages, numMessages + 3);
+		EXPECT(sink.GetLines() == std::vector<std::string>({ "[WARN] [LoggerTest] warning\n", "[ERR] [LoggerTest] error\n", "[INFO] [LoggerTest] info\n" }));
+		EXPECT(sink.GetSeverities() == std::vector<Logger::Severity>({ Logger::Severity::WARN, Logger::Severity::ERR, Logger::Severity::INFO }));
+	});
+}
+
+TEST_CASE(LoggerFlushOnError)
+{
+	RunWithSink<CaptureLogSink>([](CaptureLogSink& sink) {
+		// An error reaches the sinks before LOG_ERR returns, after everything the thread logged before it
+		LOG_INFO("[LoggerTest] first");
+		LOG_WARN("[LoggerTest] second");
+		LOG_ERR("[LoggerTest] third {}", 3);
+
+		EXPECT(sink.GetLines() == std::vector<std::string>({ "[INFO] [LoggerTest] first\n", "[WARN] [LoggerTest] second\n", "[ERR] [LoggerTest] third 3\n" }));
+
+		// So do messages too large for the ring
+		std::string largeMessage(1 << 17, 'a');
+		LOG_INFO("[LoggerTest] before");
+		LOG_INFO("[LoggerTest] {}", largeMessage);
+
+		std::vector<std::string> lines = sink.GetLines();
+		EXPECT_EQ(lines.size(), std::size_t(5));
+		EXPECT(lines.size() == 5 && lines[3] == "[INFO] [LoggerTest] before\n" && lines[4].size() == largeMessage.size() + 21);
+	});
+}
+
+TEST_CASE(LoggerRingOverflow)
+{
+	RunWithSink<GateLogSink>([](GateLogSink& sink) {
+		constexpr uint32_t NUM_MESSAGES = 20000;
+		uint64_t numBlockedMessages = Logger::GetStatistics().NumBlockedMessages;
+
+		// The logger thread gets stuck writing the first message, the opener lets it continue once the ring is long full
+		LOG_INFO("[LoggerTest] {}", 0u);
+		sink.WaitUntilClosed();
+		std::thread opener([&sink]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			sink.Open();
+		});
+
+		std::string padding(64, 'p');
+		for (uint32_t i = 1; i < NUM_MESSAGES; ++i)
+			LOG_INFO("[LoggerTest] {} {}", i, padding);
+
+		opener.join();
+		Logger::Flush();
+
+		// The thread waited for room instead of dropping messages, and they arrived in order
+		EXPECT(Logger::GetStatistics().NumBlockedMessages > numBlockedMessages);
+
+		std::vector<std::string> lines = sink.GetLines();
+		EXPECT_EQ(lines.size(), std::size_t(NUM_MESSAGES));
+
+		bool isOrdered = lines.size() == NUM_MESSAGES;
+		for (uint32_t i = 0; i < NUM_MESSAGES && isOrdered; ++i)
+			isOrdered = lines[i].rfind("[INFO] [LoggerTest] " + std::to_string(i), 0) == 0;
+		EXPECT(isOrdered);
+	});
+}
+
+TEST_CASE(LoggerThreadOrder)
+{
+	RunWithSink<CaptureLogSink>([](CaptureLogSink& sink) {
+		constexpr uint32_t NUM_THREADS = 4;
+		constexpr uint32_t NUM_MESSAGES = 2000;
+
+		std::vector<std::thread> threads;
+		for (uint32_t thread = 0; thread < NUM_THREADS; ++thread)
+		{
+			threads.emplace_back([thread]() {
+				for (uint32_t i = 0; i < NUM_MESSAGES; ++i)
+					LOG_INFO("[LoggerTest] {} {}", thread, i);
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+		Logger::Flush();
+
+		// Messages of different threads interleave, the messages of one thread keep their order
+		std::vector<uint32_t> nextMessage(NUM_THREADS, 0);
+		bool isOrdered = true;
+
+		for (const std::string& line : sink.GetLines())
+		{
+			uint32_t thread = 0, message = 0;
+			isOrdered &= sscanf(line.c_str(), "[INFO] [LoggerTest] %u %u", &thread, &message) == 2 && thread < NUM_THREADS && message == nextMessage[thread];
+			if (thread < NUM_THREADS)
+				nextMessage[thread]++;
+		}
+
+		EXPECT(isOrdered);
+		EXPECT(std::all_of(nextMessage.begin(), nextMessage.end(), [](uint32_t numMessages) { return numMessages == NUM_MESSAGES; }));
+	});
+}
@@ -0,0 +1,179 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Util/MemoryTracker.h"
+
+#include <thread>
+
+// The tracker is global and other tests allocate tracked memory as well, so every test looks at the change it caused
+static const GPUMemoryResource* FindGPUResource(const std::vector<GPUMemoryResource>& resources, const std::string& name)
+{
+	auto iter = std::find_if(resources.begin(), resources.end(), [&name](const GPUMemoryResource& resource) { return resource.Name == name; });
+	return iter != resources.end() ? &*iter : nullptr;
+}
+
+TEST_CASE(MemoryTrackerTrackedContainers)
+{
+	MemoryTagStatistics before = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_SCENE];
+
+	{
+		TrackedVector<uint32_t, MEMORY_TAG_SCENE> values;
+		values.reserve(1000);
+
+		MemoryTagStatistics during = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_SCENE];
+		EXPECT_EQ(during.ByteSize, before.ByteSize + 4000);
+		EXPECT_EQ(during.NumAllocations, before.NumAllocations + 1);
+		EXPECT_EQ(during.NumTotalAllocations, before.NumTotalAllocations + 1);
+		EXPECT(during.PeakByteSize >= during.ByteSize);
+
+		// Growing frees the old storage after the new one was allocated
+		values.reserve(2000);
+		during = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_SCENE];
+		EXPECT_EQ(during.ByteSize, before.ByteSize + 8000);
+		EXPECT_EQ(during.NumAllocations, before.NumAllocations + 1);
+		EXPECT_EQ(during.NumTotalAllocations, before.NumTotalAllocations + 2);
+		EXPECT(during.PeakByteSize >= before.ByteSize + 12000);
+	}
+
+	MemoryTagStatistics after = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_SCENE];
+	EXPECT_EQ(after.ByteSize, before.ByteSize);
+	EXPECT_EQ(after.NumAllocations, before.NumAllocations);
+	EXPECT_EQ(after.NumTotalAllocations, before.NumTotalAllocations + 2);
+
+	// Strings are counted under their own tag, short strings stay inside the string object
+	uint64_t stringByteSize = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_STRINGS].ByteSize;
+	{
+		TrackedString name(256, 'x');
+		EXPECT(MemoryTracker::GetStatistics().Tags[MEMORY_TAG_STRINGS].ByteSize > stringByteSize);
+	}
+	EXPECT_EQ(MemoryTracker::GetStatistics().Tags[MEMORY_TAG_STRINGS].ByteSize, stringByteSize);
+}
+
+TEST_CASE(MemoryTrackerThreads)
+{
+	constexpr uint32_t NUM_THREADS = 8;
+	constexpr uint32_t NUM_ALLOCATIONS = 10000;
+
+	MemoryTagStatistics before = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_ASSETS];
+
+	std::vector<std::thread> threads;
+	for (uint32_t thread = 0; thread < NUM_THREADS; ++thread)
+	{
+		threads.emplace_back([]() {
+			for (uint32_t i = 0; i < NUM_ALLOCATIONS; ++i)
+			{
+				MemoryTracker::TrackAllocation(MEMORY_TAG_ASSETS, 64 + i % 7);
+				MemoryTracker::TrackFree(MEMORY_TAG_ASSETS, 64 + i % 7);
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// No update of the counters is lost
+	MemoryTagStatistics after = MemoryTracker::GetStatistics().Tags[MEMORY_TAG_ASSETS];
+	EXPECT_EQ(after.ByteSize, before.ByteSize);
+	EXPECT_EQ(after.NumAllocations, before.NumAllocations);
+	EXPECT_EQ(after.NumTotalAllocations, before.NumTotalAllocations + NUM_THREADS * NUM_ALLOCATIONS);
+	EXPECT(after.PeakByteSize >= before.ByteSize + 64);
+	EXPECT(after.PeakByteSize <= std::max(before.PeakByteSize, before.ByteSize + NUM_THREADS * 70));
+}
+
+TEST_CASE(MemoryTrackerGPUResources)
+{
+	MemoryStatistics before = MemoryTracker::GetStatistics();
+	const GPUMemoryCategoryStatistics& shadowsBefore = before.GPUCategories[GPU_MEMORY_CATEGORY_SHADOW_MAPS];
+	const GPUMemoryCategoryStatistics& meshesBefore = before.GPUCategories[GPU_MEMORY_CATEGORY_MESH_BUFFERS];
+
+	uint32_t atlasID = MemoryTracker::AddGPUResource("MemoryTrackerTestAtlas", GPU_MEMORY_CATEGORY_SHADOW_MAPS, 64ull << 20);
+	uint32_t vertexID = MemoryTracker::AddGPUResource("MemoryTrackerTestVertices", GPU_MEMORY_CATEGORY_MESH_BUFFERS, 3ull << 20);
+	uint32_t indexID = MemoryTracker::AddGPUResource("MemoryTrackerTestIndices", GPU_MEMORY_CATEGORY_MESH_BUFFERS, 1ull << 20);
+	EXPECT(atlasID != vertexID && vertexID != indexID && atlasID != indexID);
+
+	MemoryStatistics during = MemoryTracker::GetStatistics();
+	EXPECT_EQ(during.GPUCategories[GPU_MEMORY_CATEGORY_SHADOW_MAPS].ByteSize, shadowsBefore.ByteSize + (64ull << 20));
+	EXPECT_EQ(during.GPUCategories[GPU_MEMORY_CATEGORY_SHADOW_MAPS].NumResources, shadowsBefore.NumResources + 1);
+	EXPECT_EQ(during.GPUCategories[GPU_MEMORY_CATEGORY_MESH_BUFFERS].ByteSize, meshesBefore.ByteSize + (4ull << 20));
+	EXPECT_EQ(during.GPUCategories[GPU_MEMORY_CATEGORY_MESH_BUFFERS].NumResources, meshesBefore.NumResources + 2);
+	EXPECT_EQ(during.GPUByteSize, before.GPUByteSize + (68ull << 20));
+
+	// The largest resources come first, the ones of this test keep their order among them
+	std::vector<GPUMemoryResource> largest;
+	MemoryTracker::GetLargestGPUResources(std::numeric_limits<uint32_t>::max(), largest);
+	EXPECT(std::is_sorted(largest.begin(), largest.end(), [](const GPUMemoryResource& lhs, const GPUMemoryResource& rhs) { return lhs.ByteSize > rhs.ByteSize; }));
+
+	const GPUMemoryResource* atlas = FindGPUResource(largest, "MemoryTrackerTestAtlas");
+	const GPUMemoryResource* vertices = FindGPUResource(largest, "MemoryTrackerTestVertices");
+	const GPUMemoryResource* indices = FindGPUResource(largest, "MemoryTrackerTestIndices");
+	EXPECT(atlas && vertices && indices);
+	EXPECT(atlas < vertices && vertices < indices);
+	EXPECT(atlas && atlas->Category == GPU_MEMORY_CATEGORY_SHADOW_MAPS);
+
+	MemoryTracker::GetLargestGPUResources(1, largest);
+	EXPECT_EQ(largest.size(), std::size_t(1));
+
+	// Removed resources free their slot for the next one, the category keeps its peak
+	MemoryTracker::RemoveGPUResource(atlasID);
+	MemoryTracker::RemoveGPUResource(MEMORY_TRACKER_INVALID_ID);
+	uint32_t reusedID = MemoryTracker::AddGPUResource("MemoryTrackerTestReused", GPU_MEMORY_CATEGORY_SHADOW_MAPS, 1ull << 20);
+	EXPECT_EQ(reusedID, atlasID);
+
+	MemoryStatistics after = MemoryTracker::GetStatistics();
+	EXPECT_EQ(after.GPUCategories[GPU_MEMORY_CATEGORY_SHADOW_MAPS].ByteSize, shadowsBefore.ByteSize + (1ull << 20));
+	EXPECT(after.GPUCategories[GPU_MEMORY_CATEGORY_SHADOW_MAPS].PeakByteSize >= shadowsBefore.ByteSize + (64ull << 20));
+
+	// Everything alive is reported as a leak
+	uint32_t numResourcesBefore = 0;
+	for (const GPUMemoryCategoryStatistics& category : before.GPUCategories)
+		numResourcesBefore += category.NumResources;
+
+	EXPECT_EQ(MemoryTracker::ReportLeaks(), numResourcesBefore + 3);
+
+	MemoryTracker::RemoveGPUResource(reusedID);
+	MemoryTracker::RemoveGPUResource(vertexID);
+	MemoryTracker::RemoveGPUResource(indexID);
+
+	after = MemoryTracker::GetStatistics();
+	EXPECT_EQ(after.GPUByteSize, before.GPUByteSize);
+	EXPECT_EQ(after.GPUCategories[GPU_MEMORY_CATEGORY_MESH_BUFFERS].NumResources, meshesBefore.NumResources);
+}
+
+TEST_CASE(MemoryTrackerFrameDeltas)
+{
+	MemoryTracker::EndFrame();
+
+	TrackedVector<uint8_t, MEMORY_TAG_RENDER> values;
+	values.reserve(4096);
+	uint32_t targetID = MemoryTracker::AddGPUResource("MemoryTrackerTestTarget", GPU_MEMORY_CATEGORY_RENDER_TARGETS, 1 << 16);
+
+	// Deltas are taken at the end of a frame and stay until the next one
+	MemoryTracker::EndFrame();
+	MemoryStatistics stats = MemoryTracker::GetStatistics();
+	EXPECT_EQ(stats.Tags[MEMORY_TAG_RENDER].FrameDelta, 4096ll);
+	EXPECT_EQ(stats.GPUCategories[GPU_MEMORY_CATEGORY_RENDER_TARGETS].FrameDelta, 65536ll);
+	EXPECT_EQ(stats.GPUFrameDelta, 65536ll);
+
+	MemoryTracker::EndFrame();
+	stats = MemoryTracker::GetStatistics();
+	EXPECT_EQ(stats.Tags[MEMORY_TAG_RENDER].FrameDelta, 0ll);
+	EXPECT_EQ(stats.GPUFrameDelta, 0ll);
+
+	// Resources remember the frame they were created in
+	uint32_t laterID = MemoryTracker::AddGPUResource("MemoryTrackerTestLater", GPU_MEMORY_CATEGORY_RENDER_TARGETS, 1 << 10);
+	std::vector<GPUMemoryResource> resources;
+	MemoryTracker::GetLargestGPUResources(std::numeric_limits<uint32_t>::max(), resources);
+
+	const GPUMemoryResource* target = FindGPUResource(resources, "MemoryTrackerTestTarget");
+	const GPUMemoryResource* later = FindGPUResource(resources, "MemoryTrackerTestLater");
+	EXPECT(target && later);
+	EXPECT(target && later && later->Frame == target->Frame + 2);
+
+	MemoryTracker::RemoveGPUResource(targetID);
+	MemoryTracker::RemoveGPUResource(laterID);
+	decltype(values)().swap(values);
+
+	MemoryTracker::EndFrame();
+	stats = MemoryTracker::GetStatistics();
+	EXPECT_EQ(stats.Tags[MEMORY_TAG_RENDER].FrameDelta, -4096ll);
+	EXPECT_EQ(stats.GPUCategories[GPU_MEMORY_CATEGORY_RENDER_TARGETS].FrameDelta, -65536ll);
+}
@@ -0,0 +1,96 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Resource/GLTFDocument.h"
+#include "Resource/ModelImporter.h"
+
+#include <filesystem>
+
+// One triangle with zero positions, normals and texture coordinates, followed by the indices 0, 1, 2
+static const char* TRIANGLE_DOCUMENT = R"({
+	"asset": { "version": "2.0" },
+	"buffers": [ { "byteLength": 104, "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAABAAIAAAA=" } ],
+	"bufferViews": [
+		{ "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+		{ "buffer": 0, "byteOffset": 36, "byteLength": 36 },
+		{ "buffer": 0, "byteOffset": 72, "byteLength": 24 },
+		{ "buffer": 0, "byteOffset": 96, "byteLength": 6 }
+	],
+	"accessors": [
+		{ "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" },
+		{ "bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3" },
+		{ "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC2" },
+		{ "bufferView": 3, "componentType": 5123, "count": 3, "type": "SCALAR" }
+	],
+	"meshes": [ { "name": "Triangle", "primitives": [ { "attributes": { "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }, "indices": 3 } ] } ]
+})";
+
+// Number of primitives ReadGeometry imports from the triangle document with a part of it replaced
+static std::size_t ImportPrimitives(const std::string& from, const std::string& to)
+{
+	std::string document = TRIANGLE_DOCUMENT;
+	std::size_t offset = document.find(from);
+	if (offset == std::string::npos)
+	{
+		Test::ReportFailure(__FILE__, __LINE__, from + " to be part of the triangle document");
+		return 0;
+	}
+
+	document.replace(offset, from.size(), to);
+	std::string filepath = Test::WriteTemporaryFile("dx12r_tests_triangle.gltf", document);
+
+	std::size_t numPrimitives = 0;
+	{
+		GLTFDocument gltfDocument(filepath);
+		if (!gltfDocument.IsValid())
+			Test::ReportFailure(__FILE__, __LINE__, "a valid document");
+
+		ImportedGeometry geometry = ModelImporter::ReadGeometry(gltfDocument);
+		numPrimitives = geometry.Primitives.size();
+	}
+
+	std::filesystem::remove(filepath);
+	return numPrimitives;
+}
+
+TEST_CASE(ModelImporterReadsTriangle)
+{
+	std::string filepath = Test::WriteTemporaryFile("dx12r_tests_triangle.gltf", TRIANGLE_DOCUMENT);
+
+	{
+		GLTFDocument document(filepath);
+		ImportedGeometry geometry = ModelImporter::ReadGeometry(document);
+
+		EXPECT_EQ(geometry.Primitives.size(), 1u);
+		EXPECT_EQ(geometry.MeshFirstPrimitive.size(), 2u);
+		if (geometry.Primitives.size() == 1)
+		{
+			EXPECT_EQ(geometry.Primitives[0].Vertices.size(), 3u);
+			EXPECT_EQ(geometry.Primitives[0].Indices.size(), 3u);
+			EXPECT_EQ(geometry.Primitives[0].Indices[2], 2u);
+		}
+	}
+
+	std::filesystem::remove(filepath);
+}
+
+TEST_CASE(ModelImporterRejectsMalformedPrimitives)
+{
+	// Index 2 refers past the last of two vertices
+	EXPECT_EQ(ImportPrimitives(R"("componentType": 5126, "count": 3, "type": "VEC3" },)", R"("componentType": 5126, "count": 2, "type": "VEC3" },)"), 0u);
+	// Attributes with less elements than positions
+	EXPECT_EQ(ImportPrimitives(R"("count": 3, "type": "VEC2")", R"("count": 2, "type": "VEC2")"), 0u);
+	EXPECT_EQ(ImportPrimitives(R"({ "bufferView": 1, "componentType": 5126, "count": 3)", R"({ "bufferView": 1, "componentType": 5126, "count": 1)"), 0u);
+	// Missing attributes, and attributes with too few components
+	EXPECT_EQ(ImportPrimitives(R"("NORMAL": 1, )", ""), 0u);
+	EXPECT_EQ(ImportPrimitives(R"("count": 3, "type": "VEC2")", R"("count": 3, "type": "SCALAR")"), 0u);
+	// Indices that are not unsigned integer scalars, or do not form whole triangles
+	EXPECT_EQ(ImportPrimitives(R"("componentType": 5123, "count": 3)", R"("componentType": 5122, "count": 3)"), 0u);
+	EXPECT_EQ(ImportPrimitives(R"("componentType": 5123, "count": 3)", R"("componentType": 5123, "count": 2)"), 0u);
+}
+
+TEST_CASE(ModelImporterTransparencyModes)
+{
+	EXPECT(ModelImporter::GetTransparencyMode(GLTFAlphaMode::GLTF_ALPHA_MODE_OPAQUE) == TransparencyMode::OPAQUE);
+	EXPECT(ModelImporter::GetTransparencyMode(GLTFAlphaMode::GLTF_ALPHA_MODE_MASK) == TransparencyMode::MASKED);
+	EXPECT(ModelImporter::GetTransparencyMode(GLTFAlphaMode::GLTF_ALPHA_MODE_BLEND) == TransparencyMode::TRANSPARENT);
+}
@@ -0,0 +1,131 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/Backend/PipelineStateCache.h"
+
+// Stand-in for a pipeline state object, the cache only passes the pointer around
+struct FakePipelineState
+{
+	uint32_t Value = 0;
+};
+
+static Hash128 MakeKey(const char* shaderName, uint32_t renderTargetFormat)
+{
+	PipelineStateHasher hasher;
+	hasher.AddString(shaderName);
+	hasher.Add(renderTargetFormat);
+
+	return hasher.GetHash();
+}
+
+TEST_CASE(PipelineStateHasherIsDeterministic)
+{
+	EXPECT(MakeKey("Lighting", 1) == MakeKey("Lighting", 1));
+	EXPECT(MakeKey("Lighting", 1) != MakeKey("Lighting", 2));
+	EXPECT(MakeKey("Lighting", 1) != MakeKey("Shadow", 1));
+
+	// The order of the fields matters
+	PipelineStateHasher lhs, rhs;
+	lhs.Add(1u);
+	lhs.Add(2u);
+	rhs.Add(2u);
+	rhs.Add(1u);
+	EXPECT(lhs.GetHash() != rhs.GetHash());
+
+	// Variable length fields do not shift bytes into each other
+	PipelineStateHasher ab, a;
+	ab.AddString("ab");
+	ab.AddString("c");
+	a.AddString("a");
+	a.AddString("bc");
+	EXPECT(ab.GetHash() != a.GetHash());
+
+	// A null string hashes like an empty one, and differs from no field at all
+	PipelineStateHasher nullString, emptyString;
+	nullString.AddString(nullptr);
+	emptyString.AddString("");
+	EXPECT(nullString.GetHash() == emptyString.GetHash());
+	EXPECT(nullString.GetHash() != PipelineStateHasher().GetHash());
+}
+
+TEST_CASE(PipelineStateCacheDeduplicatesRequests)
+{
+	JobSystem::Initialize(2);
+
+	std::atomic<uint32_t> numCreates = 0;
+	std::vector<void*> releasedStates;
+
+	{
+		PipelineStateCache cache([&releasedStates](void* pipelineState)
+		{
+			releasedStates.push_back(pipelineState);
+			delete static_cast<FakePipelineState*>(pipelineState);
+		});
+
+		auto create = [&numCreates](uint32_t value)
+		{
+			return [&numCreates, value]() -> void*
+			{
+				numCreates++;
+				return new FakePipelineState{ value };
+			};
+		};
+
+		uint32_t lightingID = cache.Request(MakeKey("Lighting", 1), "Lighting", create(1));
+		uint32_t shadowID = cache.Request(MakeKey("Shadow", 1), "Shadow", create(2));
+		uint32_t duplicateID = cache.Request(MakeKey("Lighting", 1), "Lighting duplicate", create(3));
+
+		EXPECT(lightingID != shadowID);
+		EXPECT_EQ(duplicateID, lightingID);
+		EXPECT_EQ(cache.GetNumPipelineStates(), 2u);
+		EXPECT(cache.GetName(duplicateID) == "Lighting");
+		EXPECT(cache.GetKey(shadowID) == MakeKey("Shadow", 1));
+
+		FakePipelineState* lighting = static_cast<FakePipelineState*>(cache.WaitForPipelineState(lightingID));
+		EXPECT(lighting != nullptr && lighting->Value == 1);
+		EXPECT(cache.GetStatus(lightingID) == PipelineStateStatus::PIPELINE_STATE_STATUS_READY);
+		EXPECT(cache.GetPipelineState(lightingID) == lighting);
+
+		cache.WaitForAll();
+		EXPECT_EQ(numCreates.load(), 2u);
+
+		PipelineStateCacheStatistics stats = cache.GetStatistics();
+		EXPECT_EQ(stats.NumRequests, 3u);
+		EXPECT_EQ(stats.NumDeduplicated, 1u);
+		EXPECT_EQ(stats.NumCreated, 2u);
+		EXPECT_EQ(stats.NumPending, 0u);
+		EXPECT_EQ(stats.NumFailed, 0u);
+	}
+
+	// Every created pipeline state is released exactly once
+	EXPECT_EQ(releasedStates.size(), std::size_t(2));
+	EXPECT(releasedStates.size() == 2 && releasedStates[0] != releasedStates[1]);
+
+	JobSystem::Finalize();
+}
+
+TEST_CASE(PipelineStateCacheReportsFailures)
+{
+	JobSystem::Initialize(2);
+
+	uint32_t numReleases = 0;
+	{
+		PipelineStateCache cache([&numReleases](void*) { numReleases++; });
+
+		uint32_t id = cache.Request(MakeKey("Broken", 1), "Broken", []() -> void* { return nullptr; });
+		EXPECT(cache.WaitForPipelineState(id) == nullptr);
+		EXPECT(cache.GetStatus(id) == PipelineStateStatus::PIPELINE_STATE_STATUS_FAILED);
+		EXPECT(cache.GetPipelineState(id) == nullptr);
+
+		// A failed key is not created again
+		EXPECT_EQ(cache.Request(MakeKey("Broken", 1), "Broken", []() -> void* { return nullptr; }), id);
+
+		PipelineStateCacheStatistics stats = cache.GetStatistics();
+		EXPECT_EQ(stats.NumFailed, 1u);
+		EXPECT_EQ(stats.NumCreated, 0u);
+		EXPECT_EQ(stats.NumPending, 0u);
+	}
+
+	EXPECT_EQ(numReleases, 0u);
+
+	JobSystem::Finalize();
+}
@@ -0,0 +1,198 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Util/Profiler.h"
+
+#include <thread>
+
+static constexpr ProfilerZone s_OuterZone = { "ProfilerTestOuter", __FILE__, __LINE__ };
+static constexpr ProfilerZone s_InnerZone = { "ProfilerTestInner", __FILE__, __LINE__ };
+
+// The profiler is global, the test thread is found by its name and zones by their descriptors
+static const ProfilerThreadFrame* FindTestThreadFrame()
+{
+	for (const ProfilerThreadFrame& threadFrame : Profiler::GetThreadFrames())
+	{
+		if (threadFrame.Name == "ProfilerTests")
+			return &threadFrame;
+	}
+
+	return nullptr;
+}
+
+static const ProfilerZoneNode* FindNode(const ProfilerZone& zone)
+{
+	const ProfilerThreadFrame* threadFrame = FindTestThreadFrame();
+	if (!threadFrame)
+		return nullptr;
+
+	for (const ProfilerZoneNode& node : threadFrame->Nodes)
+	{
+		if (node.Zone == &zone)
+			return &node;
+	}
+
+	return nullptr;
+}
+
+static const ProfilerZoneStatistics* FindZoneStatistics(const char* name)
+{
+	for (const ProfilerZoneStatistics& zoneStatistics : Profiler::GetZoneStatistics())
+	{
+		if (strcmp(zoneStatistics.Name.c_str(), name) == 0)
+			return &zoneStatistics;
+	}
+
+	return nullptr;
+}
+
+TEST_CASE(ProfilerNestedZones)
+{
+	Profiler::SetThreadName("ProfilerTests");
+	Profiler::EndFrame();
+
+	// Calls of a zone with the same parent are merged into one node
+	EXPECT(Profiler::BeginZone(s_OuterZone));
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		EXPECT(Profiler::BeginZone(s_InnerZone));
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		Profiler::EndZone();
+	}
+	Profiler::EndZone();
+	Profiler::EndFrame();
+
+	const ProfilerThreadFrame* threadFrame = FindTestThreadFrame();
+	const ProfilerZoneNode* outer = FindNode(s_OuterZone);
+	const ProfilerZoneNode* inner = FindNode(s_InnerZone);
+	EXPECT(threadFrame && outer && inner);
+
+	if (threadFrame && outer && inner)
+	{
+		EXPECT_EQ(threadFrame->Nodes.size(), std::size_t(2));
+		EXPECT(outer < inner);
+		EXPECT(outer->Depth == 0u && outer->NumCalls == 1u);
+		EXPECT(inner->Depth == 1u && inner->NumCalls == 3u);
+		EXPECT(inner->Duration >= 3.0f * 0.9f && inner->Duration <= outer->Duration);
+		EXPECT(inner->MaxDuration <= inner->Duration);
+	}
+
+	// Nothing ran since, the tree is empty
+	Profiler::EndFrame();
+	threadFrame = FindTestThreadFrame();
+	EXPECT(threadFrame && threadFrame->Nodes.empty());
+}
+
+TEST_CASE(ProfilerZoneAcrossFrames)
+{
+	Profiler::SetThreadName("ProfilerTests");
+	Profiler::EndFrame();
+
+	// An open zone does not show up until a zone nested in it ends, and is counted in the frame it ends in
+	EXPECT(Profiler::BeginZone(s_OuterZone));
+	Profiler::EndFrame();
+	EXPECT(FindNode(s_OuterZone) == nullptr);
+
+	EXPECT(Profiler::BeginZone(s_InnerZone));
+	Profiler::EndZone();
+	Profiler::EndFrame();
+
+	const ProfilerZoneNode* outer = FindNode(s_OuterZone);
+	const ProfilerZoneNode* inner = FindNode(s_InnerZone);
+	EXPECT(outer && outer->NumCalls == 0u);
+	EXPECT(inner && inner->NumCalls == 1u && inner->Depth == 1u);
+
+	Profiler::EndZone();
+	Profiler::EndFrame();
+	outer = FindNode(s_OuterZone);
+	EXPECT(outer && outer->NumCalls == 1u && outer->Depth == 0u);
+	EXPECT(FindNode(s_InnerZone) == nullptr);
+}
+
+TEST_CASE(ProfilerDroppedZones)
+{
+	Profiler::SetThreadName("ProfilerTests");
+	Profiler::EndFrame();
+
+	// Zones fill the ring of the thread until the next frame drains it, whole zones are dropped after that
+	uint64_t numDroppedBefore = Profiler::GetStatistics().NumDroppedZones;
+	uint32_t numRecorded = 0;
+
+	while (Profiler::BeginZone(s_InnerZone))
+	{
+		Profiler::EndZone();
+		numRecorded++;
+	}
+
+	EXPECT(!Profiler::BeginZone(s_OuterZone));
+	EXPECT_EQ(Profiler::GetStatistics().NumDroppedZones, numDroppedBefore + 2);
+
+	Profiler::EndFrame();
+	const ProfilerZoneNode* inner = FindNode(s_InnerZone);
+	EXPECT(inner && inner->NumCalls == numRecorded);
+	EXPECT(numRecorded > 1000u);
+
+	// The drained ring has room again
+	EXPECT(Profiler::BeginZone(s_OuterZone));
+	Profiler::EndZone();
+	Profiler::EndFrame();
+	EXPECT(FindNode(s_OuterZone) != nullptr);
+}
+
+TEST_CASE(ProfilerZoneFrameStatistics)
+{
+	Profiler::SetThreadName("ProfilerTests");
+	Profiler::SetStatisticsWindow(16);
+	Profiler::EndFrame();
+
+	ProfilerGPUZone gpuZone;
+	gpuZone.Name = "ProfilerTestGPU";
+	gpuZone.Duration = 2.5f;
+
+	// Every frame runs the CPU zone twice and reports one GPU zone, the frame takes at least 2 ms
+	for (uint32_t frame = 0; frame < 4; ++frame)
+	{
+		for (uint32_t i = 0; i < 2; ++i)
+		{
+			EXPECT(Profiler::BeginZone(s_InnerZone));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			Profiler::EndZone();
+		}
+
+		Profiler::AddGPUZones({ gpuZone });
+		EXPECT(Profiler::GetGPUZones().empty() || Profiler::GetGPUZones()[0].Duration == 2.5f);
+		Profiler::EndFrame();
+
+		EXPECT_EQ(Profiler::GetGPUZones().size(), std::size_t(1));
+		EXPECT(Profiler::GetFrameTime() >= 2.0f * 0.9f);
+	}
+
+	const ProfilerZoneStatistics* cpuStatistics = FindZoneStatistics("ProfilerTestInner");
+	const ProfilerZoneStatistics* gpuStatistics = FindZoneStatistics("ProfilerTestGPU");
+	EXPECT(cpuStatistics && gpuStatistics);
+
+	if (cpuStatistics && gpuStatistics)
+	{
+		FrameTimeStatistics cpuStats = cpuStatistics->Statistics.GetStatistics();
+		FrameTimeStatistics gpuStats = gpuStatistics->Statistics.GetStatistics();
+
+		// The zone time of a frame is the sum of its calls
+		EXPECT(!cpuStatistics->IsGPUZone);
+		EXPECT_EQ(cpuStats.NumSamples, 4u);
+		EXPECT(cpuStats.Min >= 2.0f * 0.9f);
+
+		EXPECT(gpuStatistics->IsGPUZone);
+		EXPECT_EQ(gpuStats.NumSamples, 4u);
+		EXPECT(gpuStats.Min == 2.5f && gpuStats.Max == 2.5f);
+	}
+
+	EXPECT(Profiler::GetFrameStatistics().GetNumSamples() == 5u);
+	EXPECT(Profiler::GetFrameStatistics().GetWindowSize() == 16u);
+
+	Profiler::ResetStatistics();
+	EXPECT_EQ(Profiler::GetFrameStatistics().GetNumSamples(), 0u);
+	EXPECT(!cpuStatistics || cpuStatistics->Statistics.GetNumSamples() == 0u);
+
+	// Releases the tracked zone names of the statistics
+	Profiler::Finalize();
+	EXPECT(Profiler::GetZoneStatistics().empty());
+}
@@ -0,0 +1,253 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShaderCache.h"
+#include "Util/JobSystem.h"
+
+#include <filesystem>
+#include <fstream>
+
+/*
+
+	Compiles a shader into the concatenated code of its sources, so a binary shows exactly which sources it was built from.
+	Shaders with #error fail, every call is counted so the test can tell compiles from cache hits.
+
+*/
+class FakeShaderCompiler : public ShaderCompiler
+{
+public:
+	FakeShaderCompiler(uint64_t version)
+		: m_Version(version)
+	{
+	}
+
+	virtual Hash128 GetVersionHash() const override { return Hash::Value(m_Version); }
+
+	virtual bool Compile(const ShaderCompileDesc& desc, const ShaderSources& sources, ShaderBinary& outBinary, std::string& outMessages) override
+	{
+		NumCompiles++;
+
+		std::string code = desc.EntryPoint + ";" + desc.Target + ";";
+		for (const ShaderSourceFile& source : sources)
+			code += source.Code;
+
+		if (code.find("#error") != std::string::npos)
+		{
+			outMessages = "error: #error";
+			return false;
+		}
+
+		outBinary.Bytecode.assign(code.begin(), code.end());
+		outBinary.Reflection.assign({ 1, 2, 3 });
+		return true;
+	}
+
+public:
+	std::atomic<uint32_t> NumCompiles = 0;
+
+private:
+	uint64_t m_Version = 0;
+
+};
+
+static const std::filesystem::path SHADER_DIRECTORY = std::filesystem::temp_directory_path() / "dx12r_tests_shaders";
+static const std::filesystem::path SHADER_CACHE_DIRECTORY = std::filesystem::temp_directory_path() / "dx12r_tests_shader_cache";
+
+static std::string WriteShader(const std::string& filename, const std::string& code)
+{
+	std::filesystem::path filepath = SHADER_DIRECTORY / filename;
+	std::filesystem::create_directories(filepath.parent_path());
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	file << code;
+
+	return filepath.lexically_normal().generic_string();
+}
+
+// A pixel shader that includes Common.hlsl, which includes a nested file, and a vertex shader that includes nothing
+static void WriteShaderDirectory()
+{
+	std::error_code error;
+	std::filesystem::remove_all(SHADER_DIRECTORY, error);
+	std::filesystem::remove_all(SHADER_CACHE_DIRECTORY, error);
+
+	WriteShader("Common.hlsl", "#include \"Include/Nested.hlsl\"\nfloat Common;\n");
+	WriteShader("Include/Nested.hlsl", "  #  include \"../Common.hlsl\"\nfloat Nested;\n");
+	WriteShader("Lighting_PS.hlsl", "#include \"Common.hlsl\"\n// #include \"Commented.hlsl\"\n/* #include \"Block.hlsl\" */\n#include \"Missing.hlsl\"\nfloat4 main() : SV_Target;\n");
+	WriteShader("Mesh_VS.hlsl", "float4 main() : SV_Position;\n");
+}
+
+static std::string GetBytecode(const std::shared_ptr<const ShaderBinary>& binary)
+{
+	return binary ? std::string(binary->Bytecode.begin(), binary->Bytecode.end()) : std::string();
+}
+
+static ShaderCompileDesc MakeDesc(const std::string& filename, const char* target)
+{
+	ShaderCompileDesc desc;
+	desc.Filepath = (SHADER_DIRECTORY / filename).generic_string();
+	desc.Target = target;
+	desc.Flags = SHADER_COMPILE_FLAG_NONE;
+	return desc;
+}
+
+TEST_CASE(ShaderCacheLoadSources)
+{
+	WriteShaderDirectory();
+
+	ShaderSources sources;
+	EXPECT(ShaderCache::LoadSources((SHADER_DIRECTORY / "Lighting_PS.hlsl").string(), sources));
+	EXPECT_EQ(sources.size(), std::size_t(4));
+
+	// The main file, its includes in order, then the nested include, every file once and commented includes skipped
+	if (sources.size() == 4)
+	{
+		EXPECT(sources[0].Filepath == (SHADER_DIRECTORY / "Lighting_PS.hlsl").lexically_normal().generic_string() && sources[0].Exists);
+		EXPECT(sources[1].Filepath == (SHADER_DIRECTORY / "Common.hlsl").lexically_normal().generic_string() && sources[1].Exists);
+		EXPECT(sources[2].Filepath == (SHADER_DIRECTORY / "Missing.hlsl").lexically_normal().generic_string() && !sources[2].Exists);
+		EXPECT(sources[3].Filepath == (SHADER_DIRECTORY / "Include/Nested.hlsl").lexically_normal().generic_string() && sources[3].Exists);
+		EXPECT(sources[3].Code.find("float Nested;") != std::string::npos);
+	}
+
+	EXPECT(!ShaderCache::LoadSources((SHADER_DIRECTORY / "Nonexistent_PS.hlsl").string(), sources));
+}
+
+TEST_CASE(ShaderCacheKeys)
+{
+	WriteShaderDirectory();
+	ShaderCache::Initialize(std::make_unique<FakeShaderCompiler>(1), { SHADER_CACHE_DIRECTORY.string() });
+
+	ShaderCompileDesc desc = MakeDesc("Lighting_PS.hlsl", SHADER_TARGET_PIXEL);
+	ShaderSources sources;
+	ShaderCache::LoadSources(desc.Filepath, sources);
+	Hash128 key = ShaderCache::HashShader(desc, sources);
+
+	EXPECT(ShaderCache::HashShader(desc, sources) == key);
+
+	auto hashWith = [&sources](const ShaderCompileDesc& changedDesc) { return ShaderCache::HashShader(changedDesc, sources); };
+	ShaderCompileDesc changed = desc;
+	changed.EntryPoint = "PSMain";
+	EXPECT(hashWith(changed) != key);
+	changed = desc;
+	changed.Target = SHADER_TARGET_COMPUTE;
+	EXPECT(hashWith(changed) != key);
+	changed = desc;
+	changed.Flags = SHADER_COMPILE_FLAG_DEBUG;
+	EXPECT(hashWith(changed) != key);
+
+	// Defines are hashed one by one, so moving characters between them changes the key
+	changed = desc;
+	changed.Defines = { "A", "BC" };
+	Hash128 definesKey = hashWith(changed);
+	EXPECT(definesKey != key);
+	changed.Defines = { "AB", "C" };
+	EXPECT(hashWith(changed) != definesKey);
+
+	// Editing an include, or creating a missing one, changes the key of every shader that includes it
+	WriteShader("Include/Nested.hlsl", "float Nested2;\n");
+	ShaderCache::LoadSources(desc.Filepath, sources);
+	Hash128 editedKey = ShaderCache::HashShader(desc, sources);
+	EXPECT(editedKey != key);
+
+	WriteShader("Missing.hlsl", "");
+	ShaderCache::LoadSources(desc.Filepath, sources);
+	EXPECT(ShaderCache::HashShader(desc, sources) != editedKey);
+
+	// Binaries of another compiler version are never used
+	ShaderCache::Finalize();
+	ShaderCache::Initialize(std::make_unique<FakeShaderCompiler>(2), { SHADER_CACHE_DIRECTORY.string() });
+	EXPECT(ShaderCache::HashShader(desc, sources) != key);
+	ShaderCache::Finalize();
+}
+
+TEST_CASE(ShaderCacheHits)
+{
+	WriteShaderDirectory();
+	JobSystem::Initialize(4);
+
+	auto compiler = std::make_unique<FakeShaderCompiler>(1);
+	FakeShaderCompiler* fakeCompiler = compiler.get();
+	ShaderCache::Initialize(std::move(compiler), { SHADER_CACHE_DIRECTORY.string() });
+	ShaderCache::ResetStatistics();
+
+	std::vector<ShaderCompileDesc> descs = { MakeDesc("Lighting_PS.hlsl", SHADER_TARGET_PIXEL), MakeDesc("Mesh_VS.hlsl", SHADER_TARGET_VERTEX),
+		MakeDesc("Lighting_PS.hlsl", SHADER_TARGET_PIXEL) };
+	std::vector<std::shared_ptr<const ShaderBinary>> binaries;
+
+	// Requests with the same key in one batch are compiled once and share the binary
+	ShaderCache::CompileShaders(descs, binaries);
+	EXPECT_EQ(fakeCompiler->NumCompiles.load(), 2u);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumCompiled, 2u);
+	EXPECT(binaries[0] && binaries[1] && binaries[0] == binaries[2]);
+	EXPECT(GetBytecode(binaries[0]).find("float Nested;") != std::string::npos);
+	EXPECT(GetBytecode(binaries[1]).find("SV_Position") != std::string::npos);
+	std::string lightingBytecode = GetBytecode(binaries[0]);
+
+	ShaderCache::CompileShaders(descs, binaries);
+	EXPECT_EQ(fakeCompiler->NumCompiles.load(), 2u);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumMemoryHits, 3u);
+
+	// A new launch loads the binaries from disk
+	ShaderCache::ClearMemory();
+	ShaderCache::CompileShaders(descs, binaries);
+	EXPECT_EQ(fakeCompiler->NumCompiles.load(), 2u);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumDiskHits, 2u);
+	EXPECT(GetBytecode(binaries[0]) == lightingBytecode);
+	EXPECT(binaries[0] && binaries[0]->Reflection == std::vector<uint8_t>({ 1, 2, 3 }));
+
+	// Only the shaders that include an edited file are compiled again
+	WriteShader("Common.hlsl", "#include \"Include/Nested.hlsl\"\nfloat Common2;\n");
+	ShaderCache::CompileShaders(descs, binaries);
+	EXPECT_EQ(fakeCompiler->NumCompiles.load(), 3u);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumMemoryHits, 4u);
+	EXPECT(GetBytecode(binaries[0]).find("float Common2;") != std::string::npos);
+	EXPECT(ShaderCache::GetShader(descs[1]) == binaries[1]);
+
+	ShaderCache::Finalize();
+	JobSystem::Finalize();
+}
+
+TEST_CASE(ShaderCacheFailures)
+{
+	WriteShaderDirectory();
+	WriteShader("Broken_PS.hlsl", "#error broken\n");
+
+	auto compiler = std::make_unique<FakeShaderCompiler>(1);
+	FakeShaderCompiler* fakeCompiler = compiler.get();
+	ShaderCache::Initialize(std::move(compiler), { SHADER_CACHE_DIRECTORY.string() });
+	ShaderCache::ResetStatistics();
+
+	// Failed and missing shaders are returned as nullptr, failures are not cached, so a fixed file compiles right away
+	EXPECT(ShaderCache::GetShader(MakeDesc("Broken_PS.hlsl", SHADER_TARGET_PIXEL)) == nullptr);
+	EXPECT(ShaderCache::GetShader(MakeDesc("Broken_PS.hlsl", SHADER_TARGET_PIXEL)) == nullptr);
+	EXPECT(ShaderCache::GetShader(MakeDesc("Nonexistent_PS.hlsl", SHADER_TARGET_PIXEL)) == nullptr);
+	EXPECT_EQ(fakeCompiler->NumCompiles.load(), 2u);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumFailed, 3u);
+
+	WriteShader("Broken_PS.hlsl", "float4 main() : SV_Target;\n");
+	EXPECT(ShaderCache::GetShader(MakeDesc("Broken_PS.hlsl", SHADER_TARGET_PIXEL)) != nullptr);
+	EXPECT_EQ(ShaderCache::GetStatistics().NumCompiled, 1u);
+
+	ShaderCache::Finalize();
+}
+
+TEST_CASE(ShaderCacheDirectoryShaders)
+{
+	WriteShaderDirectory();
+	WriteShader("Clustering_CS.hlsl", "[numthreads(64, 1, 1)] void main();\n");
+
+	// Sorted by path, the stage comes from the suffix and files without one are includes
+	std::vector<ShaderCompileDesc> descs;
+	ShaderCache::GetDirectoryShaders(SHADER_DIRECTORY.string(), descs);
+	EXPECT_EQ(descs.size(), std::size_t(3));
+
+	if (descs.size() == 3)
+	{
+		EXPECT(std::filesystem::path(descs[0].Filepath).filename() == "Clustering_CS.hlsl" && descs[0].Target == SHADER_TARGET_COMPUTE);
+		EXPECT(std::filesystem::path(descs[1].Filepath).filename() == "Lighting_PS.hlsl" && descs[1].Target == SHADER_TARGET_PIXEL);
+		EXPECT(std::filesystem::path(descs[2].Filepath).filename() == "Mesh_VS.hlsl" && descs[2].Target == SHADER_TARGET_VERTEX);
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(SHADER_DIRECTORY, error);
+	std::filesystem::remove_all(SHADER_CACHE_DIRECTORY, error);
+}
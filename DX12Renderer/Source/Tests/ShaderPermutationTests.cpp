@@ -0,0 +1,139 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShaderPermutation.h"
+
+static constexpr uint32_t NORMAL_MAP = SHADER_FEATURE_NORMAL_MAP;
+static constexpr uint32_t METALLIC_ROUGHNESS_MAP = SHADER_FEATURE_METALLIC_ROUGHNESS_MAP;
+static constexpr uint32_t ALPHA_TEST = SHADER_FEATURE_ALPHA_TEST;
+static constexpr uint32_t SHADOWED_LIGHTS_ONLY = SHADER_FEATURE_SHADOWED_LIGHTS_ONLY;
+
+static ShaderPermutationManifest MakeManifest(uint32_t supportedFeatures, const std::vector<uint32_t>& variants)
+{
+	ShaderPermutationManifest manifest;
+	manifest.Name = "ShaderPermutationTest";
+	manifest.SupportedFeatures = supportedFeatures;
+	manifest.Variants = variants;
+	return manifest;
+}
+
+TEST_CASE(ShaderPermutationDefines)
+{
+	std::vector<std::string> defines;
+	ShaderPermutation::GetDefines(SHADOWED_LIGHTS_ONLY | NORMAL_MAP, defines);
+	EXPECT(defines == std::vector<std::string>({ "HAS_NORMAL_MAP", "SHADOWED_LIGHTS_ONLY" }));
+
+	ShaderPermutation::GetDefines(SHADER_FEATURE_NONE, defines);
+	EXPECT(defines.empty());
+
+	// Every feature bit has a define of its own
+	ShaderPermutation::GetDefines(SHADER_FEATURE_ALL, defines);
+	EXPECT_EQ(defines.size(), std::size_t(SHADER_FEATURE_NUM_BITS));
+	for (std::size_t i = 0; i < defines.size(); ++i)
+	{
+		EXPECT(!defines[i].empty());
+		EXPECT(std::find(defines.begin(), defines.begin() + i, defines[i]) == defines.begin() + i);
+	}
+
+	EXPECT(ShaderPermutation::GetFeatureString(SHADER_FEATURE_NONE) == "NONE");
+	EXPECT(ShaderPermutation::GetFeatureString(NORMAL_MAP | METALLIC_ROUGHNESS_MAP) == "HAS_NORMAL_MAP|HAS_METALLIC_ROUGHNESS_MAP");
+	EXPECT(ShaderPermutation::GetFeatureString(ALPHA_TEST) == "ALPHA_TEST");
+}
+
+TEST_CASE(ShaderPermutationCompatibility)
+{
+	// A variant needs every capability of the draw, extra capabilities are fine
+	EXPECT(ShaderPermutation::IsVariantCompatible(NORMAL_MAP | METALLIC_ROUGHNESS_MAP, NORMAL_MAP));
+	EXPECT(ShaderPermutation::IsVariantCompatible(NORMAL_MAP, NORMAL_MAP));
+	EXPECT(!ShaderPermutation::IsVariantCompatible(NORMAL_MAP, NORMAL_MAP | METALLIC_ROUGHNESS_MAP));
+	EXPECT(!ShaderPermutation::IsVariantCompatible(SHADER_FEATURE_NONE, ALPHA_TEST));
+
+	// A specialized variant only fits draws that meet it, draws that meet it can still use the unspecialized variant
+	EXPECT(!ShaderPermutation::IsVariantCompatible(NORMAL_MAP | SHADOWED_LIGHTS_ONLY, NORMAL_MAP));
+	EXPECT(ShaderPermutation::IsVariantCompatible(NORMAL_MAP | SHADOWED_LIGHTS_ONLY, NORMAL_MAP | SHADOWED_LIGHTS_ONLY));
+	EXPECT(ShaderPermutation::IsVariantCompatible(NORMAL_MAP, NORMAL_MAP | SHADOWED_LIGHTS_ONLY));
+}
+
+TEST_CASE(ShaderPermutationSelectVariant)
+{
+	// Without a manifest every draw gets the only variant
+	ShaderPermutationSet defaultSet;
+	EXPECT_EQ(defaultSet.GetNumVariants(), 1u);
+	EXPECT_EQ(defaultSet.GetVariantFeatures(0), uint32_t(SHADER_FEATURE_NONE));
+	for (uint32_t drawFeatures = 0; drawFeatures <= SHADER_FEATURE_ALL; ++drawFeatures)
+		EXPECT_EQ(defaultSet.SelectVariant(drawFeatures), 0u);
+
+	// The variant with the fewest unneeded capabilities wins, then the one with the most specializations
+	ShaderPermutationSet set(MakeManifest(NORMAL_MAP | METALLIC_ROUGHNESS_MAP | SHADOWED_LIGHTS_ONLY,
+		{ NORMAL_MAP | METALLIC_ROUGHNESS_MAP, NORMAL_MAP, NORMAL_MAP | SHADOWED_LIGHTS_ONLY, NORMAL_MAP | METALLIC_ROUGHNESS_MAP | SHADOWED_LIGHTS_ONLY }));
+
+	EXPECT_EQ(set.SelectVariant(NORMAL_MAP | METALLIC_ROUGHNESS_MAP), 0u);
+	EXPECT_EQ(set.SelectVariant(NORMAL_MAP), 1u);
+	EXPECT_EQ(set.SelectVariant(NORMAL_MAP | SHADOWED_LIGHTS_ONLY), 2u);
+	EXPECT_EQ(set.SelectVariant(NORMAL_MAP | METALLIC_ROUGHNESS_MAP | SHADOWED_LIGHTS_ONLY), 3u);
+	EXPECT_EQ(set.SelectVariant(SHADER_FEATURE_NONE), 1u);
+	EXPECT_EQ(set.SelectVariant(METALLIC_ROUGHNESS_MAP), 0u);
+	EXPECT_EQ(set.SelectVariant(SHADOWED_LIGHTS_ONLY), 2u);
+
+	// Unsupported features are ignored
+	EXPECT_EQ(set.SelectVariant(NORMAL_MAP | ALPHA_TEST), 1u);
+
+	// Every draw gets a variant it can use
+	for (uint32_t drawFeatures = 0; drawFeatures <= SHADER_FEATURE_ALL; ++drawFeatures)
+	{
+		uint32_t variant = set.SelectVariant(drawFeatures);
+		EXPECT(variant < set.GetNumVariants());
+		EXPECT(ShaderPermutation::IsVariantCompatible(set.GetVariantFeatures(variant), drawFeatures & set.GetManifest().SupportedFeatures));
+	}
+}
+
+TEST_CASE(ShaderPermutationValidateManifest)
+{
+	constexpr uint32_t SUPPORTED = NORMAL_MAP | SHADOWED_LIGHTS_ONLY;
+
+	EXPECT(ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, { NORMAL_MAP, SHADER_FEATURE_NONE, SHADOWED_LIGHTS_ONLY })));
+	EXPECT(ShaderPermutation::ValidateManifest(MakeManifest(SHADER_FEATURE_NONE, { SHADER_FEATURE_NONE })));
+
+	// The fallback has every supported capability and no specialization
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, { SHADER_FEATURE_NONE, NORMAL_MAP })));
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, { NORMAL_MAP | SHADOWED_LIGHTS_ONLY, NORMAL_MAP })));
+
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, {})));
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, { NORMAL_MAP, SHADER_FEATURE_NONE, NORMAL_MAP })));
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SUPPORTED, { NORMAL_MAP, ALPHA_TEST })));
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SHADER_FEATURE_ALL + 1, { SHADER_FEATURE_NONE })));
+
+	std::vector<uint32_t> tooManyVariants(SHADER_PERMUTATION_MAX_VARIANTS + 1, SHADER_FEATURE_NONE);
+	EXPECT(!ShaderPermutation::ValidateManifest(MakeManifest(SHADER_FEATURE_NONE, tooManyVariants)));
+}
+
+TEST_CASE(ShaderPermutationLightingManifest)
+{
+	const ShaderPermutationManifest& manifest = ShaderPermutation::GetLightingManifest();
+	EXPECT(ShaderPermutation::ValidateManifest(manifest));
+	EXPECT_EQ(manifest.Variants.size(), std::size_t(8));
+	EXPECT(!manifest.Variants.empty() && manifest.Variants[0] == (manifest.SupportedFeatures & SHADER_FEATURE_CAPABILITIES));
+
+	// Every draw gets the variant with exactly its supported features
+	ShaderPermutationSet set(manifest);
+	for (uint32_t drawFeatures = 0; drawFeatures <= SHADER_FEATURE_ALL; ++drawFeatures)
+		EXPECT_EQ(set.GetVariantFeatures(set.SelectVariant(drawFeatures)), drawFeatures & manifest.SupportedFeatures);
+}
+
+TEST_CASE(ShaderPermutationDrawSortKey)
+{
+	constexpr uint32_t MAX_ID = std::numeric_limits<uint32_t>::max();
+
+	for (uint32_t features = 0; features <= SHADER_FEATURE_ALL; ++features)
+	{
+		EXPECT_EQ(ShaderPermutation::GetDrawSortKeyFeatures(ShaderPermutation::MakeDrawSortKey(features, 0, 0)), features);
+		EXPECT_EQ(ShaderPermutation::GetDrawSortKeyFeatures(ShaderPermutation::MakeDrawSortKey(features, MAX_ID, MAX_ID)), features);
+	}
+
+	EXPECT_EQ(ShaderPermutation::GetDrawSortKeyFeatures(ShaderPermutation::MakeDrawSortKey(MAX_ID, 0, 0)), SHADER_FEATURE_ALL);
+
+	// Draws are grouped by features first, then by material, then by mesh
+	EXPECT(ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, MAX_ID, MAX_ID) < ShaderPermutation::MakeDrawSortKey(METALLIC_ROUGHNESS_MAP, 0, 0));
+	EXPECT(ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 1, MAX_ID) < ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 2, 0));
+	EXPECT(ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 1, 5) < ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 1, 6));
+	EXPECT(ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 1, 5) == ShaderPermutation::MakeDrawSortKey(NORMAL_MAP, 1, 5));
+}
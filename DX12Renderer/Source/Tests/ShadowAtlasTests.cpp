@@ -0,0 +1,186 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShadowAtlas.h"
+
+static bool IsOverlapping(const ShadowAtlasTile& lhs, const ShadowAtlasTile& rhs)
+{
+	return lhs.X < rhs.X + rhs.Size && rhs.X < lhs.X + lhs.Size && lhs.Y < rhs.Y + rhs.Size && rhs.Y < lhs.Y + lhs.Size;
+}
+
+// Small atlas without demand scaling, so the tile sizes follow directly from the screen coverage
+static ShadowAtlasSettings MakeSettings()
+{
+	ShadowAtlasSettings settings;
+	settings.AtlasResolution = 1024;
+	settings.MinTileSize = 64;
+	settings.MaxTileSize = 1024;
+	settings.MaxOccupancy = 1.0f;
+
+	return settings;
+}
+
+static ShadowAtlasRequest MakeRequest(uint64_t lightID, float screenCoverage, float importance = 1.0f)
+{
+	ShadowAtlasRequest request;
+	request.LightID = lightID;
+	request.ScreenCoverage = screenCoverage;
+	request.Importance = importance;
+
+	return request;
+}
+
+TEST_CASE(ShadowAtlasAllocatorPacksWithoutOverlap)
+{
+	ShadowAtlasAllocator allocator(1024, 64);
+	std::vector<ShadowAtlasTile> tiles;
+
+	// 3 * 256, 3 * 128 and 4 * 64 tiles fill one quarter, together with three 512 tiles the atlas is full
+	const uint32_t sizes[] = { 512, 256, 128, 128, 512, 256, 64, 64, 64, 64, 256, 128, 512 };
+	for (uint32_t size : sizes)
+	{
+		ShadowAtlasTile tile;
+		EXPECT(allocator.Allocate(size, tile));
+		EXPECT_EQ(tile.Size, size);
+		EXPECT(tile.X % size == 0 && tile.Y % size == 0);
+		EXPECT(tile.X + tile.Size <= 1024 && tile.Y + tile.Size <= 1024);
+
+		for (const ShadowAtlasTile& other : tiles)
+			EXPECT(!IsOverlapping(tile, other));
+
+		tiles.push_back(tile);
+	}
+
+	EXPECT_EQ(allocator.GetAllocatedTexels(), uint64_t(1024 * 1024));
+
+	ShadowAtlasTile tile;
+	EXPECT(!allocator.Allocate(64, tile));
+
+	// Freeing everything merges the nodes back into the full atlas
+	for (const ShadowAtlasTile& allocatedTile : tiles)
+		allocator.Free(allocatedTile);
+
+	EXPECT_EQ(allocator.GetAllocatedTexels(), uint64_t(0));
+	EXPECT(allocator.Allocate(1024, tile));
+	EXPECT(tile == (ShadowAtlasTile{ 0, 0, 1024 }));
+}
+
+TEST_CASE(ShadowAtlasAllocatorFillsPartiallyUsedNodes)
+{
+	ShadowAtlasAllocator allocator(1024, 64);
+	ShadowAtlasTile first, second, third;
+
+	EXPECT(allocator.Allocate(256, first));
+	EXPECT(allocator.Allocate(512, second));
+	EXPECT(allocator.Allocate(256, third));
+
+	// The second 256 tile goes next to the first one instead of splitting another 512 node
+	EXPECT(first == (ShadowAtlasTile{ 0, 0, 256 }));
+	EXPECT(second == (ShadowAtlasTile{ 512, 0, 512 }));
+	EXPECT(third == (ShadowAtlasTile{ 256, 0, 256 }));
+
+	// Sizes that are no power of two or out of range are rejected
+	ShadowAtlasTile tile;
+	EXPECT(!allocator.Allocate(96, tile));
+	EXPECT(!allocator.Allocate(32, tile));
+	EXPECT(!allocator.Allocate(2048, tile));
+}
+
+TEST_CASE(ShadowAtlasServesHigherPriorityFirst)
+{
+	ShadowAtlas atlas(MakeSettings());
+
+	// Both lights want the full atlas, the light ID does not matter, only the priority
+	atlas.Update({ MakeRequest(1, 1000.0f, 1.0f), MakeRequest(2, 1000.0f, 2.0f) });
+
+	const ShadowAtlasAllocation* allocation = atlas.GetAllocation(2);
+	EXPECT(allocation != nullptr && allocation->TileSize == 1024 && allocation->NumTiles == 1);
+	EXPECT(atlas.GetAllocation(1) == nullptr);
+
+	const ShadowAtlasStatistics& stats = atlas.GetStatistics();
+	EXPECT_EQ(stats.NumLights, 2u);
+	EXPECT_EQ(stats.NumAllocatedLights, 1u);
+	EXPECT_EQ(stats.NumUnallocatedLights, 1u);
+	EXPECT(stats.DemandScale < 1.0f);
+}
+
+TEST_CASE(ShadowAtlasEvictsClearlyLowerPriority)
+{
+	ShadowAtlas atlas(MakeSettings());
+
+	atlas.Update({ MakeRequest(1, 1000.0f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr && atlas.GetAllocation(1)->TileSize == 1024);
+
+	// A new light that is only slightly more important does not take the tiles
+	atlas.Update({ MakeRequest(1, 1000.0f), MakeRequest(2, 1000.0f, 1.1f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr);
+	EXPECT(atlas.GetAllocation(2) == nullptr);
+	EXPECT_EQ(atlas.GetStatistics().NumEvictedLights, 0u);
+
+	atlas.Update({ MakeRequest(1, 1000.0f), MakeRequest(2, 1000.0f, 4.0f) });
+	EXPECT(atlas.GetAllocation(1) == nullptr);
+	EXPECT(atlas.GetAllocation(2) != nullptr && atlas.GetAllocation(2)->TileSize == 1024);
+	EXPECT_EQ(atlas.GetStatistics().NumEvictedLights, 1u);
+	EXPECT_EQ(atlas.GetStatistics().NumNewLights, 1u);
+}
+
+TEST_CASE(ShadowAtlasKeepsSizeWithinHysteresis)
+{
+	ShadowAtlas atlas(MakeSettings());
+
+	atlas.Update({ MakeRequest(1, 300.0f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr && atlas.GetAllocation(1)->TileSize == 256);
+	ShadowAtlasTile tile = atlas.GetAllocation(1)->Tiles[0];
+
+	// Past the halfway point to 512, but not by the hysteresis
+	atlas.Update({ MakeRequest(1, 370.0f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr && atlas.GetAllocation(1)->Tiles[0] == tile);
+	EXPECT_EQ(atlas.GetStatistics().NumResizedLights, 0u);
+	EXPECT_EQ(atlas.GetStatistics().NumNewLights, 0u);
+
+	atlas.Update({ MakeRequest(1, 500.0f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr && atlas.GetAllocation(1)->TileSize == 512);
+	EXPECT_EQ(atlas.GetStatistics().NumResizedLights, 1u);
+
+	atlas.Update({ MakeRequest(1, 100.0f) });
+	EXPECT(atlas.GetAllocation(1) != nullptr && atlas.GetAllocation(1)->TileSize == 128);
+	EXPECT_EQ(atlas.GetStatistics().NumAllocatedTexels, uint64_t(128 * 128));
+}
+
+TEST_CASE(ShadowAtlasNeverEvictsFixedTiles)
+{
+	ShadowAtlas atlas(MakeSettings());
+
+	ShadowAtlasRequest cascades;
+	cascades.LightID = 1;
+	cascades.NumTiles = 4;
+	cascades.FixedTileSize = 512;
+
+	for (uint32_t frame = 0; frame < 2; ++frame)
+	{
+		atlas.Update({ MakeRequest(2, 1000.0f, 100.0f), cascades });
+
+		const ShadowAtlasAllocation* allocation = atlas.GetAllocation(1);
+		EXPECT(allocation != nullptr && allocation->TileSize == 512 && allocation->NumTiles == 4);
+		EXPECT(atlas.GetAllocation(2) == nullptr);
+		EXPECT_EQ(atlas.GetStatistics().NumEvictedLights, 0u);
+	}
+}
+
+TEST_CASE(ShadowAtlasReleasesUnrequestedLights)
+{
+	ShadowAtlas atlas(MakeSettings());
+
+	atlas.Update({ MakeRequest(1, 200.0f), MakeRequest(2, 100.0f) });
+	EXPECT_EQ(atlas.GetStatistics().NumAllocatedLights, 2u);
+
+	atlas.Update({ MakeRequest(2, 100.0f) });
+	EXPECT(atlas.GetAllocation(1) == nullptr);
+	EXPECT_EQ(atlas.GetStatistics().NumAllocatedTexels, uint64_t(128 * 128));
+
+	atlas.Update({});
+	EXPECT(atlas.GetAllocation(2) == nullptr);
+	EXPECT_EQ(atlas.GetStatistics().NumAllocatedTexels, uint64_t(0));
+
+	glm::vec4 uvRect = atlas.GetTileUVRect(ShadowAtlasTile{ 512, 256, 256 });
+	EXPECT(uvRect == glm::vec4(0.5f, 0.25f, 0.25f, 0.25f));
+}
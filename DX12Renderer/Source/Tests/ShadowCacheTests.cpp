@@ -0,0 +1,100 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShadowCache.h"
+
+static glm::mat4 MakeLightViewProjection(const glm::vec3& position)
+{
+	glm::mat4 view = glm::lookAtLH(position, position + glm::vec3(0.0f, -1.0f, 0.2f), glm::vec3(0.0f, 0.0f, 1.0f));
+	return glm::perspectiveFovLH_ZO(glm::radians(90.0f), 1.0f, 1.0f, 0.1f, 50.0f) * view;
+}
+
+static glm::mat4 MakeCasterTransform(const glm::vec3& position)
+{
+	return glm::translate(glm::identity<glm::mat4>(), position);
+}
+
+TEST_CASE(ShadowCacheStaticCasters)
+{
+	glm::mat4 transform = MakeCasterTransform(glm::vec3(1.0f, 2.0f, 3.0f));
+
+	EXPECT(ShadowCache::IsStaticCaster(transform, transform));
+	EXPECT(!ShadowCache::IsStaticCaster(transform, MakeCasterTransform(glm::vec3(1.0f, 2.0f, 3.001f))));
+}
+
+TEST_CASE(ShadowCacheSignatureIgnoresSubmissionOrder)
+{
+	glm::mat4 viewProjection = MakeLightViewProjection(glm::vec3(0.0f, 10.0f, 0.0f));
+	glm::uvec3 tile = glm::uvec3(512, 0, 256);
+
+	Hash128 lhs = {};
+	ShadowCache::AddView(lhs, viewProjection, tile);
+	for (uint64_t meshID = 0; meshID < 4; ++meshID)
+		ShadowCache::AddStaticCaster(lhs, meshID, MakeCasterTransform(glm::vec3(static_cast<float>(meshID), 0.0f, 0.0f)));
+
+	Hash128 rhs = {};
+	for (uint64_t meshID = 4; meshID-- > 0;)
+		ShadowCache::AddStaticCaster(rhs, meshID, MakeCasterTransform(glm::vec3(static_cast<float>(meshID), 0.0f, 0.0f)));
+	ShadowCache::AddView(rhs, viewProjection, tile);
+
+	EXPECT(lhs == rhs);
+}
+
+TEST_CASE(ShadowCacheSignatureChanges)
+{
+	glm::mat4 viewProjection = MakeLightViewProjection(glm::vec3(0.0f, 10.0f, 0.0f));
+	glm::mat4 transform = MakeCasterTransform(glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::uvec3 tile = glm::uvec3(512, 0, 256);
+
+	auto makeSignature = [](const glm::mat4& lightViewProjection, const glm::uvec3& atlasTile, const std::vector<std::pair<uint64_t, glm::mat4>>& casters)
+	{
+		Hash128 casterSignature = {};
+		ShadowCache::AddView(casterSignature, lightViewProjection, atlasTile);
+		for (const auto& [meshID, casterTransform] : casters)
+			ShadowCache::AddStaticCaster(casterSignature, meshID, casterTransform);
+
+		return casterSignature;
+	};
+
+	Hash128 signature = makeSignature(viewProjection, tile, { { 7, transform } });
+
+	// The light moved, the light moved in the atlas, the caster moved, was replaced, and a caster appeared
+	EXPECT(signature != makeSignature(MakeLightViewProjection(glm::vec3(0.0f, 10.5f, 0.0f)), tile, { { 7, transform } }));
+	EXPECT(signature != makeSignature(viewProjection, glm::uvec3(0, 0, 256), { { 7, transform } }));
+	EXPECT(signature != makeSignature(viewProjection, glm::uvec3(512, 0, 512), { { 7, transform } }));
+	EXPECT(signature != makeSignature(viewProjection, tile, { { 7, MakeCasterTransform(glm::vec3(1.5f, 0.0f, 0.0f)) } }));
+	EXPECT(signature != makeSignature(viewProjection, tile, { { 8, transform } }));
+	EXPECT(signature != makeSignature(viewProjection, tile, { { 7, transform }, { 9, transform } }));
+	EXPECT(signature != makeSignature(viewProjection, tile, {}));
+
+	// A view and a caster with the same matrix do not cancel each other out
+	Hash128 viewOnly = {};
+	ShadowCache::AddView(viewOnly, viewProjection, tile);
+	Hash128 viewAndCaster = viewOnly;
+	ShadowCache::AddStaticCaster(viewAndCaster, 0, viewProjection);
+	EXPECT(viewOnly != viewAndCaster);
+}
+
+TEST_CASE(ShadowCacheValidate)
+{
+	Hash128 signature = {};
+	ShadowCache::AddView(signature, MakeLightViewProjection(glm::vec3(0.0f, 10.0f, 0.0f)), glm::uvec3(0, 0, 1024));
+
+	Hash128 otherSignature = signature;
+	ShadowCache::AddStaticCaster(otherSignature, 3, MakeCasterTransform(glm::vec3(0.0f)));
+
+	// A new entry has to be rendered once, then it is reused until the signature changes
+	ShadowCacheEntry entry;
+	EXPECT(!ShadowCache::Validate(entry, signature));
+	EXPECT(ShadowCache::Validate(entry, signature));
+	EXPECT(ShadowCache::Validate(entry, signature));
+
+	EXPECT(!ShadowCache::Validate(entry, otherSignature));
+	EXPECT(entry.Signature == otherSignature);
+	EXPECT(ShadowCache::Validate(entry, otherSignature));
+
+	// An invalidated entry is rendered again even if the signature did not change
+	ShadowCache::Invalidate(entry);
+	EXPECT(!entry.IsValid);
+	EXPECT(!ShadowCache::Validate(entry, otherSignature));
+	EXPECT(ShadowCache::Validate(entry, otherSignature));
+}
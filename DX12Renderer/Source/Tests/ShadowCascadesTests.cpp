@@ -0,0 +1,181 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShadowCascades.h"
+
+static bool IsNear(float lhs, float rhs, float epsilon = 1e-3f)
+{
+	return std::abs(lhs - rhs) <= epsilon * std::max(1.0f, std::max(std::abs(lhs), std::abs(rhs)));
+}
+
+static glm::mat4 MakeCameraView(const glm::vec3& position)
+{
+	return glm::lookAtLH(position, position + glm::vec3(0.3f, -0.2f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// A min larger than the max marks a scene without bounds, the depth range then only depends on the sphere
+static BoundingBox MakeEmptyBoundingBox()
+{
+	BoundingBox bb;
+	bb.Min = glm::vec3(1.0f);
+	bb.Max = glm::vec3(-1.0f);
+
+	return bb;
+}
+
+TEST_CASE(ShadowCascadesSplitDistances)
+{
+	float splits[MAX_SHADOW_CASCADES + 1] = {};
+
+	ShadowCascades::CalculateSplitDistances(0.1f, 100.0f, 4, 0.5f, splits);
+	EXPECT(splits[0] == 0.1f);
+	EXPECT(splits[4] == 100.0f);
+	for (uint32_t i = 0; i < 4; ++i)
+		EXPECT(splits[i] < splits[i + 1]);
+
+	// Uniform and logarithmic splits are the two ends of the blend
+	ShadowCascades::CalculateSplitDistances(0.1f, 100.0f, 4, 0.0f, splits);
+	EXPECT(IsNear(splits[2], 50.05f));
+
+	ShadowCascades::CalculateSplitDistances(0.1f, 100.0f, 4, 1.0f, splits);
+	EXPECT(IsNear(splits[2], 0.1f * std::sqrt(1000.0f)));
+
+	ShadowCascades::CalculateSplitDistances(1.0f, 10.0f, 1, 0.75f, splits);
+	EXPECT(splits[0] == 1.0f && splits[1] == 10.0f);
+}
+
+TEST_CASE(ShadowCascadesSliceSphereContainsCorners)
+{
+	const float tanHalfFovY = std::tan(glm::radians(35.0f));
+	const float aspectRatio = 16.0f / 9.0f;
+	const float slices[][2] = { { 0.1f, 5.0f }, { 5.0f, 40.0f }, { 40.0f, 300.0f } };
+
+	glm::mat4 view = MakeCameraView(glm::vec3(10.0f, 4.0f, -7.0f));
+	glm::mat4 invView = glm::inverse(view);
+
+	for (const auto& slice : slices)
+	{
+		BoundingSphere sphere = ShadowCascades::CalculateFrustumSliceBoundingSphere(view, tanHalfFovY, aspectRatio, slice[0], slice[1]);
+
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			float depth = slice[(i >> 2) & 1];
+			glm::vec4 viewCorner((i & 1 ? 1.0f : -1.0f) * depth * tanHalfFovY * aspectRatio, (i & 2 ? 1.0f : -1.0f) * depth * tanHalfFovY, depth, 1.0f);
+			glm::vec3 worldCorner = invView * viewCorner;
+
+			EXPECT(glm::length(worldCorner - sphere.Position) <= sphere.Radius * 1.0001f);
+		}
+
+		// Rotating the camera around its position does not change the size of the sphere
+		glm::mat4 rotatedView = glm::lookAtLH(glm::vec3(10.0f, 4.0f, -7.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		EXPECT(ShadowCascades::CalculateFrustumSliceBoundingSphere(rotatedView, tanHalfFovY, aspectRatio, slice[0], slice[1]).Radius == sphere.Radius);
+	}
+}
+
+TEST_CASE(ShadowCascadesFitCoversSphere)
+{
+	const uint32_t resolution = 1024;
+	glm::mat4 lightView = ShadowCascades::MakeLightView(glm::vec3(0.4f, -1.0f, 0.2f));
+
+	BoundingSphere sphere;
+	sphere.Position = glm::vec3(3.0f, 1.0f, -2.0f);
+	sphere.Radius = 12.0f;
+
+	ShadowCascade cascade;
+	ShadowCascades::FitCascade(lightView, sphere, resolution, MakeEmptyBoundingBox(), cascade);
+
+	glm::vec3 center = lightView * glm::vec4(sphere.Position, 1.0f);
+	EXPECT(cascade.Left <= center.x - sphere.Radius && cascade.Right >= center.x + sphere.Radius);
+	EXPECT(cascade.Bottom <= center.y - sphere.Radius && cascade.Top >= center.y + sphere.Radius);
+	EXPECT(IsNear(cascade.Right - cascade.Left, cascade.Top - cascade.Bottom));
+	EXPECT(cascade.Near < cascade.Far);
+
+	// Reverse-z, the near plane maps to depth 1 and the far plane to depth 0
+	glm::vec4 nearPoint = cascade.Projection * glm::vec4(center.x, center.y, cascade.Near, 1.0f);
+	glm::vec4 farPoint = cascade.Projection * glm::vec4(center.x, center.y, cascade.Far, 1.0f);
+	EXPECT(IsNear(nearPoint.z / nearPoint.w, 1.0f));
+	EXPECT(IsNear(farPoint.z / farPoint.w, 0.0f));
+}
+
+TEST_CASE(ShadowCascadesFitTightensDepthToScene)
+{
+	glm::mat4 lightView = ShadowCascades::MakeLightView(glm::vec3(0.0f, -1.0f, 0.0f));
+
+	BoundingSphere sphere;
+	sphere.Position = glm::vec3(0.0f);
+	sphere.Radius = 10.0f;
+
+	// The scene reaches far above the sphere (casters) but ends inside of it (receivers)
+	BoundingBox sceneBB;
+	sceneBB.Min = glm::vec3(-50.0f, -2.0f, -50.0f);
+	sceneBB.Max = glm::vec3(50.0f, 100.0f, 50.0f);
+
+	ShadowCascade cascade;
+	ShadowCascades::FitCascade(lightView, sphere, 1024, sceneBB, cascade);
+
+	// Looking down, depth is the negated height
+	EXPECT(IsNear(cascade.Near, -100.0f));
+	EXPECT(IsNear(cascade.Far, 2.0f));
+
+	// A scene entirely behind the sphere still gives a valid depth range
+	sceneBB.Min = glm::vec3(-1.0f, -300.0f, -1.0f);
+	sceneBB.Max = glm::vec3(1.0f, -200.0f, 1.0f);
+	ShadowCascades::FitCascade(lightView, sphere, 1024, sceneBB, cascade);
+	EXPECT(cascade.Near < cascade.Far);
+}
+
+TEST_CASE(ShadowCascadesSnapToTexels)
+{
+	const uint32_t resolution = 2048;
+	glm::mat4 lightView = ShadowCascades::MakeLightView(glm::vec3(-0.3f, -1.0f, 0.5f));
+
+	float firstLeft = 0.0f;
+	for (uint32_t step = 0; step < 16; ++step)
+	{
+		// Moves the sphere by fractions of a texel, the bounds only ever move in whole texels
+		BoundingSphere sphere;
+		sphere.Position = glm::vec3(1.0f + step * 0.0037f, 2.0f, 3.0f - step * 0.0051f);
+		sphere.Radius = 20.0f;
+
+		ShadowCascade cascade;
+		ShadowCascades::FitCascade(lightView, sphere, resolution, MakeEmptyBoundingBox(), cascade);
+
+		float texelSize = (cascade.Right - cascade.Left) / resolution;
+		if (step == 0)
+			firstLeft = cascade.Left;
+
+		float texelOffset = (cascade.Left - firstLeft) / texelSize;
+		EXPECT(std::abs(texelOffset - std::round(texelOffset)) < 0.01f);
+	}
+}
+
+TEST_CASE(ShadowCascadesCalculateCascades)
+{
+	ShadowCascadeSettings settings;
+	settings.NumCascades = 3;
+	settings.MaxShadowDistance = 200.0f;
+	settings.ShadowMapResolution = 1024;
+
+	glm::mat4 view = MakeCameraView(glm::vec3(0.0f, 2.0f, 0.0f));
+	glm::mat4 projection = glm::perspectiveFovLH_ZO(glm::radians(60.0f), 1920.0f, 1080.0f, 0.1f, 1000.0f);
+
+	ShadowCascade cascades[MAX_SHADOW_CASCADES];
+	uint32_t numCascades = ShadowCascades::CalculateCascades(settings, view, projection, 0.1f, 1000.0f, glm::vec3(0.2f, -1.0f, 0.1f), MakeEmptyBoundingBox(), cascades);
+
+	EXPECT_EQ(numCascades, 3u);
+	EXPECT(cascades[0].SplitNear == 0.1f);
+	EXPECT(cascades[2].SplitFar == 200.0f);
+
+	for (uint32_t i = 0; i < numCascades; ++i)
+	{
+		EXPECT(cascades[i].Near < cascades[i].Far);
+		if (i > 0)
+		{
+			EXPECT(cascades[i].SplitNear == cascades[i - 1].SplitFar);
+			EXPECT(cascades[i].Sphere.Radius >= cascades[i - 1].Sphere.Radius);
+		}
+	}
+
+	// Shadows that would start behind the near plane are skipped
+	settings.MaxShadowDistance = 0.05f;
+	EXPECT_EQ(ShadowCascades::CalculateCascades(settings, view, projection, 0.1f, 1000.0f, glm::vec3(0.0f, -1.0f, 0.0f), MakeEmptyBoundingBox(), cascades), 0u);
+}
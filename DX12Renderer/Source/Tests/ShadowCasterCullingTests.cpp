@@ -0,0 +1,162 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShadowCasterCulling.h"
+
+// Scene of a flat ground, seen by a reverse-z camera standing on it and looking toward +z
+static const BoundingBox SCENE_BB = { glm::vec3(-20.0f, -1.0f, -20.0f), glm::vec3(20.0f, 2.0f, 20.0f) };
+
+static glm::mat4 MakeCameraViewProjection(const glm::vec3& eye, const glm::vec3& target, float far)
+{
+	glm::mat4 view = glm::lookAtLH(eye, target, glm::vec3(0.0f, 1.0f, 0.0f));
+	return glm::perspectiveLH_ZO(glm::radians(30.0f), 1.6f, far, 0.1f) * view;
+}
+
+static BoundingBox MakeBox(const glm::vec3& center, float halfSize)
+{
+	return { center - glm::vec3(halfSize), center + glm::vec3(halfSize) };
+}
+
+static bool IsNear(const glm::vec3& lhs, const glm::vec3& rhs)
+{
+	return glm::all(glm::lessThanEqual(glm::abs(lhs - rhs), glm::vec3(1e-3f)));
+}
+
+static std::vector<glm::vec3> MakeReceiverRegion()
+{
+	std::vector<glm::vec3> points;
+	ShadowCasterCulling::CalculateReceiverRegion(MakeCameraViewProjection(glm::vec3(0.0f, 1.0f, -15.0f), glm::vec3(0.0f, 1.0f, 0.0f), 20.0f), SCENE_BB, points);
+	return points;
+}
+
+// Random points inside the convex receiver region
+static std::vector<glm::vec3> MakeRandomReceivers(const std::vector<glm::vec3>& region, uint32_t numReceivers)
+{
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<float> weightDistribution(0.0f, 1.0f);
+	std::vector<glm::vec3> receivers(numReceivers);
+
+	for (glm::vec3& receiver : receivers)
+	{
+		glm::vec3 sum(0.0f);
+		float totalWeight = 0.0f;
+
+		for (const glm::vec3& point : region)
+		{
+			float weight = weightDistribution(random);
+			sum += point * weight;
+			totalWeight += weight;
+		}
+
+		receiver = sum / totalWeight;
+	}
+
+	return receivers;
+}
+
+TEST_CASE(ShadowCasterCullingReceiverRegion)
+{
+	std::vector<glm::vec3> points = MakeReceiverRegion();
+	glm::mat4 cameraViewProjection = MakeCameraViewProjection(glm::vec3(0.0f, 1.0f, -15.0f), glm::vec3(0.0f, 1.0f, 0.0f), 20.0f);
+	EXPECT(!points.empty());
+
+	for (const glm::vec3& point : points)
+	{
+		EXPECT(glm::all(glm::greaterThanEqual(point, SCENE_BB.Min - 1e-3f)) && glm::all(glm::lessThanEqual(point, SCENE_BB.Max + 1e-3f)));
+
+		glm::vec4 clip = cameraViewProjection * glm::vec4(point, 1.0f);
+		float tolerance = 1e-3f * clip.w;
+		EXPECT(clip.w > 0.0f && std::abs(clip.x) <= clip.w + tolerance && std::abs(clip.y) <= clip.w + tolerance);
+		EXPECT(clip.z >= -tolerance && clip.z <= clip.w + tolerance);
+	}
+
+	// A frustum inside the scene bounds is the region itself
+	glm::mat4 innerViewProjection = MakeCameraViewProjection(glm::vec3(0.0f, 0.5f, 0.0f), glm::vec3(0.0f, 0.5f, 1.0f), 2.0f);
+	ShadowCasterCulling::CalculateReceiverRegion(innerViewProjection, SCENE_BB, points);
+	glm::mat4 invViewProjection = glm::inverse(innerViewProjection);
+
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		glm::vec4 corner = invViewProjection * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : 0.0f, 1.0f);
+		glm::vec3 frustumCorner = glm::vec3(corner) / corner.w;
+		EXPECT(std::any_of(points.begin(), points.end(), [&](const glm::vec3& point) { return IsNear(point, frustumCorner); }));
+	}
+
+	// A camera looking away from the scene and an empty scene see no receivers
+	ShadowCasterCulling::CalculateReceiverRegion(MakeCameraViewProjection(glm::vec3(0.0f, 1.0f, -25.0f), glm::vec3(0.0f, 1.0f, -30.0f), 20.0f), SCENE_BB, points);
+	EXPECT(points.empty());
+
+	BoundingBox emptyBB = { glm::vec3(1.0f), glm::vec3(-1.0f) };
+	ShadowCasterCulling::CalculateReceiverRegion(cameraViewProjection, emptyBB, points);
+	EXPECT(points.empty());
+}
+
+TEST_CASE(ShadowCasterCullingDirectional)
+{
+	// Light shining straight down, light view x is world x, y is world z and depth is -y
+	glm::mat4 lightView = glm::lookAtLH(glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	glm::mat4 lightProjection = glm::orthoLH_ZO(-40.0f, 40.0f, -40.0f, 40.0f, 100.0f, -100.0f);
+
+	std::vector<glm::vec3> region = MakeReceiverRegion();
+	ShadowCasterVolume volume = ShadowCasterCulling::MakeCasterVolume(lightView, lightProjection, region);
+	EXPECT(!volume.IsEmpty);
+	EXPECT(!volume.IsPerspective);
+
+	// Above the receivers, to the side of the view, behind the camera and below the ground
+	EXPECT(ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(0.0f, 20.0f, 0.0f), 1.0f)));
+	EXPECT(!ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(16.0f, 5.0f, 0.0f), 1.0f)));
+	EXPECT(!ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(0.0f, 5.0f, -19.0f), 0.5f)));
+	EXPECT(!ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(0.0f, -5.0f, 0.0f), 1.0f)));
+
+	// Every caster on the way from a visible receiver to the light is kept
+	std::vector<BoundingBox> casters;
+	for (const glm::vec3& receiver : MakeRandomReceivers(region, 256))
+	{
+		for (float height : { 0.0f, 0.5f, 4.0f, 50.0f })
+			casters.push_back(MakeBox(receiver + glm::vec3(0.0f, height, 0.0f), 0.01f));
+	}
+
+	std::vector<uint8_t> visible(casters.size());
+	EXPECT_EQ(ShadowCasterCulling::CullCasters(volume, casters.data(), casters.size(), visible.data()), 0u);
+	EXPECT(std::all_of(visible.begin(), visible.end(), [](uint8_t isVisible) { return isVisible == 1; }));
+
+	// No receivers, nothing casts a shadow
+	ShadowCasterVolume emptyVolume = ShadowCasterCulling::MakeCasterVolume(lightView, lightProjection, {});
+	EXPECT(emptyVolume.IsEmpty);
+	EXPECT_EQ(ShadowCasterCulling::CullCasters(emptyVolume, casters.data(), casters.size(), visible.data()), static_cast<uint32_t>(casters.size()));
+}
+
+TEST_CASE(ShadowCasterCullingPerspective)
+{
+	// Reverse-z spot light above the scene shining straight down, depth is 15 - y
+	glm::vec3 lightPosition = glm::vec3(0.0f, 15.0f, 0.0f);
+	glm::mat4 lightView = glm::lookAtLH(lightPosition, lightPosition + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	glm::mat4 lightProjection = glm::perspectiveFovLH_ZO(glm::radians(90.0f), 1.0f, 1.0f, 50.0f, 0.1f);
+
+	std::vector<glm::vec3> region = MakeReceiverRegion();
+	ShadowCasterVolume volume = ShadowCasterCulling::MakeCasterVolume(lightView, lightProjection, region);
+	EXPECT(!volume.IsEmpty);
+	EXPECT(volume.IsPerspective);
+
+	// Between the light and the receivers, around the light, behind the light and outside the cone toward the receivers
+	EXPECT(ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(0.0f, 8.0f, 0.0f), 1.0f)));
+	EXPECT(ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(lightPosition, 1.0f)));
+	EXPECT(!ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(0.0f, 20.0f, 0.0f), 1.0f)));
+	EXPECT(!ShadowCasterCulling::IsCasterInVolume(volume, MakeBox(glm::vec3(12.0f, 5.0f, 0.0f), 0.5f)));
+
+	std::vector<BoundingBox> casters;
+	for (const glm::vec3& receiver : MakeRandomReceivers(region, 256))
+	{
+		for (float t : { 0.0f, 0.25f, 0.5f, 0.95f })
+			casters.push_back(MakeBox(glm::mix(receiver, lightPosition, t), 0.01f));
+	}
+
+	std::vector<uint8_t> visible(casters.size());
+	EXPECT_EQ(ShadowCasterCulling::CullCasters(volume, casters.data(), casters.size(), visible.data()), 0u);
+
+	// A receiver region around the light can be shadowed in any direction of the light view
+	std::vector<glm::vec3> aroundLight = { lightPosition + glm::vec3(-1.0f, -1.0f, -1.0f), lightPosition + glm::vec3(1.0f, 1.0f, 1.0f),
+		lightPosition + glm::vec3(1.0f, -1.0f, 1.0f), lightPosition + glm::vec3(-1.0f, 1.0f, -1.0f) };
+	ShadowCasterVolume aroundVolume = ShadowCasterCulling::MakeCasterVolume(lightView, lightProjection, aroundLight);
+	EXPECT(!aroundVolume.IsEmpty);
+	EXPECT(ShadowCasterCulling::IsCasterInVolume(aroundVolume, MakeBox(lightPosition + glm::vec3(0.4f, -0.5f, -0.4f), 0.05f)));
+}
@@ -0,0 +1,205 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/ShadowScheduler.h"
+
+static ShadowViewRequest MakeRequest(uint64_t viewID, float screenCoverage, uint32_t numDraws)
+{
+	ShadowViewRequest request;
+	request.ViewID = viewID;
+	request.ScreenCoverage = screenCoverage;
+	request.Distance = 10.0f;
+	request.NumDraws = numDraws;
+	request.NumTriangles = numDraws * 1000ull;
+	return request;
+}
+
+static std::vector<uint64_t> GetUpdatedViews(const std::vector<ShadowViewRequest>& requests, const std::vector<uint8_t>& update)
+{
+	std::vector<uint64_t> viewIDs;
+	for (std::size_t i = 0; i < requests.size(); ++i)
+	{
+		if (update[i])
+			viewIDs.push_back(requests[i].ViewID);
+	}
+
+	std::sort(viewIDs.begin(), viewIDs.end());
+	return viewIDs;
+}
+
+TEST_CASE(ShadowSchedulerUnlimitedBudget)
+{
+	ShadowScheduler scheduler;
+	std::vector<ShadowViewRequest> requests;
+	for (uint64_t viewID = 0; viewID < 16; ++viewID)
+		requests.push_back(MakeRequest(viewID, 100.0f, 10));
+
+	std::vector<uint8_t> update;
+	scheduler.Schedule(requests, update);
+
+	EXPECT(std::all_of(update.begin(), update.end(), [](uint8_t isUpdated) { return isUpdated == 1; }));
+	EXPECT_EQ(scheduler.GetStatistics().NumViews, 16u);
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedViews, 16u);
+	EXPECT_EQ(scheduler.GetStatistics().NumSkippedViews, 0u);
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedDraws, 160u);
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedTriangles, 160000ull);
+}
+
+TEST_CASE(ShadowSchedulerBudgetOrder)
+{
+	ShadowSchedulerSettings settings;
+	settings.DrawBudget = 20;
+	ShadowScheduler scheduler(settings);
+
+	// The cascade goes over the budget on its own, the invalid view goes before the larger stale ones
+	ShadowViewRequest cascade = MakeRequest(0, 0.0f, 25);
+	cascade.AlwaysUpdate = true;
+	ShadowViewRequest invalid = MakeRequest(1, 1.0f, 10);
+	invalid.IsInvalid = true;
+	ShadowViewRequest large = MakeRequest(2, 500.0f, 10);
+	large.HasMoved = true;
+	ShadowViewRequest small = MakeRequest(3, 10.0f, 5);
+	std::vector<ShadowViewRequest> requests = { large, small, cascade, invalid };
+
+	std::vector<uint8_t> update;
+	scheduler.Schedule(requests, update);
+
+	// Nothing but the cascade fits, the invalid view is still rendered so the budget does not starve every other view
+	EXPECT(GetUpdatedViews(requests, update) == std::vector<uint64_t>({ 0, 1 }));
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedDraws, 35u);
+	EXPECT_EQ(scheduler.GetStatistics().NumSkippedViews, 2u);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(2), 1u);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(3), 1u);
+
+	// With room for the top stale view, a cheaper view further down fills the rest of the budget
+	settings.DrawBudget = 30;
+	scheduler.SetSettings(settings);
+	cascade.NumDraws = 5;
+	invalid.IsInvalid = false;
+	invalid.NumDraws = 12;
+	requests = { large, small, cascade, invalid };
+
+	scheduler.Schedule(requests, update);
+	EXPECT(GetUpdatedViews(requests, update) == std::vector<uint64_t>({ 0, 2, 3 }));
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedDraws, 20u);
+	EXPECT_EQ(scheduler.GetStatistics().NumUnshadowedViews, 0u);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(1), 1u);
+}
+
+TEST_CASE(ShadowSchedulerUnshadowedViews)
+{
+	ShadowSchedulerSettings settings;
+	settings.TriangleBudget = 10000;
+	ShadowScheduler scheduler(settings);
+
+	std::vector<ShadowViewRequest> requests;
+	for (uint64_t viewID = 0; viewID < 4; ++viewID)
+	{
+		requests.push_back(MakeRequest(viewID, 100.0f, 8));
+		requests.back().IsInvalid = true;
+	}
+
+	std::vector<uint8_t> update;
+	scheduler.Schedule(requests, update);
+
+	EXPECT_EQ(scheduler.GetStatistics().NumUpdatedViews, 1u);
+	EXPECT_EQ(scheduler.GetStatistics().NumUnshadowedViews, 3u);
+	EXPECT(GetUpdatedViews(requests, update) == std::vector<uint64_t>({ 0 }));
+}
+
+TEST_CASE(ShadowSchedulerNoStarvation)
+{
+	ShadowSchedulerSettings settings;
+	settings.DrawBudget = 10;
+	ShadowScheduler scheduler(settings);
+
+	// One large, moving light close to the camera and many smaller ones that only fit one at a time
+	std::vector<ShadowViewRequest> requests;
+	requests.push_back(MakeRequest(0, 1000.0f, 10));
+	requests.back().HasMoved = true;
+	requests.back().Distance = 1.0f;
+
+	for (uint64_t viewID = 1; viewID < 8; ++viewID)
+	{
+		requests.push_back(MakeRequest(viewID, 50.0f, 10));
+		requests.back().Distance = 50.0f;
+		requests.back().HasDynamicCasters = true;
+	}
+
+	// A small view overtakes the large one after about importance ratio frames, the large one grows again while it waits
+	float largeImportance = (1.0f + 1000.0f) / (1.0f + 1.0f * settings.DistanceFalloff) * settings.MotionWeight;
+	float smallImportance = (1.0f + 50.0f) / (1.0f + 50.0f * settings.DistanceFalloff);
+	uint32_t maxExpectedWait = 2 * static_cast<uint32_t>(std::ceil(largeImportance / smallImportance));
+	constexpr uint32_t NUM_FRAMES = 1000;
+
+	std::vector<uint32_t> numUpdates(requests.size(), 0);
+	std::vector<uint8_t> update;
+	uint32_t maxFramesSinceUpdate = 0;
+
+	for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame)
+	{
+		scheduler.Schedule(requests, update);
+		EXPECT_EQ(scheduler.GetStatistics().NumUpdatedViews, 1u);
+
+		for (std::size_t i = 0; i < requests.size(); ++i)
+			numUpdates[i] += update[i];
+
+		maxFramesSinceUpdate = std::max(maxFramesSinceUpdate, scheduler.GetStatistics().MaxFramesSinceUpdate);
+	}
+
+	// The important light gets most of the updates, but every view keeps getting its turn
+	EXPECT(numUpdates[0] > NUM_FRAMES / 2);
+	for (std::size_t i = 1; i < requests.size(); ++i)
+		EXPECT(numUpdates[i] >= NUM_FRAMES / maxExpectedWait);
+
+	EXPECT(maxFramesSinceUpdate <= maxExpectedWait);
+	for (const ShadowViewRequest& request : requests)
+		EXPECT(scheduler.GetFramesSinceUpdate(request.ViewID) <= maxFramesSinceUpdate);
+}
+
+TEST_CASE(ShadowSchedulerDeterministic)
+{
+	ShadowSchedulerSettings settings;
+	settings.DrawBudget = 12;
+
+	// Equal priorities, the order of the requests must not decide which views update
+	std::vector<ShadowViewRequest> requests;
+	for (uint64_t viewID = 0; viewID < 6; ++viewID)
+		requests.push_back(MakeRequest(viewID * 7, 50.0f, 4));
+
+	std::vector<ShadowViewRequest> reversedRequests(requests.rbegin(), requests.rend());
+
+	ShadowScheduler scheduler(settings), reversedScheduler(settings);
+	std::vector<uint8_t> update, reversedUpdate;
+
+	for (uint32_t frame = 0; frame < 8; ++frame)
+	{
+		scheduler.Schedule(requests, update);
+		reversedScheduler.Schedule(reversedRequests, reversedUpdate);
+
+		EXPECT(GetUpdatedViews(requests, update) == GetUpdatedViews(reversedRequests, reversedUpdate));
+	}
+
+	// Ties go to the lowest view IDs
+	ShadowScheduler freshScheduler(settings);
+	freshScheduler.Schedule(reversedRequests, reversedUpdate);
+	EXPECT(GetUpdatedViews(reversedRequests, reversedUpdate) == std::vector<uint64_t>({ 0, 7, 14 }));
+}
+
+TEST_CASE(ShadowSchedulerForgetsRemovedViews)
+{
+	ShadowSchedulerSettings settings;
+	settings.DrawBudget = 1;
+	ShadowScheduler scheduler(settings);
+
+	std::vector<ShadowViewRequest> requests = { MakeRequest(1, 100.0f, 1), MakeRequest(2, 1.0f, 1) };
+	std::vector<uint8_t> update;
+	scheduler.Schedule(requests, update);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(2), 1u);
+
+	// A view that comes back after it was not requested for a frame starts over like a new view
+	scheduler.Schedule({ requests[0] }, update);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(2), 0u);
+
+	scheduler.Schedule(requests, update);
+	EXPECT_EQ(scheduler.GetFramesSinceUpdate(2), 1u);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+
+	Minimal test framework of dx12r_tests, test cases register themselves at static initialization and are run by TestMain.cpp.
+	A failed expectation is reported and the test case continues, so one run lists every failure of a test case.
+
+*/
+namespace Test
+{
+
+	using TestFunction = void(*)();
+
+	bool Register(const char* name, TestFunction function);
+	void ReportFailure(const char* file, int line, const std::string& message);
+
+	// Writes the contents to a file in the temporary directory and returns its path
+	std::string WriteTemporaryFile(const std::string& filename, const std::string& contents);
+
+};
+
+#define TEST_CASE(name) \
+	static void name(); \
+	static bool name##Registered = Test::Register(#name, name); \
+	static void name()
+
+#define EXPECT(condition) \
+	do { if (!(condition)) Test::ReportFailure(__FILE__, __LINE__, #condition); } while (false)
+
+#define EXPECT_EQ(lhs, rhs) \
+	do { if (!((lhs) == (rhs))) Test::ReportFailure(__FILE__, __LINE__, std::string(#lhs " == " #rhs ", got ") + std::to_string(lhs) + " and " + std::to_string(rhs)); } while (false)
@@ -0,0 +1,71 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+
+#include <filesystem>
+#include <fstream>
+
+struct TestCaseEntry
+{
+	const char* Name;
+	Test::TestFunction Function;
+};
+
+struct InternalTestData
+{
+	std::vector<TestCaseEntry> TestCases;
+	uint32_t NumFailures = 0;
+};
+
+// Function local, test cases of other translation units register themselves during static initialization
+static InternalTestData& GetTestData()
+{
+	static InternalTestData data;
+	return data;
+}
+
+bool Test::Register(const char* name, TestFunction function)
+{
+	GetTestData().TestCases.push_back({ name, function });
+	return true;
+}
+
+void Test::ReportFailure(const char* file, int line, const std::string& message)
+{
+	printf("  %s(%d): expected %s\n", file, line, message.c_str());
+	GetTestData().NumFailures++;
+}
+
+std::string Test::WriteTemporaryFile(const std::string& filename, const std::string& contents)
+{
+	std::string filepath = (std::filesystem::temp_directory_path() / filename).string();
+
+	std::ofstream file(filepath, std::ios::binary);
+	file << contents;
+
+	return filepath;
+}
+
+// Runs every test case, or the ones whose name contains the first argument
+int main(int argc, char* argv[])
+{
+	InternalTestData& data = GetTestData();
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	uint32_t numRun = 0, numFailed = 0;
+	for (const TestCaseEntry& testCase : data.TestCases)
+	{
+		if (filter && !strstr(testCase.Name, filter))
+			continue;
+
+		uint32_t numFailuresBefore = data.NumFailures;
+		testCase.Function();
+		numRun++;
+
+		bool passed = data.NumFailures == numFailuresBefore;
+		numFailed += passed ? 0 : 1;
+		printf("[%s] %s\n", passed ? "PASS" : "FAIL", testCase.Name);
+	}
+
+	printf("%u of %u test cases passed\n", numRun - numFailed, numRun);
+	return numFailed == 0 && numRun > 0 ? 0 : 1;
+}
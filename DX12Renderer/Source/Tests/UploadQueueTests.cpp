@@ -0,0 +1,281 @@
+#include "Pch.h"
+#include "Tests/Test.h"
+#include "Graphics/Backend/UploadQueue.h"
+
+#include <chrono>
+
+// Destination of the fake backend, copies land here when they are recorded
+struct FakeResource
+{
+	std::vector<uint8_t> Memory;
+	std::size_t RowPitch = 0;
+	uint32_t NumCompletions = 0;
+};
+
+/*
+
+	Records copies into fake resources and only completes fences when the test says so,
+	WaitForFenceValue completes everything up to the value like a GPU that finished its work.
+
+*/
+class FakeUploadQueueBackend : public UploadQueueBackend
+{
+public:
+	static constexpr std::size_t ROW_PITCH_ALIGNMENT = 256;
+	static constexpr std::size_t SLICE_ALIGNMENT = 512;
+
+	FakeUploadQueueBackend(std::size_t stagingByteSize)
+		: m_Staging(stagingByteSize)
+	{
+	}
+
+	virtual uint8_t* GetStagingMemory() override { return m_Staging.data(); }
+	virtual std::size_t GetStagingByteSize() const override { return m_Staging.size(); }
+	virtual std::size_t GetTextureRowPitchAlignment() const override { return ROW_PITCH_ALIGNMENT; }
+	virtual std::size_t GetTextureSliceAlignment() const override { return SLICE_ALIGNMENT; }
+
+	virtual void BeginBatch() override
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_IsBatchOpen = true;
+	}
+
+	virtual void RecordCopy(const UploadRequest& request, const UploadSlice& slice) override
+	{
+		std::scoped_lock lock(m_Mutex);
+		if (!m_IsBatchOpen)
+			m_NumCopiesOutsideBatch++;
+
+		FakeResource* resource = static_cast<FakeResource*>(request.Destination);
+		const uint8_t* staging = m_Staging.data() + slice.StagingOffset;
+
+		if (request.Type == UploadRequestType::UPLOAD_REQUEST_TYPE_BUFFER)
+		{
+			memcpy(resource->Memory.data() + slice.ByteOffset, staging, slice.NumBytes);
+			return;
+		}
+
+		if (slice.StagingOffset % SLICE_ALIGNMENT != 0 || slice.StagingRowPitch % ROW_PITCH_ALIGNMENT != 0 || slice.StagingRowPitch < request.RowPitch)
+			m_NumMisalignedSlices++;
+
+		for (uint32_t row = 0; row < slice.NumRows; ++row)
+			memcpy(resource->Memory.data() + (slice.FirstRow + row) * resource->RowPitch, staging + row * slice.StagingRowPitch, resource->RowPitch);
+	}
+
+	virtual uint64_t SubmitBatch() override
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_IsBatchOpen = false;
+		return ++m_SubmittedFenceValue;
+	}
+
+	virtual uint64_t GetCompletedFenceValue() const override
+	{
+		return m_CompletedFenceValue;
+	}
+
+	virtual void WaitForFenceValue(uint64_t fenceValue) override
+	{
+		CompleteFenceValue(fenceValue);
+	}
+
+	virtual void OnUploadComplete(UploadRequestType type, void* destination) override
+	{
+		FakeResource* resource = static_cast<FakeResource*>(destination);
+		resource->NumCompletions++;
+		m_CompletionOrder.push_back(resource);
+	}
+
+	void CompleteFenceValue(uint64_t fenceValue)
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_CompletedFenceValue = std::max(m_CompletedFenceValue.load(), std::min(fenceValue, m_SubmittedFenceValue));
+	}
+
+	void CompleteAll()
+	{
+		std::scoped_lock lock(m_Mutex);
+		m_CompletedFenceValue = m_SubmittedFenceValue;
+	}
+
+	uint32_t GetNumMisalignedSlices() const { std::scoped_lock lock(m_Mutex); return m_NumMisalignedSlices; }
+	uint32_t GetNumCopiesOutsideBatch() const { std::scoped_lock lock(m_Mutex); return m_NumCopiesOutsideBatch; }
+	const std::vector<FakeResource*>& GetCompletionOrder() const { return m_CompletionOrder; }
+
+private:
+	std::vector<uint8_t> m_Staging;
+
+	mutable std::mutex m_Mutex;
+	bool m_IsBatchOpen = false;
+	uint64_t m_SubmittedFenceValue = 0;
+	std::atomic<uint64_t> m_CompletedFenceValue = 0;
+	uint32_t m_NumMisalignedSlices = 0;
+	uint32_t m_NumCopiesOutsideBatch = 0;
+
+	// Only touched from the thread that processes completions
+	std::vector<FakeResource*> m_CompletionOrder;
+
+};
+
+static std::vector<uint8_t> MakePattern(std::size_t byteSize, uint8_t seed)
+{
+	std::vector<uint8_t> bytes(byteSize);
+	for (std::size_t i = 0; i < byteSize; ++i)
+		bytes[i] = static_cast<uint8_t>(i * 31 + seed + i / 251);
+
+	return bytes;
+}
+
+// The worker is asynchronous, statistics are polled until they match or a generous timeout passes
+template<typename Predicate_t>
+static bool WaitUntil(Predicate_t predicate)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (!predicate())
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return true;
+}
+
+TEST_CASE(UploadQueueSplitsBufferLargerThanStaging)
+{
+	FakeUploadQueueBackend* backend = new FakeUploadQueueBackend(KILOBYTE(128));
+	UploadQueue queue((std::unique_ptr<UploadQueueBackend>(backend)));
+
+	std::vector<uint8_t> data = MakePattern(KILOBYTE(300) + 7, 3);
+	FakeResource resource;
+	resource.Memory.resize(data.size());
+
+	UploadTicket ticket = queue.UploadBuffer(&resource, data.data(), data.size());
+	EXPECT(ticket.Value != 0);
+
+	queue.Flush();
+
+	EXPECT(queue.IsComplete(ticket));
+	EXPECT(resource.Memory == data);
+	EXPECT_EQ(resource.NumCompletions, 1u);
+	EXPECT_EQ(backend->GetNumCopiesOutsideBatch(), 0u);
+	// The staging ring holds less than half of the buffer, so it took several batches
+	EXPECT(queue.GetStatistics().NumBatchesSubmitted >= 3);
+}
+
+TEST_CASE(UploadQueueCopiesTextureRowsWithAlignedPitch)
+{
+	FakeUploadQueueBackend* backend = new FakeUploadQueueBackend(KILOBYTE(16));
+	UploadQueue queue((std::unique_ptr<UploadQueueBackend>(backend)));
+
+	// The row pitch is not a multiple of the alignment, and all rows together need more than the staging ring
+	const std::size_t rowPitch = 100;
+	const uint32_t numRows = 200;
+	std::vector<uint8_t> data = MakePattern(rowPitch * numRows, 11);
+
+	FakeResource resource;
+	resource.Memory.resize(data.size());
+	resource.RowPitch = rowPitch;
+
+	UploadTicket ticket = queue.UploadTexture(&resource, data.data(), rowPitch, numRows);
+	queue.WaitForTicket(ticket);
+
+	EXPECT(queue.IsComplete(ticket));
+	EXPECT(resource.Memory == data);
+	EXPECT_EQ(resource.NumCompletions, 1u);
+	EXPECT_EQ(backend->GetNumMisalignedSlices(), 0u);
+}
+
+TEST_CASE(UploadQueueRespectsFrameBudget)
+{
+	FakeUploadQueueBackend* backend = new FakeUploadQueueBackend(KILOBYTE(64));
+
+	UploadQueueDesc desc;
+	desc.MaxBytesPerFrame = 1024;
+	UploadQueue queue(std::unique_ptr<UploadQueueBackend>(backend), desc);
+
+	const std::size_t rowPitch = 256;
+	const uint32_t numRows = 64;
+	std::vector<uint8_t> data = MakePattern(rowPitch * numRows, 5);
+
+	FakeResource resource;
+	resource.Memory.resize(data.size());
+	resource.RowPitch = rowPitch;
+
+	UploadTicket ticket = queue.UploadTexture(&resource, data.data(), rowPitch, numRows);
+
+	// Four rows fit into the budget of a frame, the rest waits for the next frames
+	EXPECT(WaitUntil([&queue] { return queue.GetStatistics().BytesUploadedThisFrame == 1024; }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	UploadQueueStatistics stats = queue.GetStatistics();
+	EXPECT_EQ(stats.BytesUploadedThisFrame, std::size_t(1024));
+	EXPECT_EQ(stats.NumPendingRequests, std::size_t(1));
+	EXPECT_EQ(stats.NumPendingBytes, data.size() - 1024);
+
+	queue.BeginFrame();
+	EXPECT(WaitUntil([&queue] { return queue.GetStatistics().BytesUploadedThisFrame == 1024; }));
+	EXPECT_EQ(queue.GetStatistics().NumPendingBytes, data.size() - 2048);
+
+	backend->CompleteAll();
+	queue.ProcessCompletions();
+	EXPECT(!queue.IsComplete(ticket));
+
+	// Waiting lifts the budget
+	queue.WaitForTicket(ticket);
+	EXPECT(queue.IsComplete(ticket));
+	EXPECT(resource.Memory == data);
+}
+
+TEST_CASE(UploadQueueCompletesTicketsInOrderAfterFence)
+{
+	FakeUploadQueueBackend* backend = new FakeUploadQueueBackend(KILOBYTE(256));
+	UploadQueue queue((std::unique_ptr<UploadQueueBackend>(backend)));
+
+	EXPECT(queue.IsComplete(UploadTicket()));
+
+	std::vector<uint8_t> firstData = MakePattern(KILOBYTE(4), 1);
+	std::vector<uint8_t> secondData = MakePattern(KILOBYTE(8), 2);
+
+	FakeResource first, second;
+	first.Memory.resize(firstData.size());
+	second.Memory.resize(secondData.size());
+
+	UploadTicket firstTicket = queue.UploadBuffer(&first, firstData.data(), firstData.size());
+	UploadTicket secondTicket = queue.UploadBuffer(&second, secondData.data(), secondData.size());
+	EXPECT(secondTicket.Value > firstTicket.Value);
+
+	// Everything is recorded and submitted, but the fence did not pass yet
+	EXPECT(WaitUntil([&queue] { UploadQueueStatistics stats = queue.GetStatistics(); return stats.NumPendingRequests == 0 && stats.NumBatchesSubmitted > 0; }));
+	queue.ProcessCompletions();
+
+	EXPECT(!queue.IsComplete(firstTicket));
+	EXPECT(!queue.IsComplete(secondTicket));
+	EXPECT_EQ(first.NumCompletions, 0u);
+
+	backend->CompleteAll();
+	queue.ProcessCompletions();
+
+	EXPECT(queue.IsComplete(firstTicket));
+	EXPECT(queue.IsComplete(secondTicket));
+	EXPECT_EQ(queue.GetStatistics().NumRequestsCompleted, uint64_t(2));
+
+	const std::vector<FakeResource*>& completionOrder = backend->GetCompletionOrder();
+	EXPECT_EQ(completionOrder.size(), std::size_t(2));
+	EXPECT(completionOrder.size() == 2 && completionOrder[0] == &first && completionOrder[1] == &second);
+	EXPECT(first.Memory == firstData);
+	EXPECT(second.Memory == secondData);
+}
+
+TEST_CASE(UploadQueueIgnoresEmptyUploads)
+{
+	UploadQueue queue(std::make_unique<FakeUploadQueueBackend>(KILOBYTE(64)));
+	FakeResource resource;
+
+	EXPECT_EQ(queue.UploadBuffer(&resource, nullptr, 16).Value, uint64_t(0));
+	EXPECT_EQ(queue.UploadTexture(&resource, &resource, 0, 4).Value, uint64_t(0));
+
+	queue.Flush();
+	EXPECT_EQ(queue.GetStatistics().NumBatchesSubmitted, uint64_t(0));
+}
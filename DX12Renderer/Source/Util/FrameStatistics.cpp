@@ -0,0 +1,196 @@
+#include "Pch.h"
+#include "Util/FrameStatistics.h"
+
+#include <cmath>
+
+static constexpr uint32_t FLOAT_MANTISSA_BITS = 23;
+static constexpr uint32_t FLOAT_EXPONENT_BIAS = 127;
+static constexpr uint32_t HISTOGRAM_FIRST_BUCKET_BITS = (FLOAT_EXPONENT_BIAS + FrameTimeHistogram::MIN_EXPONENT) << FrameTimeHistogram::NUM_SUB_BUCKET_BITS;
+
+// The median only moves slowly, so it is not refreshed for every sample, the windows need this many samples before they detect stutters
+static constexpr uint32_t STATISTICS_MEDIAN_INTERVAL = 16;
+
+void FrameTimeHistogram::Add(float milliseconds)
+{
+	m_Counts[GetBucket(milliseconds)]++;
+	m_NumSamples++;
+}
+
+void FrameTimeHistogram::Remove(float milliseconds)
+{
+	uint32_t bucket = GetBucket(milliseconds);
+	ASSERT(m_Counts[bucket] > 0, "Removed a sample that is not in the histogram");
+
+	m_Counts[bucket]--;
+	m_NumSamples--;
+}
+
+void FrameTimeHistogram::Clear()
+{
+	m_Counts.fill(0);
+	m_NumSamples = 0;
+}
+
+float FrameTimeHistogram::GetPercentile(float percentile) const
+{
+	if (m_NumSamples == 0)
+		return 0.0f;
+
+	// Nearest rank, the sample at the percentile is the first one at or above it.
+	// The rank is rounded down by a little, so 99.9 of 1000 samples is the 999th sample despite the float error of 99.9
+	double rank = std::ceil(static_cast<double>(std::clamp(percentile, 0.0f, 100.0f)) / 100.0 * m_NumSamples - 0.001);
+	uint32_t targetRank = std::max(static_cast<uint32_t>(rank), 1u);
+
+	uint32_t numSamples = 0;
+	for (uint32_t bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+	{
+		numSamples += m_Counts[bucket];
+		if (numSamples >= targetRank)
+			return 0.5f * (GetBucketLowerBound(bucket) + GetBucketLowerBound(bucket + 1));
+	}
+
+	return GetBucketLowerBound(NUM_BUCKETS);
+}
+
+uint32_t FrameTimeHistogram::GetBucket(float milliseconds)
+{
+	static const float minTime = std::ldexp(1.0f, MIN_EXPONENT);
+	static const float maxTime = std::ldexp(1.0f, MAX_EXPONENT);
+
+	// Also catches NaN
+	if (!(milliseconds >= minTime))
+		return 0;
+	if (milliseconds >= maxTime)
+		return NUM_BUCKETS - 1;
+
+	uint32_t bits = 0;
+	std::memcpy(&bits, &milliseconds, sizeof(bits));
+
+	return (bits >> (FLOAT_MANTISSA_BITS - NUM_SUB_BUCKET_BITS)) - HISTOGRAM_FIRST_BUCKET_BITS;
+}
+
+float FrameTimeHistogram::GetBucketLowerBound(uint32_t bucket)
+{
+	uint32_t bits = (bucket + HISTOGRAM_FIRST_BUCKET_BITS) << (FLOAT_MANTISSA_BITS - NUM_SUB_BUCKET_BITS);
+
+	float milliseconds = 0.0f;
+	std::memcpy(&milliseconds, &bits, sizeof(milliseconds));
+
+	return milliseconds;
+}
+
+RollingFrameStatistics::RollingFrameStatistics(uint32_t windowSize, float stutterFactor)
+	: m_StutterFactor(stutterFactor)
+{
+	ASSERT(windowSize > 0, "Frame statistics need a window of at least one sample");
+
+	m_Samples.resize(std::max(windowSize, 1u));
+	m_IsStutter.resize(m_Samples.size());
+}
+
+void RollingFrameStatistics::AddSample(float milliseconds)
+{
+	uint32_t windowSize = GetWindowSize();
+
+	if (m_NumSamples == windowSize)
+	{
+		float oldest = m_Samples[m_NextSample];
+		m_Histogram.Remove(oldest);
+		m_Sum -= oldest;
+		m_SumOfSquares -= static_cast<double>(oldest) * oldest;
+		m_NumStutters -= m_IsStutter[m_NextSample];
+	}
+	else
+	{
+		m_NumSamples++;
+	}
+
+	bool isStutter = m_Median > 0.0f && milliseconds > m_StutterFactor * m_Median;
+	m_Samples[m_NextSample] = milliseconds;
+	m_IsStutter[m_NextSample] = isStutter ? 1 : 0;
+	m_NumStutters += m_IsStutter[m_NextSample];
+	m_NumTotalStutters += m_IsStutter[m_NextSample];
+
+	m_Histogram.Add(milliseconds);
+	m_Sum += milliseconds;
+	m_SumOfSquares += static_cast<double>(milliseconds) * milliseconds;
+
+	m_NextSample = (m_NextSample + 1) % windowSize;
+	if (m_NextSample == 0)
+		RecomputeSums();
+
+	// Refreshing scans the histogram, which is constant work spread over the interval
+	m_NumSamplesSinceMedian++;
+	if (m_NumSamplesSinceMedian == STATISTICS_MEDIAN_INTERVAL)
+	{
+		m_Median = m_Histogram.GetPercentile(50.0f);
+		m_NumSamplesSinceMedian = 0;
+	}
+}
+
+void RollingFrameStatistics::Clear()
+{
+	std::fill(m_IsStutter.begin(), m_IsStutter.end(), static_cast<uint8_t>(0));
+	m_NextSample = 0;
+	m_NumSamples = 0;
+
+	m_Histogram.Clear();
+	m_Sum = 0.0;
+	m_SumOfSquares = 0.0;
+
+	m_Median = 0.0f;
+	m_NumSamplesSinceMedian = 0;
+	m_NumStutters = 0;
+	m_NumTotalStutters = 0;
+}
+
+FrameTimeStatistics RollingFrameStatistics::GetStatistics() const
+{
+	FrameTimeStatistics stats;
+	stats.NumSamples = m_NumSamples;
+	stats.NumStutters = m_NumStutters;
+
+	if (m_NumSamples == 0)
+		return stats;
+
+	// The window is only filled from the front until it wrapped around once
+	auto [minIter, maxIter] = std::minmax_element(m_Samples.begin(), m_Samples.begin() + m_NumSamples);
+	stats.Min = *minIter;
+	stats.Max = *maxIter;
+
+	double average = m_Sum / m_NumSamples;
+	double variance = std::max(m_SumOfSquares / m_NumSamples - average * average, 0.0);
+	stats.Average = static_cast<float>(average);
+	stats.StdDev = static_cast<float>(std::sqrt(variance));
+
+	// Bucket middles can lie just outside the samples, the exact bounds are known
+	auto getPercentile = [this, &stats](float percentile) { return std::clamp(m_Histogram.GetPercentile(percentile), stats.Min, stats.Max); };
+	stats.P50 = getPercentile(50.0f);
+	stats.P95 = getPercentile(95.0f);
+	stats.P99 = getPercentile(99.0f);
+	stats.P999 = getPercentile(99.9f);
+
+	return stats;
+}
+
+void RollingFrameStatistics::GetSamples(std::vector<float>& outSamples) const
+{
+	outSamples.clear();
+	outSamples.reserve(m_NumSamples);
+
+	uint32_t first = m_NumSamples == GetWindowSize() ? m_NextSample : 0;
+	for (uint32_t i = 0; i < m_NumSamples; ++i)
+		outSamples.push_back(m_Samples[(first + i) % GetWindowSize()]);
+}
+
+void RollingFrameStatistics::RecomputeSums()
+{
+	m_Sum = 0.0;
+	m_SumOfSquares = 0.0;
+
+	for (uint32_t i = 0; i < m_NumSamples; ++i)
+	{
+		m_Sum += m_Samples[i];
+		m_SumOfSquares += static_cast<double>(m_Samples[i]) * m_Samples[i];
+	}
+}
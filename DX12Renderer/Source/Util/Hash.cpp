@@ -0,0 +1,122 @@
+#include "Pch.h"
+#include "Util/Hash.h"
+
+#if defined(_M_X64)
+#include <intrin.h>
+#endif
+
+static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t RotateLeft(uint64_t value, uint32_t amount)
+{
+	return (value << amount) | (value >> (64 - amount));
+}
+
+static inline uint64_t Read64(const uint8_t* ptr)
+{
+	uint64_t value;
+	memcpy(&value, ptr, sizeof(uint64_t));
+	return value;
+}
+
+static inline uint64_t MultiplyFold64(uint64_t lhs, uint64_t rhs)
+{
+#if defined(_M_X64)
+	uint64_t high;
+	uint64_t low = _umul128(lhs, rhs, &high);
+	return low ^ high;
+#elif defined(__SIZEOF_INT128__)
+	unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+	return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+	// Portable 64x64 -> 128 bit multiply for 32-bit targets
+	uint64_t lo_lo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+	uint64_t hi_lo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+	uint64_t lo_hi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+	uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+
+	uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+	uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	uint64_t low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+	return low ^ high;
+#endif
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME64_2;
+	acc = RotateLeft(acc, 31);
+	return acc * PRIME64_1;
+}
+
+static inline uint64_t Avalanche(uint64_t hash)
+{
+	hash ^= hash >> 37;
+	hash *= 0x165667919E3779F9ULL;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+Hash128 Hash::Bytes(const void* data, std::size_t byteSize, uint64_t seed)
+{
+	const uint8_t* ptr = static_cast<const uint8_t*>(data);
+	const uint8_t* end = ptr + byteSize;
+
+	uint64_t acc[4] = {
+		seed + PRIME64_1 + PRIME64_2,
+		seed + PRIME64_2,
+		seed,
+		seed - PRIME64_1
+	};
+
+	// Main loop, 4 independent lanes so the multiplies can be pipelined
+	while (end - ptr >= 32)
+	{
+		acc[0] = Round(acc[0], Read64(ptr + 0));
+		acc[1] = Round(acc[1], Read64(ptr + 8));
+		acc[2] = Round(acc[2], Read64(ptr + 16));
+		acc[3] = Round(acc[3], Read64(ptr + 24));
+		ptr += 32;
+	}
+
+	// Remaining full words are spread across the lanes
+	uint32_t lane = 0;
+	while (end - ptr >= 8)
+	{
+		acc[lane] = Round(acc[lane], Read64(ptr));
+		lane = (lane + 1) & 3;
+		ptr += 8;
+	}
+
+	// Tail bytes are zero padded into a final word, the length is mixed in below so padding can't collide
+	if (ptr < end)
+	{
+		uint64_t tail = 0;
+		memcpy(&tail, ptr, end - ptr);
+		acc[lane] = Round(acc[lane], tail ^ PRIME64_5);
+	}
+
+	uint64_t length = static_cast<uint64_t>(byteSize);
+
+	Hash128 result = {};
+	result.Low = RotateLeft(acc[0], 1) + RotateLeft(acc[1], 7) + RotateLeft(acc[2], 12) + RotateLeft(acc[3], 18);
+	result.Low += MultiplyFold64(acc[0] ^ PRIME64_3, acc[2] ^ length);
+	result.High = MultiplyFold64(acc[1] ^ PRIME64_4, acc[3] ^ (length * PRIME64_1));
+	result.High += RotateLeft(acc[0] ^ acc[3], 27) + acc[1] + acc[2];
+
+	result.Low = Avalanche(result.Low ^ length);
+	result.High = Avalanche(result.High + (length * PRIME64_2));
+	return result;
+}
+
+Hash128 Hash::Combine(const Hash128& lhs, const Hash128& rhs)
+{
+	Hash128 result = {};
+	result.Low = Avalanche(MultiplyFold64(lhs.Low ^ PRIME64_1, rhs.Low ^ PRIME64_4) + RotateLeft(lhs.High, 17));
+	result.High = Avalanche(MultiplyFold64(lhs.High ^ PRIME64_2, rhs.High ^ PRIME64_5) + RotateLeft(rhs.Low, 29));
+	return result;
+}
@@ -0,0 +1,126 @@
+#include "Pch.h"
+#include "Util/JobSystem.h"
+
+struct Job
+{
+	std::function<void()> Function;
+	JobCounter* Counter = nullptr;
+};
+
+struct InternalJobSystemData
+{
+	std::vector<std::thread> Workers;
+	std::deque<Job> Jobs;
+
+	std::mutex JobsMutex;
+	std::condition_variable JobsCV;
+	bool Stop = false;
+};
+
+static InternalJobSystemData s_Data;
+
+static bool TryPopJob(Job& job)
+{
+	std::scoped_lock lock(s_Data.JobsMutex);
+	if (s_Data.Jobs.empty())
+		return false;
+
+	job = std::move(s_Data.Jobs.front());
+	s_Data.Jobs.pop_front();
+	return true;
+}
+
+static void RunJob(Job& job)
+{
+	SCOPED_TIMER("JobSystem::RunJob");
+	job.Function();
+	job.Counter->NumPendingJobs--;
+}
+
+static void WorkerLoop(uint32_t workerIndex)
+{
+	Profiler::SetThreadName("Job worker " + std::to_string(workerIndex));
+
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(s_Data.JobsMutex);
+			s_Data.JobsCV.wait(lock, [] { return s_Data.Stop || !s_Data.Jobs.empty(); });
+
+			if (s_Data.Stop && s_Data.Jobs.empty())
+				return;
+
+			job = std::move(s_Data.Jobs.front());
+			s_Data.Jobs.pop_front();
+		}
+
+		RunJob(job);
+	}
+}
+
+void JobSystem::Initialize(uint32_t numWorkers)
+{
+	if (numWorkers == 0)
+		numWorkers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	s_Data.Stop = false;
+	for (uint32_t i = 0; i < numWorkers; ++i)
+		s_Data.Workers.emplace_back(WorkerLoop, i);
+}
+
+void JobSystem::Finalize()
+{
+	{
+		std::scoped_lock lock(s_Data.JobsMutex);
+		s_Data.Stop = true;
+	}
+	s_Data.JobsCV.notify_all();
+
+	for (auto& worker : s_Data.Workers)
+		worker.join();
+
+	s_Data.Workers.clear();
+}
+
+void JobSystem::Execute(JobCounter& counter, std::function<void()> job)
+{
+	counter.NumPendingJobs++;
+
+	// Without workers (or before initialization) jobs simply run inline
+	if (s_Data.Workers.empty())
+	{
+		Job inlineJob = { std::move(job), &counter };
+		RunJob(inlineJob);
+		return;
+	}
+
+	{
+		std::scoped_lock lock(s_Data.JobsMutex);
+		s_Data.Jobs.push_back({ std::move(job), &counter });
+	}
+	s_Data.JobsCV.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (counter.NumPendingJobs > 0)
+	{
+		// Help out instead of idling, jobs of other counters are fine as well
+		Job job;
+		if (TryPopJob(job))
+			RunJob(job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::IsBusy(const JobCounter& counter)
+{
+	return counter.NumPendingJobs > 0;
+}
+
+uint32_t JobSystem::GetNumWorkers()
+{
+	return static_cast<uint32_t>(s_Data.Workers.size());
+}
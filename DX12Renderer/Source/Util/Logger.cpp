@@ -1,54 +1,487 @@
 #include "Pch.h"
 #include "Util/Logger.h"
 
-void Logger::Log(const char* message, Severity severity)
+#include <csignal>
+#include <filesystem>
+
+// Bytes per thread, a message with a few arguments takes about a hundred
+static constexpr uint64_t LOGGER_RING_BYTE_SIZE = 1 << 18;
+static constexpr uint64_t LOGGER_RING_MASK = LOGGER_RING_BYTE_SIZE - 1;
+// Larger messages, e.g. shader compiler output, bypass the ring and are written before the call returns
+static constexpr uint64_t LOGGER_MAX_RING_MESSAGE_BYTE_SIZE = LOGGER_RING_BYTE_SIZE / 4;
+static constexpr uint64_t LOGGER_MESSAGE_ALIGNMENT = 8;
+// The logger thread drains the rings this often, or as soon as it is woken up
+static constexpr std::chrono::milliseconds LOGGER_DRAIN_INTERVAL = std::chrono::milliseconds(5);
+// A crashing thread waits this long for the logger thread to finish its drain before it drains the rings itself
+static constexpr uint32_t LOGGER_CRASH_LOCK_ATTEMPTS = 100;
+
+struct LogMessageHeader
+{
+	// Nullptr for padding up to the end of the ring, the next message starts at the beginning of the ring
+	Logger::DecodeFunction Decode;
+	const char* Format;
+	// Header and arguments, aligned to LOGGER_MESSAGE_ALIGNMENT
+	uint32_t ByteSize;
+	Logger::Severity Severity;
+};
+
+// Single producer (the owning thread), single consumer (whoever holds the drain lock) ring of messages
+struct LoggerThreadRing
 {
-	SetSeverityConsoleColor(severity);
+	std::unique_ptr<uint8_t[]> Data = std::make_unique<uint8_t[]>(LOGGER_RING_BYTE_SIZE);
+	std::atomic<uint64_t> WritePos = 0;
+	std::atomic<uint64_t> ReadPos = 0;
+
+	// Only written by the owning thread, so they are counted without atomic read-modify-writes
+	std::atomic<uint64_t> NumMessages = 0;
+	std::atomic<uint64_t> NumBlockedMessages = 0;
+
+	// Only touched by the owning thread, the read position it saw last and the end of the message it is writing
+	uint64_t CachedReadPos = 0;
+	uint64_t MessageEndPos = 0;
+	// Message that is too large for the ring, written straight to the sinks by EndMessage
+	std::vector<uint8_t> OversizedMessage;
+};
 
-	std::string strMessage(message);
-	std::string fullMessage = SeverityToString(severity) + strMessage + "\n";
+class ConsoleLogSink : public LogSink
+{
+public:
+	virtual void Write(Logger::Severity severity, const std::string& line) override
+	{
+#if defined(_WIN32)
+		HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+
+		switch (severity)
+		{
+		case Logger::Severity::INFO:
+			SetConsoleTextAttribute(hConsole, 7);
+			break;
+		case Logger::Severity::WARN:
+			SetConsoleTextAttribute(hConsole, 6);
+			break;
+		case Logger::Severity::ERR:
+			SetConsoleTextAttribute(hConsole, 12);
+			break;
+		}
+#endif
+
+		fwrite(line.data(), 1, line.size(), stdout);
+	}
 
-	printf(fullMessage.c_str());
+	virtual void Flush() override
+	{
+		fflush(stdout);
+	}
+
+};
+
+class FileLogSink : public LogSink
+{
+public:
+	FileLogSink(const std::string& filepath, std::size_t maxByteSize, uint32_t numBackups)
+		: m_Filepath(filepath), m_MaxByteSize(maxByteSize), m_NumBackups(numBackups)
+	{
+		m_File = fopen(m_Filepath.c_str(), "ab");
+		if (m_File)
+			m_ByteSize = static_cast<std::size_t>(std::filesystem::file_size(m_Filepath, m_Error));
+	}
+
+	virtual ~FileLogSink()
+	{
+		if (m_File)
+			fclose(m_File);
+	}
+
+	virtual void Write(Logger::Severity severity, const std::string& line) override
+	{
+		if (m_File && m_ByteSize > 0 && m_ByteSize + line.size() > m_MaxByteSize)
+			Rotate();
+
+		if (m_File)
+		{
+			fwrite(line.data(), 1, line.size(), m_File);
+			m_ByteSize += line.size();
+		}
+	}
+
+	virtual void Flush() override
+	{
+		if (m_File)
+			fflush(m_File);
+	}
+
+	bool IsValid() const { return m_File != nullptr; }
+
+private:
+	void Rotate()
+	{
+		fclose(m_File);
+
+		// filepath.1 is the newest backup, the oldest one is overwritten
+		for (uint32_t backup = m_NumBackups; backup > 1; --backup)
+			std::filesystem::rename(m_Filepath + "." + std::to_string(backup - 1), m_Filepath + "." + std::to_string(backup), m_Error);
+
+		if (m_NumBackups > 0)
+			std::filesystem::rename(m_Filepath, m_Filepath + ".1", m_Error);
+
+		m_File = fopen(m_Filepath.c_str(), "wb");
+		m_ByteSize = 0;
+	}
+
+private:
+	std::string m_Filepath;
+	std::size_t m_MaxByteSize = 0;
+	uint32_t m_NumBackups = 0;
+
+	FILE* m_File = nullptr;
+	std::size_t m_ByteSize = 0;
+	std::error_code m_Error;
+
+};
+
+static void StopLoggerThread();
+
+struct InternalLoggerData
+{
+	// Rings are never released, so messages of threads that already exited can still be drained
+	std::mutex RingsMutex;
+	std::vector<std::unique_ptr<LoggerThreadRing>> Rings;
+
+	// Held by whoever drains the rings and writes to the sinks, the logger thread or a thread that flushes
+	std::mutex DrainMutex;
+	std::shared_ptr<LogSink> ConsoleSink = std::make_shared<ConsoleLogSink>();
+	std::vector<std::shared_ptr<LogSink>> Sinks;
+	bool IsConsoleOutputEnabled = true;
+	std::string Message;
+	std::string Line;
+	std::atomic<uint64_t> NumWrittenBytes = 0;
+
+	std::thread Thread;
+	std::mutex WakeMutex;
+	std::condition_variable WakeCondition;
+	std::atomic<bool> IsRunning = false;
+
+	~InternalLoggerData()
+	{
+		StopLoggerThread();
+	}
+};
+
+static InternalLoggerData s_Data;
+static thread_local LoggerThreadRing* t_Ring = nullptr;
+
+static void WriteMessage(const LogMessageHeader& header, const uint8_t* arguments)
+{
+	s_Data.Message.clear();
+	header.Decode(header.Format, arguments, s_Data.Message);
+
+	s_Data.Line.clear();
+	s_Data.Line += Logger::SeverityToString(header.Severity);
+	s_Data.Line += s_Data.Message;
+	s_Data.Line += '\n';
+
+	if (s_Data.IsConsoleOutputEnabled)
+		s_Data.ConsoleSink->Write(header.Severity, s_Data.Line);
+	for (auto& sink : s_Data.Sinks)
+		sink->Write(header.Severity, s_Data.Line);
+
+	s_Data.NumWrittenBytes.store(s_Data.NumWrittenBytes.load(std::memory_order_relaxed) + s_Data.Line.size(), std::memory_order_relaxed);
 }
 
-void Logger::Log(const std::string& message, Severity severity)
+// Expects the drain lock to be held
+static void DrainRings()
 {
-	SetSeverityConsoleColor(severity);
+	std::vector<LoggerThreadRing*> rings;
+	{
+		std::scoped_lock lock(s_Data.RingsMutex);
+		rings.reserve(s_Data.Rings.size());
+		for (auto& ring : s_Data.Rings)
+			rings.push_back(ring.get());
+	}
+
+	for (LoggerThreadRing* ring : rings)
+	{
+		uint64_t readPos = ring->ReadPos.load(std::memory_order_relaxed);
+		uint64_t writePos = ring->WritePos.load(std::memory_order_acquire);
 
-	std::string fullMessage = SeverityToString(severity) + message + "\n";
+		while (readPos < writePos)
+		{
+			uint64_t offset = readPos & LOGGER_RING_MASK;
 
-	printf(fullMessage.c_str());
+			// Too little room for a header before the end of the ring, the producer skipped it
+			if (LOGGER_RING_BYTE_SIZE - offset < sizeof(LogMessageHeader))
+			{
+				readPos += LOGGER_RING_BYTE_SIZE - offset;
+				continue;
+			}
+
+			LogMessageHeader header;
+			std::memcpy(&header, &ring->Data[offset], sizeof(header));
+
+			if (header.Decode)
+				WriteMessage(header, &ring->Data[offset + sizeof(header)]);
+
+			// Released per message, so a producer waiting for room can continue as early as possible
+			readPos += header.ByteSize;
+			ring->ReadPos.store(readPos, std::memory_order_release);
+		}
+	}
 }
 
-const char* Logger::SeverityToString(Severity severity)
+static void FlushSinks()
 {
-	switch (severity)
+	if (s_Data.IsConsoleOutputEnabled)
+		s_Data.ConsoleSink->Flush();
+	for (auto& sink : s_Data.Sinks)
+		sink->Flush();
+}
+
+static void LoggerThread()
+{
+	std::unique_lock<std::mutex> wakeLock(s_Data.WakeMutex);
+
+	while (s_Data.IsRunning.load(std::memory_order_relaxed))
 	{
-	case Severity::INFO:
-		return "[INFO] ";
-	case Severity::WARN:
-		return "[WARN] ";
-	case Severity::ERR:
-		return "[ERR] ";
-	default:
-		return "[INFO] ";
+		s_Data.WakeCondition.wait_for(wakeLock, LOGGER_DRAIN_INTERVAL);
+		wakeLock.unlock();
+
+		{
+			std::scoped_lock drainLock(s_Data.DrainMutex);
+			DrainRings();
+			FlushSinks();
+		}
+
+		wakeLock.lock();
 	}
 }
 
-inline void Logger::SetSeverityConsoleColor(Severity severity)
+static void StopLoggerThread()
 {
-	HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+	{
+		std::scoped_lock lock(s_Data.WakeMutex);
+		s_Data.IsRunning = false;
+	}
+
+	s_Data.WakeCondition.notify_one();
+	if (s_Data.Thread.joinable())
+		s_Data.Thread.join();
+
+	std::scoped_lock drainLock(s_Data.DrainMutex);
+	DrainRings();
+	FlushSinks();
+}
 
+// Not async signal safe, but the process is going down anyway, and losing the last messages before a crash is worse
+static void OnCrash(int signal)
+{
+	uint32_t attempt = 0;
+	while (!s_Data.DrainMutex.try_lock() && ++attempt < LOGGER_CRASH_LOCK_ATTEMPTS)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	// The crash may have happened while this thread held the lock, the messages are drained without it then
+	DrainRings();
+	FlushSinks();
+
+	std::signal(signal, SIG_DFL);
+	std::raise(signal);
+}
+
+static LoggerThreadRing* RegisterThread()
+{
+	static std::once_flag started;
+	std::call_once(started, []() {
+		s_Data.IsRunning = true;
+		s_Data.Thread = std::thread(LoggerThread);
+
+		std::signal(SIGSEGV, OnCrash);
+		std::signal(SIGABRT, OnCrash);
+		std::signal(SIGFPE, OnCrash);
+		std::signal(SIGILL, OnCrash);
+	});
+
+	std::scoped_lock lock(s_Data.RingsMutex);
+	t_Ring = s_Data.Rings.emplace_back(std::make_unique<LoggerThreadRing>()).get();
+	return t_Ring;
+}
+
+uint8_t* Logger::BeginMessage(Severity severity, const char* format, DecodeFunction decode, uint32_t byteSize)
+{
+	LoggerThreadRing* ring = t_Ring ? t_Ring : RegisterThread();
+
+	LogMessageHeader header = { decode, format, 0, severity };
+	uint64_t messageByteSize = (sizeof(LogMessageHeader) + byteSize + LOGGER_MESSAGE_ALIGNMENT - 1) & ~(LOGGER_MESSAGE_ALIGNMENT - 1);
+	header.ByteSize = static_cast<uint32_t>(messageByteSize);
+
+	if (messageByteSize > LOGGER_MAX_RING_MESSAGE_BYTE_SIZE)
+	{
+		ring->OversizedMessage.resize(messageByteSize);
+		std::memcpy(ring->OversizedMessage.data(), &header, sizeof(header));
+		return ring->OversizedMessage.data() + sizeof(header);
+	}
+
+	uint64_t writePos = ring->WritePos.load(std::memory_order_relaxed);
+	uint64_t offset = writePos & LOGGER_RING_MASK;
+	uint64_t paddingByteSize = offset + messageByteSize > LOGGER_RING_BYTE_SIZE ? LOGGER_RING_BYTE_SIZE - offset : 0;
+	uint64_t endPos = writePos + paddingByteSize + messageByteSize;
+
+	if (endPos - ring->CachedReadPos > LOGGER_RING_BYTE_SIZE)
+	{
+		ring->CachedReadPos = ring->ReadPos.load(std::memory_order_acquire);
+		if (endPos - ring->CachedReadPos > LOGGER_RING_BYTE_SIZE)
+		{
+			ring->NumBlockedMessages.store(ring->NumBlockedMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			// Drained by this thread, waiting for the logger thread would take at least until its next drain
+			while (endPos - ring->CachedReadPos > LOGGER_RING_BYTE_SIZE)
+			{
+				{
+					std::scoped_lock lock(s_Data.DrainMutex);
+					DrainRings();
+				}
+				ring->CachedReadPos = ring->ReadPos.load(std::memory_order_acquire);
+			}
+		}
+	}
+
+	// Padding only gets a header when there is room for one, the consumer skips smaller gaps on its own
+	if (paddingByteSize >= sizeof(LogMessageHeader))
+	{
+		LogMessageHeader padding = { nullptr, nullptr, static_cast<uint32_t>(paddingByteSize), severity };
+		std::memcpy(&ring->Data[offset], &padding, sizeof(padding));
+	}
+
+	offset = (writePos + paddingByteSize) & LOGGER_RING_MASK;
+	std::memcpy(&ring->Data[offset], &header, sizeof(header));
+	ring->MessageEndPos = endPos;
+
+	return &ring->Data[offset + sizeof(header)];
+}
+
+void Logger::EndMessage(Severity severity)
+{
+	LoggerThreadRing* ring = t_Ring;
+	ring->NumMessages.store(ring->NumMessages.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	if (!ring->OversizedMessage.empty())
+	{
+		// Everything this thread logged before goes first, so its messages keep their order
+		std::scoped_lock lock(s_Data.DrainMutex);
+		DrainRings();
+
+		LogMessageHeader header;
+		std::memcpy(&header, ring->OversizedMessage.data(), sizeof(header));
+		WriteMessage(header, ring->OversizedMessage.data() + sizeof(header));
+		FlushSinks();
+
+		ring->OversizedMessage.clear();
+		ring->OversizedMessage.shrink_to_fit();
+		return;
+	}
+
+	ring->WritePos.store(ring->MessageEndPos, std::memory_order_release);
+
+	if (severity == Severity::ERR || !s_Data.IsRunning.load(std::memory_order_relaxed))
+		Flush();
+}
+
+void Logger::Format(const char* format, const std::string* arguments, std::size_t numArguments, std::string& outMessage)
+{
+	std::size_t argument = 0;
+
+	for (const char* c = format; *c != '\0'; ++c)
+	{
+		// Placeholders without an argument are kept, so a message with braces of its own is printed as it is
+		if (c[0] == '{' && c[1] == '}' && argument < numArguments)
+		{
+			outMessage += arguments[argument++];
+			++c;
+		}
+		else
+		{
+			outMessage += *c;
+		}
+	}
+}
+
+bool Logger::AddFileSink(const std::string& filepath, std::size_t maxByteSize, uint32_t numBackups)
+{
+	std::error_code error;
+	std::filesystem::path parentPath = std::filesystem::path(filepath).parent_path();
+	if (!parentPath.empty())
+		std::filesystem::create_directories(parentPath, error);
+
+	auto sink = std::make_shared<FileLogSink>(filepath, maxByteSize, numBackups);
+	if (!sink->IsValid())
+	{
+		LOG_ERR("[Logger] Could not open log file {}", filepath);
+		return false;
+	}
+
+	AddSink(sink);
+	return true;
+}
+
+void Logger::AddSink(std::shared_ptr<LogSink> sink)
+{
+	std::scoped_lock lock(s_Data.DrainMutex);
+	s_Data.Sinks.push_back(std::move(sink));
+}
+
+void Logger::RemoveSink(const std::shared_ptr<LogSink>& sink)
+{
+	// Messages that are still in the rings go to the sink before it is removed
+	std::scoped_lock lock(s_Data.DrainMutex);
+	DrainRings();
+	sink->Flush();
+
+	s_Data.Sinks.erase(std::remove(s_Data.Sinks.begin(), s_Data.Sinks.end(), sink), s_Data.Sinks.end());
+}
+
+void Logger::SetConsoleOutput(bool enabled)
+{
+	std::scoped_lock lock(s_Data.DrainMutex);
+	DrainRings();
+	s_Data.IsConsoleOutputEnabled = enabled;
+}
+
+void Logger::Flush()
+{
+	std::scoped_lock lock(s_Data.DrainMutex);
+	DrainRings();
+	FlushSinks();
+}
+
+void Logger::Finalize()
+{
+	StopLoggerThread();
+}
+
+LoggerStatistics Logger::GetStatistics()
+{
+	LoggerStatistics stats;
+
+	std::scoped_lock lock(s_Data.RingsMutex);
+	for (auto& ring : s_Data.Rings)
+	{
+		stats.NumMessages += ring->NumMessages.load(std::memory_order_relaxed);
+		stats.NumBlockedMessages += ring->NumBlockedMessages.load(std::memory_order_relaxed);
+	}
+
+	stats.NumWrittenBytes = s_Data.NumWrittenBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+const char* Logger::SeverityToString(Severity severity)
+{
 	switch (severity)
 	{
 	case Severity::INFO:
-		SetConsoleTextAttribute(hConsole, 7);
-		break;
+		return "[INFO] ";
 	case Severity::WARN:
-		SetConsoleTextAttribute(hConsole, 6);
-		break;
+		return "[WARN] ";
 	case Severity::ERR:
-		SetConsoleTextAttribute(hConsole, 12);
-		break;
+		return "[ERR] ";
+	default:
+		return "[INFO] ";
 	}
 }
@@ -0,0 +1,93 @@
+#include "Pch.h"
+#include "Util/MappedFile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& filepath)
+{
+	m_FileHandle = ::CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_FileHandle == INVALID_HANDLE_VALUE)
+	{
+		LOG_ERR("Could not open file: {}", filepath);
+		return;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!::GetFileSizeEx(m_FileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		// Empty files cannot be mapped
+		LOG_WARN("File is empty or its size could not be queried: {}", filepath);
+		return;
+	}
+
+	m_MappingHandle = ::CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_MappingHandle)
+	{
+		LOG_ERR("Could not create file mapping: {}", filepath);
+		return;
+	}
+
+	m_Data = static_cast<const uint8_t*>(::MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	ASSERT(m_Data, "Could not map view of file: " + filepath);
+
+	m_ByteSize = static_cast<std::size_t>(fileSize.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_Data)
+		::UnmapViewOfFile(m_Data);
+	if (m_MappingHandle)
+		::CloseHandle(m_MappingHandle);
+	if (m_FileHandle != INVALID_HANDLE_VALUE)
+		::CloseHandle(m_FileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath)
+{
+	m_FileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+	if (m_FileDescriptor < 0)
+	{
+		LOG_ERR("Could not open file: {}", filepath);
+		return;
+	}
+
+	struct stat fileStat = {};
+	if (::fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		// Empty files cannot be mapped
+		LOG_WARN("File is empty or its size could not be queried: {}", filepath);
+		return;
+	}
+
+	void* data = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+	if (data == MAP_FAILED)
+	{
+		LOG_ERR("Could not map file: {}", filepath);
+		return;
+	}
+
+	::madvise(data, static_cast<std::size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+	m_Data = static_cast<const uint8_t*>(data);
+	m_ByteSize = static_cast<std::size_t>(fileStat.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+	if (m_Data)
+		::munmap(const_cast<uint8_t*>(m_Data), m_ByteSize);
+	if (m_FileDescriptor >= 0)
+		::close(m_FileDescriptor);
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include "Pch.h"
+#include "Util/MemoryTracker.h"
+
+// Leaked resources logged one by one before the rest are only counted
+static constexpr uint32_t MEMORY_TRACKER_MAX_LOGGED_LEAKS = 32;
+
+// Every tag on its own cache line, so threads counting different tags do not share one
+struct alignas(64) MemoryTagCounters
+{
+	std::atomic<uint64_t> ByteSize = 0;
+	std::atomic<uint64_t> PeakByteSize = 0;
+	std::atomic<uint64_t> NumAllocations = 0;
+	std::atomic<uint64_t> NumTotalAllocations = 0;
+};
+
+struct GPUMemoryResourceSlot
+{
+	GPUMemoryResource Resource;
+	bool IsAlive = false;
+};
+
+struct InternalMemoryTrackerData
+{
+	// Guards the resources, the GPU category totals and the frame snapshots
+	std::mutex Mutex;
+	std::vector<GPUMemoryResourceSlot> Resources;
+	std::vector<uint32_t> FreeResourceSlots;
+	GPUMemoryCategoryStatistics GPUCategories[NUM_GPU_MEMORY_CATEGORIES];
+	uint64_t Frame = 0;
+
+	// Sizes at the end of the last frame, and the deltas of the frame before it
+	uint64_t LastTagByteSizes[NUM_MEMORY_TAGS] = {};
+	uint64_t LastGPUCategoryByteSizes[NUM_GPU_MEMORY_CATEGORIES] = {};
+	int64_t TagFrameDeltas[NUM_MEMORY_TAGS] = {};
+	int64_t GPUCategoryFrameDeltas[NUM_GPU_MEMORY_CATEGORIES] = {};
+};
+
+// Constant initialized, so containers that allocate during static initialization are counted as well
+static MemoryTagCounters s_TagCounters[NUM_MEMORY_TAGS];
+static InternalMemoryTrackerData s_Data;
+
+void MemoryTracker::TrackAllocation(MemoryTag tag, std::size_t byteSize)
+{
+	MemoryTagCounters& counters = s_TagCounters[tag];
+	uint64_t newByteSize = counters.ByteSize.fetch_add(byteSize, std::memory_order_relaxed) + byteSize;
+	counters.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	counters.NumTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	// The peak is only written when it grows, which becomes rare once a tag reached its working set
+	uint64_t peakByteSize = counters.PeakByteSize.load(std::memory_order_relaxed);
+	while (newByteSize > peakByteSize && !counters.PeakByteSize.compare_exchange_weak(peakByteSize, newByteSize, std::memory_order_relaxed))
+	{
+	}
+}
+
+void MemoryTracker::TrackFree(MemoryTag tag, std::size_t byteSize)
+{
+	MemoryTagCounters& counters = s_TagCounters[tag];
+	counters.ByteSize.fetch_sub(byteSize, std::memory_order_relaxed);
+	counters.NumAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+uint32_t MemoryTracker::AddGPUResource(const std::string& name, GPUMemoryCategory category, uint64_t byteSize)
+{
+	std::scoped_lock lock(s_Data.Mutex);
+
+	uint32_t resourceID = static_cast<uint32_t>(s_Data.Resources.size());
+	if (!s_Data.FreeResourceSlots.empty())
+	{
+		resourceID = s_Data.FreeResourceSlots.back();
+		s_Data.FreeResourceSlots.pop_back();
+	}
+	else
+	{
+		s_Data.Resources.emplace_back();
+	}
+
+	GPUMemoryResourceSlot& slot = s_Data.Resources[resourceID];
+	slot.Resource = { name, category, byteSize, s_Data.Frame };
+	slot.IsAlive = true;
+
+	GPUMemoryCategoryStatistics& categoryStats = s_Data.GPUCategories[category];
+	categoryStats.ByteSize += byteSize;
+	categoryStats.PeakByteSize = std::max(categoryStats.PeakByteSize, categoryStats.ByteSize);
+	categoryStats.NumResources++;
+
+	return resourceID;
+}
+
+void MemoryTracker::RemoveGPUResource(uint32_t resourceID)
+{
+	if (resourceID == MEMORY_TRACKER_INVALID_ID)
+		return;
+
+	std::scoped_lock lock(s_Data.Mutex);
+
+	ASSERT(resourceID < s_Data.Resources.size() && s_Data.Resources[resourceID].IsAlive, "Removed a GPU resource that is not tracked");
+	if (resourceID >= s_Data.Resources.size() || !s_Data.Resources[resourceID].IsAlive)
+		return;
+
+	GPUMemoryResourceSlot& slot = s_Data.Resources[resourceID];
+	GPUMemoryCategoryStatistics& categoryStats = s_Data.GPUCategories[slot.Resource.Category];
+	categoryStats.ByteSize -= slot.Resource.ByteSize;
+	categoryStats.NumResources--;
+
+	slot.Resource.Name.clear();
+	slot.IsAlive = false;
+	s_Data.FreeResourceSlots.push_back(resourceID);
+}
+
+void MemoryTracker::EndFrame()
+{
+	std::scoped_lock lock(s_Data.Mutex);
+
+	for (uint32_t tag = 0; tag < NUM_MEMORY_TAGS; ++tag)
+	{
+		uint64_t byteSize = s_TagCounters[tag].ByteSize.load(std::memory_order_relaxed);
+		s_Data.TagFrameDeltas[tag] = static_cast<int64_t>(byteSize) - static_cast<int64_t>(s_Data.LastTagByteSizes[tag]);
+		s_Data.LastTagByteSizes[tag] = byteSize;
+	}
+
+	for (uint32_t category = 0; category < NUM_GPU_MEMORY_CATEGORIES; ++category)
+	{
+		uint64_t byteSize = s_Data.GPUCategories[category].ByteSize;
+		s_Data.GPUCategoryFrameDeltas[category] = static_cast<int64_t>(byteSize) - static_cast<int64_t>(s_Data.LastGPUCategoryByteSizes[category]);
+		s_Data.LastGPUCategoryByteSizes[category] = byteSize;
+	}
+
+	s_Data.Frame++;
+}
+
+MemoryStatistics MemoryTracker::GetStatistics()
+{
+	MemoryStatistics stats;
+
+	std::scoped_lock lock(s_Data.Mutex);
+
+	for (uint32_t tag = 0; tag < NUM_MEMORY_TAGS; ++tag)
+	{
+		const MemoryTagCounters& counters = s_TagCounters[tag];
+		MemoryTagStatistics& tagStats = stats.Tags[tag];
+		tagStats.ByteSize = counters.ByteSize.load(std::memory_order_relaxed);
+		tagStats.PeakByteSize = counters.PeakByteSize.load(std::memory_order_relaxed);
+		tagStats.NumAllocations = counters.NumAllocations.load(std::memory_order_relaxed);
+		tagStats.NumTotalAllocations = counters.NumTotalAllocations.load(std::memory_order_relaxed);
+		tagStats.FrameDelta = s_Data.TagFrameDeltas[tag];
+
+		stats.CPUByteSize += tagStats.ByteSize;
+		stats.CPUFrameDelta += tagStats.FrameDelta;
+	}
+
+	for (uint32_t category = 0; category < NUM_GPU_MEMORY_CATEGORIES; ++category)
+	{
+		stats.GPUCategories[category] = s_Data.GPUCategories[category];
+		stats.GPUCategories[category].FrameDelta = s_Data.GPUCategoryFrameDeltas[category];
+
+		stats.GPUByteSize += stats.GPUCategories[category].ByteSize;
+		stats.GPUFrameDelta += stats.GPUCategories[category].FrameDelta;
+	}
+
+	return stats;
+}
+
+void MemoryTracker::GetLargestGPUResources(uint32_t numResources, std::vector<GPUMemoryResource>& outResources)
+{
+	outResources.clear();
+
+	{
+		std::scoped_lock lock(s_Data.Mutex);
+		for (const GPUMemoryResourceSlot& slot : s_Data.Resources)
+		{
+			if (slot.IsAlive)
+				outResources.push_back(slot.Resource);
+		}
+	}
+
+	auto isLarger = [](const GPUMemoryResource& lhs, const GPUMemoryResource& rhs) { return lhs.ByteSize > rhs.ByteSize; };
+	std::size_t numSorted = std::min<std::size_t>(numResources, outResources.size());
+
+	std::partial_sort(outResources.begin(), outResources.begin() + numSorted, outResources.end(), isLarger);
+	outResources.resize(numSorted);
+}
+
+uint32_t MemoryTracker::ReportLeaks()
+{
+	std::vector<GPUMemoryResource> leakedResources;
+	GetLargestGPUResources(std::numeric_limits<uint32_t>::max(), leakedResources);
+
+	for (uint32_t i = 0; i < std::min<std::size_t>(leakedResources.size(), MEMORY_TRACKER_MAX_LOGGED_LEAKS); ++i)
+	{
+		const GPUMemoryResource& resource = leakedResources[i];
+		LOG_WARN("[MemoryTracker] Leaked GPU resource {} ({}, {} bytes, created in frame {})", resource.Name, GetGPUCategoryName(resource.Category),
+			resource.ByteSize, resource.Frame);
+	}
+
+	if (leakedResources.size() > MEMORY_TRACKER_MAX_LOGGED_LEAKS)
+		LOG_WARN("[MemoryTracker] {} more GPU resources leaked", leakedResources.size() - MEMORY_TRACKER_MAX_LOGGED_LEAKS);
+
+	// Tagged containers with static storage are only freed after this, so CPU memory that is still alive is not necessarily a leak
+	for (uint32_t tag = 0; tag < NUM_MEMORY_TAGS; ++tag)
+	{
+		uint64_t numAllocations = s_TagCounters[tag].NumAllocations.load(std::memory_order_relaxed);
+		if (numAllocations > 0)
+		{
+			LOG_INFO("[MemoryTracker] {} allocations with {} bytes still alive in {}", numAllocations, s_TagCounters[tag].ByteSize.load(std::memory_order_relaxed),
+				GetTagName(static_cast<MemoryTag>(tag)));
+		}
+	}
+
+	if (leakedResources.empty())
+		LOG_INFO("[MemoryTracker] No GPU resources leaked");
+
+	return static_cast<uint32_t>(leakedResources.size());
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MEMORY_TAG_SCENE:
+		return "Scene";
+	case MEMORY_TAG_ASSETS:
+		return "Assets";
+	case MEMORY_TAG_RENDER:
+		return "Render";
+	case MEMORY_TAG_STRINGS:
+		return "Strings";
+	default:
+		return "Unknown";
+	}
+}
+
+const char* MemoryTracker::GetGPUCategoryName(GPUMemoryCategory category)
+{
+	switch (category)
+	{
+	case GPU_MEMORY_CATEGORY_MESH_BUFFERS:
+		return "Mesh buffers";
+	case GPU_MEMORY_CATEGORY_MATERIAL_TEXTURES:
+		return "Material textures";
+	case GPU_MEMORY_CATEGORY_SHADOW_MAPS:
+		return "Shadow maps";
+	case GPU_MEMORY_CATEGORY_RENDER_TARGETS:
+		return "Render targets";
+	case GPU_MEMORY_CATEGORY_UPLOAD:
+		return "Upload";
+	case GPU_MEMORY_CATEGORY_DESCRIPTOR_HEAPS:
+		return "Descriptor heaps";
+	case GPU_MEMORY_CATEGORY_OTHER:
+		return "Other";
+	default:
+		return "Unknown";
+	}
+}
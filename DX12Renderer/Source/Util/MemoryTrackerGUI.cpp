@@ -0,0 +1,100 @@
+#include "Pch.h"
+#include "Util/MemoryTracker.h"
+
+#include <imgui/imgui.h>
+
+static constexpr uint32_t MEMORY_TRACKER_GUI_NUM_LARGEST_RESOURCES = 10;
+
+static float ToMegabytes(uint64_t byteSize)
+{
+	return static_cast<float>(TO_MEGABYTE(static_cast<double>(byteSize)));
+}
+
+static float ToMegabytes(int64_t byteSize)
+{
+	return static_cast<float>(TO_MEGABYTE(static_cast<double>(byteSize)));
+}
+
+void MemoryTracker::OnImGuiRender()
+{
+	MemoryStatistics stats = GetStatistics();
+
+	ImGui::Text("CPU: %.3f MB tracked, %+.3f MB last frame", ToMegabytes(stats.CPUByteSize), ToMegabytes(stats.CPUFrameDelta));
+	ImGui::Text("GPU: %.3f MB tracked, %+.3f MB last frame", ToMegabytes(stats.GPUByteSize), ToMegabytes(stats.GPUFrameDelta));
+
+	ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders;
+	if (ImGui::BeginTable("CPU memory", 5, tableFlags))
+	{
+		ImGui::TableSetupColumn("Tag");
+		ImGui::TableSetupColumn("MB");
+		ImGui::TableSetupColumn("Peak MB");
+		ImGui::TableSetupColumn("Allocations");
+		ImGui::TableSetupColumn("Delta MB");
+		ImGui::TableHeadersRow();
+
+		for (uint32_t tag = 0; tag < NUM_MEMORY_TAGS; ++tag)
+		{
+			const MemoryTagStatistics& tagStats = stats.Tags[tag];
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(GetTagName(static_cast<MemoryTag>(tag)));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", ToMegabytes(tagStats.ByteSize));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", ToMegabytes(tagStats.PeakByteSize));
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(tagStats.NumAllocations));
+			ImGui::TableNextColumn();
+			ImGui::Text("%+.3f", ToMegabytes(tagStats.FrameDelta));
+		}
+
+		ImGui::EndTable();
+	}
+
+	if (ImGui::BeginTable("GPU memory", 5, tableFlags))
+	{
+		ImGui::TableSetupColumn("Category");
+		ImGui::TableSetupColumn("MB");
+		ImGui::TableSetupColumn("Peak MB");
+		ImGui::TableSetupColumn("Resources");
+		ImGui::TableSetupColumn("Delta MB");
+		ImGui::TableHeadersRow();
+
+		for (uint32_t category = 0; category < NUM_GPU_MEMORY_CATEGORIES; ++category)
+		{
+			const GPUMemoryCategoryStatistics& categoryStats = stats.GPUCategories[category];
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(GetGPUCategoryName(static_cast<GPUMemoryCategory>(category)));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", ToMegabytes(categoryStats.ByteSize));
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", ToMegabytes(categoryStats.PeakByteSize));
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", categoryStats.NumResources);
+			ImGui::TableNextColumn();
+			ImGui::Text("%+.3f", ToMegabytes(categoryStats.FrameDelta));
+		}
+
+		ImGui::EndTable();
+	}
+
+	if (ImGui::TreeNode("Largest GPU resources"))
+	{
+		std::vector<GPUMemoryResource> largestResources;
+		GetLargestGPUResources(MEMORY_TRACKER_GUI_NUM_LARGEST_RESOURCES, largestResources);
+
+		for (const GPUMemoryResource& resource : largestResources)
+		{
+			ImGui::Text("%.3f MB: %s (%s, frame %llu)", ToMegabytes(resource.ByteSize), resource.Name.c_str(), GetGPUCategoryName(resource.Category),
+				static_cast<unsigned long long>(resource.Frame));
+		}
+
+		ImGui::TreePop();
+	}
+
+	if (ImGui::Button("Report leaks"))
+		ReportLeaks();
+}
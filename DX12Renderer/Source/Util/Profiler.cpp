@@ -1,119 +1,669 @@
 #include "Pch.h"
 #include "Util/Profiler.h"
 
-#include <imgui/imgui.h>
+#include <filesystem>
+#include <fstream>
 
-TimerResult m_FrameTime;
-std::array<std::array<TimerResult, 50>, 2> m_Timers;
-uint32_t m_TimerCounts[2] = { 0, 0 };
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_USE_TSC 1
+#else
+#define PROFILER_USE_TSC 0
+#endif
 
-enum TimerType : uint32_t
+// Events per thread, a ring holds about a megabyte
+static constexpr uint64_t PROFILER_RING_SIZE = 1 << 16;
+static constexpr uint64_t PROFILER_RING_MASK = PROFILER_RING_SIZE - 1;
+// Frames the frame and zone statistics are kept for by default
+static constexpr uint32_t PROFILER_STATISTICS_WINDOW = 1024;
+static constexpr float PROFILER_DEFAULT_STUTTER_FACTOR = 2.0f;
+
+// Marks the end of a frame in the ring of the main thread, it is never begun or ended like a zone
+static constexpr ProfilerZone s_FrameMarkerZone = { "Frame", __FILE__, __LINE__ };
+
+struct ProfilerEvent
+{
+	uint64_t Timestamp = 0;
+	// Nullptr for the end of the innermost open zone
+	const ProfilerZone* Zone = nullptr;
+};
+
+// Single producer (the owning thread), single consumer (the thread calling EndFrame) ring of events
+struct ProfilerThreadRing
+{
+	std::unique_ptr<ProfilerEvent[]> Events = std::make_unique<ProfilerEvent[]>(PROFILER_RING_SIZE);
+	std::atomic<uint64_t> WritePos = 0;
+	std::atomic<uint64_t> ReadPos = 0;
+	std::atomic<uint64_t> NumDroppedZones = 0;
+
+	// Only touched by the owning thread, the read position it saw last and the zones it still has to end
+	uint64_t CachedReadPos = 0;
+	uint64_t NumOpenZones = 0;
+
+	// Only touched by the consumer, the zones still open at the end of the last drain
+	struct OpenZone
+	{
+		const ProfilerZone* Zone;
+		uint64_t BeginTimestamp;
+		uint32_t Node;
+	};
+	std::vector<OpenZone> OpenZones;
+
+	std::mutex NameMutex;
+	std::string Name;
+};
+
+struct ProfilerTraceZone
+{
+	const ProfilerZone* Zone;
+	uint32_t Thread;
+	uint64_t BeginTimestamp;
+	uint64_t EndTimestamp;
+};
+
+// Nodes of the call tree of a thread while it is built, children are linked so the tree can be flattened depth first
+struct ProfilerTreeNode
 {
-	CPU = 0,
-	GPU,
+	ProfilerZoneNode Node;
+	uint32_t FirstChild = std::numeric_limits<uint32_t>::max();
+	uint32_t LastChild = std::numeric_limits<uint32_t>::max();
+	uint32_t NextSibling = std::numeric_limits<uint32_t>::max();
 };
 
-void Profiler::AddFrameTime(const TimerResult& result)
+struct InternalProfilerData
+{
+	// Rings are never released, so events of threads that already exited can still be drained
+	std::mutex RingsMutex;
+	std::vector<std::unique_ptr<ProfilerThreadRing>> Rings;
+
+	// Timestamp and steady_clock time at startup, the tick period is measured between them and the last frame
+	uint64_t StartTimestamp = 0;
+	std::chrono::steady_clock::time_point StartTime;
+	double NanosecondsPerTick = 1.0;
+
+	uint64_t LastFrameTimestamp = 0;
+	float FrameTime = 0.0f;
+	uint64_t NumZones = 0;
+
+	std::vector<ProfilerThreadFrame> ThreadFrames;
+	std::vector<std::vector<ProfilerTreeNode>> ThreadTrees;
+
+	std::vector<ProfilerGPUZone> PendingGPUZones;
+	std::vector<ProfilerGPUZone> GPUZones;
+
+	uint32_t StatisticsWindow = PROFILER_STATISTICS_WINDOW;
+	float StutterFactor = PROFILER_DEFAULT_STUTTER_FACTOR;
+	RollingFrameStatistics FrameStatistics = RollingFrameStatistics(PROFILER_STATISTICS_WINDOW, PROFILER_DEFAULT_STUTTER_FACTOR);
+	// Zones are identified by their descriptor on the CPU and by their interned name on the GPU
+	std::unordered_map<const void*, uint32_t> ZoneStatisticsIndices;
+	std::vector<ProfilerZoneStatistics> ZoneStatistics;
+	// Time of every zone in the current frame, and the zones that ran in it
+	std::vector<float> ZoneFrameDurations;
+	std::vector<uint32_t> FrameZones;
+
+	std::string TraceFilepath;
+	uint32_t NumTraceFramesLeft = 0;
+	std::vector<ProfilerTraceZone> TraceZones;
+	// Timestamps of the frame markers and the thread that recorded them
+	std::vector<std::pair<uint64_t, uint32_t>> TraceFrameMarkers;
+	std::vector<ProfilerGPUZone> TraceGPUZones;
+};
+
+static InternalProfilerData s_Data;
+static thread_local ProfilerThreadRing* t_Ring = nullptr;
+
+static uint64_t GetTimestamp()
+{
+#if PROFILER_USE_TSC
+	return __rdtsc();
+#else
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+static void InitializeClock()
 {
-	m_FrameTime = result;
+	static std::once_flag initialized;
+	std::call_once(initialized, []() {
+		s_Data.StartTime = std::chrono::steady_clock::now();
+		s_Data.StartTimestamp = GetTimestamp();
+		s_Data.LastFrameTimestamp = s_Data.StartTimestamp;
+	});
 }
 
-void Profiler::AddCPUTimer(const TimerResult& result)
+// The TSC runs at a constant rate on every CPU the renderer supports, its period is refined the longer the application runs
+static void UpdateTickPeriod()
 {
-	m_Timers[CPU][m_TimerCounts[CPU]] = result;
-	m_TimerCounts[CPU]++;
+#if PROFILER_USE_TSC
+	uint64_t ticks = GetTimestamp() - s_Data.StartTimestamp;
+	double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Data.StartTime).count());
 
-	ASSERT(m_TimerCounts[CPU] <= 50, "CPU timers exceeded the maximum allowed amount of 50 timer entries");
+	if (ticks > 0 && nanoseconds > 0.0)
+		s_Data.NanosecondsPerTick = nanoseconds / static_cast<double>(ticks);
+#endif
 }
 
-void Profiler::AddGPUTimer(const TimerResult& result)
+static float TicksToMilliseconds(uint64_t ticks)
 {
-	m_Timers[GPU][m_TimerCounts[GPU]] = result;
-	m_TimerCounts[GPU]++;
+	return static_cast<float>(static_cast<double>(ticks) * s_Data.NanosecondsPerTick / 1000000.0);
+}
+
+static ProfilerThreadRing* RegisterThread()
+{
+	InitializeClock();
+
+	std::scoped_lock lock(s_Data.RingsMutex);
+	ProfilerThreadRing* ring = s_Data.Rings.emplace_back(std::make_unique<ProfilerThreadRing>()).get();
+	ring->Name = "Thread " + std::to_string(s_Data.Rings.size() - 1);
 
-	ASSERT(m_TimerCounts[GPU] <= 50, "GPU timers exceeded the maximum allowed amount of 50 timer entries");
+	return ring;
 }
 
-void Profiler::OnImGuiRender()
+static ProfilerThreadRing& GetThreadRing()
 {
-	ImGui::Begin("Profiler");
-	ImGui::Text("Frametime: %.3f ms", m_FrameTime.Duration);
-	ImGui::Text("FPS: %u", static_cast<uint32_t>(1000.0f / (m_FrameTime.Duration)));
+	if (!t_Ring)
+		t_Ring = RegisterThread();
 
-	std::sort(m_Timers[CPU].begin(), m_Timers[CPU].begin() + m_TimerCounts[CPU], [](TimerResult& lhs, TimerResult& rhs) {
-		return lhs.Duration > rhs.Duration;
-	});
+	return *t_Ring;
+}
+
+// Begins only go in when the ring has room for them and the end events of all open zones, so ends never fail
+static bool HasRoomForBegin(ProfilerThreadRing& ring, uint64_t writePos)
+{
+	uint64_t numRequired = ring.NumOpenZones + 2;
+	if (writePos - ring.CachedReadPos + numRequired <= PROFILER_RING_SIZE)
+		return true;
+
+	ring.CachedReadPos = ring.ReadPos.load(std::memory_order_acquire);
+	return writePos - ring.CachedReadPos + numRequired <= PROFILER_RING_SIZE;
+}
+
+static void PushEvent(ProfilerThreadRing& ring, uint64_t writePos, const ProfilerZone* zone)
+{
+	ring.Events[writePos & PROFILER_RING_MASK] = { GetTimestamp(), zone };
+	ring.WritePos.store(writePos + 1, std::memory_order_release);
+}
+
+static uint32_t AddTreeNode(std::vector<ProfilerTreeNode>& tree, uint32_t parent, const ProfilerZone* zone)
+{
+	// Zones are merged with an earlier sibling of the same descriptor, the root node has no zone
+	uint32_t child = tree[parent].FirstChild;
+	while (child != std::numeric_limits<uint32_t>::max())
+	{
+		if (tree[child].Node.Zone == zone)
+			return child;
+
+		child = tree[child].NextSibling;
+	}
+
+	uint32_t node = static_cast<uint32_t>(tree.size());
+	ProfilerTreeNode& treeNode = tree.emplace_back();
+	treeNode.Node.Zone = zone;
+	treeNode.Node.Depth = tree[parent].Node.Depth + 1;
+
+	if (tree[parent].FirstChild == std::numeric_limits<uint32_t>::max())
+		tree[parent].FirstChild = node;
+	else
+		tree[tree[parent].LastChild].NextSibling = node;
+
+	tree[parent].LastChild = node;
+	return node;
+}
 
-	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
-	if (ImGui::CollapsingHeader("CPU Timers"))
+static void FlattenTree(const std::vector<ProfilerTreeNode>& tree, uint32_t node, std::vector<ProfilerZoneNode>& outNodes)
+{
+	for (uint32_t child = tree[node].FirstChild; child != std::numeric_limits<uint32_t>::max(); child = tree[child].NextSibling)
+	{
+		std::size_t numNodes = outNodes.size();
+		ProfilerZoneNode& zoneNode = outNodes.emplace_back(tree[child].Node);
+		zoneNode.Depth -= 1;
+
+		FlattenTree(tree, child, outNodes);
+
+		// Zones that are still open only show up when a zone nested in them ended this frame
+		if (tree[child].Node.NumCalls == 0 && outNodes.size() == numNodes + 1)
+			outNodes.pop_back();
+	}
+}
+
+static void DrainRing(ProfilerThreadRing& ring, uint32_t threadIndex, std::vector<ProfilerTreeNode>& tree)
+{
+	tree.clear();
+	tree.emplace_back();
+
+	// Zones that are still open from earlier frames get their nodes again, so their children are nested below them
+	uint32_t parent = 0;
+	for (ProfilerThreadRing::OpenZone& openZone : ring.OpenZones)
+	{
+		openZone.Node = AddTreeNode(tree, parent, openZone.Zone);
+		parent = openZone.Node;
+	}
+
+	uint64_t readPos = ring.ReadPos.load(std::memory_order_relaxed);
+	uint64_t writePos = ring.WritePos.load(std::memory_order_acquire);
+	bool isCapturing = s_Data.NumTraceFramesLeft > 0;
+
+	for (uint64_t pos = readPos; pos < writePos; ++pos)
 	{
-		uint32_t currentTimer = 0;
+		const ProfilerEvent& event = ring.Events[pos & PROFILER_RING_MASK];
 
-		for (auto& timerResult : m_Timers[CPU])
+		if (event.Zone == &s_FrameMarkerZone)
 		{
-			char buf[50];
-			strcpy_s(buf, timerResult.Name);
-			strcat_s(buf, ": %.3fms");
+			if (isCapturing)
+				s_Data.TraceFrameMarkers.emplace_back(event.Timestamp, threadIndex);
+		}
+		else if (event.Zone)
+		{
+			uint32_t node = AddTreeNode(tree, ring.OpenZones.empty() ? 0 : ring.OpenZones.back().Node, event.Zone);
+			ring.OpenZones.push_back({ event.Zone, event.Timestamp, node });
+		}
+		else if (!ring.OpenZones.empty())
+		{
+			ProfilerThreadRing::OpenZone openZone = ring.OpenZones.back();
+			ring.OpenZones.pop_back();
 
-			ImGui::Text(buf, timerResult.Duration);
+			float duration = TicksToMilliseconds(event.Timestamp - openZone.BeginTimestamp);
+			ProfilerZoneNode& node = tree[openZone.Node].Node;
+			node.NumCalls++;
+			node.Duration += duration;
+			node.MaxDuration = std::max(node.MaxDuration, duration);
 
-			currentTimer++;
-			if (currentTimer >= m_TimerCounts[CPU])
-				break;
+			if (isCapturing)
+				s_Data.TraceZones.push_back({ openZone.Zone, threadIndex, openZone.BeginTimestamp, event.Timestamp });
+
+			s_Data.NumZones++;
 		}
 	}
 
-	std::sort(m_Timers[GPU].begin(), m_Timers[GPU].begin() + m_TimerCounts[GPU], [](TimerResult& lhs, TimerResult& rhs) {
-		return lhs.Duration > rhs.Duration;
-	});
+	ring.ReadPos.store(writePos, std::memory_order_release);
+}
+
+static void AddZoneFrameDuration(const void* key, const char* name, bool isGPUZone, float duration)
+{
+	auto [iter, inserted] = s_Data.ZoneStatisticsIndices.try_emplace(key, static_cast<uint32_t>(s_Data.ZoneStatistics.size()));
+	if (inserted)
+	{
+		s_Data.ZoneStatistics.push_back({ name, isGPUZone, RollingFrameStatistics(s_Data.StatisticsWindow, s_Data.StutterFactor) });
+		s_Data.ZoneFrameDurations.push_back(-1.0f);
+	}
+
+	float& frameDuration = s_Data.ZoneFrameDurations[iter->second];
+	if (frameDuration < 0.0f)
+	{
+		frameDuration = 0.0f;
+		s_Data.FrameZones.push_back(iter->second);
+	}
+
+	frameDuration += duration;
+}
+
+static void UpdateStatistics()
+{
+	s_Data.FrameStatistics.AddSample(s_Data.FrameTime);
+
+	// Nodes only exist for zones that ended this frame, zones still open show up with no calls
+	for (const ProfilerThreadFrame& threadFrame : s_Data.ThreadFrames)
+	{
+		for (const ProfilerZoneNode& node : threadFrame.Nodes)
+		{
+			if (node.NumCalls > 0)
+				AddZoneFrameDuration(node.Zone, node.Zone->Name, false, node.Duration);
+		}
+	}
+
+	for (const ProfilerGPUZone& zone : s_Data.GPUZones)
+		AddZoneFrameDuration(zone.Name, zone.Name, true, zone.Duration);
+
+	for (uint32_t zone : s_Data.FrameZones)
+	{
+		s_Data.ZoneStatistics[zone].Statistics.AddSample(s_Data.ZoneFrameDurations[zone]);
+		s_Data.ZoneFrameDurations[zone] = -1.0f;
+	}
+	s_Data.FrameZones.clear();
+}
+
+static void WriteJSONString(std::ofstream& file, const char* string)
+{
+	file << '"';
+	for (const char* c = string; *c; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			file << '\\';
+		file << *c;
+	}
+	file << '"';
+}
+
+static void WriteTrace()
+{
+	UpdateTickPeriod();
+
+	std::filesystem::path traceDirectory = std::filesystem::path(s_Data.TraceFilepath).parent_path();
+	std::error_code error;
+	if (!traceDirectory.empty())
+		std::filesystem::create_directories(traceDirectory, error);
+
+	std::ofstream file(s_Data.TraceFilepath);
+	if (!file)
+	{
+		LOG_ERR("[Profiler] Could not write trace to {}", s_Data.TraceFilepath);
+		return;
+	}
+
+	// Timestamps are written in microseconds since startup, complete events ("X") carry their duration
+	auto toMicroseconds = [](uint64_t timestamp) { return static_cast<double>(timestamp - s_Data.StartTimestamp) * s_Data.NanosecondsPerTick / 1000.0; };
+	file.setf(std::ios::fixed);
+	file.precision(3);
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	{
+		std::scoped_lock lock(s_Data.RingsMutex);
+		for (std::size_t i = 0; i < s_Data.Rings.size(); ++i)
+		{
+			std::scoped_lock nameLock(s_Data.Rings[i]->NameMutex);
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":";
+			WriteJSONString(file, s_Data.Rings[i]->Name.c_str());
+			file << "}},\n";
+		}
+	}
+
+	// GPU zones are a process of their own, so the GPU track is kept apart from the CPU threads
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPU\"}},\n";
+	file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Direct queue\"}},\n";
+
+	for (const auto& [timestamp, thread] : s_Data.TraceFrameMarkers)
+		file << "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":" << thread << ",\"ts\":" << toMicroseconds(timestamp) << "},\n";
+
+	for (const ProfilerTraceZone& zone : s_Data.TraceZones)
+	{
+		file << "{\"name\":";
+		WriteJSONString(file, zone.Zone->Name);
+		file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.Thread << ",\"ts\":" << toMicroseconds(zone.BeginTimestamp) <<
+			",\"dur\":" << static_cast<double>(zone.EndTimestamp - zone.BeginTimestamp) * s_Data.NanosecondsPerTick / 1000.0 << ",\"args\":{\"file\":";
+		WriteJSONString(file, zone.Zone->File);
+		file << ",\"line\":" << zone.Zone->Line << "}},\n";
+	}
+
+	for (const ProfilerGPUZone& zone : s_Data.TraceGPUZones)
+	{
+		file << "{\"name\":";
+		WriteJSONString(file, zone.Name);
+		file << ",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":" <<
+			std::chrono::duration<double, std::micro>(zone.BeginTime - s_Data.StartTime).count() << ",\"dur\":" << zone.Duration * 1000.0 << "},\n";
+	}
+
+	// Trailing metadata event, so every event above can end with a comma
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"DX12Renderer\"}}\n]}\n";
+
+	LOG_INFO("[Profiler] Wrote {} CPU zones and {} GPU zones of {} frames to {}", s_Data.TraceZones.size(), s_Data.TraceGPUZones.size(),
+		s_Data.TraceFrameMarkers.size(), s_Data.TraceFilepath);
+
+	s_Data.TraceZones.clear();
+	s_Data.TraceFrameMarkers.clear();
+	s_Data.TraceGPUZones.clear();
+}
+
+bool Profiler::BeginZone(const ProfilerZone& zone)
+{
+	ProfilerThreadRing& ring = GetThreadRing();
+	uint64_t writePos = ring.WritePos.load(std::memory_order_relaxed);
+
+	if (!HasRoomForBegin(ring, writePos))
+	{
+		ring.NumDroppedZones.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	ring.NumOpenZones++;
+	PushEvent(ring, writePos, &zone);
+	return true;
+}
+
+void Profiler::EndZone()
+{
+	ProfilerThreadRing& ring = *t_Ring;
+	ring.NumOpenZones--;
+	PushEvent(ring, ring.WritePos.load(std::memory_order_relaxed), nullptr);
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+	ProfilerThreadRing& ring = GetThreadRing();
+
+	std::scoped_lock lock(ring.NameMutex);
+	ring.Name = name;
+}
+
+void Profiler::EndFrame()
+{
+	// The frame marker is dropped with the zones when the ring is full, the frame time does not depend on it
+	ProfilerThreadRing& ring = GetThreadRing();
+	uint64_t writePos = ring.WritePos.load(std::memory_order_relaxed);
+
+	if (HasRoomForBegin(ring, writePos))
+		PushEvent(ring, writePos, &s_FrameMarkerZone);
+
+	uint64_t frameTimestamp = GetTimestamp();
+	UpdateTickPeriod();
+
+	s_Data.FrameTime = TicksToMilliseconds(frameTimestamp - s_Data.LastFrameTimestamp);
+	s_Data.LastFrameTimestamp = frameTimestamp;
 
-	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
-	if (ImGui::CollapsingHeader("GPU Timers"))
 	{
-		uint32_t currentTimer = 0;
+		std::scoped_lock lock(s_Data.RingsMutex);
+		s_Data.ThreadFrames.resize(s_Data.Rings.size());
+		s_Data.ThreadTrees.resize(s_Data.Rings.size());
 
-		for (auto& timerResult : m_Timers[GPU])
+		for (std::size_t i = 0; i < s_Data.Rings.size(); ++i)
 		{
-			char buf[50];
-			strcpy_s(buf, timerResult.Name);
-			strcat_s(buf, ": %.3fms");
+			ProfilerThreadRing& threadRing = *s_Data.Rings[i];
+			std::vector<ProfilerTreeNode>& tree = s_Data.ThreadTrees[i];
+			DrainRing(threadRing, static_cast<uint32_t>(i), tree);
 
-			ImGui::Text(buf, timerResult.Duration);
+			ProfilerThreadFrame& threadFrame = s_Data.ThreadFrames[i];
+			threadFrame.Nodes.clear();
+			FlattenTree(tree, 0, threadFrame.Nodes);
 
-			currentTimer++;
-			if (currentTimer >= m_TimerCounts[GPU])
-				break;
+			std::scoped_lock nameLock(threadRing.NameMutex);
+			threadFrame.Name = threadRing.Name;
 		}
 	}
 
-	ImGui::End();
+	s_Data.GPUZones.swap(s_Data.PendingGPUZones);
+	s_Data.PendingGPUZones.clear();
+
+	UpdateStatistics();
+
+	if (s_Data.NumTraceFramesLeft > 0)
+		s_Data.TraceGPUZones.insert(s_Data.TraceGPUZones.end(), s_Data.GPUZones.begin(), s_Data.GPUZones.end());
+
+	if (s_Data.NumTraceFramesLeft > 0)
+	{
+		s_Data.NumTraceFramesLeft--;
+		if (s_Data.NumTraceFramesLeft == 0)
+			WriteTrace();
+	}
+}
+
+void Profiler::Finalize()
+{
+	// A capture that did not reach its frame count yet is written with the frames it has
+	if (s_Data.NumTraceFramesLeft > 0)
+	{
+		s_Data.NumTraceFramesLeft = 0;
+		WriteTrace();
+	}
+
+	// Zone names are tracked strings, the statistics are released so they are not reported as leaks
+	decltype(s_Data.ZoneStatistics)().swap(s_Data.ZoneStatistics);
+	decltype(s_Data.ZoneFrameDurations)().swap(s_Data.ZoneFrameDurations);
+	s_Data.ZoneStatisticsIndices.clear();
+	s_Data.FrameZones.clear();
+}
+
+void Profiler::CaptureTrace(const std::string& filepath, uint32_t numFrames)
+{
+	InitializeClock();
+
+	s_Data.TraceFilepath = filepath;
+	s_Data.NumTraceFramesLeft = numFrames;
+	s_Data.TraceZones.clear();
+	s_Data.TraceFrameMarkers.clear();
+	s_Data.TraceGPUZones.clear();
+}
+
+bool Profiler::IsCapturingTrace()
+{
+	return s_Data.NumTraceFramesLeft > 0;
+}
+
+float Profiler::GetFrameTime()
+{
+	return s_Data.FrameTime;
+}
+
+const std::vector<ProfilerThreadFrame>& Profiler::GetThreadFrames()
+{
+	return s_Data.ThreadFrames;
+}
+
+ProfilerStatistics Profiler::GetStatistics()
+{
+	ProfilerStatistics stats;
+	stats.NumZones = s_Data.NumZones;
+
+	std::scoped_lock lock(s_Data.RingsMutex);
+	stats.NumThreads = static_cast<uint32_t>(s_Data.Rings.size());
+
+	for (const auto& ring : s_Data.Rings)
+		stats.NumDroppedZones += ring->NumDroppedZones.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+void Profiler::AddGPUZones(const std::vector<ProfilerGPUZone>& zones)
+{
+	s_Data.PendingGPUZones.insert(s_Data.PendingGPUZones.end(), zones.begin(), zones.end());
+}
+
+const std::vector<ProfilerGPUZone>& Profiler::GetGPUZones()
+{
+	return s_Data.GPUZones;
+}
+
+const RollingFrameStatistics& Profiler::GetFrameStatistics()
+{
+	return s_Data.FrameStatistics;
+}
+
+const std::vector<ProfilerZoneStatistics>& Profiler::GetZoneStatistics()
+{
+	return s_Data.ZoneStatistics;
 }
 
-void Profiler::Reset()
+void Profiler::SetStatisticsWindow(uint32_t numFrames)
 {
-	m_TimerCounts[CPU] = 0;
-	m_TimerCounts[GPU] = 0;
+	s_Data.StatisticsWindow = std::max(numFrames, 1u);
+	s_Data.FrameStatistics = RollingFrameStatistics(s_Data.StatisticsWindow, s_Data.StutterFactor);
+
+	for (ProfilerZoneStatistics& zoneStatistics : s_Data.ZoneStatistics)
+		zoneStatistics.Statistics = RollingFrameStatistics(s_Data.StatisticsWindow, s_Data.StutterFactor);
 }
 
-Timer::Timer(const char* name)
-	: m_Name(name), m_IsStopped(false)
+void Profiler::SetStutterFactor(float stutterFactor)
 {
-	m_StartTime = std::chrono::steady_clock::now();
+	s_Data.StutterFactor = stutterFactor;
+	s_Data.FrameStatistics.SetStutterFactor(stutterFactor);
+
+	for (ProfilerZoneStatistics& zoneStatistics : s_Data.ZoneStatistics)
+		zoneStatistics.Statistics.SetStutterFactor(stutterFactor);
 }
 
-Timer::~Timer()
+float Profiler::GetStutterFactor()
 {
-	if (!m_IsStopped)
-		Stop();
+	return s_Data.StutterFactor;
 }
 
-void Timer::Stop()
+void Profiler::ResetStatistics()
 {
-	m_IsStopped = true;
+	s_Data.FrameStatistics.Clear();
+
+	for (ProfilerZoneStatistics& zoneStatistics : s_Data.ZoneStatistics)
+		zoneStatistics.Statistics.Clear();
+}
+
+bool Profiler::WriteStatisticsReport(const std::string& filepath)
+{
+	std::filesystem::path reportPath(filepath);
+	std::error_code error;
+	if (!reportPath.parent_path().empty())
+		std::filesystem::create_directories(reportPath.parent_path(), error);
+
+	std::ofstream file(filepath);
+	if (!file)
+	{
+		LOG_ERR("[Profiler] Could not write statistics to {}", filepath);
+		return false;
+	}
+
+	file.setf(std::ios::fixed);
+	file.precision(4);
+
+	bool isCSV = reportPath.extension() == ".csv";
+	if (isCSV)
+	{
+		auto writeRow = [&file](const char* name, const char* type, const RollingFrameStatistics& statistics)
+		{
+			FrameTimeStatistics stats = statistics.GetStatistics();
+			// Names are quoted, quotes inside them are doubled
+			file << '"';
+			for (const char* c = name; *c; ++c)
+			{
+				if (*c == '"')
+					file << '"';
+				file << *c;
+			}
+			file << "\"," << type << ',' << stats.NumSamples << ',' << stats.Min << ',' << stats.Average << ',' << stats.StdDev << ',' << stats.P50 << ',' <<
+				stats.P95 << ',' << stats.P99 << ',' << stats.P999 << ',' << stats.Max << ',' << stats.NumStutters << ',' << statistics.GetNumTotalStutters() << '\n';
+		};
 
-	std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - m_StartTime;
-	if (strcmp(m_Name, "Frametime") == 0)
-		Profiler::AddFrameTime({ m_Name, elapsed.count() * 1000.0f });
+		file << "name,type,samples,min_ms,avg_ms,stddev_ms,p50_ms,p95_ms,p99_ms,p999_ms,max_ms,stutters,total_stutters\n";
+		writeRow("Frame", "frame", s_Data.FrameStatistics);
+
+		for (const ProfilerZoneStatistics& zoneStatistics : s_Data.ZoneStatistics)
+			writeRow(zoneStatistics.Name.c_str(), zoneStatistics.IsGPUZone ? "gpu" : "cpu", zoneStatistics.Statistics);
+	}
 	else
-		Profiler::AddCPUTimer({ m_Name, elapsed.count() * 1000.0f });
+	{
+		auto writeObject = [&file](const RollingFrameStatistics& statistics)
+		{
+			FrameTimeStatistics stats = statistics.GetStatistics();
+			file << "\"samples\":" << stats.NumSamples << ",\"min_ms\":" << stats.Min << ",\"avg_ms\":" << stats.Average << ",\"stddev_ms\":" << stats.StdDev <<
+				",\"p50_ms\":" << stats.P50 << ",\"p95_ms\":" << stats.P95 << ",\"p99_ms\":" << stats.P99 << ",\"p999_ms\":" << stats.P999 <<
+				",\"max_ms\":" << stats.Max << ",\"stutters\":" << stats.NumStutters << ",\"total_stutters\":" << statistics.GetNumTotalStutters();
+		};
+
+		file << "{\n  \"window\": " << s_Data.StatisticsWindow << ",\n  \"stutter_factor\": " << s_Data.StutterFactor << ",\n  \"frame\": {";
+		writeObject(s_Data.FrameStatistics);
+		file << "},\n  \"zones\": [";
+
+		for (std::size_t i = 0; i < s_Data.ZoneStatistics.size(); ++i)
+		{
+			const ProfilerZoneStatistics& zoneStatistics = s_Data.ZoneStatistics[i];
+			file << (i > 0 ? ",\n    {\"name\":" : "\n    {\"name\":");
+			WriteJSONString(file, zoneStatistics.Name.c_str());
+			file << ",\"type\":\"" << (zoneStatistics.IsGPUZone ? "gpu" : "cpu") << "\",";
+			writeObject(zoneStatistics.Statistics);
+			file << '}';
+		}
+
+		file << "\n  ]\n}\n";
+	}
+
+	LOG_INFO("[Profiler] Wrote statistics of {} frames and {} zones to {}", s_Data.FrameStatistics.GetNumSamples(), s_Data.ZoneStatistics.size(), filepath);
+	return true;
 }
@@ -0,0 +1,213 @@
+#include "Pch.h"
+#include "Util/Profiler.h"
+
+#include <imgui/imgui.h>
+#include <implot/implot.h>
+
+static void RenderZoneNodes(const std::vector<ProfilerZoneNode>& nodes)
+{
+	// Nodes are in depth first order, a closed tree node skips all deeper nodes that follow it
+	uint32_t openDepth = 0;
+
+	for (std::size_t i = 0; i < nodes.size(); ++i)
+	{
+		const ProfilerZoneNode& node = nodes[i];
+		if (node.Depth > openDepth)
+			continue;
+
+		while (openDepth > node.Depth)
+		{
+			ImGui::TreePop();
+			openDepth--;
+		}
+
+		bool hasChildren = i + 1 < nodes.size() && nodes[i + 1].Depth > node.Depth;
+		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | (hasChildren ? 0 : ImGuiTreeNodeFlags_Leaf);
+
+		ImGui::PushID(static_cast<int>(i));
+		bool isOpen = ImGui::TreeNodeEx(node.Zone->Name, flags, "%s: %.3f ms (%u calls, max %.3f ms)", node.Zone->Name,
+			node.Duration, node.NumCalls, node.MaxDuration);
+		ImGui::PopID();
+
+		if (isOpen)
+			openDepth++;
+	}
+
+	while (openDepth > 0)
+	{
+		ImGui::TreePop();
+		openDepth--;
+	}
+}
+
+static void RenderStatisticsRow(const char* name, const char* type, const RollingFrameStatistics& statistics, bool isSelected, bool& outIsClicked)
+{
+	FrameTimeStatistics stats = statistics.GetStatistics();
+
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	outIsClicked = ImGui::Selectable(name, isSelected, ImGuiSelectableFlags_SpanAllColumns);
+	ImGui::TableNextColumn();
+	ImGui::TextUnformatted(type);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", stats.Average);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", stats.P50);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", stats.P95);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", stats.P99);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", stats.Max);
+	ImGui::TableNextColumn();
+	ImGui::Text("%u", stats.NumStutters);
+}
+
+static void RenderFrameStatistics()
+{
+	const RollingFrameStatistics& frameStatistics = Profiler::GetFrameStatistics();
+	const std::vector<ProfilerZoneStatistics>& zoneStatistics = Profiler::GetZoneStatistics();
+
+	FrameTimeStatistics stats = frameStatistics.GetStatistics();
+	ImGui::Text("Last %u frames: avg %.3f ms, stddev %.3f ms, min %.3f ms, max %.3f ms", stats.NumSamples, stats.Average, stats.StdDev, stats.Min, stats.Max);
+	ImGui::Text("p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, p99.9 %.3f ms", stats.P50, stats.P95, stats.P99, stats.P999);
+	ImGui::Text("Stutters: %u in the last frames, %llu in total", stats.NumStutters, static_cast<unsigned long long>(frameStatistics.GetNumTotalStutters()));
+
+	float stutterFactor = Profiler::GetStutterFactor();
+	if (ImGui::DragFloat("Stutter factor", &stutterFactor, 0.05f, 1.1f, 10.0f, "%.2fx median"))
+		Profiler::SetStutterFactor(stutterFactor);
+
+	if (ImGui::Button("Reset"))
+		Profiler::ResetStatistics();
+	ImGui::SameLine();
+	if (ImGui::Button("Export to Captures/FrameStatistics.csv"))
+		Profiler::WriteStatisticsReport("Captures/FrameStatistics.csv");
+	ImGui::SameLine();
+	if (ImGui::Button("Export to Captures/FrameStatistics.json"))
+		Profiler::WriteStatisticsReport("Captures/FrameStatistics.json");
+
+	// The frame or the zone selected in the table below is plotted, zones can disappear when the statistics are reset
+	static int selectedZone = -1;
+	if (selectedZone >= static_cast<int>(zoneStatistics.size()))
+		selectedZone = -1;
+
+	const char* plottedName = selectedZone < 0 ? "Frame" : zoneStatistics[selectedZone].Name.c_str();
+	const RollingFrameStatistics& plottedStatistics = selectedZone < 0 ? frameStatistics : zoneStatistics[selectedZone].Statistics;
+	FrameTimeStatistics plottedStats = plottedStatistics.GetStatistics();
+
+	static std::vector<float> samples;
+	plottedStatistics.GetSamples(samples);
+	float stutterThreshold = plottedStats.P50 * stutterFactor;
+
+	if (ImPlot::BeginPlot("Frame times", ImVec2(-1.0f, 160.0f)))
+	{
+		ImPlot::SetupAxes("Frame", "ms", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+		ImPlot::PlotLine(plottedName, samples.data(), static_cast<int>(samples.size()));
+		ImPlot::PlotInfLines("Median", &plottedStats.P50, 1, ImPlotInfLinesFlags_Horizontal);
+		ImPlot::PlotInfLines("Stutter threshold", &stutterThreshold, 1, ImPlotInfLinesFlags_Horizontal);
+		ImPlot::EndPlot();
+	}
+
+	if (ImPlot::BeginPlot("Histogram", ImVec2(-1.0f, 160.0f)))
+	{
+		ImPlot::SetupAxes("ms", "Frames", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+		ImPlot::PlotHistogram(plottedName, samples.data(), static_cast<int>(samples.size()), ImPlotBin_Sqrt);
+		ImPlot::PlotInfLines("p99", &plottedStats.P99, 1);
+		ImPlot::PlotInfLines("p99.9", &plottedStats.P999, 1);
+		ImPlot::EndPlot();
+	}
+
+	ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+	if (ImGui::BeginTable("Zone statistics", 8, tableFlags, ImVec2(0.0f, 250.0f)))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Zone");
+		ImGui::TableSetupColumn("Type");
+		ImGui::TableSetupColumn("Avg ms");
+		ImGui::TableSetupColumn("p50 ms");
+		ImGui::TableSetupColumn("p95 ms");
+		ImGui::TableSetupColumn("p99 ms");
+		ImGui::TableSetupColumn("Max ms");
+		ImGui::TableSetupColumn("Stutters");
+		ImGui::TableHeadersRow();
+
+		bool isClicked = false;
+		RenderStatisticsRow("Frame", "Frame", frameStatistics, selectedZone < 0, isClicked);
+		if (isClicked)
+			selectedZone = -1;
+
+		for (std::size_t i = 0; i < zoneStatistics.size(); ++i)
+		{
+			ImGui::PushID(static_cast<int>(i));
+			RenderStatisticsRow(zoneStatistics[i].Name.c_str(), zoneStatistics[i].IsGPUZone ? "GPU" : "CPU", zoneStatistics[i].Statistics,
+				selectedZone == static_cast<int>(i), isClicked);
+			ImGui::PopID();
+
+			if (isClicked)
+				selectedZone = static_cast<int>(i);
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+void Profiler::OnImGuiRender()
+{
+	ImGui::Begin("Profiler");
+
+	float frameTime = GetFrameTime();
+	ImGui::Text("Frametime: %.3f ms", frameTime);
+	ImGui::Text("FPS: %u", frameTime > 0.0f ? static_cast<uint32_t>(1000.0f / frameTime) : 0);
+
+	ProfilerStatistics stats = GetStatistics();
+	ImGui::Text("Threads: %u, zones: %llu, dropped: %llu", stats.NumThreads, static_cast<unsigned long long>(stats.NumZones),
+		static_cast<unsigned long long>(stats.NumDroppedZones));
+
+	static int numTraceFrames = 60;
+	ImGui::DragInt("Trace frames", &numTraceFrames, 1.0f, 1, 10000);
+
+	if (IsCapturingTrace())
+		ImGui::Text("Capturing trace");
+	else if (ImGui::Button("Capture trace to Captures/Trace.json"))
+		CaptureTrace("Captures/Trace.json", static_cast<uint32_t>(numTraceFrames));
+
+	if (ImGui::CollapsingHeader("Frame Statistics"))
+		RenderFrameStatistics();
+
+	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+	if (ImGui::CollapsingHeader("CPU Zones"))
+	{
+		for (const ProfilerThreadFrame& threadFrame : GetThreadFrames())
+		{
+			if (threadFrame.Nodes.empty())
+				continue;
+
+			ImGui::PushID(threadFrame.Name.c_str());
+			if (ImGui::TreeNodeEx(threadFrame.Name.c_str(), ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				RenderZoneNodes(threadFrame.Nodes);
+				ImGui::TreePop();
+			}
+			ImGui::PopID();
+		}
+	}
+
+	ImGui::SetNextItemOpen(true, ImGuiCond_Once);
+	if (ImGui::CollapsingHeader("GPU Zones"))
+	{
+		// Zones are in begin order, nested zones are indented below their parent
+		for (const ProfilerGPUZone& zone : GetGPUZones())
+		{
+			float indent = 10.0f * zone.Depth;
+			if (indent > 0.0f)
+				ImGui::Indent(indent);
+
+			ImGui::Text("%s: %.3f ms", zone.Name, zone.Duration);
+
+			if (indent > 0.0f)
+				ImGui::Unindent(indent);
+		}
+	}
+
+	ImGui::End();
+}